@@ -138,8 +138,8 @@ struct args_option *args_process_line(int argc, char *argv[], char *definition)
 		struct args_option	*search = options;
 		char			*name = NULL;
 
-		if (*argv[i] == '-') {
-			/* The entry's an option name. */
+		if (*argv[i] == '-' && argv[i][1] != '\0') {
+			/* The entry's an option name; a lone - is a value. */
 		
 			name = argv[i] + 1;
 
@@ -157,7 +157,7 @@ struct args_option *args_process_line(int argc, char *argv[], char *definition)
 			}
 
 			if (search->type != ARGS_TYPE_BOOL) {
-				if (i + 1 >= argc || *argv[i + 1] == '-') {
+				if (i + 1 >= argc || (*argv[i + 1] == '-' && argv[i + 1][1] != '\0')) {
 					fprintf(stderr, "Switch -%s requires a value.\n", name);
 					return NULL;
 				}
@@ -31,6 +31,12 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "encoding.h"
 #include "string.h"
@@ -321,6 +327,50 @@ static struct encoding_table encoding_list[] = {
 	{ENCODING_TARGET_ACORN_LATIN2,	encoding_acorn_latin2,	"AcornL2",	"iso-8859-2"}
 };
 
+/**
+ * The number of codepoints covered by each page of a lookup table.
+ */
+
+#define ENCODING_PAGE_SIZE 256
+
+/**
+ * The number of pages in a lookup table, covering the Basic
+ * Multilingual Plane.
+ */
+
+#define ENCODING_PAGES 256
+
+/**
+ * A two-level lookup table from unicode codepoints in the Basic Multilingual
+ * Plane to the characters in an encoding. Pages with no mapped characters
+ * all share an empty page, and a zero entry indicates that the codepoint
+ * can not be encoded; all of the mapped targets lie above 127.
+ */
+
+struct encoding_lookup {
+	bool			built;				/**< True if the table has been built.		*/
+	const unsigned char	*pages[ENCODING_PAGES];		/**< The pages of the table.			*/
+};
+
+/**
+ * The lookup tables for each of the encodings, built when the encoding is
+ * first selected.
+ */
+
+static struct encoding_lookup encoding_lookups[ENCODING_TARGET_MAX];
+
+/**
+ * The empty page, shared by the lookup tables.
+ */
+
+static const unsigned char encoding_empty_page[ENCODING_PAGE_SIZE];
+
+/**
+ * A lock protecting the building of the lookup tables.
+ */
+
+static pthread_mutex_t encoding_lookup_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * An entry in the line endings table.
  */
@@ -343,32 +393,102 @@ static struct encoding_line_end_table encoding_line_end_list[] = {
 };
 
 /**
- * The currently selected encoding target.
+ * An encoding context, holding the encoding and line ending selections
+ * for an output job.
  */
 
-static enum encoding_target encoding_current_target = ENCODING_TARGET_UTF8;
+struct encoding_context {
+	enum encoding_target	target;		/**< The currently selected encoding target.		*/
+	struct encoding_map	*map;		/**< The active encoding map, or NULL to pass out UTF8.	*/
+	struct encoding_lookup	*lookup;	/**< The lookup table for the active encoding map.	*/
+	int			line_end;	/**< The current line end selection.			*/
+};
 
 /**
- * The active encoding map, or NULL to pass out UTF8.
+ * The encoding context used by threads which haven't selected their own.
  */
 
-static struct encoding_map *encoding_current_map = NULL;
+static struct encoding_context encoding_default_context = {ENCODING_TARGET_UTF8, NULL, NULL, -1};
 
 /**
- * The number of entries in the current map.
+ * The key used to hold the encoding context selected by each thread.
  */
 
-static size_t encoding_current_map_size = 0;
+static pthread_key_t encoding_context_key;
 
 /**
- * The current line end selection.
+ * Control for the one-time creation of the context key.
  */
 
-static int encoding_current_line_end = -1;
+static pthread_once_t encoding_context_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the context key was created successfully.
+ */
+
+static bool encoding_context_key_valid = false;
 
 /* Static Function Prototypes. */
 
-static bool encoding_find_mapped_character(int unicode, char *c);
+static struct encoding_context *encoding_find_context(void);
+static void encoding_create_context_key(void);
+static bool encoding_find_mapped_character(struct encoding_context *context, int unicode, char *c);
+static bool encoding_build_lookup(struct encoding_lookup *lookup, struct encoding_map *map);
+static size_t encoding_find_text_run(const char *text, size_t length);
+
+/**
+ * Create a new encoding context, for use by a thread via
+ * encoding_select_context().
+ *
+ * \return			Pointer to the new context, or NULL on failure.
+ */
+
+struct encoding_context *encoding_create_context(void)
+{
+	struct encoding_context *context;
+
+	context = malloc(sizeof(struct encoding_context));
+	if (context == NULL)
+		return NULL;
+
+	context->target = ENCODING_TARGET_UTF8;
+	context->map = NULL;
+	context->lookup = NULL;
+	context->line_end = -1;
+
+	return context;
+}
+
+/**
+ * Destroy an encoding context. The context must not be selected by any
+ * thread at the time.
+ *
+ * \param *context		Pointer to the context to destroy.
+ */
+
+void encoding_destroy_context(struct encoding_context *context)
+{
+	free(context);
+}
+
+/**
+ * Select an encoding context for the calling thread, so that encoding
+ * and line end selections made by the thread don't affect any others.
+ *
+ * \param *context		Pointer to the context to select, or NULL
+ *				to return to the default context.
+ * \return			True if successful; else false.
+ */
+
+bool encoding_select_context(struct encoding_context *context)
+{
+	pthread_once(&encoding_context_once, encoding_create_context_key);
+
+	if (!encoding_context_key_valid)
+		return false;
+
+	return (pthread_setspecific(encoding_context_key, context) == 0) ? true : false;
+}
 
 /**
  * Find an encoding type based on a textual name.
@@ -398,13 +518,14 @@ enum encoding_target encoding_find_target(char *name)
 
 bool encoding_select_table(enum encoding_target target)
 {
-	int	i = 0, current_code = 0;
-	bool	map[256];
+	struct encoding_context	*context = encoding_find_context();
+	int			i = 0, current_code = 0;
+	bool			map[256];
 
 	/* Reset the current map selection. */
 
-	encoding_current_map = NULL;
-	encoding_current_map_size = 0;
+	context->map = NULL;
+	context->lookup = NULL;
 
 	/* Check that the requested map actually exists. */
 
@@ -418,15 +539,15 @@ bool encoding_select_table(enum encoding_target target)
 
 	/* Set the current encoding. */
 
-	encoding_current_target = target;
+	context->target = target;
 
 	/* Set the current map table. */
 
-	encoding_current_map = encoding_list[target].table;
+	context->map = encoding_list[target].table;
 
 	/* If the table isn't allocated, there's nothing else to check. */
 
-	if (encoding_current_map == NULL)
+	if (context->map == NULL)
 		return true;
 
 	/* Reset the map target flags. */
@@ -438,28 +559,42 @@ bool encoding_select_table(enum encoding_target target)
 	 * map targets.
 	 */
 
-	for (i = 0; encoding_current_map[i].utf8 != 0; i++) {
-		if (encoding_current_map[i].utf8 <= current_code)
-			msg_report(MSG_ENC_OUT_OF_SEQ, encoding_current_map[i].utf8, i);
+	for (i = 0; context->map[i].utf8 != 0; i++) {
+		if (context->map[i].utf8 <= current_code)
+			msg_report(MSG_ENC_OUT_OF_SEQ, context->map[i].utf8, i);
 
-		if (encoding_current_map[i].target < 0 || encoding_current_map[i].target >= 256)
-			msg_report(MSG_ENC_OUT_OF_RANGE, encoding_current_map[i].utf8, i);
+		if (context->map[i].target < 0 || context->map[i].target >= 256)
+			msg_report(MSG_ENC_OUT_OF_RANGE, context->map[i].utf8, i);
 
-		if (map[encoding_current_map[i].target] == true)
-			msg_report(MSG_ENC_DUPLICATE, encoding_current_map[i].utf8, encoding_current_map[i].target, i);
+		if (map[context->map[i].target] == true)
+			msg_report(MSG_ENC_DUPLICATE, context->map[i].utf8, context->map[i].target, i);
 
-		map[encoding_current_map[i].target] = true;
+		map[context->map[i].target] = true;
 
-		current_code = encoding_current_map[i].utf8;
+		current_code = context->map[i].utf8;
 	}
 
-	encoding_current_map_size = i;
-
 	for (i = 128; i < 256; i++) {
 		if (map[i] == false)
 			msg_report(MSG_ENC_NO_MAP, i, i);
 	}
 
+	/* Build the lookup table for the encoding, if no-one has done so already. */
+
+	pthread_mutex_lock(&encoding_lookup_lock);
+
+	if (!encoding_lookups[target].built && encoding_build_lookup(&(encoding_lookups[target]), context->map))
+		encoding_lookups[target].built = true;
+
+	pthread_mutex_unlock(&encoding_lookup_lock);
+
+	if (!encoding_lookups[target].built) {
+		context->map = NULL;
+		return false;
+	}
+
+	context->lookup = &(encoding_lookups[target]);
+
 	return true;
 }
 
@@ -472,7 +607,22 @@ bool encoding_select_table(enum encoding_target target)
 
 const char *encoding_get_current_label(void)
 {
-	return encoding_list[encoding_current_target].label;
+	struct encoding_context *context = encoding_find_context();
+
+	return encoding_list[context->target].label;
+}
+
+/**
+ * Return the currently selected encoding target.
+ *
+ * \return			The current encoding target.
+ */
+
+enum encoding_target encoding_get_current_target(void)
+{
+	struct encoding_context *context = encoding_find_context();
+
+	return context->target;
 }
 
 /**
@@ -503,9 +653,11 @@ enum encoding_line_end encoding_find_line_end(char *name)
 
 bool encoding_select_line_end(enum encoding_line_end type)
 {
+	struct encoding_context *context = encoding_find_context();
+
 	/* Reset the current line end selection */
 
-	encoding_current_line_end = -1;
+	context->line_end = -1;
 
 	/* Check that the requested line end actually exists. */
 
@@ -519,7 +671,7 @@ bool encoding_select_line_end(enum encoding_line_end type)
 
 	/* Set the current map table. */
 
-	encoding_current_line_end = type;
+	context->line_end = type;
 
 	return true;
 }
@@ -542,6 +694,81 @@ int encoding_get_utf8_string_length(char *text)
 	return length;
 }
 
+/**
+ * Find the length of the run of plain 7-bit ASCII characters at the start
+ * of a UTF8 string. These are passed through unchanged by all of the
+ * supported encodings, so can be copied straight to the output.
+ *
+ * The bulk of the string is checked a block at a time, using SSE2 where
+ * it is available and whole machine words otherwise, with the block
+ * containing the end of the run being resolved a byte at a time.
+ *
+ * \param *text			Pointer to the UTF8 string to scan.
+ * \param length		The number of bytes available in the string.
+ * \param special		A further character to end the run at, or
+ *				'\0' for none.
+ * \return			The number of bytes in the run.
+ */
+
+size_t encoding_find_ascii_run(const char *text, size_t length, char special)
+{
+	size_t		run = 0;
+	unsigned char	c;
+#ifdef __SSE2__
+	__m128i		block, zero, stop;
+#else
+	uint32_t	word, ones = 0x01010101u, highs = 0x80808080u, stop;
+#endif
+
+	if (text == NULL)
+		return 0;
+
+#ifdef __SSE2__
+	zero = _mm_setzero_si128();
+	stop = _mm_set1_epi8(special);
+
+	while (length - run >= sizeof(__m128i)) {
+		block = _mm_loadu_si128((const __m128i *) (text + run));
+
+		/* The sign bits pick up the top-bit-set bytes; the compares
+		 * pick up terminators and the special character.
+		 */
+
+		if (_mm_movemask_epi8(_mm_or_si128(block, _mm_or_si128(_mm_cmpeq_epi8(block, zero), _mm_cmpeq_epi8(block, stop)))) != 0)
+			break;
+
+		run += sizeof(__m128i);
+	}
+#else
+	stop = ones * (unsigned char) special;
+
+	while (length - run >= sizeof(uint32_t)) {
+		memcpy(&word, text + run, sizeof(uint32_t));
+
+		/* Check for top-bit-set bytes, zero bytes and special bytes. */
+
+		if ((word & highs) != 0 || ((word - ones) & ~word & highs) != 0 ||
+				(((word ^ stop) - ones) & ~(word ^ stop) & highs) != 0)
+			break;
+
+		run += sizeof(uint32_t);
+	}
+#endif
+
+	/* Complete the run a byte at a time. */
+
+	while (run < length) {
+		c = text[run];
+
+		if (c == '\0' || c >= 0x80 || c == (unsigned char) special)
+			break;
+
+		run++;
+	}
+
+	return run;
+}
+
 /**
  * Parse a UTF8 string, returning the individual characters in Unicode.
  * The supplied string pointer is updated on return, to  point to the
@@ -605,22 +832,24 @@ int encoding_parse_utf8_string(char **text)
 
 bool encoding_write_unicode_char(char *buffer, size_t length, int unicode)
 {
+	struct encoding_context *context = encoding_find_context();
+
 	if (buffer == NULL)
 		return false;
 
 	/* There's an encoding selected, so convert the character. */
 
-	if (encoding_current_map != NULL) {
+	if (context->map != NULL) {
 		if (length < 2)
 			return false;
 
 		buffer[1] = '\0';
-		return encoding_find_mapped_character(unicode, buffer);
+		return encoding_find_mapped_character(context, unicode, buffer);
 	}
 
 	/* It's 7-bit encoding, so reject anything that falls out of range. */
 
-	if (encoding_current_target == ENCODING_TARGET_7BIT && unicode > 127) {
+	if (context->target == ENCODING_TARGET_7BIT && unicode > 127) {
 		buffer[0] = '?';
 		buffer[1] = '\0';
 		return false;
@@ -685,17 +914,18 @@ int encoding_write_utf8_character(char *buffer, size_t length, int unicode)
  * Convert a unicode character into the appropriate code in the current
  * encoding. Characters which can't be mapped are returned as '?'.
  *
+ * \param *context		Pointer to the encoding context to use.
  * \param unicode		The unicode character to convert.
  * \param *c			Pointer to a character in which to
  *				return the encoding (or '?').
  * \return			True if an encoding was found; else False.
  */
 
-static bool encoding_find_mapped_character(int unicode, char *c)
+static bool encoding_find_mapped_character(struct encoding_context *context, int unicode, char *c)
 {
-	int first = 0, last = encoding_current_map_size, middle;
+	unsigned char target = 0;
 
-	if (c == NULL)
+	if (context == NULL || c == NULL)
 		return false;
 
 	/* The byte is the same in unicode or ASCII. */
@@ -707,24 +937,19 @@ static bool encoding_find_mapped_character(int unicode, char *c)
 
 	/* There's no encoding selected, so output straight unicode. */
 
-	if (encoding_current_map == NULL) {
+	if (context->map == NULL || context->lookup == NULL) {
 		*c = unicode;
 		return true;
 	}
 
 	/* Find the character in the current encoding. */
 
-	while (first <= last) {
-		middle = (first + last) / 2;
+	if (unicode >= 0 && unicode < ENCODING_PAGES * ENCODING_PAGE_SIZE)
+		target = context->lookup->pages[unicode / ENCODING_PAGE_SIZE][unicode % ENCODING_PAGE_SIZE];
 
-		if (encoding_current_map[middle].utf8 == unicode) {
-			*c = encoding_current_map[middle].target;
-			return true;
-		} else if (encoding_current_map[middle].utf8 < unicode) {
-			first = middle + 1;
-		} else {
-			last = middle - 1;
-		}
+	if (target != 0) {
+		*c = target;
+		return true;
 	}
 
 	msg_report(MSG_ENC_NO_OUTPUT, unicode, unicode);
@@ -734,6 +959,48 @@ static bool encoding_find_mapped_character(int unicode, char *c)
 	return false;
 }
 
+/**
+ * Build the lookup table for an encoding map. Any pages allocated before
+ * a failure are left in place, to be reused on a future attempt.
+ *
+ * \param *lookup		Pointer to the lookup table to build.
+ * \param *map			Pointer to the map to build the table from.
+ * \return			True if successful; else False.
+ */
+
+static bool encoding_build_lookup(struct encoding_lookup *lookup, struct encoding_map *map)
+{
+	unsigned char	*page;
+	int		i, unicode;
+
+	for (i = 0; i < ENCODING_PAGES; i++) {
+		if (lookup->pages[i] == NULL)
+			lookup->pages[i] = encoding_empty_page;
+	}
+
+	for (i = 0; map[i].utf8 != 0; i++) {
+		unicode = map[i].utf8;
+
+		if (unicode < 128 || unicode >= ENCODING_PAGES * ENCODING_PAGE_SIZE || map[i].target < 128)
+			continue;
+
+		if (lookup->pages[unicode / ENCODING_PAGE_SIZE] == encoding_empty_page) {
+			page = calloc(ENCODING_PAGE_SIZE, sizeof(unsigned char));
+			if (page == NULL)
+				return false;
+
+			lookup->pages[unicode / ENCODING_PAGE_SIZE] = page;
+		}
+
+		/* The pages are only written to while the table is being built. */
+
+		page = (unsigned char *) lookup->pages[unicode / ENCODING_PAGE_SIZE];
+		page[unicode % ENCODING_PAGE_SIZE] = map[i].target;
+	}
+
+	return true;
+}
+
 /**
  * Return a pointer to the currently selected line end sequence.
  *
@@ -742,10 +1009,12 @@ static bool encoding_find_mapped_character(int unicode, char *c)
 
 const char *encoding_get_newline(void)
 {
-	if (encoding_current_line_end < 0 || encoding_current_line_end >= ENCODING_LINE_END_MAX)
+	struct encoding_context *context = encoding_find_context();
+
+	if (context->line_end < 0 || context->line_end >= ENCODING_LINE_END_MAX)
 		return NULL;
 
-	return encoding_line_end_list[encoding_current_line_end].sequence;
+	return encoding_line_end_list[context->line_end].sequence;
 }
 
 /**
@@ -758,27 +1027,158 @@ const char *encoding_get_newline(void)
 
 void encoding_flatten_whitespace(char *text)
 {
-	unsigned char	*head, *tail;
-	bool		space = false, whitespace = false;
-
-	head = (unsigned char*) text;
-	tail = head;
-
-	while (*head != '\0') {
-		space = (*head == '\t' || *head == '\r' || *head == '\n' || *head == ' ');
-
-		if (space && whitespace) {
-			head++;
-		} else if (space == true) {
-			*tail++ = ' ';
-			head++;
-			whitespace = space;
-		} else {
-			*tail++ = *head++;
-			whitespace = space;
+	if (text == NULL)
+		return;
+
+	encoding_flatten_whitespace_copy(text, text, strlen(text));
+}
+
+/**
+ * Copy a block of text into a buffer, flattening down the white space on
+ * the way so that multiple spaces and newlines become a single ASCII space.
+ * As every line ending becomes a space, CR and CRLF line endings need no
+ * separate normalisation. The copy stops early at any zero byte.
+ *
+ * \param *to			Pointer to the buffer to take the text, which
+ *				must hold at least length + 1 bytes, and
+ *				can be the same as *from.
+ * \param *from			Pointer to the text to be copied.
+ * \param length		The number of bytes of text to copy.
+ * \return			The number of bytes written to the buffer,
+ *				excluding the terminator.
+ */
+
+size_t encoding_flatten_whitespace_copy(char *to, const char *from, size_t length)
+{
+	size_t	in = 0, out = 0, run;
+	bool	whitespace = false;
+
+	if (to == NULL)
+		return 0;
+
+	while (from != NULL && in < length) {
+		/* Copy the run of text up to the next white space. */
+
+		run = encoding_find_text_run(from + in, length - in);
+
+		if (run > 0) {
+			if (to + out != from + in)
+				memmove(to + out, from + in, run);
+
+			in += run;
+			out += run;
+			whitespace = false;
 		}
+
+		if (in >= length || from[in] == '\0')
+			break;
+
+		/* Reduce the white space to a single space. */
+
+		if (!whitespace)
+			to[out++] = ' ';
+
+		whitespace = true;
+		in++;
 	}
 
-	*tail = '\0';
+	to[out] = '\0';
+
+	return out;
 }
 
+/**
+ * Find the length of the run of characters at the start of a string
+ * which contains no white space or zero bytes.
+ *
+ * The bulk of the string is checked a block at a time, using SSE2 where
+ * it is available and whole machine words otherwise, with the block
+ * containing the end of the run being resolved a byte at a time.
+ *
+ * \param *text			Pointer to the string to scan.
+ * \param length		The number of bytes available in the string.
+ * \return			The number of bytes in the run.
+ */
+
+static size_t encoding_find_text_run(const char *text, size_t length)
+{
+	size_t		run = 0;
+	unsigned char	c;
+#ifdef __SSE2__
+	__m128i		block, found;
+#else
+	uint32_t	word, ones = 0x01010101u, highs = 0x80808080u, test;
+#endif
+
+#ifdef __SSE2__
+	while (length - run >= sizeof(__m128i)) {
+		block = _mm_loadu_si128((const __m128i *) (text + run));
+
+		found = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+		found = _mm_or_si128(found, _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(block, _mm_setzero_si128()));
+
+		if (_mm_movemask_epi8(found) != 0)
+			break;
+
+		run += sizeof(__m128i);
+	}
+#else
+	while (length - run >= sizeof(uint32_t)) {
+		memcpy(&word, text + run, sizeof(uint32_t));
+
+		/* Check for zero bytes, then for each white space character. */
+
+		test = ((word - ones) & ~word & highs);
+		test |= (((word ^ (ones * ' ')) - ones) & ~(word ^ (ones * ' ')) & highs);
+		test |= (((word ^ (ones * '\n')) - ones) & ~(word ^ (ones * '\n')) & highs);
+		test |= (((word ^ (ones * '\t')) - ones) & ~(word ^ (ones * '\t')) & highs);
+		test |= (((word ^ (ones * '\r')) - ones) & ~(word ^ (ones * '\r')) & highs);
+
+		if (test != 0)
+			break;
+
+		run += sizeof(uint32_t);
+	}
+#endif
+
+	/* Complete the run a byte at a time. */
+
+	while (run < length) {
+		c = text[run];
+
+		if (c == '\0' || c == ' ' || c == '\n' || c == '\t' || c == '\r')
+			break;
+
+		run++;
+	}
+
+	return run;
+}
+
+/**
+ * Find the encoding context for the calling thread.
+ *
+ * \return			Pointer to the thread's encoding context.
+ */
+
+static struct encoding_context *encoding_find_context(void)
+{
+	struct encoding_context *context = NULL;
+
+	if (encoding_context_key_valid)
+		context = pthread_getspecific(encoding_context_key);
+
+	return (context != NULL) ? context : &encoding_default_context;
+}
+
+/**
+ * Create the key used to hold each thread's encoding context, on behalf
+ * of pthread_once().
+ */
+
+static void encoding_create_context_key(void)
+{
+	if (pthread_key_create(&encoding_context_key, NULL) == 0)
+		encoding_context_key_valid = true;
+}
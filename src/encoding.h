@@ -31,6 +31,7 @@
 #define XMLMAN_ENCODING_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * The size of a character output buffer. This needs to hold a full
@@ -161,6 +162,42 @@ enum encoding_line_end {
 	ENCODING_LINE_END_NONE		/**< No line ending.				*/
 };
 
+/**
+ * An encoding context, holding the encoding and line ending selections
+ * for an output job.
+ */
+
+struct encoding_context;
+
+/**
+ * Create a new encoding context, for use by a thread via
+ * encoding_select_context().
+ *
+ * \return			Pointer to the new context, or NULL on failure.
+ */
+
+struct encoding_context *encoding_create_context(void);
+
+/**
+ * Destroy an encoding context. The context must not be selected by any
+ * thread at the time.
+ *
+ * \param *context		Pointer to the context to destroy.
+ */
+
+void encoding_destroy_context(struct encoding_context *context);
+
+/**
+ * Select an encoding context for the calling thread, so that encoding
+ * and line end selections made by the thread don't affect any others.
+ *
+ * \param *context		Pointer to the context to select, or NULL
+ *				to return to the default context.
+ * \return			True if successful; else false.
+ */
+
+bool encoding_select_context(struct encoding_context *context);
+
 /**
  * Find an encoding type based on a textual name.
  *
@@ -187,6 +224,14 @@ bool encoding_select_table(enum encoding_target target);
 
 const char *encoding_get_current_label(void);
 
+/**
+ * Return the currently selected encoding target.
+ *
+ * \return			The current encoding target.
+ */
+
+enum encoding_target encoding_get_current_target(void);
+
 /**
  * Find a line ending type based on a textual name.
  *
@@ -215,6 +260,20 @@ bool encoding_select_line_end(enum encoding_line_end type);
 
 int encoding_get_utf8_string_length(char *text);
 
+/**
+ * Find the length of the run of plain 7-bit ASCII characters at the start
+ * of a UTF8 string. These are passed through unchanged by all of the
+ * supported encodings, so can be copied straight to the output.
+ *
+ * \param *text			Pointer to the UTF8 string to scan.
+ * \param length		The number of bytes available in the string.
+ * \param special		A further character to end the run at, or
+ *				'\0' for none.
+ * \return			The number of bytes in the run.
+ */
+
+size_t encoding_find_ascii_run(const char *text, size_t length, char special);
+
 /**
  * Parse a UTF8 string, returning the individual characters in Unicode.
  * The supplied string pointer is updated on return, to  point to the
@@ -268,5 +327,22 @@ const char *encoding_get_newline(void);
 
 void encoding_flatten_whitespace(char *text);
 
+/**
+ * Copy a block of text into a buffer, flattening down the white space on
+ * the way so that multiple spaces and newlines become a single ASCII space.
+ * As every line ending becomes a space, CR and CRLF line endings need no
+ * separate normalisation. The copy stops early at any zero byte.
+ *
+ * \param *to			Pointer to the buffer to take the text, which
+ *				must hold at least length + 1 bytes, and
+ *				can be the same as *from.
+ * \param *from			Pointer to the text to be copied.
+ * \param length		The number of bytes of text to copy.
+ * \return			The number of bytes written to the buffer,
+ *				excluding the terminator.
+ */
+
+size_t encoding_flatten_whitespace_copy(char *to, const char *from, size_t length);
+
 #endif
 
@@ -28,7 +28,9 @@
  */
 
 #include <ctype.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -47,47 +49,172 @@
 #include "filename.h"
 
 #include "msg.h"
+#include "string.h"
 
 /**
- * A filename node, containing a root, directory or leafname.
+ * The number of components which can be held within a filename instance
+ * before a separate array must be allocated for them.
  */
 
-struct filename_node {
+#define FILENAME_LOCAL_COMPONENTS 8
+
+/**
+ * The initial number of slots in the component table; must be a power of two.
+ */
+
+#define FILENAME_TABLE_SIZE 256
+
+/**
+ * The component table is grown once it becomes more than
+ * FILENAME_TABLE_LIMIT / FILENAME_TABLE_DIVISOR full.
+ */
+
+#define FILENAME_TABLE_LIMIT 3
+#define FILENAME_TABLE_DIVISOR 4
+
+/**
+ * The initial number of slots in the created directory table; must be
+ * a power of two.
+ */
+
+#define FILENAME_DIRECTORY_TABLE_SIZE 64
+
+/**
+ * A filename instance. The components of the name are held as pointers
+ * to interned strings, so two components match if their pointers do.
+ */
+
+struct filename {
 	/**
-	 * The filename component.
+	 * The type of filename stored.
 	 */
-	char			*name;
+	enum filename_type	type;
 
 	/**
-	 * Pointer to the next node in the name, or NULL.
+	 * The number of components in the name.
 	 */
-	struct filename_node	*next;
+	size_t			count;
+
+	/**
+	 * The number of components for which space is allocated.
+	 */
+	size_t			size;
+
+	/**
+	 * Pointer to the array of interned component parts of the name.
+	 */
+	char			**components;
+
+	/**
+	 * Space for the components of short names, to save allocating
+	 * a separate array.
+	 */
+	char			*local[FILENAME_LOCAL_COMPONENTS];
 };
 
 /**
- * A filename instance.
+ * A slot in the interned component table.
  */
 
-struct filename {
+struct filename_slot {
 	/**
-	 * The type of filename stored.
+	 * The interned component text, or NULL if the slot is free.
 	 */
-	enum filename_type	type;
+	char			*text;
 
 	/**
-	 * Pointer to the component parts of the name.
+	 * The hash of the component text.
 	 */
-	struct filename_node	*name;
+	uint64_t		hash;
 };
 
+/**
+ * The interned component table, as an open-addressed hash table. Interned
+ * components are never freed, so they can be read without locking.
+ */
+
+static struct filename_slot *filename_table = NULL;
+
+/**
+ * The number of slots in the component table.
+ */
+
+static size_t filename_table_size = 0;
+
+/**
+ * The number of components held in the component table.
+ */
+
+static size_t filename_table_count = 0;
+
+/**
+ * Lock protecting the component table.
+ */
+
+static pthread_mutex_t filename_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * A slot in the created directory table, identifying a directory by the
+ * interned components of its name.
+ */
+
+struct filename_directory {
+	/**
+	 * Pointer to a copy of the directory's components, or NULL if the
+	 * slot is free.
+	 */
+	char			**components;
+
+	/**
+	 * The number of components in the directory's name.
+	 */
+	size_t			count;
+
+	/**
+	 * The hash of the directory's component pointers.
+	 */
+	uint64_t		hash;
+};
+
+/**
+ * The table of directories which filename_mkdir() has created or found
+ * to exist, as an open-addressed hash table.
+ */
+
+static struct filename_directory *filename_directory_table = NULL;
+
+/**
+ * The number of slots in the created directory table.
+ */
+
+static size_t filename_directory_table_size = 0;
+
+/**
+ * The number of directories held in the created directory table.
+ */
+
+static size_t filename_directory_table_count = 0;
+
+/**
+ * Lock protecting the created directory table.
+ */
+
+static pthread_mutex_t filename_directory_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /* Static Function Prototypes */
 
+static struct filename *filename_create(enum filename_type type);
+static bool filename_reserve(struct filename *name, size_t count);
 static size_t filename_get_storage_size(struct filename *name);
 static bool filename_copy_to_buffer(struct filename *name, char *buffer, size_t length, enum filename_platform platform, int levels);
 static int filename_count_nodes(struct filename *name);
-static struct filename_node *filename_create_node(struct filename_node *node, size_t length);
-static void filename_destroy_node(struct filename_node *node);
+static size_t filename_count_levels(struct filename *name, int levels);
+static char *filename_intern(const char *text, size_t length);
+static bool filename_grow_table(void);
+static bool filename_find_directory(struct filename *name, size_t levels, uint64_t hash);
+static void filename_add_directory(struct filename *name, size_t levels, uint64_t hash);
+static bool filename_grow_directory_table(void);
 static char filename_get_separator(enum filename_platform platform);
 static char filename_get_extension(enum filename_platform platform);
 static char *filename_get_parent_name(enum filename_platform platform);
@@ -106,47 +233,37 @@ static char *filename_get_parent_name(enum filename_platform platform);
 struct filename *filename_make(char *name, enum filename_type type, enum filename_platform platform)
 {
 	struct filename		*root = NULL;
-	struct filename_node	*current_node = NULL, *previous_node = NULL;
-	char			*part = NULL;
-	int			position = 0, length = 0;
+	char			*buffer = NULL, *part = NULL;
+	int			position = 0;
+	size_t			length = 0;
 	char			separator, extension;
 
 	/* Claim memory for the root of the name. */
 
-	root = malloc(sizeof(struct filename));
+	root = filename_create(type);
 	if (root == NULL)
 		return NULL;
 
-	root->type = type;
-	root->name = NULL;
-
 	if (name == NULL)
 		return root;
 
+	/* Claim a buffer to assemble the parts of the name in. */
+
+	buffer = malloc(strlen(name) + 1);
+	if (buffer == NULL) {
+		filename_destroy(root);
+		return NULL;
+	}
+
 	/* Break the name down into chunks. */
 
 	separator = filename_get_separator(platform);
 	extension = filename_get_extension(platform);
 
 	while (name[position] != '\0') {
-		/* Find the next part of the name. */
-
-		length = 0;
-
-		while (name[position + length] != '\0' && name[position + length] != separator)
-			length++;
-
-		/* Allocate memory for the part name. */
-
-		current_node = filename_create_node(NULL, length);
-		if (current_node == NULL) {
-			filename_destroy(root);
-			return NULL;
-		}
+		/* Copy the next part of the name into the buffer. */
 
-		/* Copy the part name into the new structure. */
-
-		part = current_node->name;
+		part = buffer;
 
 		while (name[position] != '\0' && name[position] != separator) {
 			if (name[position] == extension)
@@ -158,22 +275,35 @@ struct filename *filename_make(char *name, enum filename_type type, enum filenam
 		}
 
 		*part = '\0';
+		length = part - buffer;
 
 		/* Step past any directory separator. */
 
 		if (name[position] != '\0')
 			position++;
 
-		/* Link the new node in to the instance. */
+		/* Intern the part name and add it to the instance. Empty
+		 * parts are not valid.
+		 */
+
+		if (length == 0 || !filename_reserve(root, root->count + 1)) {
+			free(buffer);
+			filename_destroy(root);
+			return NULL;
+		}
 
-		if (previous_node == NULL)
-			root->name = current_node;
-		else
-			previous_node->next = current_node;
+		root->components[root->count] = filename_intern(buffer, length);
+		if (root->components[root->count] == NULL) {
+			free(buffer);
+			filename_destroy(root);
+			return NULL;
+		}
 
-		previous_node = current_node;
+		root->count++;
 	}
 
+	free(buffer);
+
 	return root;
 }
 
@@ -185,22 +315,15 @@ struct filename *filename_make(char *name, enum filename_type type, enum filenam
 
 void filename_destroy(struct filename *name)
 {
-	struct filename_node *current_node = NULL, *next_node = NULL;
-
 	if (name == NULL)
 		return;
 
-	/* Free the nodes in the name. */
-
-	current_node = name->name;
-
-	while (current_node != NULL) {
-		next_node = current_node->next;
-
-		filename_destroy_node(current_node);
+	/* Free any separate component array; the components themselves
+	 * are interned, and remain in the table.
+	 */
 
-		current_node = next_node;
-	}
+	if (name->components != name->local)
+		free(name->components);
 
 	/* Free the instance data itself. */
 
@@ -208,7 +331,9 @@ void filename_destroy(struct filename *name)
 }
 
 /**
- * Open a file using a filename instance.
+ * Open a file using a filename instance. A name of FILENAME_STDIO
+ * returns stdin or stdout, depending on the mode, which must not be
+ * closed by the caller.
  *
  * \param *name			The instance to open.
  * \param *mode			The required read/write mode.
@@ -220,6 +345,9 @@ FILE *filename_fopen(struct filename *name, const char *mode)
 	char	*filename = NULL;
 	FILE	*handle = NULL;
 
+	if (filename_is_stdio(name))
+		return (mode[0] == 'r') ? stdin : stdout;
+
 	filename = filename_convert(name, FILENAME_PLATFORM_LOCAL, 0);
 	if (filename == NULL) {
 		msg_report(MSG_WRITE_NO_FILENAME);
@@ -241,7 +369,8 @@ FILE *filename_fopen(struct filename *name, const char *mode)
 /**
  * Create a directory, and optionally any intermediate directories which are
  * required. If the intermediate directories are not created, the call will fail
- * if they do not exist.
+ * if they do not exist. Directories which have already been created are
+ * remembered, and not created again until filename_mkdir_reset() is called.
  *
  * \param *name			A filename instance referring to the directory
  *				to be created.
@@ -255,6 +384,7 @@ bool filename_mkdir(struct filename *name, bool intermediate)
 	size_t		length = 0;
 	char		*filename = NULL;
 	int		levels, nodes = 0;
+	uint64_t	hash = STRING_HASH_INITIAL;
 #ifdef RISCOS
 	os_error	*error = NULL;
 #endif
@@ -263,6 +393,11 @@ bool filename_mkdir(struct filename *name, bool intermediate)
 	if (nodes == 0)
 		return true;
 
+	/* If the whole path has already been created, there's nothing to do. */
+
+	if (filename_find_directory(name, nodes, string_hash(name->components, nodes * sizeof(char *), STRING_HASH_INITIAL)))
+		return true;
+
 	length = filename_get_storage_size(name);
 	if (length == 0)
 		return false;
@@ -271,7 +406,16 @@ bool filename_mkdir(struct filename *name, bool intermediate)
 	if (filename == NULL)
 		return false;
 
-	for (levels = (intermediate) ? 1 : nodes; levels <= nodes; levels++) {
+	/* Work down the path, creating any directories which haven't
+	 * been seen before.
+	 */
+
+	for (levels = 1; levels <= nodes; levels++) {
+		hash = string_hash(&(name->components[levels - 1]), sizeof(char *), hash);
+
+		if ((!intermediate && levels < nodes) || filename_find_directory(name, levels, hash))
+			continue;
+
 		if (!filename_copy_to_buffer(name, filename, length, FILENAME_PLATFORM_LOCAL, levels)) {
 			free(filename);
 			return false;
@@ -291,6 +435,7 @@ bool filename_mkdir(struct filename *name, bool intermediate)
 			return false;
 		}
 #endif
+		filename_add_directory(name, levels, hash);
 	}
 
 	free(filename);
@@ -298,6 +443,29 @@ bool filename_mkdir(struct filename *name, bool intermediate)
 	return true;
 }
 
+/**
+ * Forget all of the directories which filename_mkdir() has created, so
+ * that they will be checked on disc again when next required.
+ */
+
+void filename_mkdir_reset(void)
+{
+	size_t	i;
+
+	pthread_mutex_lock(&filename_directory_lock);
+
+	for (i = 0; i < filename_directory_table_size; i++)
+		free(filename_directory_table[i].components);
+
+	free(filename_directory_table);
+
+	filename_directory_table = NULL;
+	filename_directory_table_size = 0;
+	filename_directory_table_count = 0;
+
+	pthread_mutex_unlock(&filename_directory_lock);
+}
+
 /**
  * Set the RISC OS filetype of a file
  *
@@ -319,6 +487,9 @@ bool filename_set_type(struct filename *name, enum filename_filetype type)
 	os_error *error = NULL;
 	bits filetype = 0;
 
+	if (filename_is_stdio(name))
+		return true;
+
 	levels = filename_count_nodes(name);
 
 	length = filename_get_storage_size(name);
@@ -341,9 +512,13 @@ bool filename_set_type(struct filename *name, enum filename_filetype type)
 	case FILENAME_FILETYPE_HTML:
 		filetype = 0xfaf;
 		break;
+	case FILENAME_FILETYPE_CSS:
+		filetype = 0xf79;
+		break;
 	case FILENAME_FILETYPE_STRONGHELP:
 		filetype = 0x3d6;
 		break;
+	case FILENAME_FILETYPE_DATA:
 	default:
 		filetype = osfile_TYPE_DATA;
 		break;
@@ -359,6 +534,76 @@ bool filename_set_type(struct filename *name, enum filename_filetype type)
 #endif
 }
 
+/**
+ * Read a stamp for a file, combining its modification time and size,
+ * which will change whenever the file is written.
+ *
+ * \param *name 		A filename instance referring to the file
+ *				which is to be read.
+ * \param *stamp		Pointer to a variable to take the stamp.
+ * \return			True if the stamp was read; else False.
+ */
+
+bool filename_get_stamp(struct filename *name, uint64_t *stamp)
+{
+	size_t length = 0;
+	int levels = 0;
+	char *filename = NULL;
+#ifdef LINUX
+	struct stat status;
+	bool result;
+#endif
+#ifdef RISCOS
+	os_error *error = NULL;
+	fileswitch_object_type type;
+	bits load_addr, exec_addr;
+	int size;
+#endif
+
+	if (name == NULL || stamp == NULL)
+		return false;
+
+	levels = filename_count_nodes(name);
+
+	length = filename_get_storage_size(name);
+	if (length == 0)
+		return false;
+
+	filename = malloc(length);
+	if (filename == NULL)
+		return false;
+
+	if (!filename_copy_to_buffer(name, filename, length, FILENAME_PLATFORM_LOCAL, levels)) {
+		free(filename);
+		return false;
+	}
+
+#ifdef LINUX
+	result = (stat(filename, &status) == 0) ? true : false;
+
+	free(filename);
+
+	if (result == false)
+		return false;
+
+	*stamp = ((uint64_t) status.st_mtim.tv_sec * 1000000000u + status.st_mtim.tv_nsec) ^ ((uint64_t) status.st_size << 40);
+
+	return true;
+#endif
+#ifdef RISCOS
+	error = xosfile_read_stamped_no_path(filename, &type, &load_addr, &exec_addr, &size, NULL, NULL);
+
+	free(filename);
+
+	if (error != NULL || type != fileswitch_IS_FILE)
+		return false;
+
+	*stamp = ((uint64_t) (load_addr & 0xffu) << 32 | exec_addr) ^ ((uint64_t) size << 40);
+
+	return true;
+#endif
+}
+
 /**
  * Dump the contents of a filename instance for debug purposes.
  *
@@ -368,7 +613,7 @@ bool filename_set_type(struct filename *name, enum filename_filetype type)
 
 void filename_dump(struct filename *name, char *label)
 {
-	struct filename_node *node;
+	size_t i;
 
 	printf(">=======================\n");
 
@@ -380,16 +625,8 @@ void filename_dump(struct filename *name, char *label)
 		return;
 	}
 
-	node = name->name;
-
-	while (node != NULL) {
-		if (node->name != NULL)
-			printf("Node: '%s'\n", node->name);
-		else
-			printf("Empty node!\n");
-
-		node = node->next;
-	}
+	for (i = 0; i < name->count; i++)
+		printf("Node: '%s'\n", name->components[i]);
 
 	printf("<-----------------------\n");
 }
@@ -427,13 +664,10 @@ struct filename *filename_up(struct filename *name, int up)
 
 	/* Claim memory for the new filename root. */
 
-	new_name = malloc(sizeof(struct filename));
+	new_name = filename_create(name->type);
 	if (new_name == NULL)
 		return NULL;
 
-	new_name->type = name->type;
-	new_name->name = NULL;
-
 	/* Copy across the required number of name nodes. */
 
 	if (levels > 0 && !filename_append(new_name, name, levels)) {
@@ -448,8 +682,7 @@ struct filename *filename_up(struct filename *name, int up)
 /**
  * Add two filenames together. The nodes in the second name are duplicated and
  * added to the start of the first, so the second name can be deleted afterwards
- * if required. In the event of a failure, the number of nodes in the first
- * name is undefined.
+ * if required. In the event of a failure, the first name is unchanged.
  *
  * \param *name			Pointer to the first name, to which the nodes of
  *				the second will be prepended.
@@ -461,38 +694,23 @@ struct filename *filename_up(struct filename *name, int up)
 
 bool filename_prepend(struct filename *name, struct filename *add, int levels)
 {
-	struct filename_node	*original = NULL, *node = NULL, *new_node = NULL, *previous_node = NULL;
-	int			count = 0;
+	size_t	count;
 
 	if (name == NULL || add == NULL)
 		return false;
 
-	/* Remember the start of the first name. */
-
-	original = name->name;
-
-	/* Copy the required number of nodes on to the end of the name. */
-
-	node = add->name;
-
-	while (node != NULL && ((levels == 0) || (count++ < levels))) {
-		new_node = filename_create_node(node, 0);
-		if (new_node == NULL)
-			return false;
-
-		/* Link the new node in to the instance. */
-
-		if (previous_node == NULL)
-			name->name = new_node;
-		else
-			previous_node->next = new_node;
+	count = filename_count_levels(add, levels);
 
-		previous_node = new_node;
+	if (!filename_reserve(name, name->count + count))
+		return false;
 
-		node = node->next;
-	}
+	/* Move the existing nodes up, and copy the new ones in front. If
+	 * a name is being prepended to itself, its nodes have now moved.
+	 */
 
-	new_node->next = original;
+	memmove(name->components + count, name->components, name->count * sizeof(char *));
+	memcpy(name->components, (add == name) ? name->components + count : add->components, count * sizeof(char *));
+	name->count += count;
 
 	return true;
 }
@@ -500,8 +718,7 @@ bool filename_prepend(struct filename *name, struct filename *add, int levels)
 /**
  * Add two filenames together. The nodes in the second name are duplicated and
  * added to the end of the first, so the second name can be deleted afterwards
- * if required. In the event of a failure, the number of nodes in the first
- * name is undefined.
+ * if required. In the event of a failure, the first name is unchanged.
  *
  * \param *name			Pointer to the first name, to which the nodes of
  *				the second will be appended.
@@ -513,41 +730,18 @@ bool filename_prepend(struct filename *name, struct filename *add, int levels)
 
 bool filename_append(struct filename *name, struct filename *add, int levels)
 {
-	struct filename_node	*node = NULL, *new_node = NULL, *previous_node = NULL;
-	int			count = 0;
+	size_t	count;
 
 	if (name == NULL || add == NULL)
 		return false;
 
-	/* Find the end of the first name. */
-
-	node = name->name;
-
-	while (node != NULL) {
-		previous_node = node;
-		node = node->next;
-	}
-
-	/* Copy the required number of nodes on to the end of the name. */
-
-	node = add->name;
-
-	while (node != NULL && ((levels == 0) || (count++ < levels))) {
-		new_node = filename_create_node(node, 0);
-		if (new_node == NULL)
-			return false;
-
-		/* Link the new node in to the instance. */
+	count = filename_count_levels(add, levels);
 
-		if (previous_node == NULL)
-			name->name = new_node;
-		else
-			previous_node->next = new_node;
-
-		previous_node = new_node;
+	if (!filename_reserve(name, name->count + count))
+		return false;
 
-		node = node->next;
-	}
+	memcpy(name->components + name->count, add->components, count * sizeof(char *));
+	name->count += count;
 
 	return true;
 }
@@ -601,9 +795,8 @@ struct filename *filename_join(struct filename *first, struct filename *second)
 struct filename *filename_get_relative(struct filename *from, struct filename *to)
 {
 	struct filename *filename;
-	struct filename_node *node1 = NULL, *node2 = NULL, *tail = NULL, *node = NULL;
 	char *parent = NULL;
-	size_t parent_length;
+	size_t common = 0, up = 0, i;
 
 	if (from == NULL || to == NULL)
 		return NULL;
@@ -617,68 +810,38 @@ struct filename *filename_get_relative(struct filename *from, struct filename *t
 	if (parent == NULL)
 		return NULL;
 
-	parent_length = strlen(parent);
-
-	/* Create the new name. */
-
-	filename = filename_make(NULL, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_NONE);
-	if (filename == NULL)
+	parent = filename_intern(parent, strlen(parent));
+	if (parent == NULL)
 		return NULL;
 
 	/* Find the common parts of the two names. */
 
-	node1 = from->name;
-	node2 = to->name;
-
-	while (node1 != NULL && node2 != NULL && strcmp(node1->name, node2->name) == 0) {
-		node1 = node1->next;
-		node2 = node2->next;
-	}
+	while (common < from->count && common < to->count && from->components[common] == to->components[common])
+		common++;
 
-	/* Drop one more from the first name, to allow for the leafname
+	/* Track up the tree from the first name, allowing for the leafname
 	 * that we don't need to step back up over.
 	 */
 
-	if (node1 != NULL)
-		node1 = node1->next;
-
-	/* Track up the tree from the first name. */
-
-	while (node1 != NULL) {
-		node = filename_create_node(NULL, parent_length);
-		if (node == NULL) {
-			filename_destroy(filename);
-			return NULL;
-		}
+	if (common < from->count)
+		up = from->count - common - 1;
 
-		strncpy(node->name, parent, parent_length + 1);
+	/* Create the new name, and track back down to the second name. */
 
-		if (tail == NULL)
-			filename->name = node;
-		else
-			tail->next = node;
+	filename = filename_create(FILENAME_TYPE_LEAF);
+	if (filename == NULL)
+		return NULL;
 
-		tail = node;
-		node1 = node1->next;
+	if (!filename_reserve(filename, up + to->count - common)) {
+		filename_destroy(filename);
+		return NULL;
 	}
 
-	/* Track back down to the second name. */
+	for (i = 0; i < up; i++)
+		filename->components[filename->count++] = parent;
 
-	while (node2 != NULL) {
-		node = filename_create_node(node2, 0);
-		if (node == NULL) {
-			filename_destroy(filename);
-			return NULL;
-		}
-
-		if (tail == NULL)
-			filename->name = node;
-		else
-			tail->next = node;
-
-		tail = node;
-		node2 = node2->next;
-	}
+	for (i = common; i < to->count; i++)
+		filename->components[filename->count++] = to->components[i];
 
 	return filename;
 }
@@ -692,7 +855,20 @@ struct filename *filename_get_relative(struct filename *from, struct filename *t
 
 bool filename_is_empty(struct filename *name)
 {
-	return (name == NULL || name->name == NULL) ? true : false;
+	return (name == NULL || name->count == 0) ? true : false;
+}
+
+/**
+ * Test a filename to see if it refers to the standard input or output
+ * streams, by being FILENAME_STDIO alone.
+ *
+ * \param *name			The filename instance to be tested.
+ * \return			True if the name is a stream; otherwise false.
+ */
+
+bool filename_is_stdio(struct filename *name)
+{
+	return (name != NULL && name->count == 1 && strcmp(name->components[0], FILENAME_STDIO) == 0) ? true : false;
 }
 
 /**
@@ -749,26 +925,14 @@ char *filename_convert(struct filename *name, enum filename_platform platform, i
 
 static size_t filename_get_storage_size(struct filename *name)
 {
-	size_t			length = 0;
-	char			*c = NULL;
-	struct filename_node	*node = NULL;
-
-	node = name->name;
-
-	while (node != NULL) {
-		c = node->name;
-
-		/* Count the character bytes in the name. */
+	size_t			length = 0, i;
 
-		while (*c++ != '\0')
-			length++;
-
-		/* Add one for the separator or terminator. */
-
-		length++;
+	/* Count the character bytes in each part of the name, adding one
+	 * for the separator or terminator.
+	 */
 
-		node = node->next;
-	}
+	for (i = 0; i < name->count; i++)
+		length += strlen(name->components[i]) + 1;
 
 	return length;
 }
@@ -786,7 +950,7 @@ static size_t filename_get_storage_size(struct filename *name)
 
 static bool filename_copy_to_buffer(struct filename *name, char *buffer, size_t length, enum filename_platform platform, int levels)
 {
-	struct filename_node	*node = NULL;
+	size_t			node = 0;
 	int			ptr = 0;
 	char			*c = NULL; 
 	char			separator, extension;
@@ -794,14 +958,13 @@ static bool filename_copy_to_buffer(struct filename *name, char *buffer, size_t
 	if (buffer == NULL || length == 0)
 		return false;
 
-	node = name->name;
 	separator = filename_get_separator(platform);
 	extension = filename_get_extension(platform);
 
 	/* Copy the name into the buffer, byte by byte. */
 
-	while ((ptr < length) && (node != NULL) && (levels-- > 0)) {
-		c = node->name;
+	while ((ptr < length) && (node < name->count) && (levels-- > 0)) {
+		c = name->components[node];
 
 		/* Copy the character bytes in the name. In StrongHelp mode,
 		 * folders which start '[...]' are omitted from link names.
@@ -822,10 +985,10 @@ static bool filename_copy_to_buffer(struct filename *name, char *buffer, size_t
 		 * mode, separators are ignored when assembling link names.
 		 */
 
-		if ((ptr < length) && (node->next != NULL) && (levels > 0) && platform != FILENAME_PLATFORM_STRONGHELP)
+		if ((ptr < length) && (node + 1 < name->count) && (levels > 0) && platform != FILENAME_PLATFORM_STRONGHELP)
 			buffer[ptr++] = separator;
 
-		node = node->next;
+		node++;
 	}
 
 	/* If the buffer overran, terminate it and exit. */
@@ -849,83 +1012,310 @@ static bool filename_copy_to_buffer(struct filename *name, char *buffer, size_t
 
 static int filename_count_nodes(struct filename *name)
 {
-	struct filename_node	*node = NULL;
-	int			levels = 0;
+	return name->count;
+}
 
-	node = name->name;
+/**
+ * Count the number of nodes which will be copied from a filename for
+ * a given number of levels.
+ *
+ * \param *name			The filename instance to be counted.
+ * \param levels		The number of levels to copy, or zero for all.
+ * \return			The number of nodes to be copied.
+ */
 
-	while (node != NULL) {
-		levels++;
-		node = node->next;
-	}
+static size_t filename_count_levels(struct filename *name, int levels)
+{
+	if (levels <= 0 || (size_t) levels > name->count)
+		return name->count;
 
 	return levels;
 }
 
 
 /**
- * Duplicate a node, or create a new one with a given name
- * buffer length allocated. Either node is not NULL and length
- * is zero, or node is NULL and length is not zero.
- * 
- * \param *node		Pointer to the node to duplicate, or NULL.
- * \param length	Length of the filename buffer to allocate, or 0.
- * \return		Pointer to the duplicate node, or NULL.
+ * Create a new, empty, filename instance.
+ *
+ * \param type			The type of filename.
+ * \return			Pointer to the new instance, or NULL.
  */
 
-static struct filename_node *filename_create_node(struct filename_node *node, size_t length)
+static struct filename *filename_create(enum filename_type type)
 {
-	struct filename_node *new_node = NULL;
-	char *new_part = NULL;
+	struct filename *name = NULL;
 
-	if (node == NULL && length == 0)
+	name = malloc(sizeof(struct filename));
+	if (name == NULL)
 		return NULL;
 
-	/* Allocate the text buffer. */
+	name->type = type;
+	name->count = 0;
+	name->size = FILENAME_LOCAL_COMPONENTS;
+	name->components = name->local;
+
+	return name;
+}
+
+/**
+ * Ensure that a filename instance has space for a given number of
+ * components, moving them into a separate array if required.
+ *
+ * \param *name			The filename instance to update.
+ * \param count			The number of components required.
+ * \return			True if successful; False on failure.
+ */
+
+static bool filename_reserve(struct filename *name, size_t count)
+{
+	size_t	size;
+	char	**components = NULL;
 
-	if (node != NULL && length == 0) {
-		if (node->name != NULL)
-			new_part = strdup(node->name);
-	} else if (node == NULL && length > 0) {
-		new_part = malloc(length + 1);
-		new_part[0] = '\0';
+	if (count <= name->size)
+		return true;
+
+	size = name->size * 2;
+
+	while (size < count)
+		size *= 2;
+
+	if (name->components == name->local) {
+		components = malloc(size * sizeof(char *));
+		if (components != NULL)
+			memcpy(components, name->local, name->count * sizeof(char *));
+	} else {
+		components = realloc(name->components, size * sizeof(char *));
 	}
 
-	new_node = malloc(sizeof(struct filename_node));
+	if (components == NULL)
+		return false;
 
-	/* Tidy up the loose nodes in the event of a memory error. */
+	name->components = components;
+	name->size = size;
 
-	if (new_node == NULL || new_part == NULL) {
-		if (new_node != NULL)
-			free(new_node);
+	return true;
+}
+
+/**
+ * Find a filename component in the interned component table, adding
+ * it if it's not already present.
+ *
+ * \param *text			Pointer to the component text.
+ * \param length		The length of the component text, in bytes.
+ * \return			Pointer to the interned component, or NULL.
+ */
 
-		if (new_part != NULL)
-			free(new_part);
+static char *filename_intern(const char *text, size_t length)
+{
+	uint64_t	hash;
+	size_t		slot;
+	char		*component = NULL;
 
+	hash = string_hash(text, length, STRING_HASH_INITIAL);
+
+	pthread_mutex_lock(&filename_table_lock);
+
+	if ((filename_table_count + 1) * FILENAME_TABLE_DIVISOR > filename_table_size * FILENAME_TABLE_LIMIT &&
+			!filename_grow_table()) {
+		pthread_mutex_unlock(&filename_table_lock);
 		return NULL;
 	}
 
-	new_node->name = new_part;
-	new_node->next = NULL;
+	/* Look for the component in the table, stopping at the first
+	 * free slot if it isn't there.
+	 */
+
+	slot = hash & (filename_table_size - 1);
+
+	while (filename_table[slot].text != NULL) {
+		if (filename_table[slot].hash == hash && strncmp(filename_table[slot].text, text, length) == 0 &&
+				filename_table[slot].text[length] == '\0')
+			break;
+
+		slot = (slot + 1) & (filename_table_size - 1);
+	}
+
+	/* If it wasn't found, add a copy into the free slot. */
+
+	if (filename_table[slot].text == NULL) {
+		component = malloc(length + 1);
+
+		if (component != NULL) {
+			memcpy(component, text, length);
+			component[length] = '\0';
+
+			filename_table[slot].text = component;
+			filename_table[slot].hash = hash;
+			filename_table_count++;
+		}
+	}
+
+	component = filename_table[slot].text;
+
+	pthread_mutex_unlock(&filename_table_lock);
+
+	return component;
+}
+
+/**
+ * Double the size of the interned component table, rehashing its contents.
+ * The table lock must be held by the caller.
+ *
+ * \return			True if successful; False on failure.
+ */
+
+static bool filename_grow_table(void)
+{
+	struct filename_slot	*table = NULL;
+	size_t			size, slot, i;
+
+	size = (filename_table_size > 0) ? filename_table_size * 2 : FILENAME_TABLE_SIZE;
+
+	table = calloc(size, sizeof(struct filename_slot));
+	if (table == NULL)
+		return false;
+
+	for (i = 0; i < filename_table_size; i++) {
+		if (filename_table[i].text == NULL)
+			continue;
+
+		slot = filename_table[i].hash & (size - 1);
+
+		while (table[slot].text != NULL)
+			slot = (slot + 1) & (size - 1);
+
+		table[slot] = filename_table[i];
+	}
+
+	free(filename_table);
+
+	filename_table = table;
+	filename_table_size = size;
+
+	return true;
+}
+
+/**
+ * Test whether a directory is in the created directory table.
+ *
+ * \param *name			The filename instance holding the directory.
+ * \param levels		The number of components of the name which
+ *				make up the directory.
+ * \param hash			The hash of the directory's component pointers.
+ * \return			True if the directory is in the table; False
+ *				if not.
+ */
+
+static bool filename_find_directory(struct filename *name, size_t levels, uint64_t hash)
+{
+	size_t	slot;
+	bool	found = false;
+
+	pthread_mutex_lock(&filename_directory_lock);
+
+	if (filename_directory_table_size > 0) {
+		slot = hash & (filename_directory_table_size - 1);
+
+		while (filename_directory_table[slot].components != NULL) {
+			if (filename_directory_table[slot].hash == hash && filename_directory_table[slot].count == levels &&
+					memcmp(filename_directory_table[slot].components, name->components, levels * sizeof(char *)) == 0) {
+				found = true;
+				break;
+			}
+
+			slot = (slot + 1) & (filename_directory_table_size - 1);
+		}
+	}
+
+	pthread_mutex_unlock(&filename_directory_lock);
 
-	return new_node;
+	return found;
 }
 
 /**
- * Destroy a node, freeing the memory that it uses.
+ * Add a directory to the created directory table. If there's no memory
+ * to record it, the directory is simply checked on disc again next time.
  *
- * \param *node		Pointer to the node to be destroyed.
+ * \param *name			The filename instance holding the directory.
+ * \param levels		The number of components of the name which
+ *				make up the directory.
+ * \param hash			The hash of the directory's component pointers.
  */
 
-static void filename_destroy_node(struct filename_node *node)
+static void filename_add_directory(struct filename *name, size_t levels, uint64_t hash)
 {
-	if (node == NULL)
+	size_t	slot;
+	char	**components = NULL;
+
+	pthread_mutex_lock(&filename_directory_lock);
+
+	if ((filename_directory_table_count + 1) * FILENAME_TABLE_DIVISOR > filename_directory_table_size * FILENAME_TABLE_LIMIT &&
+			!filename_grow_directory_table()) {
+		pthread_mutex_unlock(&filename_directory_lock);
 		return;
+	}
+
+	slot = hash & (filename_directory_table_size - 1);
+
+	while (filename_directory_table[slot].components != NULL) {
+		if (filename_directory_table[slot].hash == hash && filename_directory_table[slot].count == levels &&
+				memcmp(filename_directory_table[slot].components, name->components, levels * sizeof(char *)) == 0) {
+			pthread_mutex_unlock(&filename_directory_lock);
+			return;
+		}
+
+		slot = (slot + 1) & (filename_directory_table_size - 1);
+	}
+
+	components = malloc(levels * sizeof(char *));
 
-	if (node->name != NULL)
-		free(node->name);
+	if (components != NULL) {
+		memcpy(components, name->components, levels * sizeof(char *));
 
-	free(node);
+		filename_directory_table[slot].components = components;
+		filename_directory_table[slot].count = levels;
+		filename_directory_table[slot].hash = hash;
+		filename_directory_table_count++;
+	}
+
+	pthread_mutex_unlock(&filename_directory_lock);
+}
+
+/**
+ * Double the size of the created directory table, rehashing its contents.
+ * The directory lock must be held by the caller.
+ *
+ * \return			True if successful; False on failure.
+ */
+
+static bool filename_grow_directory_table(void)
+{
+	struct filename_directory	*table = NULL;
+	size_t				size, slot, i;
+
+	size = (filename_directory_table_size > 0) ? filename_directory_table_size * 2 : FILENAME_DIRECTORY_TABLE_SIZE;
+
+	table = calloc(size, sizeof(struct filename_directory));
+	if (table == NULL)
+		return false;
+
+	for (i = 0; i < filename_directory_table_size; i++) {
+		if (filename_directory_table[i].components == NULL)
+			continue;
+
+		slot = filename_directory_table[i].hash & (size - 1);
+
+		while (table[slot].components != NULL)
+			slot = (slot + 1) & (size - 1);
+
+		table[slot] = filename_directory_table[i];
+	}
+
+	free(filename_directory_table);
+
+	filename_directory_table = table;
+	filename_directory_table_size = size;
+
+	return true;
 }
 
 /**
@@ -31,8 +31,16 @@
 #define XMLMAN_FILENAME_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
+/**
+ * The name which refers to the standard input or output streams, in
+ * place of a file on disc.
+ */
+
+#define FILENAME_STDIO "-"
+
 /**
  * A filename instance.
  */
@@ -99,7 +107,9 @@ enum filename_filetype {
 	FILENAME_FILETYPE_NONE,
 	FILENAME_FILETYPE_TEXT,
 	FILENAME_FILETYPE_HTML,
-	FILENAME_FILETYPE_STRONGHELP
+	FILENAME_FILETYPE_CSS,
+	FILENAME_FILETYPE_STRONGHELP,
+	FILENAME_FILETYPE_DATA
 };
 
 /**
@@ -123,7 +133,9 @@ struct filename *filename_make(char *name, enum filename_type type, enum filenam
 void filename_destroy(struct filename *name);
 
 /**
- * Open a file using a filename instance.
+ * Open a file using a filename instance. A name of FILENAME_STDIO
+ * returns stdin or stdout, depending on the mode, which must not be
+ * closed by the caller.
  *
  * \param *name			The instance to open.
  * \param *mode			The required read/write mode.
@@ -135,7 +147,8 @@ FILE *filename_fopen(struct filename *name, const char *mode);
 /**
  * Create a directory, and optionally any intermediate directories which are
  * required. If the intermediate directories are not created, the call will fail
- * if they do not exist.
+ * if they do not exist. Directories which have already been created are
+ * remembered, and not created again until filename_mkdir_reset() is called.
  *
  * \param *name			A filename instance referring to the directory
  *				to be created.
@@ -146,6 +159,13 @@ FILE *filename_fopen(struct filename *name, const char *mode);
 
 bool filename_mkdir(struct filename *name, bool intermediate);
 
+/**
+ * Forget all of the directories which filename_mkdir() has created, so
+ * that they will be checked on disc again when next required.
+ */
+
+void filename_mkdir_reset(void);
+
 /**
  * Set the RISC OS filetype of a file
  *
@@ -157,6 +177,18 @@ bool filename_mkdir(struct filename *name, bool intermediate);
 
 bool filename_set_type(struct filename *name, enum filename_filetype type);
 
+/**
+ * Read a stamp for a file, combining its modification time and size,
+ * which will change whenever the file is written.
+ *
+ * \param *name 		A filename instance referring to the file
+ *				which is to be read.
+ * \param *stamp		Pointer to a variable to take the stamp.
+ * \return			True if the stamp was read; else False.
+ */
+
+bool filename_get_stamp(struct filename *name, uint64_t *stamp);
+
 /**
  * Dump the contents of a filename instance for debug purposes.
  *
@@ -241,6 +273,16 @@ struct filename *filename_get_relative(struct filename *from, struct filename *t
 
 bool filename_is_empty(struct filename *name);
 
+/**
+ * Test a filename to see if it refers to the standard input or output
+ * streams, by being FILENAME_STDIO alone.
+ *
+ * \param *name			The filename instance to be tested.
+ * \return			True if the name is a stream; otherwise false.
+ */
+
+bool filename_is_stdio(struct filename *name);
+
 /**
  * Convert a filename instance into a string suitable for a given target
  * platform. Conversion between platforms of root filenames is unlikely
@@ -31,17 +31,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+
+#include "list_numbers.h"
 
 #include "encoding.h"
 #include "msg.h"
 
-/**
- * The size of a list number buffer, which should be sufficient
- * to hold all of the possible values expressed in UTF-8.
- */
-
-#define LIST_NUMBERS_BUFFER_LEN 20
-
 /**
  * The maximum list entry number that we support.
  *
@@ -52,6 +48,20 @@
 
 #define LIST_NUMBERS_MAX_VALUE 3999
 
+/**
+ * The number of alphabetic and Roman labels held in the label cache,
+ * starting from 1, which covers the lengths of most lists.
+ */
+
+#define LIST_NUMBERS_CACHE_SIZE 100
+
+/**
+ * The size of a cached label, which is sufficient for the longest
+ * alphabetic or Roman label in the cache.
+ */
+
+#define LIST_NUMBERS_CACHE_LEN 12
+
 /**
  * The types of list.
  */
@@ -65,6 +75,18 @@ enum list_numbers_type {
 	LIST_NUMBERS_TYPE_ROMAN_UPPER
 };
 
+/**
+ * The styles of label held in the label cache.
+ */
+
+enum list_numbers_cache_style {
+	LIST_NUMBERS_CACHE_LOWER,
+	LIST_NUMBERS_CACHE_UPPER,
+	LIST_NUMBERS_CACHE_ROMAN_LOWER,
+	LIST_NUMBERS_CACHE_ROMAN_UPPER,
+	LIST_NUMBERS_CACHE_STYLES
+};
+
 /**
  * A list instance implementation.
  */
@@ -92,6 +114,12 @@ struct list_numbers {
 	 * The text is held in UTF-8 format.
 	 */
 	char		buffer[LIST_NUMBERS_BUFFER_LEN];
+
+	/**
+	 * The next instance in the calling thread's list of free
+	 * instances, once the instance has been destroyed.
+	 */
+	struct list_numbers	*next;
 };
 
 /* Static Global Variables. */
@@ -126,12 +154,42 @@ static char *list_numbers_roman_upper_symbols[] = { "I", "IV", "V", "IX", "X", "
  */
 static char *list_numbers_roman_lower_symbols[] = { "i", "iv", "v", "ix", "x", "xl", "l", "xc", "c", "cd", "d", "cm", "m" };
 
+/**
+ * The cache of precomputed alphabetic and Roman labels, indexed by style
+ * and then by value - 1.
+ */
+static char list_numbers_cache[LIST_NUMBERS_CACHE_STYLES][LIST_NUMBERS_CACHE_SIZE][LIST_NUMBERS_CACHE_LEN];
+
+/**
+ * Control for the one-time building of the label cache.
+ */
+static pthread_once_t list_numbers_cache_once = PTHREAD_ONCE_INIT;
+
+/**
+ * The key holding each thread's list of free instances, so that
+ * instances can be reused from one list to the next.
+ */
+static pthread_key_t list_numbers_free_key;
+
+/**
+ * Control for the one-time creation of the free instance key.
+ */
+static pthread_once_t list_numbers_free_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the free instance key was created successfully.
+ */
+static bool list_numbers_free_key_valid = false;
 
 /* Static Function Prototypes. */
 
-static char *list_numbers_build_numeric(struct list_numbers *instance);
-static char *list_numbers_build_alphabetic(struct list_numbers *instance, bool upper_case);
-static char *list_numbers_build_roman(struct list_numbers *instance, bool upper_case);
+static struct list_numbers *list_numbers_claim_instance(void);
+static void list_numbers_create_free_key(void);
+static void list_numbers_free_instances(void *data);
+static void list_numbers_build_cache(void);
+static char *list_numbers_build_numeric(char *buffer, size_t length, int value);
+static char *list_numbers_build_alphabetic(char *buffer, size_t length, int value, bool upper_case);
+static char *list_numbers_build_roman(char *buffer, size_t length, int value, bool upper_case);
 
 /**
  * Create a new unordered list instance at a specific level.
@@ -149,51 +207,104 @@ static char *list_numbers_build_roman(struct list_numbers *instance, bool upper_
 struct list_numbers *list_numbers_create_unordered(char *bullets[], int level)
 {
 	struct list_numbers *new = NULL;
+
+	/* Claim and initialise the instance block. */
+
+	new = list_numbers_claim_instance();
+	if (new == NULL)
+		return NULL;
+
+	if (!list_numbers_reset_unordered(new, bullets, level)) {
+		list_numbers_destroy(new);
+		return NULL;
+	}
+
+	return new;
+}
+
+/**
+ * Create a new ordered list instance at a specific level.
+ * 
+ * \param length	The length of the list, in terms of the number of
+ *			entries.
+ * \param level		The level of the list, for pointer selection.
+ * \return		The new list instance, or NULL on failure.
+ */
+
+struct list_numbers *list_numbers_create_ordered(int length, int level)
+{
+	struct list_numbers *new = NULL;
+
+	/* Claim and initialise the instance block. */
+
+	new = list_numbers_claim_instance();
+	if (new == NULL)
+		return NULL;
+
+	if (!list_numbers_reset_ordered(new, length, level)) {
+		list_numbers_destroy(new);
+		return NULL;
+	}
+
+	return new;
+}
+
+/**
+ * Reset an existing instance to number a new unordered list at a
+ * specific level, as if it had just been created.
+ *
+ * \param *instance	The instance to be reset.
+ * \param *bullets[]	Pointer to an array of bullet texts, terminated by
+ *			a NULL pointer.
+ * \param level		The level of the list, for pointer selection.
+ * \return		True if successful; False on failure.
+ */
+
+bool list_numbers_reset_unordered(struct list_numbers *instance, char *bullets[], int level)
+{
 	int bullet_count = 0;
 
+	if (instance == NULL)
+		return false;
+
 	/* Identify the bullet that we want to use. */
 
 	if (bullets == NULL)
-		return NULL;
+		return false;
 
 	while (bullets[bullet_count] != NULL) {
 		bullet_count++;
 	}
 
 	if (bullet_count == 0)
-		return NULL;
+		return false;
 
-	/* Allocate and initialise the instance block. */
-
-	new = malloc(sizeof(struct list_numbers));
-	if (new == NULL)
-		return NULL;
-
-	new->type = LIST_NUMBERS_TYPE_UNORDERED;
-	new->current_value = 0;
+	instance->type = LIST_NUMBERS_TYPE_UNORDERED;
+	instance->current_value = 0;
 
 	/* Copy the selected bullet into the buffer, and find its length. */
 
-	strncpy(new->buffer, bullets[level % bullet_count], LIST_NUMBERS_BUFFER_LEN);
-	new->buffer[LIST_NUMBERS_BUFFER_LEN - 1] = '\0';
+	strncpy(instance->buffer, bullets[level % bullet_count], LIST_NUMBERS_BUFFER_LEN);
+	instance->buffer[LIST_NUMBERS_BUFFER_LEN - 1] = '\0';
 
-	new->max_length = encoding_get_utf8_string_length(new->buffer);
+	instance->max_length = encoding_get_utf8_string_length(instance->buffer);
 
-	return new;
+	return true;
 }
 
 /**
- * Create a new ordered list instance at a specific level.
- * 
+ * Reset an existing instance to number a new ordered list at a
+ * specific level, as if it had just been created.
+ *
+ * \param *instance	The instance to be reset.
  * \param length	The length of the list, in terms of the number of
  *			entries.
  * \param level		The level of the list, for pointer selection.
- * \return		The new list instance, or NULL on failure.
+ * \return		True if successful; False on failure.
  */
 
-struct list_numbers *list_numbers_create_ordered(int length, int level)
+bool list_numbers_reset_ordered(struct list_numbers *instance, int length, int level)
 {
-	struct list_numbers *new = NULL;
 	enum list_numbers_type bullets[] = {
 			LIST_NUMBERS_TYPE_NUMERIC,
 			LIST_NUMBERS_TYPE_LOWER,
@@ -204,24 +315,21 @@ struct list_numbers *list_numbers_create_ordered(int length, int level)
 	int bullet_count = 5;
 	int i = 0, *break_points;
 
+	if (instance == NULL)
+		return false;
+
 	/* Check the proposed length of the list. */
 
 	if (length > LIST_NUMBERS_MAX_VALUE) {
 		msg_report(MSG_LIST_TOO_LONG);
-		return NULL;
+		return false;
 	}
 
-	/* Allocate and initialise the instance block. */
-
-	new = malloc(sizeof(struct list_numbers));
-	if (new == NULL)
-		return NULL;
-
-	new->current_value = 0;
+	instance->current_value = 0;
 
 	/* Initialise the buffer. */
 
-	new->buffer[0] = '\0';
+	instance->buffer[0] = '\0';
 
 	/* Find the length of the longest entry.
 	 *
@@ -231,9 +339,9 @@ struct list_numbers *list_numbers_create_ordered(int length, int level)
 	 * it steps to 2, and so on.
 	 */
 
-	new->type = bullets[level % bullet_count];
+	instance->type = bullets[level % bullet_count];
 
-	switch (new->type) {
+	switch (instance->type) {
 	case LIST_NUMBERS_TYPE_NUMERIC:
 		break_points = list_numbers_numeric_length_points;
 		break;
@@ -246,20 +354,20 @@ struct list_numbers *list_numbers_create_ordered(int length, int level)
 		break_points = list_numbers_roman_length_points;
 		break;
 	default:
-		free(new);
-		return NULL;
+		return false;
 	}
 
 	while (length >= break_points[i] && break_points[i] >= 0)
 		i++;
 
-	new->max_length = i + 1; /* Add one extra for a . terminator. */
+	instance->max_length = i + 1; /* Add one extra for a . terminator. */
 
-	return new;
+	return true;
 }
 
 /**
- * Destroy a list numbers instance.
+ * Destroy a list numbers instance. The instance is kept by the calling
+ * thread, to be reused by the next list that it creates.
  * 
  * \param *instance	The instance to be destroyed.
  */
@@ -269,6 +377,15 @@ void list_numbers_destroy(struct list_numbers *instance)
 	if (instance == NULL)
 		return;
 
+	pthread_once(&list_numbers_free_once, list_numbers_create_free_key);
+
+	if (list_numbers_free_key_valid) {
+		instance->next = pthread_getspecific(list_numbers_free_key);
+
+		if (pthread_setspecific(list_numbers_free_key, instance) == 0)
+			return;
+	}
+
 	free(instance);
 }
 
@@ -298,6 +415,8 @@ int list_numbers_get_max_length(struct list_numbers *instance)
 
 char *list_numbers_get_next_entry(struct list_numbers *instance)
 {
+	int value;
+
 	if (instance == NULL)
 		return NULL;
 
@@ -308,19 +427,38 @@ char *list_numbers_get_next_entry(struct list_numbers *instance)
 		return instance->buffer;
 	}
 
+	value = instance->current_value;
+
+	/* Common alphabetic and Roman labels come from the cache. */
+
+	if (value <= LIST_NUMBERS_CACHE_SIZE)
+		pthread_once(&list_numbers_cache_once, list_numbers_build_cache);
+
 	/* Build and return the next number. */
 
 	switch (instance->type) {
 	case LIST_NUMBERS_TYPE_NUMERIC:
-		return list_numbers_build_numeric(instance);
+		return list_numbers_build_numeric(instance->buffer, LIST_NUMBERS_BUFFER_LEN, value);
 
 	case LIST_NUMBERS_TYPE_LOWER:
+		if (value <= LIST_NUMBERS_CACHE_SIZE)
+			return list_numbers_cache[LIST_NUMBERS_CACHE_LOWER][value - 1];
+		return list_numbers_build_alphabetic(instance->buffer, LIST_NUMBERS_BUFFER_LEN, value, false);
+
 	case LIST_NUMBERS_TYPE_UPPER:
-		return list_numbers_build_alphabetic(instance, (instance->type == LIST_NUMBERS_TYPE_UPPER) ? true : false);
+		if (value <= LIST_NUMBERS_CACHE_SIZE)
+			return list_numbers_cache[LIST_NUMBERS_CACHE_UPPER][value - 1];
+		return list_numbers_build_alphabetic(instance->buffer, LIST_NUMBERS_BUFFER_LEN, value, true);
 
 	case LIST_NUMBERS_TYPE_ROMAN_LOWER:
+		if (value <= LIST_NUMBERS_CACHE_SIZE)
+			return list_numbers_cache[LIST_NUMBERS_CACHE_ROMAN_LOWER][value - 1];
+		return list_numbers_build_roman(instance->buffer, LIST_NUMBERS_BUFFER_LEN, value, false);
+
 	case LIST_NUMBERS_TYPE_ROMAN_UPPER:
-		return list_numbers_build_roman(instance, (instance->type == LIST_NUMBERS_TYPE_ROMAN_UPPER) ? true : false);
+		if (value <= LIST_NUMBERS_CACHE_SIZE)
+			return list_numbers_cache[LIST_NUMBERS_CACHE_ROMAN_UPPER][value - 1];
+		return list_numbers_build_roman(instance->buffer, LIST_NUMBERS_BUFFER_LEN, value, true);
 
 	case LIST_NUMBERS_TYPE_UNORDERED:
 		break;
@@ -333,87 +471,199 @@ char *list_numbers_get_next_entry(struct list_numbers *instance)
 	return instance->buffer;
 }
 
+/**
+ * Write the next entry in a list of numbers or bullets into a buffer
+ * supplied by the caller. The text is in UTF-8 format.
+ *
+ * \param *instance	The instance to be queried.
+ * \param *buffer	Pointer to the buffer to take the entry.
+ * \param length	The size of the buffer, in bytes.
+ * \return		True if successful; False if the entry didn't fit.
+ */
+
+bool list_numbers_write_next_entry(struct list_numbers *instance, char *buffer, size_t length)
+{
+	char	*entry;
+	size_t	size;
+
+	if (buffer == NULL || length == 0)
+		return false;
+
+	buffer[0] = '\0';
+
+	entry = list_numbers_get_next_entry(instance);
+	if (entry == NULL)
+		return false;
+
+	size = strlen(entry) + 1;
+	if (size > length)
+		return false;
+
+	memcpy(buffer, entry, size);
+
+	return true;
+}
+
+/**
+ * Claim an instance block, reusing one destroyed by the calling thread
+ * if there is one, or allocating a new one if not.
+ *
+ * \return		Pointer to the instance block, or NULL on failure.
+ */
+
+static struct list_numbers *list_numbers_claim_instance(void)
+{
+	struct list_numbers *instance = NULL;
+
+	pthread_once(&list_numbers_free_once, list_numbers_create_free_key);
+
+	if (list_numbers_free_key_valid)
+		instance = pthread_getspecific(list_numbers_free_key);
+
+	if (instance != NULL && pthread_setspecific(list_numbers_free_key, instance->next) == 0)
+		return instance;
+
+	return malloc(sizeof(struct list_numbers));
+}
+
+/**
+ * Create the key used to hold each thread's list of free instances, on
+ * behalf of pthread_once(). The instances are freed when their threads
+ * exit.
+ */
+
+static void list_numbers_create_free_key(void)
+{
+	if (pthread_key_create(&list_numbers_free_key, list_numbers_free_instances) == 0)
+		list_numbers_free_key_valid = true;
+}
+
+/**
+ * Free a thread's list of free instances, on behalf of the thread key's
+ * destructor.
+ *
+ * \param *data		Pointer to the first instance in the list.
+ */
+
+static void list_numbers_free_instances(void *data)
+{
+	struct list_numbers *instance = data, *next;
+
+	while (instance != NULL) {
+		next = instance->next;
+		free(instance);
+		instance = next;
+	}
+}
+
+/**
+ * Build the cache of alphabetic and Roman labels, on behalf of
+ * pthread_once().
+ */
+
+static void list_numbers_build_cache(void)
+{
+	char	buffer[LIST_NUMBERS_BUFFER_LEN];
+	int	value;
+
+	for (value = 1; value <= LIST_NUMBERS_CACHE_SIZE; value++) {
+		strncpy(list_numbers_cache[LIST_NUMBERS_CACHE_LOWER][value - 1],
+				list_numbers_build_alphabetic(buffer, LIST_NUMBERS_BUFFER_LEN, value, false), LIST_NUMBERS_CACHE_LEN - 1);
+		strncpy(list_numbers_cache[LIST_NUMBERS_CACHE_UPPER][value - 1],
+				list_numbers_build_alphabetic(buffer, LIST_NUMBERS_BUFFER_LEN, value, true), LIST_NUMBERS_CACHE_LEN - 1);
+		strncpy(list_numbers_cache[LIST_NUMBERS_CACHE_ROMAN_LOWER][value - 1],
+				list_numbers_build_roman(buffer, LIST_NUMBERS_BUFFER_LEN, value, false), LIST_NUMBERS_CACHE_LEN - 1);
+		strncpy(list_numbers_cache[LIST_NUMBERS_CACHE_ROMAN_UPPER][value - 1],
+				list_numbers_build_roman(buffer, LIST_NUMBERS_BUFFER_LEN, value, true), LIST_NUMBERS_CACHE_LEN - 1);
+	}
+}
+
 /**
  * Build a numeric list number, and return a pointer to it.
  *
- * \param *instance	Pointer to the instance to use.
+ * \param *buffer	Pointer to the buffer to build the number in.
+ * \param length	The size of the buffer.
+ * \param value		The value to be built.
  * \return		Pointer to the numeric number.
  */
 
-static char *list_numbers_build_numeric(struct list_numbers *instance)
+static char *list_numbers_build_numeric(char *buffer, size_t length, int value)
 {
-	snprintf(instance->buffer, LIST_NUMBERS_BUFFER_LEN, "%d.", instance->current_value);
-	instance->buffer[LIST_NUMBERS_BUFFER_LEN - 1] = '\0';
+	snprintf(buffer, length, "%d.", value);
+	buffer[length - 1] = '\0';
 
-	return instance->buffer;
+	return buffer;
 }
 
 /**
- * Build a alphabetic list number, and return a pointer to it.
+ * Build a alphabetic list number, and return a pointer to it. The
+ * number is built at the end of the buffer.
  *
- * \param *instance	Pointer to the instance to use.
+ * \param *buffer	Pointer to the buffer to build the number in.
+ * \param length	The size of the buffer.
+ * \param value		The value to be built.
  * \param upper_case	True if the number should be in upper case;
  *			else false for lower case.
  * \return		Pointer to the alphabetic number.
  */
 
-static char *list_numbers_build_alphabetic(struct list_numbers *instance, bool upper_case)
+static char *list_numbers_build_alphabetic(char *buffer, size_t length, int value, bool upper_case)
 {
-	int i = LIST_NUMBERS_BUFFER_LEN, value;
+	int i = length;
 	char base;
 
-	value = instance->current_value;
 	base = (upper_case == true) ? 'A' : 'a';
 
-	instance->buffer[--i] = '\0';
-	instance->buffer[--i] = '.';
+	buffer[--i] = '\0';
+	buffer[--i] = '.';
 
 	if (i <= 0 || value <= 0)
-		return instance->buffer;
+		return buffer + i;
 
 	do {
 		value--;
-		instance->buffer[--i] = base + (value % 26);
+		buffer[--i] = base + (value % 26);
 		value = value / 26;
 	} while (value > 0 && i > 0);
 
-	return instance->buffer + i;
+	return buffer + i;
 }
 
 /**
  * Build a Roman list number, and return a pointer to it.
  *
- * \param *instance	Pointer to the instance to use.
+ * \param *buffer	Pointer to the buffer to build the number in.
+ * \param length	The size of the buffer.
+ * \param value		The value to be built.
  * \param upper_case	True if the number should be in upper case;
  *			else false for lower case.
  * \return		Pointer to the Roman number.
  */
 
-static char *list_numbers_build_roman(struct list_numbers *instance, bool upper_case)
+static char *list_numbers_build_roman(char *buffer, size_t length, int value, bool upper_case)
 {
-	int i = 12, value, div;
+	int i = 12, div;
+	size_t used = 0;
 	char **symbols;
 
-	value = instance->current_value;
 	symbols = (upper_case == true) ? list_numbers_roman_upper_symbols : list_numbers_roman_lower_symbols;
 
-	instance->buffer[0] = '\0';
-
 	while (value > 0 && i >= 0) {
 		div = value / list_numbers_roman_break_points[i];
 		value %= list_numbers_roman_break_points[i];
 
-		// "-4" to leave space in buffer for trailing . and \0 terminator after adding 2 chars.
+		/* Leave space in the buffer for the trailing . and \0 terminator. */
 
-		while (div-- > 0 && strlen(instance->buffer) < (LIST_NUMBERS_BUFFER_LEN - 4))
-			strncat(instance->buffer, symbols[i], 2);
+		while (div-- > 0 && used + strlen(symbols[i]) + 2 <= length) {
+			strcpy(buffer + used, symbols[i]);
+			used += strlen(symbols[i]);
+		}
 
 		i--;
 	}
-	
-	strncat(instance->buffer, ".", 1);
 
-	instance->buffer[LIST_NUMBERS_BUFFER_LEN - 1] = '\0';
+	buffer[used++] = '.';
+	buffer[used] = '\0';
 
-	return instance->buffer;
-}
\ No newline at end of file
+	return buffer;
+}
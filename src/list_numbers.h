@@ -31,6 +31,14 @@
 #define XMLMAN_LIST_NUMBERS_H
 
 #include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The size of a list number buffer, which should be sufficient
+ * to hold all of the possible values expressed in UTF-8.
+ */
+
+#define LIST_NUMBERS_BUFFER_LEN 20
 
 /**
  * A list numbers instance.
@@ -65,7 +73,34 @@ struct list_numbers *list_numbers_create_unordered(char *bullets[], int level);
 struct list_numbers *list_numbers_create_ordered(int length, int level);
 
 /**
- * Destroy a list numbers instance.
+ * Reset an existing instance to number a new unordered list at a
+ * specific level, as if it had just been created.
+ *
+ * \param *instance	The instance to be reset.
+ * \param *bullets[]	Pointer to an array of bullet texts, terminated by
+ *			a NULL pointer.
+ * \param level		The level of the list, for pointer selection.
+ * \return		True if successful; False on failure.
+ */
+
+bool list_numbers_reset_unordered(struct list_numbers *instance, char *bullets[], int level);
+
+/**
+ * Reset an existing instance to number a new ordered list at a
+ * specific level, as if it had just been created.
+ *
+ * \param *instance	The instance to be reset.
+ * \param length	The length of the list, in terms of the number of
+ *			entries.
+ * \param level		The level of the list, for pointer selection.
+ * \return		True if successful; False on failure.
+ */
+
+bool list_numbers_reset_ordered(struct list_numbers *instance, int length, int level);
+
+/**
+ * Destroy a list numbers instance. The instance is kept by the calling
+ * thread, to be reused by the next list that it creates.
  * 
  * \param *instance	The instance to be destroyed.
  */
@@ -92,4 +127,17 @@ int list_numbers_get_max_length(struct list_numbers *instance);
 
 char *list_numbers_get_next_entry(struct list_numbers *instance);
 
+/**
+ * Write the next entry in a list of numbers or bullets into a buffer
+ * supplied by the caller. The text is in UTF-8 format.
+ *
+ * \param *instance	The instance to be queried.
+ * \param *buffer	Pointer to the buffer to take the entry, which
+ *			should be LIST_NUMBERS_BUFFER_LEN bytes long.
+ * \param length	The size of the buffer, in bytes.
+ * \return		True if successful; False if the entry didn't fit.
+ */
+
+bool list_numbers_write_next_entry(struct list_numbers *instance, char *buffer, size_t length);
+
 #endif
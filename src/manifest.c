@@ -0,0 +1,804 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manifest.c
+ *
+ * Incremental Build Manifest, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "manifest.h"
+
+#include "xmlman.h"
+#include "encoding.h"
+#include "filename.h"
+#include "manual_data.h"
+#include "modes.h"
+#include "msg.h"
+#include "string.h"
+
+/**
+ * The suffix added to an output name to give the name of its manifest.
+ */
+
+#define MANIFEST_SUFFIX "-manifest"
+
+/**
+ * The header line identifying a manifest file and its format version.
+ */
+
+#define MANIFEST_HEADER "XMLMan Manifest 1"
+
+/**
+ * The longest line which will be read from a manifest file.
+ */
+
+#define MANIFEST_MAX_LINE 4096
+
+/**
+ * The number of buckets in a manifest's path hash table.
+ */
+
+#define MANIFEST_HASH_SIZE 256
+
+/**
+ * An entry in a manifest, recording the signature of one output file.
+ */
+
+struct manifest_entry {
+	/**
+	 * The local path of the file, in a malloc() block.
+	 */
+
+	char			*path;
+
+	/**
+	 * The signature loaded from the previous manifest.
+	 */
+
+	uint64_t		old_signature;
+
+	/**
+	 * True if the previous manifest held a signature for the file.
+	 */
+
+	bool			old_valid;
+
+	/**
+	 * The signature calculated on the current run.
+	 */
+
+	uint64_t		new_signature;
+
+	/**
+	 * True if a signature has been calculated on the current run.
+	 */
+
+	bool			new_valid;
+
+	/**
+	 * Pointer to the next entry in the same hash bucket, or NULL.
+	 */
+
+	struct manifest_entry	*next;
+
+	/**
+	 * Pointer to the next entry to be saved, or NULL.
+	 */
+
+	struct manifest_entry	*next_saved;
+};
+
+/**
+ * A manifest instance.
+ */
+
+struct manifest {
+	/**
+	 * The local path of the manifest file, in a malloc() block.
+	 */
+
+	char			*path;
+
+	/**
+	 * The output mode being written.
+	 */
+
+	enum modes_type		type;
+
+	/**
+	 * The hash of the settings which apply to the whole output.
+	 */
+
+	uint64_t		context;
+
+	/**
+	 * The path hash table.
+	 */
+
+	struct manifest_entry	*table[MANIFEST_HASH_SIZE];
+
+	/**
+	 * The first entry to be saved, or NULL.
+	 */
+
+	struct manifest_entry	*first_saved;
+
+	/**
+	 * The last entry to be saved, or NULL.
+	 */
+
+	struct manifest_entry	*last_saved;
+
+	/**
+	 * Lock protecting the entries, when files are checked from more
+	 * than one thread.
+	 */
+
+	pthread_mutex_t		lock;
+};
+
+/**
+ * True if incremental builds are enabled.
+ */
+
+static bool manifest_enabled = false;
+
+/* Static Function Prototypes. */
+
+static void manifest_load(struct manifest *manifest);
+static struct manifest_entry *manifest_find_entry(struct manifest *manifest, char *path, bool create);
+static uint64_t manifest_hash_object(struct manifest *manifest, uint64_t hash, struct manual_data *object, bool root);
+static uint64_t manifest_hash_identity(struct manifest *manifest, uint64_t hash, struct manual_data *object);
+static uint64_t manifest_hash_contents(struct manifest *manifest, uint64_t hash, struct manual_data *object);
+static uint64_t manifest_hash_resources(struct manifest *manifest, uint64_t hash, struct manual_data_resources *resources);
+static uint64_t manifest_hash_mode(uint64_t hash, struct manual_data_mode *mode);
+static uint64_t manifest_hash_filename(uint64_t hash, struct filename *name);
+static uint64_t manifest_hash_text(uint64_t hash, char *text);
+static uint64_t manifest_hash_value(uint64_t hash, int value);
+static char *manifest_get_id(struct manual_data *object);
+
+/**
+ * Initialise the manifest system. This must be called before any
+ * output jobs are started.
+ *
+ * \param enabled	True if incremental builds are enabled; otherwise
+ *			no manifests will be opened.
+ */
+
+void manifest_initialise(bool enabled)
+{
+	manifest_enabled = enabled;
+}
+
+/**
+ * Open the manifest for an output, loading any entries which were
+ * saved by a previous run with the same settings.
+ *
+ * \param *target	The folder or file to which the output is written.
+ * \param type		The output mode being written.
+ * \param encoding	The encoding selected for the output.
+ * \param line_end	The line ending selected for the output.
+ * \return		Pointer to the new manifest, or NULL if incremental
+ *			builds are disabled or the manifest can't be used.
+ */
+
+struct manifest *manifest_open(struct filename *target, enum modes_type type,
+		enum encoding_target encoding, enum encoding_line_end line_end)
+{
+	struct manifest	*manifest;
+	char		*name;
+	int		i;
+
+	if (manifest_enabled == false || target == NULL)
+		return NULL;
+
+	manifest = malloc(sizeof(struct manifest));
+	if (manifest == NULL) {
+		msg_report(MSG_MANIFEST_NO_MEM);
+		return NULL;
+	}
+
+	for (i = 0; i < MANIFEST_HASH_SIZE; i++)
+		manifest->table[i] = NULL;
+
+	manifest->first_saved = NULL;
+	manifest->last_saved = NULL;
+	manifest->type = type;
+
+	/* The manifest lives next to the output, taking its name. */
+
+	name = filename_convert(target, FILENAME_PLATFORM_LOCAL, 0);
+	if (name == NULL) {
+		free(manifest);
+		return NULL;
+	}
+
+	manifest->path = malloc(strlen(name) + strlen(MANIFEST_SUFFIX) + 1);
+	if (manifest->path == NULL) {
+		msg_report(MSG_MANIFEST_NO_MEM);
+		free(name);
+		free(manifest);
+		return NULL;
+	}
+
+	strcpy(manifest->path, name);
+	strcat(manifest->path, MANIFEST_SUFFIX);
+	free(name);
+
+	if (pthread_mutex_init(&(manifest->lock), NULL) != 0) {
+		msg_report(MSG_MANIFEST_NO_MEM);
+		free(manifest->path);
+		free(manifest);
+		return NULL;
+	}
+
+	/* Anything which changes every file in the output goes into the context. */
+
+	manifest->context = manifest_hash_text(STRING_HASH_INITIAL, BUILD_VERSION);
+	manifest->context = manifest_hash_value(manifest->context, type);
+	manifest->context = manifest_hash_value(manifest->context, encoding);
+	manifest->context = manifest_hash_value(manifest->context, line_end);
+
+	manifest_load(manifest);
+
+	return manifest;
+}
+
+/**
+ * Record the signature of a file which is about to be written, and test
+ * whether the existing copy of the file is up to date. If it is, the
+ * file does not need to be written again.
+ *
+ * \param *manifest	The manifest to update, or NULL.
+ * \param *node		The node at the root of the file.
+ * \param *filename	The full name of the file.
+ * \return		True if the existing file is up to date; otherwise
+ *			False.
+ */
+
+bool manifest_check_file(struct manifest *manifest, struct manual_data *node, struct filename *filename)
+{
+	struct manifest_entry	*entry;
+	uint64_t		signature;
+	char			*path;
+	FILE			*file;
+	bool			current = false;
+
+	if (manifest == NULL || node == NULL || filename == NULL)
+		return false;
+
+	path = filename_convert(filename, FILENAME_PLATFORM_LOCAL, 0);
+	if (path == NULL)
+		return false;
+
+	signature = manifest_hash_identity(manifest, manifest->context, node);
+	signature = manifest_hash_object(manifest, signature, node, true);
+
+	pthread_mutex_lock(&(manifest->lock));
+
+	entry = manifest_find_entry(manifest, path, true);
+	if (entry == NULL) {
+		pthread_mutex_unlock(&(manifest->lock));
+		free(path);
+		return false;
+	}
+
+	current = (entry->old_valid && entry->old_signature == signature) ? true : false;
+
+	/* Record the new signature, to be saved at the end of the run. */
+
+	if (entry->new_valid == false) {
+		if (manifest->last_saved != NULL)
+			manifest->last_saved->next_saved = entry;
+		else
+			manifest->first_saved = entry;
+
+		manifest->last_saved = entry;
+	}
+
+	entry->new_signature = signature;
+	entry->new_valid = true;
+
+	pthread_mutex_unlock(&(manifest->lock));
+
+	/* The file is only current if it is still there to be reused. */
+
+	if (current) {
+		file = fopen(path, "rb");
+		if (file != NULL)
+			fclose(file);
+		else
+			current = false;
+	}
+
+	if (current)
+		msg_report(MSG_MANIFEST_UNCHANGED, path);
+
+	free(path);
+
+	return current;
+}
+
+/**
+ * Close a manifest, saving the signatures recorded during the current
+ * run if required, and free its memory.
+ *
+ * \param *manifest	The manifest to close, or NULL.
+ * \param save		True to save the manifest; False to discard it
+ *			and leave any previous copy on disc untouched.
+ * \return		True if successful; otherwise False.
+ */
+
+bool manifest_close(struct manifest *manifest, bool save)
+{
+	struct manifest_entry	*entry, *next;
+	FILE			*file;
+	bool			result = true;
+	int			i;
+
+	if (manifest == NULL)
+		return true;
+
+	if (save == true) {
+		file = fopen(manifest->path, "w");
+
+		if (file != NULL) {
+			fprintf(file, "%s %016" PRIx64 "\n", MANIFEST_HEADER, manifest->context);
+
+			for (entry = manifest->first_saved; entry != NULL; entry = entry->next_saved)
+				fprintf(file, "%016" PRIx64 " %s\n", entry->new_signature, entry->path);
+
+			if (ferror(file))
+				result = false;
+
+			if (fclose(file) != 0)
+				result = false;
+		} else {
+			result = false;
+		}
+
+		if (result == false)
+			msg_report(MSG_MANIFEST_WRITE_FAIL, manifest->path);
+	}
+
+	for (i = 0; i < MANIFEST_HASH_SIZE; i++) {
+		entry = manifest->table[i];
+
+		while (entry != NULL) {
+			next = entry->next;
+			free(entry->path);
+			free(entry);
+			entry = next;
+		}
+	}
+
+	pthread_mutex_destroy(&(manifest->lock));
+
+	free(manifest->path);
+	free(manifest);
+
+	return result;
+}
+
+/**
+ * Load the entries from a previous copy of a manifest, if one exists
+ * on disc and was written with the same settings.
+ *
+ * \param *manifest	The manifest to load the entries into.
+ */
+
+static void manifest_load(struct manifest *manifest)
+{
+	struct manifest_entry	*entry;
+	FILE			*file;
+	char			line[MANIFEST_MAX_LINE], *path, *end;
+	uint64_t		signature;
+	size_t			length;
+
+	file = fopen(manifest->path, "r");
+	if (file == NULL)
+		return;
+
+	/* Check the header, and that the context hasn't changed. */
+
+	if (fgets(line, MANIFEST_MAX_LINE, file) == NULL ||
+			strncmp(line, MANIFEST_HEADER " ", strlen(MANIFEST_HEADER) + 1) != 0 ||
+			strtoull(line + strlen(MANIFEST_HEADER) + 1, NULL, 16) != manifest->context) {
+		fclose(file);
+		return;
+	}
+
+	/* Read the file signatures. */
+
+	while (fgets(line, MANIFEST_MAX_LINE, file) != NULL) {
+		length = strlen(line);
+		if (length == 0 || line[length - 1] != '\n')
+			continue;
+
+		line[length - 1] = '\0';
+
+		signature = strtoull(line, &end, 16);
+		if (end == line || *end != ' ')
+			continue;
+
+		path = end + 1;
+
+		entry = manifest_find_entry(manifest, path, true);
+		if (entry == NULL)
+			break;
+
+		entry->old_signature = signature;
+		entry->old_valid = true;
+	}
+
+	fclose(file);
+}
+
+/**
+ * Find the entry for a path in a manifest, optionally creating it
+ * if it doesn't already exist.
+ *
+ * \param *manifest	The manifest to search.
+ * \param *path		The path to find.
+ * \param create	True to create a new entry if one isn't found.
+ * \return		Pointer to the entry, or NULL.
+ */
+
+static struct manifest_entry *manifest_find_entry(struct manifest *manifest, char *path, bool create)
+{
+	struct manifest_entry	*entry;
+	int			bucket;
+
+	bucket = manifest_hash_text(STRING_HASH_INITIAL, path) % MANIFEST_HASH_SIZE;
+
+	for (entry = manifest->table[bucket]; entry != NULL; entry = entry->next) {
+		if (strcmp(entry->path, path) == 0)
+			return entry;
+	}
+
+	if (create == false)
+		return NULL;
+
+	entry = malloc(sizeof(struct manifest_entry));
+	if (entry == NULL) {
+		msg_report(MSG_MANIFEST_NO_MEM);
+		return NULL;
+	}
+
+	entry->path = strdup(path);
+	if (entry->path == NULL) {
+		msg_report(MSG_MANIFEST_NO_MEM);
+		free(entry);
+		return NULL;
+	}
+
+	entry->old_signature = 0;
+	entry->old_valid = false;
+	entry->new_signature = 0;
+	entry->new_valid = false;
+	entry->next_saved = NULL;
+
+	entry->next = manifest->table[bucket];
+	manifest->table[bucket] = entry;
+
+	return entry;
+}
+
+/**
+ * Add an object and its descendents into a file signature. Objects
+ * which will be written to files of their own only contribute the
+ * details which appear in the file linking to them.
+ *
+ * \param *manifest	The manifest to which the signature belongs.
+ * \param hash		The signature to add the object to.
+ * \param *object	The object to add.
+ * \param root		True if the object is at the root of the file.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_object(struct manifest *manifest, uint64_t hash, struct manual_data *object, bool root)
+{
+	struct manual_data	*child;
+	struct manual_data_mode	*resources;
+
+	if (object == NULL)
+		return manifest_hash_value(hash, -1);
+
+	hash = manifest_hash_value(hash, object->type);
+	hash = manifest_hash_value(hash, object->index);
+	hash = manifest_hash_object(manifest, hash, object->title, false);
+
+	switch (object->type) {
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		hash = manifest_hash_text(hash, object->chapter.id);
+
+		resources = modes_find_resources(object->chapter.resources, manifest->type);
+
+		if (!root && object->first_child != NULL && resources != NULL &&
+				(resources->filename != NULL || resources->folder != NULL)) {
+			hash = manifest_hash_mode(hash, resources);
+
+			if (object->chapter.resources != NULL)
+				hash = manifest_hash_object(manifest, hash, object->chapter.resources->summary, false);
+
+			return hash;
+		}
+
+		hash = manifest_hash_resources(manifest, hash, object->chapter.resources);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		hash = manifest_hash_text(hash, object->chapter.id);
+		hash = manifest_hash_object(manifest, hash, object->chapter.columns, false);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		hash = manifest_hash_text(hash, object->chapter.id);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION:
+		hash = manifest_hash_value(hash, object->chunk.width);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
+		hash = manifest_hash_contents(manifest, hash, object);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		hash = manifest_hash_value(hash, object->chunk.entity);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		hash = manifest_hash_text(hash, object->chunk.text);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		hash = manifest_hash_value(hash, object->flags);
+		hash = manifest_hash_text(hash, object->chunk.id);
+		hash = manifest_hash_identity(manifest, hash, object->chunk.target);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		hash = manifest_hash_value(hash, object->flags);
+		hash = manifest_hash_object(manifest, hash, object->chunk.link, false);
+		break;
+
+	default:
+		hash = manifest_hash_value(hash, object->flags);
+		break;
+	}
+
+	for (child = object->first_child; child != NULL; child = child->next)
+		hash = manifest_hash_object(manifest, hash, child, false);
+
+	return manifest_hash_value(hash, -1);
+}
+
+/**
+ * Add the identity of an object into a file signature: its location in
+ * the manual, which determines its number and the files which it and its
+ * ancestors are written to, along with its title.
+ *
+ * \param *manifest	The manifest to which the signature belongs.
+ * \param hash		The signature to add the identity to.
+ * \param *object	The object whose identity is to be added, or NULL.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_identity(struct manifest *manifest, uint64_t hash, struct manual_data *object)
+{
+	struct manual_data		*node;
+	struct manual_data_resources	*resources;
+
+	if (object == NULL)
+		return manifest_hash_value(hash, -1);
+
+	for (node = object; node != NULL; node = node->parent) {
+		hash = manifest_hash_value(hash, node->type);
+		hash = manifest_hash_value(hash, node->index);
+		hash = manifest_hash_text(hash, manifest_get_id(node));
+
+		switch (node->type) {
+		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+		case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		case MANUAL_DATA_OBJECT_TYPE_SECTION:
+			resources = node->chapter.resources;
+			if (resources != NULL) {
+				hash = manifest_hash_mode(hash, modes_find_resources(resources, manifest->type));
+				hash = manifest_hash_filename(hash, resources->images);
+				hash = manifest_hash_filename(hash, resources->downloads);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	return manifest_hash_object(manifest, hash, object->title, false);
+}
+
+/**
+ * Add the entries which will appear in a contents list into a file
+ * signature. The list covers the chain of objects containing the list's
+ * parent object.
+ *
+ * \param *manifest	The manifest to which the signature belongs.
+ * \param hash		The signature to add the contents to.
+ * \param *object	The contents object.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_contents(struct manifest *manifest, uint64_t hash, struct manual_data *object)
+{
+	struct manual_data *entry;
+
+	if (object->parent == NULL || object->parent->parent == NULL)
+		return hash;
+
+	for (entry = object->parent->parent->first_child; entry != NULL; entry = entry->next) {
+		switch (entry->type) {
+		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		case MANUAL_DATA_OBJECT_TYPE_SECTION:
+			hash = manifest_hash_identity(manifest, hash, entry);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return hash;
+}
+
+/**
+ * Add a resources block into a file signature.
+ *
+ * \param *manifest	The manifest to which the signature belongs.
+ * \param hash		The signature to add the resources to.
+ * \param *resources	The resources to add, or NULL.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_resources(struct manifest *manifest, uint64_t hash, struct manual_data_resources *resources)
+{
+	if (resources == NULL)
+		return manifest_hash_value(hash, -1);
+
+	hash = manifest_hash_mode(hash, modes_find_resources(resources, manifest->type));
+	hash = manifest_hash_filename(hash, resources->images);
+	hash = manifest_hash_filename(hash, resources->downloads);
+	hash = manifest_hash_object(manifest, hash, resources->summary, false);
+	hash = manifest_hash_object(manifest, hash, resources->strapline, false);
+	hash = manifest_hash_object(manifest, hash, resources->credit, false);
+	hash = manifest_hash_object(manifest, hash, resources->version, false);
+	hash = manifest_hash_object(manifest, hash, resources->date, false);
+
+	return hash;
+}
+
+/**
+ * Add the filenames from a mode resources block into a file signature.
+ *
+ * \param hash		The signature to add the resources to.
+ * \param *mode		The mode resources to add, or NULL.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_mode(uint64_t hash, struct manual_data_mode *mode)
+{
+	if (mode == NULL)
+		return manifest_hash_value(hash, -1);
+
+	hash = manifest_hash_filename(hash, mode->filename);
+	hash = manifest_hash_filename(hash, mode->folder);
+	hash = manifest_hash_filename(hash, mode->stylesheet);
+
+	return hash;
+}
+
+/**
+ * Add a filename into a file signature.
+ *
+ * \param hash		The signature to add the filename to.
+ * \param *name		The filename to add, or NULL.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_filename(uint64_t hash, struct filename *name)
+{
+	char *text;
+
+	if (name == NULL)
+		return manifest_hash_value(hash, -1);
+
+	text = filename_convert(name, FILENAME_PLATFORM_LINUX, 0);
+	hash = manifest_hash_text(hash, text);
+	free(text);
+
+	return hash;
+}
+
+/**
+ * Add a string, including its terminator, into a file signature.
+ *
+ * \param hash		The signature to add the string to.
+ * \param *text		The string to add, or NULL.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_text(uint64_t hash, char *text)
+{
+	if (text == NULL)
+		return manifest_hash_value(hash, -1);
+
+	return string_hash(text, strlen(text) + 1, hash);
+}
+
+/**
+ * Add an integer value into a file signature.
+ *
+ * \param hash		The signature to add the value to.
+ * \param value		The value to add.
+ * \return		The updated signature.
+ */
+
+static uint64_t manifest_hash_value(uint64_t hash, int value)
+{
+	return string_hash(&value, sizeof(int), hash);
+}
+
+/**
+ * Return the ID of an object, if it is of a type which can hold one.
+ *
+ * \param *object	The object of interest.
+ * \return		Pointer to the object's ID, or NULL.
+ */
+
+static char *manifest_get_id(struct manual_data *object)
+{
+	switch (object->type) {
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		return object->chapter.id;
+	default:
+		return NULL;
+	}
+}
@@ -0,0 +1,102 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manifest.h
+ *
+ * Incremental Build Manifest Interface.
+ *
+ * A manifest is stored alongside an output, recording a signature for
+ * each file that was written to it. The signature covers the nodes
+ * which make up the file, along with the titles, numbers and locations
+ * of any nodes which they refer to, so that on a later run a file can
+ * be left alone if nothing which went into it has changed.
+ */
+
+#ifndef XMLMAN_MANIFEST_H
+#define XMLMAN_MANIFEST_H
+
+#include <stdbool.h>
+
+#include "xmlman.h"
+#include "encoding.h"
+#include "filename.h"
+
+/**
+ * A manifest instance.
+ */
+
+struct manifest;
+
+/**
+ * Initialise the manifest system. This must be called before any
+ * output jobs are started.
+ *
+ * \param enabled	True if incremental builds are enabled; otherwise
+ *			no manifests will be opened.
+ */
+
+void manifest_initialise(bool enabled);
+
+/**
+ * Open the manifest for an output, loading any entries which were
+ * saved by a previous run with the same settings.
+ *
+ * \param *target	The folder or file to which the output is written.
+ * \param type		The output mode being written.
+ * \param encoding	The encoding selected for the output.
+ * \param line_end	The line ending selected for the output.
+ * \return		Pointer to the new manifest, or NULL if incremental
+ *			builds are disabled or the manifest can't be used.
+ */
+
+struct manifest *manifest_open(struct filename *target, enum modes_type type,
+		enum encoding_target encoding, enum encoding_line_end line_end);
+
+/**
+ * Record the signature of a file which is about to be written, and test
+ * whether the existing copy of the file is up to date. If it is, the
+ * file does not need to be written again.
+ *
+ * \param *manifest	The manifest to update, or NULL.
+ * \param *node		The node at the root of the file.
+ * \param *filename	The full name of the file.
+ * \return		True if the existing file is up to date; otherwise
+ *			False.
+ */
+
+bool manifest_check_file(struct manifest *manifest, struct manual_data *node, struct filename *filename);
+
+/**
+ * Close a manifest, saving the signatures recorded during the current
+ * run if required, and free its memory.
+ *
+ * \param *manifest	The manifest to close, or NULL.
+ * \param save		True to save the manifest; False to discard it
+ *			and leave any previous copy on disc untouched.
+ * \return		True if successful; otherwise False.
+ */
+
+bool manifest_close(struct manifest *manifest, bool save);
+
+#endif
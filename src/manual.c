@@ -32,6 +32,7 @@
 #include <stdlib.h>
 
 #include "manual.h"
+#include "manual_cache.h"
 
 /**
  * Create a new manual structure.
@@ -48,8 +49,32 @@ struct manual *manual_create(struct manual_data *node)
 	if (document == NULL)
 		return NULL;
 
+	document->arena = manual_arena_create();
+	if (document->arena == NULL) {
+		free(document);
+		return NULL;
+	}
+
 	document->manual = node;
+	document->cache = NULL;
 
 	return document;
 }
 
+/**
+ * Destroy a manual structure, along with all of the data held in its
+ * arena.
+ *
+ * \param *document	Pointer to the structure to destroy.
+ */
+
+void manual_destroy(struct manual *document)
+{
+	if (document == NULL)
+		return;
+
+	manual_arena_destroy(document->arena);
+	manual_cache_close(document->cache);
+	free(document);
+}
+
@@ -31,9 +31,12 @@
 #define XMLMAN_MANUAL_H
 
 #include "xmlman.h"
+#include "manual_arena.h"
 #include "manual_data.h"
 #include "manual_ids.h"
 
+struct manual_cache;
+
 /**
  * A top-level manual structure.
  */
@@ -44,6 +47,18 @@ struct manual {
 	 */
 
 	struct manual_data	*manual;
+
+	/**
+	 * Pointer to the arena holding the manual's data.
+	 */
+
+	struct manual_arena	*arena;
+
+	/**
+	 * Pointer to the cache which the manual was loaded from, or NULL.
+	 */
+
+	struct manual_cache	*cache;
 };
 
 /**
@@ -55,5 +70,14 @@ struct manual {
 
 struct manual *manual_create(struct manual_data *node);
 
+/**
+ * Destroy a manual structure, along with all of the data held in its
+ * arena.
+ *
+ * \param *document	Pointer to the structure to destroy.
+ */
+
+void manual_destroy(struct manual *document);
+
 #endif
 
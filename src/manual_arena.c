@@ -0,0 +1,412 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_arena.c
+ *
+ * Manual Memory Arena, implementation.
+ *
+ * Memory is handed out from a chain of large slabs by bumping a pointer;
+ * individual allocations are never freed, and the slabs are released in
+ * one go when the arena is destroyed.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "manual_arena.h"
+#include "stats.h"
+
+/**
+ * The size of a standard arena slab.
+ */
+
+#define MANUAL_ARENA_SLAB_SIZE 65536
+
+/**
+ * Requests larger than this are given a slab of their own, to avoid
+ * wasting the unused space at the end of the current one.
+ */
+
+#define MANUAL_ARENA_LARGE_ALLOCATION (MANUAL_ARENA_SLAB_SIZE / 4)
+
+/**
+ * A union of the types with the strictest alignment requirements, used
+ * to align allocations from the arena.
+ */
+
+union manual_arena_align {
+	long		l;
+	double		d;
+	void		*p;
+	long double	ld;
+};
+
+/**
+ * The alignment of allocations made from an arena.
+ */
+
+#define MANUAL_ARENA_ALIGNMENT (sizeof(union manual_arena_align))
+
+/**
+ * A slab of memory within an arena.
+ */
+
+struct manual_arena_slab {
+	/**
+	 * Pointer to the next slab in the chain, or NULL.
+	 */
+
+	struct manual_arena_slab	*next;
+
+	/**
+	 * The number of bytes available for allocation in the slab.
+	 */
+
+	size_t				size;
+
+	/**
+	 * The number of bytes already allocated from the slab.
+	 */
+
+	size_t				used;
+
+	/**
+	 * The memory held in the slab, which follows on from the header.
+	 */
+
+	union manual_arena_align	data[];
+};
+
+/**
+ * A block of heap memory which has been handed over to an arena.
+ */
+
+struct manual_arena_adopted {
+	/**
+	 * Pointer to the next adopted block in the chain, or NULL.
+	 */
+
+	struct manual_arena_adopted	*next;
+
+	/**
+	 * Pointer to the block, to be freed with the arena.
+	 */
+
+	void				*block;
+};
+
+/**
+ * A memory arena instance.
+ */
+
+struct manual_arena {
+	/**
+	 * Pointer to the slab currently being allocated from, which is
+	 * the head of the chain of slabs, or NULL.
+	 */
+
+	struct manual_arena_slab	*current;
+
+	/**
+	 * Pointer to a chain of slabs holding single large allocations,
+	 * or NULL.
+	 */
+
+	struct manual_arena_slab	*large;
+
+	/**
+	 * Pointer to a chain of heap blocks adopted by the arena, or NULL.
+	 */
+
+	struct manual_arena_adopted	*adopted;
+};
+
+/* Static Function Prototypes. */
+
+static struct manual_arena_slab *manual_arena_new_slab(size_t size);
+static void manual_arena_link_slabs(struct manual_arena_slab **chain, struct manual_arena_slab *slabs);
+static void manual_arena_free_slabs(struct manual_arena_slab *slab);
+
+/**
+ * Create a new memory arena.
+ *
+ * \return		Pointer to the new arena, or NULL on failure.
+ */
+
+struct manual_arena *manual_arena_create(void)
+{
+	struct manual_arena *arena;
+
+	arena = malloc(sizeof(struct manual_arena));
+	if (arena == NULL)
+		return NULL;
+
+	arena->current = NULL;
+	arena->large = NULL;
+	arena->adopted = NULL;
+
+	return arena;
+}
+
+/**
+ * Destroy a memory arena, freeing all of the memory allocated from it.
+ *
+ * \param *arena	Pointer to the arena to destroy.
+ */
+
+void manual_arena_destroy(struct manual_arena *arena)
+{
+	struct manual_arena_adopted *adopted;
+
+	if (arena == NULL)
+		return;
+
+	/* The adopted block records live in the slabs, so free the blocks
+	 * before the slabs go.
+	 */
+
+	for (adopted = arena->adopted; adopted != NULL; adopted = adopted->next)
+		free(adopted->block);
+
+	manual_arena_free_slabs(arena->current);
+	manual_arena_free_slabs(arena->large);
+
+	free(arena);
+}
+
+/**
+ * Merge the contents of one arena into another, so that the memory
+ * allocated from it will be freed when the receiving arena is destroyed.
+ * The merged arena is destroyed in the process, and its allocations remain
+ * valid.
+ *
+ * \param *arena	Pointer to the arena to receive the memory.
+ * \param *source	Pointer to the arena to be merged and destroyed.
+ */
+
+void manual_arena_merge(struct manual_arena *arena, struct manual_arena *source)
+{
+	struct manual_arena_adopted *tail;
+
+	if (arena == NULL || source == NULL || arena == source)
+		return;
+
+	/* Link the source's slabs in behind the current slab, so that
+	 * allocations continue from the space remaining in it.
+	 */
+
+	if (arena->current == NULL)
+		arena->current = source->current;
+	else
+		manual_arena_link_slabs(&(arena->current->next), source->current);
+
+	manual_arena_link_slabs(&(arena->large), source->large);
+
+	if (source->adopted != NULL) {
+		for (tail = source->adopted; tail->next != NULL; tail = tail->next);
+
+		tail->next = arena->adopted;
+		arena->adopted = source->adopted;
+	}
+
+	free(source);
+}
+
+/**
+ * Allocate a block of memory from an arena. If no arena is supplied,
+ * the memory will be claimed from the heap instead.
+ *
+ * \param *arena	Pointer to the arena to allocate from, or NULL.
+ * \param size		The number of bytes to allocate.
+ * \return		Pointer to the memory, or NULL on failure.
+ */
+
+void *manual_arena_alloc(struct manual_arena *arena, size_t size)
+{
+	struct manual_arena_slab *slab;
+	void *block;
+
+	stats_count(STATS_COUNTER_ALLOCATIONS, 1);
+
+	if (arena == NULL)
+		return malloc(size);
+
+	/* Round the request up to keep subsequent blocks aligned. */
+
+	size = ((size + MANUAL_ARENA_ALIGNMENT - 1) / MANUAL_ARENA_ALIGNMENT) * MANUAL_ARENA_ALIGNMENT;
+
+	if (size == 0)
+		size = MANUAL_ARENA_ALIGNMENT;
+
+	/* Large blocks go into a slab of their own. */
+
+	if (size > MANUAL_ARENA_LARGE_ALLOCATION) {
+		slab = manual_arena_new_slab(size);
+		if (slab == NULL)
+			return NULL;
+
+		slab->used = size;
+		slab->next = arena->large;
+		arena->large = slab;
+
+		return slab->data;
+	}
+
+	/* Start a new slab if there isn't enough room left in the current one. */
+
+	if (arena->current == NULL || (arena->current->size - arena->current->used) < size) {
+		slab = manual_arena_new_slab(MANUAL_ARENA_SLAB_SIZE);
+		if (slab == NULL)
+			return NULL;
+
+		slab->next = arena->current;
+		arena->current = slab;
+	}
+
+	block = (char *) arena->current->data + arena->current->used;
+	arena->current->used += size;
+
+	return block;
+}
+
+/**
+ * Hand a block of memory claimed from the heap over to an arena, so that
+ * it will be freed when the arena is destroyed.
+ *
+ * \param *arena	Pointer to the arena to adopt the block.
+ * \param *block	Pointer to the block to be adopted.
+ * \return		True if successful; False on failure, in which
+ *			case the block remains with the caller.
+ */
+
+bool manual_arena_adopt(struct manual_arena *arena, void *block)
+{
+	struct manual_arena_adopted *adopted;
+
+	if (arena == NULL || block == NULL)
+		return false;
+
+	adopted = manual_arena_alloc(arena, sizeof(struct manual_arena_adopted));
+	if (adopted == NULL)
+		return false;
+
+	adopted->block = block;
+	adopted->next = arena->adopted;
+	arena->adopted = adopted;
+
+	return true;
+}
+
+/**
+ * Allocate a copy of a string from an arena, or from the heap if no
+ * arena is supplied. At most length bytes will be copied, and the copy
+ * will always be terminated.
+ *
+ * \param *arena	Pointer to the arena to allocate from, or NULL.
+ * \param *text		Pointer to the text to copy.
+ * \param length	The maximum number of bytes to copy.
+ * \return		Pointer to the copy, or NULL on failure.
+ */
+
+char *manual_arena_strndup(struct manual_arena *arena, const char *text, size_t length)
+{
+	char *copy;
+	size_t i;
+
+	if (text == NULL)
+		return NULL;
+
+	for (i = 0; i < length && text[i] != '\0'; i++);
+
+	copy = manual_arena_alloc(arena, i + 1);
+	if (copy == NULL)
+		return NULL;
+
+	memcpy(copy, text, i);
+	copy[i] = '\0';
+
+	return copy;
+}
+
+/**
+ * Allocate a new slab of memory.
+ *
+ * \param size		The number of bytes to be available in the slab.
+ * \return		Pointer to the new slab, or NULL on failure.
+ */
+
+static struct manual_arena_slab *manual_arena_new_slab(size_t size)
+{
+	struct manual_arena_slab *slab;
+
+	slab = malloc(sizeof(struct manual_arena_slab) + size);
+	if (slab == NULL)
+		return NULL;
+
+	stats_count(STATS_COUNTER_SLABS, 1);
+
+	slab->next = NULL;
+	slab->size = size;
+	slab->used = 0;
+
+	return slab;
+}
+
+/**
+ * Link a chain of slabs on to the front of another chain.
+ *
+ * \param **chain	Pointer to the head pointer of the chain to link to.
+ * \param *slabs	Pointer to the first slab in the chain to be linked.
+ */
+
+static void manual_arena_link_slabs(struct manual_arena_slab **chain, struct manual_arena_slab *slabs)
+{
+	struct manual_arena_slab *tail;
+
+	if (chain == NULL || slabs == NULL)
+		return;
+
+	for (tail = slabs; tail->next != NULL; tail = tail->next);
+
+	tail->next = *chain;
+	*chain = slabs;
+}
+
+/**
+ * Free a chain of slabs.
+ *
+ * \param *slab		Pointer to the first slab in the chain.
+ */
+
+static void manual_arena_free_slabs(struct manual_arena_slab *slab)
+{
+	struct manual_arena_slab *next;
+
+	while (slab != NULL) {
+		next = slab->next;
+		free(slab);
+		slab = next;
+	}
+}
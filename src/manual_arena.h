@@ -0,0 +1,110 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_arena.h
+ *
+ * Manual Memory Arena Interface.
+ *
+ * An arena hands out blocks of memory which live for as long as the
+ * document that they belong to, and which are all freed together when
+ * the arena is destroyed.
+ */
+
+#ifndef XMLMAN_MANUAL_ARENA_H
+#define XMLMAN_MANUAL_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A memory arena instance.
+ */
+
+struct manual_arena;
+
+/**
+ * Create a new memory arena.
+ *
+ * \return		Pointer to the new arena, or NULL on failure.
+ */
+
+struct manual_arena *manual_arena_create(void);
+
+/**
+ * Destroy a memory arena, freeing all of the memory allocated from it.
+ *
+ * \param *arena	Pointer to the arena to destroy.
+ */
+
+void manual_arena_destroy(struct manual_arena *arena);
+
+/**
+ * Merge the contents of one arena into another, so that the memory
+ * allocated from it will be freed when the receiving arena is destroyed.
+ * The merged arena is destroyed in the process, and its allocations remain
+ * valid.
+ *
+ * \param *arena	Pointer to the arena to receive the memory.
+ * \param *source	Pointer to the arena to be merged and destroyed.
+ */
+
+void manual_arena_merge(struct manual_arena *arena, struct manual_arena *source);
+
+/**
+ * Allocate a block of memory from an arena. If no arena is supplied,
+ * the memory will be claimed from the heap instead.
+ *
+ * \param *arena	Pointer to the arena to allocate from, or NULL.
+ * \param size		The number of bytes to allocate.
+ * \return		Pointer to the memory, or NULL on failure.
+ */
+
+void *manual_arena_alloc(struct manual_arena *arena, size_t size);
+
+/**
+ * Hand a block of memory claimed from the heap over to an arena, so that
+ * it will be freed when the arena is destroyed.
+ *
+ * \param *arena	Pointer to the arena to adopt the block.
+ * \param *block	Pointer to the block to be adopted.
+ * \return		True if successful; False on failure, in which
+ *			case the block remains with the caller.
+ */
+
+bool manual_arena_adopt(struct manual_arena *arena, void *block);
+
+/**
+ * Allocate a copy of a string from an arena, or from the heap if no
+ * arena is supplied. At most length bytes will be copied, and the copy
+ * will always be terminated.
+ *
+ * \param *arena	Pointer to the arena to allocate from, or NULL.
+ * \param *text		Pointer to the text to copy.
+ * \param length	The maximum number of bytes to copy.
+ * \return		Pointer to the copy, or NULL on failure.
+ */
+
+char *manual_arena_strndup(struct manual_arena *arena, const char *text, size_t length);
+
+#endif
@@ -0,0 +1,1558 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_cache.c
+ *
+ * Pre-Parsed Document Cache, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "manual_cache.h"
+
+#include "xmlman.h"
+#include "filename.h"
+#include "manual.h"
+#include "manual_arena.h"
+#include "manual_data.h"
+#include "msg.h"
+#include "stats.h"
+#include "string.h"
+
+/**
+ * The identifier at the start of a cache file, including its terminator.
+ */
+
+#define MANUAL_CACHE_MAGIC "XMLManC"
+
+/**
+ * The format version of cache files.
+ */
+
+#define MANUAL_CACHE_VERSION 2
+
+/**
+ * A value stored in the header to identify the byte order of the file.
+ */
+
+#define MANUAL_CACHE_BYTE_ORDER 0x01020304u
+
+/**
+ * The index or string offset used in a cache file to represent NULL.
+ */
+
+#define MANUAL_CACHE_NULL 0
+
+/**
+ * The initial number of slots in a pointer map, which must be a power of two.
+ */
+
+#define MANUAL_CACHE_MAP_INITIAL_SIZE 1024
+
+/**
+ * The size of the blocks in which source files are read to check their hashes.
+ */
+
+#define MANUAL_CACHE_READ_BLOCK 8192
+
+/**
+ * The header at the start of a cache file. It is followed by the source
+ * records, the node records, the annotation records, the resource records
+ * and the string table, in that order.
+ */
+
+struct manual_cache_header {
+	char		magic[8];		/**< The identifier, MANUAL_CACHE_MAGIC.		*/
+	uint32_t	version;		/**< The format version, MANUAL_CACHE_VERSION.		*/
+	uint32_t	byte_order;		/**< MANUAL_CACHE_BYTE_ORDER, in the writer's order.	*/
+	uint64_t	build;			/**< The hash of the build and record layouts.		*/
+	uint32_t	root;			/**< The index of the root manual node.			*/
+	uint32_t	source_count;		/**< The number of source records.			*/
+	uint32_t	node_count;		/**< The number of node records.			*/
+	uint32_t	annotation_count;	/**< The number of annotation records.			*/
+	uint32_t	resource_count;		/**< The number of resource records.			*/
+	uint32_t	strings_size;		/**< The number of bytes in the string table.		*/
+};
+
+/**
+ * A source file record in a cache file.
+ */
+
+struct manual_cache_source {
+	uint64_t	hash;			/**< The hash of the file's contents.			*/
+	uint64_t	length;			/**< The length of the file, in bytes.			*/
+	uint32_t	path;			/**< The offset of the file's name in the string table.	*/
+	uint32_t	reserved;		/**< Padding, which is zero.				*/
+};
+
+/**
+ * A node record in a cache file. Nodes are referred to by their index in
+ * the file, counting from one, and strings by their offset into the string
+ * table; in both cases, MANUAL_CACHE_NULL stands for NULL. The meaning of
+ * the flags, first and second fields depends on the type of the node.
+ */
+
+struct manual_cache_node {
+	uint32_t	type;			/**< The node's object type.				*/
+	int32_t		index;			/**< The node's index number.				*/
+	uint32_t	title;			/**< The node's title.					*/
+	uint32_t	first_child;		/**< The node's first child.				*/
+	uint32_t	parent;			/**< The node's parent.					*/
+	uint32_t	previous;		/**< The node's previous sibling.			*/
+	uint32_t	next;			/**< The node's next sibling.				*/
+	uint32_t	annotations;		/**< The index of the node's annotations.		*/
+	uint32_t	flags;			/**< The chunk flags, or the processed state.		*/
+	uint32_t	first;			/**< The ID, link, width or columns.			*/
+	uint32_t	second;			/**< The text, entity, target, resources or filename.	*/
+};
+
+/**
+ * An annotation record in a cache file.
+ */
+
+struct manual_cache_annotations {
+	uint32_t	file[MODES_TYPE_COUNT];		/**< The file owner nodes for each mode.	*/
+	uint32_t	folder[MODES_TYPE_COUNT];	/**< The folder owner nodes for each mode.	*/
+	uint32_t	stylesheet[MODES_TYPE_COUNT];	/**< The stylesheet owner nodes for each mode.	*/
+	uint32_t	split;				/**< A bit for each mode whose output is split.	*/
+	uint32_t	number;				/**< The display number string.			*/
+	uint32_t	named_number;			/**< The named display number string.		*/
+};
+
+/**
+ * The mode resources within a resource record in a cache file. Filenames
+ * are stored as strings in Linux format.
+ */
+
+struct manual_cache_mode {
+	uint32_t	filename;		/**< The output filename.				*/
+	uint32_t	folder;			/**< The output folder name.				*/
+	uint32_t	stylesheet;		/**< The stylesheet filename.				*/
+};
+
+/**
+ * A resource record in a cache file.
+ */
+
+struct manual_cache_resources {
+	struct manual_cache_mode	text;		/**< The text mode resources.			*/
+	struct manual_cache_mode	strong;		/**< The StrongHelp mode resources.		*/
+	struct manual_cache_mode	html;		/**< The HTML mode resources.			*/
+	uint32_t			images;		/**< The image folder name.			*/
+	uint32_t			downloads;	/**< The download folder name.			*/
+	uint32_t			summary;	/**< The summary node.				*/
+	uint32_t			strapline;	/**< The strapline node.			*/
+	uint32_t			credit;		/**< The credit node.				*/
+	uint32_t			version;	/**< The version node.				*/
+	uint32_t			date;		/**< The date node.				*/
+};
+
+/**
+ * A loaded cache file, whose string table is referred to by the manual
+ * which was loaded from it.
+ */
+
+struct manual_cache {
+	char		*data;			/**< Pointer to the contents of the file.		*/
+	size_t		size;			/**< The size of the file, in bytes.			*/
+	bool		mapped;			/**< True if the file is mapped; False if in a malloc() block.	*/
+};
+
+/**
+ * A source file recorded while parsing.
+ */
+
+struct manual_cache_recorded_source {
+	char					*path;		/**< The name of the file, in a malloc() block.	*/
+	uint64_t				hash;		/**< The hash of the file's contents.		*/
+	uint64_t				length;		/**< The length of the file, in bytes.		*/
+	struct manual_cache_recorded_source	*next;		/**< The next recorded file, or NULL.		*/
+};
+
+/**
+ * An entry in a pointer map.
+ */
+
+struct manual_cache_map_entry {
+	void		*key;			/**< The pointer being mapped, or NULL if the slot is free.	*/
+	uint32_t	value;			/**< The index to which the pointer maps.		*/
+};
+
+/**
+ * A map from pointers to the indices which represent them in a cache file.
+ */
+
+struct manual_cache_map {
+	struct manual_cache_map_entry	*entries;	/**< The map's slots.				*/
+	size_t				size;		/**< The number of slots, a power of two.	*/
+	size_t				count;		/**< The number of slots in use.		*/
+};
+
+/**
+ * The state of a cache which is being written.
+ */
+
+struct manual_cache_writer {
+	struct manual_cache_map		nodes;			/**< The map of nodes to indices.		*/
+	struct manual_data		**node_list;		/**< The nodes, in index order.			*/
+	size_t				node_count;		/**< The number of nodes.			*/
+	size_t				node_capacity;		/**< The space in the node list.		*/
+
+	struct manual_cache_map		annotations;		/**< The map of annotations to indices.		*/
+	struct manual_data_annotations	**annotation_list;	/**< The annotations, in index order.		*/
+	size_t				annotation_count;	/**< The number of annotations.			*/
+	size_t				annotation_capacity;	/**< The space in the annotation list.		*/
+
+	struct manual_cache_resources	*resource_list;		/**< The resource records.			*/
+	size_t				resource_count;		/**< The number of resource records.		*/
+	size_t				resource_capacity;	/**< The space in the resource list.		*/
+
+	char				*strings;		/**< The string table.				*/
+	size_t				strings_size;		/**< The number of bytes in the string table.	*/
+	size_t				strings_capacity;	/**< The space in the string table.		*/
+
+	bool				failed;			/**< True if the writer has run out of memory.	*/
+};
+
+/**
+ * The state of a cache which is being loaded.
+ */
+
+struct manual_cache_reader {
+	struct manual_data		*nodes;			/**< The array of loaded nodes.			*/
+	uint32_t			node_count;		/**< The number of nodes.			*/
+	struct manual_data_annotations	*annotations;		/**< The array of loaded annotations.		*/
+	uint32_t			annotation_count;	/**< The number of annotations.			*/
+	struct manual_data_resources	*resources;		/**< The array of loaded resources.		*/
+	uint32_t			resource_count;		/**< The number of resources.			*/
+	char				*strings;		/**< The string table.				*/
+	uint32_t			strings_size;		/**< The number of bytes in the string table.	*/
+	bool				valid;			/**< False if a bad reference has been found.	*/
+};
+
+/**
+ * True if the source files being parsed are to be recorded.
+ */
+
+static bool manual_cache_enabled = false;
+
+/**
+ * The first source file recorded while parsing, or NULL.
+ */
+
+static struct manual_cache_recorded_source *manual_cache_first_source = NULL;
+
+/**
+ * The last source file recorded while parsing, or NULL.
+ */
+
+static struct manual_cache_recorded_source *manual_cache_last_source = NULL;
+
+/**
+ * The number of source files recorded while parsing.
+ */
+
+static size_t manual_cache_source_count = 0;
+
+/**
+ * Lock protecting the recorded source files, when chapter files are
+ * parsed from more than one thread.
+ */
+
+static pthread_mutex_t manual_cache_sources_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Static Function Prototypes. */
+
+static uint64_t manual_cache_build_hash(void);
+static bool manual_cache_read_file(char *filename, struct manual_cache *cache);
+static bool manual_cache_check_source(char *path, uint64_t hash, uint64_t length);
+static bool manual_cache_restore_node(struct manual_cache_reader *reader, struct manual_data *node, struct manual_cache_node *record);
+static struct manual_data *manual_cache_get_node(struct manual_cache_reader *reader, uint32_t index);
+static char *manual_cache_get_string(struct manual_cache_reader *reader, uint32_t offset);
+static struct filename *manual_cache_get_filename(struct manual_cache_reader *reader, uint32_t offset, enum filename_type type);
+static void manual_cache_restore_mode(struct manual_cache_reader *reader, struct manual_data_mode *mode, struct manual_cache_mode *record);
+
+static void manual_cache_collect(struct manual_cache_writer *writer, struct manual_data *node);
+static void manual_cache_collect_resources(struct manual_cache_writer *writer, struct manual_data_resources *resources);
+static void manual_cache_build_node(struct manual_cache_writer *writer, struct manual_data *node, struct manual_cache_node *record);
+static uint32_t manual_cache_build_resources(struct manual_cache_writer *writer, struct manual_data_resources *resources);
+static void manual_cache_build_mode(struct manual_cache_writer *writer, struct manual_data_mode *mode, struct manual_cache_mode *record);
+static uint32_t manual_cache_add_string(struct manual_cache_writer *writer, char *text);
+static uint32_t manual_cache_add_filename(struct manual_cache_writer *writer, struct filename *name);
+static uint32_t manual_cache_find_node(struct manual_cache_writer *writer, struct manual_data *node);
+static bool manual_cache_grow(void **array, size_t *capacity, size_t required, size_t size);
+static void manual_cache_free_writer(struct manual_cache_writer *writer);
+
+static bool manual_cache_map_add(struct manual_cache_map *map, void *key, uint32_t value);
+static uint32_t manual_cache_map_find(struct manual_cache_map *map, void *key);
+static size_t manual_cache_map_slot(struct manual_cache_map *map, void *key);
+
+/**
+ * Initialise the cache system. This must be called before any source
+ * files are parsed.
+ *
+ * \param enabled	True if a cache is to be written; otherwise the
+ *			source files won't be recorded.
+ */
+
+void manual_cache_initialise(bool enabled)
+{
+	manual_cache_enabled = enabled;
+}
+
+/**
+ * Record a source file which has been read by the parser, so that its
+ * hash can be stored in any cache which is written.
+ *
+ * \param *filename	The name of the file, as it was opened.
+ * \param *data		Pointer to the contents of the file.
+ * \param length	The number of bytes in the file.
+ */
+
+void manual_cache_add_source(char *filename, char *data, long length)
+{
+	struct manual_cache_recorded_source *source;
+
+	if (manual_cache_enabled == false || filename == NULL || data == NULL || length < 0)
+		return;
+
+	source = malloc(sizeof(struct manual_cache_recorded_source));
+	if (source == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		return;
+	}
+
+	source->path = strdup(filename);
+	if (source->path == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		free(source);
+		return;
+	}
+
+	source->hash = string_hash(data, length, STRING_HASH_INITIAL);
+	source->length = length;
+	source->next = NULL;
+
+	/* Keep the files in the order they were read, so that the root
+	 * file always comes first.
+	 */
+
+	pthread_mutex_lock(&manual_cache_sources_lock);
+
+	if (manual_cache_last_source != NULL)
+		manual_cache_last_source->next = source;
+	else
+		manual_cache_first_source = source;
+
+	manual_cache_last_source = source;
+	manual_cache_source_count++;
+
+	pthread_mutex_unlock(&manual_cache_sources_lock);
+}
+
+/**
+ * Test whether a file is a cache, by looking for the identifying header.
+ *
+ * \param *filename	The name of the file to test.
+ * \return		True if the file is a cache; otherwise False.
+ */
+
+bool manual_cache_test(char *filename)
+{
+	FILE	*file;
+	char	magic[sizeof(MANUAL_CACHE_MAGIC)];
+	bool	result = false;
+
+	if (filename == NULL)
+		return false;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return false;
+
+	if (fread(magic, sizeof(MANUAL_CACHE_MAGIC), 1, file) == 1 &&
+			memcmp(magic, MANUAL_CACHE_MAGIC, sizeof(MANUAL_CACHE_MAGIC)) == 0)
+		result = true;
+
+	fclose(file);
+
+	return result;
+}
+
+/**
+ * Load a manual from a cache, if the cache exists and all of the source
+ * files recorded in it are unchanged.
+ *
+ * \param *filename	The name of the cache file.
+ * \param **root	Pointer to a location to take a pointer to the name
+ *			of the root source file recorded in the cache, in a
+ *			malloc() block, or NULL if not required. The location
+ *			is only updated if the cache could be read.
+ * \return		Pointer to the manual, or NULL if the cache couldn't
+ *			be used.
+ */
+
+struct manual *manual_cache_load(char *filename, char **root)
+{
+	struct manual_cache		*cache;
+	struct manual_cache_header	*header;
+	struct manual_cache_source	*sources;
+	struct manual_cache_node	*nodes;
+	struct manual_cache_annotations	*annotations;
+	struct manual_cache_resources	*resources;
+	struct manual_cache_reader	reader;
+	struct manual			*document;
+	struct stats_timer		timer;
+	size_t				required;
+	uint32_t			i;
+	int				type;
+
+	if (filename == NULL)
+		return NULL;
+
+	stats_start(&timer);
+
+	cache = malloc(sizeof(struct manual_cache));
+	if (cache == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		return NULL;
+	}
+
+	if (!manual_cache_read_file(filename, cache)) {
+		free(cache);
+		return NULL;
+	}
+
+	/* Check the header, and that the file holds everything that it claims to. */
+
+	header = (struct manual_cache_header *) cache->data;
+
+	if (cache->size < sizeof(struct manual_cache_header) ||
+			memcmp(header->magic, MANUAL_CACHE_MAGIC, sizeof(MANUAL_CACHE_MAGIC)) != 0 ||
+			header->version != MANUAL_CACHE_VERSION ||
+			header->byte_order != MANUAL_CACHE_BYTE_ORDER ||
+			header->build != manual_cache_build_hash()) {
+		msg_report(MSG_CACHE_BAD, filename);
+		manual_cache_close(cache);
+		return NULL;
+	}
+
+	required = sizeof(struct manual_cache_header);
+
+	if (header->source_count > (cache->size - required) / sizeof(struct manual_cache_source) ||
+			(required += (size_t) header->source_count * sizeof(struct manual_cache_source)) > cache->size ||
+			header->node_count > (cache->size - required) / sizeof(struct manual_cache_node) ||
+			(required += (size_t) header->node_count * sizeof(struct manual_cache_node)) > cache->size ||
+			header->annotation_count > (cache->size - required) / sizeof(struct manual_cache_annotations) ||
+			(required += (size_t) header->annotation_count * sizeof(struct manual_cache_annotations)) > cache->size ||
+			header->resource_count > (cache->size - required) / sizeof(struct manual_cache_resources) ||
+			(required += (size_t) header->resource_count * sizeof(struct manual_cache_resources)) > cache->size ||
+			header->strings_size != cache->size - required || header->strings_size == 0 ||
+			cache->data[cache->size - 1] != '\0') {
+		msg_report(MSG_CACHE_BAD, filename);
+		manual_cache_close(cache);
+		return NULL;
+	}
+
+	sources = (struct manual_cache_source *) (cache->data + sizeof(struct manual_cache_header));
+	nodes = (struct manual_cache_node *) (sources + header->source_count);
+	annotations = (struct manual_cache_annotations *) (nodes + header->node_count);
+	resources = (struct manual_cache_resources *) (annotations + header->annotation_count);
+
+	reader.strings = (char *) (resources + header->resource_count);
+	reader.strings_size = header->strings_size;
+	reader.node_count = header->node_count;
+	reader.annotation_count = header->annotation_count;
+	reader.resource_count = header->resource_count;
+	reader.valid = true;
+
+	/* Pass back the name of the root source file, which was read first. */
+
+	if (root != NULL && header->source_count > 0 && manual_cache_get_string(&reader, sources[0].path) != NULL) {
+		*root = strdup(manual_cache_get_string(&reader, sources[0].path));
+		if (*root == NULL)
+			msg_report(MSG_CACHE_NO_MEM);
+	}
+
+	/* Check that none of the source files have changed. */
+
+	for (i = 0; i < header->source_count; i++) {
+		if (!manual_cache_check_source(manual_cache_get_string(&reader, sources[i].path), sources[i].hash, sources[i].length)) {
+			msg_report(MSG_CACHE_STALE, filename);
+			manual_cache_close(cache);
+			return NULL;
+		}
+	}
+
+	/* Create the document, and allocate the structures from its arena. */
+
+	document = manual_create(NULL);
+	if (document == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		manual_cache_close(cache);
+		return NULL;
+	}
+
+	manual_data_select_arena(document->arena);
+
+	reader.nodes = manual_data_alloc((header->node_count + 1) * sizeof(struct manual_data));
+	reader.annotations = manual_data_alloc((header->annotation_count + 1) * sizeof(struct manual_data_annotations));
+	reader.resources = manual_data_alloc((header->resource_count + 1) * sizeof(struct manual_data_resources));
+
+	if (reader.nodes == NULL || reader.annotations == NULL || reader.resources == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		manual_destroy(document);
+		manual_cache_close(cache);
+		return NULL;
+	}
+
+	/* Restore the annotations and resources, followed by the nodes. */
+
+	for (i = 0; i < header->annotation_count; i++) {
+		for (type = 0; type < MODES_TYPE_COUNT; type++) {
+			reader.annotations[i].file[type] = manual_cache_get_node(&reader, annotations[i].file[type]);
+			reader.annotations[i].folder[type] = manual_cache_get_node(&reader, annotations[i].folder[type]);
+			reader.annotations[i].stylesheet[type] = manual_cache_get_node(&reader, annotations[i].stylesheet[type]);
+			reader.annotations[i].split[type] = (annotations[i].split & (1u << type)) ? true : false;
+		}
+
+		reader.annotations[i].number = manual_cache_get_string(&reader, annotations[i].number);
+		reader.annotations[i].named_number = manual_cache_get_string(&reader, annotations[i].named_number);
+	}
+
+	for (i = 0; i < header->resource_count; i++) {
+		manual_cache_restore_mode(&reader, &(reader.resources[i].text), &(resources[i].text));
+		manual_cache_restore_mode(&reader, &(reader.resources[i].strong), &(resources[i].strong));
+		manual_cache_restore_mode(&reader, &(reader.resources[i].html), &(resources[i].html));
+
+		reader.resources[i].images = manual_cache_get_filename(&reader, resources[i].images, FILENAME_TYPE_DIRECTORY);
+		reader.resources[i].downloads = manual_cache_get_filename(&reader, resources[i].downloads, FILENAME_TYPE_DIRECTORY);
+		reader.resources[i].summary = manual_cache_get_node(&reader, resources[i].summary);
+		reader.resources[i].strapline = manual_cache_get_node(&reader, resources[i].strapline);
+		reader.resources[i].credit = manual_cache_get_node(&reader, resources[i].credit);
+		reader.resources[i].version = manual_cache_get_node(&reader, resources[i].version);
+		reader.resources[i].date = manual_cache_get_node(&reader, resources[i].date);
+	}
+
+	for (i = 0; i < header->node_count && reader.valid; i++)
+		reader.valid = manual_cache_restore_node(&reader, reader.nodes + i, nodes + i);
+
+	document->manual = manual_cache_get_node(&reader, header->root);
+
+	if (!reader.valid || document->manual == NULL || document->manual->type != MANUAL_DATA_OBJECT_TYPE_MANUAL) {
+		msg_report(MSG_CACHE_BAD, filename);
+		manual_destroy(document);
+		manual_cache_close(cache);
+		return NULL;
+	}
+
+	document->cache = cache;
+
+	stats_count(STATS_COUNTER_BYTES_READ, cache->size);
+	stats_count(STATS_COUNTER_NODES, header->node_count);
+	stats_record(&timer, "cache", filename);
+
+	msg_report(MSG_CACHE_LOADED, filename);
+
+	return document;
+}
+
+/**
+ * Save a linked manual to a cache, along with the hashes of the source
+ * files which have been recorded.
+ *
+ * \param *document	The manual to be saved.
+ * \param *filename	The name of the cache file.
+ * \return		True if successful; otherwise False.
+ */
+
+bool manual_cache_save(struct manual *document, char *filename)
+{
+	struct manual_cache_writer		writer;
+	struct manual_cache_header		header;
+	struct manual_cache_source		source;
+	struct manual_cache_node		record;
+	struct manual_cache_annotations		annotations;
+	struct manual_cache_recorded_source	*recorded;
+	struct stats_timer			timer;
+	FILE					*file;
+	size_t					i;
+	int					type;
+	bool					result = true;
+
+	if (document == NULL || document->manual == NULL || filename == NULL)
+		return false;
+
+	stats_start(&timer);
+
+	writer.nodes.entries = NULL;
+	writer.nodes.size = 0;
+	writer.nodes.count = 0;
+	writer.node_list = NULL;
+	writer.node_count = 0;
+	writer.node_capacity = 0;
+
+	writer.annotations.entries = NULL;
+	writer.annotations.size = 0;
+	writer.annotations.count = 0;
+	writer.annotation_list = NULL;
+	writer.annotation_count = 0;
+	writer.annotation_capacity = 0;
+
+	writer.resource_list = NULL;
+	writer.resource_count = 0;
+	writer.resource_capacity = 0;
+
+	writer.strings = NULL;
+	writer.strings_size = 0;
+	writer.strings_capacity = 0;
+
+	writer.failed = false;
+
+	/* Reserve the first byte of the string table, so that no string
+	 * can have an offset of MANUAL_CACHE_NULL.
+	 */
+
+	if (manual_cache_grow((void **) &(writer.strings), &(writer.strings_capacity), 1, sizeof(char)))
+		writer.strings[writer.strings_size++] = '\0';
+	else
+		writer.failed = true;
+
+	/* Number the nodes and annotations, then build the records for the
+	 * resources and the string table as the nodes are written out.
+	 */
+
+	manual_cache_collect(&writer, document->manual);
+
+	file = NULL;
+
+	if (!writer.failed) {
+		file = fopen(filename, "wb");
+		if (file == NULL)
+			result = false;
+	}
+
+	if (file != NULL) {
+		memset(&header, 0, sizeof(struct manual_cache_header));
+
+		/* The header is written twice: once to reserve its space, and
+		 * again with the final counts once the records are complete.
+		 */
+
+		if (fwrite(&header, sizeof(struct manual_cache_header), 1, file) != 1)
+			result = false;
+
+		/* Write the source files. */
+
+		pthread_mutex_lock(&manual_cache_sources_lock);
+
+		for (recorded = manual_cache_first_source; recorded != NULL && result; recorded = recorded->next) {
+			source.hash = recorded->hash;
+			source.length = recorded->length;
+			source.path = manual_cache_add_string(&writer, recorded->path);
+			source.reserved = 0;
+
+			if (fwrite(&source, sizeof(struct manual_cache_source), 1, file) != 1)
+				result = false;
+		}
+
+		header.source_count = manual_cache_source_count;
+
+		pthread_mutex_unlock(&manual_cache_sources_lock);
+
+		/* Write the nodes. */
+
+		for (i = 0; i < writer.node_count && result; i++) {
+			manual_cache_build_node(&writer, writer.node_list[i], &record);
+
+			if (fwrite(&record, sizeof(struct manual_cache_node), 1, file) != 1)
+				result = false;
+		}
+
+		/* Write the annotations. */
+
+		for (i = 0; i < writer.annotation_count && result; i++) {
+			annotations.split = 0;
+
+			for (type = 0; type < MODES_TYPE_COUNT; type++) {
+				annotations.file[type] = manual_cache_find_node(&writer, writer.annotation_list[i]->file[type]);
+				annotations.folder[type] = manual_cache_find_node(&writer, writer.annotation_list[i]->folder[type]);
+				annotations.stylesheet[type] = manual_cache_find_node(&writer, writer.annotation_list[i]->stylesheet[type]);
+
+				if (writer.annotation_list[i]->split[type])
+					annotations.split |= 1u << type;
+			}
+
+			annotations.number = manual_cache_add_string(&writer, writer.annotation_list[i]->number);
+			annotations.named_number = manual_cache_add_string(&writer, writer.annotation_list[i]->named_number);
+
+			if (fwrite(&annotations, sizeof(struct manual_cache_annotations), 1, file) != 1)
+				result = false;
+		}
+
+		/* Write the resources and the string table, which are complete now. */
+
+		if (result && writer.resource_count > 0 &&
+				fwrite(writer.resource_list, sizeof(struct manual_cache_resources), writer.resource_count, file) != writer.resource_count)
+			result = false;
+
+		if (result && !writer.failed &&
+				fwrite(writer.strings, sizeof(char), writer.strings_size, file) != writer.strings_size)
+			result = false;
+
+		/* Complete the header. */
+
+		memcpy(header.magic, MANUAL_CACHE_MAGIC, sizeof(MANUAL_CACHE_MAGIC));
+		header.version = MANUAL_CACHE_VERSION;
+		header.byte_order = MANUAL_CACHE_BYTE_ORDER;
+		header.build = manual_cache_build_hash();
+		header.root = manual_cache_find_node(&writer, document->manual);
+		header.node_count = writer.node_count;
+		header.annotation_count = writer.annotation_count;
+		header.resource_count = writer.resource_count;
+		header.strings_size = writer.strings_size;
+
+		if (result && (fseek(file, 0, SEEK_SET) != 0 ||
+				fwrite(&header, sizeof(struct manual_cache_header), 1, file) != 1))
+			result = false;
+
+		if (ferror(file))
+			result = false;
+
+		if (fclose(file) != 0)
+			result = false;
+	}
+
+	if (writer.failed) {
+		msg_report(MSG_CACHE_NO_MEM);
+		result = false;
+	} else if (result == false) {
+		msg_report(MSG_CACHE_WRITE_FAIL, filename);
+	}
+
+	/* Don't leave a partial cache behind to be found by a later run. */
+
+	if (file != NULL && (result == false || writer.failed))
+		remove(filename);
+
+	manual_cache_free_writer(&writer);
+
+	stats_record(&timer, "cache", filename);
+
+	return result;
+}
+
+/**
+ * Release a loaded cache, once the manual which refers to its contents
+ * is no longer required.
+ *
+ * \param *cache	The cache to release, or NULL.
+ */
+
+void manual_cache_close(struct manual_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+#ifdef LINUX
+	if (cache->mapped)
+		munmap(cache->data, cache->size);
+	else
+		free(cache->data);
+#else
+	free(cache->data);
+#endif
+
+	free(cache);
+}
+
+/**
+ * Calculate a hash identifying the build of XMLMan and the layout of the
+ * records in a cache file, so that caches from other builds are ignored.
+ *
+ * \return		The build hash.
+ */
+
+static uint64_t manual_cache_build_hash(void)
+{
+	uint64_t	hash;
+	size_t		sizes[6];
+
+	sizes[0] = sizeof(struct manual_cache_header);
+	sizes[1] = sizeof(struct manual_cache_source);
+	sizes[2] = sizeof(struct manual_cache_node);
+	sizes[3] = sizeof(struct manual_cache_annotations);
+	sizes[4] = sizeof(struct manual_cache_resources);
+	sizes[5] = MANUAL_DATA_OBJECT_TYPE_NONE;
+
+	hash = string_hash(BUILD_VERSION, strlen(BUILD_VERSION), STRING_HASH_INITIAL);
+	hash = string_hash(BUILD_DATE, strlen(BUILD_DATE), hash);
+
+	return string_hash(sizes, sizeof(sizes), hash);
+}
+
+/**
+ * Read the contents of a cache file into memory, mapping it if the
+ * platform allows.
+ *
+ * \param *filename	The name of the file to read.
+ * \param *cache	The cache block to take the contents.
+ * \return		True if successful; otherwise False.
+ */
+
+static bool manual_cache_read_file(char *filename, struct manual_cache *cache)
+{
+#ifdef LINUX
+	int		handle;
+	struct stat	status;
+	void		*data;
+
+	handle = open(filename, O_RDONLY);
+	if (handle == -1)
+		return false;
+
+	if (fstat(handle, &status) != 0 || status.st_size <= 0) {
+		close(handle);
+		return false;
+	}
+
+	/* The mapping is private, so that the manual is free to treat its
+	 * strings as its own.
+	 */
+
+	data = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, handle, 0);
+	close(handle);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	cache->data = data;
+	cache->size = status.st_size;
+	cache->mapped = true;
+
+	return true;
+#else
+	FILE	*file;
+	long	size;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return false;
+
+	if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) <= 0 || fseek(file, 0, SEEK_SET) != 0) {
+		fclose(file);
+		return false;
+	}
+
+	cache->data = malloc(size);
+	if (cache->data == NULL) {
+		msg_report(MSG_CACHE_NO_MEM);
+		fclose(file);
+		return false;
+	}
+
+	if (fread(cache->data, size, 1, file) != 1) {
+		free(cache->data);
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+
+	cache->size = size;
+	cache->mapped = false;
+
+	return true;
+#endif
+}
+
+/**
+ * Check that a source file recorded in a cache is unchanged.
+ *
+ * \param *path		The name of the source file.
+ * \param hash		The hash recorded for the file.
+ * \param length	The length recorded for the file.
+ * \return		True if the file is unchanged; otherwise False.
+ */
+
+static bool manual_cache_check_source(char *path, uint64_t hash, uint64_t length)
+{
+	FILE		*file;
+	char		buffer[MANUAL_CACHE_READ_BLOCK];
+	size_t		read;
+	uint64_t	total = 0, current = STRING_HASH_INITIAL;
+
+	if (path == NULL)
+		return false;
+
+	file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	while ((read = fread(buffer, sizeof(char), MANUAL_CACHE_READ_BLOCK, file)) > 0) {
+		current = string_hash(buffer, read, current);
+		total += read;
+	}
+
+	fclose(file);
+
+	return (total == length && current == hash) ? true : false;
+}
+
+/**
+ * Restore a node from its record in a cache file.
+ *
+ * \param *reader	The reader for the cache.
+ * \param *node		The node to be restored.
+ * \param *record	The record from which to restore the node.
+ * \return		True if successful; False if the record is invalid.
+ */
+
+static bool manual_cache_restore_node(struct manual_cache_reader *reader, struct manual_data *node, struct manual_cache_node *record)
+{
+	if (record->type >= MANUAL_DATA_OBJECT_TYPE_NONE)
+		return false;
+
+	node->type = record->type;
+	node->flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
+	node->processed = false;
+	node->index = record->index;
+	node->title = manual_cache_get_node(reader, record->title);
+	node->first_child = manual_cache_get_node(reader, record->first_child);
+	node->parent = manual_cache_get_node(reader, record->parent);
+	node->previous = manual_cache_get_node(reader, record->previous);
+	node->next = manual_cache_get_node(reader, record->next);
+
+	if (record->annotations == MANUAL_CACHE_NULL)
+		node->annotations = NULL;
+	else if (record->annotations <= reader->annotation_count)
+		node->annotations = reader->annotations + (record->annotations - 1);
+	else
+		return false;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		node->chapter.id = manual_cache_get_string(reader, record->first);
+		node->processed = (record->flags != 0) ? true : false;
+
+		if (node->type != MANUAL_DATA_OBJECT_TYPE_MANUAL && node->type != MANUAL_DATA_OBJECT_TYPE_SECTION && !node->processed)
+			node->chapter.filename = manual_cache_get_filename(reader, record->second, FILENAME_TYPE_LEAF);
+		else if (record->second == MANUAL_CACHE_NULL)
+			node->chapter.resources = NULL;
+		else if (record->second <= reader->resource_count)
+			node->chapter.resources = reader->resources + (record->second - 1);
+		else
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		node->chapter.id = manual_cache_get_string(reader, record->first);
+		node->chapter.columns = manual_cache_get_node(reader, record->second);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		node->chapter.id = manual_cache_get_string(reader, record->first);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		node->flags = record->flags;
+		node->chunk.id = manual_cache_get_string(reader, record->first);
+		node->chunk.target = manual_cache_get_node(reader, record->second);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		node->flags = record->flags;
+		node->chunk.link = manual_cache_get_node(reader, record->first);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION:
+		node->flags = record->flags;
+		node->chunk.width = (int32_t) record->first;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		if (record->second > MANUAL_ENTITY_NONE)
+			return false;
+
+		node->flags = record->flags;
+		node->chunk.entity = record->second;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		node->flags = record->flags;
+		node->chunk.encoded = NULL;
+		node->chunk.text = manual_cache_get_string(reader, record->second);
+		break;
+
+	default:
+		node->flags = record->flags;
+		break;
+	}
+
+	return reader->valid;
+}
+
+/**
+ * Find a loaded node from its index in a cache file.
+ *
+ * \param *reader	The reader for the cache.
+ * \param index		The index of the node.
+ * \return		Pointer to the node, or NULL.
+ */
+
+static struct manual_data *manual_cache_get_node(struct manual_cache_reader *reader, uint32_t index)
+{
+	if (index == MANUAL_CACHE_NULL)
+		return NULL;
+
+	if (index > reader->node_count) {
+		reader->valid = false;
+		return NULL;
+	}
+
+	return reader->nodes + (index - 1);
+}
+
+/**
+ * Find a string from its offset into the string table of a cache file.
+ * The string table is known to be terminated, so any offset within it
+ * gives a valid string.
+ *
+ * \param *reader	The reader for the cache.
+ * \param offset	The offset of the string.
+ * \return		Pointer to the string, or NULL.
+ */
+
+static char *manual_cache_get_string(struct manual_cache_reader *reader, uint32_t offset)
+{
+	if (offset == MANUAL_CACHE_NULL)
+		return NULL;
+
+	if (offset >= reader->strings_size) {
+		reader->valid = false;
+		return NULL;
+	}
+
+	return reader->strings + offset;
+}
+
+/**
+ * Recreate a filename from its string in a cache file.
+ *
+ * \param *reader	The reader for the cache.
+ * \param offset	The offset of the filename's string.
+ * \param type		The type of filename to create.
+ * \return		Pointer to the filename, or NULL.
+ */
+
+static struct filename *manual_cache_get_filename(struct manual_cache_reader *reader, uint32_t offset, enum filename_type type)
+{
+	char *name;
+
+	name = manual_cache_get_string(reader, offset);
+	if (name == NULL)
+		return NULL;
+
+	return filename_make(name, type, FILENAME_PLATFORM_LINUX);
+}
+
+/**
+ * Restore the resources for a mode from their record in a cache file.
+ *
+ * \param *reader	The reader for the cache.
+ * \param *mode		The mode resources to be restored.
+ * \param *record	The record from which to restore the resources.
+ */
+
+static void manual_cache_restore_mode(struct manual_cache_reader *reader, struct manual_data_mode *mode, struct manual_cache_mode *record)
+{
+	mode->filename = manual_cache_get_filename(reader, record->filename, FILENAME_TYPE_LEAF);
+	mode->folder = manual_cache_get_filename(reader, record->folder, FILENAME_TYPE_DIRECTORY);
+	mode->stylesheet = manual_cache_get_filename(reader, record->stylesheet, FILENAME_TYPE_DIRECTORY);
+}
+
+/**
+ * Number a node, its siblings and everything that they refer to, adding
+ * them to the writer's node list. Annotations are numbered as they are
+ * found, too.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *node		The first node to be numbered.
+ */
+
+static void manual_cache_collect(struct manual_cache_writer *writer, struct manual_data *node)
+{
+	while (node != NULL && !writer->failed) {
+		/* Stop if the node has already been reached some other way. */
+
+		if (manual_cache_map_find(&(writer->nodes), node) != MANUAL_CACHE_NULL)
+			return;
+
+		if (!manual_cache_grow((void **) &(writer->node_list), &(writer->node_capacity), writer->node_count + 1, sizeof(struct manual_data *)) ||
+				!manual_cache_map_add(&(writer->nodes), node, writer->node_count + 1)) {
+			writer->failed = true;
+			return;
+		}
+
+		writer->node_list[writer->node_count++] = node;
+
+		if (node->annotations != NULL && manual_cache_map_find(&(writer->annotations), node->annotations) == MANUAL_CACHE_NULL) {
+			if (!manual_cache_grow((void **) &(writer->annotation_list), &(writer->annotation_capacity),
+							writer->annotation_count + 1, sizeof(struct manual_data_annotations *)) ||
+					!manual_cache_map_add(&(writer->annotations), node->annotations, writer->annotation_count + 1)) {
+				writer->failed = true;
+				return;
+			}
+
+			writer->annotation_list[writer->annotation_count++] = node->annotations;
+		}
+
+		/* Number the nodes which this one refers to. */
+
+		manual_cache_collect(writer, node->title);
+
+		switch (node->type) {
+		case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+			if (node->processed)
+				manual_cache_collect_resources(writer, node->chapter.resources);
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+		case MANUAL_DATA_OBJECT_TYPE_SECTION:
+			manual_cache_collect_resources(writer, node->chapter.resources);
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_TABLE:
+			manual_cache_collect(writer, node->chapter.columns);
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_LINK:
+			manual_cache_collect(writer, node->chunk.link);
+			break;
+
+		default:
+			break;
+		}
+
+		manual_cache_collect(writer, node->first_child);
+
+		node = node->next;
+	}
+}
+
+/**
+ * Number the nodes held in a resources block.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *resources	The resources block, or NULL.
+ */
+
+static void manual_cache_collect_resources(struct manual_cache_writer *writer, struct manual_data_resources *resources)
+{
+	if (resources == NULL)
+		return;
+
+	manual_cache_collect(writer, resources->summary);
+	manual_cache_collect(writer, resources->strapline);
+	manual_cache_collect(writer, resources->credit);
+	manual_cache_collect(writer, resources->version);
+	manual_cache_collect(writer, resources->date);
+}
+
+/**
+ * Build the record for a node in a cache file.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *node		The node to be written.
+ * \param *record	The record to take the node.
+ */
+
+static void manual_cache_build_node(struct manual_cache_writer *writer, struct manual_data *node, struct manual_cache_node *record)
+{
+	record->type = node->type;
+	record->index = node->index;
+	record->title = manual_cache_find_node(writer, node->title);
+	record->first_child = manual_cache_find_node(writer, node->first_child);
+	record->parent = manual_cache_find_node(writer, node->parent);
+	record->previous = manual_cache_find_node(writer, node->previous);
+	record->next = manual_cache_find_node(writer, node->next);
+	record->annotations = (node->annotations != NULL) ? manual_cache_map_find(&(writer->annotations), node->annotations) : MANUAL_CACHE_NULL;
+	record->flags = 0;
+	record->first = MANUAL_CACHE_NULL;
+	record->second = MANUAL_CACHE_NULL;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		record->first = manual_cache_add_string(writer, node->chapter.id);
+		record->flags = (node->processed) ? 1 : 0;
+
+		if (node->processed)
+			record->second = manual_cache_build_resources(writer, node->chapter.resources);
+		else
+			record->second = manual_cache_add_filename(writer, node->chapter.filename);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		record->first = manual_cache_add_string(writer, node->chapter.id);
+		record->second = manual_cache_build_resources(writer, node->chapter.resources);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		record->first = manual_cache_add_string(writer, node->chapter.id);
+		record->second = manual_cache_find_node(writer, node->chapter.columns);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		record->first = manual_cache_add_string(writer, node->chapter.id);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		record->flags = node->flags;
+		record->first = manual_cache_add_string(writer, node->chunk.id);
+		record->second = manual_cache_find_node(writer, node->chunk.target);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		record->flags = node->flags;
+		record->first = manual_cache_find_node(writer, node->chunk.link);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION:
+		record->flags = node->flags;
+		record->first = (uint32_t) node->chunk.width;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		record->flags = node->flags;
+		record->second = node->chunk.entity;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		record->flags = node->flags;
+		record->second = manual_cache_add_string(writer, node->chunk.text);
+		break;
+
+	default:
+		record->flags = node->flags;
+		break;
+	}
+}
+
+/**
+ * Build the record for a resources block in a cache file.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *resources	The resources block to be written, or NULL.
+ * \return		The index of the resource record.
+ */
+
+static uint32_t manual_cache_build_resources(struct manual_cache_writer *writer, struct manual_data_resources *resources)
+{
+	struct manual_cache_resources *record;
+
+	if (resources == NULL || writer->failed)
+		return MANUAL_CACHE_NULL;
+
+	if (!manual_cache_grow((void **) &(writer->resource_list), &(writer->resource_capacity),
+			writer->resource_count + 1, sizeof(struct manual_cache_resources))) {
+		writer->failed = true;
+		return MANUAL_CACHE_NULL;
+	}
+
+	record = writer->resource_list + writer->resource_count++;
+
+	manual_cache_build_mode(writer, &(resources->text), &(record->text));
+	manual_cache_build_mode(writer, &(resources->strong), &(record->strong));
+	manual_cache_build_mode(writer, &(resources->html), &(record->html));
+
+	record->images = manual_cache_add_filename(writer, resources->images);
+	record->downloads = manual_cache_add_filename(writer, resources->downloads);
+	record->summary = manual_cache_find_node(writer, resources->summary);
+	record->strapline = manual_cache_find_node(writer, resources->strapline);
+	record->credit = manual_cache_find_node(writer, resources->credit);
+	record->version = manual_cache_find_node(writer, resources->version);
+	record->date = manual_cache_find_node(writer, resources->date);
+
+	return writer->resource_count;
+}
+
+/**
+ * Build the record for the resources of a mode in a cache file.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *mode		The mode resources to be written.
+ * \param *record	The record to take the resources.
+ */
+
+static void manual_cache_build_mode(struct manual_cache_writer *writer, struct manual_data_mode *mode, struct manual_cache_mode *record)
+{
+	record->filename = manual_cache_add_filename(writer, mode->filename);
+	record->folder = manual_cache_add_filename(writer, mode->folder);
+	record->stylesheet = manual_cache_add_filename(writer, mode->stylesheet);
+}
+
+/**
+ * Add a string to the string table of a cache file.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *text		The string to add, or NULL.
+ * \return		The offset of the string.
+ */
+
+static uint32_t manual_cache_add_string(struct manual_cache_writer *writer, char *text)
+{
+	size_t length, offset;
+
+	if (text == NULL || writer->failed)
+		return MANUAL_CACHE_NULL;
+
+	length = strlen(text) + 1;
+
+	if (writer->strings_size + length > UINT32_MAX ||
+			!manual_cache_grow((void **) &(writer->strings), &(writer->strings_capacity), writer->strings_size + length, sizeof(char))) {
+		writer->failed = true;
+		return MANUAL_CACHE_NULL;
+	}
+
+	offset = writer->strings_size;
+	memcpy(writer->strings + offset, text, length);
+	writer->strings_size += length;
+
+	return offset;
+}
+
+/**
+ * Add a filename to the string table of a cache file, in Linux format.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *name		The filename to add, or NULL.
+ * \return		The offset of the filename's string.
+ */
+
+static uint32_t manual_cache_add_filename(struct manual_cache_writer *writer, struct filename *name)
+{
+	char		*text;
+	uint32_t	offset;
+
+	if (name == NULL)
+		return MANUAL_CACHE_NULL;
+
+	text = filename_convert(name, FILENAME_PLATFORM_LINUX, 0);
+	if (text == NULL) {
+		writer->failed = true;
+		return MANUAL_CACHE_NULL;
+	}
+
+	offset = manual_cache_add_string(writer, text);
+	free(text);
+
+	return offset;
+}
+
+/**
+ * Find the index of a node in a cache file.
+ *
+ * \param *writer	The writer for the cache.
+ * \param *node		The node to find, or NULL.
+ * \return		The index of the node.
+ */
+
+static uint32_t manual_cache_find_node(struct manual_cache_writer *writer, struct manual_data *node)
+{
+	if (node == NULL)
+		return MANUAL_CACHE_NULL;
+
+	return manual_cache_map_find(&(writer->nodes), node);
+}
+
+/**
+ * Ensure that a malloc() array has room for a number of entries,
+ * doubling its size if it needs to grow.
+ *
+ * \param **array	Pointer to the array pointer, which is updated.
+ * \param *capacity	Pointer to the number of entries in the array,
+ *			which is updated.
+ * \param required	The number of entries which are required.
+ * \param size		The size of each entry.
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_cache_grow(void **array, size_t *capacity, size_t required, size_t size)
+{
+	size_t	new_capacity;
+	void	*new_array;
+
+	if (required <= *capacity)
+		return true;
+
+	new_capacity = (*capacity > 0) ? *capacity : 256;
+
+	while (new_capacity < required)
+		new_capacity *= 2;
+
+	new_array = realloc(*array, new_capacity * size);
+	if (new_array == NULL)
+		return false;
+
+	*array = new_array;
+	*capacity = new_capacity;
+
+	return true;
+}
+
+/**
+ * Free the memory used by a cache writer.
+ *
+ * \param *writer	The writer to free.
+ */
+
+static void manual_cache_free_writer(struct manual_cache_writer *writer)
+{
+	free(writer->nodes.entries);
+	free(writer->node_list);
+	free(writer->annotations.entries);
+	free(writer->annotation_list);
+	free(writer->resource_list);
+	free(writer->strings);
+}
+
+/**
+ * Add a pointer to a pointer map, growing the map if required.
+ *
+ * \param *map		The map to add the pointer to.
+ * \param *key		The pointer to add.
+ * \param value		The index which the pointer maps to.
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_cache_map_add(struct manual_cache_map *map, void *key, uint32_t value)
+{
+	struct manual_cache_map_entry	*old_entries;
+	size_t				old_size, i, slot;
+
+	/* Keep the map no more than half full, so that the probes stay short. */
+
+	if ((map->count + 1) * 2 > map->size) {
+		old_entries = map->entries;
+		old_size = map->size;
+
+		map->size = (old_size > 0) ? old_size * 2 : MANUAL_CACHE_MAP_INITIAL_SIZE;
+		map->entries = malloc(map->size * sizeof(struct manual_cache_map_entry));
+		if (map->entries == NULL) {
+			map->entries = old_entries;
+			map->size = old_size;
+			return false;
+		}
+
+		for (i = 0; i < map->size; i++)
+			map->entries[i].key = NULL;
+
+		for (i = 0; i < old_size; i++) {
+			if (old_entries[i].key == NULL)
+				continue;
+
+			slot = manual_cache_map_slot(map, old_entries[i].key);
+			map->entries[slot] = old_entries[i];
+		}
+
+		free(old_entries);
+	}
+
+	slot = manual_cache_map_slot(map, key);
+
+	if (map->entries[slot].key == NULL)
+		map->count++;
+
+	map->entries[slot].key = key;
+	map->entries[slot].value = value;
+
+	return true;
+}
+
+/**
+ * Find the index which a pointer maps to in a pointer map.
+ *
+ * \param *map		The map to search.
+ * \param *key		The pointer to find.
+ * \return		The index, or MANUAL_CACHE_NULL if not found.
+ */
+
+static uint32_t manual_cache_map_find(struct manual_cache_map *map, void *key)
+{
+	size_t slot;
+
+	if (map->size == 0 || key == NULL)
+		return MANUAL_CACHE_NULL;
+
+	slot = manual_cache_map_slot(map, key);
+
+	return (map->entries[slot].key == key) ? map->entries[slot].value : MANUAL_CACHE_NULL;
+}
+
+/**
+ * Find the slot in a pointer map which holds a pointer, or which would
+ * hold it if it were added.
+ *
+ * \param *map		The map to search.
+ * \param *key		The pointer to find.
+ * \return		The slot for the pointer.
+ */
+
+static size_t manual_cache_map_slot(struct manual_cache_map *map, void *key)
+{
+	uintptr_t	hash;
+	size_t		slot;
+
+	hash = (uintptr_t) key;
+	hash ^= hash >> 17;
+	hash *= 0x9e3779b1u;
+	hash ^= hash >> 15;
+
+	slot = hash & (map->size - 1);
+
+	while (map->entries[slot].key != NULL && map->entries[slot].key != key)
+		slot = (slot + 1) & (map->size - 1);
+
+	return slot;
+}
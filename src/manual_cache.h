@@ -0,0 +1,115 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_cache.h
+ *
+ * Pre-Parsed Document Cache Interface.
+ *
+ * A cache holds a fully linked manual in a compact binary form, so that
+ * later runs can generate outputs without parsing the XML source again.
+ * Nodes refer to each other by index rather than by address, so that the
+ * file can be mapped into memory wherever is convenient. The cache also
+ * records a hash of each source file which went into it, and is only
+ * used while all of those files are unchanged.
+ */
+
+#ifndef XMLMAN_MANUAL_CACHE_H
+#define XMLMAN_MANUAL_CACHE_H
+
+#include <stdbool.h>
+
+#include "manual.h"
+
+/**
+ * A loaded cache instance.
+ */
+
+struct manual_cache;
+
+/**
+ * Initialise the cache system. This must be called before any source
+ * files are parsed.
+ *
+ * \param enabled	True if a cache is to be written; otherwise the
+ *			source files won't be recorded.
+ */
+
+void manual_cache_initialise(bool enabled);
+
+/**
+ * Record a source file which has been read by the parser, so that its
+ * hash can be stored in any cache which is written.
+ *
+ * \param *filename	The name of the file, as it was opened.
+ * \param *data		Pointer to the contents of the file.
+ * \param length	The number of bytes in the file.
+ */
+
+void manual_cache_add_source(char *filename, char *data, long length);
+
+/**
+ * Test whether a file is a cache, by looking for the identifying header.
+ *
+ * \param *filename	The name of the file to test.
+ * \return		True if the file is a cache; otherwise False.
+ */
+
+bool manual_cache_test(char *filename);
+
+/**
+ * Load a manual from a cache, if the cache exists and all of the source
+ * files recorded in it are unchanged.
+ *
+ * \param *filename	The name of the cache file.
+ * \param **root	Pointer to a location to take a pointer to the name
+ *			of the root source file recorded in the cache, in a
+ *			malloc() block, or NULL if not required. The location
+ *			is only updated if the cache could be read.
+ * \return		Pointer to the manual, or NULL if the cache couldn't
+ *			be used.
+ */
+
+struct manual *manual_cache_load(char *filename, char **root);
+
+/**
+ * Save a linked manual to a cache, along with the hashes of the source
+ * files which have been recorded.
+ *
+ * \param *document	The manual to be saved.
+ * \param *filename	The name of the cache file.
+ * \return		True if successful; otherwise False.
+ */
+
+bool manual_cache_save(struct manual *document, char *filename);
+
+/**
+ * Release a loaded cache, once the manual which refers to its contents
+ * is no longer required.
+ *
+ * \param *cache	The cache to release, or NULL.
+ */
+
+void manual_cache_close(struct manual_cache *cache);
+
+#endif
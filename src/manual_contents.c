@@ -0,0 +1,298 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file manual_contents.c
+ *
+ * Contents List Cache, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "manual_contents.h"
+
+#include "xmlman.h"
+#include "manual_data.h"
+
+/**
+ * A contents list held in the cache.
+ */
+
+struct manual_contents_list {
+	/**
+	 * The node whose children are listed.
+	 */
+
+	struct manual_data		*parent;
+
+	/**
+	 * The entries in the list, or NULL if there are none.
+	 */
+
+	struct manual_contents_entry	*entries;
+
+	/**
+	 * The number of entries in the list.
+	 */
+
+	size_t				count;
+
+	/**
+	 * Pointer to the next list in the cache, or NULL.
+	 */
+
+	struct manual_contents_list	*next;
+};
+
+/**
+ * A contents list cache instance.
+ */
+
+struct manual_contents {
+	/**
+	 * The function used to render entry titles.
+	 */
+
+	bool				(*render)(struct manual_data *node, void **title, size_t *length);
+
+	/**
+	 * The lists which have been built. There are rarely more than a
+	 * handful in a manual, so these are held in a simple chain.
+	 */
+
+	struct manual_contents_list	*lists;
+
+	/**
+	 * Lock protecting the chain of lists, when they are requested from
+	 * more than one thread.
+	 */
+
+	pthread_mutex_t			lock;
+};
+
+/* Static Function Prototypes. */
+
+static struct manual_contents_list *manual_contents_build_list(struct manual_contents *contents, struct manual_data *parent);
+static bool manual_contents_is_listed(struct manual_data *node);
+static void manual_contents_free_list(struct manual_contents_list *list);
+
+/**
+ * Create a new contents list cache for an output.
+ *
+ * \param *render	The function to call to render the title of an
+ *			entry into a block of memory allocated with
+ *			malloc(), which the cache will take ownership of.
+ * \return		Pointer to the new cache, or NULL on failure.
+ */
+
+struct manual_contents *manual_contents_create(bool (*render)(struct manual_data *node, void **title, size_t *length))
+{
+	struct manual_contents *contents;
+
+	if (render == NULL)
+		return NULL;
+
+	contents = malloc(sizeof(struct manual_contents));
+	if (contents == NULL)
+		return NULL;
+
+	if (pthread_mutex_init(&(contents->lock), NULL) != 0) {
+		free(contents);
+		return NULL;
+	}
+
+	contents->render = render;
+	contents->lists = NULL;
+
+	return contents;
+}
+
+/**
+ * Destroy a contents list cache, freeing all of the lists held in it.
+ *
+ * \param *contents	Pointer to the cache to destroy.
+ */
+
+void manual_contents_destroy(struct manual_contents *contents)
+{
+	struct manual_contents_list *list;
+
+	if (contents == NULL)
+		return;
+
+	while (contents->lists != NULL) {
+		list = contents->lists;
+		contents->lists = list->next;
+		manual_contents_free_list(list);
+	}
+
+	pthread_mutex_destroy(&(contents->lock));
+
+	free(contents);
+}
+
+/**
+ * Return the contents list for the children of a node, building it on
+ * the first request. The list contains the chapters and sections which
+ * have titles, in document order.
+ *
+ * \param *contents	Pointer to the cache to use.
+ * \param *parent	The node whose children are to be listed.
+ * \param **entries	Pointer to a variable to take a pointer to the
+ *			entries, which remain owned by the cache.
+ * \param *count	Pointer to a variable to take the number of entries.
+ * \return		True if successful; else False.
+ */
+
+bool manual_contents_get_list(struct manual_contents *contents, struct manual_data *parent,
+		struct manual_contents_entry **entries, size_t *count)
+{
+	struct manual_contents_list *list;
+
+	if (contents == NULL || parent == NULL || entries == NULL || count == NULL)
+		return false;
+
+	/* The titles are rendered under the lock, so that each list is only
+	 * built once; a list never changes once it is in the chain.
+	 */
+
+	pthread_mutex_lock(&(contents->lock));
+
+	for (list = contents->lists; list != NULL && list->parent != parent; list = list->next);
+
+	if (list == NULL) {
+		list = manual_contents_build_list(contents, parent);
+
+		if (list != NULL) {
+			list->next = contents->lists;
+			contents->lists = list;
+		}
+	}
+
+	pthread_mutex_unlock(&(contents->lock));
+
+	if (list == NULL)
+		return false;
+
+	*entries = list->entries;
+	*count = list->count;
+
+	return true;
+}
+
+/**
+ * Build the contents list for the children of a node.
+ *
+ * \param *contents	Pointer to the cache to build the list for.
+ * \param *parent	The node whose children are to be listed.
+ * \return		Pointer to the new list, or NULL on failure.
+ */
+
+static struct manual_contents_list *manual_contents_build_list(struct manual_contents *contents, struct manual_data *parent)
+{
+	struct manual_contents_list	*list;
+	struct manual_data		*node;
+	size_t				count = 0;
+
+	list = malloc(sizeof(struct manual_contents_list));
+	if (list == NULL)
+		return NULL;
+
+	list->parent = parent;
+	list->entries = NULL;
+	list->count = 0;
+	list->next = NULL;
+
+	for (node = parent->first_child; node != NULL; node = node->next) {
+		if (manual_contents_is_listed(node))
+			count++;
+	}
+
+	if (count == 0)
+		return list;
+
+	list->entries = malloc(count * sizeof(struct manual_contents_entry));
+	if (list->entries == NULL) {
+		free(list);
+		return NULL;
+	}
+
+	for (node = parent->first_child; node != NULL; node = node->next) {
+		if (!manual_contents_is_listed(node))
+			continue;
+
+		list->entries[list->count].node = node;
+		list->entries[list->count].title = NULL;
+		list->entries[list->count].length = 0;
+
+		if (!contents->render(node, &(list->entries[list->count].title), &(list->entries[list->count].length))) {
+			manual_contents_free_list(list);
+			return NULL;
+		}
+
+		list->count++;
+	}
+
+	return list;
+}
+
+/**
+ * Test whether a node should appear in a contents list.
+ *
+ * \param *node		The node to test.
+ * \return		True if the node is listed; else False.
+ */
+
+static bool manual_contents_is_listed(struct manual_data *node)
+{
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		return (node->title != NULL) ? true : false;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Free a contents list and the titles held in it.
+ *
+ * \param *list		Pointer to the list to free.
+ */
+
+static void manual_contents_free_list(struct manual_contents_list *list)
+{
+	size_t i;
+
+	if (list == NULL)
+		return;
+
+	for (i = 0; i < list->count; i++)
+		free(list->entries[i].title);
+
+	free(list->entries);
+	free(list);
+}
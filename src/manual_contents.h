@@ -0,0 +1,106 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file manual_contents.h
+ *
+ * Contents List Cache Interface.
+ *
+ * The cache holds the entries of the chapter lists in an output, with
+ * their titles rendered once, so that the lists repeated on each page
+ * can be written out by copying.
+ */
+
+#ifndef XMLMAN_MANUAL_CONTENTS_H
+#define XMLMAN_MANUAL_CONTENTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "manual_data.h"
+
+/**
+ * A contents list cache instance.
+ */
+
+struct manual_contents;
+
+/**
+ * An entry in a contents list.
+ */
+
+struct manual_contents_entry {
+	/**
+	 * The chapter or section node which the entry lists.
+	 */
+
+	struct manual_data	*node;
+
+	/**
+	 * The rendered title of the node, in the output's format and encoding.
+	 */
+
+	void			*title;
+
+	/**
+	 * The length of the rendered title, in bytes.
+	 */
+
+	size_t			length;
+};
+
+/**
+ * Create a new contents list cache for an output.
+ *
+ * \param *render	The function to call to render the title of an
+ *			entry into a block of memory allocated with
+ *			malloc(), which the cache will take ownership of.
+ * \return		Pointer to the new cache, or NULL on failure.
+ */
+
+struct manual_contents *manual_contents_create(bool (*render)(struct manual_data *node, void **title, size_t *length));
+
+/**
+ * Destroy a contents list cache, freeing all of the lists held in it.
+ *
+ * \param *contents	Pointer to the cache to destroy.
+ */
+
+void manual_contents_destroy(struct manual_contents *contents);
+
+/**
+ * Return the contents list for the children of a node, building it on
+ * the first request. The list contains the chapters and sections which
+ * have titles, in document order.
+ *
+ * \param *contents	Pointer to the cache to use.
+ * \param *parent	The node whose children are to be listed.
+ * \param **entries	Pointer to a variable to take a pointer to the
+ *			entries, which remain owned by the cache.
+ * \param *count	Pointer to a variable to take the number of entries.
+ * \return		True if successful; else False.
+ */
+
+bool manual_contents_get_list(struct manual_contents *contents, struct manual_data *parent,
+		struct manual_contents_entry **entries, size_t *count);
+
+#endif
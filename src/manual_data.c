@@ -29,13 +29,17 @@
 
 #include <ctype.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "xmlman.h"
 #include "manual_data.h"
 
 #include "modes.h"
 #include "msg.h"
+#include "stats.h"
 
 /* Constant Declarations. */
 
@@ -51,6 +55,31 @@
 
 #define MANUAL_DATA_MAX_NUMBER_BUFFER_LEN 256
 
+/**
+ * The number of tree walk levels held on the stack, before the walk
+ * moves its frames on to the heap.
+ */
+
+#define MANUAL_DATA_WALK_LOCAL_FRAMES 16
+
+/**
+ * The size of a node which uses none of the chapter and chunk unions.
+ */
+
+#define MANUAL_DATA_SIZE_BARE (offsetof(struct manual_data, chapter))
+
+/**
+ * The size of a node which uses only the chapter ID.
+ */
+
+#define MANUAL_DATA_SIZE_ID (offsetof(struct manual_data, chapter.resources))
+
+/**
+ * The size of a node which uses only the first of the chunk unions.
+ */
+
+#define MANUAL_DATA_SIZE_CHUNK (offsetof(struct manual_data, chunk.text))
+
 /**
  * A chunk type definition structure.
  */
@@ -61,10 +90,51 @@ struct manual_data_object_type_definition {
 };
 
 /**
- * Two manual chunks for use when returning arbitary text items.
+ * A pair of manual chunks for use when returning arbitary text items.
+ */
+
+struct manual_data_chunk_pair {
+	struct manual_data	list;		/**< The chunk list, or title, node.	*/
+	struct manual_data	text;		/**< The text node.			*/
+};
+
+/**
+ * The key holding each thread's chunk pair, so that the items returned to
+ * one thread aren't overwritten by another.
+ */
+
+static pthread_key_t manual_data_chunk_key;
+
+/**
+ * Control for the one-time creation of the chunk pair key.
+ */
+
+static pthread_once_t manual_data_chunk_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the chunk pair key was created successfully.
+ */
+
+static bool manual_data_chunk_key_valid = false;
+
+/**
+ * The key holding the arena from which each thread allocates new data,
+ * or NULL to use the heap.
+ */
+
+static pthread_key_t manual_data_arena_key;
+
+/**
+ * Control for the one-time creation of the arena key.
+ */
+
+static pthread_once_t manual_data_arena_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the arena key was created successfully.
  */
 
-struct manual_data manual_data_chunk_list, manual_data_chunk_text;
+static bool manual_data_arena_key_valid = false;
 
 /**
  * The number of entries in the object type list.
@@ -72,6 +142,12 @@ struct manual_data manual_data_chunk_list, manual_data_chunk_text;
 
 static int manual_data_max_object_types = -1;
 
+/**
+ * Control for the one-time check of the object type list.
+ */
+
+static pthread_once_t manual_data_object_types_once = PTHREAD_ONCE_INIT;
+
 /**
  * The list of known object type definitions.
  */
@@ -146,11 +222,137 @@ static struct manual_data_object_type_definition manual_data_object_type_names[]
 
 /* Static Function Prototypes. */
 
+static size_t manual_data_get_size(enum manual_data_object_type type);
 static void manual_data_initialise_mode_resources(struct manual_data_mode *mode);
+static void manual_data_create_arena_key(void);
+static struct manual_data_chunk_pair *manual_data_find_chunk_pair(void);
+static void manual_data_check_object_types(void);
+static bool manual_data_format_node_number(struct manual_data *node, bool include_name, char *text, size_t length);
+static char *manual_data_copy_text(char *text);
+static struct manual_data_mode *manual_data_find_mode_resources(struct manual_data *node, enum modes_type type);
+static bool manual_data_node_has_file(struct manual_data *node, enum modes_type type);
+static struct manual_data *manual_data_find_file_node(struct manual_data *node, enum modes_type type);
+static struct manual_data *manual_data_get_folder_node(struct manual_data *node, enum modes_type type);
+static void manual_data_create_chunk_key(void);
+static void manual_data_walk_abandon(struct manual_data_walk_frame *frames, int depth,
+		bool (*leave)(struct manual_data_walk_frame *, void *), void *data);
+
+/**
+ * Select the arena from which new manual data will be allocated by the
+ * calling thread.
+ *
+ * \param *arena	Pointer to the arena to use, or NULL to allocate
+ *			from the heap.
+ */
+
+void manual_data_select_arena(struct manual_arena *arena)
+{
+	pthread_once(&manual_data_arena_once, manual_data_create_arena_key);
+
+	if (manual_data_arena_key_valid)
+		pthread_setspecific(manual_data_arena_key, arena);
+}
+
+/**
+ * Allocate a block of memory to hold data attached to a manual, from
+ * the currently selected arena.
+ *
+ * \param size		The number of bytes to allocate.
+ * \return		Pointer to the memory, or NULL on failure.
+ */
+
+void *manual_data_alloc(size_t size)
+{
+	struct manual_arena *arena = NULL;
+
+	if (manual_data_arena_key_valid)
+		arena = pthread_getspecific(manual_data_arena_key);
+
+	return manual_arena_alloc(arena, size);
+}
+
+/**
+ * Hand a block of memory claimed from the heap over to the currently
+ * selected arena, so that it lives for as long as the manual data
+ * allocated alongside it.
+ *
+ * \param *block	Pointer to the block to be adopted.
+ * \return		True if successful; False if there's no arena
+ *			selected or on failure, in which case the block
+ *			remains with the caller.
+ */
+
+bool manual_data_adopt(void *block)
+{
+	struct manual_arena *arena = NULL;
+
+	if (manual_data_arena_key_valid)
+		arena = pthread_getspecific(manual_data_arena_key);
+
+	return manual_arena_adopt(arena, block);
+}
+
+/**
+ * Create the key used to hold each thread's allocation arena, on behalf
+ * of pthread_once().
+ */
+
+static void manual_data_create_arena_key(void)
+{
+	if (pthread_key_create(&manual_data_arena_key, NULL) == 0)
+		manual_data_arena_key_valid = true;
+}
+
+/**
+ * Find the chunk pair belonging to the calling thread, creating it if
+ * it doesn't yet exist.
+ *
+ * \return		Pointer to the thread's chunk pair, or NULL on failure.
+ */
+
+static struct manual_data_chunk_pair *manual_data_find_chunk_pair(void)
+{
+	struct manual_data_chunk_pair *pair;
+
+	pthread_once(&manual_data_chunk_once, manual_data_create_chunk_key);
+
+	if (!manual_data_chunk_key_valid)
+		return NULL;
+
+	pair = pthread_getspecific(manual_data_chunk_key);
+	if (pair != NULL)
+		return pair;
+
+	pair = malloc(sizeof(struct manual_data_chunk_pair));
+	if (pair == NULL)
+		return NULL;
+
+	if (pthread_setspecific(manual_data_chunk_key, pair) != 0) {
+		free(pair);
+		return NULL;
+	}
+
+	return pair;
+}
+
+/**
+ * Create the key used to hold each thread's chunk pair, on behalf of
+ * pthread_once(). Pairs are freed when their threads exit.
+ */
+
+static void manual_data_create_chunk_key(void)
+{
+	if (pthread_key_create(&manual_data_chunk_key, free) == 0)
+		manual_data_chunk_key_valid = true;
+}
 
 /**
  * Create a new manual_data structure.
  *
+ * Only as much of the type-specific data as the type requires is
+ * allocated, so the members of the chapter and chunk unions which aren't
+ * used by the type must not be accessed.
+ *
  * \param type		The type of object to create.
  * \return		Pointer to the new structure, or NULL on failure.
  */
@@ -159,13 +361,17 @@ struct manual_data *manual_data_create(enum manual_data_object_type type)
 {
 	struct manual_data *data;
 
-	data = malloc(sizeof(struct manual_data));
+	data = manual_data_alloc(manual_data_get_size(type));
 	if (data == NULL) {
 		msg_report(MSG_DATA_MALLOC_FAIL);
 		return NULL;
 	}
 
+	stats_count(STATS_COUNTER_NODES, 1);
+
 	data->type = type;
+	data->flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
+	data->processed = false;
 
 	data->index = 0;
 	data->title = NULL;
@@ -173,13 +379,13 @@ struct manual_data *manual_data_create(enum manual_data_object_type type)
 	data->parent = NULL;
 	data->previous = NULL;
 	data->next = NULL;
+	data->annotations = NULL;
 
 	switch (type) {
 	case MANUAL_DATA_OBJECT_TYPE_INDEX:
 	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
 		data->chapter.id = NULL;
 		data->chapter.filename = NULL;
-		data->chapter.processed = false;
 		break;
 
 	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
@@ -193,31 +399,75 @@ struct manual_data *manual_data_create(enum manual_data_object_type type)
 		data->chapter.columns = NULL;
 		break;
 
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		data->chapter.id = NULL;
+		break;
+
 	case MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION:
 		data->chunk.width = 0;
 		break;
 
-	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
-		data->chapter.id = NULL;
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		data->chunk.link = NULL;
 		break;
 
 	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
-		data->chunk.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
-		data->chunk.id = NULL; // .link should also be NULL.
 		data->chunk.entity = MANUAL_ENTITY_NONE;
 		break;
 
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		data->chunk.id = NULL;
+		data->chunk.target = NULL;
+		break;
+
 	case MANUAL_DATA_OBJECT_TYPE_TEXT:
-	default:
-		data->chunk.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
-		data->chunk.id = NULL; // .link should also be NULL.
+		data->chunk.encoded = NULL;
 		data->chunk.text = NULL;
 		break;
+
+	default:
+		break;
 	}
 
 	return data;
 }
 
+/**
+ * Return the number of bytes required to hold a node of a given type,
+ * including only those members of the chapter and chunk unions which
+ * are used by the type.
+ *
+ * \param type		The type of object of interest.
+ * \return		The number of bytes to allocate for the node.
+ */
+
+static size_t manual_data_get_size(enum manual_data_object_type type)
+{
+	switch (type) {
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		return sizeof(struct manual_data);
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		return MANUAL_DATA_SIZE_ID;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION:
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		return MANUAL_DATA_SIZE_CHUNK;
+
+	default:
+		return MANUAL_DATA_SIZE_BARE;
+	}
+}
+
 /**
  * Return a pointer to an object's resources structure, if one would be
  * valid, creating it first if required.
@@ -245,7 +495,7 @@ struct manual_data_resources *manual_data_get_resources(struct manual_data *obje
 	}
 
 	if (object->chapter.resources == NULL) {
-		object->chapter.resources = malloc(sizeof(struct manual_data_resources));
+		object->chapter.resources = manual_data_alloc(sizeof(struct manual_data_resources));
 		if (object->chapter.resources == NULL) {
 			msg_report(MSG_DATA_MALLOC_FAIL);
 			return NULL;
@@ -293,18 +543,10 @@ static void manual_data_initialise_mode_resources(struct manual_data_mode *mode)
 
 const char *manual_data_find_object_name(enum manual_data_object_type type)
 {
-	int i;
-
-	if (manual_data_max_object_types <= 0) {
-		for (i = 0; manual_data_object_type_names[i].type != MANUAL_DATA_OBJECT_TYPE_NONE; i++) {
-			if (manual_data_object_type_names[i].type != i) {
-				msg_report(MSG_ELEMENT_OUT_OF_SEQ);
-				return "*error*";
-			}
-		}
+	pthread_once(&manual_data_object_types_once, manual_data_check_object_types);
 
-		manual_data_max_object_types = i;
-	}
+	if (manual_data_max_object_types <= 0)
+		return "*error*";
 
 	if (type < 0 || type >= manual_data_max_object_types)
 		return "*none*";
@@ -318,6 +560,180 @@ const char *manual_data_find_object_name(enum manual_data_object_type type)
 	return manual_data_object_type_names[type].name;
 }
 
+/**
+ * Check that the object type list is in sequence, and count its entries,
+ * on behalf of pthread_once().
+ */
+
+static void manual_data_check_object_types(void)
+{
+	int i;
+
+	for (i = 0; manual_data_object_type_names[i].type != MANUAL_DATA_OBJECT_TYPE_NONE; i++) {
+		if (manual_data_object_type_names[i].type != i) {
+			msg_report(MSG_ELEMENT_OUT_OF_SEQ);
+			return;
+		}
+	}
+
+	manual_data_max_object_types = i;
+}
+
+/**
+ * Walk a node and its descendents, without recursion, calling enter for
+ * each node before its children and leave for it afterwards. If the walk
+ * is abandoned, leave is called with the failed flag set for every node
+ * which has been entered but not left.
+ *
+ * \param *node		The first node to walk.
+ * \param *parent	The parent of the first node.
+ * \param siblings	True to walk the siblings following the first node.
+ * \param level		The level to start the walk at.
+ * \param *enter	The function to call on entering each node.
+ * \param *leave	The function to call on leaving each node, or NULL.
+ * \param *data		Data to pass to the callbacks.
+ * \return		True if successful; False if the walk was abandoned.
+ */
+
+bool manual_data_walk(struct manual_data *node, struct manual_data *parent, bool siblings, int level,
+		enum manual_data_walk_action (*enter)(struct manual_data_walk_frame *, void *),
+		bool (*leave)(struct manual_data_walk_frame *, void *), void *data)
+{
+	struct manual_data_walk_frame	local[MANUAL_DATA_WALK_LOCAL_FRAMES], *frames = local, *frame, *extended;
+	int				depth = 0, size = MANUAL_DATA_WALK_LOCAL_FRAMES, i;
+	bool				descend;
+
+	if (node == NULL || enter == NULL)
+		return true;
+
+	frames[0].node = node;
+	frames[0].parent = parent;
+	frames[0].previous = NULL;
+	frames[0].count = 0;
+
+	while (depth >= 0) {
+		frame = frames + depth;
+
+		/* At the end of a level, step back up and leave its parent. */
+
+		if (frame->node == NULL) {
+			if (--depth < 0)
+				break;
+
+			frame = frames + depth;
+			frame->up = (depth > 0) ? frame - 1 : NULL;
+			frame->failed = false;
+
+			if (leave != NULL && !leave(frame, data)) {
+				manual_data_walk_abandon(frames, depth - 1, leave, data);
+				if (frames != local)
+					free(frames);
+				return false;
+			}
+		} else {
+			frame->up = (depth > 0) ? frame - 1 : NULL;
+			frame->level = (depth > 0) ? frames[depth - 1].level : level;
+			frame->handle = NULL;
+			frame->failed = false;
+
+			descend = false;
+
+			switch (enter(frame, data)) {
+			case MANUAL_DATA_WALK_DESCEND:
+				descend = true;
+				break;
+			case MANUAL_DATA_WALK_SKIP:
+				break;
+			case MANUAL_DATA_WALK_STOP:
+				manual_data_walk_abandon(frames, depth - 1, leave, data);
+				if (frames != local)
+					free(frames);
+				return false;
+			}
+
+			/* Start a new level for the node's children. The frames
+			 * move to the heap if the walk gets too deep, so the up
+			 * links are refreshed as each node is entered.
+			 */
+
+			if (descend && frame->node->first_child != NULL) {
+				if (depth + 1 >= size) {
+					extended = (frames == local) ? malloc(2 * size * sizeof(struct manual_data_walk_frame)) :
+							realloc(frames, 2 * size * sizeof(struct manual_data_walk_frame));
+					if (extended == NULL) {
+						msg_report(MSG_DATA_MALLOC_FAIL);
+						frame->failed = true;
+						if (leave != NULL)
+							leave(frame, data);
+						manual_data_walk_abandon(frames, depth - 1, leave, data);
+						if (frames != local)
+							free(frames);
+						return false;
+					}
+
+					if (frames == local) {
+						for (i = 0; i <= depth; i++)
+							extended[i] = local[i];
+					}
+
+					frames = extended;
+					size *= 2;
+					frame = frames + depth;
+				}
+
+				depth++;
+
+				frames[depth].node = frame->node->first_child;
+				frames[depth].parent = frame->node;
+				frames[depth].previous = NULL;
+				frames[depth].count = 0;
+
+				continue;
+			}
+
+			if (descend && leave != NULL && !leave(frame, data)) {
+				manual_data_walk_abandon(frames, depth - 1, leave, data);
+				if (frames != local)
+					free(frames);
+				return false;
+			}
+		}
+
+		/* Move on to the next node at this level. */
+
+		frame->previous = frame->node;
+		frame->node = (siblings || depth > 0) ? frame->node->next : NULL;
+	}
+
+	if (frames != local)
+		free(frames);
+
+	return true;
+}
+
+/**
+ * Leave all of the nodes which have been entered during an abandoned
+ * tree walk, from the innermost outwards.
+ *
+ * \param *frames	The walk's array of frames.
+ * \param depth		The depth of the innermost node to be left.
+ * \param *leave	The function to call on leaving each node, or NULL.
+ * \param *data		Data to pass to the callback.
+ */
+
+static void manual_data_walk_abandon(struct manual_data_walk_frame *frames, int depth,
+		bool (*leave)(struct manual_data_walk_frame *, void *), void *data)
+{
+	if (leave == NULL)
+		return;
+
+	while (depth >= 0) {
+		frames[depth].failed = true;
+		leave(frames + depth, data);
+		depth--;
+	}
+}
+
 /**
  * Given a node and a current nesting level for the parent node,
  * determine the nesting level if the node is descended into.
@@ -374,7 +790,8 @@ int manual_data_get_nesting_level(struct manual_data *node, int current_level)
 
 /**
  * Given a node, return a pointer to its display number in string format,
- * or NULL if no number is defined.
+ * or NULL if no number is defined. The number is calculated when the
+ * document is linked, and remains owned by the node.
  *
  * This is the full number, including the numbers of any parent sections.
  *
@@ -384,14 +801,157 @@ int manual_data_get_nesting_level(struct manual_data *node, int current_level)
  */
 
 char *manual_data_get_node_number(struct manual_data *node, bool include_name)
+{
+	if (node == NULL || node->annotations == NULL)
+		return NULL;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		return (include_name) ? node->annotations->named_number : node->annotations->number;
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Calculate the annotations for a node, once it and all of its parents
+ * have been linked and numbered. Nodes which are numbered or which have
+ * output resources are given annotations of their own; all others share
+ * those of their parent.
+ *
+ * \param *node		The node to annotate.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_data_annotate_node(struct manual_data *node)
+{
+	struct manual_data_annotations	*annotations = NULL, *parent = NULL;
+	struct manual_data_mode		*resources = NULL;
+	struct manual_data		*top = NULL;
+	char				text[MANUAL_DATA_MAX_NUMBER_BUFFER_LEN];
+	bool				own_resources = false, numbered = false;
+	int				type;
+
+	if (node == NULL)
+		return false;
+
+	if (node->parent != NULL)
+		parent = node->parent->annotations;
+
+	for (type = 0; type < MODES_TYPE_COUNT; type++) {
+		resources = manual_data_find_mode_resources(node, type);
+		if (resources != NULL && (resources->filename != NULL || resources->folder != NULL || resources->stylesheet != NULL))
+			own_resources = true;
+	}
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		numbered = true;
+		break;
+	default:
+		break;
+	}
+
+	/* Share the parent's annotations if nothing has changed. */
+
+	if (parent != NULL && !own_resources && !numbered) {
+		node->annotations = parent;
+		return true;
+	}
+
+	annotations = manual_data_alloc(sizeof(struct manual_data_annotations));
+	if (annotations == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return false;
+	}
+
+	/* Record the file, folder and stylesheet owners for each mode. */
+
+	for (type = 0; type < MODES_TYPE_COUNT; type++) {
+		resources = manual_data_find_mode_resources(node, type);
+
+		if (manual_data_node_has_file(node, type))
+			annotations->file[type] = node;
+		else if (parent != NULL)
+			annotations->file[type] = parent->file[type];
+		else
+			annotations->file[type] = manual_data_find_file_node(node->parent, type);
+
+		if (resources != NULL && resources->folder != NULL)
+			annotations->folder[type] = node;
+		else
+			annotations->folder[type] = manual_data_get_folder_node(node->parent, type);
+
+		if (resources != NULL && resources->stylesheet != NULL)
+			annotations->stylesheet[type] = node;
+		else
+			annotations->stylesheet[type] = manual_data_get_node_stylesheet(node->parent, type);
+
+		annotations->split[type] = false;
+	}
+
+	/* Record the display numbers. */
+
+	annotations->number = NULL;
+	annotations->named_number = NULL;
+
+	if (numbered && manual_data_format_node_number(node, false, text, MANUAL_DATA_MAX_NUMBER_BUFFER_LEN)) {
+		annotations->number = manual_data_copy_text(text);
+
+		if (manual_data_format_node_number(node, true, text, MANUAL_DATA_MAX_NUMBER_BUFFER_LEN))
+			annotations->named_number = manual_data_copy_text(text);
+
+		if (annotations->number == NULL || annotations->named_number == NULL) {
+			msg_report(MSG_DATA_MALLOC_FAIL);
+			return false;
+		}
+	}
+
+	node->annotations = annotations;
+
+	/* Note in the root node's annotations that its output is split
+	 * across multiple files.
+	 */
+
+	for (top = node; top->parent != NULL; top = top->parent);
+
+	for (type = 0; type < MODES_TYPE_COUNT; type++) {
+		if (top->annotations != NULL && manual_data_node_has_file(node, type))
+			top->annotations->split[type] = true;
+	}
+
+	return true;
+}
+
+/**
+ * Write a node's display number into a buffer, in string format.
+ *
+ * This is the full number, including the numbers of any parent sections.
+ *
+ * \param *node		The node to write a number for.
+ * \param include_name	Should we prefix the number with the object name?
+ * \param *text		Pointer to the buffer to take the number.
+ * \param length	The size of the buffer, in bytes.
+ * \return		True if a number was written; otherwise False.
+ */
+
+static bool manual_data_format_node_number(struct manual_data *node, bool include_name, char *text, size_t length)
 {
 	struct manual_data	*nodes[MANUAL_DATA_MAX_NUMBER_DEPTH], *last = NULL;
-	char			*text, *separator = NULL, *name = NULL;
+	char			*separator = NULL, *name = NULL;
 	int			depth = 0, written = 0, position = 0;
 	bool			include_sections = false;
 
-	if (node == NULL)
-		return NULL;
+	if (node == NULL || text == NULL || length == 0)
+		return false;
 
 	/* Identify a node type name. */
 
@@ -443,7 +1003,7 @@ char *manual_data_get_node_number(struct manual_data *node, bool include_name)
 				(depth < MANUAL_DATA_MAX_NUMBER_DEPTH));
 
 		if (node == NULL)
-			return NULL;
+			return false;
 
 		separator = ".";
 		break;
@@ -455,30 +1015,22 @@ char *manual_data_get_node_number(struct manual_data *node, bool include_name)
 	 * and the node, and not step through.
 	 */
 	default:
-		return NULL;
+		return false;
 	}
 
 	/* If there are no nodes, something went wrong! */
 
 	if (depth == 0)
-		return NULL;
-
-	/* Claim a memory buffer. */
-
-	text = malloc(MANUAL_DATA_MAX_NUMBER_BUFFER_LEN);
-	if (text == NULL)
-		return NULL;
+		return false;
 
 	position = 0;
 
 	/* Put the object name in the buffer. */
 
 	if (include_name == true && name != NULL) {
-		written = snprintf(text + position, MANUAL_DATA_MAX_NUMBER_BUFFER_LEN - position, "%s ", name);
-		if (written < 0) {
-			free(text);
-			return NULL;
-		}
+		written = snprintf(text + position, length - position, "%s ", name);
+		if (written < 0)
+			return false;
 
 		position += written;
 	}
@@ -486,24 +1038,41 @@ char *manual_data_get_node_number(struct manual_data *node, bool include_name)
 	/* Write the number to the buffer. */
 
 	do {
-		written = snprintf(text + position, MANUAL_DATA_MAX_NUMBER_BUFFER_LEN - position, "%d%s",
+		written = snprintf(text + position, length - position, "%d%s",
 				nodes[--depth]->index, (separator == NULL) ? "" : separator);
-		if (written < 0) {
-			free(text);
-			return NULL;
-		}
+		if (written < 0)
+			return false;
 
 		position += written;
-	} while ((depth > 0) && (position < MANUAL_DATA_MAX_NUMBER_BUFFER_LEN));
+	} while ((depth > 0) && (position < length));
 
-	text[MANUAL_DATA_MAX_NUMBER_BUFFER_LEN - 1] = '\0';
+	text[length - 1] = '\0';
 
-	return text;
+	return true;
+}
+
+/**
+ * Copy a string into a block allocated from the current arena.
+ *
+ * \param *text		Pointer to the string to copy.
+ * \return		Pointer to the copy, or NULL on failure.
+ */
+
+static char *manual_data_copy_text(char *text)
+{
+	char *copy;
+
+	copy = manual_data_alloc(strlen(text) + 1);
+	if (copy != NULL)
+		strcpy(copy, text);
+
+	return copy;
 }
 
 /**
  * Search a node and its children for any filename data associated with
- * a given manual type.
+ * a given manual type. For an annotated root node, the answer is found
+ * from its annotations.
  *
  * \param *node		The node to search down from.
  * \param type		The target output type to search for.
@@ -512,24 +1081,24 @@ char *manual_data_get_node_number(struct manual_data *node, bool include_name)
 
 bool manual_data_find_filename_data(struct manual_data *node, enum modes_type type)
 {
-	struct manual_data_mode *resources = NULL;
-
 	if (node == NULL)
 		return false;
 
+	if (node->parent == NULL && node->next == NULL && node->annotations != NULL && type >= 0 && type < MODES_TYPE_COUNT)
+		return node->annotations->split[type];
+
 	while (node != NULL) {
 		switch (node->type) {
 		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
 		case MANUAL_DATA_OBJECT_TYPE_INDEX:
 		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
 		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			resources = modes_find_resources(node->chapter.resources, type);
-			if (resources == NULL)
+			if (manual_data_find_mode_resources(node, type) == NULL)
 				break;
 
 			/* If there is any filename data, our quest is over. */
 
-			if (resources->filename != NULL || resources->folder != NULL)
+			if (manual_data_node_has_file(node, type))
 				return true;
 
 			/* If there are any child nodes, search them for more sections. */
@@ -572,44 +1141,147 @@ struct filename *manual_data_get_node_filename(struct manual_data *node, struct
 	if (filename == NULL)
 		return NULL;
 
-	while (node != NULL) {
-		switch (node->type) {
-		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
-		case MANUAL_DATA_OBJECT_TYPE_INDEX:
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			resources = modes_find_resources(node->chapter.resources, type);
-			if (resources == NULL)
-				break;
+	/* Nodes below the one owning the file don't contribute to its name. */
 
-			/* Collect only the leaf filename. */
+	node = manual_data_get_file_node(node, type);
 
-			if (resources->filename != NULL && filename_is_empty(filename))
-				filename_prepend(filename, resources->filename, 0);
+	/* The leaf name is given by the node owning the file, if it has
+	 * one; otherwise, the default filename is used.
+	 */
 
-			/* Collect any folders that we find, including the
-			 * default filename if another hasn't been found.
-			 */
+	resources = manual_data_find_mode_resources(node, type);
 
-			if (resources->folder != NULL) {
-				if (root != NULL && filename_is_empty(filename))
-					filename_prepend(filename, root, 0);
+	if (resources != NULL && resources->filename != NULL)
+		filename_prepend(filename, resources->filename, 0);
+	else if (root != NULL)
+		filename_prepend(filename, root, 0);
 
-				filename_prepend(filename, resources->folder, 0);
-			}
-			break;
+	/* Collect the folders given by the owning node and its parents. */
 
-		default:
-			break;
-		}
+	for (node = manual_data_get_folder_node(node, type); node != NULL; node = manual_data_get_folder_node(node->parent, type)) {
+		resources = manual_data_find_mode_resources(node, type);
+		filename_prepend(filename, resources->folder, 0);
+	}
+
+	return filename;
+}
+
+/**
+ * Given a node, return a pointer to the first parent node which contains
+ * a filename or folder for the chosen output type. All of the nodes which
+ * share such a parent will have the same filename.
+ *
+ * \param *node		The node to return a file node for.
+ * \param type		The target output type.
+ * \return		Pointer to a node, or NULL if the node is in the
+ *			root file for the manual.
+ */
+
+struct manual_data *manual_data_get_file_node(struct manual_data *node, enum modes_type type)
+{
+	if (node == NULL)
+		return NULL;
+
+	if (node->annotations != NULL && type >= 0 && type < MODES_TYPE_COUNT)
+		return node->annotations->file[type];
+
+	return manual_data_find_file_node(node, type);
+}
+
+/**
+ * Find the resources of a node for the chosen output type.
+ *
+ * \param *node		The node to find the resources for.
+ * \param type		The target output type.
+ * \return		Pointer to the resources, or NULL if there are none.
+ */
+
+static struct manual_data_mode *manual_data_find_mode_resources(struct manual_data *node, enum modes_type type)
+{
+	if (node == NULL)
+		return NULL;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		return modes_find_resources(node->chapter.resources, type);
+
+	default:
+		break;
+	}
+
+	return NULL;
+}
+
+/**
+ * Test whether a node contains a filename or folder for the chosen
+ * output type.
+ *
+ * \param *node		The node to test.
+ * \param type		The target output type.
+ * \return		True if the node starts a new file; otherwise False.
+ */
+
+static bool manual_data_node_has_file(struct manual_data *node, enum modes_type type)
+{
+	struct manual_data_mode *resources = manual_data_find_mode_resources(node, type);
+
+	return (resources != NULL && (resources->filename != NULL || resources->folder != NULL)) ? true : false;
+}
+
+/**
+ * Search up from a node for the first parent node which contains a
+ * filename or folder for the chosen output type, for nodes which
+ * haven't been annotated.
+ *
+ * \param *node		The node to search up from.
+ * \param type		The target output type.
+ * \return		Pointer to a node, or NULL if the node is in the
+ *			root file for the manual.
+ */
+
+static struct manual_data *manual_data_find_file_node(struct manual_data *node, enum modes_type type)
+{
+	while (node != NULL) {
+		if (manual_data_node_has_file(node, type))
+			return node;
 
 		node = node->parent;
 	}
 
-	if (root != NULL && filename_is_empty(filename))
-		filename_prepend(filename, root, 0);
+	return NULL;
+}
 
-	return filename;
+/**
+ * Given a node, return a pointer to the first of it and its parents
+ * which contains a folder for the chosen output type.
+ *
+ * \param *node		The node to return a folder node for.
+ * \param type		The target output type.
+ * \return		Pointer to a node, or NULL if there is none.
+ */
+
+static struct manual_data *manual_data_get_folder_node(struct manual_data *node, enum modes_type type)
+{
+	struct manual_data_mode *resources = NULL;
+
+	if (node == NULL)
+		return NULL;
+
+	if (node->annotations != NULL && type >= 0 && type < MODES_TYPE_COUNT)
+		return node->annotations->folder[type];
+
+	while (node != NULL) {
+		resources = manual_data_find_mode_resources(node, type);
+		if (resources != NULL && resources->folder != NULL)
+			return node;
+
+		node = node->parent;
+	}
+
+	return NULL;
 }
 
 /**
@@ -628,25 +1300,16 @@ struct manual_data *manual_data_get_node_stylesheet(struct manual_data *node, en
 	if (node == NULL)
 		return NULL;
 
-	while (node != NULL) {
-		switch (node->type) {
-		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
-		case MANUAL_DATA_OBJECT_TYPE_INDEX:
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			resources = modes_find_resources(node->chapter.resources, type);
-			if (resources == NULL)
-				break;
+	if (node->annotations != NULL && type >= 0 && type < MODES_TYPE_COUNT)
+		return node->annotations->stylesheet[type];
 
-			/* Return as soon as we find a stylesheet link. */
+	while (node != NULL) {
+		resources = manual_data_find_mode_resources(node, type);
 
-			if (resources->stylesheet != NULL)
-				return node;
-			break;
+		/* Return as soon as we find a stylesheet link. */
 
-		default:
-			break;
-		}
+		if (resources != NULL && resources->stylesheet != NULL)
+			return node;
 
 		node = node->parent;
 	}
@@ -667,51 +1330,18 @@ struct manual_data *manual_data_get_node_stylesheet(struct manual_data *node, en
 
 bool manual_data_nodes_share_file(struct manual_data *node1, struct manual_data *node2, enum modes_type type)
 {
-	struct manual_data_mode *resources = NULL;
-	bool found = false;
-
 	if (node1 == NULL || node2 == NULL)
 		return false;
 
-	found = false;
-
-	while (node1 != NULL && !found) {
-		switch (node1->type) {
-		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
-		case MANUAL_DATA_OBJECT_TYPE_INDEX:
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			resources = modes_find_resources(node1->chapter.resources, type);
-			if (resources != NULL && (resources->filename != NULL || resources->folder != NULL))
-				found = true;
-			break;
-
-		default:
-			break;
-		}
+	/* Step up to the parents of the nodes owning the two files. */
 
+	node1 = manual_data_get_file_node(node1, type);
+	if (node1 != NULL)
 		node1 = node1->parent;
-	}
-
-	found = false;
-
-	while (node2 != NULL && !found) {
-		switch (node2->type) {
-		case MANUAL_DATA_OBJECT_TYPE_MANUAL:
-		case MANUAL_DATA_OBJECT_TYPE_INDEX:
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			resources = modes_find_resources(node2->chapter.resources, type);
-			if (resources != NULL && (resources->filename != NULL || resources->folder != NULL))
-				found = true;
-			break;
-
-		default:
-			break;
-		}
 
+	node2 = manual_data_get_file_node(node2, type);
+	if (node2 != NULL)
 		node2 = node2->parent;
-	}
 
 	/* Are the nodes the same? If no filenames were passed in either
 	 * case, both pointers will be NULL, which is a valid outcome: it
@@ -731,12 +1361,17 @@ bool manual_data_nodes_share_file(struct manual_data *node1, struct manual_data
 
 struct manual_data *manual_data_get_callout_name(struct manual_data* callout)
 {
-	char *title;
+	struct manual_data_chunk_pair	*pair;
+	char				*title;
 
 	if (callout == NULL || callout->type != MANUAL_DATA_OBJECT_TYPE_CALLOUT)
 		return NULL;
 
-	switch (callout->chunk.flags & MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE) {
+	pair = manual_data_find_chunk_pair();
+	if (pair == NULL)
+		return NULL;
+
+	switch (callout->flags & MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE) {
 	case MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ATTENTION:
 		title = "Attention";
 		break;
@@ -772,25 +1407,25 @@ struct manual_data *manual_data_get_callout_name(struct manual_data* callout)
 		break;
 	}
 
-	manual_data_chunk_list.type = MANUAL_DATA_OBJECT_TYPE_TITLE;
-	manual_data_chunk_list.index = 0;
-	manual_data_chunk_list.title = NULL;
-	manual_data_chunk_list.first_child = &manual_data_chunk_text;
-	manual_data_chunk_list.parent = callout;
-	manual_data_chunk_list.previous = NULL;
-	manual_data_chunk_list.next = NULL;
-	manual_data_chunk_list.chunk.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
-	manual_data_chunk_list.chunk.text = NULL;
-
-	manual_data_chunk_text.type = MANUAL_DATA_OBJECT_TYPE_TEXT;
-	manual_data_chunk_text.index = 0;
-	manual_data_chunk_text.title = NULL;
-	manual_data_chunk_text.first_child = NULL;
-	manual_data_chunk_text.parent = &manual_data_chunk_list;
-	manual_data_chunk_text.previous = NULL;
-	manual_data_chunk_text.next = NULL;
-	manual_data_chunk_text.chunk.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
-	manual_data_chunk_text.chunk.text = title;
-
-	return &manual_data_chunk_list;
+	pair->list.type = MANUAL_DATA_OBJECT_TYPE_TITLE;
+	pair->list.index = 0;
+	pair->list.title = NULL;
+	pair->list.first_child = &(pair->text);
+	pair->list.parent = callout;
+	pair->list.previous = NULL;
+	pair->list.next = NULL;
+	pair->list.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
+	pair->list.chunk.text = NULL;
+
+	pair->text.type = MANUAL_DATA_OBJECT_TYPE_TEXT;
+	pair->text.index = 0;
+	pair->text.title = NULL;
+	pair->text.first_child = NULL;
+	pair->text.parent = &(pair->list);
+	pair->text.previous = NULL;
+	pair->text.next = NULL;
+	pair->text.flags = MANUAL_DATA_OBJECT_FLAGS_NONE;
+	pair->text.chunk.text = title;
+
+	return &(pair->list);
 }
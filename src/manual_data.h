@@ -31,10 +31,44 @@
 #define XMLMAN_MANUAL_DATA_H
 
 #include "xmlman.h"
+#include "manual_arena.h"
 #include "manual_entity.h"
 #include "modes.h"
 #include "filename.h"
 
+/**
+ * Select the arena from which new manual data will be allocated by the
+ * calling thread.
+ *
+ * \param *arena	Pointer to the arena to use, or NULL to allocate
+ *			from the heap.
+ */
+
+void manual_data_select_arena(struct manual_arena *arena);
+
+/**
+ * Allocate a block of memory to hold data attached to a manual, from
+ * the currently selected arena.
+ *
+ * \param size		The number of bytes to allocate.
+ * \return		Pointer to the memory, or NULL on failure.
+ */
+
+void *manual_data_alloc(size_t size);
+
+/**
+ * Hand a block of memory claimed from the heap over to the currently
+ * selected arena, so that it lives for as long as the manual data
+ * allocated alongside it.
+ *
+ * \param *block	Pointer to the block to be adopted.
+ * \return		True if successful; False if there's no arena
+ *			selected or on failure, in which case the block
+ *			remains with the caller.
+ */
+
+bool manual_data_adopt(void *block);
+
 /**
  * Create a new manual_data structure.
  *
@@ -64,6 +98,95 @@ struct manual_data_resources *manual_data_get_resources(struct manual_data *obje
 
 const char *manual_data_find_object_name(enum manual_data_object_type type);
 
+/**
+ * The actions which the enter callback of a tree walk can request.
+ */
+
+enum manual_data_walk_action {
+	MANUAL_DATA_WALK_DESCEND,	/**< Walk the node's children, then leave the node.		*/
+	MANUAL_DATA_WALK_SKIP,		/**< Move on, without walking the children or leaving the node.	*/
+	MANUAL_DATA_WALK_STOP		/**< Abandon the walk, as it has failed.			*/
+};
+
+/**
+ * A level in a tree walk, as seen by the walk's callbacks. The frames
+ * for all of the levels are held in a single array.
+ */
+
+struct manual_data_walk_frame {
+	/**
+	 * The node being visited.
+	 */
+
+	struct manual_data		*node;
+
+	/**
+	 * The parent of the nodes at this level.
+	 */
+
+	struct manual_data		*parent;
+
+	/**
+	 * The previous node visited at this level, or NULL.
+	 */
+
+	struct manual_data		*previous;
+
+	/**
+	 * The frame of the level above, or NULL at the top of the walk.
+	 */
+
+	struct manual_data_walk_frame	*up;
+
+	/**
+	 * A level for the client's use, copied from the level above
+	 * (or the walk's starting level) as each node is entered.
+	 */
+
+	int				level;
+
+	/**
+	 * A count for the client's use, set to zero at the start of the
+	 * level and kept between its nodes.
+	 */
+
+	int				count;
+
+	/**
+	 * A handle for the client's use, set to NULL as each node is
+	 * entered.
+	 */
+
+	void				*handle;
+
+	/**
+	 * True if the node is being left because the walk has been
+	 * abandoned, so that only its resources should be released.
+	 */
+
+	bool				failed;
+};
+
+/**
+ * Walk a node and its descendents, without recursion, calling enter for
+ * each node before its children and leave for it afterwards. If the walk
+ * is abandoned, leave is called with the failed flag set for every node
+ * which has been entered but not left.
+ *
+ * \param *node		The first node to walk.
+ * \param *parent	The parent of the first node.
+ * \param siblings	True to walk the siblings following the first node.
+ * \param level		The level to start the walk at.
+ * \param *enter	The function to call on entering each node.
+ * \param *leave	The function to call on leaving each node, or NULL.
+ * \param *data		Data to pass to the callbacks.
+ * \return		True if successful; False if the walk was abandoned.
+ */
+
+bool manual_data_walk(struct manual_data *node, struct manual_data *parent, bool siblings, int level,
+		enum manual_data_walk_action (*enter)(struct manual_data_walk_frame *, void *),
+		bool (*leave)(struct manual_data_walk_frame *, void *), void *data);
+
 /**
  * Given a node and a current nesting level for the parent node,
  * determine the nesting level if the node is descended into.
@@ -77,7 +200,8 @@ int manual_data_get_nesting_level(struct manual_data *node, int current_level);
 
 /**
  * Given a node, return a pointer to its display number in string format,
- * or NULL if no number is defined.
+ * or NULL if no number is defined. The number is calculated when the
+ * document is linked, and remains owned by the node.
  *
  * This is the full number, including the numbers of any parent sections.
  *
@@ -88,11 +212,24 @@ int manual_data_get_nesting_level(struct manual_data *node, int current_level);
 
 char *manual_data_get_node_number(struct manual_data *node, bool include_name);
 
+/**
+ * Calculate the annotations for a node, once it and all of its parents
+ * have been linked and numbered. Nodes which are numbered or which have
+ * output resources are given annotations of their own; all others share
+ * those of their parent.
+ *
+ * \param *node		The node to annotate.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_data_annotate_node(struct manual_data *node);
+
 #include "modes.h"
 
 /**
  * Search a node and its children for any filename data associated with
- * a given manual type.
+ * a given manual type. For an annotated root node, the answer is found
+ * from its annotations.
  *
  * \param *node		The node to search down from.
  * \param type		The target output type to search for.
@@ -113,6 +250,19 @@ bool manual_data_find_filename_data(struct manual_data *node, enum modes_type ty
 
 struct filename *manual_data_get_node_filename(struct manual_data *node, struct filename *root, enum modes_type type);
 
+/**
+ * Given a node, return a pointer to the first parent node which contains
+ * a filename or folder for the chosen output type. All of the nodes which
+ * share such a parent will have the same filename.
+ *
+ * \param *node		The node to return a file node for.
+ * \param type		The target output type.
+ * \return		Pointer to a node, or NULL if the node is in the
+ *			root file for the manual.
+ */
+
+struct manual_data *manual_data_get_file_node(struct manual_data *node, enum modes_type type);
+
 /**
  * Given a node, return a pointer to the first parent node which contains
  * a stylesheet filename for the chosen output type.
@@ -0,0 +1,204 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_encoded.c
+ *
+ * Encoded Text Cache, implementation.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "manual_encoded.h"
+
+#include "encoding.h"
+#include "manual_arena.h"
+#include "manual_data.h"
+
+/**
+ * A piece of cached text, converted into one encoding for one output mode.
+ * The entries for a chunk are chained from its encoded pointer.
+ */
+
+struct manual_data_encoded {
+	/**
+	 * Pointer to the next entry for the same chunk, or NULL.
+	 */
+
+	struct manual_data_encoded	*next;
+
+	/**
+	 * The output mode which encoded the text.
+	 */
+
+	enum modes_type			type;
+
+	/**
+	 * The encoding that the text was converted into.
+	 */
+
+	enum encoding_target		target;
+
+	/**
+	 * The length of the encoded text, in bytes.
+	 */
+
+	size_t				length;
+
+	/**
+	 * Pointer to the encoded text, which follows the entry in memory.
+	 */
+
+	char				*text;
+};
+
+/**
+ * The arena from which cached text is allocated, or NULL if the cache
+ * is not in use.
+ */
+
+static struct manual_arena *manual_encoded_arena = NULL;
+
+/**
+ * Lock protecting the cache entries and the arena, since the outputs may
+ * be written by several threads at once.
+ */
+
+static pthread_mutex_t manual_encoded_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Initialise the encoded text cache, selecting the arena from which the
+ * cached text will be allocated.
+ *
+ * \param *arena	Pointer to the arena holding the document whose
+ *			text is to be cached, or NULL to disable the cache.
+ */
+
+void manual_encoded_initialise(struct manual_arena *arena)
+{
+	manual_encoded_arena = arena;
+}
+
+/**
+ * Test whether the encoded text cache is in use.
+ *
+ * \return		True if text should be cached; otherwise False.
+ */
+
+bool manual_encoded_active(void)
+{
+	return (manual_encoded_arena != NULL) ? true : false;
+}
+
+/**
+ * Find the encoded text for a chunk, if it has already been cached.
+ *
+ * \param *chunk	Pointer to the text chunk to look up.
+ * \param type		The output mode which encoded the text.
+ * \param target	The encoding that the text was converted into.
+ * \param *length	Pointer to a variable to take the length of the
+ *			text, in bytes.
+ * \return		Pointer to the encoded text, which remains owned
+ *			by the cache, or NULL if none was found.
+ */
+
+const char *manual_encoded_find(struct manual_data *chunk, enum modes_type type, enum encoding_target target, size_t *length)
+{
+	struct manual_data_encoded	*entry;
+	const char			*text = NULL;
+
+	if (chunk == NULL || manual_encoded_arena == NULL || chunk->type != MANUAL_DATA_OBJECT_TYPE_TEXT)
+		return NULL;
+
+	pthread_mutex_lock(&manual_encoded_lock);
+
+	for (entry = chunk->chunk.encoded; entry != NULL; entry = entry->next) {
+		if (entry->type == type && entry->target == target) {
+			text = entry->text;
+			if (length != NULL)
+				*length = entry->length;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&manual_encoded_lock);
+
+	return text;
+}
+
+/**
+ * Add the encoded text for a chunk to the cache.
+ *
+ * \param *chunk	Pointer to the text chunk that was encoded.
+ * \param type		The output mode which encoded the text.
+ * \param target	The encoding that the text was converted into.
+ * \param *text		Pointer to the encoded text, which is copied.
+ * \param length	The length of the text, in bytes.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_encoded_store(struct manual_data *chunk, enum modes_type type, enum encoding_target target, const char *text, size_t length)
+{
+	struct manual_data_encoded *entry;
+
+	if (chunk == NULL || manual_encoded_arena == NULL || chunk->type != MANUAL_DATA_OBJECT_TYPE_TEXT)
+		return false;
+
+	if (text == NULL && length > 0)
+		return false;
+
+	pthread_mutex_lock(&manual_encoded_lock);
+
+	/* Another thread may have cached the same text in the meantime. */
+
+	for (entry = chunk->chunk.encoded; entry != NULL; entry = entry->next) {
+		if (entry->type == type && entry->target == target) {
+			pthread_mutex_unlock(&manual_encoded_lock);
+			return true;
+		}
+	}
+
+	entry = manual_arena_alloc(manual_encoded_arena, sizeof(struct manual_data_encoded) + length);
+	if (entry == NULL) {
+		pthread_mutex_unlock(&manual_encoded_lock);
+		return false;
+	}
+
+	entry->type = type;
+	entry->target = target;
+	entry->length = length;
+	entry->text = (char *) (entry + 1);
+
+	if (length > 0)
+		memcpy(entry->text, text, length);
+
+	entry->next = chunk->chunk.encoded;
+	chunk->chunk.encoded = entry;
+
+	pthread_mutex_unlock(&manual_encoded_lock);
+
+	return true;
+}
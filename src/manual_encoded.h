@@ -0,0 +1,90 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_encoded.h
+ *
+ * Encoded Text Cache Interface.
+ *
+ * The cache holds the text of chunks once it has been converted into an
+ * output encoding, with the format's fallbacks for unavailable characters
+ * already in place, so that text written more than once only needs to be
+ * converted the first time.
+ */
+
+#ifndef XMLMAN_MANUAL_ENCODED_H
+#define XMLMAN_MANUAL_ENCODED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "encoding.h"
+#include "manual_arena.h"
+#include "manual_data.h"
+
+/**
+ * Initialise the encoded text cache, selecting the arena from which the
+ * cached text will be allocated.
+ *
+ * \param *arena	Pointer to the arena holding the document whose
+ *			text is to be cached, or NULL to disable the cache.
+ */
+
+void manual_encoded_initialise(struct manual_arena *arena);
+
+/**
+ * Test whether the encoded text cache is in use.
+ *
+ * \return		True if text should be cached; otherwise False.
+ */
+
+bool manual_encoded_active(void);
+
+/**
+ * Find the encoded text for a chunk, if it has already been cached.
+ *
+ * \param *chunk	Pointer to the text chunk to look up.
+ * \param type		The output mode which encoded the text.
+ * \param target	The encoding that the text was converted into.
+ * \param *length	Pointer to a variable to take the length of the
+ *			text, in bytes.
+ * \return		Pointer to the encoded text, which remains owned
+ *			by the cache, or NULL if none was found.
+ */
+
+const char *manual_encoded_find(struct manual_data *chunk, enum modes_type type, enum encoding_target target, size_t *length);
+
+/**
+ * Add the encoded text for a chunk to the cache.
+ *
+ * \param *chunk	Pointer to the text chunk that was encoded.
+ * \param type		The output mode which encoded the text.
+ * \param target	The encoding that the text was converted into.
+ * \param *text		Pointer to the encoded text, which is copied.
+ * \param length	The length of the text, in bytes.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_encoded_store(struct manual_data *chunk, enum modes_type type, enum encoding_target target, const char *text, size_t length);
+
+#endif
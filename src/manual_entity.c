@@ -31,11 +31,11 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "manual_entity.h"
 
 #include "msg.h"
-#include "search_tree.h"
 
 /**
  * An entity definition structure.
@@ -48,18 +48,6 @@ struct manual_entity_definition {
 	char			**alternatives;		/**< A list of alternative names, or NULL.	*/
 };
 
-/**
- * The lookup tree instance for the entities.
- */
-
-static struct search_tree *manual_entity_search_tree = NULL;
-
-/**
- * The number of entries in the entity list.
- */
-
-static int manual_entities_max_entries = -1;
-
 /**
  * The list of known entity definitions.
  *
@@ -1622,9 +1610,2016 @@ static struct manual_entity_definition manual_entity_names[] = {
 	{ MANUAL_ENTITY_NONE,			0x7fffffff,	"",			NULL }
 };
 
+/**
+ * The number of entries in the entity list, excluding the end stop.
+ */
+
+#define MANUAL_ENTITY_MAX_ENTRIES ((int) (sizeof(manual_entity_names) / sizeof(struct manual_entity_definition)) - 1)
+
+/**
+ * An entry in the entity name lookup table.
+ */
+
+struct manual_entity_lookup {
+	const char		*name;			/**< The name of the entity.			*/
+	enum manual_entity_type	type;			/**< The type of entity.			*/
+};
+
+/**
+ * The entity names and alternative names, used to look up entity types
+ * from the source text.
+ *
+ * The order of this table is by ascending name length and then by strcmp()
+ * order within each length, so that it can be binary searched. It *must*
+ * contain every name and alternative from manual_entity_names[] above,
+ * and be updated whenever entities are added to that list.
+ */
+
+static const struct manual_entity_lookup manual_entity_lookup[] = {
+	/* 2 characters */
+
+	{ "DD",				MANUAL_ENTITY_DIFFERENTIALD_U },
+	{ "GT",				MANUAL_ENTITY_GT },
+	{ "Gg",				MANUAL_ENTITY_GG },
+	{ "Im",				MANUAL_ENTITY_IMAGE_U },
+	{ "LT",				MANUAL_ENTITY_LT },
+	{ "Ll",				MANUAL_ENTITY_LL },
+	{ "Mu",				MANUAL_ENTITY_MU_U },
+	{ "Nu",				MANUAL_ENTITY_NU_U },
+	{ "Pi",				MANUAL_ENTITY_PI_U },
+	{ "Pr",				MANUAL_ENTITY_PR },
+	{ "Re",				MANUAL_ENTITY_REAL_U },
+	{ "Sc",				MANUAL_ENTITY_SC },
+	{ "Xi",				MANUAL_ENTITY_XI_U },
+	{ "ac",				MANUAL_ENTITY_AC },
+	{ "af",				MANUAL_ENTITY_APPLYFUNCTION },
+	{ "ap",				MANUAL_ENTITY_ASYMP },
+	{ "dd",				MANUAL_ENTITY_DIFFERENTIALD_L },
+	{ "ee",				MANUAL_ENTITY_EXPONENTIALE_L },
+	{ "eg",				MANUAL_ENTITY_EG },
+	{ "el",				MANUAL_ENTITY_EL },
+	{ "gE",				MANUAL_ENTITY_GREATERFULLEQUAL },
+	{ "ge",				MANUAL_ENTITY_GE },
+	{ "gl",				MANUAL_ENTITY_GREATERLESS },
+	{ "gt",				MANUAL_ENTITY_GT },
+	{ "ic",				MANUAL_ENTITY_INVISIBLECOMMA },
+	{ "ii",				MANUAL_ENTITY_IMAGINARYI_L },
+	{ "in",				MANUAL_ENTITY_ISIN },
+	{ "it",				MANUAL_ENTITY_INVISIBLETIMES },
+	{ "lE",				MANUAL_ENTITY_LESSFULLEQUAL },
+	{ "le",				MANUAL_ENTITY_LE },
+	{ "lg",				MANUAL_ENTITY_LESSGREATER },
+	{ "lt",				MANUAL_ENTITY_LT },
+	{ "mp",				MANUAL_ENTITY_MINUSPLUS },
+	{ "mu",				MANUAL_ENTITY_MU_L },
+	{ "ne",				MANUAL_ENTITY_NE },
+	{ "ni",				MANUAL_ENTITY_NI },
+	{ "nu",				MANUAL_ENTITY_NU_L },
+	{ "oS",				MANUAL_ENTITY_CIRCLEDS_U },
+	{ "pi",				MANUAL_ENTITY_PI_L },
+	{ "pm",				MANUAL_ENTITY_PLUSMN },
+	{ "pr",				MANUAL_ENTITY_PRECEDES },
+	{ "rx",				MANUAL_ENTITY_RX },
+	{ "sc",				MANUAL_ENTITY_SUCCEEDS },
+	{ "wp",				MANUAL_ENTITY_WEIERP },
+	{ "wr",				MANUAL_ENTITY_VERTICALTILDE },
+	{ "xi",				MANUAL_ENTITY_XI_L },
+
+	/* 3 characters */
+
+	{ "AMP",			MANUAL_ENTITY_AMP },
+	{ "Acy",			MANUAL_ENTITY_ACY_U },
+	{ "Afr",			MANUAL_ENTITY_AFR_U },
+	{ "Bcy",			MANUAL_ENTITY_BCY_U },
+	{ "Bfr",			MANUAL_ENTITY_BFR_U },
+	{ "Cfr",			MANUAL_ENTITY_CAYLEYS_U },
+	{ "Chi",			MANUAL_ENTITY_CHI_U },
+	{ "Dcy",			MANUAL_ENTITY_DCY_U },
+	{ "Del",			MANUAL_ENTITY_NABLA },
+	{ "Dfr",			MANUAL_ENTITY_DFR_U },
+	{ "Dot",			MANUAL_ENTITY_UML },
+	{ "ENG",			MANUAL_ENTITY_ENG_U },
+	{ "ETH",			MANUAL_ENTITY_ETH_U },
+	{ "Ecy",			MANUAL_ENTITY_ECY_U },
+	{ "Efr",			MANUAL_ENTITY_EFR_U },
+	{ "Eta",			MANUAL_ENTITY_ETA_U },
+	{ "Fcy",			MANUAL_ENTITY_FCY_U },
+	{ "Ffr",			MANUAL_ENTITY_FFR_U },
+	{ "Gcy",			MANUAL_ENTITY_GCY_U },
+	{ "Gfr",			MANUAL_ENTITY_GFR_U },
+	{ "Hat",			MANUAL_ENTITY_HAT },
+	{ "Hfr",			MANUAL_ENTITY_HFR_U },
+	{ "Icy",			MANUAL_ENTITY_ICY_U },
+	{ "Ifr",			MANUAL_ENTITY_IMAGE_U },
+	{ "Jcy",			MANUAL_ENTITY_JCY_U },
+	{ "Jfr",			MANUAL_ENTITY_JFR_U },
+	{ "Kcy",			MANUAL_ENTITY_KCY_U },
+	{ "Kfr",			MANUAL_ENTITY_KFR_U },
+	{ "Lcy",			MANUAL_ENTITY_LCY_U },
+	{ "Lfr",			MANUAL_ENTITY_LFR_U },
+	{ "Lsh",			MANUAL_ENTITY_LSH },
+	{ "Map",			MANUAL_ENTITY_MAP },
+	{ "Mcy",			MANUAL_ENTITY_MCY_U },
+	{ "Mfr",			MANUAL_ENTITY_MFR_U },
+	{ "Ncy",			MANUAL_ENTITY_NCY_U },
+	{ "Nfr",			MANUAL_ENTITY_NFR_U },
+	{ "Ocy",			MANUAL_ENTITY_OCY_U },
+	{ "Ofr",			MANUAL_ENTITY_OFR_U },
+	{ "Pcy",			MANUAL_ENTITY_PCY_U },
+	{ "Pfr",			MANUAL_ENTITY_PFR_U },
+	{ "Phi",			MANUAL_ENTITY_PHI_U },
+	{ "Psi",			MANUAL_ENTITY_PSI_U },
+	{ "Qfr",			MANUAL_ENTITY_QFR_U },
+	{ "REG",			MANUAL_ENTITY_REG },
+	{ "Rcy",			MANUAL_ENTITY_RCY_U },
+	{ "Rfr",			MANUAL_ENTITY_REAL_U },
+	{ "Rho",			MANUAL_ENTITY_RHO_U },
+	{ "Rsh",			MANUAL_ENTITY_RSH },
+	{ "Scy",			MANUAL_ENTITY_SCY_U },
+	{ "Sfr",			MANUAL_ENTITY_SFR_U },
+	{ "Sum",			MANUAL_ENTITY_SUM },
+	{ "Tab",			MANUAL_ENTITY_TAB },
+	{ "Tau",			MANUAL_ENTITY_TAU_U },
+	{ "Tcy",			MANUAL_ENTITY_TCY_U },
+	{ "Tfr",			MANUAL_ENTITY_TFR_U },
+	{ "Ucy",			MANUAL_ENTITY_UCY_U },
+	{ "Ufr",			MANUAL_ENTITY_UFR_U },
+	{ "Vcy",			MANUAL_ENTITY_VCY_U },
+	{ "Vee",			MANUAL_ENTITY_VEE },
+	{ "Vfr",			MANUAL_ENTITY_VFR_U },
+	{ "Wfr",			MANUAL_ENTITY_WFR_U },
+	{ "Xfr",			MANUAL_ENTITY_XFR_U },
+	{ "Ycy",			MANUAL_ENTITY_YCY_U },
+	{ "Yfr",			MANUAL_ENTITY_YFR_U },
+	{ "Zcy",			MANUAL_ENTITY_ZCY_U },
+	{ "Zfr",			MANUAL_ENTITY_ZFR_U },
+	{ "acd",			MANUAL_ENTITY_ACD },
+	{ "acy",			MANUAL_ENTITY_ACY_L },
+	{ "afr",			MANUAL_ENTITY_AFR_L },
+	{ "amp",			MANUAL_ENTITY_AMP },
+	{ "ang",			MANUAL_ENTITY_ANG },
+	{ "ast",			MANUAL_ENTITY_AST },
+	{ "bcy",			MANUAL_ENTITY_BCY_L },
+	{ "bfr",			MANUAL_ENTITY_BFR_L },
+	{ "bot",			MANUAL_ENTITY_PERP },
+	{ "cfr",			MANUAL_ENTITY_CFR_L },
+	{ "chi",			MANUAL_ENTITY_CHI_L },
+	{ "cir",			MANUAL_ENTITY_CIR },
+	{ "dcy",			MANUAL_ENTITY_DCY_L },
+	{ "deg",			MANUAL_ENTITY_DEG },
+	{ "dfr",			MANUAL_ENTITY_DFR_L },
+	{ "die",			MANUAL_ENTITY_UML },
+	{ "div",			MANUAL_ENTITY_DIVIDE },
+	{ "dot",			MANUAL_ENTITY_DIACRITICALDOT },
+	{ "ecy",			MANUAL_ENTITY_ECY_L },
+	{ "efr",			MANUAL_ENTITY_EFR_L },
+	{ "egs",			MANUAL_ENTITY_EGS },
+	{ "ell",			MANUAL_ENTITY_ELL_L },
+	{ "els",			MANUAL_ENTITY_ELS },
+	{ "eng",			MANUAL_ENTITY_ENG_L },
+	{ "eta",			MANUAL_ENTITY_ETA_L },
+	{ "eth",			MANUAL_ENTITY_ETH_L },
+	{ "fcy",			MANUAL_ENTITY_FCY_L },
+	{ "ffr",			MANUAL_ENTITY_FFR_L },
+	{ "gEl",			MANUAL_ENTITY_GEL },
+	{ "gap",			MANUAL_ENTITY_GAP },
+	{ "gcy",			MANUAL_ENTITY_GCY_L },
+	{ "gel",			MANUAL_ENTITY_GREATEREQUALLESS },
+	{ "geq",			MANUAL_ENTITY_GE },
+	{ "ges",			MANUAL_ENTITY_GREATERSLANTEQUAL },
+	{ "gfr",			MANUAL_ENTITY_GFR_L },
+	{ "ggg",			MANUAL_ENTITY_GG },
+	{ "glE",			MANUAL_ENTITY_GLE },
+	{ "gla",			MANUAL_ENTITY_GLA },
+	{ "glj",			MANUAL_ENTITY_GLJ },
+	{ "hfr",			MANUAL_ENTITY_HFR_L },
+	{ "icy",			MANUAL_ENTITY_ICY_L },
+	{ "ifr",			MANUAL_ENTITY_IFR_L },
+	{ "jcy",			MANUAL_ENTITY_JCY_L },
+	{ "jfr",			MANUAL_ENTITY_JFR_L },
+	{ "kcy",			MANUAL_ENTITY_KCY_L },
+	{ "kfr",			MANUAL_ENTITY_KFR_L },
+	{ "lEg",			MANUAL_ENTITY_LEG },
+	{ "lap",			MANUAL_ENTITY_LAP },
+	{ "lat",			MANUAL_ENTITY_LAT },
+	{ "lcy",			MANUAL_ENTITY_LCY_L },
+	{ "leg",			MANUAL_ENTITY_LESSEQUALGREATER },
+	{ "leq",			MANUAL_ENTITY_LE },
+	{ "les",			MANUAL_ENTITY_LESSSLANTEQUAL },
+	{ "lfr",			MANUAL_ENTITY_LFR_L },
+	{ "lgE",			MANUAL_ENTITY_LGE },
+	{ "loz",			MANUAL_ENTITY_LOZ },
+	{ "lrm",			MANUAL_ENTITY_LRM },
+	{ "lsh",			MANUAL_ENTITY_LSH },
+	{ "map",			MANUAL_ENTITY_RIGHTTEEARROW },
+	{ "mcy",			MANUAL_ENTITY_MCY_L },
+	{ "mfr",			MANUAL_ENTITY_MFR_L },
+	{ "mho",			MANUAL_ENTITY_MHO },
+	{ "mid",			MANUAL_ENTITY_VERTICALBAR },
+	{ "nap",			MANUAL_ENTITY_NOTTILDETILDE },
+	{ "ncy",			MANUAL_ENTITY_NCY_L },
+	{ "nfr",			MANUAL_ENTITY_NFR_L },
+	{ "nge",			MANUAL_ENTITY_NOTGREATEREQUAL },
+	{ "ngt",			MANUAL_ENTITY_NOTGREATER },
+	{ "nis",			MANUAL_ENTITY_NIS },
+	{ "niv",			MANUAL_ENTITY_NI },
+	{ "nle",			MANUAL_ENTITY_NOTLESSEQUAL },
+	{ "nlt",			MANUAL_ENTITY_NOTLESS },
+	{ "not",			MANUAL_ENTITY_NOT },
+	{ "npr",			MANUAL_ENTITY_NOTPRECEDES },
+	{ "nsc",			MANUAL_ENTITY_NOTSUCCEEDS },
+	{ "num",			MANUAL_ENTITY_NUM },
+	{ "ocy",			MANUAL_ENTITY_OCY_L },
+	{ "ofr",			MANUAL_ENTITY_OFR_L },
+	{ "ogt",			MANUAL_ENTITY_OGT },
+	{ "ohm",			MANUAL_ENTITY_OMEGA_U },
+	{ "olt",			MANUAL_ENTITY_OLT },
+	{ "ord",			MANUAL_ENTITY_ORD },
+	{ "orv",			MANUAL_ENTITY_ORV },
+	{ "par",			MANUAL_ENTITY_DOUBLEVERTICALBAR },
+	{ "pcy",			MANUAL_ENTITY_PCY_L },
+	{ "pfr",			MANUAL_ENTITY_PFR_L },
+	{ "phi",			MANUAL_ENTITY_PHI_L },
+	{ "piv",			MANUAL_ENTITY_PIV_L },
+	{ "prE",			MANUAL_ENTITY_PRE },
+	{ "pre",			MANUAL_ENTITY_PRECEDESEQUAL },
+	{ "psi",			MANUAL_ENTITY_PSI_L },
+	{ "qfr",			MANUAL_ENTITY_QFR_L },
+	{ "rcy",			MANUAL_ENTITY_RCY_L },
+	{ "reg",			MANUAL_ENTITY_REG },
+	{ "rfr",			MANUAL_ENTITY_RFR_L },
+	{ "rho",			MANUAL_ENTITY_RHO_L },
+	{ "rlm",			MANUAL_ENTITY_RLM },
+	{ "rsh",			MANUAL_ENTITY_RSH },
+	{ "scE",			MANUAL_ENTITY_SCE },
+	{ "sce",			MANUAL_ENTITY_SUCCEEDSEQUAL },
+	{ "scy",			MANUAL_ENTITY_SCY_L },
+	{ "sfr",			MANUAL_ENTITY_SFR_L },
+	{ "shy",			MANUAL_ENTITY_SHY },
+	{ "sim",			MANUAL_ENTITY_SIM },
+	{ "smt",			MANUAL_ENTITY_SMT },
+	{ "sol",			MANUAL_ENTITY_SOL },
+	{ "squ",			MANUAL_ENTITY_SQUARE },
+	{ "sum",			MANUAL_ENTITY_SUM },
+	{ "tau",			MANUAL_ENTITY_TAU_L },
+	{ "tcy",			MANUAL_ENTITY_TCY_L },
+	{ "tfr",			MANUAL_ENTITY_TFR_L },
+	{ "top",			MANUAL_ENTITY_DOWNTEE },
+	{ "ucy",			MANUAL_ENTITY_UCY_L },
+	{ "ufr",			MANUAL_ENTITY_UFR_L },
+	{ "uml",			MANUAL_ENTITY_UML },
+	{ "vcy",			MANUAL_ENTITY_VCY_L },
+	{ "vfr",			MANUAL_ENTITY_VFR_L },
+	{ "wfr",			MANUAL_ENTITY_WFR_L },
+	{ "xfr",			MANUAL_ENTITY_XFR_L },
+	{ "ycy",			MANUAL_ENTITY_YCY_L },
+	{ "yen",			MANUAL_ENTITY_YEN },
+	{ "yfr",			MANUAL_ENTITY_YFR_L },
+	{ "zcy",			MANUAL_ENTITY_ZCY_L },
+	{ "zfr",			MANUAL_ENTITY_ZFR_L },
+	{ "zwj",			MANUAL_ENTITY_ZWJ },
+
+	/* 4 characters */
+
+	{ "Aopf",			MANUAL_ENTITY_AOPF_U },
+	{ "Ascr",			MANUAL_ENTITY_ASCR_U },
+	{ "Auml",			MANUAL_ENTITY_AUML_U },
+	{ "Barv",			MANUAL_ENTITY_BARV },
+	{ "Beta",			MANUAL_ENTITY_BETA_U },
+	{ "Bopf",			MANUAL_ENTITY_BOPF_U },
+	{ "Bscr",			MANUAL_ENTITY_BERNOULLIS_U },
+	{ "CHcy",			MANUAL_ENTITY_CHCY_U },
+	{ "COPY",			MANUAL_ENTITY_COPY },
+	{ "Cdot",			MANUAL_ENTITY_CDOT_U },
+	{ "Copf",			MANUAL_ENTITY_COPF_U },
+	{ "Cscr",			MANUAL_ENTITY_CSCR_U },
+	{ "DJcy",			MANUAL_ENTITY_DJCY_U },
+	{ "DScy",			MANUAL_ENTITY_DSCY_U },
+	{ "DZcy",			MANUAL_ENTITY_DZCY_U },
+	{ "Dopf",			MANUAL_ENTITY_DOPF_U },
+	{ "Dscr",			MANUAL_ENTITY_DSCR_U },
+	{ "Edot",			MANUAL_ENTITY_EDOT_U },
+	{ "Eopf",			MANUAL_ENTITY_EOPF_U },
+	{ "Escr",			MANUAL_ENTITY_ESCR_U },
+	{ "Esim",			MANUAL_ENTITY_ESIM },
+	{ "Euml",			MANUAL_ENTITY_EUML_U },
+	{ "Fopf",			MANUAL_ENTITY_FOPF_U },
+	{ "Fscr",			MANUAL_ENTITY_FOURIERTRF_U },
+	{ "GJcy",			MANUAL_ENTITY_GJCY_U },
+	{ "Gdot",			MANUAL_ENTITY_GDOT_U },
+	{ "Gopf",			MANUAL_ENTITY_GOPF_U },
+	{ "Gscr",			MANUAL_ENTITY_GSCR_U },
+	{ "Hopf",			MANUAL_ENTITY_HOPF_U },
+	{ "Hscr",			MANUAL_ENTITY_HILBERTSPACE_U },
+	{ "IEcy",			MANUAL_ENTITY_IECY_U },
+	{ "IOcy",			MANUAL_ENTITY_IOCY_U },
+	{ "Idot",			MANUAL_ENTITY_IDOT_U },
+	{ "Iopf",			MANUAL_ENTITY_IOPF_U },
+	{ "Iota",			MANUAL_ENTITY_IOTA_U },
+	{ "Iscr",			MANUAL_ENTITY_ISCR_U },
+	{ "Iuml",			MANUAL_ENTITY_IUML_U },
+	{ "Jopf",			MANUAL_ENTITY_JOPF_U },
+	{ "Jscr",			MANUAL_ENTITY_JSCR_U },
+	{ "KHcy",			MANUAL_ENTITY_KHCY_U },
+	{ "KJcy",			MANUAL_ENTITY_KJCY_U },
+	{ "Kopf",			MANUAL_ENTITY_KOPF_U },
+	{ "Kscr",			MANUAL_ENTITY_KSCR_U },
+	{ "LJcy",			MANUAL_ENTITY_LJCY_U },
+	{ "Lopf",			MANUAL_ENTITY_LOPF_U },
+	{ "Lscr",			MANUAL_ENTITY_LAPLACETRF_U },
+	{ "Mopf",			MANUAL_ENTITY_MOPF_U },
+	{ "Mscr",			MANUAL_ENTITY_MELLINTRF_U },
+	{ "NJcy",			MANUAL_ENTITY_NJCY_U },
+	{ "Nopf",			MANUAL_ENTITY_NOPF_U },
+	{ "Nscr",			MANUAL_ENTITY_NSCR_U },
+	{ "Oopf",			MANUAL_ENTITY_OOPF_U },
+	{ "Oscr",			MANUAL_ENTITY_OSCR_U },
+	{ "Ouml",			MANUAL_ENTITY_OUML_U },
+	{ "Popf",			MANUAL_ENTITY_POPF_U },
+	{ "Pscr",			MANUAL_ENTITY_PSCR_U },
+	{ "QUOT",			MANUAL_ENTITY_QUOT },
+	{ "Qopf",			MANUAL_ENTITY_QOPF_U },
+	{ "Qscr",			MANUAL_ENTITY_QSCR_U },
+	{ "Ropf",			MANUAL_ENTITY_ROPF_U },
+	{ "Rscr",			MANUAL_ENTITY_RSCR_U },
+	{ "SHcy",			MANUAL_ENTITY_SHCY_U },
+	{ "Sopf",			MANUAL_ENTITY_SOPF_U },
+	{ "Sqrt",			MANUAL_ENTITY_RADIC },
+	{ "Sscr",			MANUAL_ENTITY_SSCR_U },
+	{ "TScy",			MANUAL_ENTITY_TSCY_U },
+	{ "Topf",			MANUAL_ENTITY_TOPF_U },
+	{ "Tscr",			MANUAL_ENTITY_TSCR_U },
+	{ "Uopf",			MANUAL_ENTITY_UOPF_U },
+	{ "Upsi",			MANUAL_ENTITY_UPSIH_U },
+	{ "Uscr",			MANUAL_ENTITY_USCR_U },
+	{ "Uuml",			MANUAL_ENTITY_UUML_U },
+	{ "Vert",			MANUAL_ENTITY_VERBAR },
+	{ "Vopf",			MANUAL_ENTITY_VOPF_U },
+	{ "Vscr",			MANUAL_ENTITY_VSCR_U },
+	{ "Wopf",			MANUAL_ENTITY_WOPF_U },
+	{ "Wscr",			MANUAL_ENTITY_WSCR_U },
+	{ "Xopf",			MANUAL_ENTITY_XOPF_U },
+	{ "Xscr",			MANUAL_ENTITY_XSCR_U },
+	{ "YAcy",			MANUAL_ENTITY_YACY_U },
+	{ "YIcy",			MANUAL_ENTITY_YICY_U },
+	{ "YUcy",			MANUAL_ENTITY_YUCY_U },
+	{ "Yopf",			MANUAL_ENTITY_YOPF_U },
+	{ "Yscr",			MANUAL_ENTITY_YSCR_U },
+	{ "Yuml",			MANUAL_ENTITY_YUML_U },
+	{ "ZHcy",			MANUAL_ENTITY_ZHCY_U },
+	{ "Zdot",			MANUAL_ENTITY_ZDOT_U },
+	{ "Zeta",			MANUAL_ENTITY_ZETA_U },
+	{ "Zopf",			MANUAL_ENTITY_ZOPF_U },
+	{ "Zscr",			MANUAL_ENTITY_ZSCR_U },
+	{ "andd",			MANUAL_ENTITY_ANDD },
+	{ "andv",			MANUAL_ENTITY_ANDV },
+	{ "ange",			MANUAL_ENTITY_ANGE },
+	{ "aopf",			MANUAL_ENTITY_AOPF_L },
+	{ "apid",			MANUAL_ENTITY_APID },
+	{ "apos",			MANUAL_ENTITY_APOS },
+	{ "ascr",			MANUAL_ENTITY_ASCR_L },
+	{ "auml",			MANUAL_ENTITY_AUML_L },
+	{ "bbrk",			MANUAL_ENTITY_UNDERBRACKET },
+	{ "beta",			MANUAL_ENTITY_BETA_L },
+	{ "beth",			MANUAL_ENTITY_BETH },
+	{ "bopf",			MANUAL_ENTITY_BOPF_L },
+	{ "boxH",			MANUAL_ENTITY_BOXH },
+	{ "boxh",			MANUAL_ENTITY_HORIZONTALLINE },
+	{ "bscr",			MANUAL_ENTITY_BSCR_L },
+	{ "bsim",			MANUAL_ENTITY_BACKSIM },
+	{ "bsol",			MANUAL_ENTITY_BSOL },
+	{ "bull",			MANUAL_ENTITY_BULL },
+	{ "bump",			MANUAL_ENTITY_BUMPEQ },
+	{ "cdot",			MANUAL_ENTITY_CDOT_L },
+	{ "cent",			MANUAL_ENTITY_CENT },
+	{ "chcy",			MANUAL_ENTITY_CHCY_L },
+	{ "cirE",			MANUAL_ENTITY_CIRE },
+	{ "circ",			MANUAL_ENTITY_CIRC },
+	{ "cire",			MANUAL_ENTITY_CIRCEQ },
+	{ "comp",			MANUAL_ENTITY_COMP },
+	{ "cong",			MANUAL_ENTITY_CONG },
+	{ "copf",			MANUAL_ENTITY_COPF_L },
+	{ "copy",			MANUAL_ENTITY_COPY },
+	{ "cscr",			MANUAL_ENTITY_CSCR_L },
+	{ "csub",			MANUAL_ENTITY_CSUB },
+	{ "csup",			MANUAL_ENTITY_CSUP },
+	{ "dHar",			MANUAL_ENTITY_DHAR },
+	{ "dash",			MANUAL_ENTITY_DASH },
+	{ "diam",			MANUAL_ENTITY_DIAMOND },
+	{ "djcy",			MANUAL_ENTITY_DJCY_L },
+	{ "dopf",			MANUAL_ENTITY_DOPF_L },
+	{ "dscr",			MANUAL_ENTITY_DSCR_L },
+	{ "dscy",			MANUAL_ENTITY_DSCY_L },
+	{ "dsol",			MANUAL_ENTITY_DSOL },
+	{ "dtri",			MANUAL_ENTITY_DTRI },
+	{ "dzcy",			MANUAL_ENTITY_DZCY_L },
+	{ "eDot",			MANUAL_ENTITY_DOTEQDOT },
+	{ "ecir",			MANUAL_ENTITY_ECIR },
+	{ "edot",			MANUAL_ENTITY_EDOT_L },
+	{ "emsp",			MANUAL_ENTITY_EMSP },
+	{ "ensp",			MANUAL_ENTITY_ENSP },
+	{ "eopf",			MANUAL_ENTITY_EOPF_L },
+	{ "epar",			MANUAL_ENTITY_EPAR },
+	{ "epsi",			MANUAL_ENTITY_EPSILON_L },
+	{ "escr",			MANUAL_ENTITY_ESCR_L },
+	{ "esim",			MANUAL_ENTITY_EQUALTILDE },
+	{ "euml",			MANUAL_ENTITY_EUML_L },
+	{ "euro",			MANUAL_ENTITY_EURO },
+	{ "excl",			MANUAL_ENTITY_EXCL },
+	{ "flat",			MANUAL_ENTITY_FLAT },
+	{ "fnof",			MANUAL_ENTITY_FNOF_L },
+	{ "fopf",			MANUAL_ENTITY_FOPF_L },
+	{ "fork",			MANUAL_ENTITY_FORK },
+	{ "fscr",			MANUAL_ENTITY_FSCR_L },
+	{ "gdot",			MANUAL_ENTITY_GDOT_L },
+	{ "geqq",			MANUAL_ENTITY_GREATERFULLEQUAL },
+	{ "gjcy",			MANUAL_ENTITY_GJCY_L },
+	{ "gnap",			MANUAL_ENTITY_GNAP },
+	{ "gopf",			MANUAL_ENTITY_GOPF_L },
+	{ "gscr",			MANUAL_ENTITY_GSCR_L },
+	{ "gsim",			MANUAL_ENTITY_GREATERTILDE },
+	{ "gtcc",			MANUAL_ENTITY_GTCC },
+	{ "half",			MANUAL_ENTITY_FRAC12 },
+	{ "hbar",			MANUAL_ENTITY_HBAR_L },
+	{ "hopf",			MANUAL_ENTITY_HOPF_L },
+	{ "hscr",			MANUAL_ENTITY_HSCR_L },
+	{ "iecy",			MANUAL_ENTITY_IECY_L },
+	{ "imof",			MANUAL_ENTITY_IMOF },
+	{ "iocy",			MANUAL_ENTITY_IOCY_L },
+	{ "iopf",			MANUAL_ENTITY_IOPF_L },
+	{ "iota",			MANUAL_ENTITY_IOTA_L },
+	{ "iscr",			MANUAL_ENTITY_ISCR_L },
+	{ "isin",			MANUAL_ENTITY_ISIN },
+	{ "iuml",			MANUAL_ENTITY_IUML_L },
+	{ "jopf",			MANUAL_ENTITY_JOPF_L },
+	{ "jscr",			MANUAL_ENTITY_JSCR_L },
+	{ "khcy",			MANUAL_ENTITY_KHCY_L },
+	{ "kjcy",			MANUAL_ENTITY_KJCY_L },
+	{ "kopf",			MANUAL_ENTITY_KOPF_L },
+	{ "kscr",			MANUAL_ENTITY_KSCR_L },
+	{ "lHar",			MANUAL_ENTITY_LHAR },
+	{ "lang",			MANUAL_ENTITY_LEFTANGLEBRACKET },
+	{ "late",			MANUAL_ENTITY_LATE },
+	{ "lcub",			MANUAL_ENTITY_LBRACE },
+	{ "ldca",			MANUAL_ENTITY_LDCA },
+	{ "ldsh",			MANUAL_ENTITY_LDSH },
+	{ "leqq",			MANUAL_ENTITY_LESSFULLEQUAL },
+	{ "ljcy",			MANUAL_ENTITY_LJCY_L },
+	{ "lnap",			MANUAL_ENTITY_LNAP },
+	{ "lopf",			MANUAL_ENTITY_LOPF_L },
+	{ "lozf",			MANUAL_ENTITY_BLACKLOZENGE },
+	{ "lpar",			MANUAL_ENTITY_LPAR },
+	{ "lscr",			MANUAL_ENTITY_LSCR_L },
+	{ "lsim",			MANUAL_ENTITY_LESSTILDE },
+	{ "lsqb",			MANUAL_ENTITY_LBRACK },
+	{ "ltcc",			MANUAL_ENTITY_LTCC },
+	{ "ltri",			MANUAL_ENTITY_LTRI },
+	{ "macr",			MANUAL_ENTITY_MACR },
+	{ "male",			MANUAL_ENTITY_MALE },
+	{ "malt",			MANUAL_ENTITY_MALT },
+	{ "mlcp",			MANUAL_ENTITY_MLCP },
+	{ "mldr",			MANUAL_ENTITY_HELLIP },
+	{ "mopf",			MANUAL_ENTITY_MOPF_L },
+	{ "mscr",			MANUAL_ENTITY_MSCR_L },
+	{ "msep",			MANUAL_ENTITY_MSEP },
+	{ "nbsp",			MANUAL_ENTITY_NBSP },
+	{ "ncap",			MANUAL_ENTITY_NCAP },
+	{ "ncup",			MANUAL_ENTITY_NCUP },
+	{ "ngeq",			MANUAL_ENTITY_NOTGREATEREQUAL },
+	{ "ngtr",			MANUAL_ENTITY_NOTGREATER },
+	{ "nisd",			MANUAL_ENTITY_NISD },
+	{ "njcy",			MANUAL_ENTITY_NJCY_L },
+	{ "nldr",			MANUAL_ENTITY_NLDR },
+	{ "nleq",			MANUAL_ENTITY_NOTLESSEQUAL },
+	{ "nmid",			MANUAL_ENTITY_NOTVERTICALBAR },
+	{ "nopf",			MANUAL_ENTITY_NOPF_L },
+	{ "npar",			MANUAL_ENTITY_NOTDOUBLEVERTICALBAR },
+	{ "nscr",			MANUAL_ENTITY_NSCR_L },
+	{ "nsim",			MANUAL_ENTITY_NOTTILDE },
+	{ "nsub",			MANUAL_ENTITY_NSUB },
+	{ "nsup",			MANUAL_ENTITY_NSUP },
+	{ "ntgl",			MANUAL_ENTITY_NOTGREATERLESS },
+	{ "ntlg",			MANUAL_ENTITY_NOTLESSGREATER },
+	{ "oast",			MANUAL_ENTITY_CIRCLEDAST },
+	{ "ocir",			MANUAL_ENTITY_CIRCLEDCIRC },
+	{ "odiv",			MANUAL_ENTITY_ODIV },
+	{ "odot",			MANUAL_ENTITY_CIRCLEDOT },
+	{ "ogon",			MANUAL_ENTITY_OGON },
+	{ "oint",			MANUAL_ENTITY_CONTOURINTEGRAL },
+	{ "omid",			MANUAL_ENTITY_OMID },
+	{ "oopf",			MANUAL_ENTITY_OOPF_L },
+	{ "opar",			MANUAL_ENTITY_OPAR },
+	{ "ordf",			MANUAL_ENTITY_ORDF_L },
+	{ "ordm",			MANUAL_ENTITY_ORDM_L },
+	{ "oror",			MANUAL_ENTITY_OROR },
+	{ "oscr",			MANUAL_ENTITY_ORDER_L },
+	{ "osol",			MANUAL_ENTITY_OSOL },
+	{ "ouml",			MANUAL_ENTITY_OUML_L },
+	{ "para",			MANUAL_ENTITY_PARA },
+	{ "part",			MANUAL_ENTITY_PART },
+	{ "perp",			MANUAL_ENTITY_PERP },
+	{ "phiv",			MANUAL_ENTITY_PHIV_L },
+	{ "plus",			MANUAL_ENTITY_PLUS },
+	{ "popf",			MANUAL_ENTITY_POPF_L },
+	{ "prap",			MANUAL_ENTITY_PRAP },
+	{ "prec",			MANUAL_ENTITY_PRECEDES },
+	{ "prnE",			MANUAL_ENTITY_PRECNEQQ },
+	{ "prod",			MANUAL_ENTITY_PROD },
+	{ "prop",			MANUAL_ENTITY_PROP },
+	{ "pscr",			MANUAL_ENTITY_PSCR_L },
+	{ "qint",			MANUAL_ENTITY_IIIINT },
+	{ "qopf",			MANUAL_ENTITY_QOPF_L },
+	{ "qscr",			MANUAL_ENTITY_QSCR_L },
+	{ "quot",			MANUAL_ENTITY_QUOT },
+	{ "rHar",			MANUAL_ENTITY_RHAR },
+	{ "rang",			MANUAL_ENTITY_RIGHTANGLEBRACKET },
+	{ "rcub",			MANUAL_ENTITY_RBRACE },
+	{ "rdca",			MANUAL_ENTITY_RDCA },
+	{ "rdsh",			MANUAL_ENTITY_RDSH },
+	{ "real",			MANUAL_ENTITY_REAL_U },
+	{ "rect",			MANUAL_ENTITY_RECT },
+	{ "rhov",			MANUAL_ENTITY_RHOV_L },
+	{ "ring",			MANUAL_ENTITY_RING },
+	{ "ropf",			MANUAL_ENTITY_ROPF_L },
+	{ "rpar",			MANUAL_ENTITY_RPAR },
+	{ "rscr",			MANUAL_ENTITY_RSCR_L },
+	{ "rsqb",			MANUAL_ENTITY_RBRACK },
+	{ "rtri",			MANUAL_ENTITY_RTRI },
+	{ "scap",			MANUAL_ENTITY_SCAP },
+	{ "scnE",			MANUAL_ENTITY_SCNE },
+	{ "sdot",			MANUAL_ENTITY_SDOT },
+	{ "sect",			MANUAL_ENTITY_SECT },
+	{ "semi",			MANUAL_ENTITY_SEMI },
+	{ "sext",			MANUAL_ENTITY_SEXT },
+	{ "shcy",			MANUAL_ENTITY_SHCY_L },
+	{ "sime",			MANUAL_ENTITY_TILDEEQUAL },
+	{ "simg",			MANUAL_ENTITY_SIMG },
+	{ "siml",			MANUAL_ENTITY_SIML },
+	{ "smid",			MANUAL_ENTITY_VERTICALBAR },
+	{ "smte",			MANUAL_ENTITY_SMTE },
+	{ "solb",			MANUAL_ENTITY_SOLB },
+	{ "sopf",			MANUAL_ENTITY_SOPF_L },
+	{ "spar",			MANUAL_ENTITY_DOUBLEVERTICALBAR },
+	{ "squf",			MANUAL_ENTITY_FILLEDVERYSMALLSQUARE },
+	{ "sscr",			MANUAL_ENTITY_SSCR_L },
+	{ "succ",			MANUAL_ENTITY_SUCCEEDS },
+	{ "sung",			MANUAL_ENTITY_SUNG },
+	{ "sup1",			MANUAL_ENTITY_SUP1 },
+	{ "sup2",			MANUAL_ENTITY_SUP2 },
+	{ "sup3",			MANUAL_ENTITY_SUP3 },
+	{ "tbrk",			MANUAL_ENTITY_OVERBRACKET },
+	{ "tdot",			MANUAL_ENTITY_TRIPLEDOT },
+	{ "tint",			MANUAL_ENTITY_IIINT },
+	{ "toea",			MANUAL_ENTITY_NESEAR },
+	{ "topf",			MANUAL_ENTITY_TOPF_L },
+	{ "tosa",			MANUAL_ENTITY_SESWAR },
+	{ "trie",			MANUAL_ENTITY_TRIANGLEQ },
+	{ "tscr",			MANUAL_ENTITY_TSCR_L },
+	{ "tscy",			MANUAL_ENTITY_TSCY_L },
+	{ "uHar",			MANUAL_ENTITY_UHAR },
+	{ "uopf",			MANUAL_ENTITY_UOPF_L },
+	{ "upsi",			MANUAL_ENTITY_UPSILON_L },
+	{ "uscr",			MANUAL_ENTITY_USCR_L },
+	{ "utri",			MANUAL_ENTITY_TRIANGLE },
+	{ "uuml",			MANUAL_ENTITY_UUML_L },
+	{ "vArr",			MANUAL_ENTITY_DOUBLEUPDOWNARROW },
+	{ "varr",			MANUAL_ENTITY_UPDOWNARROW },
+	{ "vert",			MANUAL_ENTITY_VERTICALLINE },
+	{ "vopf",			MANUAL_ENTITY_VOPF_L },
+	{ "vscr",			MANUAL_ENTITY_VSCR_L },
+	{ "wopf",			MANUAL_ENTITY_WOPF_L },
+	{ "wscr",			MANUAL_ENTITY_WSCR_L },
+	{ "xcap",			MANUAL_ENTITY_INTERSECTION },
+	{ "xcup",			MANUAL_ENTITY_UNION },
+	{ "xmap",			MANUAL_ENTITY_LONGMAPSTO },
+	{ "xnis",			MANUAL_ENTITY_XNIS },
+	{ "xopf",			MANUAL_ENTITY_XOPF_L },
+	{ "xscr",			MANUAL_ENTITY_XSCR_L },
+	{ "xvee",			MANUAL_ENTITY_VEE },
+	{ "yacy",			MANUAL_ENTITY_YACY_L },
+	{ "yicy",			MANUAL_ENTITY_YICY_L },
+	{ "yopf",			MANUAL_ENTITY_YOPF_L },
+	{ "yscr",			MANUAL_ENTITY_YSCR_L },
+	{ "yucy",			MANUAL_ENTITY_YUCY_L },
+	{ "yuml",			MANUAL_ENTITY_YUML_L },
+	{ "zdot",			MANUAL_ENTITY_ZDOT_L },
+	{ "zeta",			MANUAL_ENTITY_ZETA_L },
+	{ "zhcy",			MANUAL_ENTITY_ZHCY_L },
+	{ "zopf",			MANUAL_ENTITY_ZOPF_L },
+	{ "zscr",			MANUAL_ENTITY_ZSCR_L },
+	{ "zwnj",			MANUAL_ENTITY_ZWNJ },
+
+	/* 5 characters */
+
+	{ "AElig",			MANUAL_ENTITY_AELIG_U },
+	{ "Acirc",			MANUAL_ENTITY_ACIRC_U },
+	{ "Alpha",			MANUAL_ENTITY_ALPHA_U },
+	{ "Amacr",			MANUAL_ENTITY_AMACR_U },
+	{ "Aogon",			MANUAL_ENTITY_AOGON_U },
+	{ "Aring",			MANUAL_ENTITY_ARING_U },
+	{ "Breve",			MANUAL_ENTITY_BREVE },
+	{ "Ccirc",			MANUAL_ENTITY_CCIRC_U },
+	{ "Dashv",			MANUAL_ENTITY_DASHV },
+	{ "Delta",			MANUAL_ENTITY_DELTA_U },
+	{ "Ecirc",			MANUAL_ENTITY_ECIRC_U },
+	{ "Emacr",			MANUAL_ENTITY_EMACR_U },
+	{ "Eogon",			MANUAL_ENTITY_EOGON_U },
+	{ "Equal",			MANUAL_ENTITY_EQUAL },
+	{ "Gamma",			MANUAL_ENTITY_GAMMA_U },
+	{ "Gcirc",			MANUAL_ENTITY_GCIRC_U },
+	{ "Hacek",			MANUAL_ENTITY_HACEK },
+	{ "Hcirc",			MANUAL_ENTITY_HCIRC_U },
+	{ "IJlig",			MANUAL_ENTITY_IJLIG_U },
+	{ "Icirc",			MANUAL_ENTITY_ICIRC_U },
+	{ "Imacr",			MANUAL_ENTITY_IMACR_U },
+	{ "Iogon",			MANUAL_ENTITY_IOGON_U },
+	{ "Iukcy",			MANUAL_ENTITY_IUKCY_U },
+	{ "Jcirc",			MANUAL_ENTITY_JCIRC_U },
+	{ "Jukcy",			MANUAL_ENTITY_JUKCY_U },
+	{ "Kappa",			MANUAL_ENTITY_KAPPA_U },
+	{ "OElig",			MANUAL_ENTITY_OELIG_U },
+	{ "Ocirc",			MANUAL_ENTITY_OCIRC_U },
+	{ "Omacr",			MANUAL_ENTITY_OMACR_U },
+	{ "Omega",			MANUAL_ENTITY_OMEGA_U },
+	{ "Prime",			MANUAL_ENTITY_DPRIME },
+	{ "RBarr",			MANUAL_ENTITY_RBARR },
+	{ "Scirc",			MANUAL_ENTITY_SCIRC_U },
+	{ "Sigma",			MANUAL_ENTITY_SIGMA_U },
+	{ "THORN",			MANUAL_ENTITY_THORN_U },
+	{ "TRADE",			MANUAL_ENTITY_TRADE },
+	{ "TSHcy",			MANUAL_ENTITY_TSHCY_U },
+	{ "Theta",			MANUAL_ENTITY_THETA_U },
+	{ "Tilde",			MANUAL_ENTITY_SIM },
+	{ "Ubrcy",			MANUAL_ENTITY_UBRCY_U },
+	{ "Ucirc",			MANUAL_ENTITY_UCIRC_U },
+	{ "Umacr",			MANUAL_ENTITY_UMACR_U },
+	{ "Union",			MANUAL_ENTITY_UNION },
+	{ "Uogon",			MANUAL_ENTITY_UOGON_U },
+	{ "UpTee",			MANUAL_ENTITY_PERP },
+	{ "Uring",			MANUAL_ENTITY_URING_U },
+	{ "Wcirc",			MANUAL_ENTITY_WCIRC_U },
+	{ "Wedge",			MANUAL_ENTITY_WEDGE },
+	{ "Ycirc",			MANUAL_ENTITY_YCIRC_U },
+	{ "acirc",			MANUAL_ENTITY_ACIRC_L },
+	{ "acute",			MANUAL_ENTITY_ACUTE },
+	{ "aelig",			MANUAL_ENTITY_AELIG_L },
+	{ "aleph",			MANUAL_ENTITY_ALEFSYM },
+	{ "alpha",			MANUAL_ENTITY_ALPHA_L },
+	{ "amacr",			MANUAL_ENTITY_AMACR_L },
+	{ "amalg",			MANUAL_ENTITY_AMALG },
+	{ "angle",			MANUAL_ENTITY_ANG },
+	{ "angrt",			MANUAL_ENTITY_ANGRT },
+	{ "angst",			MANUAL_ENTITY_ARING_U },
+	{ "aogon",			MANUAL_ENTITY_AOGON_L },
+	{ "aring",			MANUAL_ENTITY_ARING_L },
+	{ "asymp",			MANUAL_ENTITY_ASYMP },
+	{ "awint",			MANUAL_ENTITY_AWINT },
+	{ "bcong",			MANUAL_ENTITY_BACKCONG },
+	{ "bdquo",			MANUAL_ENTITY_BDQUO },
+	{ "bepsi",			MANUAL_ENTITY_BACKEPSILON },
+	{ "blank",			MANUAL_ENTITY_BLANK },
+	{ "blk12",			MANUAL_ENTITY_BLK12 },
+	{ "blk14",			MANUAL_ENTITY_BLK14 },
+	{ "blk34",			MANUAL_ENTITY_BLK34 },
+	{ "block",			MANUAL_ENTITY_BLOCK },
+	{ "breve",			MANUAL_ENTITY_BREVE },
+	{ "bsemi",			MANUAL_ENTITY_BSEMI },
+	{ "bsime",			MANUAL_ENTITY_BACKSIMEQ },
+	{ "bsolb",			MANUAL_ENTITY_BSOLB },
+	{ "bumpE",			MANUAL_ENTITY_BUMPE },
+	{ "bumpe",			MANUAL_ENTITY_HUMPEQUAL },
+	{ "caret",			MANUAL_ENTITY_CARET },
+	{ "caron",			MANUAL_ENTITY_HACEK },
+	{ "ccaps",			MANUAL_ENTITY_CCAPS },
+	{ "ccirc",			MANUAL_ENTITY_CCIRC_L },
+	{ "ccups",			MANUAL_ENTITY_CCUPS },
+	{ "cedil",			MANUAL_ENTITY_CEDIL },
+	{ "check",			MANUAL_ENTITY_CHECK },
+	{ "clubs",			MANUAL_ENTITY_CLUBS },
+	{ "colon",			MANUAL_ENTITY_COLON },
+	{ "comma",			MANUAL_ENTITY_COMMA },
+	{ "crarr",			MANUAL_ENTITY_CRARR },
+	{ "csube",			MANUAL_ENTITY_CSUBE },
+	{ "csupe",			MANUAL_ENTITY_CSUPE },
+	{ "ctdot",			MANUAL_ENTITY_CTDOT },
+	{ "cuepr",			MANUAL_ENTITY_CUEPR },
+	{ "cuesc",			MANUAL_ENTITY_CUESC },
+	{ "cupor",			MANUAL_ENTITY_CUPOR },
+	{ "cuvee",			MANUAL_ENTITY_CURLYVEE },
+	{ "cuwed",			MANUAL_ENTITY_CURLYWEDGE },
+	{ "cwint",			MANUAL_ENTITY_CWINT },
+	{ "dashv",			MANUAL_ENTITY_LEFTTEE },
+	{ "dblac",			MANUAL_ENTITY_DIACRITICALDOUBLEACUTE },
+	{ "ddarr",			MANUAL_ENTITY_DDARR },
+	{ "delta",			MANUAL_ENTITY_DELTA_L },
+	{ "dharl",			MANUAL_ENTITY_LEFTDOWNVECTOR },
+	{ "dharr",			MANUAL_ENTITY_RIGHTDOWNVECTOR },
+	{ "diams",			MANUAL_ENTITY_DIAMS },
+	{ "disin",			MANUAL_ENTITY_DISIN },
+	{ "doteq",			MANUAL_ENTITY_DOTEQUAL },
+	{ "dtdot",			MANUAL_ENTITY_DTDOT },
+	{ "dtrif",			MANUAL_ENTITY_BLACKTRIANGLEDOWN },
+	{ "duarr",			MANUAL_ENTITY_DOWNARROWUPARROW },
+	{ "duhar",			MANUAL_ENTITY_REVERSEUPEQUILIBRIUM },
+	{ "eDDot",			MANUAL_ENTITY_DDOTSEQ },
+	{ "ecirc",			MANUAL_ENTITY_ECIRC_L },
+	{ "efDot",			MANUAL_ENTITY_EFDOT },
+	{ "emacr",			MANUAL_ENTITY_EMACR_L },
+	{ "empty",			MANUAL_ENTITY_EMPTY },
+	{ "eogon",			MANUAL_ENTITY_EOGON_L },
+	{ "eplus",			MANUAL_ENTITY_EPLUS },
+	{ "epsiv",			MANUAL_ENTITY_EPSIV_L },
+	{ "eqsim",			MANUAL_ENTITY_EQUALTILDE },
+	{ "equiv",			MANUAL_ENTITY_EQUIV },
+	{ "erDot",			MANUAL_ENTITY_ERDOT },
+	{ "erarr",			MANUAL_ENTITY_ERARR },
+	{ "esdot",			MANUAL_ENTITY_DOTEQUAL },
+	{ "exist",			MANUAL_ENTITY_EXIST },
+	{ "fflig",			MANUAL_ENTITY_FFLIG_L },
+	{ "filig",			MANUAL_ENTITY_FILIG_L },
+	{ "fllig",			MANUAL_ENTITY_FLLIG_L },
+	{ "fltns",			MANUAL_ENTITY_FLTNS },
+	{ "forkv",			MANUAL_ENTITY_FORKV },
+	{ "frasl",			MANUAL_ENTITY_FRASL },
+	{ "frown",			MANUAL_ENTITY_FROWN },
+	{ "gamma",			MANUAL_ENTITY_GAMMA_L },
+	{ "gcirc",			MANUAL_ENTITY_GCIRC_L },
+	{ "gescc",			MANUAL_ENTITY_GESCC },
+	{ "gimel",			MANUAL_ENTITY_GIMEL },
+	{ "gnsim",			MANUAL_ENTITY_GNSIM },
+	{ "grave",			MANUAL_ENTITY_DIACRITICALGRAVE },
+	{ "gsime",			MANUAL_ENTITY_GSIME },
+	{ "gsiml",			MANUAL_ENTITY_GSIML },
+	{ "gtcir",			MANUAL_ENTITY_GTCIR },
+	{ "gtdot",			MANUAL_ENTITY_GTDOT },
+	{ "harrw",			MANUAL_ENTITY_HARRW },
+	{ "hcirc",			MANUAL_ENTITY_HCIRC_L },
+	{ "hoarr",			MANUAL_ENTITY_HOARR },
+	{ "icirc",			MANUAL_ENTITY_ICIRC_L },
+	{ "iexcl",			MANUAL_ENTITY_IEXCL },
+	{ "iiint",			MANUAL_ENTITY_IIINT },
+	{ "iiota",			MANUAL_ENTITY_IIOTA },
+	{ "ijlig",			MANUAL_ENTITY_IJLIG_L },
+	{ "imacr",			MANUAL_ENTITY_IMACR_L },
+	{ "image",			MANUAL_ENTITY_IMAGE_U },
+	{ "imath",			MANUAL_ENTITY_IMATH_L },
+	{ "imped",			MANUAL_ENTITY_IMPED_U },
+	{ "infin",			MANUAL_ENTITY_INFIN },
+	{ "iogon",			MANUAL_ENTITY_IOGON_L },
+	{ "iprod",			MANUAL_ENTITY_INTPROD },
+	{ "isinE",			MANUAL_ENTITY_ISINE },
+	{ "isins",			MANUAL_ENTITY_ISINS },
+	{ "isinv",			MANUAL_ENTITY_ISIN },
+	{ "iukcy",			MANUAL_ENTITY_IUKCY_L },
+	{ "jcirc",			MANUAL_ENTITY_JCIRC_L },
+	{ "jmath",			MANUAL_ENTITY_JMATH_L },
+	{ "jukcy",			MANUAL_ENTITY_JUKCY_L },
+	{ "kappa",			MANUAL_ENTITY_KAPPA_L },
+	{ "lAarr",			MANUAL_ENTITY_LLEFTARROW },
+	{ "lBarr",			MANUAL_ENTITY_DLBARR },
+	{ "langd",			MANUAL_ENTITY_LANGD },
+	{ "laquo",			MANUAL_ENTITY_LAQUO },
+	{ "larrb",			MANUAL_ENTITY_LEFTARROWBAR },
+	{ "lbarr",			MANUAL_ENTITY_LBARR },
+	{ "lbbrk",			MANUAL_ENTITY_LBBRK },
+	{ "lbrke",			MANUAL_ENTITY_LBRKE },
+	{ "lceil",			MANUAL_ENTITY_LCEIL },
+	{ "ldquo",			MANUAL_ENTITY_LDQUO },
+	{ "lescc",			MANUAL_ENTITY_LESCC },
+	{ "lhard",			MANUAL_ENTITY_DOWNLEFTVECTOR },
+	{ "lharu",			MANUAL_ENTITY_LEFTVECTOR },
+	{ "lhblk",			MANUAL_ENTITY_LHBLK },
+	{ "llarr",			MANUAL_ENTITY_LEFTLEFTARROWS },
+	{ "lltri",			MANUAL_ENTITY_LLTRI },
+	{ "lnsim",			MANUAL_ENTITY_LNSIM },
+	{ "loang",			MANUAL_ENTITY_LOANG },
+	{ "loarr",			MANUAL_ENTITY_LOARR },
+	{ "lobrk",			MANUAL_ENTITY_LEFTDOUBLEBRACKET },
+	{ "lopar",			MANUAL_ENTITY_LOPAR },
+	{ "lrarr",			MANUAL_ENTITY_LEFTARROWRIGHTARROW },
+	{ "lrhar",			MANUAL_ENTITY_REVERSEEQUILIBRIUM },
+	{ "lrtri",			MANUAL_ENTITY_LRTRI },
+	{ "lsime",			MANUAL_ENTITY_LSIME },
+	{ "lsimg",			MANUAL_ENTITY_LSIMG },
+	{ "lsquo",			MANUAL_ENTITY_LSQUO },
+	{ "ltcir",			MANUAL_ENTITY_LTCIR },
+	{ "ltdot",			MANUAL_ENTITY_LESSDOT },
+	{ "ltrie",			MANUAL_ENTITY_LEFTTRIANGLEEQUAL },
+	{ "ltrif",			MANUAL_ENTITY_BLACKTRIANGLELEFT },
+	{ "mDDot",			MANUAL_ENTITY_MDDOT },
+	{ "mdash",			MANUAL_ENTITY_MDASH },
+	{ "micro",			MANUAL_ENTITY_MICRO_L },
+	{ "minus",			MANUAL_ENTITY_MINUS },
+	{ "mumap",			MANUAL_ENTITY_MULTIMAP },
+	{ "nabla",			MANUAL_ENTITY_NABLA },
+	{ "napos",			MANUAL_ENTITY_NAPOS_L },
+	{ "natur",			MANUAL_ENTITY_NATUR },
+	{ "ncong",			MANUAL_ENTITY_NOTTILDEFULLEQUAL },
+	{ "ndash",			MANUAL_ENTITY_NDASH },
+	{ "neArr",			MANUAL_ENTITY_NEARR },
+	{ "nearr",			MANUAL_ENTITY_UPPERRIGHTARROW },
+	{ "ngsim",			MANUAL_ENTITY_NOTGREATERTILDE },
+	{ "nhArr",			MANUAL_ENTITY_NLEFTRIGHTARROW },
+	{ "nharr",			MANUAL_ENTITY_NHARR },
+	{ "nhpar",			MANUAL_ENTITY_NHPAR },
+	{ "nlArr",			MANUAL_ENTITY_NLEFTARROW },
+	{ "nlarr",			MANUAL_ENTITY_NLARR },
+	{ "nless",			MANUAL_ENTITY_NOTLESS },
+	{ "nlsim",			MANUAL_ENTITY_NOTLESSTILDE },
+	{ "nltri",			MANUAL_ENTITY_NOTLEFTTRIANGLE },
+	{ "notin",			MANUAL_ENTITY_NOTIN },
+	{ "notni",			MANUAL_ENTITY_NOTREVERSEELEMENT },
+	{ "nprec",			MANUAL_ENTITY_NOTPRECEDES },
+	{ "nrArr",			MANUAL_ENTITY_NRIGHTARROW },
+	{ "nrarr",			MANUAL_ENTITY_NRARR },
+	{ "nrtri",			MANUAL_ENTITY_NOTRIGHTTRIANGLE },
+	{ "nsime",			MANUAL_ENTITY_NOTTILDEEQUAL },
+	{ "nsmid",			MANUAL_ENTITY_NOTVERTICALBAR },
+	{ "nspar",			MANUAL_ENTITY_NOTDOUBLEVERTICALBAR },
+	{ "nsube",			MANUAL_ENTITY_NOTSUBSETEQUAL },
+	{ "nsucc",			MANUAL_ENTITY_NOTSUCCEEDS },
+	{ "nsupe",			MANUAL_ENTITY_NOTSUPERSETEQUAL },
+	{ "numsp",			MANUAL_ENTITY_NUMSP },
+	{ "nwArr",			MANUAL_ENTITY_NWARR },
+	{ "nwarr",			MANUAL_ENTITY_UPPERLEFTARROW },
+	{ "ocirc",			MANUAL_ENTITY_OCIRC_L },
+	{ "odash",			MANUAL_ENTITY_CIRCLEDDASH },
+	{ "oelig",			MANUAL_ENTITY_OELIG_L },
+	{ "ofcir",			MANUAL_ENTITY_OFCIR },
+	{ "ohbar",			MANUAL_ENTITY_OHBAR },
+	{ "olarr",			MANUAL_ENTITY_CIRCLEARROWLEFT },
+	{ "olcir",			MANUAL_ENTITY_OLCIR },
+	{ "oline",			MANUAL_ENTITY_OLINE },
+	{ "omacr",			MANUAL_ENTITY_OMACR_L },
+	{ "omega",			MANUAL_ENTITY_OMEGA_L },
+	{ "operp",			MANUAL_ENTITY_OPERP },
+	{ "oplus",			MANUAL_ENTITY_OPLUS },
+	{ "orarr",			MANUAL_ENTITY_CIRCLEARROWRIGHT },
+	{ "order",			MANUAL_ENTITY_ORDER_L },
+	{ "ovbar",			MANUAL_ENTITY_OVBAR },
+	{ "parsl",			MANUAL_ENTITY_PARSL },
+	{ "phone",			MANUAL_ENTITY_PHONE },
+	{ "plusb",			MANUAL_ENTITY_BOXPLUS },
+	{ "pluse",			MANUAL_ENTITY_PLUSE },
+	{ "pound",			MANUAL_ENTITY_POUND },
+	{ "prcue",			MANUAL_ENTITY_PRECEDESSLANTEQUAL },
+	{ "prime",			MANUAL_ENTITY_PRIME },
+	{ "prnap",			MANUAL_ENTITY_PRECNAPPROX },
+	{ "prsim",			MANUAL_ENTITY_PRECEDESTILDE },
+	{ "quest",			MANUAL_ENTITY_QUEST },
+	{ "rAarr",			MANUAL_ENTITY_RRIGHTARROW },
+	{ "rBarr",			MANUAL_ENTITY_DBKAROW },
+	{ "radic",			MANUAL_ENTITY_RADIC },
+	{ "rangd",			MANUAL_ENTITY_RANGD },
+	{ "range",			MANUAL_ENTITY_RANGE },
+	{ "raquo",			MANUAL_ENTITY_RAQUO },
+	{ "rarrb",			MANUAL_ENTITY_RIGHTARROWBAR },
+	{ "rarrc",			MANUAL_ENTITY_RARRC },
+	{ "rarrw",			MANUAL_ENTITY_RARRW },
+	{ "ratio",			MANUAL_ENTITY_RATIO },
+	{ "rbarr",			MANUAL_ENTITY_BKAROW },
+	{ "rbbrk",			MANUAL_ENTITY_RBBRK },
+	{ "rbrke",			MANUAL_ENTITY_RBRKE },
+	{ "rceil",			MANUAL_ENTITY_RCEIL },
+	{ "rdquo",			MANUAL_ENTITY_RDQUO },
+	{ "reals",			MANUAL_ENTITY_ROPF_U },
+	{ "rhard",			MANUAL_ENTITY_DOWNRIGHTVECTOR },
+	{ "rharu",			MANUAL_ENTITY_RIGHTVECTOR },
+	{ "rlarr",			MANUAL_ENTITY_RIGHTARROWLEFTARROW },
+	{ "rlhar",			MANUAL_ENTITY_EQUILIBRIUM },
+	{ "rnmid",			MANUAL_ENTITY_RNMID },
+	{ "roang",			MANUAL_ENTITY_ROANG },
+	{ "roarr",			MANUAL_ENTITY_ROARR },
+	{ "robrk",			MANUAL_ENTITY_RIGHTDOUBLEBRACKET },
+	{ "ropar",			MANUAL_ENTITY_ROPAR },
+	{ "rrarr",			MANUAL_ENTITY_RIGHTRIGHTARROWS },
+	{ "rsquo",			MANUAL_ENTITY_RSQUO },
+	{ "rtrie",			MANUAL_ENTITY_RIGHTTRIANGLEEQUAL },
+	{ "rtrif",			MANUAL_ENTITY_BLACKTRIANGLERIGHT },
+	{ "sbquo",			MANUAL_ENTITY_SBQUO },
+	{ "sccue",			MANUAL_ENTITY_SUCCEEDSSLANTEQUAL },
+	{ "scirc",			MANUAL_ENTITY_SCIRC_L },
+	{ "scnap",			MANUAL_ENTITY_SCNAP },
+	{ "scsim",			MANUAL_ENTITY_SUCCEEDSTILDE },
+	{ "sdotb",			MANUAL_ENTITY_DOTSQUARE },
+	{ "sdote",			MANUAL_ENTITY_SDOTE },
+	{ "seArr",			MANUAL_ENTITY_SEARR },
+	{ "searr",			MANUAL_ENTITY_LOWERRIGHTARROW },
+	{ "setmn",			MANUAL_ENTITY_BACKSLASH },
+	{ "sharp",			MANUAL_ENTITY_SHARP },
+	{ "sigma",			MANUAL_ENTITY_SIGMA_L },
+	{ "simeq",			MANUAL_ENTITY_TILDEEQUAL },
+	{ "simgE",			MANUAL_ENTITY_SIMGE },
+	{ "simlE",			MANUAL_ENTITY_SIMLE },
+	{ "simne",			MANUAL_ENTITY_SIMNE },
+	{ "smile",			MANUAL_ENTITY_SMILE },
+	{ "sqcap",			MANUAL_ENTITY_SQUAREINTERSECTION },
+	{ "sqcup",			MANUAL_ENTITY_SQUAREUNION },
+	{ "sqsub",			MANUAL_ENTITY_SQUARESUBSET },
+	{ "sqsup",			MANUAL_ENTITY_SQUARESUPERSET },
+	{ "starf",			MANUAL_ENTITY_BIGSTAR },
+	{ "strns",			MANUAL_ENTITY_MACR },
+	{ "swArr",			MANUAL_ENTITY_SWARR },
+	{ "swarr",			MANUAL_ENTITY_LOWERLEFTARROW },
+	{ "szlig",			MANUAL_ENTITY_SZLIG_L },
+	{ "theta",			MANUAL_ENTITY_THETA_L },
+	{ "thkap",			MANUAL_ENTITY_ASYMP },
+	{ "thorn",			MANUAL_ENTITY_THORN_L },
+	{ "tilde",			MANUAL_ENTITY_TILDE },
+	{ "times",			MANUAL_ENTITY_TIMES },
+	{ "trade",			MANUAL_ENTITY_TRADE },
+	{ "trisb",			MANUAL_ENTITY_TRISB },
+	{ "tshcy",			MANUAL_ENTITY_TSHCY_L },
+	{ "twixt",			MANUAL_ENTITY_BETWEEN },
+	{ "ubrcy",			MANUAL_ENTITY_UBRCY_L },
+	{ "ucirc",			MANUAL_ENTITY_UCIRC_L },
+	{ "udarr",			MANUAL_ENTITY_UPARROWDOWNARROW },
+	{ "udhar",			MANUAL_ENTITY_UPEQUILIBRIUM },
+	{ "uharl",			MANUAL_ENTITY_LEFTUPVECTOR },
+	{ "uharr",			MANUAL_ENTITY_RIGHTUPVECTOR },
+	{ "uhblk",			MANUAL_ENTITY_UHBLK },
+	{ "ultri",			MANUAL_ENTITY_ULTRI },
+	{ "umacr",			MANUAL_ENTITY_UMACR_L },
+	{ "uogon",			MANUAL_ENTITY_UOGON_L },
+	{ "uplus",			MANUAL_ENTITY_UNIONPLUS },
+	{ "upsih",			MANUAL_ENTITY_UPSIH_U },
+	{ "uring",			MANUAL_ENTITY_URING_L },
+	{ "urtri",			MANUAL_ENTITY_URTRI },
+	{ "utdot",			MANUAL_ENTITY_UTDOT },
+	{ "utrif",			MANUAL_ENTITY_BLACKTRIANGLE },
+	{ "uuarr",			MANUAL_ENTITY_UPUPARROWS },
+	{ "vBarv",			MANUAL_ENTITY_VBARV },
+	{ "vDash",			MANUAL_ENTITY_DOUBLERIGHTTEE },
+	{ "varpi",			MANUAL_ENTITY_PIV_L },
+	{ "vdash",			MANUAL_ENTITY_RIGHTTEE },
+	{ "veeeq",			MANUAL_ENTITY_VEEEQ },
+	{ "vltri",			MANUAL_ENTITY_LEFTTRIANGLE },
+	{ "vprop",			MANUAL_ENTITY_PROP },
+	{ "vrtri",			MANUAL_ENTITY_RIGHTTRIANGLE },
+	{ "wcirc",			MANUAL_ENTITY_WCIRC_L },
+	{ "xcirc",			MANUAL_ENTITY_BIGCIRC },
+	{ "xdtri",			MANUAL_ENTITY_BIGTRIANGLEDOWN },
+	{ "xhArr",			MANUAL_ENTITY_DOUBLELONGLEFTRIGHTARROW },
+	{ "xharr",			MANUAL_ENTITY_LONGLEFTRIGHTARROW },
+	{ "xlArr",			MANUAL_ENTITY_DOUBLELONGLEFTARROW },
+	{ "xlarr",			MANUAL_ENTITY_LONGLEFTARROW },
+	{ "xodot",			MANUAL_ENTITY_BIGODOT },
+	{ "xrArr",			MANUAL_ENTITY_DOUBLELONGRIGHTARROW },
+	{ "xrarr",			MANUAL_ENTITY_LONGRIGHTARROW },
+	{ "xutri",			MANUAL_ENTITY_BIGTRIANGLEUP },
+	{ "ycirc",			MANUAL_ENTITY_YCIRC_L },
+
+	/* 6 characters */
+
+	{ "Aacute",			MANUAL_ENTITY_AACUTE_U },
+	{ "Abreve",			MANUAL_ENTITY_ABREVE_U },
+	{ "Agrave",			MANUAL_ENTITY_AGRAVE_U },
+	{ "Assign",			MANUAL_ENTITY_ASSIGN },
+	{ "Atilde",			MANUAL_ENTITY_ATILDE_U },
+	{ "Bumpeq",			MANUAL_ENTITY_BUMPEQ },
+	{ "Cacute",			MANUAL_ENTITY_CACUTE_U },
+	{ "Ccaron",			MANUAL_ENTITY_CCARON_U },
+	{ "Ccedil",			MANUAL_ENTITY_CCEDIL_U },
+	{ "Colone",			MANUAL_ENTITY_COLONE },
+	{ "Conint",			MANUAL_ENTITY_CONINT },
+	{ "Dagger",			MANUAL_ENTITY_DDAGGER },
+	{ "Dcaron",			MANUAL_ENTITY_DCARON_U },
+	{ "DotDot",			MANUAL_ENTITY_DOTDOT },
+	{ "Dstrok",			MANUAL_ENTITY_DSTROK_U },
+	{ "Eacute",			MANUAL_ENTITY_EACUTE_U },
+	{ "Ecaron",			MANUAL_ENTITY_ECARON_U },
+	{ "Egrave",			MANUAL_ENTITY_EGRAVE_U },
+	{ "Exists",			MANUAL_ENTITY_EXIST },
+	{ "ForAll",			MANUAL_ENTITY_FORALL },
+	{ "Gammad",			MANUAL_ENTITY_GAMMAD_U },
+	{ "Gbreve",			MANUAL_ENTITY_GBREVE_U },
+	{ "Gcedil",			MANUAL_ENTITY_GCEDIL_U },
+	{ "HARDcy",			MANUAL_ENTITY_HARDCY_U },
+	{ "Hstrok",			MANUAL_ENTITY_HSTROK_U },
+	{ "Iacute",			MANUAL_ENTITY_IACUTE_U },
+	{ "Igrave",			MANUAL_ENTITY_IGRAVE_U },
+	{ "Itilde",			MANUAL_ENTITY_ITILDE_U },
+	{ "Jsercy",			MANUAL_ENTITY_JSERCY_U },
+	{ "Kcedil",			MANUAL_ENTITY_KCEDIL_U },
+	{ "Lacute",			MANUAL_ENTITY_LACUTE_U },
+	{ "Lambda",			MANUAL_ENTITY_LAMBDA_U },
+	{ "Lcaron",			MANUAL_ENTITY_LCARON_U },
+	{ "Lcedil",			MANUAL_ENTITY_LCEDIL_U },
+	{ "Lmidot",			MANUAL_ENTITY_LMIDOT_U },
+	{ "Lstrok",			MANUAL_ENTITY_LSTROK_U },
+	{ "Nacute",			MANUAL_ENTITY_NACUTE_U },
+	{ "Ncaron",			MANUAL_ENTITY_NCARON_U },
+	{ "Ncedil",			MANUAL_ENTITY_NCEDIL_U },
+	{ "Ntilde",			MANUAL_ENTITY_NTILDE_U },
+	{ "Oacute",			MANUAL_ENTITY_OACUTE_U },
+	{ "Odblac",			MANUAL_ENTITY_ODBLAC_U },
+	{ "Ograve",			MANUAL_ENTITY_OGRAVE_U },
+	{ "Oslash",			MANUAL_ENTITY_OSLASH_U },
+	{ "Otilde",			MANUAL_ENTITY_OTILDE_U },
+	{ "Racute",			MANUAL_ENTITY_RACUTE_U },
+	{ "Rarrtl",			MANUAL_ENTITY_RRARRTL },
+	{ "Rcaron",			MANUAL_ENTITY_RCARON_U },
+	{ "Rcedil",			MANUAL_ENTITY_RCEDIL_U },
+	{ "SHCHcy",			MANUAL_ENTITY_SHCHCY_U },
+	{ "SOFTcy",			MANUAL_ENTITY_SOFTCY_U },
+	{ "Sacute",			MANUAL_ENTITY_SACUTE_U },
+	{ "Scaron",			MANUAL_ENTITY_SCARON_U },
+	{ "Scedil",			MANUAL_ENTITY_SCEDIL_U },
+	{ "Square",			MANUAL_ENTITY_SQUARE },
+	{ "Tcaron",			MANUAL_ENTITY_TCARON_U },
+	{ "Tcedil",			MANUAL_ENTITY_TCEDIL_U },
+	{ "Tstrok",			MANUAL_ENTITY_TSTROK_U },
+	{ "Uacute",			MANUAL_ENTITY_UACUTE_U },
+	{ "Ubreve",			MANUAL_ENTITY_UBREVE_U },
+	{ "Udblac",			MANUAL_ENTITY_UDBLAC_U },
+	{ "Ugrave",			MANUAL_ENTITY_UGRAVE_U },
+	{ "Utilde",			MANUAL_ENTITY_UTILDE_U },
+	{ "Vdashl",			MANUAL_ENTITY_VDASHL },
+	{ "Verbar",			MANUAL_ENTITY_VERBAR },
+	{ "Vvdash",			MANUAL_ENTITY_VVDASH },
+	{ "Yacute",			MANUAL_ENTITY_YACUTE_U },
+	{ "Zacute",			MANUAL_ENTITY_ZACUTE_U },
+	{ "Zcaron",			MANUAL_ENTITY_ZCARON_U },
+	{ "aacute",			MANUAL_ENTITY_AACUTE_L },
+	{ "abreve",			MANUAL_ENTITY_ABREVE_L },
+	{ "agrave",			MANUAL_ENTITY_AGRAVE_L },
+	{ "andand",			MANUAL_ENTITY_ANDAND },
+	{ "angmsd",			MANUAL_ENTITY_ANGMSD },
+	{ "angsph",			MANUAL_ENTITY_ANGSPH },
+	{ "apacir",			MANUAL_ENTITY_APACIR },
+	{ "approx",			MANUAL_ENTITY_ASYMP },
+	{ "atilde",			MANUAL_ENTITY_ATILDE_L },
+	{ "barvee",			MANUAL_ENTITY_BARVEE },
+	{ "becaus",			MANUAL_ENTITY_BECAUSE },
+	{ "bernou",			MANUAL_ENTITY_BERNOULLIS_U },
+	{ "bigcap",			MANUAL_ENTITY_INTERSECTION },
+	{ "bigcup",			MANUAL_ENTITY_UNION },
+	{ "bigvee",			MANUAL_ENTITY_VEE },
+	{ "bkarow",			MANUAL_ENTITY_BKAROW },
+	{ "bottom",			MANUAL_ENTITY_PERP },
+	{ "bowtie",			MANUAL_ENTITY_BOWTIE },
+	{ "boxbox",			MANUAL_ENTITY_BOXBOX },
+	{ "bprime",			MANUAL_ENTITY_BACKPRIME },
+	{ "brvbar",			MANUAL_ENTITY_BRVBAR },
+	{ "bullet",			MANUAL_ENTITY_BULL },
+	{ "bumpeq",			MANUAL_ENTITY_HUMPEQUAL },
+	{ "cacute",			MANUAL_ENTITY_CACUTE_L },
+	{ "capand",			MANUAL_ENTITY_CAPAND },
+	{ "capcap",			MANUAL_ENTITY_CAPCAP },
+	{ "capcup",			MANUAL_ENTITY_CAPCUP },
+	{ "capdot",			MANUAL_ENTITY_CAPDOT },
+	{ "ccaron",			MANUAL_ENTITY_CCARON_L },
+	{ "ccedil",			MANUAL_ENTITY_CCEDIL_L },
+	{ "circeq",			MANUAL_ENTITY_CIRCEQ },
+	{ "cirmid",			MANUAL_ENTITY_CIRMID },
+	{ "colone",			MANUAL_ENTITY_ASSIGN },
+	{ "commat",			MANUAL_ENTITY_COMMAT },
+	{ "compfn",			MANUAL_ENTITY_SMALLCIRCLE },
+	{ "conint",			MANUAL_ENTITY_CONTOURINTEGRAL },
+	{ "coprod",			MANUAL_ENTITY_COPRODUCT },
+	{ "copysr",			MANUAL_ENTITY_COPYSR },
+	{ "cularr",			MANUAL_ENTITY_CULARR },
+	{ "cupcup",			MANUAL_ENTITY_CUPCUP },
+	{ "cupdot",			MANUAL_ENTITY_CUPDOT },
+	{ "curarr",			MANUAL_ENTITY_CURARR },
+	{ "curren",			MANUAL_ENTITY_CURREN },
+	{ "cylcty",			MANUAL_ENTITY_CYLCTY },
+	{ "dagger",			MANUAL_ENTITY_DAGGER },
+	{ "daleth",			MANUAL_ENTITY_DALETH },
+	{ "dcaron",			MANUAL_ENTITY_DCARON_L },
+	{ "dfisht",			MANUAL_ENTITY_DFISHT },
+	{ "divide",			MANUAL_ENTITY_DIVIDE },
+	{ "divonx",			MANUAL_ENTITY_DIVIDEONTIMES },
+	{ "dlcorn",			MANUAL_ENTITY_DLCORN },
+	{ "dlcrop",			MANUAL_ENTITY_DLCROP },
+	{ "dollar",			MANUAL_ENTITY_DOLLAR },
+	{ "drcorn",			MANUAL_ENTITY_DRCORN },
+	{ "drcrop",			MANUAL_ENTITY_DRCROP },
+	{ "dstrok",			MANUAL_ENTITY_DSTROK_L },
+	{ "eacute",			MANUAL_ENTITY_EACUTE_L },
+	{ "easter",			MANUAL_ENTITY_EASTER },
+	{ "ecaron",			MANUAL_ENTITY_ECARON_L },
+	{ "ecolon",			MANUAL_ENTITY_ECOLON },
+	{ "egrave",			MANUAL_ENTITY_EGRAVE_L },
+	{ "egsdot",			MANUAL_ENTITY_EGSDOT },
+	{ "elsdot",			MANUAL_ENTITY_ELSDOT },
+	{ "emptyv",			MANUAL_ENTITY_EMPTY },
+	{ "emsp13",			MANUAL_ENTITY_EMSP13 },
+	{ "emsp14",			MANUAL_ENTITY_EMSP14 },
+	{ "eparsl",			MANUAL_ENTITY_EPARSL },
+	{ "eqcirc",			MANUAL_ENTITY_ECIR },
+	{ "equals",			MANUAL_ENTITY_EQUALS },
+	{ "equest",			MANUAL_ENTITY_EQUEST },
+	{ "female",			MANUAL_ENTITY_FEMALE },
+	{ "ffilig",			MANUAL_ENTITY_FFILIG_L },
+	{ "ffllig",			MANUAL_ENTITY_FFLLIG_L },
+	{ "forall",			MANUAL_ENTITY_FORALL },
+	{ "frac12",			MANUAL_ENTITY_FRAC12 },
+	{ "frac13",			MANUAL_ENTITY_FRAC13 },
+	{ "frac14",			MANUAL_ENTITY_FRAC14 },
+	{ "frac15",			MANUAL_ENTITY_FRAC15 },
+	{ "frac16",			MANUAL_ENTITY_FRAC16 },
+	{ "frac18",			MANUAL_ENTITY_FRAC18 },
+	{ "frac23",			MANUAL_ENTITY_FRAC23 },
+	{ "frac25",			MANUAL_ENTITY_FRAC25 },
+	{ "frac34",			MANUAL_ENTITY_FRAC34 },
+	{ "frac35",			MANUAL_ENTITY_FRAC35 },
+	{ "frac38",			MANUAL_ENTITY_FRAC38 },
+	{ "frac45",			MANUAL_ENTITY_FRAC45 },
+	{ "frac56",			MANUAL_ENTITY_FRAC56 },
+	{ "frac58",			MANUAL_ENTITY_FRAC58 },
+	{ "frac78",			MANUAL_ENTITY_FRAC78 },
+	{ "gacute",			MANUAL_ENTITY_GACUTE_L },
+	{ "gammad",			MANUAL_ENTITY_DIGAMMA_L },
+	{ "gbreve",			MANUAL_ENTITY_GBREVE_L },
+	{ "gesdot",			MANUAL_ENTITY_GESDOT },
+	{ "gesles",			MANUAL_ENTITY_GESLES },
+	{ "gtlPar",			MANUAL_ENTITY_GTLPAR },
+	{ "gtrarr",			MANUAL_ENTITY_GTRARR },
+	{ "gtrdot",			MANUAL_ENTITY_GTDOT },
+	{ "gtrsim",			MANUAL_ENTITY_GREATERTILDE },
+	{ "hairsp",			MANUAL_ENTITY_VERYTHINSPACE },
+	{ "hamilt",			MANUAL_ENTITY_HILBERTSPACE_U },
+	{ "hardcy",			MANUAL_ENTITY_HARDCY_L },
+	{ "hearts",			MANUAL_ENTITY_HEARTS },
+	{ "hellip",			MANUAL_ENTITY_HELLIP },
+	{ "hercon",			MANUAL_ENTITY_HERCON },
+	{ "homtht",			MANUAL_ENTITY_HOMTHT },
+	{ "horbar",			MANUAL_ENTITY_HORBAR },
+	{ "hslash",			MANUAL_ENTITY_HBAR_L },
+	{ "hstrok",			MANUAL_ENTITY_HSTROK_L },
+	{ "hybull",			MANUAL_ENTITY_HYBULL },
+	{ "hyphen",			MANUAL_ENTITY_DASH },
+	{ "iacute",			MANUAL_ENTITY_IACUTE_L },
+	{ "igrave",			MANUAL_ENTITY_IGRAVE_L },
+	{ "iiiint",			MANUAL_ENTITY_IIIINT },
+	{ "iinfin",			MANUAL_ENTITY_IINFIN },
+	{ "incare",			MANUAL_ENTITY_INCARE },
+	{ "inodot",			MANUAL_ENTITY_IMATH_L },
+	{ "intcal",			MANUAL_ENTITY_INTCAL },
+	{ "iquest",			MANUAL_ENTITY_IQUEST },
+	{ "isinsv",			MANUAL_ENTITY_ISINSV },
+	{ "itilde",			MANUAL_ENTITY_ITILDE_L },
+	{ "jsercy",			MANUAL_ENTITY_JSERCY_L },
+	{ "kappav",			MANUAL_ENTITY_KAPPAV_L },
+	{ "kcedil",			MANUAL_ENTITY_KCEDIL_L },
+	{ "kgreen",			MANUAL_ENTITY_KGREEN_L },
+	{ "lAtail",			MANUAL_ENTITY_DLATAIL },
+	{ "lacute",			MANUAL_ENTITY_LACUTE_L },
+	{ "lagran",			MANUAL_ENTITY_LAPLACETRF_U },
+	{ "lambda",			MANUAL_ENTITY_LAMBDA_L },
+	{ "langle",			MANUAL_ENTITY_LEFTANGLEBRACKET },
+	{ "larrfs",			MANUAL_ENTITY_LARRFS },
+	{ "larrhk",			MANUAL_ENTITY_HOOKLEFTARROW },
+	{ "larrlp",			MANUAL_ENTITY_LARRLP },
+	{ "larrpl",			MANUAL_ENTITY_LARRPL },
+	{ "larrtl",			MANUAL_ENTITY_LARRTL },
+	{ "latail",			MANUAL_ENTITY_LATAIL },
+	{ "lbrace",			MANUAL_ENTITY_LBRACE },
+	{ "lbrack",			MANUAL_ENTITY_LBRACK },
+	{ "lcaron",			MANUAL_ENTITY_LCARON_L },
+	{ "lcedil",			MANUAL_ENTITY_LCEDIL_L },
+	{ "ldquor",			MANUAL_ENTITY_BDQUO },
+	{ "lesdot",			MANUAL_ENTITY_LESDOT },
+	{ "lesges",			MANUAL_ENTITY_LESGES },
+	{ "lfisht",			MANUAL_ENTITY_LFISHT },
+	{ "lfloor",			MANUAL_ENTITY_LFLOOR },
+	{ "lharul",			MANUAL_ENTITY_LHARUL },
+	{ "llhard",			MANUAL_ENTITY_LLHARD },
+	{ "lmidot",			MANUAL_ENTITY_LMIDOT_L },
+	{ "lmoust",			MANUAL_ENTITY_LMOUST },
+	{ "loplus",			MANUAL_ENTITY_LOPLUS },
+	{ "lowast",			MANUAL_ENTITY_LOWAST },
+	{ "lowbar",			MANUAL_ENTITY_UNDERBAR },
+	{ "lparlt",			MANUAL_ENTITY_LPARLT },
+	{ "lrhard",			MANUAL_ENTITY_LRHARD },
+	{ "lsaquo",			MANUAL_ENTITY_LSAQUO },
+	{ "lsquor",			MANUAL_ENTITY_SBQUO },
+	{ "lstrok",			MANUAL_ENTITY_LSTROK_L },
+	{ "lthree",			MANUAL_ENTITY_LEFTTHREETIMES },
+	{ "ltimes",			MANUAL_ENTITY_LTIMES },
+	{ "ltlarr",			MANUAL_ENTITY_LTLARR },
+	{ "ltrPar",			MANUAL_ENTITY_LTRPAR },
+	{ "mapsto",			MANUAL_ENTITY_RIGHTTEEARROW },
+	{ "marker",			MANUAL_ENTITY_MARKER },
+	{ "mcomma",			MANUAL_ENTITY_MCOMMA },
+	{ "midast",			MANUAL_ENTITY_AST },
+	{ "midcir",			MANUAL_ENTITY_MIDCIR },
+	{ "middot",			MANUAL_ENTITY_MIDDOT },
+	{ "minusb",			MANUAL_ENTITY_BOXMINUS },
+	{ "minusd",			MANUAL_ENTITY_DOTMINUS },
+	{ "mnplus",			MANUAL_ENTITY_MINUSPLUS },
+	{ "models",			MANUAL_ENTITY_MODELS },
+	{ "mstpos",			MANUAL_ENTITY_AC },
+	{ "nacute",			MANUAL_ENTITY_NACUTE_L },
+	{ "ncaron",			MANUAL_ENTITY_NCARON_L },
+	{ "ncedil",			MANUAL_ENTITY_NCEDIL_L },
+	{ "nearhk",			MANUAL_ENTITY_NEARHK },
+	{ "nequiv",			MANUAL_ENTITY_NOTCONGRUENT },
+	{ "nesear",			MANUAL_ENTITY_NESEAR },
+	{ "nexist",			MANUAL_ENTITY_NOTEXISTS },
+	{ "nltrie",			MANUAL_ENTITY_NOTLEFTTRIANGLEEQUAL },
+	{ "nprcue",			MANUAL_ENTITY_NOTPRECEDESSLANTEQUAL },
+	{ "nrtrie",			MANUAL_ENTITY_NOTRIGHTTRIANGLEEQUAL },
+	{ "nsccue",			MANUAL_ENTITY_NOTSUCCEEDSSLANTEQUAL },
+	{ "nsimeq",			MANUAL_ENTITY_NOTTILDEEQUAL },
+	{ "ntilde",			MANUAL_ENTITY_NTILDE_L },
+	{ "numero",			MANUAL_ENTITY_NUMERO },
+	{ "nvHarr",			MANUAL_ENTITY_NVHARR },
+	{ "nvlArr",			MANUAL_ENTITY_NVLARR },
+	{ "nvrArr",			MANUAL_ENTITY_NVRARR },
+	{ "nwarhk",			MANUAL_ENTITY_NWARHK },
+	{ "nwnear",			MANUAL_ENTITY_NWNEAR },
+	{ "oacute",			MANUAL_ENTITY_OACUTE_L },
+	{ "odblac",			MANUAL_ENTITY_ODBLAC_L },
+	{ "odsold",			MANUAL_ENTITY_ODSOLD },
+	{ "ograve",			MANUAL_ENTITY_OGRAVE_L },
+	{ "ominus",			MANUAL_ENTITY_CIRCLEMINUS },
+	{ "origof",			MANUAL_ENTITY_ORIGOF },
+	{ "oslash",			MANUAL_ENTITY_OSLASH_L },
+	{ "otilde",			MANUAL_ENTITY_OTILDE_L },
+	{ "parsim",			MANUAL_ENTITY_PARSIM },
+	{ "percnt",			MANUAL_ENTITY_PERCNT },
+	{ "period",			MANUAL_ENTITY_PERIOD },
+	{ "permil",			MANUAL_ENTITY_PERMIL },
+	{ "phmmat",			MANUAL_ENTITY_MELLINTRF_U },
+	{ "planck",			MANUAL_ENTITY_HBAR_L },
+	{ "plankv",			MANUAL_ENTITY_HBAR_L },
+	{ "plusdo",			MANUAL_ENTITY_DOTPLUS },
+	{ "plusdu",			MANUAL_ENTITY_PLUSDU },
+	{ "plusmn",			MANUAL_ENTITY_PLUSMN },
+	{ "preceq",			MANUAL_ENTITY_PRECEDESEQUAL },
+	{ "primes",			MANUAL_ENTITY_POPF_U },
+	{ "prnsim",			MANUAL_ENTITY_PRECNSIM },
+	{ "propto",			MANUAL_ENTITY_PROP },
+	{ "prurel",			MANUAL_ENTITY_PRUREL },
+	{ "puncsp",			MANUAL_ENTITY_PUNCSP },
+	{ "qprime",			MANUAL_ENTITY_QPRIME },
+	{ "rAtail",			MANUAL_ENTITY_DRATAIL },
+	{ "racute",			MANUAL_ENTITY_RACUTE_L },
+	{ "rangle",			MANUAL_ENTITY_RIGHTANGLEBRACKET },
+	{ "rarrap",			MANUAL_ENTITY_RARRAP },
+	{ "rarrfs",			MANUAL_ENTITY_RARRFS },
+	{ "rarrhk",			MANUAL_ENTITY_HOOKRIGHTARROW },
+	{ "rarrlp",			MANUAL_ENTITY_LOOPARROWRIGHT },
+	{ "rarrpl",			MANUAL_ENTITY_RARRPL },
+	{ "rarrtl",			MANUAL_ENTITY_RARRTL },
+	{ "ratail",			MANUAL_ENTITY_RATAIL },
+	{ "rbrace",			MANUAL_ENTITY_RBRACE },
+	{ "rbrack",			MANUAL_ENTITY_RBRACK },
+	{ "rcaron",			MANUAL_ENTITY_RCARON_L },
+	{ "rcedil",			MANUAL_ENTITY_RCEDIL_L },
+	{ "rdquor",			MANUAL_ENTITY_RDQUO },
+	{ "rfisht",			MANUAL_ENTITY_RFISHT },
+	{ "rfloor",			MANUAL_ENTITY_RFLOOR },
+	{ "rharul",			MANUAL_ENTITY_RHARUL },
+	{ "rmoust",			MANUAL_ENTITY_RMOUST },
+	{ "roplus",			MANUAL_ENTITY_ROPLUS },
+	{ "rpargt",			MANUAL_ENTITY_RPARGT },
+	{ "rsaquo",			MANUAL_ENTITY_RSAQUO },
+	{ "rsquor",			MANUAL_ENTITY_RSQUO },
+	{ "rthree",			MANUAL_ENTITY_RIGHTTHREETIMES },
+	{ "rtimes",			MANUAL_ENTITY_RTIMES },
+	{ "sacute",			MANUAL_ENTITY_SACUTE_L },
+	{ "scaron",			MANUAL_ENTITY_SCARON_L },
+	{ "scedil",			MANUAL_ENTITY_SCEDIL_L },
+	{ "scnsim",			MANUAL_ENTITY_SCNSIM },
+	{ "searhk",			MANUAL_ENTITY_HKSEAROW },
+	{ "seswar",			MANUAL_ENTITY_SESWAR },
+	{ "sfrown",			MANUAL_ENTITY_FROWN },
+	{ "shchcy",			MANUAL_ENTITY_SHCHCY_L },
+	{ "sigmaf",			MANUAL_ENTITY_SIGMAF_L },
+	{ "sigmav",			MANUAL_ENTITY_SIGMAF_L },
+	{ "simdot",			MANUAL_ENTITY_SIMDOT },
+	{ "smashp",			MANUAL_ENTITY_SMASHP },
+	{ "softcy",			MANUAL_ENTITY_SOFTCY_L },
+	{ "solbar",			MANUAL_ENTITY_SOLBAR },
+	{ "spades",			MANUAL_ENTITY_SPADES },
+	{ "sqsube",			MANUAL_ENTITY_SQUARESUBSETEQUAL },
+	{ "sqsupe",			MANUAL_ENTITY_SQUARESUPERSETEQUAL },
+	{ "square",			MANUAL_ENTITY_SQUARE },
+	{ "squarf",			MANUAL_ENTITY_FILLEDVERYSMALLSQUARE },
+	{ "ssetmn",			MANUAL_ENTITY_BACKSLASH },
+	{ "ssmile",			MANUAL_ENTITY_SMILE },
+	{ "subdot",			MANUAL_ENTITY_SUBDOT },
+	{ "subsim",			MANUAL_ENTITY_SUBSIM },
+	{ "subsub",			MANUAL_ENTITY_SUBSUB },
+	{ "subsup",			MANUAL_ENTITY_SUBSUP },
+	{ "succeq",			MANUAL_ENTITY_SUCCEEDSEQUAL },
+	{ "supdot",			MANUAL_ENTITY_SUPDOT },
+	{ "supsim",			MANUAL_ENTITY_SUPSIM },
+	{ "supsub",			MANUAL_ENTITY_SUPSUB },
+	{ "supsup",			MANUAL_ENTITY_SUPSUP },
+	{ "swarhk",			MANUAL_ENTITY_HKSWAROW },
+	{ "swnwar",			MANUAL_ENTITY_SWNWAR },
+	{ "target",			MANUAL_ENTITY_TARGET },
+	{ "tcaron",			MANUAL_ENTITY_TCARON_L },
+	{ "tcedil",			MANUAL_ENTITY_TCEDIL_L },
+	{ "telrec",			MANUAL_ENTITY_TELREC },
+	{ "there4",			MANUAL_ENTITY_THERE4 },
+	{ "thetav",			MANUAL_ENTITY_THETASYM_L },
+	{ "thinsp",			MANUAL_ENTITY_THINSP },
+	{ "thksim",			MANUAL_ENTITY_SIM },
+	{ "timesb",			MANUAL_ENTITY_BOXTIMES },
+	{ "timesd",			MANUAL_ENTITY_TIMESD },
+	{ "topbot",			MANUAL_ENTITY_TOPBOT },
+	{ "topcir",			MANUAL_ENTITY_TOPCIR },
+	{ "tprime",			MANUAL_ENTITY_TPRIME },
+	{ "tridot",			MANUAL_ENTITY_TRIDOT },
+	{ "tstrok",			MANUAL_ENTITY_TSTROK_L },
+	{ "uacute",			MANUAL_ENTITY_UACUTE_L },
+	{ "ubreve",			MANUAL_ENTITY_UBREVE_L },
+	{ "udblac",			MANUAL_ENTITY_UDBLAC_L },
+	{ "ufisht",			MANUAL_ENTITY_UFISHT },
+	{ "ugrave",			MANUAL_ENTITY_UGRAVE_L },
+	{ "ulcorn",			MANUAL_ENTITY_ULCORN },
+	{ "ulcrop",			MANUAL_ENTITY_ULCROP },
+	{ "urcorn",			MANUAL_ENTITY_URCORN },
+	{ "urcrop",			MANUAL_ENTITY_URCROP },
+	{ "utilde",			MANUAL_ENTITY_UTILDE_L },
+	{ "vangrt",			MANUAL_ENTITY_VANGRT },
+	{ "varphi",			MANUAL_ENTITY_PHIV_L },
+	{ "varrho",			MANUAL_ENTITY_RHOV_L },
+	{ "veebar",			MANUAL_ENTITY_VEEBAR },
+	{ "vellip",			MANUAL_ENTITY_VELLIP },
+	{ "verbar",			MANUAL_ENTITY_VERTICALLINE },
+	{ "wedbar",			MANUAL_ENTITY_WEDBAR },
+	{ "wedgeq",			MANUAL_ENTITY_WEDGEQ },
+	{ "weierp",			MANUAL_ENTITY_WEIERP },
+	{ "wreath",			MANUAL_ENTITY_VERTICALTILDE },
+	{ "xoplus",			MANUAL_ENTITY_BIGOPLUS },
+	{ "xotime",			MANUAL_ENTITY_BIGOTIMES },
+	{ "xsqcup",			MANUAL_ENTITY_BIGSQCUP },
+	{ "xuplus",			MANUAL_ENTITY_BIGUPLUS },
+	{ "xwedge",			MANUAL_ENTITY_WEDGE },
+	{ "yacute",			MANUAL_ENTITY_YACUTE_L },
+	{ "zacute",			MANUAL_ENTITY_ZACUTE_L },
+	{ "zcaron",			MANUAL_ENTITY_ZCARON_L },
+	{ "zeetrf",			MANUAL_ENTITY_ZFR_U },
+
+	/* 7 characters */
+
+	{ "Because",			MANUAL_ENTITY_BECAUSE },
+	{ "Cayleys",			MANUAL_ENTITY_CAYLEYS_U },
+	{ "Cconint",			MANUAL_ENTITY_CCONINT },
+	{ "Cedilla",			MANUAL_ENTITY_CEDIL },
+	{ "Diamond",			MANUAL_ENTITY_DIAMOND },
+	{ "DownTee",			MANUAL_ENTITY_DOWNTEE },
+	{ "Element",			MANUAL_ENTITY_ISIN },
+	{ "Epsilon",			MANUAL_ENTITY_EPSILON_U },
+	{ "LeftTee",			MANUAL_ENTITY_LEFTTEE },
+	{ "NewLine",			MANUAL_ENTITY_NEWLINE },
+	{ "NoBreak",			MANUAL_ENTITY_NOBREAK },
+	{ "NotLess",			MANUAL_ENTITY_NOTLESS },
+	{ "Omicron",			MANUAL_ENTITY_OMICRON_U },
+	{ "OverBar",			MANUAL_ENTITY_OLINE },
+	{ "Product",			MANUAL_ENTITY_PROD },
+	{ "Upsilon",			MANUAL_ENTITY_UPSILON_U },
+	{ "alefsym",			MANUAL_ENTITY_ALEFSYM },
+	{ "angrtvb",			MANUAL_ENTITY_ANGRTVB },
+	{ "angzarr",			MANUAL_ENTITY_ANGZARR },
+	{ "backsim",			MANUAL_ENTITY_BACKSIM },
+	{ "because",			MANUAL_ENTITY_BECAUSE },
+	{ "bemptyv",			MANUAL_ENTITY_BEMPTYV },
+	{ "between",			MANUAL_ENTITY_BETWEEN },
+	{ "bigcirc",			MANUAL_ENTITY_BIGCIRC },
+	{ "bigodot",			MANUAL_ENTITY_BIGODOT },
+	{ "bigstar",			MANUAL_ENTITY_BIGSTAR },
+	{ "boxplus",			MANUAL_ENTITY_BOXPLUS },
+	{ "ccupssm",			MANUAL_ENTITY_CCUPSSM },
+	{ "cemptyv",			MANUAL_ENTITY_CEMPTYV },
+	{ "cirscir",			MANUAL_ENTITY_CIRSCIR },
+	{ "coloneq",			MANUAL_ENTITY_ASSIGN },
+	{ "congdot",			MANUAL_ENTITY_CONGDOT },
+	{ "cudarrl",			MANUAL_ENTITY_CUDARRL },
+	{ "cudarrr",			MANUAL_ENTITY_CUDARRR },
+	{ "cularrp",			MANUAL_ENTITY_CULARRP },
+	{ "curarrm",			MANUAL_ENTITY_CURARRM },
+	{ "dbkarow",			MANUAL_ENTITY_DBKAROW },
+	{ "ddagger",			MANUAL_ENTITY_DDAGGER },
+	{ "ddotseq",			MANUAL_ENTITY_DDOTSEQ },
+	{ "demptyv",			MANUAL_ENTITY_DEMPTYV },
+	{ "diamond",			MANUAL_ENTITY_DIAMOND },
+	{ "digamma",			MANUAL_ENTITY_DIGAMMA_L },
+	{ "dotplus",			MANUAL_ENTITY_DOTPLUS },
+	{ "dwangle",			MANUAL_ENTITY_DWANGLE },
+	{ "epsilon",			MANUAL_ENTITY_EPSILON_L },
+	{ "eqcolon",			MANUAL_ENTITY_ECOLON },
+	{ "equivDD",			MANUAL_ENTITY_EQUIVDD },
+	{ "gesdoto",			MANUAL_ENTITY_GESDOTO },
+	{ "gtquest",			MANUAL_ENTITY_GTQUEST },
+	{ "gtrless",			MANUAL_ENTITY_GREATERLESS },
+	{ "harrcir",			MANUAL_ENTITY_HARRCIR },
+	{ "intprod",			MANUAL_ENTITY_INTPROD },
+	{ "isindot",			MANUAL_ENTITY_ISINDOT },
+	{ "larrbfs",			MANUAL_ENTITY_LARRBFS },
+	{ "larrsim",			MANUAL_ENTITY_LARRSIM },
+	{ "lbrksld",			MANUAL_ENTITY_LBRKSLD },
+	{ "lbrkslu",			MANUAL_ENTITY_LBRKSLU },
+	{ "ldrdhar",			MANUAL_ENTITY_LDRDHAR },
+	{ "lesdoto",			MANUAL_ENTITY_LESDOTO },
+	{ "lessdot",			MANUAL_ENTITY_LESSDOT },
+	{ "lessgtr",			MANUAL_ENTITY_LESSGREATER },
+	{ "lesssim",			MANUAL_ENTITY_LESSTILDE },
+	{ "lotimes",			MANUAL_ENTITY_LOTIMES },
+	{ "lozenge",			MANUAL_ENTITY_LOZ },
+	{ "ltquest",			MANUAL_ENTITY_LTQUEST },
+	{ "luruhar",			MANUAL_ENTITY_LURUHAR },
+	{ "maltese",			MANUAL_ENTITY_MALT },
+	{ "minusdu",			MANUAL_ENTITY_MINUSDU },
+	{ "napprox",			MANUAL_ENTITY_NOTTILDETILDE },
+	{ "natural",			MANUAL_ENTITY_NATUR },
+	{ "nearrow",			MANUAL_ENTITY_UPPERRIGHTARROW },
+	{ "nexists",			MANUAL_ENTITY_NOTEXISTS },
+	{ "notinva",			MANUAL_ENTITY_NOTIN },
+	{ "notinvb",			MANUAL_ENTITY_NOTINVB },
+	{ "notinvc",			MANUAL_ENTITY_NOTINVC },
+	{ "notniva",			MANUAL_ENTITY_NOTREVERSEELEMENT },
+	{ "notnivb",			MANUAL_ENTITY_NOTNIVB },
+	{ "notnivc",			MANUAL_ENTITY_NOTNIVC },
+	{ "npolint",			MANUAL_ENTITY_NPOLINT },
+	{ "nsqsube",			MANUAL_ENTITY_NOTSQUARESUBSETEQUAL },
+	{ "nsqsupe",			MANUAL_ENTITY_NOTSQUARESUPERSETEQUAL },
+	{ "nvinfin",			MANUAL_ENTITY_NVINFIN },
+	{ "nwarrow",			MANUAL_ENTITY_UPPERLEFTARROW },
+	{ "olcross",			MANUAL_ENTITY_OLCROSS },
+	{ "omicron",			MANUAL_ENTITY_OMICRON_L },
+	{ "orderof",			MANUAL_ENTITY_ORDER_L },
+	{ "orslope",			MANUAL_ENTITY_ORSLOPE },
+	{ "pertenk",			MANUAL_ENTITY_PERTENK },
+	{ "planckh",			MANUAL_ENTITY_PLANCKH_L },
+	{ "pluscir",			MANUAL_ENTITY_PLUSCIR },
+	{ "plussim",			MANUAL_ENTITY_PLUSSIM },
+	{ "plustwo",			MANUAL_ENTITY_PLUSTWO },
+	{ "precsim",			MANUAL_ENTITY_PRECEDESTILDE },
+	{ "quatint",			MANUAL_ENTITY_QUATINT },
+	{ "questeq",			MANUAL_ENTITY_EQUEST },
+	{ "rarrbfs",			MANUAL_ENTITY_RARRBFS },
+	{ "rarrsim",			MANUAL_ENTITY_RARRSIM },
+	{ "rbrksld",			MANUAL_ENTITY_RBRKSLD },
+	{ "rbrkslu",			MANUAL_ENTITY_RBRKSLU },
+	{ "rdldhar",			MANUAL_ENTITY_RDLDHAR },
+	{ "realine",			MANUAL_ENTITY_RSCR_U },
+	{ "rotimes",			MANUAL_ENTITY_ROTIMES },
+	{ "ruluhar",			MANUAL_ENTITY_RULUHAR },
+	{ "sadface",			MANUAL_ENTITY_SADFACE },
+	{ "searrow",			MANUAL_ENTITY_LOWERRIGHTARROW },
+	{ "simplus",			MANUAL_ENTITY_SIMPLUS },
+	{ "simrarr",			MANUAL_ENTITY_SIMRARR },
+	{ "subedot",			MANUAL_ENTITY_SUBEDOT },
+	{ "submult",			MANUAL_ENTITY_SUBMULT },
+	{ "subplus",			MANUAL_ENTITY_SUBPLUS },
+	{ "subrarr",			MANUAL_ENTITY_SUBRARR },
+	{ "succsim",			MANUAL_ENTITY_SUCCEEDSTILDE },
+	{ "supdsub",			MANUAL_ENTITY_SUPDSUB },
+	{ "supedot",			MANUAL_ENTITY_SUPEDOT },
+	{ "suphsol",			MANUAL_ENTITY_SUPHSOL },
+	{ "suphsub",			MANUAL_ENTITY_SUPHSUB },
+	{ "suplarr",			MANUAL_ENTITY_SUPLARR },
+	{ "supmult",			MANUAL_ENTITY_SUPMULT },
+	{ "supplus",			MANUAL_ENTITY_SUPPLUS },
+	{ "swarrow",			MANUAL_ENTITY_LOWERLEFTARROW },
+	{ "topfork",			MANUAL_ENTITY_TOPFORK },
+	{ "triplus",			MANUAL_ENTITY_TRIPLUS },
+	{ "tritime",			MANUAL_ENTITY_TRITIME },
+	{ "upsilon",			MANUAL_ENTITY_UPSILON_L },
+	{ "uwangle",			MANUAL_ENTITY_UWANGLE },
+	{ "vzigzag",			MANUAL_ENTITY_VZIGZAG },
+	{ "zigrarr",			MANUAL_ENTITY_ZIGRARR },
+
+	/* 8 characters */
+
+	{ "DDotrahd",			MANUAL_ENTITY_DDOTRAHD },
+	{ "DotEqual",			MANUAL_ENTITY_DOTEQUAL },
+	{ "LessLess",			MANUAL_ENTITY_LESSLESS },
+	{ "NotEqual",			MANUAL_ENTITY_NE },
+	{ "NotTilde",			MANUAL_ENTITY_NOTTILDE },
+	{ "PartialD",			MANUAL_ENTITY_PART },
+	{ "Precedes",			MANUAL_ENTITY_PRECEDES },
+	{ "RightTee",			MANUAL_ENTITY_RIGHTTEE },
+	{ "Succeeds",			MANUAL_ENTITY_SUCCEEDS },
+	{ "SuchThat",			MANUAL_ENTITY_NI },
+	{ "Uarrocir",			MANUAL_ENTITY_UARROCIR },
+	{ "UnderBar",			MANUAL_ENTITY_UNDERBAR },
+	{ "andslope",			MANUAL_ENTITY_ANDSLOPE },
+	{ "angmsdaa",			MANUAL_ENTITY_ANGMSDAA },
+	{ "angmsdab",			MANUAL_ENTITY_ANGMSDAB },
+	{ "angmsdac",			MANUAL_ENTITY_ANGMSDAC },
+	{ "angmsdad",			MANUAL_ENTITY_ANGMSDAD },
+	{ "angmsdae",			MANUAL_ENTITY_ANGMSDAE },
+	{ "angmsdaf",			MANUAL_ENTITY_ANGMSDAF },
+	{ "angmsdag",			MANUAL_ENTITY_ANGMSDAG },
+	{ "angmsdah",			MANUAL_ENTITY_ANGMSDAH },
+	{ "angrtvbd",			MANUAL_ENTITY_ANGRTVBD },
+	{ "awconint",			MANUAL_ENTITY_COUNTERCLOCKWISECONTOURINTEGRAL },
+	{ "backcong",			MANUAL_ENTITY_BACKCONG },
+	{ "bbrktbrk",			MANUAL_ENTITY_BBRKTBRK },
+	{ "bigoplus",			MANUAL_ENTITY_BIGOPLUS },
+	{ "bigsqcup",			MANUAL_ENTITY_BIGSQCUP },
+	{ "biguplus",			MANUAL_ENTITY_BIGUPLUS },
+	{ "bigwedge",			MANUAL_ENTITY_WEDGE },
+	{ "boxminus",			MANUAL_ENTITY_BOXMINUS },
+	{ "boxtimes",			MANUAL_ENTITY_BOXTIMES },
+	{ "bsolhsub",			MANUAL_ENTITY_BSOLHSUB },
+	{ "capbrcup",			MANUAL_ENTITY_CAPBRCUP },
+	{ "circledR",			MANUAL_ENTITY_REG },
+	{ "circledS",			MANUAL_ENTITY_CIRCLEDS_U },
+	{ "cirfnint",			MANUAL_ENTITY_CIRFNINT },
+	{ "clubsuit",			MANUAL_ENTITY_CLUBS },
+	{ "cupbrcap",			MANUAL_ENTITY_CUPBRCAP },
+	{ "curlyvee",			MANUAL_ENTITY_CURLYVEE },
+	{ "cwconint",			MANUAL_ENTITY_CLOCKWISECONTOURINTEGRAL },
+	{ "doteqdot",			MANUAL_ENTITY_DOTEQDOT },
+	{ "dotminus",			MANUAL_ENTITY_DOTMINUS },
+	{ "drbkarow",			MANUAL_ENTITY_RBARR },
+	{ "dzigrarr",			MANUAL_ENTITY_DZIGRARR },
+	{ "elinters",			MANUAL_ENTITY_ELINTERS },
+	{ "emptyset",			MANUAL_ENTITY_EMPTY },
+	{ "eqvparsl",			MANUAL_ENTITY_EQVPARSL },
+	{ "fpartint",			MANUAL_ENTITY_FPARTINT },
+	{ "geqslant",			MANUAL_ENTITY_GREATERSLANTEQUAL },
+	{ "gesdotol",			MANUAL_ENTITY_GESDOTOL },
+	{ "gnapprox",			MANUAL_ENTITY_GNAP },
+	{ "hksearow",			MANUAL_ENTITY_HKSEAROW },
+	{ "hkswarow",			MANUAL_ENTITY_HKSWAROW },
+	{ "imagline",			MANUAL_ENTITY_ISCR_U },
+	{ "imagpart",			MANUAL_ENTITY_IMAGE_U },
+	{ "infintie",			MANUAL_ENTITY_INFINTIE },
+	{ "integers",			MANUAL_ENTITY_ZOPF_U },
+	{ "intercal",			MANUAL_ENTITY_INTCAL },
+	{ "intlarhk",			MANUAL_ENTITY_INTLARHK },
+	{ "laemptyv",			MANUAL_ENTITY_LAEMPTYV },
+	{ "ldrushar",			MANUAL_ENTITY_LDRUSHAR },
+	{ "leqslant",			MANUAL_ENTITY_LESSSLANTEQUAL },
+	{ "lesdotor",			MANUAL_ENTITY_LESDOTOR },
+	{ "llcorner",			MANUAL_ENTITY_DLCORN },
+	{ "lnapprox",			MANUAL_ENTITY_LNAP },
+	{ "lrcorner",			MANUAL_ENTITY_DRCORN },
+	{ "lurdshar",			MANUAL_ENTITY_LURDSHAR },
+	{ "mapstoup",			MANUAL_ENTITY_UPTEEARROW },
+	{ "multimap",			MANUAL_ENTITY_MULTIMAP },
+	{ "naturals",			MANUAL_ENTITY_NOPF_U },
+	{ "otimesas",			MANUAL_ENTITY_OTIMESAS },
+	{ "parallel",			MANUAL_ENTITY_DOUBLEVERTICALBAR },
+	{ "plusacir",			MANUAL_ENTITY_PLUSACIR },
+	{ "pointint",			MANUAL_ENTITY_POINTINT },
+	{ "precneqq",			MANUAL_ENTITY_PRECNEQQ },
+	{ "precnsim",			MANUAL_ENTITY_PRECNSIM },
+	{ "profalar",			MANUAL_ENTITY_PROFALAR },
+	{ "profline",			MANUAL_ENTITY_PROFLINE },
+	{ "profsurf",			MANUAL_ENTITY_PROFSURF },
+	{ "raemptyv",			MANUAL_ENTITY_RAEMPTYV },
+	{ "realpart",			MANUAL_ENTITY_REAL_U },
+	{ "rppolint",			MANUAL_ENTITY_RPPOLINT },
+	{ "rtriltri",			MANUAL_ENTITY_RTRILTRI },
+	{ "scpolint",			MANUAL_ENTITY_SCPOLINT },
+	{ "setminus",			MANUAL_ENTITY_BACKSLASH },
+	{ "shortmid",			MANUAL_ENTITY_VERTICALBAR },
+	{ "smeparsl",			MANUAL_ENTITY_SMEPARSL },
+	{ "sqsubset",			MANUAL_ENTITY_SQUARESUBSET },
+	{ "sqsupset",			MANUAL_ENTITY_SQUARESUPERSET },
+	{ "succneqq",			MANUAL_ENTITY_SCNE },
+	{ "succnsim",			MANUAL_ENTITY_SCNSIM },
+	{ "thetasym",			MANUAL_ENTITY_THETASYM_L },
+	{ "thicksim",			MANUAL_ENTITY_SIM },
+	{ "timesbar",			MANUAL_ENTITY_TIMESBAR },
+	{ "triangle",			MANUAL_ENTITY_TRIANGLE },
+	{ "triminus",			MANUAL_ENTITY_TRIMINUS },
+	{ "trpezium",			MANUAL_ENTITY_TRPEZIUM },
+	{ "ulcorner",			MANUAL_ENTITY_ULCORN },
+	{ "urcorner",			MANUAL_ENTITY_URCORN },
+	{ "varkappa",			MANUAL_ENTITY_KAPPAV_L },
+	{ "varsigma",			MANUAL_ENTITY_SIGMAF_L },
+	{ "vartheta",			MANUAL_ENTITY_THETASYM_L },
+
+	/* 9 characters */
+
+	{ "Backslash",			MANUAL_ENTITY_BACKSLASH },
+	{ "CenterDot",			MANUAL_ENTITY_MIDDOT },
+	{ "CircleDot",			MANUAL_ENTITY_CIRCLEDOT },
+	{ "Congruent",			MANUAL_ENTITY_EQUIV },
+	{ "Coproduct",			MANUAL_ENTITY_COPRODUCT },
+	{ "DoubleDot",			MANUAL_ENTITY_UML },
+	{ "DownBreve",			MANUAL_ENTITY_DOWNBREVE },
+	{ "HumpEqual",			MANUAL_ENTITY_HUMPEQUAL },
+	{ "LeftFloor",			MANUAL_ENTITY_LFLOOR },
+	{ "LessTilde",			MANUAL_ENTITY_LESSTILDE },
+	{ "Mellintrf",			MANUAL_ENTITY_MELLINTRF_U },
+	{ "MinusPlus",			MANUAL_ENTITY_MINUSPLUS },
+	{ "NotCupCap",			MANUAL_ENTITY_NOTCUPCAP },
+	{ "NotExists",			MANUAL_ENTITY_NOTEXISTS },
+	{ "OverBrace",			MANUAL_ENTITY_OVERBRACE },
+	{ "PlusMinus",			MANUAL_ENTITY_PLUSMN },
+	{ "Therefore",			MANUAL_ENTITY_THERE4 },
+	{ "ThinSpace",			MANUAL_ENTITY_THINSP },
+	{ "TripleDot",			MANUAL_ENTITY_TRIPLEDOT },
+	{ "UnionPlus",			MANUAL_ENTITY_UNIONPLUS },
+	{ "backprime",			MANUAL_ENTITY_BACKPRIME },
+	{ "backsimeq",			MANUAL_ENTITY_BACKSIMEQ },
+	{ "bigotimes",			MANUAL_ENTITY_BIGOTIMES },
+	{ "centerdot",			MANUAL_ENTITY_MIDDOT },
+	{ "checkmark",			MANUAL_ENTITY_CHECK },
+	{ "complexes",			MANUAL_ENTITY_COPF_U },
+	{ "dotsquare",			MANUAL_ENTITY_DOTSQUARE },
+	{ "gtrapprox",			MANUAL_ENTITY_GAP },
+	{ "gtreqless",			MANUAL_ENTITY_GREATEREQUALLESS },
+	{ "heartsuit",			MANUAL_ENTITY_HEARTS },
+	{ "lesseqgtr",			MANUAL_ENTITY_LESSEQUALGREATER },
+	{ "nparallel",			MANUAL_ENTITY_NOTDOUBLEVERTICALBAR },
+	{ "nshortmid",			MANUAL_ENTITY_NOTVERTICALBAR },
+	{ "nsubseteq",			MANUAL_ENTITY_NOTSUBSETEQUAL },
+	{ "nsupseteq",			MANUAL_ENTITY_NOTSUPERSETEQUAL },
+	{ "pitchfork",			MANUAL_ENTITY_FORK },
+	{ "rationals",			MANUAL_ENTITY_QOPF_U },
+	{ "spadesuit",			MANUAL_ENTITY_SPADES },
+	{ "therefore",			MANUAL_ENTITY_THERE4 },
+	{ "triangleq",			MANUAL_ENTITY_TRIANGLEQ },
+	{ "varpropto",			MANUAL_ENTITY_PROP },
+
+	/* 10 characters */
+
+	{ "Bernoullis",			MANUAL_ENTITY_BERNOULLIS_U },
+	{ "CirclePlus",			MANUAL_ENTITY_OPLUS },
+	{ "EqualTilde",			MANUAL_ENTITY_EQUALTILDE },
+	{ "Fouriertrf",			MANUAL_ENTITY_FOURIERTRF_U },
+	{ "ImaginaryI",			MANUAL_ENTITY_IMAGINARYI_L },
+	{ "Laplacetrf",			MANUAL_ENTITY_LAPLACETRF_U },
+	{ "LeftVector",			MANUAL_ENTITY_LEFTVECTOR },
+	{ "Lleftarrow",			MANUAL_ENTITY_LLEFTARROW },
+	{ "NotElement",			MANUAL_ENTITY_NOTIN },
+	{ "NotGreater",			MANUAL_ENTITY_NOTGREATER },
+	{ "RightFloor",			MANUAL_ENTITY_RFLOOR },
+	{ "TildeEqual",			MANUAL_ENTITY_TILDEEQUAL },
+	{ "TildeTilde",			MANUAL_ENTITY_ASYMP },
+	{ "UnderBrace",			MANUAL_ENTITY_UNDERBRACE },
+	{ "UpArrowBar",			MANUAL_ENTITY_UPARROWBAR },
+	{ "UpTeeArrow",			MANUAL_ENTITY_UPTEEARROW },
+	{ "circledast",			MANUAL_ENTITY_CIRCLEDAST },
+	{ "complement",			MANUAL_ENTITY_COMP },
+	{ "curlywedge",			MANUAL_ENTITY_CURLYWEDGE },
+	{ "eqslantgtr",			MANUAL_ENTITY_EGS },
+	{ "gtreqqless",			MANUAL_ENTITY_GEL },
+	{ "lessapprox",			MANUAL_ENTITY_LAP },
+	{ "lesseqqgtr",			MANUAL_ENTITY_LEG },
+	{ "lmoustache",			MANUAL_ENTITY_LMOUST },
+	{ "longmapsto",			MANUAL_ENTITY_LONGMAPSTO },
+	{ "mapstoleft",			MANUAL_ENTITY_LEFTTEEARROW },
+	{ "nLeftarrow",			MANUAL_ENTITY_NLEFTARROW },
+	{ "nleftarrow",			MANUAL_ENTITY_NLARR },
+	{ "precapprox",			MANUAL_ENTITY_PRAP },
+	{ "rmoustache",			MANUAL_ENTITY_RMOUST },
+	{ "smileyface",			MANUAL_ENTITY_SMILEYFACE },
+	{ "sqsubseteq",			MANUAL_ENTITY_SQUARESUBSETEQUAL },
+	{ "sqsupseteq",			MANUAL_ENTITY_SQUARESUPERSETEQUAL },
+	{ "succapprox",			MANUAL_ENTITY_SCAP },
+	{ "upuparrows",			MANUAL_ENTITY_UPUPARROWS },
+	{ "varepsilon",			MANUAL_ENTITY_EPSIV_L },
+	{ "varnothing",			MANUAL_ENTITY_EMPTY },
+
+	/* 11 characters */
+
+	{ "CircleMinus",		MANUAL_ENTITY_CIRCLEMINUS },
+	{ "Equilibrium",		MANUAL_ENTITY_EQUILIBRIUM },
+	{ "GreaterLess",		MANUAL_ENTITY_GREATERLESS },
+	{ "LeftCeiling",		MANUAL_ENTITY_LCEIL },
+	{ "LessGreater",		MANUAL_ENTITY_LESSGREATER },
+	{ "MediumSpace",		MANUAL_ENTITY_MEDIUMSPACE },
+	{ "NotPrecedes",		MANUAL_ENTITY_NOTPRECEDES },
+	{ "NotSucceeds",		MANUAL_ENTITY_NOTSUCCEEDS },
+	{ "OverBracket",		MANUAL_ENTITY_OVERBRACKET },
+	{ "RightVector",		MANUAL_ENTITY_RIGHTVECTOR },
+	{ "Rrightarrow",		MANUAL_ENTITY_RRIGHTARROW },
+	{ "RuleDelayed",		MANUAL_ENTITY_RULEDELAYED },
+	{ "SmallCircle",		MANUAL_ENTITY_SMALLCIRCLE },
+	{ "SquareUnion",		MANUAL_ENTITY_SQUAREUNION },
+	{ "UpDownArrow",		MANUAL_ENTITY_UPDOWNARROW },
+	{ "Updownarrow",		MANUAL_ENTITY_DOUBLEUPDOWNARROW },
+	{ "VerticalBar",		MANUAL_ENTITY_VERTICALBAR },
+	{ "backepsilon",		MANUAL_ENTITY_BACKEPSILON },
+	{ "blacksquare",		MANUAL_ENTITY_FILLEDVERYSMALLSQUARE },
+	{ "circledcirc",		MANUAL_ENTITY_CIRCLEDCIRC },
+	{ "circleddash",		MANUAL_ENTITY_CIRCLEDDASH },
+	{ "curlyeqprec",		MANUAL_ENTITY_CUEPR },
+	{ "curlyeqsucc",		MANUAL_ENTITY_CUESC },
+	{ "diamondsuit",		MANUAL_ENTITY_DIAMS },
+	{ "eqslantless",		MANUAL_ENTITY_ELS },
+	{ "expectation",		MANUAL_ENTITY_ESCR_U },
+	{ "nRightarrow",		MANUAL_ENTITY_NRIGHTARROW },
+	{ "nrightarrow",		MANUAL_ENTITY_NRARR },
+	{ "preccurlyeq",		MANUAL_ENTITY_PRECEDESSLANTEQUAL },
+	{ "precnapprox",		MANUAL_ENTITY_PRECNAPPROX },
+	{ "quaternions",		MANUAL_ENTITY_HOPF_U },
+	{ "straightphi",		MANUAL_ENTITY_PHIV_L },
+	{ "succcurlyeq",		MANUAL_ENTITY_SUCCEEDSSLANTEQUAL },
+	{ "succnapprox",		MANUAL_ENTITY_SCNAP },
+	{ "thickapprox",		MANUAL_ENTITY_ASYMP },
+	{ "updownarrow",		MANUAL_ENTITY_UPDOWNARROW },
+
+	/* 12 characters */
+
+	{ "DownArrowBar",		MANUAL_ENTITY_DOWNARROWBAR },
+	{ "ExponentialE",		MANUAL_ENTITY_EXPONENTIALE_L },
+	{ "GreaterEqual",		MANUAL_ENTITY_GE },
+	{ "GreaterTilde",		MANUAL_ENTITY_GREATERTILDE },
+	{ "HilbertSpace",		MANUAL_ENTITY_HILBERTSPACE_U },
+	{ "HumpDownHump",		MANUAL_ENTITY_BUMPEQ },
+	{ "Intersection",		MANUAL_ENTITY_INTERSECTION },
+	{ "LeftArrowBar",		MANUAL_ENTITY_LEFTARROWBAR },
+	{ "LeftTeeArrow",		MANUAL_ENTITY_LEFTTEEARROW },
+	{ "LeftTriangle",		MANUAL_ENTITY_LEFTTRIANGLE },
+	{ "LeftUpVector",		MANUAL_ENTITY_LEFTUPVECTOR },
+	{ "NotCongruent",		MANUAL_ENTITY_NOTCONGRUENT },
+	{ "NotLessEqual",		MANUAL_ENTITY_NOTLESSEQUAL },
+	{ "NotLessTilde",		MANUAL_ENTITY_NOTLESSTILDE },
+	{ "Proportional",		MANUAL_ENTITY_PROP },
+	{ "RightCeiling",		MANUAL_ENTITY_RCEIL },
+	{ "RoundImplies",		MANUAL_ENTITY_ROUNDIMPLIES },
+	{ "SquareSubset",		MANUAL_ENTITY_SQUARESUBSET },
+	{ "UnderBracket",		MANUAL_ENTITY_UNDERBRACKET },
+	{ "VerticalLine",		MANUAL_ENTITY_VERTICALLINE },
+	{ "blacklozenge",		MANUAL_ENTITY_BLACKLOZENGE },
+	{ "exponentiale",		MANUAL_ENTITY_EXPONENTIALE_L },
+	{ "risingdotseq",		MANUAL_ENTITY_ERDOT },
+	{ "triangledown",		MANUAL_ENTITY_DTRI },
+	{ "triangleleft",		MANUAL_ENTITY_LTRI },
+
+	/* 13 characters */
+
+	{ "ApplyFunction",		MANUAL_ENTITY_APPLYFUNCTION },
+	{ "DifferentialD",		MANUAL_ENTITY_DIFFERENTIALD_L },
+	{ "DoubleLeftTee",		MANUAL_ENTITY_DASHV },
+	{ "LeftTeeVector",		MANUAL_ENTITY_LEFTTEEVECTOR },
+	{ "LeftVectorBar",		MANUAL_ENTITY_LEFTVECTORBAR },
+	{ "LessFullEqual",		MANUAL_ENTITY_LESSFULLEQUAL },
+	{ "LongLeftArrow",		MANUAL_ENTITY_LONGLEFTARROW },
+	{ "Longleftarrow",		MANUAL_ENTITY_DOUBLELONGLEFTARROW },
+	{ "NotTildeEqual",		MANUAL_ENTITY_NOTTILDEEQUAL },
+	{ "NotTildeTilde",		MANUAL_ENTITY_NOTTILDETILDE },
+	{ "Poincareplane",		MANUAL_ENTITY_HFR_U },
+	{ "PrecedesEqual",		MANUAL_ENTITY_PRECEDESEQUAL },
+	{ "PrecedesTilde",		MANUAL_ENTITY_PRECEDESTILDE },
+	{ "RightArrowBar",		MANUAL_ENTITY_RIGHTARROWBAR },
+	{ "RightTeeArrow",		MANUAL_ENTITY_RIGHTTEEARROW },
+	{ "RightTriangle",		MANUAL_ENTITY_RIGHTTRIANGLE },
+	{ "RightUpVector",		MANUAL_ENTITY_RIGHTUPVECTOR },
+	{ "SucceedsEqual",		MANUAL_ENTITY_SUCCEEDSEQUAL },
+	{ "SucceedsTilde",		MANUAL_ENTITY_SUCCEEDSTILDE },
+	{ "UpEquilibrium",		MANUAL_ENTITY_UPEQUILIBRIUM },
+	{ "VerticalTilde",		MANUAL_ENTITY_VERTICALTILDE },
+	{ "VeryThinSpace",		MANUAL_ENTITY_VERYTHINSPACE },
+	{ "bigtriangleup",		MANUAL_ENTITY_BIGTRIANGLEUP },
+	{ "blacktriangle",		MANUAL_ENTITY_BLACKTRIANGLE },
+	{ "divideontimes",		MANUAL_ENTITY_DIVIDEONTIMES },
+	{ "fallingdotseq",		MANUAL_ENTITY_EFDOT },
+	{ "hookleftarrow",		MANUAL_ENTITY_HOOKLEFTARROW },
+	{ "leftarrowtail",		MANUAL_ENTITY_LARRTL },
+	{ "leftharpoonup",		MANUAL_ENTITY_LEFTVECTOR },
+	{ "longleftarrow",		MANUAL_ENTITY_LONGLEFTARROW },
+	{ "looparrowleft",		MANUAL_ENTITY_LARRLP },
+	{ "measuredangle",		MANUAL_ENTITY_ANGMSD },
+	{ "ntriangleleft",		MANUAL_ENTITY_NOTLEFTTRIANGLE },
+	{ "shortparallel",		MANUAL_ENTITY_DOUBLEVERTICALBAR },
+	{ "smallsetminus",		MANUAL_ENTITY_BACKSLASH },
+	{ "triangleright",		MANUAL_ENTITY_RTRI },
+	{ "upharpoonleft",		MANUAL_ENTITY_LEFTUPVECTOR },
+
+	/* 14 characters */
+
+	{ "DiacriticalDot",		MANUAL_ENTITY_DIACRITICALDOT },
+	{ "DoubleRightTee",		MANUAL_ENTITY_DOUBLERIGHTTEE },
+	{ "DownLeftVector",		MANUAL_ENTITY_DOWNLEFTVECTOR },
+	{ "GreaterGreater",		MANUAL_ENTITY_GREATERGREATER },
+	{ "HorizontalLine",		MANUAL_ENTITY_HORIZONTALLINE },
+	{ "InvisibleComma",		MANUAL_ENTITY_INVISIBLECOMMA },
+	{ "InvisibleTimes",		MANUAL_ENTITY_INVISIBLETIMES },
+	{ "LeftDownVector",		MANUAL_ENTITY_LEFTDOWNVECTOR },
+	{ "LessSlantEqual",		MANUAL_ENTITY_LESSSLANTEQUAL },
+	{ "LongRightArrow",		MANUAL_ENTITY_LONGRIGHTARROW },
+	{ "Longrightarrow",		MANUAL_ENTITY_DOUBLELONGRIGHTARROW },
+	{ "LowerLeftArrow",		MANUAL_ENTITY_LOWERLEFTARROW },
+	{ "NotGreaterLess",		MANUAL_ENTITY_NOTGREATERLESS },
+	{ "NotLessGreater",		MANUAL_ENTITY_NOTLESSGREATER },
+	{ "NotSubsetEqual",		MANUAL_ENTITY_NOTSUBSETEQUAL },
+	{ "NotVerticalBar",		MANUAL_ENTITY_NOTVERTICALBAR },
+	{ "OpenCurlyQuote",		MANUAL_ENTITY_LSQUO },
+	{ "ReverseElement",		MANUAL_ENTITY_NI },
+	{ "RightTeeVector",		MANUAL_ENTITY_RIGHTTEEVECTOR },
+	{ "RightVectorBar",		MANUAL_ENTITY_RIGHTVECTORBAR },
+	{ "SquareSuperset",		MANUAL_ENTITY_SQUARESUPERSET },
+	{ "TildeFullEqual",		MANUAL_ENTITY_CONG },
+	{ "UpperLeftArrow",		MANUAL_ENTITY_UPPERLEFTARROW },
+	{ "ZeroWidthSpace",		MANUAL_ENTITY_NEGATIVEMEDIUMSPACE },
+	{ "curvearrowleft",		MANUAL_ENTITY_CULARR },
+	{ "downdownarrows",		MANUAL_ENTITY_DDARR },
+	{ "hookrightarrow",		MANUAL_ENTITY_HOOKRIGHTARROW },
+	{ "leftleftarrows",		MANUAL_ENTITY_LEFTLEFTARROWS },
+	{ "leftthreetimes",		MANUAL_ENTITY_LEFTTHREETIMES },
+	{ "longrightarrow",		MANUAL_ENTITY_LONGRIGHTARROW },
+	{ "looparrowright",		MANUAL_ENTITY_LOOPARROWRIGHT },
+	{ "nshortparallel",		MANUAL_ENTITY_NOTDOUBLEVERTICALBAR },
+	{ "ntriangleright",		MANUAL_ENTITY_NOTRIGHTTRIANGLE },
+	{ "rightarrowtail",		MANUAL_ENTITY_RARRTL },
+	{ "rightharpoonup",		MANUAL_ENTITY_RIGHTVECTOR },
+	{ "trianglelefteq",		MANUAL_ENTITY_LEFTTRIANGLEEQUAL },
+	{ "upharpoonright",		MANUAL_ENTITY_RIGHTUPVECTOR },
+
+	/* 15 characters */
+
+	{ "CloseCurlyQuote",		MANUAL_ENTITY_RSQUO },
+	{ "ContourIntegral",		MANUAL_ENTITY_CONTOURINTEGRAL },
+	{ "DownRightVector",		MANUAL_ENTITY_DOWNRIGHTVECTOR },
+	{ "LeftRightVector",		MANUAL_ENTITY_LEFTRIGHTVECTOR },
+	{ "LeftTriangleBar",		MANUAL_ENTITY_LEFTTRIANGLEBAR },
+	{ "LeftUpTeeVector",		MANUAL_ENTITY_LEFTUPTEEVECTOR },
+	{ "LeftUpVectorBar",		MANUAL_ENTITY_LEFTUPVECTORBAR },
+	{ "LowerRightArrow",		MANUAL_ENTITY_LOWERRIGHTARROW },
+	{ "NotGreaterEqual",		MANUAL_ENTITY_NOTGREATEREQUAL },
+	{ "NotGreaterTilde",		MANUAL_ENTITY_NOTGREATERTILDE },
+	{ "NotLeftTriangle",		MANUAL_ENTITY_NOTLEFTTRIANGLE },
+	{ "OverParenthesis",		MANUAL_ENTITY_OVERPARENTHESIS },
+	{ "RightDownVector",		MANUAL_ENTITY_RIGHTDOWNVECTOR },
+	{ "UpperRightArrow",		MANUAL_ENTITY_UPPERRIGHTARROW },
+	{ "bigtriangledown",		MANUAL_ENTITY_BIGTRIANGLEDOWN },
+	{ "circlearrowleft",		MANUAL_ENTITY_CIRCLEARROWLEFT },
+	{ "curvearrowright",		MANUAL_ENTITY_CURARR },
+	{ "downharpoonleft",		MANUAL_ENTITY_LEFTDOWNVECTOR },
+	{ "leftharpoondown",		MANUAL_ENTITY_DOWNLEFTVECTOR },
+	{ "leftrightarrows",		MANUAL_ENTITY_LEFTARROWRIGHTARROW },
+	{ "nLeftrightarrow",		MANUAL_ENTITY_NLEFTRIGHTARROW },
+	{ "nleftrightarrow",		MANUAL_ENTITY_NHARR },
+	{ "ntrianglelefteq",		MANUAL_ENTITY_NOTLEFTTRIANGLEEQUAL },
+	{ "rightleftarrows",		MANUAL_ENTITY_RIGHTARROWLEFTARROW },
+	{ "rightsquigarrow",		MANUAL_ENTITY_RARRW },
+	{ "rightthreetimes",		MANUAL_ENTITY_RIGHTTHREETIMES },
+	{ "straightepsilon",		MANUAL_ENTITY_EPSIV_L },
+	{ "trianglerighteq",		MANUAL_ENTITY_RIGHTTRIANGLEEQUAL },
+	{ "vartriangleleft",		MANUAL_ENTITY_LEFTTRIANGLE },
+
+	/* 16 characters */
+
+	{ "DiacriticalAcute",		MANUAL_ENTITY_ACUTE },
+	{ "DiacriticalGrave",		MANUAL_ENTITY_DIACRITICALGRAVE },
+	{ "DiacriticalTilde",		MANUAL_ENTITY_TILDE },
+	{ "DownArrowUpArrow",		MANUAL_ENTITY_DOWNARROWUPARROW },
+	{ "EmptySmallSquare",		MANUAL_ENTITY_EMPTYSMALLSQUARE },
+	{ "GreaterEqualLess",		MANUAL_ENTITY_GREATEREQUALLESS },
+	{ "GreaterFullEqual",		MANUAL_ENTITY_GREATERFULLEQUAL },
+	{ "LeftAngleBracket",		MANUAL_ENTITY_LEFTANGLEBRACKET },
+	{ "LeftUpDownVector",		MANUAL_ENTITY_LEFTUPDOWNVECTOR },
+	{ "LessEqualGreater",		MANUAL_ENTITY_LESSEQUALGREATER },
+	{ "NonBreakingSpace",		MANUAL_ENTITY_NBSP },
+	{ "NotRightTriangle",		MANUAL_ENTITY_NOTRIGHTTRIANGLE },
+	{ "NotSupersetEqual",		MANUAL_ENTITY_NOTSUPERSETEQUAL },
+	{ "RightTriangleBar",		MANUAL_ENTITY_RIGHTTRIANGLEBAR },
+	{ "RightUpTeeVector",		MANUAL_ENTITY_RIGHTUPTEEVECTOR },
+	{ "RightUpVectorBar",		MANUAL_ENTITY_RIGHTUPVECTORBAR },
+	{ "UnderParenthesis",		MANUAL_ENTITY_UNDERPARENTHESIS },
+	{ "UpArrowDownArrow",		MANUAL_ENTITY_UPARROWDOWNARROW },
+	{ "circlearrowright",		MANUAL_ENTITY_CIRCLEARROWRIGHT },
+	{ "downharpoonright",		MANUAL_ENTITY_RIGHTDOWNVECTOR },
+	{ "ntrianglerighteq",		MANUAL_ENTITY_NOTRIGHTTRIANGLEEQUAL },
+	{ "rightharpoondown",		MANUAL_ENTITY_DOWNRIGHTVECTOR },
+	{ "rightrightarrows",		MANUAL_ENTITY_RIGHTRIGHTARROWS },
+	{ "vartriangleright",		MANUAL_ENTITY_RIGHTTRIANGLE },
+
+	/* 17 characters */
+
+	{ "DoubleUpDownArrow",		MANUAL_ENTITY_DOUBLEUPDOWNARROW },
+	{ "DoubleVerticalBar",		MANUAL_ENTITY_DOUBLEVERTICALBAR },
+	{ "DownLeftTeeVector",		MANUAL_ENTITY_DOWNLEFTTEEVECTOR },
+	{ "DownLeftVectorBar",		MANUAL_ENTITY_DOWNLEFTVECTORBAR },
+	{ "FilledSmallSquare",		MANUAL_ENTITY_FILLEDSMALLSQUARE },
+	{ "GreaterSlantEqual",		MANUAL_ENTITY_GREATERSLANTEQUAL },
+	{ "LeftDoubleBracket",		MANUAL_ENTITY_LEFTDOUBLEBRACKET },
+	{ "LeftDownTeeVector",		MANUAL_ENTITY_LEFTDOWNTEEVECTOR },
+	{ "LeftDownVectorBar",		MANUAL_ENTITY_LEFTDOWNVECTORBAR },
+	{ "LeftTriangleEqual",		MANUAL_ENTITY_LEFTTRIANGLEEQUAL },
+	{ "NegativeThinSpace",		MANUAL_ENTITY_NEGATIVEMEDIUMSPACE },
+	{ "NotReverseElement",		MANUAL_ENTITY_NOTREVERSEELEMENT },
+	{ "NotTildeFullEqual",		MANUAL_ENTITY_NOTTILDEFULLEQUAL },
+	{ "RightAngleBracket",		MANUAL_ENTITY_RIGHTANGLEBRACKET },
+	{ "RightUpDownVector",		MANUAL_ENTITY_RIGHTUPDOWNVECTOR },
+	{ "SquareSubsetEqual",		MANUAL_ENTITY_SQUARESUBSETEQUAL },
+	{ "VerticalSeparator",		MANUAL_ENTITY_VERTICALSEPARATOR },
+	{ "blacktriangledown",		MANUAL_ENTITY_BLACKTRIANGLEDOWN },
+	{ "blacktriangleleft",		MANUAL_ENTITY_BLACKTRIANGLELEFT },
+	{ "leftrightharpoons",		MANUAL_ENTITY_REVERSEEQUILIBRIUM },
+	{ "rightleftharpoons",		MANUAL_ENTITY_EQUILIBRIUM },
+
+	/* 18 characters */
+
+	{ "DownRightTeeVector",		MANUAL_ENTITY_DOWNRIGHTTEEVECTOR },
+	{ "DownRightVectorBar",		MANUAL_ENTITY_DOWNRIGHTVECTORBAR },
+	{ "LongLeftRightArrow",		MANUAL_ENTITY_LONGLEFTRIGHTARROW },
+	{ "Longleftrightarrow",		MANUAL_ENTITY_DOUBLELONGLEFTRIGHTARROW },
+	{ "NegativeThickSpace",		MANUAL_ENTITY_NEGATIVEMEDIUMSPACE },
+	{ "PrecedesSlantEqual",		MANUAL_ENTITY_PRECEDESSLANTEQUAL },
+	{ "ReverseEquilibrium",		MANUAL_ENTITY_REVERSEEQUILIBRIUM },
+	{ "RightDoubleBracket",		MANUAL_ENTITY_RIGHTDOUBLEBRACKET },
+	{ "RightDownTeeVector",		MANUAL_ENTITY_RIGHTDOWNTEEVECTOR },
+	{ "RightDownVectorBar",		MANUAL_ENTITY_RIGHTDOWNVECTORBAR },
+	{ "RightTriangleEqual",		MANUAL_ENTITY_RIGHTTRIANGLEEQUAL },
+	{ "SquareIntersection",		MANUAL_ENTITY_SQUAREINTERSECTION },
+	{ "SucceedsSlantEqual",		MANUAL_ENTITY_SUCCEEDSSLANTEQUAL },
+	{ "blacktriangleright",		MANUAL_ENTITY_BLACKTRIANGLERIGHT },
+	{ "longleftrightarrow",		MANUAL_ENTITY_LONGLEFTRIGHTARROW },
+
+	/* 19 characters */
+
+	{ "DoubleLongLeftArrow",	MANUAL_ENTITY_DOUBLELONGLEFTARROW },
+	{ "DownLeftRightVector",	MANUAL_ENTITY_DOWNLEFTRIGHTVECTOR },
+	{ "LeftArrowRightArrow",	MANUAL_ENTITY_LEFTARROWRIGHTARROW },
+	{ "NegativeMediumSpace",	MANUAL_ENTITY_NEGATIVEMEDIUMSPACE },
+	{ "RightArrowLeftArrow",	MANUAL_ENTITY_RIGHTARROWLEFTARROW },
+	{ "SquareSupersetEqual",	MANUAL_ENTITY_SQUARESUPERSETEQUAL },
+	{ "leftrightsquigarrow",	MANUAL_ENTITY_HARRW },
+
+	/* 20 characters */
+
+	{ "CapitalDifferentialD",	MANUAL_ENTITY_DIFFERENTIALD_U },
+	{ "DoubleLongRightArrow",	MANUAL_ENTITY_DOUBLELONGRIGHTARROW },
+	{ "EmptyVerySmallSquare",	MANUAL_ENTITY_EMPTYVERYSMALLSQUARE },
+	{ "NotDoubleVerticalBar",	MANUAL_ENTITY_NOTDOUBLEVERTICALBAR },
+	{ "NotLeftTriangleEqual",	MANUAL_ENTITY_NOTLEFTTRIANGLEEQUAL },
+	{ "NotSquareSubsetEqual",	MANUAL_ENTITY_NOTSQUARESUBSETEQUAL },
+	{ "OpenCurlyDoubleQuote",	MANUAL_ENTITY_LDQUO },
+	{ "ReverseUpEquilibrium",	MANUAL_ENTITY_REVERSEUPEQUILIBRIUM },
+
+	/* 21 characters */
+
+	{ "CloseCurlyDoubleQuote",	MANUAL_ENTITY_RDQUO },
+	{ "DoubleContourIntegral",	MANUAL_ENTITY_CONINT },
+	{ "FilledVerySmallSquare",	MANUAL_ENTITY_FILLEDVERYSMALLSQUARE },
+	{ "NegativeVeryThinSpace",	MANUAL_ENTITY_NEGATIVEMEDIUMSPACE },
+	{ "NotPrecedesSlantEqual",	MANUAL_ENTITY_NOTPRECEDESSLANTEQUAL },
+	{ "NotRightTriangleEqual",	MANUAL_ENTITY_NOTRIGHTTRIANGLEEQUAL },
+	{ "NotSucceedsSlantEqual",	MANUAL_ENTITY_NOTSUCCEEDSSLANTEQUAL },
+
+	/* 22 characters */
+
+	{ "DiacriticalDoubleAcute",	MANUAL_ENTITY_DIACRITICALDOUBLEACUTE },
+	{ "NotSquareSupersetEqual",	MANUAL_ENTITY_NOTSQUARESUPERSETEQUAL },
+
+	/* 24 characters */
+
+	{ "ClockwiseContourIntegral",	MANUAL_ENTITY_CLOCKWISECONTOURINTEGRAL },
+	{ "DoubleLongLeftRightArrow",	MANUAL_ENTITY_DOUBLELONGLEFTRIGHTARROW },
+
+	/* 31 characters */
+
+	{ "CounterClockwiseContourIntegral",	MANUAL_ENTITY_COUNTERCLOCKWISECONTOURINTEGRAL },
+};
+
+/**
+ * The number of entries in the entity name lookup table.
+ */
+
+#define MANUAL_ENTITY_LOOKUP_ENTRIES ((int) (sizeof(manual_entity_lookup) / sizeof(struct manual_entity_lookup)))
+
+/**
+ * The number of codepoints covered by each page of the codepoint table.
+ */
+
+#define MANUAL_ENTITY_PAGE_SIZE 256
+
+/**
+ * The number of pages in the codepoint table, covering the Basic
+ * Multilingual Plane.
+ */
+
+#define MANUAL_ENTITY_PAGES 256
+
+/**
+ * A two-level lookup table from unicode codepoints in the Basic Multilingual
+ * Plane to indexes into manual_entity_names[]. Pages with no entities share
+ * an empty page, and a zero index indicates that there is no entity; this
+ * is safe as the first entry in the list has no codepoint.
+ */
+
+static const unsigned short *manual_entity_codepoint_pages[MANUAL_ENTITY_PAGES];
+
+/**
+ * The empty page, shared by the codepoint table.
+ */
+
+static const unsigned short manual_entity_empty_page[MANUAL_ENTITY_PAGE_SIZE];
+
+/**
+ * Control for the one-time initialisation of the codepoint table.
+ */
+
+static pthread_once_t manual_entity_codepoint_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the codepoint table was initialised successfully.
+ */
+
+static bool manual_entity_codepoint_valid = false;
+
 /* Static function prototypes. */
 
-static bool manual_entity_initialise_lists(void);
+static const struct manual_entity_lookup *manual_entity_find_lookup(const char *name);
+static void manual_entity_initialise_codepoints(void);
 
 /**
  * Given a node containing an entity, return the entity type.
@@ -1635,19 +3630,14 @@ static bool manual_entity_initialise_lists(void);
 
 enum manual_entity_type manual_entity_find_type(char *name)
 {
-	struct manual_entity_definition *entity;
+	const struct manual_entity_lookup *entity;
 
 	if (name == NULL)
 		return MANUAL_ENTITY_NONE;
 
-	/* If the search tree hasn't been initialised, do it now.*/
-
-	if (manual_entity_search_tree == NULL && !manual_entity_initialise_lists())
-		return MANUAL_ENTITY_NONE;
-
 	/* Find the entity definition. */
 
-	entity = search_tree_find_entry(manual_entity_search_tree, name);
+	entity = manual_entity_find_lookup(name);
 	if (entity == NULL) {
 		msg_report(MSG_UNKNOWN_ENTITY, name);
 		return MANUAL_ENTITY_NONE;
@@ -1666,10 +3656,7 @@ enum manual_entity_type manual_entity_find_type(char *name)
 
 const char *manual_entity_find_name(enum manual_entity_type type)
 {
-	if (manual_entities_max_entries <= 0 && !manual_entity_initialise_lists())
-		return NULL;
-
-	if (type == MANUAL_ENTITY_NONE || type < 0 || type >= manual_entities_max_entries)
+	if (type == MANUAL_ENTITY_NONE || type < 0 || type >= MANUAL_ENTITY_MAX_ENTRIES)
 		return NULL;
 
 	/* Look up the tag name.
@@ -1690,10 +3677,7 @@ const char *manual_entity_find_name(enum manual_entity_type type)
 
 int manual_entity_find_codepoint(enum manual_entity_type type)
 {
-	if (manual_entities_max_entries <= 0 && !manual_entity_initialise_lists())
-		return MANUAL_ENTITY_NO_CODEPOINT;
-
-	if (type == MANUAL_ENTITY_NONE || type < 0 || type >= manual_entities_max_entries)
+	if (type == MANUAL_ENTITY_NONE || type < 0 || type >= MANUAL_ENTITY_MAX_ENTRIES)
 		return MANUAL_ENTITY_NO_CODEPOINT;
 
 	/* Look up the tag name.
@@ -1716,17 +3700,23 @@ int manual_entity_find_codepoint(enum manual_entity_type type)
 
 const char *manual_entity_find_name_from_codepoint(int codepoint)
 {
-	int first = 0, last, middle;
-
-	if (manual_entities_max_entries <= 0 && !manual_entity_initialise_lists())
-		return NULL;
+	int first = 0, last, middle, i;
 
 	if (codepoint < 0)
 		return NULL;
 
+	/* Codepoints in the Basic Multilingual Plane can be looked up directly. */
+
+	pthread_once(&manual_entity_codepoint_once, manual_entity_initialise_codepoints);
+
+	if (manual_entity_codepoint_valid && codepoint < MANUAL_ENTITY_PAGES * MANUAL_ENTITY_PAGE_SIZE) {
+		i = manual_entity_codepoint_pages[codepoint / MANUAL_ENTITY_PAGE_SIZE][codepoint % MANUAL_ENTITY_PAGE_SIZE];
+		return (i != 0) ? manual_entity_names[i].name : NULL;
+	}
+
 	/* Find the character in the current encoding. */
 
-	last = manual_entities_max_entries;
+	last = MANUAL_ENTITY_MAX_ENTRIES;
 
 	while (first <= last) {
 		middle = (first + last) / 2;
@@ -1749,53 +3739,76 @@ const char *manual_entity_find_name_from_codepoint(int codepoint)
 }
 
 /**
- * Initialise the parse tree and entity list.
- * 
- * \return		True if successful; False on failure.
+ * Find the lookup table entry for an entity name.
+ *
+ * \param *name		Pointer to the textual entity name.
+ * \return		Pointer to the lookup table entry, or NULL if
+ *			the name was not recognised.
  */
 
-static bool manual_entity_initialise_lists(void)
+static const struct manual_entity_lookup *manual_entity_find_lookup(const char *name)
 {
-	char **alternative;
-	int i, j, current_code = -1;
+	int first = 0, last, middle, result;
+	size_t length, middle_length;
 
-	if (manual_entity_search_tree != NULL || manual_entities_max_entries > 0)
-		return false;
+	length = strlen(name);
 
-	/* Create a new search tree. */
+	last = MANUAL_ENTITY_LOOKUP_ENTRIES - 1;
 
-	manual_entity_search_tree = search_tree_create();
-	if (manual_entity_search_tree == NULL)
-		return false;
+	while (first <= last) {
+		middle = (first + last) / 2;
 
-	/* Add the element tags to the search tree. */
+		/* Compare lengths first, which usually avoids the strcmp(). */
 
-	for (i = 0; manual_entity_names[i].type != MANUAL_ENTITY_NONE; i++) {
-		if (!search_tree_add_entry(manual_entity_search_tree, manual_entity_names[i].name, &(manual_entity_names[i])))
-			return false;
+		middle_length = strlen(manual_entity_lookup[middle].name);
 
-		alternative = manual_entity_names[i].alternatives;
+		if (middle_length != length)
+			result = (middle_length < length) ? -1 : 1;
+		else
+			result = strcmp(manual_entity_lookup[middle].name, name);
 
-		if (alternative != NULL) {
-			for (j = 0; alternative[j] != NULL; j++) {
-				if (!search_tree_add_entry(manual_entity_search_tree, alternative[j], &(manual_entity_names[i])))
-					return false;
-			}
-		}
+		if (result == 0)
+			return manual_entity_lookup + middle;
+		else if (result < 0)
+			first = middle + 1;
+		else
+			last = middle - 1;
+	}
+
+	return NULL;
+}
+
+/**
+ * Build the codepoint lookup table, on behalf of pthread_once(). If
+ * memory runs out, the table is left invalid and lookups fall back to
+ * searching the entity list.
+ */
 
-		/* Check that the values are in the correct index slots, to allow for
-		 * quick lookups.
-		 */
+static void manual_entity_initialise_codepoints(void)
+{
+	unsigned short	*page;
+	int		i, codepoint;
 
-		if (manual_entity_names[i].type != i || manual_entity_names[i].unicode < current_code) {
-			msg_report(MSG_ENTITY_OUT_OF_SEQ);
-			return false;
+	for (i = 0; i < MANUAL_ENTITY_PAGES; i++)
+		manual_entity_codepoint_pages[i] = manual_entity_empty_page;
+
+	for (i = 1; i < MANUAL_ENTITY_MAX_ENTRIES; i++) {
+		codepoint = manual_entity_names[i].unicode;
+
+		if (codepoint < 0 || codepoint >= MANUAL_ENTITY_PAGES * MANUAL_ENTITY_PAGE_SIZE)
+			continue;
+
+		if (manual_entity_codepoint_pages[codepoint / MANUAL_ENTITY_PAGE_SIZE] == manual_entity_empty_page) {
+			page = calloc(MANUAL_ENTITY_PAGE_SIZE, sizeof(unsigned short));
+			if (page == NULL)
+				return;
+
+			manual_entity_codepoint_pages[codepoint / MANUAL_ENTITY_PAGE_SIZE] = page;
 		}
 
-		current_code = manual_entity_names[i].unicode;
+		page = (unsigned short *) manual_entity_codepoint_pages[codepoint / MANUAL_ENTITY_PAGE_SIZE];
+		page[codepoint % MANUAL_ENTITY_PAGE_SIZE] = i;
 	}
 
-	manual_entities_max_entries = i;
-
-	return true;
+	manual_entity_codepoint_valid = true;
 }
@@ -29,6 +29,7 @@
 
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -36,48 +37,78 @@
 #include "manual_data.h"
 #include "manual_ids.h"
 #include "msg.h"
+#include "stats.h"
+#include "string.h"
 
 /**
- * The size of the manual IDs hash table.
+ * The initial number of slots in the manual IDs hash table. This must
+ * be a power of two.
  */
 
-#define MANUAL_IDS_HASH_SIZE 100
+#define MANUAL_IDS_INITIAL_SIZE 128
 
 /**
- * An entry in the ID tag index.
+ * The table is grown once more than this many slots in every
+ * MANUAL_IDS_LOAD_DIVISOR are in use.
+ */
+
+#define MANUAL_IDS_LOAD_LIMIT 3
+
+/**
+ * The divisor applied to the table size by MANUAL_IDS_LOAD_LIMIT.
+ */
+
+#define MANUAL_IDS_LOAD_DIVISOR 4
+
+/**
+ * A slot in the ID tag index.
  */
 
 struct manual_ids_entry {
 	/**
-	 * The ID tag for the node. This will just be set to point to the
-	 * data held by the node itself.
+	 * The ID tag for the node, or NULL if the slot is empty. This will
+	 * just be set to point to the data held by the node itself.
 	 */
 
 	char			*id;
 
 	/**
-	 * The node relating to the tag.
+	 * The hash value calculated for the ID tag.
 	 */
 
-	struct manual_data	*node;
+	uint64_t		hash;
 
 	/**
-	 * Pointer to the next ID entry, or NULL.
+	 * The node relating to the tag.
 	 */
 
-	struct manual_ids_entry	*next;
+	struct manual_data	*node;
 };
 
 /**
- * The ID hash table.
+ * The ID hash table, using open addressing with linear probing.
  */
 
-struct manual_ids_entry	*manual_ids_table[MANUAL_IDS_HASH_SIZE];
+static struct manual_ids_entry *manual_ids_table = NULL;
+
+/**
+ * The number of slots in the ID hash table.
+ */
+
+static size_t manual_ids_table_size = 0;
+
+/**
+ * The number of slots in use in the ID hash table.
+ */
+
+static size_t manual_ids_table_used = 0;
 
 /* Static Function Prototypes. */
 
 static struct manual_ids_entry *manual_ids_find_id(char *id);
-static int manual_ids_get_hash(char *id);
+static struct manual_ids_entry *manual_ids_find_slot(char *id, uint64_t hash);
+static bool manual_ids_grow_table(void);
+static uint64_t manual_ids_get_hash(char *id);
 
 /**
  * Initialise the manual IDs index.
@@ -85,12 +116,13 @@ static int manual_ids_get_hash(char *id);
 
 void manual_ids_initialise(void)
 {
-	int i;
+	/* Release any previous table; the IDs themselves belong to the nodes. */
 
-	/* Zero the hash table entries. */
+	free(manual_ids_table);
 
-	for (i = 0; i < MANUAL_IDS_HASH_SIZE; i++)
-		manual_ids_table[i] = NULL;
+	manual_ids_table = NULL;
+	manual_ids_table_size = 0;
+	manual_ids_table_used = 0;
 }
 
 /**
@@ -99,20 +131,16 @@ void manual_ids_initialise(void)
 
 void manual_ids_dump(void)
 {
-	struct manual_ids_entry	*entry;
-	int			i;
-
-	msg_report(MSG_ID_HASH_DUMP);
+	size_t i;
 
-	for (i = 0; i < MANUAL_IDS_HASH_SIZE; i++) {
-		entry = manual_ids_table[i];
+	msg_trace(MSG_ID_HASH_DUMP);
 
-		msg_report(MSG_ID_HASH_LINE, i, entry);
+	for (i = 0; i < manual_ids_table_size; i++) {
+		if (manual_ids_table[i].id == NULL)
+			continue;
 
-		while (entry != NULL) {
-			msg_report(MSG_ID_HASH_ENTRY, entry->id);
-			entry = entry->next;
-		}
+		msg_trace(MSG_ID_HASH_LINE, (int) i, (unsigned int) manual_ids_table[i].hash);
+		msg_trace(MSG_ID_HASH_ENTRY, manual_ids_table[i].id);
 	}
 }
 
@@ -125,8 +153,8 @@ void manual_ids_dump(void)
 
 bool manual_ids_add_node(struct manual_data *node)
 {
-	struct manual_ids_entry	*new;
-	int			hash;
+	struct manual_ids_entry	*slot;
+	uint64_t		hash;
 
 	if (node == NULL || node->chapter.id == NULL)
 		return false;
@@ -160,26 +188,32 @@ bool manual_ids_add_node(struct manual_data *node)
 		return false;
 	}
 
-	/* Check that the ID isn't in the table already. */
+	/* Make room for a new record, then check that the ID isn't in the
+	 * table already.
+	 */
 
-	if (manual_ids_find_id(node->chapter.id) != NULL) {
-		msg_report(MSG_ID_BAD_STORE, node->chapter.id);
+	if ((manual_ids_table_used + 1) * MANUAL_IDS_LOAD_DIVISOR > manual_ids_table_size * MANUAL_IDS_LOAD_LIMIT &&
+			!manual_ids_grow_table())
 		return false;
-	}
 
-	/* Create the new record and link it into the table. */
+	hash = manual_ids_get_hash(node->chapter.id);
+
+	slot = manual_ids_find_slot(node->chapter.id, hash);
 
-	new = malloc(sizeof(struct manual_ids_entry));
-	if (new == NULL)
+	if (slot->id != NULL) {
+		msg_report(MSG_ID_BAD_STORE, node->chapter.id);
 		return false;
+	}
 
-	hash = manual_ids_get_hash(node->chapter.id);
+	/* Store the new record in the table. */
 
-	new->id = node->chapter.id;
-	new->node = node;
+	slot->id = node->chapter.id;
+	slot->hash = hash;
+	slot->node = node;
 
-	new->next = manual_ids_table[hash];
-	manual_ids_table[hash] = new;
+	manual_ids_table_used++;
+
+	stats_count(STATS_COUNTER_IDS, 1);
 
 	return true;
 }
@@ -219,9 +253,59 @@ struct manual_data *manual_ids_find_node(struct manual_data *node)
 		return NULL;
 	}
 
+	stats_count(STATS_COUNTER_REFERENCES, 1);
+
 	return entry->node;
 }
 
+/**
+ * Given a reference node, find the node that it refers to if it has been
+ * indexed, without reporting any problems or counting the lookup.
+ *
+ * \param *node		The reference node to start from.
+ * \return		The target node, or NULL.
+ */
+
+struct manual_data *manual_ids_peek_node(struct manual_data *node)
+{
+	struct manual_ids_entry *entry;
+
+	if (node == NULL || node->type != MANUAL_DATA_OBJECT_TYPE_REFERENCE)
+		return NULL;
+
+	entry = manual_ids_find_id(node->chunk.id);
+
+	return (entry != NULL) ? entry->node : NULL;
+}
+
+/**
+ * Replace a node in the index with a copy carrying the same ID. If the
+ * original node wasn't the one indexed under the ID, nothing is changed.
+ *
+ * \param *original	The node which was indexed.
+ * \param *node		The node to be indexed in place of the original.
+ * \return		True if successful; False if the original wasn't indexed.
+ */
+
+bool manual_ids_update_node(struct manual_data *original, struct manual_data *node)
+{
+	struct manual_ids_entry *entry;
+
+	if (original == NULL || node == NULL || node->chapter.id == NULL)
+		return false;
+
+	entry = manual_ids_find_id(node->chapter.id);
+	if (entry == NULL || entry->node != original)
+		return false;
+
+	/* The ID text must be re-pointed too, as it belongs to the node. */
+
+	entry->id = node->chapter.id;
+	entry->node = node;
+
+	return true;
+}
+
 /**
  * Given and ID, find a matching record in the index.
  *
@@ -231,23 +315,84 @@ struct manual_data *manual_ids_find_node(struct manual_data *node)
 
 static struct manual_ids_entry *manual_ids_find_id(char *id)
 {
-	struct manual_ids_entry *entry = NULL;
-	int hash;
+	struct manual_ids_entry *entry;
 
-	if (id == NULL)
+	if (id == NULL || manual_ids_table == NULL)
 		return NULL;
 
-	hash = manual_ids_get_hash(id);
-	entry = manual_ids_table[hash];
+	entry = manual_ids_find_slot(id, manual_ids_get_hash(id));
+
+	return (entry->id != NULL) ? entry : NULL;
+}
+
+/**
+ * Find the slot in the index which holds an ID, or the empty slot at
+ * which it would be stored if it isn't present. The table must exist,
+ * and must contain at least one empty slot.
+ *
+ * \param *id		The ID to search for.
+ * \param hash		The hash value calculated for the ID.
+ * \return		Pointer to the matching or empty slot.
+ */
+
+static struct manual_ids_entry *manual_ids_find_slot(char *id, uint64_t hash)
+{
+	struct manual_ids_entry *entry;
+	size_t mask, i;
+
+	mask = manual_ids_table_size - 1;
 
-	while (entry != NULL) {
-		if (entry->id != NULL && strcmp(id, entry->id) == 0)
+	for (i = hash & mask; ; i = (i + 1) & mask) {
+		entry = manual_ids_table + i;
+
+		if (entry->id == NULL)
+			return entry;
+
+		if (entry->hash == hash && strcmp(id, entry->id) == 0)
 			return entry;
+	}
+}
+
+/**
+ * Double the size of the index, or create it if it doesn't exist,
+ * rehashing any existing entries into the new table.
+ *
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_ids_grow_table(void)
+{
+	struct manual_ids_entry	*old_table, *slot;
+	size_t			old_size, i;
+
+	old_table = manual_ids_table;
+	old_size = manual_ids_table_size;
 
-		entry = entry->next;
+	manual_ids_table_size = (old_size > 0) ? old_size * 2 : MANUAL_IDS_INITIAL_SIZE;
+
+	manual_ids_table = malloc(manual_ids_table_size * sizeof(struct manual_ids_entry));
+	if (manual_ids_table == NULL) {
+		manual_ids_table = old_table;
+		manual_ids_table_size = old_size;
+		return false;
+	}
+
+	for (i = 0; i < manual_ids_table_size; i++)
+		manual_ids_table[i].id = NULL;
+
+	/* The cached hashes save working them out again. */
+
+	for (i = 0; i < old_size; i++) {
+		if (old_table[i].id == NULL)
+			continue;
+
+		slot = manual_ids_find_slot(old_table[i].id, old_table[i].hash);
+		*slot = old_table[i];
 	}
 
-	return NULL;
+	free(old_table);
+
+	return true;
 }
 
 /**
@@ -257,16 +402,10 @@ static struct manual_ids_entry *manual_ids_find_id(char *id)
  * \return		The calculated hash value.
  */
 
-static int manual_ids_get_hash(char *id)
+static uint64_t manual_ids_get_hash(char *id)
 {
-	int hash = 0;
-
 	if (id == NULL)
 		return 0;
 
-	while (*id != '\0')
-		hash += *id++;
-
-	return (hash % MANUAL_IDS_HASH_SIZE);
+	return string_hash(id, strlen(id), STRING_HASH_INITIAL);
 }
-
@@ -65,5 +65,25 @@ bool manual_ids_add_node(struct manual_data *node);
 
 struct manual_data *manual_ids_find_node(struct manual_data *node);
 
-#endif
+/**
+ * Given a reference node, find the node that it refers to if it has been
+ * indexed, without reporting any problems or counting the lookup.
+ *
+ * \param *node		The reference node to start from.
+ * \return		The target node, or NULL.
+ */
+
+struct manual_data *manual_ids_peek_node(struct manual_data *node);
 
+/**
+ * Replace a node in the index with a copy carrying the same ID. If the
+ * original node wasn't the one indexed under the ID, nothing is changed.
+ *
+ * \param *original	The node which was indexed.
+ * \param *node		The node to be indexed in place of the original.
+ * \return		True if successful; False if the original wasn't indexed.
+ */
+
+bool manual_ids_update_node(struct manual_data *original, struct manual_data *node);
+
+#endif
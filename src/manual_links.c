@@ -0,0 +1,378 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_links.c
+ *
+ * Relative Link Cache, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "manual_links.h"
+
+#include "filename.h"
+#include "manual_data.h"
+#include "modes.h"
+#include "string.h"
+
+/**
+ * The initial number of slots in a cache; must be a power of two.
+ */
+
+#define MANUAL_LINKS_INITIAL_SIZE 64
+
+/**
+ * The cache is grown once it becomes more than
+ * MANUAL_LINKS_LOAD_LIMIT / MANUAL_LINKS_LOAD_DIVISOR full.
+ */
+
+#define MANUAL_LINKS_LOAD_LIMIT 3
+#define MANUAL_LINKS_LOAD_DIVISOR 4
+
+/**
+ * A slot in the link cache, keyed on the nodes which own the source and
+ * target files.
+ */
+
+struct manual_links_slot {
+	/**
+	 * The node owning the source file, or NULL for the root file.
+	 */
+
+	struct manual_data	*source;
+
+	/**
+	 * The node owning the target file, or NULL for the root file.
+	 */
+
+	struct manual_data	*target;
+
+	/**
+	 * The relative link between the two files, or NULL if the slot
+	 * is free.
+	 */
+
+	char			*link;
+};
+
+/**
+ * A relative link cache instance.
+ */
+
+struct manual_links {
+	/**
+	 * The default root filename for the output.
+	 */
+
+	struct filename			*root;
+
+	/**
+	 * The output type for which links are calculated.
+	 */
+
+	enum modes_type			type;
+
+	/**
+	 * The platform for which links are formatted.
+	 */
+
+	enum filename_platform		platform;
+
+	/**
+	 * The cache slots, forming an open-addressed hash table.
+	 */
+
+	struct manual_links_slot	*slots;
+
+	/**
+	 * The number of slots in the table; always a power of two.
+	 */
+
+	size_t				size;
+
+	/**
+	 * The number of slots which are in use.
+	 */
+
+	size_t				count;
+
+	/**
+	 * Lock protecting the table, when links are requested from more
+	 * than one thread.
+	 */
+
+	pthread_mutex_t			lock;
+};
+
+/* Static Function Prototypes. */
+
+static struct manual_links_slot *manual_links_find_slot(struct manual_links *links, struct manual_data *source, struct manual_data *target);
+static bool manual_links_grow_table(struct manual_links *links);
+static char *manual_links_calculate(struct manual_links *links, struct manual_data *source, struct manual_data *target);
+static struct filename *manual_links_get_filename(struct manual_links *links, struct manual_data *node);
+
+/**
+ * Create a new relative link cache for an output.
+ *
+ * \param *root		The default root filename for the output.
+ * \param type		The output type for which links are required.
+ * \param platform	The platform for which links are formatted.
+ * \return		Pointer to the new cache, or NULL on failure.
+ */
+
+struct manual_links *manual_links_create(struct filename *root, enum modes_type type, enum filename_platform platform)
+{
+	struct manual_links *links;
+
+	links = malloc(sizeof(struct manual_links));
+	if (links == NULL)
+		return NULL;
+
+	links->slots = calloc(MANUAL_LINKS_INITIAL_SIZE, sizeof(struct manual_links_slot));
+	if (links->slots == NULL) {
+		free(links);
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&(links->lock), NULL) != 0) {
+		free(links->slots);
+		free(links);
+		return NULL;
+	}
+
+	links->root = root;
+	links->type = type;
+	links->platform = platform;
+	links->size = MANUAL_LINKS_INITIAL_SIZE;
+	links->count = 0;
+
+	return links;
+}
+
+/**
+ * Destroy a relative link cache, freeing all of the links held in it.
+ *
+ * \param *links	Pointer to the cache to destroy.
+ */
+
+void manual_links_destroy(struct manual_links *links)
+{
+	size_t i;
+
+	if (links == NULL)
+		return;
+
+	for (i = 0; i < links->size; i++)
+		free(links->slots[i].link);
+
+	pthread_mutex_destroy(&(links->lock));
+
+	free(links->slots);
+	free(links);
+}
+
+/**
+ * Return the relative link from the file holding one node to the file
+ * holding another, calculating it on the first request.
+ *
+ * \param *links	Pointer to the cache to use.
+ * \param *source	The node to be the source of the link.
+ * \param *target	The node to be the target of the link.
+ * \return		Pointer to the link, which remains owned by the
+ *			cache, or NULL on failure.
+ */
+
+char *manual_links_get_relative(struct manual_links *links, struct manual_data *source, struct manual_data *target)
+{
+	struct manual_links_slot	*slot;
+	char				*link;
+
+	if (links == NULL || source == NULL || target == NULL)
+		return NULL;
+
+	/* All of the nodes in a file share a filename, so cache the links
+	 * against the nodes which own the files.
+	 */
+
+	source = manual_data_get_file_node(source, links->type);
+	target = manual_data_get_file_node(target, links->type);
+
+	pthread_mutex_lock(&(links->lock));
+
+	slot = manual_links_find_slot(links, source, target);
+	if (slot->link != NULL) {
+		link = slot->link;
+		pthread_mutex_unlock(&(links->lock));
+		return link;
+	}
+
+	/* Make sure that there's room before calculating the link. */
+
+	if ((links->count + 1) * MANUAL_LINKS_LOAD_DIVISOR > links->size * MANUAL_LINKS_LOAD_LIMIT) {
+		if (!manual_links_grow_table(links)) {
+			pthread_mutex_unlock(&(links->lock));
+			return NULL;
+		}
+
+		slot = manual_links_find_slot(links, source, target);
+	}
+
+	slot->link = manual_links_calculate(links, source, target);
+	if (slot->link == NULL) {
+		pthread_mutex_unlock(&(links->lock));
+		return NULL;
+	}
+
+	slot->source = source;
+	slot->target = target;
+	links->count++;
+
+	link = slot->link;
+
+	pthread_mutex_unlock(&(links->lock));
+
+	return link;
+}
+
+/**
+ * Find the slot holding the link between two file nodes, or the free
+ * slot where it should be placed.
+ *
+ * \param *links	Pointer to the cache to search.
+ * \param *source	The node owning the source file.
+ * \param *target	The node owning the target file.
+ * \return		Pointer to the slot.
+ */
+
+static struct manual_links_slot *manual_links_find_slot(struct manual_links *links, struct manual_data *source, struct manual_data *target)
+{
+	uint64_t	hash;
+	size_t		slot;
+
+	hash = string_hash(&source, sizeof(struct manual_data *), STRING_HASH_INITIAL);
+	hash = string_hash(&target, sizeof(struct manual_data *), hash);
+
+	slot = hash & (links->size - 1);
+
+	while (links->slots[slot].link != NULL &&
+			(links->slots[slot].source != source || links->slots[slot].target != target))
+		slot = (slot + 1) & (links->size - 1);
+
+	return links->slots + slot;
+}
+
+/**
+ * Double the size of a cache's table, rehashing its contents.
+ *
+ * \param *links	Pointer to the cache to grow.
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_links_grow_table(struct manual_links *links)
+{
+	struct manual_links_slot	*old_slots, *slot;
+	size_t				old_size, i;
+
+	old_slots = links->slots;
+	old_size = links->size;
+
+	links->slots = calloc(old_size * 2, sizeof(struct manual_links_slot));
+	if (links->slots == NULL) {
+		links->slots = old_slots;
+		return false;
+	}
+
+	links->size = old_size * 2;
+
+	for (i = 0; i < old_size; i++) {
+		if (old_slots[i].link == NULL)
+			continue;
+
+		slot = manual_links_find_slot(links, old_slots[i].source, old_slots[i].target);
+		*slot = old_slots[i];
+	}
+
+	free(old_slots);
+
+	return true;
+}
+
+/**
+ * Calculate the relative link between the files owned by two nodes.
+ *
+ * \param *links	Pointer to the cache in use.
+ * \param *source	The node owning the source file.
+ * \param *target	The node owning the target file.
+ * \return		Pointer to the link, in a malloc() block, or NULL.
+ */
+
+static char *manual_links_calculate(struct manual_links *links, struct manual_data *source, struct manual_data *target)
+{
+	struct filename *sourcename = NULL, *targetname = NULL, *filename = NULL;
+	char *link = NULL;
+
+	sourcename = manual_links_get_filename(links, source);
+	if (sourcename == NULL)
+		return NULL;
+
+	targetname = manual_links_get_filename(links, target);
+	if (targetname == NULL) {
+		filename_destroy(sourcename);
+		return NULL;
+	}
+
+	filename = filename_get_relative(sourcename, targetname);
+	filename_destroy(sourcename);
+	filename_destroy(targetname);
+	if (filename == NULL)
+		return NULL;
+
+	link = filename_convert(filename, links->platform, 0);
+	filename_destroy(filename);
+
+	return link;
+}
+
+/**
+ * Return the filename of the file owned by a node.
+ *
+ * \param *links	Pointer to the cache in use.
+ * \param *node		The node owning the file, or NULL for the root file.
+ * \return		Pointer to the filename, or NULL on failure.
+ */
+
+static struct filename *manual_links_get_filename(struct manual_links *links, struct manual_data *node)
+{
+	if (node != NULL)
+		return manual_data_get_node_filename(node, links->root, links->type);
+
+	if (links->root != NULL)
+		return filename_up(links->root, 0);
+
+	return filename_make(NULL, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_NONE);
+}
@@ -0,0 +1,78 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_links.h
+ *
+ * Relative Link Cache Interface.
+ *
+ * The cache holds the relative links between the files of an output,
+ * so that each is calculated once, however many references use it.
+ */
+
+#ifndef XMLMAN_MANUAL_LINKS_H
+#define XMLMAN_MANUAL_LINKS_H
+
+#include "filename.h"
+#include "manual_data.h"
+#include "modes.h"
+
+/**
+ * A relative link cache instance.
+ */
+
+struct manual_links;
+
+/**
+ * Create a new relative link cache for an output.
+ *
+ * \param *root		The default root filename for the output.
+ * \param type		The output type for which links are required.
+ * \param platform	The platform for which links are formatted.
+ * \return		Pointer to the new cache, or NULL on failure.
+ */
+
+struct manual_links *manual_links_create(struct filename *root, enum modes_type type, enum filename_platform platform);
+
+/**
+ * Destroy a relative link cache, freeing all of the links held in it.
+ *
+ * \param *links	Pointer to the cache to destroy.
+ */
+
+void manual_links_destroy(struct manual_links *links);
+
+/**
+ * Return the relative link from the file holding one node to the file
+ * holding another, calculating it on the first request.
+ *
+ * \param *links	Pointer to the cache to use.
+ * \param *source	The node to be the source of the link.
+ * \param *target	The node to be the target of the link.
+ * \return		Pointer to the link, which remains owned by the
+ *			cache, or NULL on failure.
+ */
+
+char *manual_links_get_relative(struct manual_links *links, struct manual_data *source, struct manual_data *target);
+
+#endif
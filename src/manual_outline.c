@@ -0,0 +1,524 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_outline.c
+ *
+ * Manual Outline, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "manual_outline.h"
+
+#include "xmlman.h"
+#include "manual_data.h"
+#include "manual_ids.h"
+#include "msg.h"
+
+/**
+ * The number of reference pointers to allocate at a time.
+ */
+
+#define MANUAL_OUTLINE_REFERENCE_BLOCK 64
+
+/**
+ * A node being outlined, which might own the files of its descendents.
+ */
+
+struct manual_outline_owner {
+	struct manual_data		*original;	/**< The original node.					*/
+	struct manual_data		*copy;		/**< The outline copy of the node.			*/
+	struct manual_outline_owner	*parent;	/**< The owner of the parent node, or NULL.		*/
+};
+
+/**
+ * A list of outline nodes being built up beneath a parent.
+ */
+
+struct manual_outline_list {
+	struct manual_data		*parent;	/**< The parent of the nodes in the list.		*/
+	struct manual_data		*first;		/**< The first node in the list, or NULL.		*/
+	struct manual_data		*last;		/**< The last node in the list, or NULL.		*/
+};
+
+/* Static Global Variables. */
+
+/**
+ * The references within the outline titles, which must be resolved
+ * again each time a node is outlined, as their targets are moved.
+ */
+
+static struct manual_data **manual_outline_references = NULL;
+
+/**
+ * The number of references within the outline titles.
+ */
+
+static size_t manual_outline_reference_count = 0;
+
+/**
+ * The number of references for which there is space allocated.
+ */
+
+static size_t manual_outline_reference_size = 0;
+
+/* Static Function Prototypes. */
+
+static bool manual_outline_copy_children(struct manual_data *node, struct manual_outline_list *list, struct manual_outline_owner *owner);
+static struct manual_data *manual_outline_copy_node(struct manual_data *node, struct manual_data *parent, struct manual_outline_owner *owner);
+static struct manual_data *manual_outline_copy_text_nodes(struct manual_data *node, struct manual_data *parent);
+static struct manual_data_annotations *manual_outline_copy_annotations(struct manual_data_annotations *annotations, struct manual_outline_owner *owner);
+static struct manual_data *manual_outline_find_owner(struct manual_outline_owner *owner, struct manual_data *node);
+static bool manual_outline_add_reference(struct manual_data *reference);
+static char *manual_outline_copy_text(char *text, bool *success);
+
+/**
+ * Initialise the outline module, ready for a new document.
+ */
+
+void manual_outline_initialise(void)
+{
+	manual_outline_close();
+}
+
+/**
+ * Replace the contents of a top-level node with an outline allocated
+ * from the current arena, pointing the ID index at the copies, so that
+ * the arena which held the original contents can be released.
+ *
+ * \param *node		The top-level node to be outlined.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_outline_replace(struct manual_data *node)
+{
+	struct manual_outline_owner	owner;
+	struct manual_outline_list	list;
+	struct manual_data		*title;
+	struct manual_data_annotations	*annotations;
+	char				*id;
+	bool				success = true;
+	size_t				i;
+
+	if (node == NULL)
+		return false;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		break;
+	default:
+		return false;
+	}
+
+	/* The top-level node stays where it is, so it is its own copy. */
+
+	owner.original = node;
+	owner.copy = node;
+	owner.parent = NULL;
+
+	list.parent = node;
+	list.first = NULL;
+	list.last = NULL;
+
+	title = manual_outline_copy_text_nodes(node->title, node);
+	if (node->title != NULL && title == NULL)
+		return false;
+
+	annotations = manual_outline_copy_annotations(node->annotations, &owner);
+	if (node->annotations != NULL && annotations == NULL)
+		return false;
+
+	id = manual_outline_copy_text(node->chapter.id, &success);
+
+	if (!success || !manual_outline_copy_children(node->first_child, &list, &owner))
+		return false;
+
+	/* Swap the outline in for the original contents. */
+
+	node->title = title;
+	node->annotations = annotations;
+	node->first_child = list.first;
+	node->chapter.id = id;
+	node->chapter.resources = NULL;
+
+	if (id != NULL)
+		manual_ids_update_node(node, node);
+
+	/* Some of the targets of the references in the outline titles may
+	 * have just been moved, so look them all up again.
+	 */
+
+	for (i = 0; i < manual_outline_reference_count; i++)
+		manual_outline_references[i]->chunk.target = manual_ids_peek_node(manual_outline_references[i]);
+
+	return true;
+}
+
+/**
+ * Release the memory used by the outline module, once the document
+ * has been written out.
+ */
+
+void manual_outline_close(void)
+{
+	free(manual_outline_references);
+
+	manual_outline_references = NULL;
+	manual_outline_reference_count = 0;
+	manual_outline_reference_size = 0;
+}
+
+/**
+ * Add outline copies of any chapters, sections and targets with IDs
+ * found in a chain of nodes and their descendents to a list. Other
+ * nodes are dropped, with any targets within them being added to the
+ * list in their place.
+ *
+ * \param *node		The first node in the chain to be outlined.
+ * \param *list		The list to add the copies to.
+ * \param *owner	The owner of the list's parent node.
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_outline_copy_children(struct manual_data *node, struct manual_outline_list *list, struct manual_outline_owner *owner)
+{
+	struct manual_outline_owner	child_owner;
+	struct manual_outline_list	child_list;
+	struct manual_data		*copy;
+	bool				keep;
+
+	while (node != NULL) {
+		switch (node->type) {
+		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		case MANUAL_DATA_OBJECT_TYPE_SECTION:
+			keep = true;
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+		case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+			keep = (node->chapter.id != NULL) ? true : false;
+			break;
+
+		default:
+			keep = false;
+			break;
+		}
+
+		if (keep) {
+			copy = manual_outline_copy_node(node, list->parent, owner);
+			if (copy == NULL)
+				return false;
+
+			copy->previous = list->last;
+
+			if (list->last != NULL)
+				list->last->next = copy;
+			else
+				list->first = copy;
+
+			list->last = copy;
+		}
+
+		/* Chapters and sections keep their own outlines; anything
+		 * found within other nodes is added in their place.
+		 */
+
+		if (keep && node->type != MANUAL_DATA_OBJECT_TYPE_TABLE &&
+				node->type != MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK &&
+				node->type != MANUAL_DATA_OBJECT_TYPE_FOOTNOTE) {
+			child_owner.original = node;
+			child_owner.copy = copy;
+			child_owner.parent = owner;
+
+			child_list.parent = copy;
+			child_list.first = NULL;
+			child_list.last = NULL;
+
+			if (!manual_outline_copy_children(node->first_child, &child_list, &child_owner))
+				return false;
+
+			copy->first_child = child_list.first;
+		} else if (!manual_outline_copy_children(node->first_child, list, owner)) {
+			return false;
+		}
+
+		node = node->next;
+	}
+
+	return true;
+}
+
+/**
+ * Make an outline copy of a chapter, section or target, without any
+ * of its children, and index it in place of the original.
+ *
+ * \param *node		The node to be copied.
+ * \param *parent	The parent for the copy.
+ * \param *owner	The owner of the parent node.
+ * \return		Pointer to the copy, or NULL on failure.
+ */
+
+static struct manual_data *manual_outline_copy_node(struct manual_data *node, struct manual_data *parent, struct manual_outline_owner *owner)
+{
+	struct manual_outline_owner	self;
+	struct manual_data		*copy;
+	bool				success = true;
+
+	copy = manual_data_create(node->type);
+	if (copy == NULL)
+		return NULL;
+
+	copy->index = node->index;
+	copy->parent = parent;
+
+	copy->title = manual_outline_copy_text_nodes(node->title, copy);
+	if (node->title != NULL && copy->title == NULL)
+		return NULL;
+
+	/* The node may own its own files, so it is included in the
+	 * chain of owners when its annotations are copied.
+	 */
+
+	self.original = node;
+	self.copy = copy;
+	self.parent = owner;
+
+	copy->annotations = manual_outline_copy_annotations(node->annotations, &self);
+	if (node->annotations != NULL && copy->annotations == NULL)
+		return NULL;
+
+	copy->chapter.id = manual_outline_copy_text(node->chapter.id, &success);
+	if (!success)
+		return NULL;
+
+	if (node->type == MANUAL_DATA_OBJECT_TYPE_CHAPTER || node->type == MANUAL_DATA_OBJECT_TYPE_INDEX)
+		copy->processed = node->processed;
+
+	if (copy->chapter.id != NULL)
+		manual_ids_update_node(node, copy);
+
+	return copy;
+}
+
+/**
+ * Copy a chain of text nodes, such as a title, along with their children.
+ *
+ * \param *node		The first node in the chain to be copied.
+ * \param *parent	The parent for the copies.
+ * \return		Pointer to the first copy, or NULL on failure or
+ *			if there was nothing to copy.
+ */
+
+static struct manual_data *manual_outline_copy_text_nodes(struct manual_data *node, struct manual_data *parent)
+{
+	struct manual_data	*first = NULL, *last = NULL, *copy;
+	bool			success = true;
+
+	while (node != NULL) {
+		copy = manual_data_create(node->type);
+		if (copy == NULL)
+			return NULL;
+
+		copy->index = node->index;
+		copy->parent = parent;
+		copy->previous = last;
+
+		switch (node->type) {
+		case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+			copy->flags = node->flags;
+			copy->chunk.entity = node->chunk.entity;
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+			copy->flags = node->flags;
+			copy->chunk.id = manual_outline_copy_text(node->chunk.id, &success);
+
+			if (!success || !manual_outline_add_reference(copy))
+				return NULL;
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_LINK:
+			copy->flags = node->flags;
+			copy->chunk.link = manual_outline_copy_text_nodes(node->chunk.link, copy);
+
+			if (node->chunk.link != NULL && copy->chunk.link == NULL)
+				return NULL;
+			break;
+
+		case MANUAL_DATA_OBJECT_TYPE_TEXT:
+			copy->flags = node->flags;
+			copy->chunk.text = manual_outline_copy_text(node->chunk.text, &success);
+
+			if (!success)
+				return NULL;
+			break;
+
+		default:
+			copy->flags = node->flags;
+			break;
+		}
+
+		copy->first_child = manual_outline_copy_text_nodes(node->first_child, copy);
+		if (node->first_child != NULL && copy->first_child == NULL)
+			return NULL;
+
+		if (last != NULL)
+			last->next = copy;
+		else
+			first = copy;
+
+		last = copy;
+		node = node->next;
+	}
+
+	return first;
+}
+
+/**
+ * Copy a node's annotations, pointing any file owners which have been
+ * outlined at their copies.
+ *
+ * \param *annotations	The annotations to copy, or NULL.
+ * \param *owner	The owner details for the node being copied.
+ * \return		Pointer to the copy, or NULL on failure or if there
+ *			was nothing to copy.
+ */
+
+static struct manual_data_annotations *manual_outline_copy_annotations(struct manual_data_annotations *annotations, struct manual_outline_owner *owner)
+{
+	struct manual_data_annotations	*copy;
+	bool				success = true;
+	int				type;
+
+	if (annotations == NULL)
+		return NULL;
+
+	copy = manual_data_alloc(sizeof(struct manual_data_annotations));
+	if (copy == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	/* File, folder and stylesheet owners are always the node itself or
+	 * one of its parents; those above the top-level node haven't moved.
+	 */
+
+	for (type = 0; type < MODES_TYPE_COUNT; type++) {
+		copy->file[type] = manual_outline_find_owner(owner, annotations->file[type]);
+		copy->folder[type] = manual_outline_find_owner(owner, annotations->folder[type]);
+		copy->stylesheet[type] = manual_outline_find_owner(owner, annotations->stylesheet[type]);
+		copy->split[type] = annotations->split[type];
+	}
+
+	copy->number = manual_outline_copy_text(annotations->number, &success);
+	copy->named_number = manual_outline_copy_text(annotations->named_number, &success);
+
+	return (success) ? copy : NULL;
+}
+
+/**
+ * Find the copy of an owner node, if it has been outlined.
+ *
+ * \param *owner	The owner details for the node being copied.
+ * \param *node		The owner node to find the copy of, or NULL.
+ * \return		Pointer to the copy, or the original node if it
+ *			hasn't been copied.
+ */
+
+static struct manual_data *manual_outline_find_owner(struct manual_outline_owner *owner, struct manual_data *node)
+{
+	struct manual_outline_owner *search;
+
+	for (search = owner; search != NULL && node != NULL; search = search->parent) {
+		if (search->original == node)
+			return search->copy;
+	}
+
+	return node;
+}
+
+/**
+ * Record a reference within an outline title, so that its target can
+ * be looked up again as nodes are outlined.
+ *
+ * \param *reference	The reference to record.
+ * \return		True if successful; False on failure.
+ */
+
+static bool manual_outline_add_reference(struct manual_data *reference)
+{
+	struct manual_data **references;
+
+	if (manual_outline_reference_count >= manual_outline_reference_size) {
+		references = realloc(manual_outline_references,
+				(manual_outline_reference_size + MANUAL_OUTLINE_REFERENCE_BLOCK) * sizeof(struct manual_data *));
+		if (references == NULL) {
+			msg_report(MSG_DATA_MALLOC_FAIL);
+			return false;
+		}
+
+		manual_outline_references = references;
+		manual_outline_reference_size += MANUAL_OUTLINE_REFERENCE_BLOCK;
+	}
+
+	manual_outline_references[manual_outline_reference_count++] = reference;
+
+	return true;
+}
+
+/**
+ * Copy a string into the current arena.
+ *
+ * \param *text		The string to copy, or NULL.
+ * \param *success	Pointer to a flag to clear on failure.
+ * \return		Pointer to the copy, or NULL.
+ */
+
+static char *manual_outline_copy_text(char *text, bool *success)
+{
+	char	*copy;
+	size_t	length;
+
+	if (text == NULL)
+		return NULL;
+
+	length = strlen(text) + 1;
+
+	copy = manual_data_alloc(length);
+	if (copy == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		*success = false;
+		return NULL;
+	}
+
+	memcpy(copy, text, length);
+
+	return copy;
+}
@@ -0,0 +1,67 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file manual_outline.h
+ *
+ * Manual Outline Interface.
+ *
+ * When a document is written out while it is being parsed, each top-level
+ * node can be discarded once it has been written. An outline of the node
+ * is kept in its place, holding just the chapters, sections and targets
+ * with IDs, along with their titles and numbers, so that the nodes which
+ * follow can still list and refer to them.
+ */
+
+#ifndef XMLMAN_MANUAL_OUTLINE_H
+#define XMLMAN_MANUAL_OUTLINE_H
+
+#include <stdbool.h>
+
+#include "manual_data.h"
+
+/**
+ * Initialise the outline module, ready for a new document.
+ */
+
+void manual_outline_initialise(void);
+
+/**
+ * Replace the contents of a top-level node with an outline allocated
+ * from the current arena, pointing the ID index at the copies, so that
+ * the arena which held the original contents can be released.
+ *
+ * \param *node		The top-level node to be outlined.
+ * \return		True if successful; False on failure.
+ */
+
+bool manual_outline_replace(struct manual_data *node);
+
+/**
+ * Release the memory used by the outline module, once the document
+ * has been written out.
+ */
+
+void manual_outline_close(void);
+
+#endif
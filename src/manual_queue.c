@@ -30,10 +30,13 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include "xmlman.h"
 #include "manual_data.h"
 #include "manual_ids.h"
+#include "manual_queue.h"
+#include "modes.h"
 
 /**
  * An entry in the node queue.
@@ -52,50 +55,272 @@ struct manual_queue_entry {
 	 */
 
 	struct manual_queue_entry	*next;
+
+	/**
+	 * Pointer to the next entry allocated to the queue, or NULL.
+	 */
+
+	struct manual_queue_entry	*link;
+
+	/**
+	 * Pointer to the first entry added while processing the node, which
+	 * is waiting for earlier nodes to complete, or NULL.
+	 */
+
+	struct manual_queue_entry	*first_child;
+
+	/**
+	 * Pointer to the last entry added while processing the node, which
+	 * is waiting for earlier nodes to complete, or NULL.
+	 */
+
+	struct manual_queue_entry	*last_child;
+
+	/**
+	 * The position in which the node was removed from the queue.
+	 */
+
+	unsigned			position;
+
+	/**
+	 * True if the node has been processed.
+	 */
+
+	bool				complete;
+};
+
+/**
+ * A queue context, holding the node queue for an output job.
+ */
+
+struct manual_queue_context {
+
+	/**
+	 * Pointer to the first entry allocated to the queue.
+	 */
+
+	struct manual_queue_entry	*root;
+
+	/**
+	 * Pointer to the next allocated entry to be reused, or NULL.
+	 */
+
+	struct manual_queue_entry	*spare;
+
+	/**
+	 * Pointer to the last entry in the queue.
+	 */
+
+	struct manual_queue_entry	*head;
+
+	/**
+	 * Pointer to the next queue entry to be read back.
+	 */
+
+	struct manual_queue_entry	*tail;
+
+	/**
+	 * Pointer to the oldest entry in the queue which hasn't been
+	 * processed. Entries added while processing any later nodes are
+	 * held back until this one is complete, so that the queue is in
+	 * the same order however many threads are sharing it.
+	 */
+
+	struct manual_queue_entry	*oldest;
+
+	/**
+	 * Lock protecting the queue, when it is shared between threads.
+	 */
+
+	pthread_mutex_t			lock;
+
+	/**
+	 * Condition signalled when a node is added or completed.
+	 */
+
+	pthread_cond_t			ready;
+
+	/**
+	 * The number of nodes removed from the queue.
+	 */
+
+	unsigned			removed;
+
+	/**
+	 * The number of nodes removed from the queue and not yet completed.
+	 */
+
+	int				active;
+
+	/**
+	 * True if the queue has been abandoned following a failure.
+	 */
+
+	bool				abandoned;
 };
 
 /**
- * Pointer to the queue structure.
+ * The queue context used by threads which haven't selected their own.
  */
 
-static struct manual_queue_entry *manual_queue_root = NULL;
+static struct manual_queue_context manual_queue_default_context = {NULL, NULL, NULL, NULL, NULL,
+		PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, false};
 
 /**
- * Pointer to the first free queue entry.
+ * The key used to hold the queue context selected by each thread.
  */
 
-static struct manual_queue_entry *manual_queue_head = NULL;
+static pthread_key_t manual_queue_context_key;
 
 /**
- * Pointer to the next queue entry to be read back.
+ * The key used to hold the queue entry being processed by each thread.
  */
 
-static struct manual_queue_entry *manual_queue_tail = NULL;
+static pthread_key_t manual_queue_entry_key;
 
+/**
+ * Control for the one-time creation of the context keys.
+ */
+
+static pthread_once_t manual_queue_context_once = PTHREAD_ONCE_INIT;
 
 /**
- * Initialise the queue.
+ * Set to true if the context keys were created successfully.
  */
 
-void manual_queue_initialise(void)
+static bool manual_queue_context_key_valid = false;
+
+/* Static Function Prototypes. */
+
+static void manual_queue_append_entries(struct manual_queue_context *context, struct manual_queue_entry *first, struct manual_queue_entry *last);
+static struct manual_queue_context *manual_queue_find_context(void);
+static struct manual_queue_entry *manual_queue_find_entry(void);
+static void manual_queue_create_context_key(void);
+
+/**
+ * Create a new queue context, for use by a thread via
+ * manual_queue_select_context().
+ *
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct manual_queue_context *manual_queue_create_context(void)
 {
-	struct manual_queue_entry *entry;
+	struct manual_queue_context *context;
+
+	context = malloc(sizeof(struct manual_queue_context));
+	if (context == NULL)
+		return NULL;
+
+	context->root = NULL;
+	context->spare = NULL;
+	context->head = NULL;
+	context->tail = NULL;
+	context->oldest = NULL;
+	context->removed = 0;
+	context->active = 0;
+	context->abandoned = false;
+
+	if (pthread_mutex_init(&(context->lock), NULL) != 0) {
+		free(context);
+		return NULL;
+	}
+
+	if (pthread_cond_init(&(context->ready), NULL) != 0) {
+		pthread_mutex_destroy(&(context->lock));
+		free(context);
+		return NULL;
+	}
+
+	return context;
+}
+
+/**
+ * Destroy a queue context, freeing any queue entries which it holds. The
+ * context must not be selected by any thread at the time.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
 
-	manual_queue_head = manual_queue_root;
-	manual_queue_tail = NULL;
+void manual_queue_destroy_context(struct manual_queue_context *context)
+{
+	struct manual_queue_entry *entry, *next;
 
-	/* Clear out the node details. */
+	if (context == NULL)
+		return;
 
-	entry = manual_queue_root;
+	entry = context->root;
 
 	while (entry != NULL) {
-		entry->node = NULL;
-		entry = entry->next;
+		next = entry->link;
+		free(entry);
+		entry = next;
 	}
+
+	pthread_cond_destroy(&(context->ready));
+	pthread_mutex_destroy(&(context->lock));
+
+	free(context);
 }
 
 /**
- * Add a node to the queue for later processing.
+ * Select a queue context for the calling thread, so that the queue
+ * used by the thread is independent of any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool manual_queue_select_context(struct manual_queue_context *context)
+{
+	pthread_once(&manual_queue_context_once, manual_queue_create_context_key);
+
+	if (!manual_queue_context_key_valid)
+		return false;
+
+	return (pthread_setspecific(manual_queue_context_key, context) == 0) ? true : false;
+}
+
+/**
+ * Return the queue context selected by the calling thread, so that it can
+ * be selected by other threads which are to share the same queue.
+ *
+ * \return		Pointer to the thread's queue context.
+ */
+
+struct manual_queue_context *manual_queue_get_context(void)
+{
+	return manual_queue_find_context();
+}
+
+/**
+ * Initialise the queue.
+ */
+
+void manual_queue_initialise(void)
+{
+	struct manual_queue_context	*context = manual_queue_find_context();
+
+	pthread_once(&manual_queue_context_once, manual_queue_create_context_key);
+
+	pthread_mutex_lock(&(context->lock));
+
+	context->spare = context->root;
+	context->head = NULL;
+	context->tail = NULL;
+	context->oldest = NULL;
+	context->removed = 0;
+	context->active = 0;
+	context->abandoned = false;
+
+	pthread_mutex_unlock(&(context->lock));
+}
+
+/**
+ * Add a node to the queue for later processing. If the calling thread is
+ * processing a node which isn't the oldest in the queue, the new node is
+ * held back until all of the older nodes are complete.
  * 
  * \param *node		Pointer to the node to be added.
  * \return		True if successful; otherwise false.
@@ -103,53 +328,258 @@ void manual_queue_initialise(void)
 
 bool manual_queue_add_node(struct manual_data *node)
 {
-	struct manual_queue_entry *entry = NULL;
+	struct manual_queue_context	*context = manual_queue_find_context();
+	struct manual_queue_entry	*entry = NULL, *parent = manual_queue_find_entry();
+
+	pthread_mutex_lock(&(context->lock));
 
 	/* Make sure that there's an entry to use. */
 
-	if (manual_queue_head == NULL || manual_queue_head->next == NULL) {
+	if (context->spare != NULL) {
+		entry = context->spare;
+		context->spare = entry->link;
+	} else {
 		entry = malloc(sizeof(struct manual_queue_entry));
-		if (entry == NULL)
+		if (entry == NULL) {
+			pthread_mutex_unlock(&(context->lock));
 			return false;
+		}
 
-		entry->node = NULL;
-		entry->next = NULL;
+		entry->link = context->root;
+		context->root = entry;
+	}
 
-		if (manual_queue_head != NULL) {
-			manual_queue_head->next = entry;
-			manual_queue_head = entry;
-		} else {
-			manual_queue_root = entry;
-			manual_queue_head = entry;
-		}
+	entry->node = node;
+	entry->next = NULL;
+	entry->first_child = NULL;
+	entry->last_child = NULL;
+	entry->position = 0;
+	entry->complete = false;
+
+	if (parent != NULL && parent != context->oldest) {
+		if (parent->last_child != NULL)
+			parent->last_child->next = entry;
+		else
+			parent->first_child = entry;
+
+		parent->last_child = entry;
 	} else {
-		manual_queue_head = manual_queue_head->next;
-		entry = manual_queue_head;
+		manual_queue_append_entries(context, entry, entry);
 	}
 
-	entry->node = node;
+	pthread_cond_signal(&(context->ready));
+	pthread_mutex_unlock(&(context->lock));
+
+	return true;
+}
 
-	if (manual_queue_tail == NULL)
-		manual_queue_tail = entry;
+/**
+ * Add the descendents of a node which are written to files of their own
+ * to the queue, as the output engines would do while writing the node
+ * out. This allows the writing of an up to date file to be skipped
+ * without losing the files which hang off it.
+ *
+ * \param *node		Pointer to the node whose descendents are to be added.
+ * \param type		The output mode being written.
+ * \return		True if successful; otherwise false.
+ */
+
+bool manual_queue_add_file_children(struct manual_data *node, enum modes_type type)
+{
+	struct manual_data	*block;
+	struct manual_data_mode	*resources;
+
+	if (node == NULL)
+		return false;
+
+	for (block = node->first_child; block != NULL; block = block->next) {
+		switch (block->type) {
+		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		case MANUAL_DATA_OBJECT_TYPE_SECTION:
+			if (block->first_child == NULL)
+				break;
+
+			resources = modes_find_resources(block->chapter.resources, type);
+
+			if (resources != NULL && (resources->filename != NULL || resources->folder != NULL)) {
+				if (!manual_queue_add_node(block))
+					return false;
+			} else if (!manual_queue_add_file_children(block, type)) {
+				return false;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
 
 	return true;
 }
 
 /**
- * Remove the next node to be processed from the queue.
+ * Remove the next node to be processed from the queue. If the queue is
+ * empty but other threads sharing it are still processing nodes, wait
+ * to see if they add any more. Every node returned must be passed back
+ * to manual_queue_complete_node() once it has been processed.
  *
  * \return		Pointer to the next node, or NULL if done.
  */
 
 struct manual_data *manual_queue_remove_node(void)
 {
-	struct manual_data *node = NULL;
+	struct manual_queue_context	*context = manual_queue_find_context();
+	struct manual_queue_entry	*entry = NULL;
+
+	pthread_mutex_lock(&(context->lock));
+
+	while (context->tail == NULL && context->active > 0 && !context->abandoned)
+		pthread_cond_wait(&(context->ready), &(context->lock));
+
+	if (context->tail != NULL && !context->abandoned) {
+		entry = context->tail;
+		entry->position = context->removed++;
+		context->tail = entry->next;
+		context->active++;
+	}
+
+	pthread_mutex_unlock(&(context->lock));
+
+	if (manual_queue_context_key_valid)
+		pthread_setspecific(manual_queue_entry_key, entry);
+
+	return (entry != NULL) ? entry->node : NULL;
+}
+
+/**
+ * Return the position in which the node being processed by the calling
+ * thread was removed from the queue. The nodes are always removed in the
+ * same order, however many threads are sharing the queue.
+ *
+ * \return		The position of the node, counting from zero.
+ */
+
+unsigned manual_queue_get_position(void)
+{
+	struct manual_queue_entry *entry = manual_queue_find_entry();
+
+	return (entry != NULL) ? entry->position : 0;
+}
 
-	if (manual_queue_tail == NULL)
+/**
+ * Mark a node returned by manual_queue_remove_node() as processed, waking
+ * any threads which are waiting for more nodes. If processing failed, the
+ * queue is abandoned and no more nodes will be returned from it.
+ *
+ * \param success	True if the node was processed successfully;
+ *			False if processing failed.
+ */
+
+void manual_queue_complete_node(bool success)
+{
+	struct manual_queue_context	*context = manual_queue_find_context();
+	struct manual_queue_entry	*entry = manual_queue_find_entry();
+
+	pthread_mutex_lock(&(context->lock));
+
+	if (context->active > 0)
+		context->active--;
+
+	if (!success)
+		context->abandoned = true;
+
+	/* Release the nodes held back by the nodes which are now the
+	 * oldest, in the order that the nodes themselves were queued.
+	 */
+
+	if (entry != NULL)
+		entry->complete = true;
+
+	while (context->oldest != NULL && context->oldest->complete) {
+		context->oldest = context->oldest->next;
+
+		if (context->oldest != NULL && context->oldest->first_child != NULL) {
+			manual_queue_append_entries(context, context->oldest->first_child, context->oldest->last_child);
+			context->oldest->first_child = NULL;
+			context->oldest->last_child = NULL;
+		}
+	}
+
+	pthread_cond_broadcast(&(context->ready));
+	pthread_mutex_unlock(&(context->lock));
+
+	if (manual_queue_context_key_valid)
+		pthread_setspecific(manual_queue_entry_key, NULL);
+}
+
+/**
+ * Append a chain of entries to the end of the queue. The queue's lock
+ * must be held by the caller.
+ *
+ * \param *context	Pointer to the queue context to append to.
+ * \param *first	Pointer to the first entry in the chain.
+ * \param *last		Pointer to the last entry in the chain.
+ */
+
+static void manual_queue_append_entries(struct manual_queue_context *context, struct manual_queue_entry *first, struct manual_queue_entry *last)
+{
+	if (context->head != NULL)
+		context->head->next = first;
+
+	context->head = last;
+
+	if (context->tail == NULL)
+		context->tail = first;
+
+	if (context->oldest == NULL)
+		context->oldest = first;
+}
+
+/**
+ * Find the queue context for the calling thread.
+ *
+ * \return		Pointer to the thread's queue context.
+ */
+
+static struct manual_queue_context *manual_queue_find_context(void)
+{
+	struct manual_queue_context *context = NULL;
+
+	if (manual_queue_context_key_valid)
+		context = pthread_getspecific(manual_queue_context_key);
+
+	return (context != NULL) ? context : &manual_queue_default_context;
+}
+
+/**
+ * Find the queue entry being processed by the calling thread.
+ *
+ * \return		Pointer to the thread's queue entry, or NULL.
+ */
+
+static struct manual_queue_entry *manual_queue_find_entry(void)
+{
+	if (!manual_queue_context_key_valid)
 		return NULL;
 
-	node = manual_queue_tail->node;
-	manual_queue_tail = manual_queue_tail->next;
+	return pthread_getspecific(manual_queue_entry_key);
+}
+
+/**
+ * Create the keys used to hold each thread's queue context and entry, on
+ * behalf of pthread_once().
+ */
+
+static void manual_queue_create_context_key(void)
+{
+	if (pthread_key_create(&manual_queue_context_key, NULL) != 0)
+		return;
+
+	if (pthread_key_create(&manual_queue_entry_key, NULL) != 0) {
+		pthread_key_delete(manual_queue_context_key);
+		return;
+	}
 
-	return node;
+	manual_queue_context_key_valid = true;
 }
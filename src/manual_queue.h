@@ -32,7 +32,51 @@
 
 #include <stdbool.h>
 
-#include "manual_queue.h"
+#include "manual_data.h"
+
+/**
+ * A queue context, holding the node queue for an output job.
+ */
+
+struct manual_queue_context;
+
+/**
+ * Create a new queue context, for use by a thread via
+ * manual_queue_select_context().
+ *
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct manual_queue_context *manual_queue_create_context(void);
+
+/**
+ * Destroy a queue context, freeing any queue entries which it holds. The
+ * context must not be selected by any thread at the time.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
+
+void manual_queue_destroy_context(struct manual_queue_context *context);
+
+/**
+ * Select a queue context for the calling thread, so that the queue
+ * used by the thread is independent of any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool manual_queue_select_context(struct manual_queue_context *context);
+
+/**
+ * Return the queue context selected by the calling thread, so that it can
+ * be selected by other threads which are to share the same queue.
+ *
+ * \return		Pointer to the thread's queue context.
+ */
+
+struct manual_queue_context *manual_queue_get_context(void);
 
 /**
  * Initialise the queue.
@@ -41,7 +85,9 @@
 void manual_queue_initialise(void);
 
 /**
- * Add a node to the queue for later processing.
+ * Add a node to the queue for later processing. If the calling thread is
+ * processing a node which isn't the oldest in the queue, the new node is
+ * held back until all of the older nodes are complete.
  * 
  * \param *node		Pointer to the node to be added.
  * \return		True if successful; otherwise false.
@@ -50,12 +96,47 @@ void manual_queue_initialise(void);
 bool manual_queue_add_node(struct manual_data *node);
 
 /**
- * Remove the next node to be processed from the queue.
+ * Add the descendents of a node which are written to files of their own
+ * to the queue, without writing the node itself out.
+ *
+ * \param *node		Pointer to the node whose descendents are to be added.
+ * \param type		The output mode being written.
+ * \return		True if successful; otherwise false.
+ */
+
+bool manual_queue_add_file_children(struct manual_data *node, enum modes_type type);
+
+/**
+ * Remove the next node to be processed from the queue. If the queue is
+ * empty but other threads sharing it are still processing nodes, wait
+ * to see if they add any more. Every node returned must be passed back
+ * to manual_queue_complete_node() once it has been processed.
  *
  * \return		Pointer to the next node, or NULL if done.
  */
 
 struct manual_data *manual_queue_remove_node(void);
 
+/**
+ * Return the position in which the node being processed by the calling
+ * thread was removed from the queue. The nodes are always removed in the
+ * same order, however many threads are sharing the queue.
+ *
+ * \return		The position of the node, counting from zero.
+ */
+
+unsigned manual_queue_get_position(void);
+
+/**
+ * Mark a node returned by manual_queue_remove_node() as processed, waking
+ * any threads which are waiting for more nodes. If processing failed, the
+ * queue is abandoned and no more nodes will be returned from it.
+ *
+ * \param success	True if the node was processed successfully;
+ *			False if processing failed.
+ */
+
+void manual_queue_complete_node(bool success);
+
 #endif
 
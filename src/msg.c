@@ -33,6 +33,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <pthread.h>
 
 /* Local source headers. */
 
@@ -51,15 +53,11 @@
 #define MSG_MAX_MESSAGE 256
 
 /**
- * Message level definitions.
+ * The maximum length allowed for a message, once formatted for output
+ * with its level and location.
  */
 
-enum msg_level {
-	MSG_VERBOSE,			/**< A Verbose informational message.				*/
-	MSG_INFO,			/**< An informational message.					*/
-	MSG_WARNING,			/**< A warning message.						*/
-	MSG_ERROR			/**< An error message (sets the 'error reported' flag).		*/
-};
+#define MSG_MAX_OUTPUT (MSG_MAX_MESSAGE + MSG_MAX_LOCATION_TEXT + 64)
 
 /**
  * Message definitions.
@@ -105,9 +103,8 @@ static struct msg_data msg_messages[] = {
 	{MSG_ERROR,	"Tag name <%s... too long.",					true},
 	{MSG_ERROR,	"<%s> tag is opening and closing in one.",			true},
 	{MSG_ERROR,	"Found %c instead of closing > in <%s... tag.",			true},
-	{MSG_ERROR,	"Attribute name %s... too long.",				true},
 	{MSG_ERROR,	"Unterminated attribute value for %s.",				true},
-	{MSG_ERROR,	"Too many attributes.",						true},
+	{MSG_ERROR,	"No memory for attributes.",					true},
 	{MSG_ERROR,	"Unterminated comment.",					true},
 
 	{MSG_VERBOSE,	"Push %s Object (%s).",						false},
@@ -124,7 +121,7 @@ static struct msg_data msg_messages[] = {
 	{MSG_VERBOSE,	"Parsed Entity: &%s;.",						false},
 
 	{MSG_VERBOSE,	"Dumping index table",						false},
-	{MSG_VERBOSE,	"Hash entry %d starting at 0x%x",				false},
+	{MSG_VERBOSE,	"Hash slot %d with hash 0x%08x",				false},
 	{MSG_VERBOSE,	"- Entry for '%s'",						false},
 	{MSG_ERROR,	"Reserved message ID '%s'",					false},
 	{MSG_ERROR,	"Failed to store duplicate ID '%s'",				false},
@@ -160,8 +157,8 @@ static struct msg_data msg_messages[] = {
 
 	{MSG_ERROR,	"Unknown element '<%s>'",					true},
 	{MSG_ERROR,	"Element definitions out of sequence.",				false},
+	{MSG_ERROR,	"Failed to build element lookup table.",			false},
 	{MSG_ERROR,	"Unknown entity '&%s;'",					true},
-	{MSG_ERROR,	"Entity definitions out of sequence.",				false},
 	{MSG_ERROR,	"Failed to allocate new manual data node",			false},
 
 	{MSG_ERROR,	"Failed to allocate new search tree node",			false},
@@ -204,13 +201,48 @@ static struct msg_data msg_messages[] = {
 	{MSG_ERROR,	"Failed to create new object node block",			false},
 	{MSG_ERROR,	"No active StrongHelp file block",				false},
 	{MSG_ERROR,	"A '%s' object already exists in the '%s' directory",		false},
+	{MSG_ERROR,	"StrongHelp file is too large for its 32-bit offsets",		false},
 
 	{MSG_ERROR,	"Failed to allocate memory for root output filename",		false},
 	{MSG_ERROR,	"Writing output file failed with an error",			false},
+	{MSG_ERROR,	"Output split across multiple files can't be sent to stdout",	false},
+
+	{MSG_INFO,	"Output file '%s' is up to date",				false},
+	{MSG_WARNING,	"Out of memory building incremental manifest",			false},
+	{MSG_WARNING,	"Failed to write incremental manifest '%s'",			false},
+	{MSG_ERROR,	"Out of memory creating link cache",				false},
+	{MSG_ERROR,	"Out of memory creating contents list cache",			false},
+	{MSG_ERROR,	"Out of memory building search index",				false},
+
+	{MSG_WARNING,	"Out of memory recording build statistics",			false},
+	{MSG_WARNING,	"Failed to write build statistics to '%s'",			false},
+
+	{MSG_INFO,	"Loaded document from cache '%s'",				false},
+	{MSG_INFO,	"Cache '%s' is out of date",					false},
+	{MSG_WARNING,	"File '%s' is not a usable document cache",			false},
+	{MSG_WARNING,	"Out of memory handling document cache",			false},
+	{MSG_WARNING,	"Failed to write document cache '%s'",				false},
+
+	{MSG_ERROR,	"One-pass text output can't be split into separate files",	false},
+
+	{MSG_ERROR,	"No chapter with id '%s' could be found",			false},
+
+	{MSG_ERROR,	"Failed to open batch file '%s'",				false},
+	{MSG_ERROR,	"Line %d of batch file is too long",				false},
+	{MSG_INFO,	"Starting batch job at line %d",				false},
+	{MSG_ERROR,	"Batch job at line %d failed",					false},
+	{MSG_INFO,	"Batch complete: %d of %d jobs succeeded",			false},
+
+	{MSG_INFO,	"File '%s' has changed",					false},
+	{MSG_INFO,	"Waiting for the source files to change",			false},
+
+	{MSG_ERROR,	"Name '%s' is too long to store in an archive",			false},
 
 	{MSG_INFO,	"Opened file '%s' for output",					false},
+	{MSG_INFO,	"Left file '%s' alone, as its content is unchanged",		false},
 	{MSG_ERROR,	"No filename supplied",						false},
 	{MSG_ERROR,	"Failed to open file '%s'",					false},
+	{MSG_ERROR,	"Failed to replace file '%s'",					false},
 	{MSG_ERROR,	"Failed to create folder '%s'",					false},
 	{MSG_ERROR,	"Failed to set type of file '%s'",				false},
 	{MSG_ERROR,	"No file open for output",					false},
@@ -219,29 +251,76 @@ static struct msg_data msg_messages[] = {
 };
 
 /**
- * The current error location message.
+ * A message collected by a context, waiting to be output.
+ */
+
+struct msg_record {
+	struct msg_record	*next;		/**< The next record in the list, or NULL.		*/
+	unsigned		order;		/**< The position of the reporting work in the output.	*/
+	uint64_t		sequence;	/**< The order in which the message was reported.	*/
+	char			*text;		/**< The message, formatted for output.			*/
+};
+
+/**
+ * A message context, holding the location details for a thread.
+ */
+
+struct msg_context {
+	char			location[MSG_MAX_LOCATION_TEXT];	/**< The current error location message.	*/
+	unsigned		line;					/**< The current error line.			*/
+	unsigned		(*line_source)(void *);			/**< Function to find the line, or NULL.	*/
+	void			*line_data;				/**< Data to pass to the line function.		*/
+	bool			collect;				/**< True to collect messages until flushed.	*/
+	unsigned		order;					/**< The order to give collected messages.	*/
+	struct msg_record	*first;					/**< The first collected message, or NULL.	*/
+	struct msg_record	*last;					/**< The last collected message, or NULL.	*/
+	struct msg_context	*parent;				/**< The context to pass messages on to.	*/
+	struct msg_record	*passed;				/**< Messages passed on by other contexts.	*/
+};
+
+/**
+ * The message context used by threads which haven't selected their own.
+ */
+
+static struct msg_context msg_default_context;
+
+/**
+ * The key used to hold the message context selected by each thread.
  */
 
-static char	msg_location[MSG_MAX_LOCATION_TEXT];
+static pthread_key_t msg_context_key;
 
 /**
- * The current error line.
+ * Set to true once the message context key has been created.
  */
 
-static unsigned	msg_line;
+static bool	msg_context_key_valid = false;
 
 /**
- * Set to true if an error is reported.
+ * Set to true if an error is reported. This is only ever set, so it can
+ * be updated atomically by any thread without a lock.
  */
 
 static bool	msg_error_reported = false;
 
+/**
+ * The sequence number to give to the next message reported.
+ */
+
+static uint64_t msg_sequence = 0;
+
 /**
  * Set to true if verbose output is required; otherwise false.
  */
 
 static bool	msg_verbose_output = false;
 
+/* Static Function Prototypes. */
+
+static struct msg_context *msg_find_context(void);
+static bool msg_collect(struct msg_context *context, char *text);
+static int msg_compare_order(const void *a, const void *b);
+
 /**
  * Initialise the message system.
  *
@@ -250,10 +329,145 @@ static bool	msg_verbose_output = false;
 
 void msg_initialise(bool verbose)
 {
-	*msg_location = '\0';
-	msg_line = 0;
-	msg_error_reported = false;
+	struct msg_record *list, *record;
+
+	/* Discard any messages passed on during a previous run which were
+	 * never flushed, so that they can't appear in this one.
+	 */
+
+	list = __atomic_exchange_n(&(msg_default_context.passed), NULL, __ATOMIC_ACQUIRE);
+
+	while (list != NULL) {
+		record = list;
+		list = list->next;
+		free(record);
+	}
+
+	*msg_default_context.location = '\0';
+	msg_default_context.line = 0;
+	msg_default_context.line_source = NULL;
+	msg_default_context.line_data = NULL;
+	msg_default_context.collect = false;
+	msg_default_context.order = 0;
+	msg_default_context.first = NULL;
+	msg_default_context.last = NULL;
+	msg_default_context.parent = NULL;
+	__atomic_store_n(&msg_error_reported, false, __ATOMIC_RELAXED);
 	msg_verbose_output = verbose;
+
+	if (!msg_context_key_valid && pthread_key_create(&msg_context_key, NULL) == 0)
+		msg_context_key_valid = true;
+}
+
+/**
+ * Create a new message context, for use by a thread via
+ * msg_select_context(). Any messages which it collects are passed on to
+ * the context selected by the calling thread when it is destroyed.
+ *
+ * \param collect	True to collect the messages reported in the
+ *			context, so that they can be output together by
+ *			msg_flush() once it has been destroyed; False to
+ *			output them immediately.
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct msg_context *msg_create_context(bool collect)
+{
+	struct msg_context *context;
+
+	context = malloc(sizeof(struct msg_context));
+	if (context == NULL)
+		return NULL;
+
+	*context->location = '\0';
+	context->line = 0;
+	context->line_source = NULL;
+	context->line_data = NULL;
+	context->collect = collect;
+	context->order = 0;
+	context->first = NULL;
+	context->last = NULL;
+	context->parent = msg_find_context();
+	context->passed = NULL;
+
+	return context;
+}
+
+/**
+ * Destroy a message context. The context must not be selected by any
+ * thread at the time. Any messages which it has collected are passed
+ * on to the context which created it, to be output by the next call to
+ * msg_flush() from a thread using that context.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
+
+void msg_destroy_context(struct msg_context *context)
+{
+	if (context == NULL)
+		return;
+
+	/* Push the context's messages on to its parent's list as a single
+	 * chain, retrying if another thread gets in first.
+	 */
+
+	if (context->first != NULL) {
+		context->last->next = __atomic_load_n(&(context->parent->passed), __ATOMIC_RELAXED);
+
+		while (!__atomic_compare_exchange_n(&(context->parent->passed), &(context->last->next), context->first,
+				true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	}
+
+	free(context);
+}
+
+/**
+ * Select a message context for the calling thread, so that locations set
+ * by the thread don't affect messages reported by any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool msg_select_context(struct msg_context *context)
+{
+	if (!msg_context_key_valid)
+		return false;
+
+	return (pthread_setspecific(msg_context_key, context) == 0) ? true : false;
+}
+
+/**
+ * Return the message context selected by the calling thread, so that it
+ * can be selected again after another has been used for a while.
+ *
+ * \return		Pointer to the thread's context, or NULL if it
+ *			is using the default context.
+ */
+
+struct msg_context *msg_get_context(void)
+{
+	if (!msg_context_key_valid)
+		return NULL;
+
+	return pthread_getspecific(msg_context_key);
+}
+
+/**
+ * Find the message context for the calling thread.
+ *
+ * \return		Pointer to the thread's message context.
+ */
+
+static struct msg_context *msg_find_context(void)
+{
+	struct msg_context *context = NULL;
+
+	if (msg_context_key_valid)
+		context = pthread_getspecific(msg_context_key);
+
+	return (context != NULL) ? context : &msg_default_context;
 }
 
 /**
@@ -265,8 +479,10 @@ void msg_initialise(bool verbose)
 
 void msg_set_location(char *file)
 {
-	strncpy(msg_location, (file != NULL) ? file : "", MSG_MAX_LOCATION_TEXT);
-	msg_location[MSG_MAX_LOCATION_TEXT - 1] = '\0';
+	struct msg_context *context = msg_find_context();
+
+	strncpy(context->location, (file != NULL) ? file : "", MSG_MAX_LOCATION_TEXT);
+	context->location[MSG_MAX_LOCATION_TEXT - 1] = '\0';
 }
 
 /**
@@ -279,7 +495,52 @@ void msg_set_location(char *file)
 
 void msg_set_line(unsigned line)
 {
-	msg_line = line;
+	msg_find_context()->line = line;
+}
+
+/**
+ * Set a function to be called to find the current line number, when a
+ * message which shows its location is reported. This allows the line
+ * to be found only when it is needed, instead of being tracked as the
+ * source is read.
+ *
+ * \param *source	The function to call to find the line, or NULL to
+ *			return to the line set by msg_set_line().
+ * \param *data		Data to pass to the function.
+ */
+
+void msg_set_line_source(unsigned (*source)(void *), void *data)
+{
+	struct msg_context *context = msg_find_context();
+
+	context->line_source = source;
+	context->line_data = data;
+}
+
+/**
+ * Set the position in the output of the work being done by the calling
+ * thread, so that the messages which it collects can be output in the
+ * same order as they would be if the work was done in sequence.
+ *
+ * \param order		The position of the work, counting from zero.
+ */
+
+void msg_set_order(unsigned order)
+{
+	msg_find_context()->order = order;
+}
+
+/**
+ * Test whether messages of a given level will be output, so that the
+ * cost of reporting them can be avoided if not.
+ *
+ * \param level		The message level to test.
+ * \return		True if messages of the level are output; else false.
+ */
+
+bool msg_level_enabled(enum msg_level level)
+{
+	return (level != MSG_VERBOSE || msg_verbose_output) ? true : false;
 }
 
 /**
@@ -291,8 +552,10 @@ void msg_set_line(unsigned line)
 
 void msg_report(enum msg_type type, ...)
 {
-	char		message[MSG_MAX_MESSAGE], *level, *start;
-	va_list		ap;
+	char			message[MSG_MAX_MESSAGE], output[MSG_MAX_OUTPUT], *level, *start;
+	va_list			ap;
+	struct msg_context	*context;
+	unsigned		line = 0;
 
 	/* Check that the message code is valid. */
 
@@ -330,7 +593,6 @@ void msg_report(enum msg_type type, ...)
 	case MSG_ERROR:
 		level = "Error";
 		start = MSG_TEXT_ERROR;
-		msg_error_reported = true;
 		break;
 	default:
 		level = "Message";
@@ -338,12 +600,152 @@ void msg_report(enum msg_type type, ...)
 		break;
 	}
 
-	/* Output the message to screen. */
+	if (msg_messages[type].level == MSG_ERROR)
+		__atomic_store_n(&msg_error_reported, true, __ATOMIC_RELAXED);
+
+	/* Format the message, with its location from the calling context. */
+
+	context = msg_find_context();
+
+	if (msg_messages[type].show_location) {
+		line = (context->line_source != NULL) ? context->line_source(context->line_data) : context->line;
+		snprintf(output, MSG_MAX_OUTPUT, "%s%s: %s at line %u of '%s'%s\n", start, level, message, line, context->location, MSG_TEXT_RESET);
+	} else {
+		snprintf(output, MSG_MAX_OUTPUT, "%s%s: %s%s\n", start, level, message, MSG_TEXT_RESET);
+	}
+
+	output[MSG_MAX_OUTPUT - 1] = '\0';
+
+	/* Collect the message, or output it to screen if that isn't
+	 * required or possible.
+	 */
+
+	if (!context->collect || !msg_collect(context, output))
+		fputs(output, stderr);
+}
+
+/**
+ * Add a message to those collected by a context.
+ *
+ * \param *context	Pointer to the context to add the message to.
+ * \param *text		Pointer to the formatted message.
+ * \return		True if successful; False on failure.
+ */
+
+static bool msg_collect(struct msg_context *context, char *text)
+{
+	struct msg_record	*record;
+	size_t			text_size;
+
+	text_size = strlen(text) + 1;
+
+	record = malloc(sizeof(struct msg_record) + text_size);
+	if (record == NULL)
+		return false;
+
+	record->next = NULL;
+	record->order = context->order;
+	record->sequence = __atomic_fetch_add(&msg_sequence, 1, __ATOMIC_RELAXED);
+	record->text = (char *) (record + 1);
 
-	if (msg_messages[type].show_location)
-		fprintf(stderr, "%s%s: %s at line %u of '%s'%s\n", start, level, message, msg_line, msg_location, MSG_TEXT_RESET);
+	memcpy(record->text, text, text_size);
+
+	if (context->last != NULL)
+		context->last->next = record;
 	else
-		fprintf(stderr, "%s%s: %s%s\n", start, level, message, MSG_TEXT_RESET);
+		context->first = record;
+
+	context->last = record;
+
+	return true;
+}
+
+/**
+ * Output all of the messages passed on to the calling thread's context
+ * since the last call, in the order of the work which reported them and
+ * then in the order that they were reported. If the calling thread's own
+ * context is collecting, the messages are added to it in that order
+ * instead, so that they keep their place among the thread's others.
+ */
+
+void msg_flush(void)
+{
+	struct msg_record	*list, *record, **records;
+	struct msg_context	*context = msg_find_context();
+	size_t			count = 0, i;
+
+	list = __atomic_exchange_n(&(context->passed), NULL, __ATOMIC_ACQUIRE);
+	if (list == NULL)
+		return;
+
+	for (record = list; record != NULL; record = record->next)
+		count++;
+
+	/* Sort the messages into order, if there's memory to do so. */
+
+	records = malloc(count * sizeof(struct msg_record *));
+
+	if (records != NULL) {
+		for (record = list, i = 0; record != NULL; record = record->next)
+			records[i++] = record;
+
+		qsort(records, count, sizeof(struct msg_record *), msg_compare_order);
+
+		for (i = 0; i < count; i++)
+			records[i]->next = (i + 1 < count) ? records[i + 1] : NULL;
+
+		list = records[0];
+
+		free(records);
+	}
+
+	/* Add the messages to the calling thread's context... */
+
+	if (context->collect) {
+		for (record = list; record != NULL; record = record->next) {
+			record->order = context->order;
+			record->sequence = __atomic_fetch_add(&msg_sequence, 1, __ATOMIC_RELAXED);
+		}
+
+		if (context->last != NULL)
+			context->last->next = list;
+		else
+			context->first = list;
+
+		for (context->last = list; context->last->next != NULL; context->last = context->last->next);
+
+		return;
+	}
+
+	/* ...or output them. */
+
+	while (list != NULL) {
+		record = list;
+		list = list->next;
+
+		fputs(record->text, stderr);
+		free(record);
+	}
+}
+
+/**
+ * Compare two collected messages, to sort them by the order of the work
+ * which reported them, then by the order in which they were reported.
+ *
+ * \param *a		Pointer to the first message pointer.
+ * \param *b		Pointer to the second message pointer.
+ * \return		The result of the comparison.
+ */
+
+static int msg_compare_order(const void *a, const void *b)
+{
+	const struct msg_record	*first = *((struct msg_record * const *) a);
+	const struct msg_record	*second = *((struct msg_record * const *) b);
+
+	if (first->order != second->order)
+		return (first->order < second->order) ? -1 : 1;
+
+	return (first->sequence < second->sequence) ? -1 : ((first->sequence > second->sequence) ? 1 : 0);
 }
 
 /**
@@ -354,6 +756,6 @@ void msg_report(enum msg_type type, ...)
 
 bool msg_errors(void)
 {
-	return msg_error_reported;
+	return __atomic_load_n(&msg_error_reported, __ATOMIC_RELAXED);
 }
 
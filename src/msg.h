@@ -32,6 +32,59 @@
 
 #include <stdbool.h>
 
+/**
+ * A message context, holding location details for a thread.
+ */
+
+struct msg_context;
+
+/**
+ * Message level definitions.
+ */
+
+enum msg_level {
+	MSG_VERBOSE,			/**< A Verbose informational message.				*/
+	MSG_INFO,			/**< An informational message.					*/
+	MSG_WARNING,			/**< A warning message.						*/
+	MSG_ERROR			/**< An error message (sets the 'error reported' flag).		*/
+};
+
+/**
+ * The lowest level of message which is compiled in to the build. Defining
+ * this as MSG_INFO, for example, removes all of the verbose tracing from
+ * a release build.
+ */
+
+#ifndef MSG_LEVEL_FLOOR
+#define MSG_LEVEL_FLOOR MSG_VERBOSE
+#endif
+
+/**
+ * Report a message at a given level, only evaluating the parameters if
+ * messages of that level are being output. Messages below the level
+ * floor are removed at compile time.
+ *
+ * \param level		The level of the message.
+ * \param ...		The message type, followed by any printf
+ *			parameters required by the token.
+ */
+
+#define msg_report_level(level, ...)							\
+	do {										\
+		if ((level) >= MSG_LEVEL_FLOOR && msg_level_enabled(level))		\
+			msg_report(__VA_ARGS__);					\
+	} while (0)
+
+/**
+ * Report a verbose tracing message, at almost no cost unless verbose
+ * output is enabled.
+ *
+ * \param ...		The message type, followed by any printf
+ *			parameters required by the token.
+ */
+
+#define msg_trace(...) msg_report_level(MSG_VERBOSE, __VA_ARGS__)
+
 
 /**
  * Error message codes.
@@ -49,9 +102,8 @@ enum msg_type {
 	MSG_PARSE_TAG_TOO_LONG,
 	MSG_PARSE_TAG_CLOSE_CONFLICT,
 	MSG_PARSE_TAG_END_NOT_FOUND,
-	MSG_PARSE_ATTRIBUTE_TOO_LONG,
 	MSG_PARSE_UNTERMINATED_ATTRIBUTE,
-	MSG_PARSE_TOO_MANY_ATTRIBUTES,
+	MSG_PARSE_ATTRIBUTE_NO_MEM,
 	MSG_PARSE_UNTERMINATED_COMMENT,
 
 	MSG_PARSE_PUSH,
@@ -103,8 +155,8 @@ enum msg_type {
 
 	MSG_UNKNOWN_ELEMENT,
 	MSG_ELEMENT_OUT_OF_SEQ,
+	MSG_ELEMENT_NO_HASH,
 	MSG_UNKNOWN_ENTITY,
-	MSG_ENTITY_OUT_OF_SEQ,
 	MSG_DATA_MALLOC_FAIL,
 
 	MSG_TREE_MALLOC_FAIL,
@@ -147,13 +199,49 @@ enum msg_type {
 	MSG_STRONG_NEW_NODE_FAIL,
 	MSG_STRONG_NO_FILE,
 	MSG_STRONG_NAME_EXISTS,
+	MSG_STRONG_TOO_LARGE,
 
 	MSG_OUTPUT_FILENAME_NO_MEM,
 	MSG_OUTPUT_FILE_FAILED,
+	MSG_OUTPUT_STDIO_MULTIPLE,
+
+	MSG_MANIFEST_UNCHANGED,
+	MSG_MANIFEST_NO_MEM,
+	MSG_MANIFEST_WRITE_FAIL,
+
+	MSG_LINKS_NO_MEM,
+	MSG_CONTENTS_NO_MEM,
+	MSG_SEARCH_NO_MEM,
+
+	MSG_STATS_NO_MEM,
+	MSG_STATS_WRITE_FAIL,
+
+	MSG_CACHE_LOADED,
+	MSG_CACHE_STALE,
+	MSG_CACHE_BAD,
+	MSG_CACHE_NO_MEM,
+	MSG_CACHE_WRITE_FAIL,
+
+	MSG_STREAM_FILES,
+
+	MSG_CHAPTER_NOT_FOUND,
+
+	MSG_BATCH_OPEN_FAIL,
+	MSG_BATCH_LINE_TOO_LONG,
+	MSG_BATCH_JOB_START,
+	MSG_BATCH_JOB_FAILED,
+	MSG_BATCH_COMPLETE,
+
+	MSG_WATCH_CHANGED,
+	MSG_WATCH_WAITING,
+
+	MSG_ARCHIVE_NAME_TOO_LONG,
 
 	MSG_WRITE_OPENED_FILE,
+	MSG_WRITE_UNCHANGED_FILE,
 	MSG_WRITE_NO_FILENAME,
 	MSG_WRITE_OPEN_FAIL,
+	MSG_WRITE_REPLACE_FAIL,
 	MSG_WRITE_CDIR_FAIL,
 	MSG_WRITE_SETTYPE_FAIL,
 	MSG_WRITE_NO_FILE,
@@ -172,6 +260,56 @@ enum msg_type {
 void msg_initialise(bool verbose);
 
 
+/**
+ * Create a new message context, for use by a thread via
+ * msg_select_context(). Any messages which it collects are passed on to
+ * the context selected by the calling thread when it is destroyed.
+ *
+ * \param collect	True to collect the messages reported in the
+ *			context, so that they can be output together by
+ *			msg_flush() once it has been destroyed; False to
+ *			output them immediately.
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct msg_context *msg_create_context(bool collect);
+
+
+/**
+ * Destroy a message context. The context must not be selected by any
+ * thread at the time. Any messages which it has collected are passed
+ * on to the context which created it, to be output by the next call to
+ * msg_flush() from a thread using that context.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
+
+void msg_destroy_context(struct msg_context *context);
+
+
+/**
+ * Select a message context for the calling thread, so that locations set
+ * by the thread don't affect messages reported by any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool msg_select_context(struct msg_context *context);
+
+
+/**
+ * Return the message context selected by the calling thread, so that it
+ * can be selected again after another has been used for a while.
+ *
+ * \return		Pointer to the thread's context, or NULL if it
+ *			is using the default context.
+ */
+
+struct msg_context *msg_get_context(void);
+
+
 /**
  * Set the location for future messages, in the form of a file and line number
  * relating to the source files.
@@ -194,6 +332,42 @@ void msg_set_location(char *file);
 void msg_set_line(unsigned line);
 
 
+/**
+ * Set a function to be called to find the current line number, when a
+ * message which shows its location is reported. This allows the line
+ * to be found only when it is needed, instead of being tracked as the
+ * source is read.
+ *
+ * \param *source	The function to call to find the line, or NULL to
+ *			return to the line set by msg_set_line().
+ * \param *data		Data to pass to the function.
+ */
+
+void msg_set_line_source(unsigned (*source)(void *), void *data);
+
+
+/**
+ * Set the position in the output of the work being done by the calling
+ * thread, so that the messages which it collects can be output in the
+ * same order as they would be if the work was done in sequence.
+ *
+ * \param order		The position of the work, counting from zero.
+ */
+
+void msg_set_order(unsigned order);
+
+
+/**
+ * Test whether messages of a given level will be output, so that the
+ * cost of reporting them can be avoided if not.
+ *
+ * \param level		The message level to test.
+ * \return		True if messages of the level are output; else false.
+ */
+
+bool msg_level_enabled(enum msg_level level);
+
+
 /**
  * Generate a message to the user, based on a range of standard message tokens
  *
@@ -204,6 +378,17 @@ void msg_set_line(unsigned line);
 void msg_report(enum msg_type type, ...);
 
 
+/**
+ * Output all of the messages passed on to the calling thread's context
+ * since the last call, in the order of the work which reported them and
+ * then in the order that they were reported. If the calling thread's own
+ * context is collecting, the messages are added to it in that order
+ * instead, so that they keep their place among the thread's others.
+ */
+
+void msg_flush(void);
+
+
 /**
  * Indicate whether an error has been reported at any point.
  *
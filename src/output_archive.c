@@ -0,0 +1,296 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_archive.c
+ *
+ * Output Archive, implementation.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "output_archive.h"
+
+#include "filename.h"
+#include "msg.h"
+#include "output_file.h"
+
+/**
+ * The size of a tar block, in bytes.
+ */
+
+#define OUTPUT_ARCHIVE_BLOCK_SIZE 512
+
+/**
+ * The number of empty blocks which mark the end of a tar file.
+ */
+
+#define OUTPUT_ARCHIVE_END_BLOCKS 2
+
+/**
+ * The lengths of the name and prefix fields in a ustar header.
+ */
+
+#define OUTPUT_ARCHIVE_NAME_LEN 100
+#define OUTPUT_ARCHIVE_PREFIX_LEN 155
+
+/**
+ * A ustar file header, occupying a single tar block.
+ */
+
+struct output_archive_header {
+	char	name[OUTPUT_ARCHIVE_NAME_LEN];		/**< The file's name.					*/
+	char	mode[8];				/**< The file's permissions, in octal.			*/
+	char	uid[8];					/**< The owner's user ID, in octal.			*/
+	char	gid[8];					/**< The owner's group ID, in octal.			*/
+	char	size[12];				/**< The file's length, in octal.			*/
+	char	mtime[12];				/**< The modification time, in octal.			*/
+	char	checksum[8];				/**< The header checksum, in octal.			*/
+	char	type;					/**< The type of the entry.				*/
+	char	link[OUTPUT_ARCHIVE_NAME_LEN];		/**< The target of a link entry.			*/
+	char	magic[6];				/**< The ustar magic word.				*/
+	char	version[2];				/**< The ustar version.					*/
+	char	user[32];				/**< The owner's user name.				*/
+	char	group[32];				/**< The owner's group name.				*/
+	char	major[8];				/**< The major device number.				*/
+	char	minor[8];				/**< The minor device number.				*/
+	char	prefix[OUTPUT_ARCHIVE_PREFIX_LEN];	/**< The path leading to the file's name.		*/
+	char	padding[12];				/**< Padding to the end of the block.			*/
+};
+
+/**
+ * An output archive instance.
+ */
+
+struct output_archive {
+	/**
+	 * The file holding the archive.
+	 */
+
+	struct output_file	*file;
+
+	/**
+	 * The modification time given to the files in the archive.
+	 */
+
+	time_t			time;
+
+	/**
+	 * Lock protecting the archive file while a file is added.
+	 */
+
+	pthread_mutex_t		lock;
+};
+
+/* Static Function Prototypes. */
+
+static bool output_archive_make_header(struct output_archive_header *header, char *name, size_t length, time_t time);
+
+/**
+ * Open a new archive file for output.
+ *
+ * \param *filename	Pointer to the name of the archive file.
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_archive *output_archive_open(struct filename *filename)
+{
+	struct output_archive *archive;
+
+	if (filename == NULL)
+		return NULL;
+
+	archive = malloc(sizeof(struct output_archive));
+	if (archive == NULL)
+		return NULL;
+
+	archive->file = output_file_open(filename);
+	if (archive->file == NULL) {
+		free(archive);
+		return NULL;
+	}
+
+	archive->time = time(NULL);
+
+	pthread_mutex_init(&(archive->lock), NULL);
+
+	return archive;
+}
+
+/**
+ * Complete and close an archive file. The instance is destroyed, even
+ * if the archive couldn't be completed.
+ *
+ * \param *archive	Pointer to the archive to close.
+ * \return		True if successful; False on error.
+ */
+
+bool output_archive_close(struct output_archive *archive)
+{
+	char	block[OUTPUT_ARCHIVE_BLOCK_SIZE];
+	bool	success = true;
+	int	i;
+
+	if (archive == NULL)
+		return false;
+
+	/* The end of the archive is marked by empty blocks. */
+
+	memset(block, 0, OUTPUT_ARCHIVE_BLOCK_SIZE);
+
+	for (i = 0; success && i < OUTPUT_ARCHIVE_END_BLOCKS; i++)
+		success = output_file_write(archive->file, block, OUTPUT_ARCHIVE_BLOCK_SIZE);
+
+	if (!output_file_close(archive->file))
+		success = false;
+
+	pthread_mutex_destroy(&(archive->lock));
+	free(archive);
+
+	return success;
+}
+
+/**
+ * Add a file to an archive.
+ *
+ * \param *archive	Pointer to the archive to add the file to.
+ * \param *name		Pointer to the name of the file, relative to the
+ *			root of the archive.
+ * \param *data		Pointer to the contents of the file.
+ * \param length	The length of the file, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_archive_add(struct output_archive *archive, struct filename *name, const void *data, size_t length)
+{
+	struct output_archive_header	header;
+	char				*path, padding[OUTPUT_ARCHIVE_BLOCK_SIZE];
+	size_t				remainder;
+	bool				success;
+
+	if (archive == NULL || name == NULL || (data == NULL && length > 0))
+		return false;
+
+	path = filename_convert(name, FILENAME_PLATFORM_LINUX, 0);
+	if (path == NULL) {
+		msg_report(MSG_WRITE_NO_FILENAME);
+		return false;
+	}
+
+	if (!output_archive_make_header(&header, path, length, archive->time)) {
+		msg_report(MSG_ARCHIVE_NAME_TOO_LONG, path);
+		free(path);
+		return false;
+	}
+
+	free(path);
+
+	/* Write the header, followed by the data padded out to the end of
+	 * its final block.
+	 */
+
+	remainder = length % OUTPUT_ARCHIVE_BLOCK_SIZE;
+	memset(padding, 0, OUTPUT_ARCHIVE_BLOCK_SIZE);
+
+	pthread_mutex_lock(&(archive->lock));
+
+	success = output_file_write(archive->file, &header, OUTPUT_ARCHIVE_BLOCK_SIZE);
+
+	if (success && length > 0)
+		success = output_file_write(archive->file, data, length);
+
+	if (success && remainder > 0)
+		success = output_file_write(archive->file, padding, OUTPUT_ARCHIVE_BLOCK_SIZE - remainder);
+
+	pthread_mutex_unlock(&(archive->lock));
+
+	return success;
+}
+
+/**
+ * Fill in a ustar header for a regular file.
+ *
+ * \param *header	Pointer to the header to fill in.
+ * \param *name		Pointer to the name of the file.
+ * \param length	The length of the file, in bytes.
+ * \param time		The modification time of the file.
+ * \return		True if successful; False if the name can't be
+ *			stored in the header.
+ */
+
+static bool output_archive_make_header(struct output_archive_header *header, char *name, size_t length, time_t time)
+{
+	size_t		size, split;
+	unsigned int	checksum = 0;
+	unsigned char	*bytes;
+	int		i;
+
+	memset(header, 0, sizeof(struct output_archive_header));
+
+	/* Names which don't fit the name field are split at a separator,
+	 * with the leading folders going into the prefix field.
+	 */
+
+	size = strlen(name);
+
+	if (size <= OUTPUT_ARCHIVE_NAME_LEN) {
+		memcpy(header->name, name, size);
+	} else {
+		for (split = 0; split < size && (name[split] != '/' || size - split - 1 > OUTPUT_ARCHIVE_NAME_LEN); split++);
+
+		if (split >= size || split > OUTPUT_ARCHIVE_PREFIX_LEN)
+			return false;
+
+		memcpy(header->prefix, name, split);
+		memcpy(header->name, name + split + 1, size - split - 1);
+	}
+
+	snprintf(header->mode, sizeof(header->mode), "%07o", 0644);
+	snprintf(header->uid, sizeof(header->uid), "%07o", 0);
+	snprintf(header->gid, sizeof(header->gid), "%07o", 0);
+	snprintf(header->size, sizeof(header->size), "%011llo", (unsigned long long) length);
+	snprintf(header->mtime, sizeof(header->mtime), "%011llo", (unsigned long long) time);
+	header->type = '0';
+	memcpy(header->magic, "ustar", 6);
+	memcpy(header->version, "00", 2);
+
+	/* The checksum is calculated with its own field filled with spaces. */
+
+	memset(header->checksum, ' ', sizeof(header->checksum));
+
+	bytes = (unsigned char *) header;
+
+	for (i = 0; i < OUTPUT_ARCHIVE_BLOCK_SIZE; i++)
+		checksum += bytes[i];
+
+	snprintf(header->checksum, sizeof(header->checksum), "%06o", checksum);
+	header->checksum[7] = ' ';
+
+	return true;
+}
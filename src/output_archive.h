@@ -0,0 +1,80 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_archive.h
+ *
+ * Output Archive Interface.
+ *
+ * An archive collects a set of output files into a single tar file,
+ * which is written through a buffered output file and so can itself be
+ * compressed. Files can be added by several threads at once.
+ */
+
+#ifndef XMLMAN_OUTPUT_ARCHIVE_H
+#define XMLMAN_OUTPUT_ARCHIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "filename.h"
+
+/**
+ * An output archive instance.
+ */
+
+struct output_archive;
+
+/**
+ * Open a new archive file for output.
+ *
+ * \param *filename	Pointer to the name of the archive file.
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_archive *output_archive_open(struct filename *filename);
+
+/**
+ * Complete and close an archive file. The instance is destroyed, even
+ * if the archive couldn't be completed.
+ *
+ * \param *archive	Pointer to the archive to close.
+ * \return		True if successful; False on error.
+ */
+
+bool output_archive_close(struct output_archive *archive);
+
+/**
+ * Add a file to an archive.
+ *
+ * \param *archive	Pointer to the archive to add the file to.
+ * \param *name		Pointer to the name of the file, relative to the
+ *			root of the archive.
+ * \param *data		Pointer to the contents of the file.
+ * \param length	The length of the file, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_archive_add(struct output_archive *archive, struct filename *name, const void *data, size_t length);
+
+#endif
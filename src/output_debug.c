@@ -39,10 +39,34 @@
 #include "encoding.h"
 #include "filename.h"
 #include "manual_data.h"
+#include "manual_entity.h"
+#include "output_file.h"
+
+/**
+ * The size of the buffer used to assemble the numeric fields of a
+ * JSON record.
+ */
+
+#define OUTPUT_DEBUG_JSON_FIELD_LEN 64
+
+/**
+ * A machine-readable dump of a manual in progress.
+ */
+
+struct output_debug_json {
+	struct output_file	*file;		/**< The file being written to.				*/
+	int			count;		/**< The number of nodes written so far.		*/
+};
 
 /* Static Function Prototypes. */
 
 static void output_debug_write_node(struct manual_data *parent, struct manual_data *node, int depth, bool *indent);
+static bool output_debug_json_write_nodes(struct output_debug_json *json, struct manual_data *parent, int parent_number,
+		struct manual_data *node, const char *role);
+static bool output_debug_json_write_node(struct output_debug_json *json, struct manual_data *parent, int parent_number,
+		struct manual_data *previous, struct manual_data *node, const char *role);
+static bool output_debug_json_write_field(struct output_file *file, const char *name, const char *text);
+static bool output_debug_json_write_string(struct output_file *file, const char *text);
 //static void output_debug_write_text(enum manual_data_object_type type, struct manual_data *text);
 //static char *output_debug_get_text(char *text);
 
@@ -66,6 +90,45 @@ bool output_debug(struct manual *document, struct filename *filename, enum encod
 	return true;
 }
 
+/**
+ * Output a manual in a machine-readable debug form, as newline-delimited
+ * JSON. Each node of the manual is written as a single record on a line
+ * of its own, in document order, numbered from 1 and carrying the number
+ * of its parent so that the tree can be rebuilt without any indenting.
+ * A node's role within its parent is given unless it is an ordinary
+ * child, and its index unless it is zero.
+ *
+ * \param *document	The manual to be output.
+ * \param *filename	The filename to use to write to.
+ * \param encoding	The encoding to use for output, which is ignored
+ *			as JSON is always written in UTF-8.
+ * \param line_end	The line ending to use for output, which is ignored
+ *			as each record ends in a newline.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_debug_json(struct manual *document, struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end)
+{
+	struct output_debug_json	json;
+	bool				success;
+
+	if (document == NULL || document->manual == NULL || filename == NULL)
+		return false;
+
+	json.file = output_file_open(filename);
+	if (json.file == NULL)
+		return false;
+
+	json.count = 0;
+
+	success = output_debug_json_write_nodes(&json, NULL, 0, document->manual, "root");
+
+	if (!output_file_close(json.file))
+		success = false;
+
+	return success;
+}
+
 
 static void output_debug_write_node(struct manual_data *parent, struct manual_data *node, int depth, bool *indent)
 {
@@ -141,6 +204,214 @@ static void output_debug_write_node(struct manual_data *parent, struct manual_da
 
 	free(new_indent);
 }
+
+/**
+ * Write a chain of sibling nodes, and all of their descendents, to a
+ * machine-readable debug dump.
+ *
+ * \param *json		The dump to write to.
+ * \param *parent	The parent of the nodes, or NULL.
+ * \param parent_number	The record number of the parent, or 0 for none.
+ * \param *node		The first node in the chain.
+ * \param *role		The role of the chain within its parent.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_debug_json_write_nodes(struct output_debug_json *json, struct manual_data *parent, int parent_number,
+		struct manual_data *node, const char *role)
+{
+	struct manual_data *previous = NULL;
+
+	while (node != NULL) {
+		if (!output_debug_json_write_node(json, parent, parent_number, previous, node, role))
+			return false;
+
+		previous = node;
+		node = node->next;
+	}
+
+	return true;
+}
+
+/**
+ * Write a node, and all of its descendents, to a machine-readable debug
+ * dump.
+ *
+ * \param *json		The dump to write to.
+ * \param *parent	The expected parent of the node, or NULL.
+ * \param parent_number	The record number of the parent, or 0 for none.
+ * \param *previous	The expected previous sibling of the node, or NULL.
+ * \param *node		The node to write.
+ * \param *role		The role of the node within its parent.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_debug_json_write_node(struct output_debug_json *json, struct manual_data *parent, int parent_number,
+		struct manual_data *previous, struct manual_data *node, const char *role)
+{
+	char				field[OUTPUT_DEBUG_JSON_FIELD_LEN];
+	struct manual_data_resources	*resources = NULL;
+	int				number;
+
+	number = ++json->count;
+
+	if (parent_number > 0)
+		snprintf(field, OUTPUT_DEBUG_JSON_FIELD_LEN, "{\"node\":%d,\"parent\":%d", number, parent_number);
+	else
+		snprintf(field, OUTPUT_DEBUG_JSON_FIELD_LEN, "{\"node\":%d,\"parent\":null", number);
+
+	if (!output_file_write_text(json->file, field) ||
+			!output_debug_json_write_field(json->file, "type", manual_data_find_object_name(node->type)))
+		return false;
+
+	/* Ordinary children and unnumbered nodes are the norm, so the
+	 * role and index are only written when they say something.
+	 */
+
+	if (strcmp(role, "child") != 0 && !output_debug_json_write_field(json->file, "role", role))
+		return false;
+
+	if (node->index != 0) {
+		snprintf(field, OUTPUT_DEBUG_JSON_FIELD_LEN, ",\"index\":%d", node->index);
+
+		if (!output_file_write_text(json->file, field))
+			return false;
+	}
+
+	/* Write the fields specific to the type of node. */
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		resources = node->chapter.resources;
+		/* Fall through. */
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		if (node->chapter.id != NULL && !output_debug_json_write_field(json->file, "id", node->chapter.id))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		if (node->chunk.id != NULL && !output_debug_json_write_field(json->file, "ref", node->chunk.id))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		if (node->chunk.text != NULL && !output_debug_json_write_field(json->file, "text", node->chunk.text))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		if (!output_debug_json_write_field(json->file, "entity", manual_entity_find_name(node->chunk.entity)))
+			return false;
+		break;
+
+	default:
+		break;
+	}
+
+	/* Flag any node which isn't linked to its neighbours correctly. */
+
+	if ((node->parent != parent || node->previous != previous) &&
+			!output_file_write_text(json->file, ",\"linked\":false"))
+		return false;
+
+	if (!output_file_write_text(json->file, "}\n"))
+		return false;
+
+	/* Write the node's descendents, in the same order as the tree dump. */
+
+	if (!output_debug_json_write_nodes(json, node, number, node->title, "title"))
+		return false;
+
+	if (resources != NULL) {
+		if (!output_debug_json_write_nodes(json, node, number, resources->summary, "summary") ||
+				!output_debug_json_write_nodes(json, node, number, resources->strapline, "strapline") ||
+				!output_debug_json_write_nodes(json, node, number, resources->credit, "credit") ||
+				!output_debug_json_write_nodes(json, node, number, resources->version, "version") ||
+				!output_debug_json_write_nodes(json, node, number, resources->date, "date"))
+			return false;
+	}
+
+	if (node->type == MANUAL_DATA_OBJECT_TYPE_LINK &&
+			!output_debug_json_write_nodes(json, node, number, node->chunk.link, "link"))
+		return false;
+
+	if (node->type == MANUAL_DATA_OBJECT_TYPE_TABLE &&
+			!output_debug_json_write_nodes(json, node, number, node->chapter.columns, "columns"))
+		return false;
+
+	return output_debug_json_write_nodes(json, node, number, node->first_child, "child");
+}
+
+/**
+ * Write a named string field to a JSON record, following on from an
+ * earlier field.
+ *
+ * \param *file		The file to write to.
+ * \param *name		The name of the field.
+ * \param *text		The value of the field, or NULL to write null.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_debug_json_write_field(struct output_file *file, const char *name, const char *text)
+{
+	if (!output_file_write_text(file, ",\"") || !output_file_write_text(file, name) ||
+			!output_file_write_text(file, "\":"))
+		return false;
+
+	if (text == NULL)
+		return output_file_write_text(file, "null");
+
+	return output_debug_json_write_string(file, text);
+}
+
+/**
+ * Write a string to a file as a quoted JSON string. The text is passed
+ * through in UTF-8, with only quotes, backslashes and control characters
+ * being escaped.
+ *
+ * \param *file		The file to write to.
+ * \param *text		The text to be written.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_debug_json_write_string(struct output_file *file, const char *text)
+{
+	const char	*start;
+	char		escape[8];
+	unsigned char	c;
+
+	if (!output_file_write_char(file, '"'))
+		return false;
+
+	for (start = text; (c = *text) != '\0'; text++) {
+		if (c != '"' && c != '\\' && c >= 0x20)
+			continue;
+
+		if (text > start && !output_file_write(file, start, text - start))
+			return false;
+
+		if (c == '"' || c == '\\')
+			snprintf(escape, sizeof(escape), "\\%c", c);
+		else
+			snprintf(escape, sizeof(escape), "\\u%04x", c);
+
+		if (!output_file_write_text(file, escape))
+			return false;
+
+		start = text + 1;
+	}
+
+	if (text > start && !output_file_write(file, start, text - start))
+		return false;
+
+	return output_file_write_char(file, '"');
+}
+
 #if 0
 static void output_debug_write_text(enum manual_data_object_type type, struct manual_data *text)
 {
@@ -47,5 +47,24 @@
 
 bool output_debug(struct manual *document, struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end);
 
+/**
+ * Output a manual in a machine-readable debug form, as newline-delimited
+ * JSON. Each node of the manual is written as a single record on a line
+ * of its own, in document order, numbered from 1 and carrying the number
+ * of its parent so that the tree can be rebuilt without any indenting.
+ * A node's role within its parent is given unless it is an ordinary
+ * child, and its index unless it is zero.
+ *
+ * \param *document	The manual to be output.
+ * \param *filename	The filename to use to write to.
+ * \param encoding	The encoding to use for output, which is ignored
+ *			as JSON is always written in UTF-8.
+ * \param line_end	The line ending to use for output, which is ignored
+ *			as each record ends in a newline.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_debug_json(struct manual *document, struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end);
+
 #endif
 
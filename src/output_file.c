@@ -0,0 +1,895 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_file.c
+ *
+ * Buffered Output File, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <zlib.h>
+
+#ifdef LINUX
+#include <sys/types.h>
+#endif
+
+#include "output_file.h"
+
+#include "filename.h"
+#include "msg.h"
+#include "stats.h"
+
+/**
+ * The size of the output buffer, in bytes.
+ */
+
+#define OUTPUT_FILE_BUFFER_SIZE 65536
+
+/**
+ * The initial size of the block held by a memory output file, in bytes.
+ */
+
+#define OUTPUT_FILE_MEMORY_SIZE 4096
+
+/**
+ * The size of the block used to collect compressed data, in bytes.
+ */
+
+#define OUTPUT_FILE_DEFLATE_SIZE 16384
+
+/**
+ * The zlib window size for gzip output: the maximum window, plus 16 to
+ * request a gzip header and trailer.
+ */
+
+#define OUTPUT_FILE_DEFLATE_GZIP (15 + 16)
+
+/**
+ * The suffix added to the name of a compared file's target, to give the
+ * temporary file which is written before it replaces the target. It is
+ * valid in the filenames of all of the supported platforms.
+ */
+
+#define OUTPUT_FILE_TEMP_SUFFIX "~"
+
+/**
+ * A buffered output file instance.
+ */
+
+struct output_file {
+	/**
+	 * The underlying file handle, or NULL if the file is held in memory.
+	 */
+
+	FILE		*handle;
+
+	/**
+	 * The compression stream, or NULL if the file isn't compressed.
+	 */
+
+	z_stream	*deflate;
+
+	/**
+	 * The memory block holding the flushed contents of a memory file.
+	 */
+
+	char		*memory;
+
+	/**
+	 * The number of bytes held in the memory block.
+	 */
+
+	size_t		memory_used;
+
+	/**
+	 * The local name of the file on disc which a compared file will
+	 * replace on closing if its contents differ, or NULL.
+	 */
+
+	char		*target;
+
+	/**
+	 * The allocated size of the memory block, in bytes.
+	 */
+
+	size_t		memory_size;
+
+	/**
+	 * The position in the file of the first byte in the buffer, which
+	 * is also the position of the underlying file handle.
+	 */
+
+	int64_t		base;
+
+	/**
+	 * The number of bytes held in the buffer.
+	 */
+
+	size_t		used;
+
+	/**
+	 * The offset into the buffer at which the next byte will be written.
+	 */
+
+	size_t		cursor;
+
+	/**
+	 * The output buffer.
+	 */
+
+	char		buffer[OUTPUT_FILE_BUFFER_SIZE];
+};
+
+/* Global Variables. */
+
+/**
+ * True if files opened on disc are to be written with gzip compression.
+ */
+
+static bool output_file_compress = false;
+
+/**
+ * True if files opened on disc are to be compared with the existing
+ * files, and only replaced if their contents have changed.
+ */
+
+static bool output_file_compare = false;
+
+/* Static Function Prototypes. */
+
+static bool output_file_put(struct output_file *file, const void *data, size_t length);
+static bool output_file_deflate(struct output_file *file, const void *data, size_t length, int flush);
+static bool output_file_set_position(FILE *handle, int64_t position);
+static struct output_file *output_file_open_compared(struct filename *filename);
+static bool output_file_write_target(struct output_file *file);
+static bool output_file_matches_target(struct output_file *file);
+
+/**
+ * Initialise the buffered output files.
+ *
+ * \param compress	True to compress the files which are opened on
+ *			disc using gzip; False to write them as they are.
+ * \param compare	True to only replace files on disc if their contents
+ *			have changed; ignored if compress is True.
+ */
+
+void output_file_initialise(bool compress, bool compare)
+{
+	output_file_compress = compress;
+	output_file_compare = compare && !compress;
+}
+
+/**
+ * Open a buffered file for output.
+ *
+ * \param *filename	Pointer to the name of the file to open.
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_file *output_file_open(struct filename *filename)
+{
+	struct output_file *file;
+
+	if (filename == NULL)
+		return NULL;
+
+	/* Files being compared are collected in memory until they close. */
+
+	if (output_file_compare && !filename_is_stdio(filename))
+		return output_file_open_compared(filename);
+
+	file = malloc(sizeof(struct output_file));
+	if (file == NULL)
+		return NULL;
+
+	file->handle = filename_fopen(filename, "w");
+	if (file->handle == NULL) {
+		free(file);
+		return NULL;
+	}
+
+	file->deflate = NULL;
+
+	if (output_file_compress) {
+		file->deflate = malloc(sizeof(z_stream));
+
+		if (file->deflate != NULL) {
+			file->deflate->zalloc = Z_NULL;
+			file->deflate->zfree = Z_NULL;
+			file->deflate->opaque = Z_NULL;
+
+			if (deflateInit2(file->deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED, OUTPUT_FILE_DEFLATE_GZIP, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				free(file->deflate);
+				file->deflate = NULL;
+			}
+		}
+
+		if (file->deflate == NULL) {
+			if (file->handle != stdout)
+				fclose(file->handle);
+			free(file);
+			return NULL;
+		}
+	}
+
+	stats_count(STATS_COUNTER_FILES_WRITTEN, 1);
+
+	file->memory = NULL;
+	file->memory_used = 0;
+	file->memory_size = 0;
+	file->target = NULL;
+
+	file->base = 0;
+	file->used = 0;
+	file->cursor = 0;
+
+	return file;
+}
+
+/**
+ * Open a buffered output file which collects its contents in memory,
+ * instead of writing them to disc.
+ *
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_file *output_file_open_memory(void)
+{
+	struct output_file *file;
+
+	file = malloc(sizeof(struct output_file));
+	if (file == NULL)
+		return NULL;
+
+	file->handle = NULL;
+	file->deflate = NULL;
+
+	file->memory = NULL;
+	file->memory_used = 0;
+	file->memory_size = 0;
+	file->target = NULL;
+
+	file->base = 0;
+	file->used = 0;
+	file->cursor = 0;
+
+	return file;
+}
+
+/**
+ * Open a buffered output file which collects its contents in memory, to
+ * be compared with an existing file on disc when it is closed.
+ *
+ * \param *filename	Pointer to the name of the file to be replaced.
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+static struct output_file *output_file_open_compared(struct filename *filename)
+{
+	struct output_file	*file;
+	char			*target;
+
+	target = filename_convert(filename, FILENAME_PLATFORM_LOCAL, 0);
+	if (target == NULL) {
+		msg_report(MSG_WRITE_NO_FILENAME);
+		return NULL;
+	}
+
+	file = output_file_open_memory();
+	if (file == NULL) {
+		free(target);
+		return NULL;
+	}
+
+	file->target = target;
+
+	return file;
+}
+
+/**
+ * Flush any buffered data to disc, then close a buffered output file.
+ * The instance is destroyed, even if the data couldn't be written.
+ *
+ * \param *file		Pointer to the file to close.
+ * \return		True if successful; False if the final write failed.
+ */
+
+bool output_file_close(struct output_file *file)
+{
+	bool success;
+
+	if (file == NULL)
+		return false;
+
+	success = output_file_flush(file);
+
+	/* Replace the file on disc behind a compared file, if required. */
+
+	if (file->target != NULL) {
+		if (success && !output_file_write_target(file))
+			success = false;
+
+		free(file->target);
+	}
+
+	/* Complete any compressed stream, writing out its trailer. */
+
+	if (file->deflate != NULL) {
+		if (success && !output_file_deflate(file, NULL, 0, Z_FINISH))
+			success = false;
+
+		deflateEnd(file->deflate);
+		free(file->deflate);
+	}
+
+	/* The standard output stream is flushed, but left open. */
+
+	if (file->handle == stdout) {
+		if (fflush(file->handle) == EOF)
+			success = false;
+	} else if (file->handle != NULL && fclose(file->handle) == EOF) {
+		success = false;
+	}
+
+	free(file->memory);
+	free(file);
+
+	return success;
+}
+
+/**
+ * Close a memory output file, passing the block holding its contents
+ * back to the caller. The instance is destroyed, even on failure; on
+ * success, the caller becomes responsible for freeing the block.
+ *
+ * \param *file		Pointer to the file to close.
+ * \param **data	Pointer to a variable to take a pointer to the
+ *			contents, which may be NULL if the file is empty.
+ * \param *length	Pointer to a variable to take the size of the
+ *			contents, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_close_memory(struct output_file *file, void **data, size_t *length)
+{
+	if (file == NULL || data == NULL || length == NULL)
+		return false;
+
+	if (file->handle != NULL || file->target != NULL || !output_file_flush(file)) {
+		output_file_close(file);
+		return false;
+	}
+
+	*data = file->memory;
+	*length = file->memory_used;
+
+	free(file);
+
+	return true;
+}
+
+/**
+ * Write a block of bytes to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *data		Pointer to the data to be written.
+ * \param length	The number of bytes to write.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write(struct output_file *file, const void *data, size_t length)
+{
+	if (file == NULL || data == NULL)
+		return false;
+
+	/* If the data won't fit into the buffer, flush what's there. Blocks
+	 * which would fill the buffer on their own are written directly.
+	 */
+
+	if (length > OUTPUT_FILE_BUFFER_SIZE - file->cursor) {
+		if (!output_file_flush(file))
+			return false;
+
+		if (length >= OUTPUT_FILE_BUFFER_SIZE) {
+			if (!output_file_put(file, data, length))
+				return false;
+
+			file->base += length;
+			return true;
+		}
+	}
+
+	memcpy(file->buffer + file->cursor, data, length);
+	file->cursor += length;
+
+	if (file->cursor > file->used)
+		file->used = file->cursor;
+
+	return true;
+}
+
+/**
+ * Write a terminated string to a buffered output file, without its
+ * terminator.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *text		Pointer to the text to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_text(struct output_file *file, const char *text)
+{
+	if (text == NULL)
+		return false;
+
+	return output_file_write(file, text, strlen(text));
+}
+
+/**
+ * Write a single byte to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param c		The byte to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_char(struct output_file *file, char c)
+{
+	if (file == NULL)
+		return false;
+
+	if (file->cursor >= OUTPUT_FILE_BUFFER_SIZE && !output_file_flush(file))
+		return false;
+
+	file->buffer[file->cursor++] = c;
+
+	if (file->cursor > file->used)
+		file->used = file->cursor;
+
+	return true;
+}
+
+/**
+ * Write printf-style formatted text to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *format	Pointer to the format string.
+ * \param ap		The parameters for the format string.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_format(struct output_file *file, const char *format, va_list ap)
+{
+	va_list	copy;
+	char	*text;
+	int	length;
+	bool	success;
+
+	if (file == NULL || format == NULL)
+		return false;
+
+	/* Try to format the text straight into the free space at the end
+	 * of the buffer.
+	 */
+
+	va_copy(copy, ap);
+	length = vsnprintf(file->buffer + file->cursor, OUTPUT_FILE_BUFFER_SIZE - file->cursor, format, copy);
+	va_end(copy);
+
+	if (length < 0)
+		return false;
+
+	if ((size_t) length < OUTPUT_FILE_BUFFER_SIZE - file->cursor) {
+		file->cursor += length;
+
+		if (file->cursor > file->used)
+			file->used = file->cursor;
+
+		return true;
+	}
+
+	/* There wasn't room, so either flush the buffer and try again, or
+	 * format the text into a block of its own if it's too long to fit.
+	 */
+
+	if ((size_t) length < OUTPUT_FILE_BUFFER_SIZE) {
+		if (!output_file_flush(file))
+			return false;
+
+		va_copy(copy, ap);
+		length = vsnprintf(file->buffer, OUTPUT_FILE_BUFFER_SIZE, format, copy);
+		va_end(copy);
+
+		if (length < 0)
+			return false;
+
+		file->cursor = length;
+		file->used = length;
+
+		return true;
+	}
+
+	text = malloc(length + 1);
+	if (text == NULL)
+		return false;
+
+	va_copy(copy, ap);
+	vsnprintf(text, length + 1, format, copy);
+	va_end(copy);
+
+	success = output_file_write(file, text, length);
+
+	free(text);
+
+	return success;
+}
+
+/**
+ * Write any buffered data for a buffered output file out to disc.
+ *
+ * \param *file		Pointer to the file to flush.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_flush(struct output_file *file)
+{
+	size_t used, cursor;
+
+	if (file == NULL)
+		return false;
+
+	if (file->used == 0)
+		return true;
+
+	used = file->used;
+	cursor = file->cursor;
+
+	file->used = 0;
+	file->cursor = 0;
+
+	if (!output_file_put(file, file->buffer, used))
+		return false;
+
+	/* If the write position had been moved back into the buffer, move
+	 * the file pointer back to match. A compressed stream can't be
+	 * rewound, so this is an error.
+	 */
+
+	if (cursor != used && file->deflate != NULL) {
+		file->base += used;
+		return false;
+	}
+
+	if (cursor != used && file->handle != NULL && !output_file_set_position(file->handle, file->base + cursor)) {
+		file->base += used;
+		return false;
+	}
+
+	file->base += cursor;
+
+	return true;
+}
+
+/**
+ * Return the current write position within a buffered output file.
+ *
+ * \param *file		Pointer to the file to query.
+ * \return		The current position, or -1 on error.
+ */
+
+int64_t output_file_tell(struct output_file *file)
+{
+	if (file == NULL)
+		return -1;
+
+	return file->base + file->cursor;
+}
+
+/**
+ * Set the write position within a buffered output file. Positions which
+ * are still held in the buffer are updated in memory; any others cause
+ * the buffer to be flushed first.
+ *
+ * \param *file		Pointer to the file to update.
+ * \param position	The new position, from the start of the file.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_seek(struct output_file *file, int64_t position)
+{
+	if (file == NULL || position < 0)
+		return false;
+
+	/* If the position falls within the buffer, just move the cursor. */
+
+	if (position >= file->base && position <= file->base + (int64_t) file->used) {
+		file->cursor = position - file->base;
+		return true;
+	}
+
+	/* Otherwise, write out the buffer and move the file pointer. A
+	 * compressed stream can only be written sequentially.
+	 */
+
+	if (file->deflate != NULL)
+		return false;
+
+	if (!output_file_flush(file))
+		return false;
+
+	if (file->handle == NULL) {
+		if ((size_t) position > file->memory_used)
+			return false;
+	} else if (!output_file_set_position(file->handle, position)) {
+		return false;
+	}
+
+	file->base = position;
+
+	return true;
+}
+
+/**
+ * Pass a block of data on from a buffered output file to its underlying
+ * file handle, or into its memory block, at the position given by
+ * the buffer base.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *data		Pointer to the data to be written.
+ * \param length	The number of bytes to write.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_file_put(struct output_file *file, const void *data, size_t length)
+{
+	size_t	end, size;
+	char	*memory;
+
+	if (file->deflate != NULL)
+		return output_file_deflate(file, data, length, Z_NO_FLUSH);
+
+	if (file->handle != NULL) {
+		stats_count(STATS_COUNTER_BYTES_WRITTEN, length);
+		return (fwrite(data, 1, length, file->handle) == length) ? true : false;
+	}
+
+	/* Grow the memory block if the data won't fit. */
+
+	end = (size_t) file->base + length;
+
+	if (end > file->memory_size) {
+		size = (file->memory_size > 0) ? file->memory_size : OUTPUT_FILE_MEMORY_SIZE;
+
+		while (size < end)
+			size *= 2;
+
+		memory = realloc(file->memory, size);
+		if (memory == NULL)
+			return false;
+
+		file->memory = memory;
+		file->memory_size = size;
+	}
+
+	memcpy(file->memory + (size_t) file->base, data, length);
+
+	if (end > file->memory_used)
+		file->memory_used = end;
+
+	return true;
+}
+
+/**
+ * Pass a block of data through the compression stream of a buffered
+ * output file, writing any compressed data which results to the
+ * underlying file handle.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *data		Pointer to the data to be written.
+ * \param length	The number of bytes to write.
+ * \param flush		The zlib flush mode to use: Z_NO_FLUSH, or
+ *			Z_FINISH to complete the stream.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_file_deflate(struct output_file *file, const void *data, size_t length, int flush)
+{
+	unsigned char	block[OUTPUT_FILE_DEFLATE_SIZE];
+	size_t		size, piece;
+	int		status;
+
+	/* The data is passed to zlib in pieces which are sure to fit its
+	 * counters, and the final flush is made on an empty piece.
+	 */
+
+	do {
+		piece = (length > OUTPUT_FILE_BUFFER_SIZE) ? OUTPUT_FILE_BUFFER_SIZE : length;
+
+		file->deflate->next_in = (Bytef *) data;
+		file->deflate->avail_in = piece;
+
+		do {
+			file->deflate->next_out = block;
+			file->deflate->avail_out = OUTPUT_FILE_DEFLATE_SIZE;
+
+			status = deflate(file->deflate, (piece == length) ? flush : Z_NO_FLUSH);
+			if (status == Z_STREAM_ERROR)
+				return false;
+
+			size = OUTPUT_FILE_DEFLATE_SIZE - file->deflate->avail_out;
+
+			if (size > 0) {
+				stats_count(STATS_COUNTER_BYTES_WRITTEN, size);
+
+				if (fwrite(block, 1, size, file->handle) != size)
+					return false;
+			}
+		} while (file->deflate->avail_out == 0);
+
+		if (data != NULL)
+			data = (const char *) data + piece;
+
+		length -= piece;
+	} while (length > 0);
+
+	return true;
+}
+
+/**
+ * Write the contents of a compared file out to the file on disc which
+ * it is to replace, unless that already holds the same contents. The
+ * contents go into a temporary file beside the target, which is only
+ * renamed over it once they have been written successfully, so that a
+ * failed write leaves the existing file intact.
+ *
+ * \param *file		Pointer to the file to write out.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_file_write_target(struct output_file *file)
+{
+	FILE	*handle;
+	char	*temp;
+	bool	success = true;
+
+	if (output_file_matches_target(file)) {
+		stats_count(STATS_COUNTER_FILES_UNCHANGED, 1);
+		msg_report(MSG_WRITE_UNCHANGED_FILE, file->target);
+		return true;
+	}
+
+	temp = malloc(strlen(file->target) + strlen(OUTPUT_FILE_TEMP_SUFFIX) + 1);
+	if (temp == NULL) {
+		msg_report(MSG_WRITE_REPLACE_FAIL, file->target);
+		return false;
+	}
+
+	strcpy(temp, file->target);
+	strcat(temp, OUTPUT_FILE_TEMP_SUFFIX);
+
+	handle = fopen(temp, "w");
+	if (handle == NULL) {
+		msg_report(MSG_WRITE_OPEN_FAIL, temp);
+		free(temp);
+		return false;
+	}
+
+	msg_report(MSG_WRITE_OPENED_FILE, file->target);
+	stats_count(STATS_COUNTER_FILES_WRITTEN, 1);
+
+	if (file->memory_used > 0) {
+		stats_count(STATS_COUNTER_BYTES_WRITTEN, file->memory_used);
+
+		if (fwrite(file->memory, 1, file->memory_used, handle) != file->memory_used)
+			success = false;
+	}
+
+	if (fclose(handle) == EOF)
+		success = false;
+
+	/* Replace the target with the new file. Not every platform's rename()
+	 * will overwrite an existing file, so if it fails, the target is
+	 * removed and the rename tried again.
+	 */
+
+	if (success && rename(temp, file->target) != 0 &&
+			(remove(file->target) != 0 || rename(temp, file->target) != 0))
+		success = false;
+
+	if (!success) {
+		remove(temp);
+		msg_report(MSG_WRITE_REPLACE_FAIL, file->target);
+	}
+
+	free(temp);
+
+	return success;
+}
+
+/**
+ * Test whether the file on disc behind a compared file already holds
+ * the same contents. The file is read back through the output buffer,
+ * which must be empty.
+ *
+ * \param *file		Pointer to the file to test.
+ * \return		True if the contents match; False if they differ,
+ *			or the file on disc can't be read.
+ */
+
+static bool output_file_matches_target(struct output_file *file)
+{
+	FILE	*handle;
+	size_t	length, offset = 0;
+	bool	match = true;
+
+	handle = fopen(file->target, "rb");
+	if (handle == NULL)
+		return false;
+
+	while (match) {
+		length = fread(file->buffer, 1, OUTPUT_FILE_BUFFER_SIZE, handle);
+		if (length == 0)
+			break;
+
+		if (length > file->memory_used - offset || memcmp(file->memory + offset, file->buffer, length) != 0)
+			match = false;
+		else
+			offset += length;
+	}
+
+	if (ferror(handle))
+		match = false;
+
+	fclose(handle);
+
+	return (match && offset == file->memory_used) ? true : false;
+}
+
+/**
+ * Move the file pointer of an underlying file handle. On Linux, this
+ * uses the 64-bit off_t interface; elsewhere, positions which can't be
+ * held in a long are rejected rather than being truncated.
+ *
+ * \param *handle	The file handle to update.
+ * \param position	The new position, from the start of the file.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_file_set_position(FILE *handle, int64_t position)
+{
+#ifdef LINUX
+	return (fseeko(handle, (off_t) position, SEEK_SET) == 0) ? true : false;
+#else
+	if (position > LONG_MAX)
+		return false;
+
+	return (fseek(handle, (long) position, SEEK_SET) == 0) ? true : false;
+#endif
+}
@@ -0,0 +1,189 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_file.h
+ *
+ * Buffered Output File Interface.
+ *
+ * Output files collect the data written to them in a large memory
+ * buffer, which is passed on to disc in a single write each time that
+ * it fills. Positions within the file can be revisited, allowing headers
+ * to be updated once their contents are known.
+ *
+ * Files can also be held entirely in memory, so that their contents can
+ * be collected and measured before being copied into another file.
+ *
+ * Files on disc can optionally be compressed with gzip as the buffer is
+ * passed on, in which case they can only be written sequentially.
+ *
+ * Alternatively, files on disc can be compared with what's already there:
+ * their contents are collected in memory, and only written out on closing
+ * if they differ from the existing file, which otherwise keeps its
+ * timestamp.
+ */
+
+#ifndef XMLMAN_OUTPUT_FILE_H
+#define XMLMAN_OUTPUT_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "filename.h"
+
+/**
+ * A buffered output file instance.
+ */
+
+struct output_file;
+
+/**
+ * Initialise the buffered output files.
+ *
+ * \param compress	True to compress the files which are opened on
+ *			disc using gzip; False to write them as they are.
+ * \param compare	True to only replace files on disc if their contents
+ *			have changed; ignored if compress is True.
+ */
+
+void output_file_initialise(bool compress, bool compare);
+
+/**
+ * Open a buffered file for output.
+ *
+ * \param *filename	Pointer to the name of the file to open.
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_file *output_file_open(struct filename *filename);
+
+/**
+ * Open a buffered output file which collects its contents in memory,
+ * instead of writing them to disc.
+ *
+ * \return		Pointer to the new instance, or NULL on failure.
+ */
+
+struct output_file *output_file_open_memory(void);
+
+/**
+ * Flush any buffered data to disc, then close a buffered output file.
+ * The instance is destroyed, even if the data couldn't be written.
+ *
+ * \param *file		Pointer to the file to close.
+ * \return		True if successful; False if the final write failed.
+ */
+
+bool output_file_close(struct output_file *file);
+
+/**
+ * Close a memory output file, passing the block holding its contents
+ * back to the caller. The instance is destroyed, even on failure; on
+ * success, the caller becomes responsible for freeing the block.
+ *
+ * \param *file		Pointer to the file to close.
+ * \param **data	Pointer to a variable to take a pointer to the
+ *			contents, which may be NULL if the file is empty.
+ * \param *length	Pointer to a variable to take the size of the
+ *			contents, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_close_memory(struct output_file *file, void **data, size_t *length);
+
+/**
+ * Write a block of bytes to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *data		Pointer to the data to be written.
+ * \param length	The number of bytes to write.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write(struct output_file *file, const void *data, size_t length);
+
+/**
+ * Write a terminated string to a buffered output file, without its
+ * terminator.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *text		Pointer to the text to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_text(struct output_file *file, const char *text);
+
+/**
+ * Write a single byte to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param c		The byte to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_char(struct output_file *file, char c);
+
+/**
+ * Write printf-style formatted text to a buffered output file.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *format	Pointer to the format string.
+ * \param ap		The parameters for the format string.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_write_format(struct output_file *file, const char *format, va_list ap);
+
+/**
+ * Write any buffered data for a buffered output file out to disc.
+ *
+ * \param *file		Pointer to the file to flush.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_flush(struct output_file *file);
+
+/**
+ * Return the current write position within a buffered output file.
+ *
+ * \param *file		Pointer to the file to query.
+ * \return		The current position, or -1 on error.
+ */
+
+int64_t output_file_tell(struct output_file *file);
+
+/**
+ * Set the write position within a buffered output file. Positions which
+ * are still held in the buffer are updated in memory; any others cause
+ * the buffer to be flushed first.
+ *
+ * \param *file		Pointer to the file to update.
+ * \param position	The new position, from the start of the file.
+ * \return		True if successful; False on error.
+ */
+
+bool output_file_seek(struct output_file *file, int64_t position);
+
+#endif
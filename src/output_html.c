@@ -32,17 +32,26 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "xmlman.h"
 #include "output_html.h"
 
 #include "encoding.h"
 #include "filename.h"
+#include "manifest.h"
+#include "manual_contents.h"
 #include "manual_data.h"
+#include "manual_links.h"
 #include "manual_queue.h"
 #include "modes.h"
 #include "msg.h"
+#include "output_archive.h"
+#include "output_file.h"
 #include "output_html_file.h"
+#include "output_render.h"
+#include "output_search.h"
+#include "profile.h"
 
 /* Static constants. */
 
@@ -71,17 +80,104 @@
 
 #define OUTPUT_HTML_ROOT_FILENAME "index.html"
 
+/**
+ * The filename used for the shared default stylesheet, in the root
+ * of the output folder.
+ */
+
+#define OUTPUT_HTML_SHARED_STYLESHEET_FILENAME "manual.css"
+
+/**
+ * The name of the search index, in the root of the output folder.
+ */
+
+#define OUTPUT_HTML_SEARCH_INDEX_FILENAME "search.idx"
+
+/**
+ * A worker thread, writing files claimed from the shared manual queue.
+ */
+
+struct output_html_worker {
+	struct manual_queue_context	*queue;		/**< The queue shared by the workers.			*/
+	struct msg_context		*msg;		/**< The message context for the worker.		*/
+	struct filename			*folder;	/**< The folder into which to write the manual.		*/
+	enum encoding_target		encoding;	/**< The encoding to use for output.			*/
+	enum encoding_line_end		line_end;	/**< The line ending to use for output.			*/
+	pthread_t			thread;		/**< The thread running the worker.			*/
+	bool				started;	/**< True if the thread was started.			*/
+	bool				result;		/**< The outcome of the worker, once complete.		*/
+};
+
 /* Global Variables. */
 
+/**
+ * The number of threads to use when writing the output files.
+ */
+
+static int output_html_threads = 1;
+
+/**
+ * True if the default stylesheet should be written to a shared file
+ * when the manual is split across multiple files.
+ */
+
+static bool output_html_shared_css = false;
+
+/**
+ * The name of the shared default stylesheet, relative to the output
+ * folder, or NULL if the default stylesheet is being embedded.
+ */
+
+static struct filename *output_html_shared_stylesheet = NULL;
+
+/**
+ * True if the files of a manual which is split across multiple files
+ * should be packed into a single archive.
+ */
+
+static bool output_html_pack = false;
+
+/**
+ * The archive into which the files are being packed, or NULL if they
+ * are being written directly to disc.
+ */
+
+static struct output_archive *output_html_archive = NULL;
+
+/**
+ * True if a search index should be written for a manual which is split
+ * across multiple files.
+ */
+
+static bool output_html_search_index = false;
+
 /**
  * The root filename used when writing into an empty folder.
  */
 
 static struct filename *output_html_root_filename;
 
+/**
+ * The incremental build manifest for the output, or NULL.
+ */
+
+static struct manifest *output_html_manifest;
+
+/**
+ * The cache of relative links between the output files.
+ */
+
+static struct manual_links *output_html_links;
+
+/**
+ * The cache of chapter lists, with their rendered titles.
+ */
+
+static struct manual_contents *output_html_contents;
+
 /**
  * The default stylesheet, which is embedded into the HTML file
- * if no external sheet is specified.
+ * or written to a shared file if no external sheet is specified.
  */
 
 static char *output_html_default_stylesheet[] = {
@@ -138,11 +234,52 @@ static char *output_html_default_stylesheet[] = {
 	NULL
 };
 
+/**
+ * The rendering of the inline spans, as HTML tags or styled spans.
+ */
+
+static struct output_render_span output_html_spans[] = {
+	{MANUAL_DATA_OBJECT_TYPE_CITATION,		OUTPUT_RENDER_SPAN_WRAP,	"cite"},
+	{MANUAL_DATA_OBJECT_TYPE_CODE,			OUTPUT_RENDER_SPAN_WRAP,	"code"},
+	{MANUAL_DATA_OBJECT_TYPE_COMMAND,		OUTPUT_RENDER_SPAN_CLASS,	"command"},
+	{MANUAL_DATA_OBJECT_TYPE_CONSTANT,		OUTPUT_RENDER_SPAN_CLASS,	"code"},
+	{MANUAL_DATA_OBJECT_TYPE_EVENT,			OUTPUT_RENDER_SPAN_CLASS,	"name"},
+	{MANUAL_DATA_OBJECT_TYPE_FILENAME,		OUTPUT_RENDER_SPAN_CLASS,	"filename"},
+	{MANUAL_DATA_OBJECT_TYPE_FUNCTION,		OUTPUT_RENDER_SPAN_CLASS,	"code"},
+	{MANUAL_DATA_OBJECT_TYPE_ICON,			OUTPUT_RENDER_SPAN_CLASS,	"icon"},
+	{MANUAL_DATA_OBJECT_TYPE_INTRO,			OUTPUT_RENDER_SPAN_CLASS,	"introduction"},
+	{MANUAL_DATA_OBJECT_TYPE_KEY,			OUTPUT_RENDER_SPAN_CLASS,	"key"},
+	{MANUAL_DATA_OBJECT_TYPE_KEYWORD,		OUTPUT_RENDER_SPAN_CLASS,	"keyword"},
+	{MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"em"},
+	{MANUAL_DATA_OBJECT_TYPE_LINK,			OUTPUT_RENDER_SPAN_LINK,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MATHS,			OUTPUT_RENDER_SPAN_CLASS,	"maths"},
+	{MANUAL_DATA_OBJECT_TYPE_MENU,			OUTPUT_RENDER_SPAN_CLASS,	"menu"},
+	{MANUAL_DATA_OBJECT_TYPE_MESSAGE,		OUTPUT_RENDER_SPAN_CLASS,	"name"},
+	{MANUAL_DATA_OBJECT_TYPE_MOUSE,			OUTPUT_RENDER_SPAN_CLASS,	"mouse"},
+	{MANUAL_DATA_OBJECT_TYPE_NAME,			OUTPUT_RENDER_SPAN_CLASS,	"name"},
+	{MANUAL_DATA_OBJECT_TYPE_REFERENCE,		OUTPUT_RENDER_SPAN_REFERENCE,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"strong"},
+	{MANUAL_DATA_OBJECT_TYPE_SWI,			OUTPUT_RENDER_SPAN_CLASS,	"name"},
+	{MANUAL_DATA_OBJECT_TYPE_TYPE,			OUTPUT_RENDER_SPAN_CLASS,	"name"},
+	{MANUAL_DATA_OBJECT_TYPE_USER_ENTRY,		OUTPUT_RENDER_SPAN_CLASS,	"entry"},
+	{MANUAL_DATA_OBJECT_TYPE_VARIABLE,		OUTPUT_RENDER_SPAN_CLASS,	"variable"},
+	{MANUAL_DATA_OBJECT_TYPE_WINDOW,		OUTPUT_RENDER_SPAN_CLASS,	"window"}
+};
+
 /* Static Function Prototypes. */
 
-static bool output_html_write_manual(struct manual_data *manual, struct filename *folder);
+static bool output_html_write_manual(struct manual_data *manual, struct filename *folder, enum encoding_target encoding, enum encoding_line_end line_end);
+static bool output_html_write_shared_stylesheet(struct filename *folder);
+static bool output_html_open_archive(struct filename *archive);
+static bool output_html_open_file(struct filename *filename);
+static bool output_html_write_search_index(struct manual_data *manual, struct filename *folder);
+static void *output_html_worker_thread(void *data);
+static bool output_html_write_queue(struct filename *folder, bool single_file, bool shared);
 static bool output_html_write_file(struct manual_data *object, struct filename *folder, bool single_file);
 static bool output_html_write_section_object(struct manual_data *object, int level, bool root);
+static enum manual_data_walk_action output_html_enter_section_object(struct manual_data *object, int level, bool root);
+static enum manual_data_walk_action output_html_walk_section_enter(struct manual_data_walk_frame *frame, void *data);
+static bool output_html_write_section_block(struct manual_data *object, struct manual_data *block, int level);
 static bool output_html_write_file_head(struct manual_data *manual);
 static bool output_html_write_page_head(struct manual_data *manual, int level);
 static bool output_html_write_stylesheet_link(struct manual_data *manual);
@@ -150,15 +287,18 @@ static bool output_html_write_page_foot(struct manual_data *manual);
 static bool output_html_write_file_foot(struct manual_data *manual);
 static bool output_html_write_heading(struct manual_data *node, int level);
 static bool output_html_write_chapter_list(struct manual_data *object, int level);
+static bool output_html_render_chapter_list_title(struct manual_data *node, void **title, size_t *length);
 static bool output_html_write_block_collection_object(struct manual_data *object);
 static bool output_html_write_footnote(struct manual_data *object);
 static bool output_html_write_callout(struct manual_data *object);
 static bool output_html_write_list(struct manual_data *object);
 static bool output_html_write_table(struct manual_data *object);
+static bool output_html_write_table_contents(struct manual_data *object);
 static bool output_html_write_code_block(struct manual_data *object);
 static bool output_html_write_paragraph(struct manual_data *object);
 static bool output_html_write_reference(struct manual_data *source, struct manual_data *target, char *text);
 static bool output_html_write_text(enum manual_data_object_type type, struct manual_data *text);
+static bool output_html_write_text_contents(enum manual_data_object_type type, struct manual_data *text);
 static bool output_html_write_span_tag(enum manual_data_object_type type, char *tag, struct manual_data *text);
 static bool output_html_write_span_style(enum manual_data_object_type type, char *style, struct manual_data *text);
 static bool output_html_write_inline_link(struct manual_data *link);
@@ -168,6 +308,28 @@ static bool output_html_write_title(struct manual_data *node, bool include_name,
 static bool output_html_write_id(struct manual_data *node);
 static bool output_html_write_entity(enum manual_entity_type entity);
 
+/**
+ * Initialise the HTML output engine.
+ *
+ * \param threads	The number of threads to use when writing a manual
+ *			which is split across multiple files.
+ * \param shared_css	True to write the default stylesheet to a file
+ *			of its own, when a manual is split across multiple
+ *			files, instead of embedding it in every page.
+ * \param pack		True to pack the files of a manual which is split
+ *			across multiple files into a single archive.
+ * \param search_index	True to write a search index alongside a manual
+ *			which is split across multiple files.
+ */
+
+void output_html_initialise(int threads, bool shared_css, bool pack, bool search_index)
+{
+	output_html_threads = (threads > 1) ? threads : 1;
+	output_html_shared_css = shared_css;
+	output_html_pack = pack;
+	output_html_search_index = search_index;
+}
+
 /**
  * Output a manual in HTML form.
  *
@@ -180,7 +342,9 @@ static bool output_html_write_entity(enum manual_entity_type entity);
 
 bool output_html(struct manual *document, struct filename *folder, enum encoding_target encoding, enum encoding_line_end line_end)
 {
-	bool result;
+	enum encoding_target	target;
+	enum encoding_line_end	ending;
+	bool			result;
 
 	if (document == NULL || document->manual == NULL)
 		return false;
@@ -189,17 +353,41 @@ bool output_html(struct manual *document, struct filename *folder, enum encoding
 
 	/* Output encoding defaults to UTF8. */
 
-	encoding_select_table((encoding != ENCODING_TARGET_NONE) ? encoding : ENCODING_TARGET_UTF8);
+	target = (encoding != ENCODING_TARGET_NONE) ? encoding : ENCODING_TARGET_UTF8;
+	encoding_select_table(target);
 
 	/* Output line endings default to LF. */
 
-	encoding_select_line_end((line_end != ENCODING_LINE_END_NONE) ? line_end : ENCODING_LINE_END_LF);
+	ending = (line_end != ENCODING_LINE_END_NONE) ? line_end : ENCODING_LINE_END_LF;
+	encoding_select_line_end(ending);
 
 	/* Write the manual file content. */
 
 	output_html_root_filename = filename_make(OUTPUT_HTML_ROOT_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
 
-	result = output_html_write_manual(document->manual, folder);
+	output_html_links = manual_links_create(output_html_root_filename, MODES_TYPE_HTML, FILENAME_PLATFORM_LINUX);
+	if (output_html_links == NULL) {
+		filename_destroy(output_html_root_filename);
+		msg_report(MSG_LINKS_NO_MEM);
+		return false;
+	}
+
+	output_html_contents = manual_contents_create(output_html_render_chapter_list_title);
+	if (output_html_contents == NULL) {
+		manual_links_destroy(output_html_links);
+		filename_destroy(output_html_root_filename);
+		msg_report(MSG_CONTENTS_NO_MEM);
+		return false;
+	}
+
+	output_html_manifest = manifest_open(folder, MODES_TYPE_HTML, encoding, line_end);
+
+	result = output_html_write_manual(document->manual, folder, target, ending);
+
+	manifest_close(output_html_manifest, result);
+
+	manual_contents_destroy(output_html_contents);
+	manual_links_destroy(output_html_links);
 
 	filename_destroy(output_html_root_filename);
 
@@ -211,13 +399,17 @@ bool output_html(struct manual *document, struct filename *folder, enum encoding
  *
  * \param *manual	The manual to process.
  * \param *folder	The folder into which to write the manual.
+ * \param encoding	The encoding selected for output.
+ * \param line_end	The line ending selected for output.
  * \return		TRUE if successful, otherwise FALSE.
  */
 
-static bool output_html_write_manual(struct manual_data *manual, struct filename *folder)
+static bool output_html_write_manual(struct manual_data *manual, struct filename *folder, enum encoding_target encoding, enum encoding_line_end line_end)
 {
-	struct manual_data *object;
-	bool single_file = false;
+	struct output_html_worker	*workers = NULL;
+	struct msg_context		*outer = NULL, *msg = NULL;
+	bool				single_file = false, result;
+	int				i, count = 0;
 
 	if (manual == NULL || folder == NULL)
 		return false;
@@ -234,21 +426,377 @@ static bool output_html_write_manual(struct manual_data *manual, struct filename
 
 	single_file = !manual_data_find_filename_data(manual, MODES_TYPE_HTML);
 
+	/* Output can only be sent to stdout if it's a single file. */
+
+	if (!single_file && filename_is_stdio(folder)) {
+		msg_report(MSG_OUTPUT_STDIO_MULTIPLE);
+		return false;
+	}
+
+	/* If the files are to be packed, the archive takes the place of
+	 * the output folder.
+	 */
+
+	if (output_html_pack && !single_file && !output_html_open_archive(folder))
+		return false;
+
+	/* If the pages are to share the default stylesheet, write it out
+	 * before any of them are written to link to it.
+	 */
+
+	if (output_html_shared_css && !single_file && !output_html_write_shared_stylesheet(folder)) {
+		output_archive_close(output_html_archive);
+		output_html_archive = NULL;
+		return false;
+	}
+
 	/* Initialise the manual queue. */
 
 	manual_queue_initialise();
 
-	/* Process the files, starting with the root node. */
+	/* Process the files, starting with the root node. If the manual
+	 * is split across multiple files, start additional workers to share
+	 * the queue, then take part in the work.
+	 */
 
 	manual_queue_add_node(manual);
 
+	if (single_file == false && output_html_threads > 1) {
+		workers = malloc(sizeof(struct output_html_worker) * (output_html_threads - 1));
+		if (workers != NULL)
+			count = output_html_threads - 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		workers[i].queue = manual_queue_get_context();
+		workers[i].folder = folder;
+		workers[i].encoding = encoding;
+		workers[i].line_end = line_end;
+		workers[i].result = false;
+		workers[i].msg = msg_create_context(true);
+		workers[i].started = (pthread_create(&(workers[i].thread), NULL, output_html_worker_thread, &(workers[i])) == 0) ? true : false;
+	}
+
+	/* While the workers are running, this thread's messages must be
+	 * collected alongside theirs so that they can all be reported in
+	 * the order of the files.
+	 */
+
+	if (count > 0) {
+		outer = msg_get_context();
+		msg = msg_create_context(true);
+
+		if (msg != NULL)
+			msg_select_context(msg);
+	}
+
+	result = output_html_write_queue(folder, single_file, msg != NULL);
+
+	if (msg != NULL) {
+		msg_select_context(outer);
+		msg_destroy_context(msg);
+	}
+
+	for (i = 0; i < count; i++) {
+		if (workers[i].started) {
+			pthread_join(workers[i].thread, NULL);
+
+			if (!workers[i].result)
+				result = false;
+		}
+
+		msg_destroy_context(workers[i].msg);
+	}
+
+	free(workers);
+
+	msg_flush();
+
+	/* Index the manual once all of its pages are in place. */
+
+	if (result && output_html_search_index && !single_file && !output_html_write_search_index(manual, folder))
+		result = false;
+
+	filename_destroy(output_html_shared_stylesheet);
+	output_html_shared_stylesheet = NULL;
+
+	if (output_html_archive != NULL) {
+		if (!output_archive_close(output_html_archive)) {
+			msg_report(MSG_WRITE_FAILED);
+			result = false;
+		}
+
+		output_html_archive = NULL;
+	}
+
+	return result;
+}
+
+/**
+ * Write the default stylesheet out to a file in the root of the output
+ * folder, so that it can be shared by all of the pages in the manual.
+ *
+ * \param *folder	The folder into which to write the manual.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_write_shared_stylesheet(struct filename *folder)
+{
+	struct filename *filename = NULL;
+	int line;
+
+	output_html_shared_stylesheet = filename_make(OUTPUT_HTML_SHARED_STYLESHEET_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
+	if (output_html_shared_stylesheet == NULL) {
+		msg_report(MSG_OUTPUT_FILENAME_NO_MEM);
+		return false;
+	}
+
+	/* Files in an archive are named relative to its root. */
+
+	if (output_html_archive != NULL)
+		filename = filename_make(OUTPUT_HTML_SHARED_STYLESHEET_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
+	else
+		filename = filename_join(folder, output_html_shared_stylesheet);
+	if (filename == NULL) {
+		msg_report(MSG_OUTPUT_FILENAME_NO_MEM);
+		return false;
+	}
+
+	if (!output_html_open_file(filename)) {
+		filename_destroy(filename);
+		return false;
+	}
+
+	for (line = 0; output_html_default_stylesheet[line] != NULL; line++) {
+		if (!output_html_file_write_plain("%s", output_html_default_stylesheet[line]) || !output_html_file_write_newline()) {
+			output_html_file_close();
+			filename_destroy(filename);
+			return false;
+		}
+	}
+
+	output_html_file_close();
+
+	if (output_html_archive == NULL && !filename_set_type(filename, FILENAME_FILETYPE_CSS)) {
+		filename_destroy(filename);
+		return false;
+	}
+
+	filename_destroy(filename);
+
+	return true;
+}
+
+/**
+ * Open an archive to pack the files of a manual into, creating the folder
+ * which is to hold it.
+ *
+ * \param *archive	The name of the archive file.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_open_archive(struct filename *archive)
+{
+	struct filename *foldername = NULL;
+
+	foldername = filename_up(archive, 1);
+	if (foldername == NULL)
+		return false;
+
+	if (!filename_mkdir(foldername, true)) {
+		filename_destroy(foldername);
+		return false;
+	}
+
+	filename_destroy(foldername);
+
+	output_html_archive = output_archive_open(archive);
+
+	return (output_html_archive != NULL) ? true : false;
+}
+
+/**
+ * Open an output file, either creating the folder to hold it on disc
+ * or, if the files are being packed, as a member of the archive.
+ *
+ * \param *filename	The name of the file to open.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_open_file(struct filename *filename)
+{
+	struct filename *foldername = NULL;
+
+	if (output_html_archive != NULL)
+		return output_html_file_open_member(output_html_archive, filename);
+
+	/* Create the folder and open the file. */
+
+	foldername = filename_up(filename, 1);
+	if (foldername == NULL)
+		return false;
+
+	if (!filename_mkdir(foldername, true)) {
+		filename_destroy(foldername);
+		return false;
+	}
+
+	filename_destroy(foldername);
+
+	return output_html_file_open(filename);
+}
+
+/**
+ * Build a search index for a manual, and write it out to a file in the
+ * root of the output folder or archive.
+ *
+ * \param *manual	The manual to index.
+ * \param *folder	The folder into which to write the manual.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_write_search_index(struct manual_data *manual, struct filename *folder)
+{
+	struct output_search	*search = NULL;
+	struct filename		*leaf = NULL, *filename = NULL;
+	struct output_file	*file = NULL;
+	void			*data = NULL;
+	size_t			length;
+	bool			success;
+
+	search = output_search_create();
+	if (search == NULL) {
+		msg_report(MSG_SEARCH_NO_MEM);
+		return false;
+	}
+
+	if (!output_search_add_manual(search, manual, output_html_links, MODES_TYPE_HTML)) {
+		msg_report(MSG_SEARCH_NO_MEM);
+		output_search_destroy(search);
+		return false;
+	}
+
+	leaf = filename_make(OUTPUT_HTML_SEARCH_INDEX_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
+	if (leaf == NULL) {
+		msg_report(MSG_OUTPUT_FILENAME_NO_MEM);
+		output_search_destroy(search);
+		return false;
+	}
+
+	/* The index is added to the archive if there is one, or written
+	 * straight into the folder beside the root page.
+	 */
+
+	if (output_html_archive != NULL) {
+		file = output_file_open_memory();
+
+		success = (file != NULL && output_search_write(search, file)) ? true : false;
+
+		if (file != NULL && !output_file_close_memory(file, &data, &length))
+			success = false;
+
+		if (success)
+			success = output_archive_add(output_html_archive, leaf, data, length);
+
+		free(data);
+	} else {
+		filename = filename_join(folder, leaf);
+
+		file = (filename != NULL) ? output_file_open(filename) : NULL;
+
+		success = (file != NULL && output_search_write(search, file)) ? true : false;
+
+		if (file != NULL && !output_file_close(file))
+			success = false;
+
+		if (success && !filename_set_type(filename, FILENAME_FILETYPE_DATA))
+			success = false;
+
+		filename_destroy(filename);
+	}
+
+	if (!success)
+		msg_report(MSG_WRITE_FAILED);
+
+	filename_destroy(leaf);
+	output_search_destroy(search);
+
+	return success;
+}
+
+/**
+ * Write files claimed from a manual queue shared with other threads,
+ * giving the thread encoding and writer contexts of its own alongside
+ * the message context created for it.
+ *
+ * \param *data		Pointer to the worker's details.
+ * \return		NULL.
+ */
+
+static void *output_html_worker_thread(void *data)
+{
+	struct output_html_worker	*worker = data;
+	struct msg_context		*msg = worker->msg;
+	struct encoding_context		*encoding = NULL;
+	struct output_html_file_context	*file = NULL;
+
+	encoding = encoding_create_context();
+	file = output_html_file_create_context();
+
+	if (msg == NULL || encoding == NULL || file == NULL) {
+		msg_report(MSG_UNKNOWN_MEM_ERROR);
+		worker->result = false;
+	} else {
+		msg_select_context(msg);
+		encoding_select_context(encoding);
+		output_html_file_select_context(file);
+		manual_queue_select_context(worker->queue);
+
+		encoding_select_table(worker->encoding);
+		encoding_select_line_end(worker->line_end);
+
+		worker->result = output_html_write_queue(worker->folder, false, true);
+
+		msg_select_context(NULL);
+		encoding_select_context(NULL);
+		output_html_file_select_context(NULL);
+		manual_queue_select_context(NULL);
+	}
+
+	encoding_destroy_context(encoding);
+	output_html_file_destroy_context(file);
+
+	return NULL;
+}
+
+/**
+ * Write the files held in the manual queue, until none remain.
+ *
+ * \param *folder	The folder into which to write the manual.
+ * \param single_file	TRUE if the output is intended to go into a single file.
+ * \param shared	TRUE if the queue is shared with other threads, whose
+ *			messages are collected in the order of the files.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_write_queue(struct filename *folder, bool single_file, bool shared)
+{
+	struct manual_data *object;
+
 	do {
 		object = manual_queue_remove_node();
 		if (object == NULL)
 			continue;
 
-		if (!output_html_write_file(object, folder, single_file))
+		if (shared)
+			msg_set_order(manual_queue_get_position());
+
+		if (!output_html_write_file(object, folder, single_file)) {
+			manual_queue_complete_node(false);
 			return false;
+		}
+
+		manual_queue_complete_node(true);
 	} while (object != NULL);
 
 	return true;
@@ -266,7 +814,7 @@ static bool output_html_write_manual(struct manual_data *manual, struct filename
 
 static bool output_html_write_file(struct manual_data *object, struct filename *folder, bool single_file)
 {
-	struct filename *filename = NULL, *foldername = NULL;
+	struct filename *filename = NULL;
 
 	if (object == NULL || object->first_child == NULL)
 		return true;
@@ -297,28 +845,23 @@ static bool output_html_write_file(struct manual_data *object, struct filename *
 	if (filename == NULL)
 		return false;
 
-	if (!filename_prepend(filename, folder, 0)) {
-		filename_destroy(filename);
-		return false;
-	}
+	/* Files in an archive are named relative to its root. */
 
-	foldername = filename_up(filename, 1);
-	if (foldername == NULL) {
+	if (output_html_archive == NULL && !filename_prepend(filename, folder, 0)) {
 		filename_destroy(filename);
 		return false;
 	}
 
-	/* Create the folder and open the file. */
+	/* If the file is up to date, only the files hanging off it need
+	 * to be considered.
+	 */
 
-	if (!filename_mkdir(foldername, true)) {
-		filename_destroy(foldername);
+	if (manifest_check_file(output_html_manifest, object, filename)) {
 		filename_destroy(filename);
-		return false;
+		return manual_queue_add_file_children(object, MODES_TYPE_HTML);
 	}
 
-	filename_destroy(foldername);
-
-	if (!output_html_file_open(filename)) {
+	if (!output_html_open_file(filename)) {
 		filename_destroy(filename);
 		return false;
 	}
@@ -351,7 +894,7 @@ static bool output_html_write_file(struct manual_data *object, struct filename *
 
 	output_html_file_close();
 
-	if (!filename_set_type(filename, FILENAME_FILETYPE_HTML)) {
+	if (output_html_archive == NULL && !filename_set_type(filename, FILENAME_FILETYPE_HTML)) {
 		filename_destroy(filename);
 		return false;
 	}
@@ -363,7 +906,8 @@ static bool output_html_write_file(struct manual_data *object, struct filename *
 
 
 /**
- * Process the contents of an index, chapter or section block and write it out.
+ * Process the contents of an index, chapter or section block and write it out,
+ * walking any nested sections without recursion.
  *
  * \param *object		The object to process.
  * \param level			The level to write the section at.
@@ -373,11 +917,43 @@ static bool output_html_write_file(struct manual_data *object, struct filename *
 
 static bool output_html_write_section_object(struct manual_data *object, int level, bool root)
 {
-	struct manual_data *block;
+	switch (output_html_enter_section_object(object, level, root)) {
+	case MANUAL_DATA_WALK_STOP:
+		return false;
+	case MANUAL_DATA_WALK_SKIP:
+		return true;
+	case MANUAL_DATA_WALK_DESCEND:
+		break;
+	}
+
+	if (!manual_data_walk(object->first_child, object, true, level, output_html_walk_section_enter, NULL, NULL))
+		return false;
+
+	/* If this is the file root, write the page footer out. */
+
+	if (root == true && !output_html_write_page_foot(object))
+		return false;
+
+	return true;
+}
+
+/**
+ * Start an index, chapter or section block, writing its heading. If the
+ * block is to be written to a separate file, it is queued for writing
+ * later and a reference is written in its place.
+ *
+ * \param *object		The object to process.
+ * \param level			The level to write the section at.
+ * \param root			True if the object is at the root of a file.
+ * \return			The action to take with the object's contents.
+ */
+
+static enum manual_data_walk_action output_html_enter_section_object(struct manual_data *object, int level, bool root)
+{
 	struct manual_data_mode *resources = NULL;
 
 	if (object == NULL || object->first_child == NULL)
-		return true;
+		return MANUAL_DATA_WALK_SKIP;
 
 	/* Confirm that this is a suitable object. */
 
@@ -390,7 +966,7 @@ static bool output_html_write_section_object(struct manual_data *object, int lev
 	default:
 		msg_report(MSG_UNEXPECTED_BLOCK, manual_data_find_object_name(MANUAL_DATA_OBJECT_TYPE_SECTION),
 				manual_data_find_object_name(object->type));
-		return false;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	resources = modes_find_resources(object->chapter.resources, MODES_TYPE_HTML);
@@ -399,7 +975,7 @@ static bool output_html_write_section_object(struct manual_data *object, int lev
 
 	if (level > OUTPUT_HTML_MAX_NEST_DEPTH) {
 		msg_report(MSG_TOO_DEEP, level);
-		return false;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* Write out the object heading. At the top of the file, this is
@@ -408,162 +984,186 @@ static bool output_html_write_section_object(struct manual_data *object, int lev
 
 	if (root == true) {
 		if (!output_html_write_page_head(object, level))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 	} else if (object->title != NULL) {
 		if (!output_html_file_write_newline())
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_write_heading(object, level))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_file_write_newline())
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* If this is a separate file, queue it for writing later. Otherwise,
-	 * write the objects which fall within it.
+	 * the objects which fall within it must be written.
 	 */
 
 	if (resources != NULL && !root && (resources->filename != NULL || resources->folder != NULL)) {
 		if (object->chapter.resources->summary != NULL &&
 				!output_html_write_paragraph(object->chapter.resources->summary))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_file_write_newline())
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_file_write_plain("<p>"))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_write_reference(object->parent, object, "This is a link to an external file..."))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_file_write_plain("</p>"))
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		if (!output_html_file_write_newline())
-			return false;
+			return MANUAL_DATA_WALK_STOP;
 
 		manual_queue_add_node(object);
-	} else {
-		block = object->first_child;
-
-		/* If changing this switch, note the analogous list in
-		 * output_html_write_block_collection_object() which
-		 * covers similar block level objects.
-		 */
-
-		while (block != NULL) {
-			switch (block->type) {
-			case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-			case MANUAL_DATA_OBJECT_TYPE_INDEX:
-			case MANUAL_DATA_OBJECT_TYPE_SECTION:
-				if (!output_html_write_section_object(block, manual_data_get_nesting_level(block, level), false))
-					return false;
-				break;
 
-			case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
-				if (object->type == MANUAL_DATA_OBJECT_TYPE_MANUAL) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		return MANUAL_DATA_WALK_SKIP;
+	}
 
-				/* The chapter list is treated like a section, so we always bump the level. */
+	return MANUAL_DATA_WALK_DESCEND;
+}
 
-				if (!output_html_write_chapter_list(block, manual_data_get_nesting_level(block, level)))
-					return false;
-				break;
+/**
+ * Enter one of the blocks within an index, chapter or section block,
+ * during a walk of the object's contents.
+ *
+ * \param *frame		The walk frame for the block.
+ * \param *data			Unused.
+ * \return			The action for the walk to take.
+ */
 
-			case MANUAL_DATA_OBJECT_TYPE_PARAGRAPH:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+static enum manual_data_walk_action output_html_walk_section_enter(struct manual_data_walk_frame *frame, void *data)
+{
+	switch (frame->node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		frame->level = manual_data_get_nesting_level(frame->node, frame->level);
+		return output_html_enter_section_object(frame->node, frame->level, false);
+
+	default:
+		if (!output_html_write_section_block(frame->parent, frame->node, frame->level))
+			return MANUAL_DATA_WALK_STOP;
+		return MANUAL_DATA_WALK_SKIP;
+	}
+}
+
+/**
+ * Write out one of the blocks within an index, chapter or section block,
+ * other than a nested section.
+ *
+ * \param *object		The object containing the block.
+ * \param *block		The block to write out.
+ * \param level			The level of the object.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_html_write_section_block(struct manual_data *object, struct manual_data *block, int level)
+{
+	/* If changing this switch, note the analogous list in
+	 * output_html_write_block_collection_object() which
+	 * covers similar block level objects.
+	 */
+
+	switch (block->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
+		if (object->type == MANUAL_DATA_OBJECT_TYPE_MANUAL) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-				if (!output_html_write_paragraph(block))
-					return false;
-				break;
+		/* The chapter list is treated like a section, so we always bump the level. */
 
-			case MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST:
-			case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_html_write_chapter_list(block, manual_data_get_nesting_level(block, level)))
+			return false;
+		break;
 
-				if (!output_html_write_list(block))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_PARAGRAPH:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_TABLE:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_html_write_paragraph(block))
+			return false;
+		break;
 
-				if (!output_html_write_table(block))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST:
+	case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_CALLOUT:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_html_write_list(block))
+			return false;
+		break;
 
-				if (!output_html_write_callout(block))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_html_write_table(block))
+			return false;
+		break;
 
-				if (!output_html_write_code_block(block))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_CALLOUT:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_html_write_callout(block))
+			return false;
+		break;
 
-				if (!output_html_write_footnote(block))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			default:
-				msg_report(MSG_UNEXPECTED_CHUNK,
-						manual_data_find_object_name(block->type),
-						manual_data_find_object_name(object->type));
-				break;
-			}
+		if (!output_html_write_code_block(block))
+			return false;
+		break;
 
-			block = block->next;
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
 		}
-	}
 
-	/* If this is the file root, write the page footer out. */
+		if (!output_html_write_footnote(block))
+			return false;
+		break;
 
-	if (root == true && !output_html_write_page_foot(object))
-		return false;
+	default:
+		msg_report(MSG_UNEXPECTED_CHUNK,
+				manual_data_find_object_name(block->type),
+				manual_data_find_object_name(object->type));
+		break;
+	}
 
 	return true;
 }
@@ -720,12 +1320,22 @@ static bool output_html_write_stylesheet_link(struct manual_data *manual)
 	if (manual == NULL)
 		return false;
 
-	/* Find the nearest stylesheet details. If there isn't one, write the default
-	 * sheet and exit. 
+	/* Find the nearest stylesheet details. If there isn't one, link to the
+	 * shared default sheet if there is one, or else write the default
+	 * sheet and exit.
 	 */
 
 	sheet_node = manual_data_get_node_stylesheet(manual, MODES_TYPE_HTML);
-	if (sheet_node == NULL) {
+	if (sheet_node == NULL && output_html_shared_stylesheet != NULL) {
+		sourcename = manual_data_get_node_filename(manual, output_html_root_filename, MODES_TYPE_HTML);
+		if (sourcename == NULL)
+			return false;
+
+		sheetname = filename_get_relative(sourcename, output_html_shared_stylesheet);
+		filename_destroy(sourcename);
+		if (sheetname == NULL)
+			return false;
+	} else if (sheet_node == NULL) {
 		if (!output_html_file_write_plain("<style>") || !output_html_file_write_newline())
 			return false;
 
@@ -738,15 +1348,15 @@ static bool output_html_write_stylesheet_link(struct manual_data *manual)
 			return false;
 
 		return true;
+	} else {
+		sheetname = filename_up(sheet_node->chapter.resources->html.stylesheet, 0);
+		if (sheetname == NULL)
+			return false;
 	}
 
-	sheetname = filename_up(sheet_node->chapter.resources->html.stylesheet, 0);
-	if (sheetname == NULL)
-		return false;
-
 	/* If the two nodes are not in the same file, get a relative filename. */
 
-	if (manual_data_nodes_share_file(manual, sheet_node, MODES_TYPE_HTML) == false) {
+	if (sheet_node != NULL && manual_data_nodes_share_file(manual, sheet_node, MODES_TYPE_HTML) == false) {
 		sourcename = manual_data_get_node_filename(manual, output_html_root_filename, MODES_TYPE_HTML);
 		if (sourcename == NULL)
 			return false;
@@ -920,8 +1530,8 @@ static bool output_html_write_heading(struct manual_data *node, int level)
 
 static bool output_html_write_chapter_list(struct manual_data *object, int level)
 {
-	struct manual_data *entry = NULL;
-	bool first = true;
+	struct manual_contents_entry	*entries = NULL;
+	size_t				count = 0, i;
 
 	/* The parent object is in the chain to be listed, so we need to
 	 * go up again to its parent and then down to the first child in
@@ -931,57 +1541,76 @@ static bool output_html_write_chapter_list(struct manual_data *object, int level
 	if (object == NULL || object->parent == NULL || object->parent->parent == NULL)
 		return false;
 
-	/* Output the list. */
-
-	entry = object->parent->parent->first_child;
+	if (!manual_contents_get_list(output_html_contents, object->parent->parent, &entries, &count))
+		return false;
 
-	while (entry != NULL) {
-		switch (entry->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			if (entry->title != NULL) {
-				if (first == true) {
-					if (!output_html_file_write_newline())
-						return false;
-					
-					if (!output_html_file_write_plain("<ul class=\"contents-list\">") || !output_html_file_write_newline())
-						return false;
+	if (count == 0)
+		return true;
 
-					first = false;
-				}
+	/* Output the list. */
 
-				if (!output_html_file_write_plain("<li>"))
-					return false;
+	if (!output_html_file_write_newline())
+		return false;
 
-				if (entry->chapter.id != NULL && !output_html_write_local_anchor(object, entry))
-					return false;
+	if (!output_html_file_write_plain("<ul class=\"contents-list\">") || !output_html_file_write_newline())
+		return false;
 
-				if (!output_html_write_title(entry, false, true))
-					return false;
+	for (i = 0; i < count; i++) {
+		if (!output_html_file_write_plain("<li>"))
+			return false;
 
-				if (entry->chapter.id != NULL && !output_html_file_write_plain("</a>"))
-					return false;
+		if (entries[i].node->chapter.id != NULL && !output_html_write_local_anchor(object, entries[i].node))
+			return false;
 
-				if (!output_html_file_write_plain("</li>") || !output_html_file_write_newline())
-					return false;
-			}
-			break;
+		if (!output_html_file_write_data(entries[i].title, entries[i].length))
+			return false;
 
-		default:
-			break;
-		}
+		if (entries[i].node->chapter.id != NULL && !output_html_file_write_plain("</a>"))
+			return false;
 
-		entry = entry->next;
+		if (!output_html_file_write_plain("</li>") || !output_html_file_write_newline())
+			return false;
 	}
 
-	/* Close the list if we need to, and we're done. */
+	/* Close the list, and we're done. */
 
-	if (first == false && (!output_html_file_write_plain("</ul>") || !output_html_file_write_newline()))
+	if (!output_html_file_write_plain("</ul>") || !output_html_file_write_newline())
 		return false;
 
 	return true;
 }
 
+/**
+ * Render the title of an entry in a chapter list, for the contents list
+ * cache to hold.
+ *
+ * \param *node		The node whose title is to be rendered.
+ * \param **title	Pointer to a variable to take a pointer to the
+ *			rendered title.
+ * \param *length	Pointer to a variable to take the title length.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+static bool output_html_render_chapter_list_title(struct manual_data *node, void **title, size_t *length)
+{
+	bool success;
+
+	if (!output_html_file_open_capture())
+		return false;
+
+	success = output_html_write_title(node, false, true);
+
+	if (!output_html_file_close_capture(title, length))
+		return false;
+
+	if (!success) {
+		free(*title);
+		*title = NULL;
+	}
+
+	return success;
+}
+
 /**
  * Process the contents of a block collection and write it out.
  * A block collection must be nested within a parent block object
@@ -1127,12 +1756,8 @@ static bool output_html_write_footnote(struct manual_data *object)
 	if (number == NULL)
 		return false;
 
-	if (!output_html_file_write_text(number)) {
-		free(number);
+	if (!output_html_file_write_text(number))
 		return false;
-	}
-
-	free(number);
 
 	if (!output_html_file_write_plain("</dt>"))
 		return false;
@@ -1190,7 +1815,7 @@ static bool output_html_write_callout(struct manual_data *object)
 		return false;
 	}
 
-	switch (object->chunk.flags & MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE) {
+	switch (object->flags & MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE) {
 	case MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ATTENTION:
 		type_style = " attention";
 		break;
@@ -1382,12 +2007,35 @@ static bool output_html_write_list(struct manual_data *object)
 
 /**
  * Process the contents of a table and write it out.
+ * The call is profiled, if profiling has been built in.
  *
  * \param *object		The object to process.
  * \return			True if successful; False on error.
  */
 
 static bool output_html_write_table(struct manual_data *object)
+{
+	bool result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = output_html_write_table_contents(object);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_HTML_TABLE, (object != NULL) ? object->type : MANUAL_DATA_OBJECT_TYPE_NONE);
+
+	return result;
+}
+
+/**
+ * Carry out the work of output_html_write_table(), which calls this so that it
+ * can be profiled.
+ *
+ * \param *object		The object to process.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_html_write_table_contents(struct manual_data *object)
 {
 	struct manual_data *column_set, *column, *row;
 
@@ -1654,45 +2302,20 @@ static bool output_html_write_paragraph(struct manual_data *object)
 
 static bool output_html_write_reference(struct manual_data *source, struct manual_data *target, char *text)
 {
-	struct filename *sourcename = NULL, *targetname = NULL, *filename = NULL;
 	char *link = NULL;
 
 	if (source == NULL || target == NULL)
 		return false;
 
-	sourcename = manual_data_get_node_filename(source, output_html_root_filename, MODES_TYPE_HTML);
-	if (sourcename == NULL)
-		return false;
-
-	targetname = manual_data_get_node_filename(target, output_html_root_filename, MODES_TYPE_HTML);
-	if (targetname == NULL) {
-		filename_destroy(sourcename);
-		return false;
-	}
-
-	filename = filename_get_relative(sourcename, targetname);
-	filename_destroy(sourcename);
-	filename_destroy(targetname);
-	if (filename == NULL)
-		return false;
-
-	link = filename_convert(filename, FILENAME_PLATFORM_LINUX, 0);
-	filename_destroy(filename);
-
+	link = manual_links_get_relative(output_html_links, source, target);
 	if (link == NULL)
 		return false;
 
-	if (!output_html_file_write_plain("<a href=\"")) {
-		free(link);
+	if (!output_html_file_write_plain("<a href=\""))
 		return false;
-	}
 
-	if (text != NULL && !output_html_file_write_text(link)) {
-		free(link);
+	if (text != NULL && !output_html_file_write_text(link))
 		return false;
-	}
-
-	free(link);
 
 	if (text != NULL && !output_html_file_write_plain("\">"))
 		return false;
@@ -1708,6 +2331,7 @@ static bool output_html_write_reference(struct manual_data *source, struct manua
 
 /**
  * Write a block of text to the output file.
+ * The call is profiled, if profiling has been built in.
  *
  * \param type			The type of block which is expected.
  * \param *text			The block of text to be written.
@@ -1715,8 +2339,32 @@ static bool output_html_write_reference(struct manual_data *source, struct manua
  */
 
 static bool output_html_write_text(enum manual_data_object_type type, struct manual_data *text)
+{
+	bool result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = output_html_write_text_contents(type, text);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_HTML_TEXT, type);
+
+	return result;
+}
+
+/**
+ * Carry out the work of output_html_write_text(), which calls this so that it
+ * can be profiled.
+ *
+ * \param type			The type of block which is expected.
+ * \param *text			The block of text to be written.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_html_write_text_contents(enum manual_data_object_type type, struct manual_data *text)
 {
 	struct manual_data *chunk;
+	struct output_render_span *span;
 	bool success = true;
 
 	/* An empty block doesn't require any output. */
@@ -1733,94 +2381,42 @@ static bool output_html_write_text(enum manual_data_object_type type, struct man
 
 	while (success == true && chunk != NULL) {
 		switch (chunk->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CITATION:
-			success = output_html_write_span_tag(MANUAL_DATA_OBJECT_TYPE_CITATION, "cite", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CODE:
-			success = output_html_write_span_tag(MANUAL_DATA_OBJECT_TYPE_CODE, "code", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_COMMAND:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_COMMAND, "command", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CONSTANT:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_CONSTANT, "code", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_EVENT:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_EVENT, "name", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FILENAME:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_FILENAME, "filename", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FUNCTION:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_FUNCTION, "code", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_ICON:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_ICON, "icon", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_INTRO:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_INTRO, "introduction", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEY:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_KEY, "key", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEYWORD:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_KEYWORD, "keyword", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS:
-			success = output_html_write_span_tag(MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS, "em", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LINK:
-			success = output_html_write_inline_link(chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MATHS:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_MATHS, "maths", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MENU:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_MENU, "menu", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MESSAGE:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_MESSAGE, "name", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MOUSE:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_MOUSE, "mouse", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_NAME:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_NAME, "name", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
-			success = output_html_write_inline_reference(chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS:
-			success = output_html_write_span_tag(MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS, "strong", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_SWI:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_SWI, "name", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_TYPE:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_TYPE, "name", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_USER_ENTRY:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_USER_ENTRY, "entry", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_VARIABLE:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_VARIABLE, "variable", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_WINDOW:
-			success = output_html_write_span_style(MANUAL_DATA_OBJECT_TYPE_WINDOW, "window", chunk);
-			break;
 		case MANUAL_DATA_OBJECT_TYPE_LINE_BREAK:
 			success = (output_html_file_write_plain("<br>") && output_html_file_write_newline());
 			break;
 		case MANUAL_DATA_OBJECT_TYPE_TEXT:
-			success = output_html_file_write_text(chunk->chunk.text);
+			success = output_html_file_write_chunk(chunk);
 			break;
 		case MANUAL_DATA_OBJECT_TYPE_ENTITY:
 			success = output_html_write_entity(chunk->chunk.entity);
 			break;
 		default:
-			msg_report(MSG_UNEXPECTED_CHUNK,
-					manual_data_find_object_name(chunk->type),
-					manual_data_find_object_name(text->type));
+			/* Anything else must be one of the inline spans. */
+
+			span = output_render_find_span(output_html_spans, chunk->type);
+
+			switch ((span != NULL) ? span->style : OUTPUT_RENDER_SPAN_NONE) {
+			case OUTPUT_RENDER_SPAN_PLAIN:
+				success = output_html_write_text(chunk->type, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_WRAP:
+				success = output_html_write_span_tag(chunk->type, span->decoration, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_CLASS:
+				success = output_html_write_span_style(chunk->type, span->decoration, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_LINK:
+				success = output_html_write_inline_link(chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_REFERENCE:
+				success = output_html_write_inline_reference(chunk);
+				break;
+			default:
+				msg_report(MSG_UNEXPECTED_CHUNK,
+						manual_data_find_object_name(chunk->type),
+						manual_data_find_object_name(text->type));
+				break;
+			}
 			break;
 		}
 
@@ -1914,7 +2510,7 @@ static bool output_html_write_inline_link(struct manual_data *link)
 	if (link->chunk.link != NULL && !output_html_file_write_plain("\""))
 		return false;
 
-	if ((link->chunk.flags & MANUAL_DATA_OBJECT_FLAGS_LINK_EXTERNAL) && !output_html_file_write_plain(" class=\"external\""))
+	if ((link->flags & MANUAL_DATA_OBJECT_FLAGS_LINK_EXTERNAL) && !output_html_file_write_plain(" class=\"external\""))
 		return false;
 
 	if (link->chunk.link != NULL && !output_html_file_write_plain(">"))
@@ -1965,7 +2561,7 @@ static bool output_html_write_inline_reference(struct manual_data *reference)
 
 	/* Find the target object. */
 
-	target = manual_ids_find_node(reference);
+	target = reference->chunk.target;
 
 	/* If the target is a footnote, write the body text out now. */
 
@@ -1992,12 +2588,8 @@ static bool output_html_write_inline_reference(struct manual_data *reference)
 		if (number == NULL)
 			return false;
 
-		if (!output_html_file_write_text(number)) {
-			free(number);
+		if (!output_html_file_write_text(number))
 			return false;
-		}
-
-		free(number);
 
 		if (!output_html_file_write_plain("</sup>"))
 			return false;
@@ -2036,7 +2628,6 @@ static bool output_html_write_inline_reference(struct manual_data *reference)
 
 static bool output_html_write_local_anchor(struct manual_data *source, struct manual_data *target)
 {
-	struct filename *sourcename = NULL, *targetname = NULL, *filename = NULL;
 	char *link = NULL;
 
 	if (source == NULL || target == NULL)
@@ -2045,36 +2636,17 @@ static bool output_html_write_local_anchor(struct manual_data *source, struct ma
 	/* Establish the relative link, if external. */
 
 	if (manual_data_nodes_share_file(source, target, MODES_TYPE_HTML) == false) {
-		sourcename = manual_data_get_node_filename(source, output_html_root_filename, MODES_TYPE_HTML);
-		if (sourcename == NULL)
-			return false;
-
-		targetname = manual_data_get_node_filename(target, output_html_root_filename, MODES_TYPE_HTML);
-		if (targetname == NULL) {
-			filename_destroy(sourcename);
-			return false;
-		}
-
-		filename = filename_get_relative(sourcename, targetname);
-		filename_destroy(sourcename);
-		filename_destroy(targetname);
-		if (filename == NULL)
+		link = manual_links_get_relative(output_html_links, source, target);
+		if (link == NULL)
 			return false;
-
-		link = filename_convert(filename, FILENAME_PLATFORM_LINUX, 0);
-		filename_destroy(filename);
 	}
 
 	/* Output the opening link tag. */
 
 	if (!output_html_file_write_plain("<a href=\"%s#%s\">",
 			(link == NULL) ? "" : link,
-			(target->chapter.id == NULL) ? "" : target->chapter.id)) {
-		free(link);
+			(target->chapter.id == NULL) ? "" : target->chapter.id))
 		return false;
-	}
-
-	free(link);
 
 	return true;
 }
@@ -2098,12 +2670,8 @@ static bool output_html_write_title(struct manual_data *node, bool include_name,
 	number = manual_data_get_node_number(node, include_name);
 
 	if (number != NULL) {
-		if (!output_html_file_write_text(number)) {
-			free(number);
+		if (!output_html_file_write_text(number))
 			return false;
-		}
-
-		free(number);
 
 		if (include_title && !output_html_file_write_text(" "))
 			return false;
@@ -35,6 +35,22 @@
 #include "filename.h"
 #include "manual.h"
 
+/**
+ * Initialise the HTML output engine.
+ *
+ * \param threads	The number of threads to use when writing a manual
+ *			which is split across multiple files.
+ * \param shared_css	True to write the default stylesheet to a file
+ *			of its own, when a manual is split across multiple
+ *			files, instead of embedding it in every page.
+ * \param pack		True to pack the files of a manual which is split
+ *			across multiple files into a single archive.
+ * \param search_index	True to write a search index alongside a manual
+ *			which is split across multiple files.
+ */
+
+void output_html_initialise(int threads, bool shared_css, bool pack, bool search_index);
+
 /**
  * Output a manual in HTML form.
  *
@@ -33,24 +33,142 @@
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "output_html_file.h"
 
 #include "encoding.h"
 #include "filename.h"
+#include "manual_encoded.h"
 #include "manual_entity.h"
 #include "msg.h"
+#include "output_archive.h"
+#include "output_file.h"
+
+/**
+ * A writer context, holding the output file for a thread.
+ */
+
+struct output_html_file_context {
+
+	/**
+	 * The output file handle.
+	 */
+
+	struct output_file	*handle;
+
+	/**
+	 * The archive which the file is to be added to when it is closed,
+	 * or NULL if it is being written directly to disc.
+	 */
+
+	struct output_archive	*archive;
+
+	/**
+	 * The name of the file within the archive, or NULL.
+	 */
+
+	struct filename		*member;
+
+	/**
+	 * The output file handle set aside while output is being captured
+	 * into memory, or NULL.
+	 */
+
+	struct output_file	*captured;
+};
 
 /* Global Variables. */
 
 /**
- * The output file handle.
+ * The writer context used by threads which haven't selected their own.
+ */
+
+static struct output_html_file_context output_html_file_default_context = {NULL, NULL, NULL, NULL};
+
+/**
+ * The key used to hold the writer context selected by each thread.
+ */
+
+static pthread_key_t output_html_file_context_key;
+
+/**
+ * Control for the one-time creation of the context key.
+ */
+
+static pthread_once_t output_html_file_context_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the context key was created successfully.
  */
-static FILE *output_html_file_handle = NULL;
+
+static bool output_html_file_context_key_valid = false;
 
 /* Static Function Prototypes. */
 
-static bool output_html_file_write_char(int unicode);
+static struct output_html_file_context *output_html_file_find_context(void);
+static void output_html_file_create_context_key(void);
+static bool output_html_file_write_char(struct output_html_file_context *context, int unicode);
+
+/**
+ * Create a new writer context, for use by a thread via
+ * output_html_file_select_context().
+ *
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct output_html_file_context *output_html_file_create_context(void)
+{
+	struct output_html_file_context *context;
+
+	context = malloc(sizeof(struct output_html_file_context));
+	if (context == NULL)
+		return NULL;
+
+	context->handle = NULL;
+	context->archive = NULL;
+	context->member = NULL;
+	context->captured = NULL;
+
+	return context;
+}
+
+/**
+ * Destroy a writer context. The context must not be selected by any
+ * thread at the time, and should not have a file open.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
+
+void output_html_file_destroy_context(struct output_html_file_context *context)
+{
+	if (context == NULL)
+		return;
+
+	if (context->handle != NULL)
+		output_file_close(context->handle);
+
+	free(context);
+}
+
+/**
+ * Select a writer context for the calling thread, so that files written
+ * by the thread are independent of any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool output_html_file_select_context(struct output_html_file_context *context)
+{
+	pthread_once(&output_html_file_context_once, output_html_file_create_context_key);
+
+	if (!output_html_file_context_key_valid)
+		return false;
+
+	return (pthread_setspecific(output_html_file_context_key, context) == 0) ? true : false;
+}
 
 /**
  * Open a file to write the HTML output to.
@@ -61,14 +179,44 @@ static bool output_html_file_write_char(int unicode);
 
 bool output_html_file_open(struct filename *filename)
 {
+	struct output_html_file_context *context = output_html_file_find_context();
+
 	if (filename == NULL)
 		return false;
 
-	output_html_file_handle = filename_fopen(filename, "w");
+	context->handle = output_file_open(filename);
+
+	if (context->handle == NULL)
+		return false;
+
+	return true;
+}
+
+/**
+ * Open a file to write the HTML output to, which will be added to an
+ * archive when it is closed. The filename must remain valid until then.
+ *
+ * \param *archive	Pointer to the archive to add the file to.
+ * \param *filename	Pointer to the name of the file, relative to the
+ *			root of the archive.
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_open_member(struct output_archive *archive, struct filename *filename)
+{
+	struct output_html_file_context *context = output_html_file_find_context();
+
+	if (archive == NULL || filename == NULL)
+		return false;
+
+	context->handle = output_file_open_memory();
 
-	if (output_html_file_handle == NULL)
+	if (context->handle == NULL)
 		return false;
 
+	context->archive = archive;
+	context->member = filename;
+
 	return true;
 }
 
@@ -78,11 +226,108 @@ bool output_html_file_open(struct filename *filename)
 
 void output_html_file_close(void)
 {
-	if (output_html_file_handle == NULL)
+	struct output_html_file_context	*context = output_html_file_find_context();
+	void				*data = NULL;
+	size_t				length;
+
+	if (context->handle == NULL)
 		return;
 
-	fclose(output_html_file_handle);
-	output_html_file_handle = NULL;
+	if (context->archive != NULL) {
+		if (!output_file_close_memory(context->handle, &data, &length) ||
+				!output_archive_add(context->archive, context->member, data, length))
+			msg_report(MSG_WRITE_FAILED);
+
+		free(data);
+	} else if (!output_file_close(context->handle)) {
+		msg_report(MSG_WRITE_FAILED);
+	}
+
+	context->handle = NULL;
+	context->archive = NULL;
+	context->member = NULL;
+}
+
+/**
+ * Start capturing the output written to the current HTML output file into
+ * memory, setting the file aside until the capture is closed.
+ *
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_open_capture(void)
+{
+	struct output_html_file_context *context = output_html_file_find_context();
+
+	if (context->handle == NULL || context->captured != NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	context->captured = context->handle;
+
+	context->handle = output_file_open_memory();
+	if (context->handle == NULL) {
+		context->handle = context->captured;
+		context->captured = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Stop capturing output into memory, and return to writing to the
+ * current HTML output file.
+ *
+ * \param **data	Pointer to a variable to take a pointer to the captured
+ *			data, which the caller must free().
+ * \param *length	Pointer to a variable to take the length of the data.
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_close_capture(void **data, size_t *length)
+{
+	struct output_html_file_context	*context = output_html_file_find_context();
+	bool				success;
+
+	if (context->captured == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	success = output_file_close_memory(context->handle, data, length);
+
+	context->handle = context->captured;
+	context->captured = NULL;
+
+	return success;
+}
+
+/**
+ * Write a block of data to the current HTML output file, without any
+ * conversion, as it was previously captured.
+ *
+ * \param *data		Pointer to the data to be written.
+ * \param length	The length of the data, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_html_file_write_data(void *data, size_t length)
+{
+	struct output_html_file_context *context = output_html_file_find_context();
+
+	if (context->handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	if (!output_file_write(context->handle, data, length)) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -95,26 +340,132 @@ void output_html_file_close(void)
 
 bool output_html_file_write_text(char *text)
 {
-	int c;
+	struct output_html_file_context	*context = output_html_file_find_context();
+	int				c;
+	size_t				length, run;
+	char				*start;
 
 	if (text == NULL)
 		return true;
 
-	if (output_html_file_handle == NULL) {
+	if (context->handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
 		return false;
 	}
 
-	do {
+	length = strlen(text);
+
+	while (length > 0) {
+		/* Copy any run of plain ASCII straight to the output. */
+
+		run = encoding_find_ascii_run(text, length, '\0');
+
+		if (run > 0) {
+			if (!output_file_write(context->handle, text, run)) {
+				msg_report(MSG_WRITE_FAILED);
+				return false;
+			}
+
+			text += run;
+			length -= run;
+			continue;
+		}
+
+		/* Anything else must be decoded and written individually. */
+
+		start = text;
 		c = encoding_parse_utf8_string(&text);
 
-		if (c != '\0' && !output_html_file_write_char(c))
+		if (c == '\0')
+			break;
+
+		if (!output_html_file_write_char(context, c))
 			return false;
-	} while (c != '\0');
+
+		length -= text - start;
+	}
 
 	return true;
 }
 
+/**
+ * Write the text of a TEXT chunk to the current HTML output file, in the
+ * currently selected encoding, using the encoded text cache if it is
+ * in use.
+ *
+ * \param *chunk	Pointer to the chunk to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_html_file_write_chunk(struct manual_data *chunk)
+{
+	struct output_html_file_context	*context = output_html_file_find_context();
+	struct output_file		*file;
+	enum encoding_target		target;
+	const char			*encoded;
+	void				*data = NULL;
+	size_t				length;
+	bool				success;
+
+	if (chunk == NULL || chunk->chunk.text == NULL)
+		return true;
+
+	if (context->handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	/* Plain ASCII can be copied straight out, so isn't worth caching. */
+
+	length = strlen(chunk->chunk.text);
+
+	if (!manual_encoded_active() || encoding_find_ascii_run(chunk->chunk.text, length, '\0') == length)
+		return output_html_file_write_text(chunk->chunk.text);
+
+	/* Copy the text out if it has already been encoded. */
+
+	target = encoding_get_current_target();
+
+	encoded = manual_encoded_find(chunk, MODES_TYPE_HTML, target, &length);
+	if (encoded != NULL) {
+		if (!output_file_write(context->handle, encoded, length)) {
+			msg_report(MSG_WRITE_FAILED);
+			return false;
+		}
+
+		return true;
+	}
+
+	/* Otherwise, encode the text into memory so that it can be kept. */
+
+	file = context->handle;
+
+	context->handle = output_file_open_memory();
+	if (context->handle == NULL) {
+		context->handle = file;
+		return output_html_file_write_text(chunk->chunk.text);
+	}
+
+	success = output_html_file_write_text(chunk->chunk.text);
+
+	if (!output_file_close_memory(context->handle, &data, &length))
+		success = false;
+
+	context->handle = file;
+
+	if (success && length > 0 && !output_file_write(context->handle, data, length)) {
+		msg_report(MSG_WRITE_FAILED);
+		success = false;
+	}
+
+	if (success)
+		manual_encoded_store(chunk, MODES_TYPE_HTML, target, data, length);
+
+	free(data);
+
+	return success;
+}
+
 /**
  * Write an ASCII string to the output.
  *
@@ -125,20 +476,21 @@ bool output_html_file_write_text(char *text)
 
 bool output_html_file_write_plain(char *text, ...)
 {
+	struct output_html_file_context *context = output_html_file_find_context();
 	va_list ap;
 	bool success = true;
 
 	if (text == NULL)
 		return true;
 
-	if (output_html_file_handle == NULL) {
+	if (context->handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
 		return false;
 	}
 
 	va_start(ap, text);
   
-	if (vfprintf(output_html_file_handle, text, ap) < 0) {
+	if (!output_file_write_format(context->handle, text, ap)) {
 		msg_report(MSG_WRITE_FAILED);
 		success = false;
 	}
@@ -156,9 +508,10 @@ bool output_html_file_write_plain(char *text, ...)
 
 bool output_html_file_write_newline(void)
 {
+	struct output_html_file_context *context = output_html_file_find_context();
 	const char *line_end = NULL;
 
-	if (output_html_file_handle == NULL) {
+	if (context->handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
 		return false;
 	}
@@ -169,7 +522,7 @@ bool output_html_file_write_newline(void)
 		return false;
 	}
 
-	if (fputs(line_end, output_html_file_handle) == EOF) {
+	if (!output_file_write_text(context->handle, line_end)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -181,16 +534,16 @@ bool output_html_file_write_newline(void)
  * Write a single unicode character to the output in the currently
  * selected encoding.
  *
- * \param *line		The line instance to work with.
+ * \param *context	The writer context to work with.
  * \param unicode	The unicode character to be written.
  * \return		True if successful; False on error.
  */
 
-static bool output_html_file_write_char(int unicode)
+static bool output_html_file_write_char(struct output_html_file_context *context, int unicode)
 {
 	char buffer[ENCODING_CHAR_BUF_LEN], *entity;
 
-	if (output_html_file_handle == NULL) {
+	if (context->handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
 		return false;
 	}
@@ -203,7 +556,7 @@ static bool output_html_file_write_char(int unicode)
 			return output_html_file_write_plain("&#%d;", unicode);
 	}
 
-	if (fputs(buffer, output_html_file_handle) == EOF) {
+	if (!output_file_write_text(context->handle, buffer)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -211,3 +564,29 @@ static bool output_html_file_write_char(int unicode)
 	return true;
 }
 
+/**
+ * Find the writer context for the calling thread.
+ *
+ * \return		Pointer to the thread's writer context.
+ */
+
+static struct output_html_file_context *output_html_file_find_context(void)
+{
+	struct output_html_file_context *context = NULL;
+
+	if (output_html_file_context_key_valid)
+		context = pthread_getspecific(output_html_file_context_key);
+
+	return (context != NULL) ? context : &output_html_file_default_context;
+}
+
+/**
+ * Create the key used to hold each thread's writer context, on behalf
+ * of pthread_once().
+ */
+
+static void output_html_file_create_context_key(void)
+{
+	if (pthread_key_create(&output_html_file_context_key, NULL) == 0)
+		output_html_file_context_key_valid = true;
+}
@@ -31,8 +31,46 @@
 #define XMLMAN_OUTPUT_HTML_FILE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "filename.h"
+#include "manual_data.h"
+#include "output_archive.h"
+
+/**
+ * A writer context, holding the output file for a thread.
+ */
+
+struct output_html_file_context;
+
+/**
+ * Create a new writer context, for use by a thread via
+ * output_html_file_select_context().
+ *
+ * \return		Pointer to the new context, or NULL on failure.
+ */
+
+struct output_html_file_context *output_html_file_create_context(void);
+
+/**
+ * Destroy a writer context. The context must not be selected by any
+ * thread at the time, and should not have a file open.
+ *
+ * \param *context	Pointer to the context to destroy.
+ */
+
+void output_html_file_destroy_context(struct output_html_file_context *context);
+
+/**
+ * Select a writer context for the calling thread, so that files written
+ * by the thread are independent of any others.
+ *
+ * \param *context	Pointer to the context to select, or NULL to
+ *			return to the default context.
+ * \return		True if successful; else false.
+ */
+
+bool output_html_file_select_context(struct output_html_file_context *context);
 
 /**
  * Open a file to write the HTML output to.
@@ -43,6 +81,18 @@
 
 bool output_html_file_open(struct filename *filename);
 
+/**
+ * Open a file to write the HTML output to, which will be added to an
+ * archive when it is closed. The filename must remain valid until then.
+ *
+ * \param *archive	Pointer to the archive to add the file to.
+ * \param *filename	Pointer to the name of the file, relative to the
+ *			root of the archive.
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_open_member(struct output_archive *archive, struct filename *filename);
+
 /**
  * Close the current HTML output file.
  */
@@ -50,6 +100,38 @@ bool output_html_file_open(struct filename *filename);
 void output_html_file_close(void);
 
 
+/**
+ * Start capturing the output written to the current HTML output file into
+ * memory, setting the file aside until the capture is closed.
+ *
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_open_capture(void);
+
+/**
+ * Stop capturing output into memory, and return to writing to the
+ * current HTML output file.
+ *
+ * \param **data	Pointer to a variable to take a pointer to the captured
+ *			data, which the caller must free().
+ * \param *length	Pointer to a variable to take the length of the data.
+ * \return		True on success; False on failure.
+ */
+
+bool output_html_file_close_capture(void **data, size_t *length);
+
+/**
+ * Write a block of data to the current HTML output file, without any
+ * conversion, as it was previously captured.
+ *
+ * \param *data		Pointer to the data to be written.
+ * \param length	The length of the data, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_html_file_write_data(void *data, size_t length);
+
 /**
  * Write a UTF8 string to the current HTML output file, in the currently
  * selected encoding.
@@ -60,6 +142,17 @@ void output_html_file_close(void);
 
 bool output_html_file_write_text(char *text);
 
+/**
+ * Write the text of a TEXT chunk to the current HTML output file, in the
+ * currently selected encoding, using the encoded text cache if it is
+ * in use.
+ *
+ * \param *chunk	Pointer to the chunk to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_html_file_write_chunk(struct manual_data *chunk);
+
 /**
  * Write an ASCII string to the output.
  *
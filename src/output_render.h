@@ -0,0 +1,109 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_render.h
+ *
+ * Output Renderer Core Interface.
+ *
+ * The output engines share a common description of how the inline spans
+ * within a block of text are rendered. Each engine supplies a table of
+ * the span types, in the order of the manual_data_object_type list,
+ * giving the style of each span and any decoration to use with it. The
+ * lookup is a macro, so that the engines can switch on the style and call
+ * their own primitives directly from their text loops.
+ */
+
+#ifndef XMLMAN_OUTPUT_RENDER_H
+#define XMLMAN_OUTPUT_RENDER_H
+
+#include <stddef.h>
+#include "xmlman.h"
+
+/**
+ * The first of the inline span object types.
+ */
+
+#define OUTPUT_RENDER_FIRST_SPAN MANUAL_DATA_OBJECT_TYPE_CITATION
+
+/**
+ * The last of the inline span object types.
+ */
+
+#define OUTPUT_RENDER_LAST_SPAN MANUAL_DATA_OBJECT_TYPE_WINDOW
+
+/**
+ * The ways in which an output engine can render an inline span.
+ */
+
+enum output_render_span_style {
+	OUTPUT_RENDER_SPAN_NONE,	/**< The object is not expected within text.			*/
+	OUTPUT_RENDER_SPAN_PLAIN,	/**< The span's contents are written without decoration.	*/
+	OUTPUT_RENDER_SPAN_WRAP,	/**< The contents are wrapped in the decoration, as a tag,	*/
+					/**< font or enclosing string, depending on the engine.		*/
+	OUTPUT_RENDER_SPAN_CLASS,	/**< The contents are marked with the decoration as a style.	*/
+	OUTPUT_RENDER_SPAN_LINK,	/**< The span is an external link.				*/
+	OUTPUT_RENDER_SPAN_REFERENCE	/**< The span is a reference to another node.			*/
+};
+
+/**
+ * The details of how an output engine renders an inline span type.
+ */
+
+struct output_render_span {
+	/**
+	 * The object type of the span.
+	 */
+
+	enum manual_data_object_type	type;
+
+	/**
+	 * The style in which to render the span.
+	 */
+
+	enum output_render_span_style	style;
+
+	/**
+	 * The decoration to use with the style, or NULL.
+	 */
+
+	char				*decoration;
+};
+
+/**
+ * Find the details of an inline span type within an output engine's
+ * span table. The table must hold an entry for every type from
+ * OUTPUT_RENDER_FIRST_SPAN to OUTPUT_RENDER_LAST_SPAN, in order; an
+ * entry which is out of sequence is treated as missing.
+ *
+ * \param spans		The output engine's span table.
+ * \param t		The object type to look up.
+ * \return		Pointer to the span details, or NULL if the type
+ *			is not an inline span.
+ */
+
+#define output_render_find_span(spans, t) \
+		(((t) >= OUTPUT_RENDER_FIRST_SPAN && (t) <= OUTPUT_RENDER_LAST_SPAN && \
+		(spans)[(t) - OUTPUT_RENDER_FIRST_SPAN].type == (t)) ? &((spans)[(t) - OUTPUT_RENDER_FIRST_SPAN]) : NULL)
+
+#endif
@@ -0,0 +1,844 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_search.c
+ *
+ * Search Index Output, implementation.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "output_search.h"
+
+#include "encoding.h"
+#include "manual_data.h"
+#include "manual_entity.h"
+#include "manual_links.h"
+#include "modes.h"
+#include "output_file.h"
+#include "string.h"
+
+/**
+ * The version of the index file format.
+ */
+
+#define OUTPUT_SEARCH_VERSION 1
+
+/**
+ * The initial number of slots in the term table; must be a power of two.
+ */
+
+#define OUTPUT_SEARCH_INITIAL_SIZE 1024
+
+/**
+ * The term table is grown once it becomes more than
+ * OUTPUT_SEARCH_LOAD_LIMIT / OUTPUT_SEARCH_LOAD_DIVISOR full.
+ */
+
+#define OUTPUT_SEARCH_LOAD_LIMIT 3
+#define OUTPUT_SEARCH_LOAD_DIVISOR 4
+
+/**
+ * The initial size of the growable arrays, in entries or bytes.
+ */
+
+#define OUTPUT_SEARCH_INITIAL_BLOCK 16
+
+/**
+ * The shortest and longest words which will be indexed, in bytes.
+ */
+
+#define OUTPUT_SEARCH_MIN_WORD 2
+#define OUTPUT_SEARCH_MAX_WORD 64
+
+/**
+ * The maximum length of an encoded varint, in bytes.
+ */
+
+#define OUTPUT_SEARCH_VARINT_LEN 10
+
+/**
+ * A reference from a term to a section in which it appears.
+ */
+
+struct output_search_posting {
+	unsigned int	section;	/**< The section containing the term.				*/
+	unsigned int	offset;		/**< The word offset of the term's first use in the section.	*/
+};
+
+/**
+ * A term in the index, which is a slot in the term table.
+ */
+
+struct output_search_term {
+	/**
+	 * The text of the term, or NULL if the slot is free.
+	 */
+
+	char				*text;
+
+	/**
+	 * The length of the term, in bytes.
+	 */
+
+	size_t				length;
+
+	/**
+	 * The sections in which the term appears.
+	 */
+
+	struct output_search_posting	*postings;
+
+	/**
+	 * The number of postings in use.
+	 */
+
+	size_t				count;
+
+	/**
+	 * The number of postings allocated.
+	 */
+
+	size_t				size;
+};
+
+/**
+ * A section in the index.
+ */
+
+struct output_search_section {
+	/**
+	 * The link to the section, relative to the root of the manual.
+	 */
+
+	char		*link;
+
+	/**
+	 * The title of the section, or NULL.
+	 */
+
+	char		*title;
+
+	/**
+	 * The number of words indexed in the section so far.
+	 */
+
+	unsigned int	words;
+};
+
+/**
+ * A search index instance.
+ */
+
+struct output_search {
+	/**
+	 * The term table, forming an open-addressed hash table.
+	 */
+
+	struct output_search_term	*terms;
+
+	/**
+	 * The number of slots in the term table; always a power of two.
+	 */
+
+	size_t				size;
+
+	/**
+	 * The number of terms in the table.
+	 */
+
+	size_t				count;
+
+	/**
+	 * The sections in the index.
+	 */
+
+	struct output_search_section	*sections;
+
+	/**
+	 * The number of sections in use.
+	 */
+
+	size_t				section_count;
+
+	/**
+	 * The number of sections allocated.
+	 */
+
+	size_t				section_size;
+};
+
+/**
+ * The details of a walk through a manual, while it is indexed.
+ */
+
+struct output_search_walk {
+	struct output_search	*search;	/**< The index being built.			*/
+	struct manual_data	*manual;	/**< The manual being indexed.			*/
+	struct manual_links	*links;		/**< The link cache for the output.		*/
+	enum modes_type		type;		/**< The output type being indexed.		*/
+};
+
+/**
+ * A growable block of text, used when collecting section titles.
+ */
+
+struct output_search_text {
+	char	*text;		/**< The text, which is always terminated once allocated.	*/
+	size_t	length;		/**< The length of the text, in bytes.				*/
+	size_t	size;		/**< The size of the allocated block, in bytes.			*/
+};
+
+/* Static Function Prototypes. */
+
+static enum manual_data_walk_action output_search_walk_enter(struct manual_data_walk_frame *frame, void *data);
+static enum manual_data_walk_action output_search_walk_title(struct manual_data_walk_frame *frame, void *data);
+static int output_search_add_section(struct output_search_walk *walk, struct manual_data *node);
+static bool output_search_add_text(struct output_search *search, int section, const char *text);
+static bool output_search_add_term(struct output_search *search, int section, const char *word, size_t length);
+static struct output_search_term *output_search_find_slot(struct output_search *search, const char *word, size_t length);
+static bool output_search_grow_table(struct output_search *search);
+static bool output_search_append_text(struct output_search_text *text, const char *add, size_t length);
+static int output_search_compare_terms(const void *a, const void *b);
+static int output_search_compare_postings(const void *a, const void *b);
+static bool output_search_write_number(struct output_file *file, uint64_t value);
+static bool output_search_write_string(struct output_file *file, const char *text, size_t length);
+
+/**
+ * Create a new, empty, search index.
+ *
+ * \return		Pointer to the new index, or NULL on failure.
+ */
+
+struct output_search *output_search_create(void)
+{
+	struct output_search *search;
+
+	search = malloc(sizeof(struct output_search));
+	if (search == NULL)
+		return NULL;
+
+	search->terms = calloc(OUTPUT_SEARCH_INITIAL_SIZE, sizeof(struct output_search_term));
+	if (search->terms == NULL) {
+		free(search);
+		return NULL;
+	}
+
+	search->size = OUTPUT_SEARCH_INITIAL_SIZE;
+	search->count = 0;
+
+	search->sections = NULL;
+	search->section_count = 0;
+	search->section_size = 0;
+
+	return search;
+}
+
+/**
+ * Destroy a search index, freeing all of the data held in it.
+ *
+ * \param *search	Pointer to the index to destroy.
+ */
+
+void output_search_destroy(struct output_search *search)
+{
+	size_t i;
+
+	if (search == NULL)
+		return;
+
+	for (i = 0; i < search->size; i++) {
+		free(search->terms[i].text);
+		free(search->terms[i].postings);
+	}
+
+	for (i = 0; i < search->section_count; i++) {
+		free(search->sections[i].link);
+		free(search->sections[i].title);
+	}
+
+	free(search->terms);
+	free(search->sections);
+	free(search);
+}
+
+/**
+ * Add the chapters, indexes and sections of a manual to a search index,
+ * along with the words which they contain.
+ *
+ * \param *search	Pointer to the index to add to.
+ * \param *manual	Pointer to the manual to be indexed.
+ * \param *links	Pointer to the link cache for the output.
+ * \param type		The output type for which the index is built.
+ * \return		True if successful; False on failure.
+ */
+
+bool output_search_add_manual(struct output_search *search, struct manual_data *manual, struct manual_links *links, enum modes_type type)
+{
+	struct output_search_walk walk;
+
+	if (search == NULL || manual == NULL || links == NULL)
+		return false;
+
+	walk.search = search;
+	walk.manual = manual;
+	walk.links = links;
+	walk.type = type;
+
+	/* The walk level holds the number of the section enclosing each
+	 * node, or -1 if none has been found yet.
+	 */
+
+	return manual_data_walk(manual, NULL, false, -1, output_search_walk_enter, NULL, &walk);
+}
+
+/**
+ * Write a search index out to a file.
+ *
+ * \param *search	Pointer to the index to write.
+ * \param *file		Pointer to the file to write the index to.
+ * \return		True if successful; False on failure.
+ */
+
+bool output_search_write(struct output_search *search, struct output_file *file)
+{
+	struct output_search_term	**terms, *term, *previous = NULL;
+	struct output_search_posting	*posting;
+	size_t				i, j, count, shared, last;
+	bool				success = true;
+
+	if (search == NULL || file == NULL)
+		return false;
+
+	/* Sort the terms, so that each can share a prefix with the last. */
+
+	terms = malloc(sizeof(struct output_search_term *) * ((search->count > 0) ? search->count : 1));
+	if (terms == NULL)
+		return false;
+
+	for (i = 0, count = 0; i < search->size; i++) {
+		if (search->terms[i].text != NULL)
+			terms[count++] = search->terms + i;
+	}
+
+	qsort(terms, count, sizeof(struct output_search_term *), output_search_compare_terms);
+
+	/* Write the file header and the section table. */
+
+	success = output_file_write(file, "XMSI", 4) && output_search_write_number(file, OUTPUT_SEARCH_VERSION) &&
+			output_search_write_number(file, search->section_count);
+
+	for (i = 0; success && i < search->section_count; i++) {
+		success = output_search_write_string(file, search->sections[i].link, strlen(search->sections[i].link)) &&
+				output_search_write_string(file, search->sections[i].title,
+				(search->sections[i].title != NULL) ? strlen(search->sections[i].title) : 0);
+	}
+
+	/* Write the terms, each followed by the sections containing it. */
+
+	if (success)
+		success = output_search_write_number(file, count);
+
+	for (i = 0; success && i < count; i++) {
+		term = terms[i];
+
+		for (shared = 0; previous != NULL && shared < previous->length && shared < term->length &&
+				previous->text[shared] == term->text[shared]; shared++);
+
+		success = output_search_write_number(file, shared) &&
+				output_search_write_string(file, term->text + shared, term->length - shared);
+
+		/* Text after a nested section returns to an earlier section, so
+		 * the postings must be sorted, keeping only the first use of the
+		 * term in each section.
+		 */
+
+		qsort(term->postings, term->count, sizeof(struct output_search_posting), output_search_compare_postings);
+
+		for (j = 0, last = 0; j < term->count; j++) {
+			if (last > 0 && term->postings[j].section == term->postings[last - 1].section)
+				continue;
+
+			term->postings[last++] = term->postings[j];
+		}
+
+		term->count = last;
+
+		if (success)
+			success = output_search_write_number(file, term->count);
+
+		for (j = 0, last = 0; success && j < term->count; j++) {
+			posting = term->postings + j;
+
+			success = output_search_write_number(file, posting->section - last) &&
+					output_search_write_number(file, posting->offset);
+
+			last = posting->section;
+		}
+
+		previous = term;
+	}
+
+	free(terms);
+
+	return success;
+}
+
+/**
+ * Process a node on entry during the indexing walk: sections start a new
+ * entry in the index, and text is added to the section enclosing it.
+ *
+ * \param *frame	The walk frame for the node.
+ * \param *data		The details of the walk.
+ * \return		The action for the walk to take.
+ */
+
+static enum manual_data_walk_action output_search_walk_enter(struct manual_data_walk_frame *frame, void *data)
+{
+	struct output_search_walk *walk = data;
+
+	switch (frame->node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		frame->level = output_search_add_section(walk, frame->node);
+		if (frame->level < 0)
+			return MANUAL_DATA_WALK_STOP;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		if (frame->level >= 0 && !output_search_add_text(walk->search, frame->level, frame->node->chunk.text))
+			return MANUAL_DATA_WALK_STOP;
+		return MANUAL_DATA_WALK_SKIP;
+
+	default:
+		break;
+	}
+
+	return MANUAL_DATA_WALK_DESCEND;
+}
+
+/**
+ * Collect the text of a title during a walk of its chunks.
+ *
+ * \param *frame	The walk frame for the node.
+ * \param *data		The text block collecting the title.
+ * \return		The action for the walk to take.
+ */
+
+static enum manual_data_walk_action output_search_walk_title(struct manual_data_walk_frame *frame, void *data)
+{
+	struct output_search_text	*title = data;
+	char				buffer[ENCODING_CHAR_BUF_LEN];
+	const char			*text = NULL;
+	int				length = 0;
+
+	switch (frame->node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_TEXT:
+		text = frame->node->chunk.text;
+		length = (text != NULL) ? strlen(text) : 0;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ENTITY:
+		length = encoding_write_utf8_character(buffer, ENCODING_CHAR_BUF_LEN,
+				manual_entity_find_codepoint(frame->node->chunk.entity));
+		text = buffer;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINE_BREAK:
+		text = " ";
+		length = 1;
+		break;
+
+	default:
+		return MANUAL_DATA_WALK_DESCEND;
+	}
+
+	if (length > 0 && !output_search_append_text(title, text, length))
+		return MANUAL_DATA_WALK_STOP;
+
+	return MANUAL_DATA_WALK_SKIP;
+}
+
+/**
+ * Add a new section to the index, recording its link and title, and
+ * indexing the words in its title.
+ *
+ * \param *walk		The details of the walk.
+ * \param *node		The node to add as a section.
+ * \return		The number of the new section, or -1 on failure.
+ */
+
+static int output_search_add_section(struct output_search_walk *walk, struct manual_data *node)
+{
+	struct output_search		*search = walk->search;
+	struct output_search_section	*sections, *section;
+	struct output_search_text	link = {NULL, 0, 0}, title = {NULL, 0, 0};
+	char				*file = NULL;
+	size_t				size;
+	int				number;
+
+	/* Make room for the new section. */
+
+	if (search->section_count >= search->section_size) {
+		size = (search->section_size > 0) ? search->section_size * 2 : OUTPUT_SEARCH_INITIAL_BLOCK;
+
+		sections = realloc(search->sections, sizeof(struct output_search_section) * size);
+		if (sections == NULL)
+			return -1;
+
+		search->sections = sections;
+		search->section_size = size;
+	}
+
+	/* Find the link to the section from the root file, which is
+	 * empty if the section is in the root file itself.
+	 */
+
+	if (!manual_data_nodes_share_file(walk->manual, node, walk->type)) {
+		file = manual_links_get_relative(walk->links, walk->manual, node);
+		if (file == NULL)
+			return -1;
+	}
+
+	if ((file != NULL && !output_search_append_text(&link, file, strlen(file))) ||
+			(node->chapter.id != NULL && (!output_search_append_text(&link, "#", 1) ||
+			!output_search_append_text(&link, node->chapter.id, strlen(node->chapter.id)))) ||
+			!output_search_append_text(&link, "", 0)) {
+		free(link.text);
+		return -1;
+	}
+
+	/* Collect the title. */
+
+	if (node->title != NULL && !manual_data_walk(node->title->first_child, node->title, true, 0, output_search_walk_title, NULL, &title)) {
+		free(link.text);
+		free(title.text);
+		return -1;
+	}
+
+	number = search->section_count++;
+
+	section = search->sections + number;
+	section->link = link.text;
+	section->title = title.text;
+	section->words = 0;
+
+	if (title.text != NULL && !output_search_add_text(search, number, title.text))
+		return -1;
+
+	return number;
+}
+
+/**
+ * Split a piece of text into words, and add each of them to the index
+ * against a section. Words are runs of ASCII letters and digits, along
+ * with any non-ASCII characters, and are indexed in lower case.
+ *
+ * \param *search	Pointer to the index to add to.
+ * \param section	The number of the section holding the text.
+ * \param *text		Pointer to the text to add.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_add_text(struct output_search *search, int section, const char *text)
+{
+	char	word[OUTPUT_SEARCH_MAX_WORD];
+	size_t	length = 0;
+	bool	overflow = false;
+	int	c;
+
+	if (text == NULL)
+		return true;
+
+	do {
+		c = (unsigned char) *text;
+
+		if (c >= 0x80 || isalnum(c)) {
+			if (length < OUTPUT_SEARCH_MAX_WORD)
+				word[length++] = tolower(c);
+			else
+				overflow = true;
+
+			continue;
+		}
+
+		/* Overlong words are dropped, as they're unlikely to be
+		 * searched for.
+		 */
+
+		if (length >= OUTPUT_SEARCH_MIN_WORD && !overflow && !output_search_add_term(search, section, word, length))
+			return false;
+
+		if (length > 0)
+			search->sections[section].words++;
+
+		length = 0;
+		overflow = false;
+	} while (*text++ != '\0');
+
+	return true;
+}
+
+/**
+ * Add a word to the index against a section.
+ *
+ * \param *search	Pointer to the index to add to.
+ * \param section	The number of the section holding the word.
+ * \param *word		Pointer to the word, which needn't be terminated.
+ * \param length	The length of the word, in bytes.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_add_term(struct output_search *search, int section, const char *word, size_t length)
+{
+	struct output_search_term	*term;
+	struct output_search_posting	*postings;
+	size_t				size;
+
+	term = output_search_find_slot(search, word, length);
+
+	/* Create a new term if the word hasn't been seen before. */
+
+	if (term->text == NULL) {
+		if ((search->count + 1) * OUTPUT_SEARCH_LOAD_DIVISOR > search->size * OUTPUT_SEARCH_LOAD_LIMIT) {
+			if (!output_search_grow_table(search))
+				return false;
+
+			term = output_search_find_slot(search, word, length);
+		}
+
+		term->text = malloc(length + 1);
+		if (term->text == NULL)
+			return false;
+
+		memcpy(term->text, word, length);
+		term->text[length] = '\0';
+		term->length = length;
+		term->postings = NULL;
+		term->count = 0;
+		term->size = 0;
+
+		search->count++;
+	}
+
+	/* Only the first use of a word in each section is recorded. */
+
+	if (term->count > 0 && term->postings[term->count - 1].section == (unsigned int) section)
+		return true;
+
+	if (term->count >= term->size) {
+		size = (term->size > 0) ? term->size * 2 : OUTPUT_SEARCH_INITIAL_BLOCK;
+
+		postings = realloc(term->postings, sizeof(struct output_search_posting) * size);
+		if (postings == NULL)
+			return false;
+
+		term->postings = postings;
+		term->size = size;
+	}
+
+	term->postings[term->count].section = section;
+	term->postings[term->count].offset = search->sections[section].words;
+	term->count++;
+
+	return true;
+}
+
+/**
+ * Find the slot holding a term, or the free slot where it should be placed.
+ *
+ * \param *search	Pointer to the index to search.
+ * \param *word		Pointer to the term, which needn't be terminated.
+ * \param length	The length of the term, in bytes.
+ * \return		Pointer to the slot.
+ */
+
+static struct output_search_term *output_search_find_slot(struct output_search *search, const char *word, size_t length)
+{
+	size_t slot;
+
+	slot = string_hash(word, length, STRING_HASH_INITIAL) & (search->size - 1);
+
+	while (search->terms[slot].text != NULL &&
+			(search->terms[slot].length != length || memcmp(search->terms[slot].text, word, length) != 0))
+		slot = (slot + 1) & (search->size - 1);
+
+	return search->terms + slot;
+}
+
+/**
+ * Double the size of the term table, rehashing its contents.
+ *
+ * \param *search	Pointer to the index to grow.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_grow_table(struct output_search *search)
+{
+	struct output_search_term	*old_terms, *slot;
+	size_t				old_size, i;
+
+	old_terms = search->terms;
+	old_size = search->size;
+
+	search->terms = calloc(old_size * 2, sizeof(struct output_search_term));
+	if (search->terms == NULL) {
+		search->terms = old_terms;
+		return false;
+	}
+
+	search->size = old_size * 2;
+
+	for (i = 0; i < old_size; i++) {
+		if (old_terms[i].text == NULL)
+			continue;
+
+		slot = output_search_find_slot(search, old_terms[i].text, old_terms[i].length);
+		*slot = old_terms[i];
+	}
+
+	free(old_terms);
+
+	return true;
+}
+
+/**
+ * Append some bytes to a growable text block, keeping it terminated.
+ *
+ * \param *text		Pointer to the block to append to.
+ * \param *add		Pointer to the bytes to append.
+ * \param length	The number of bytes to append.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_append_text(struct output_search_text *text, const char *add, size_t length)
+{
+	char	*block;
+	size_t	size;
+
+	if (text->length + length + 1 > text->size) {
+		size = (text->size > 0) ? text->size : OUTPUT_SEARCH_INITIAL_BLOCK;
+
+		while (size < text->length + length + 1)
+			size *= 2;
+
+		block = realloc(text->text, size);
+		if (block == NULL)
+			return false;
+
+		text->text = block;
+		text->size = size;
+	}
+
+	memcpy(text->text + text->length, add, length);
+	text->length += length;
+	text->text[text->length] = '\0';
+
+	return true;
+}
+
+/**
+ * Compare two terms for qsort(), in ascending byte order.
+ *
+ * \param *a		Pointer to the first term pointer.
+ * \param *b		Pointer to the second term pointer.
+ * \return		The result of the comparison.
+ */
+
+static int output_search_compare_terms(const void *a, const void *b)
+{
+	return strcmp((*(struct output_search_term * const *) a)->text, (*(struct output_search_term * const *) b)->text);
+}
+
+/**
+ * Compare two postings for qsort(), in ascending section order and then
+ * by offset within the section.
+ *
+ * \param *a		Pointer to the first posting.
+ * \param *b		Pointer to the second posting.
+ * \return		The result of the comparison.
+ */
+
+static int output_search_compare_postings(const void *a, const void *b)
+{
+	const struct output_search_posting *first = a, *second = b;
+
+	if (first->section != second->section)
+		return (first->section < second->section) ? -1 : 1;
+
+	if (first->offset != second->offset)
+		return (first->offset < second->offset) ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * Write a number to a file as an unsigned LEB128 varint.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param value		The value to write.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_write_number(struct output_file *file, uint64_t value)
+{
+	char	buffer[OUTPUT_SEARCH_VARINT_LEN];
+	size_t	length = 0;
+
+	do {
+		buffer[length] = value & 0x7f;
+		value >>= 7;
+
+		if (value != 0)
+			buffer[length] |= 0x80;
+
+		length++;
+	} while (value != 0);
+
+	return output_file_write(file, buffer, length);
+}
+
+/**
+ * Write a string to a file, as a varint length followed by its bytes.
+ *
+ * \param *file		Pointer to the file to write to.
+ * \param *text		Pointer to the string to write, or NULL if the
+ *			length is zero.
+ * \param length	The length of the string, in bytes.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_search_write_string(struct output_file *file, const char *text, size_t length)
+{
+	if (!output_search_write_number(file, length))
+		return false;
+
+	return (length == 0) ? true : output_file_write(file, text, length);
+}
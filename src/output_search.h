@@ -0,0 +1,104 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file output_search.h
+ *
+ * Search Index Output Interface.
+ *
+ * A search index maps each of the words in a manual to the sections in
+ * which they appear, so that a client-side search can load a single file
+ * instead of every page of the manual.
+ *
+ * All numbers in the file are unsigned LEB128 varints, and strings are
+ * stored as a varint byte count followed by their UTF-8 bytes. The file
+ * contains:
+ *
+ * - The magic word "XMSI", followed by the format version.
+ * - The number of sections, then for each, its link relative to the root
+ *   of the manual (including any #id fragment) and its title.
+ * - The number of terms, then for each in ascending byte order, the
+ *   number of bytes shared with the previous term, the remaining bytes
+ *   as a string, and the number of sections containing the term. These
+ *   are followed by a pair for each section: the difference between its
+ *   section number and the previous one in the list (or zero), and the
+ *   position of the first occurrence of the term in the section, counted
+ *   in words.
+ */
+
+#ifndef XMLMAN_OUTPUT_SEARCH_H
+#define XMLMAN_OUTPUT_SEARCH_H
+
+#include <stdbool.h>
+
+#include "manual_data.h"
+#include "manual_links.h"
+#include "modes.h"
+#include "output_file.h"
+
+/**
+ * A search index instance.
+ */
+
+struct output_search;
+
+/**
+ * Create a new, empty, search index.
+ *
+ * \return		Pointer to the new index, or NULL on failure.
+ */
+
+struct output_search *output_search_create(void);
+
+/**
+ * Destroy a search index, freeing all of the data held in it.
+ *
+ * \param *search	Pointer to the index to destroy.
+ */
+
+void output_search_destroy(struct output_search *search);
+
+/**
+ * Add the chapters, indexes and sections of a manual to a search index,
+ * along with the words which they contain.
+ *
+ * \param *search	Pointer to the index to add to.
+ * \param *manual	Pointer to the manual to be indexed.
+ * \param *links	Pointer to the link cache for the output.
+ * \param type		The output type for which the index is built.
+ * \return		True if successful; False on failure.
+ */
+
+bool output_search_add_manual(struct output_search *search, struct manual_data *manual, struct manual_links *links, enum modes_type type);
+
+/**
+ * Write a search index out to a file.
+ *
+ * \param *search	Pointer to the index to write.
+ * \param *file		Pointer to the file to write the index to.
+ * \return		True if successful; False on failure.
+ */
+
+bool output_search_write(struct output_search *search, struct output_file *file);
+
+#endif
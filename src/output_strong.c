@@ -39,11 +39,14 @@
 #include "encoding.h"
 #include "filename.h"
 #include "list_numbers.h"
+#include "manual_contents.h"
 #include "manual_data.h"
 #include "manual_queue.h"
 #include "modes.h"
 #include "msg.h"
 #include "output_strong_file.h"
+#include "output_render.h"
+#include "profile.h"
 
 /* Static constants. */
 
@@ -79,12 +82,50 @@
 
 static struct filename *output_strong_root_filename;
 
+/**
+ * The cache of chapter lists, with their rendered titles.
+ */
+
+static struct manual_contents *output_strong_contents;
+
 /**
  * The bullets that we will use for unordered lists.
  */
 
 static char *output_strong_unordered_list_bullets[] = { ENCODING_UTF8_BULLET, ENCODING_UTF8_MIDDOT, NULL };
 
+/**
+ * The rendering of the inline spans, with the decoration giving a StrongHelp font.
+ */
+
+static struct output_render_span output_strong_spans[] = {
+	{MANUAL_DATA_OBJECT_TYPE_CITATION,		OUTPUT_RENDER_SPAN_WRAP,	"/"},
+	{MANUAL_DATA_OBJECT_TYPE_CODE,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_COMMAND,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_CONSTANT,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_EVENT,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_FILENAME,		OUTPUT_RENDER_SPAN_WRAP,	"*"},
+	{MANUAL_DATA_OBJECT_TYPE_FUNCTION,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_ICON,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_INTRO,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_KEY,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_KEYWORD,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"/"},
+	{MANUAL_DATA_OBJECT_TYPE_LINK,			OUTPUT_RENDER_SPAN_LINK,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MATHS,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MENU,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MESSAGE,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MOUSE,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_NAME,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_REFERENCE,		OUTPUT_RENDER_SPAN_REFERENCE,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"*"},
+	{MANUAL_DATA_OBJECT_TYPE_SWI,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_TYPE,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_USER_ENTRY,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_VARIABLE,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_WINDOW,		OUTPUT_RENDER_SPAN_PLAIN,	NULL}
+};
+
 /* Static Function Prototypes. */
 
 static bool output_strong_write_manual(struct manual_data *manual);
@@ -96,6 +137,7 @@ static bool output_strong_write_page_foot(struct manual_data *manual);
 static bool output_strong_write_file_foot(struct manual_data *manual);
 static bool output_strong_write_heading(struct manual_data *node, int level, bool root);
 static bool output_strong_write_chapter_list(struct manual_data *object, int level);
+static bool output_strong_render_chapter_list_title(struct manual_data *node, void **title, size_t *length);
 static bool output_strong_write_block_collection_object(struct manual_data *object, int level);
 static bool output_strong_write_footnote(struct manual_data *object);
 static bool output_strong_write_callout(struct manual_data *object);
@@ -104,6 +146,7 @@ static bool output_strong_write_code_block(struct manual_data *object);
 static bool output_strong_write_paragraph(struct manual_data *object);
 static bool output_strong_write_reference(struct manual_data *target, char *text);
 static bool output_strong_write_text(enum manual_data_object_type type, struct manual_data *text);
+static bool output_strong_write_text_contents(enum manual_data_object_type type, struct manual_data *text);
 static bool output_strong_write_span_font(enum manual_data_object_type type, char *font, struct manual_data *text);
 static bool output_strong_write_inline_link(struct manual_data *link);
 static bool output_strong_write_inline_reference(struct manual_data *reference);
@@ -141,8 +184,16 @@ bool output_strong(struct manual *document, struct filename *filename, enum enco
 
 	/* Find and open the output file. */
 
-	if (!output_strong_file_open(filename))
+	output_strong_contents = manual_contents_create(output_strong_render_chapter_list_title);
+	if (output_strong_contents == NULL) {
+		msg_report(MSG_CONTENTS_NO_MEM);
 		return false;
+	}
+
+	if (!output_strong_file_open(filename)) {
+		manual_contents_destroy(output_strong_contents);
+		return false;
+	}
 
 	/* Write the manual content. */
 
@@ -152,6 +203,8 @@ bool output_strong(struct manual *document, struct filename *filename, enum enco
 
 	filename_destroy(output_strong_root_filename);
 
+	manual_contents_destroy(output_strong_contents);
+
 	output_strong_file_close();
 
 	if (!filename_set_type(filename, FILENAME_FILETYPE_STRONGHELP))
@@ -195,8 +248,12 @@ static bool output_strong_write_manual(struct manual_data *manual)
 		if (object == NULL)
 			continue;
 
-		if (!output_strong_write_file(object))
+		if (!output_strong_write_file(object)) {
+			manual_queue_complete_node(false);
 			return false;
+		}
+
+		manual_queue_complete_node(true);
 	} while (object != NULL);
 
 	return true;
@@ -681,8 +738,8 @@ static bool output_strong_write_heading(struct manual_data *node, int level, boo
 
 static bool output_strong_write_chapter_list(struct manual_data *object, int level)
 {
-	struct manual_data *entry = NULL;
-	bool first = true;
+	struct manual_contents_entry	*entries = NULL;
+	size_t				count = 0, i;
 
 	/* The parent object is in the chain to be listed, so we need to
 	 * go up again to its parent and then down to the first child in
@@ -692,44 +749,60 @@ static bool output_strong_write_chapter_list(struct manual_data *object, int lev
 	if (object == NULL || object->parent == NULL || object->parent->parent == NULL)
 		return false;
 
+	if (!manual_contents_get_list(output_strong_contents, object->parent->parent, &entries, &count))
+		return false;
+
 	/* Output the list. */
 
-	entry = object->parent->parent->first_child;
+	if (count > 0 && !output_strong_file_write_newline())
+		return false;
 
-	while (entry != NULL) {
-		switch (entry->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			if (entry->title != NULL) {
-				if (first == true) {
-					if (!output_strong_file_write_newline())
-						return false;
+	for (i = 0; i < count; i++) {
+		if (entries[i].node->chapter.id != NULL && !output_strong_file_write_plain("<"))
+			return false;
 
-					first = false;
-				}
+		if (!output_strong_file_write_data(entries[i].title, entries[i].length))
+			return false;
 
-				if (entry->chapter.id != NULL && !output_strong_file_write_plain("<"))
-					return false;
+		if (entries[i].node->chapter.id != NULL && !output_strong_write_local_anchor(object, entries[i].node))
+			return false;
 
-				if (!output_strong_write_title(entry, false, true))
-					return false;
+		if (!output_strong_file_write_newline())
+			return false;
+	}
 
-				if (entry->chapter.id != NULL && !output_strong_write_local_anchor(object, entry))
-					return false;
+	return true;
+}
 
-				if (!output_strong_file_write_newline())
-					return false;
-			}
-			break;
+/**
+ * Render the title of an entry in a chapter list, for the contents list
+ * cache to hold.
+ *
+ * \param *node		The node whose title is to be rendered.
+ * \param **title	Pointer to a variable to take a pointer to the
+ *			rendered title.
+ * \param *length	Pointer to a variable to take the title length.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
 
-		default:
-			break;
-		}
+static bool output_strong_render_chapter_list_title(struct manual_data *node, void **title, size_t *length)
+{
+	bool success;
+
+	if (!output_strong_file_open_capture())
+		return false;
+
+	success = output_strong_write_title(node, false, true);
 
-		entry = entry->next;
+	if (!output_strong_file_close_capture(title, length))
+		return false;
+
+	if (!success) {
+		free(*title);
+		*title = NULL;
 	}
 
-	return true;
+	return success;
 }
 
 /**
@@ -863,12 +936,8 @@ static bool output_strong_write_footnote(struct manual_data *object)
 	if (number == NULL)
 		return false;
 
-	if (!output_strong_file_write_text(number)) {
-		free(number);
+	if (!output_strong_file_write_text(number))
 		return false;
-	}
-
-	free(number);
 
 	if (!output_strong_file_write_plain("}"))
 		return false;
@@ -1258,6 +1327,7 @@ static bool output_strong_write_reference(struct manual_data *target, char *text
 
 /**
  * Write a block of text to the output file.
+ * The call is profiled, if profiling has been built in.
  *
  * \param type			The type of block which is expected.
  * \param *text			The block of text to be written.
@@ -1265,8 +1335,32 @@ static bool output_strong_write_reference(struct manual_data *target, char *text
  */
 
 static bool output_strong_write_text(enum manual_data_object_type type, struct manual_data *text)
+{
+	bool result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = output_strong_write_text_contents(type, text);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_STRONG_TEXT, type);
+
+	return result;
+}
+
+/**
+ * Carry out the work of output_strong_write_text(), which calls this so that it
+ * can be profiled.
+ *
+ * \param type			The type of block which is expected.
+ * \param *text			The block of text to be written.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_strong_write_text_contents(enum manual_data_object_type type, struct manual_data *text)
 {
 	struct manual_data *chunk;
+	struct output_render_span *span;
 	bool success = true;
 
 	/* An empty block doesn't require any output. */
@@ -1283,94 +1377,39 @@ static bool output_strong_write_text(enum manual_data_object_type type, struct m
 
 	while (success == true && chunk != NULL) {
 		switch (chunk->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CITATION:
-			success = output_strong_write_span_font(MANUAL_DATA_OBJECT_TYPE_CITATION, "/", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CODE:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_CODE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_COMMAND:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_COMMAND, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CONSTANT:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_CONSTANT, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_EVENT:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_EVENT, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FILENAME:
-			success = output_strong_write_span_font(MANUAL_DATA_OBJECT_TYPE_FILENAME, "*", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FUNCTION:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_FUNCTION, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_ICON:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_ICON, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_INTRO:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_INTRO, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEY:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_KEY, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEYWORD:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_KEYWORD, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS:
-			success = output_strong_write_span_font(MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS, "/", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LINK:
-			success = output_strong_write_inline_link(chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MATHS:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_MATHS, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MENU:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_MENU, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MESSAGE:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_MESSAGE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MOUSE:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_MOUSE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_NAME:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_NAME, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
-			success = output_strong_write_inline_reference(chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS:
-			success = output_strong_write_span_font(MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS, "*", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_SWI:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_SWI, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_TYPE:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_TYPE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_USER_ENTRY:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_USER_ENTRY, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_VARIABLE:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_VARIABLE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_WINDOW:
-			success = output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_WINDOW, chunk);
-			break;
 		case MANUAL_DATA_OBJECT_TYPE_LINE_BREAK:
 			success = output_strong_file_write_newline();
 			break;
 		case MANUAL_DATA_OBJECT_TYPE_TEXT:
-			success = output_strong_file_write_text(chunk->chunk.text);
+			success = output_strong_file_write_chunk(chunk);
 			break;
 		case MANUAL_DATA_OBJECT_TYPE_ENTITY:
 			success = output_strong_write_entity(chunk->chunk.entity);
 			break;
 		default:
-			msg_report(MSG_UNEXPECTED_CHUNK,
-					manual_data_find_object_name(chunk->type),
-					manual_data_find_object_name(text->type));
+			/* Anything else must be one of the inline spans. */
+
+			span = output_render_find_span(output_strong_spans, chunk->type);
+
+			switch ((span != NULL) ? span->style : OUTPUT_RENDER_SPAN_NONE) {
+			case OUTPUT_RENDER_SPAN_PLAIN:
+				success = output_strong_write_text(chunk->type, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_WRAP:
+				success = output_strong_write_span_font(chunk->type, span->decoration, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_LINK:
+				success = output_strong_write_inline_link(chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_REFERENCE:
+				success = output_strong_write_inline_reference(chunk);
+				break;
+			default:
+				msg_report(MSG_UNEXPECTED_CHUNK,
+						manual_data_find_object_name(chunk->type),
+						manual_data_find_object_name(text->type));
+				break;
+			}
 			break;
 		}
 
@@ -1394,7 +1433,7 @@ static bool output_strong_write_span_font(enum manual_data_object_type type, cha
 	if (text == NULL || font == NULL)
 		return false;
 
-	if (!output_strong_file_write_plain("{f%s}"))
+	if (!output_strong_file_write_plain("{f%s}", font))
 		return false;
 
 	if (!output_strong_write_text(type, text))
@@ -1475,7 +1514,7 @@ static bool output_strong_write_inline_reference(struct manual_data *reference)
 
 	/* Find the target object. */
 
-	target = manual_ids_find_node(reference);
+	target = reference->chunk.target;
 
 	/* If the target is a footnote, write the body text and
 	 * opening square bracket out now. */
@@ -1500,12 +1539,8 @@ static bool output_strong_write_inline_reference(struct manual_data *reference)
 		if (number == NULL)
 			return false;
 
-		if (!output_strong_file_write_text(number)) {
-			free(number);
+		if (!output_strong_file_write_text(number))
 			return false;
-		}
-
-		free(number);
 	} else {
 		if (reference->first_child != NULL) {
 			if (!output_strong_write_text(MANUAL_DATA_OBJECT_TYPE_REFERENCE, reference))
@@ -1609,12 +1644,8 @@ static bool output_strong_write_title(struct manual_data *node, bool include_nam
 	number = manual_data_get_node_number(node, include_name);
 
 	if (number != NULL) {
-		if (!output_strong_file_write_text(number)) {
-			free(number);
+		if (!output_strong_file_write_text(number))
 			return false;
-		}
-
-		free(number);
 
 		if (include_title && !output_strong_file_write_plain(" "))
 			return false;
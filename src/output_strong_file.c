@@ -39,7 +39,9 @@
 
 #include "encoding.h"
 #include "filename.h"
+#include "manual_encoded.h"
 #include "msg.h"
+#include "output_file.h"
 #include "string.h"
 
 /**
@@ -60,6 +62,12 @@ struct output_strong_file_object {
 
 	char					*filename;
 
+	/**
+	 * The case-insensitive hash of the object's filename.
+	 */
+
+	uint64_t				hash;
+
 	/**
 	 * The filetype of the object, or -1 for directories.
 	 */
@@ -72,6 +80,13 @@ struct output_strong_file_object {
 
 	size_t					size;
 
+	/**
+	 * When streaming, pointer to the file's buffered contents, without
+	 * the DATA header, or NULL.
+	 */
+
+	void					*data;
+
 	/**
 	 * If the node is a directory, pointer to the first node
 	 * within it. NULL for files.
@@ -79,6 +94,26 @@ struct output_strong_file_object {
 
 	struct output_strong_file_object	*contents;
 
+	/**
+	 * If the node is a directory, pointer to an open-addressed hash
+	 * table indexing the nodes within it by name, or NULL.
+	 */
+
+	struct output_strong_file_object	**index;
+
+	/**
+	 * The number of slots in the directory's index; always a power
+	 * of two.
+	 */
+
+	size_t					index_size;
+
+	/**
+	 * The number of nodes held in the directory's index.
+	 */
+
+	size_t					entries;
+
 	/**
 	 * Pointer to the next node in the current directory, or NULL.
 	 */
@@ -151,6 +186,26 @@ struct output_strong_file_free_block {
 
 #define OUTPUT_STRONG_FILE_TYPE_DIR ((int) -1)
 
+/**
+ * The size of the file header, including the root directory entry.
+ */
+
+#define OUTPUT_STRONG_FILE_HEADER_SIZE 44
+
+/**
+ * The initial number of slots in a directory index; must be a power of two.
+ */
+
+#define OUTPUT_STRONG_FILE_INDEX_SIZE 16
+
+/**
+ * The directory index is grown once it becomes more than
+ * OUTPUT_STRONG_FILE_INDEX_LIMIT / OUTPUT_STRONG_FILE_INDEX_DIVISOR full.
+ */
+
+#define OUTPUT_STRONG_FILE_INDEX_LIMIT 3
+#define OUTPUT_STRONG_FILE_INDEX_DIVISOR 4
+
 /**
  * Calculate the padding required to bring a file offset to a word boundary.
  */
@@ -158,47 +213,83 @@ struct output_strong_file_free_block {
 #define OUTPUT_STRONG_FILE_PADDING(position) ((4 - ((position) % 4)) % 4)
 
 /**
- * Convert a long file position into a RISC OS sized 32-bit word.
+ * The largest offset or size which can be held in a StrongHelp file,
+ * whose catalogue records them in signed 32-bit words.
  */
 
-#define OUTPUT_STRONG_FILE_TO_RISCOS(position) ((size_t) ((position) & 0xffffffff))
+#define OUTPUT_STRONG_FILE_MAX_OFFSET ((size_t) INT32_MAX)
 
 /* Global Variables. */
 
+/**
+ * True if the StrongHelp file should be streamed, without seeking back.
+ */
+
+static bool output_strong_file_stream = false;
+
 /**
  * The output file handle.
  */
  
-static FILE *output_strong_file_handle = NULL;
+static struct output_file *output_strong_file_handle = NULL;
 
 /**
- * The current output file block descriptor.
+ * The file handle to which the contents of the current file are written.
+ * When streaming, this is a memory file; otherwise, it is the output file.
  */
 
-static struct output_strong_file_object *output_strong_file_current_block = NULL;
+static struct output_file *output_strong_file_target = NULL;
 
 /**
- * The root file block descriptor.
+ * The file handle set aside while output is being captured into memory,
+ * or NULL.
  */
 
-static struct output_strong_file_object *output_strong_file_root = NULL;
+static struct output_file *output_strong_file_captured = NULL;
 
 /**
- * The position of the root directory block.
+ * The current output file block descriptor.
  */
 
-static size_t output_strong_file_root_dir_offset = 0;
+static struct output_strong_file_object *output_strong_file_current_block = NULL;
+
+/**
+ * The root file block descriptor.
+ */
+
+static struct output_strong_file_object *output_strong_file_root = NULL;
 
 /* Static Function Prototypes. */
 
 static struct output_strong_file_object *output_strong_file_add_entry(struct output_strong_file_object *directory, char *filename, int type);
 static struct output_strong_file_object *output_strong_file_link_object(struct output_strong_file_object *directory, char *filename, int type);
 static struct output_strong_file_object *output_strong_file_create_object(char *filename, int type);
+static struct output_strong_file_object **output_strong_file_find_slot(struct output_strong_file_object *directory, char *filename, uint64_t hash);
+static bool output_strong_file_index_object(struct output_strong_file_object *directory, struct output_strong_file_object *object);
+static bool output_strong_file_sort_directory(struct output_strong_file_object *directory);
+static int output_strong_file_compare_objects(const void *a, const void *b);
+static bool output_strong_file_write_header(size_t offset, size_t size);
 static bool output_strong_file_count_directory(struct output_strong_file_object *directory);
+static size_t output_strong_file_size_catalogue(struct output_strong_file_object *directory);
+static bool output_strong_file_place_files(struct output_strong_file_object *directory, size_t *offset);
+static bool output_strong_file_write_files(struct output_strong_file_object *directory);
 static bool output_strong_file_write_catalogue(struct output_strong_file_object *directory, size_t *offset, size_t *length);
 static bool output_strong_file_write_char(int unicode);
 static bool output_strong_file_write_filename(char *filename);
 static bool output_strong_file_pad(void);
+static bool output_strong_file_get_position(size_t *position);
+
+/**
+ * Initialise the StrongHelp file output engine.
+ *
+ * \param stream	True to stream files sequentially, buffering each
+ *			file in memory so that the output is never seeked.
+ */
+
+void output_strong_file_initialise(bool stream)
+{
+	output_strong_file_stream = stream;
+}
 
 /**
  * Open a file to write the StrongHelp output to.
@@ -209,12 +300,9 @@ static bool output_strong_file_pad(void);
 
 bool output_strong_file_open(struct filename *filename)
 {
-	struct output_strong_file_root		root;
-	struct output_strong_file_dir_entry	dir;
-
 	/* Open the file to disc. */
 
-	output_strong_file_handle = filename_fopen(filename, "w");
+	output_strong_file_handle = output_file_open(filename);
 
 	if (output_strong_file_handle == NULL)
 		return false;
@@ -224,46 +312,18 @@ bool output_strong_file_open(struct filename *filename)
 	output_strong_file_root = output_strong_file_create_object("$", OUTPUT_STRONG_FILE_TYPE_DIR);
 
 	if (output_strong_file_root == NULL) {
-		fclose(output_strong_file_handle);
+		output_file_close(output_strong_file_handle);
 		output_strong_file_handle = NULL;
 		msg_report(MSG_STRONG_ROOT_FAIL);
 		return false;
 	}
 
-	/* Write the file header block. */
-
-	root.help = 0x504c4548;
-	root.size = 44;
-	root.version = 290;
-	root.free_offset = -1;
-
-	if (fwrite(&root, sizeof(struct output_strong_file_root), 1, output_strong_file_handle) != 1) {
-		fclose(output_strong_file_handle);
-		output_strong_file_handle = NULL;
-		msg_report(MSG_WRITE_FAILED);
-		return false;
-	}
-
-	/* Write the root directory entry. */
-
-	output_strong_file_root_dir_offset = OUTPUT_STRONG_FILE_TO_RISCOS(ftell(output_strong_file_handle));
-
-	dir.object_offset = 0;
-	dir.load_address = 0xfffffd00;
-	dir.exec_address = 0x00000000;
-	dir.size = 0;
-	dir.flags = 0x100;
-	dir.reserved = 0;
-
-	if (fwrite(&dir, sizeof(struct output_strong_file_dir_entry), 1, output_strong_file_handle) != 1) {
-		fclose(output_strong_file_handle);
-		output_strong_file_handle = NULL;
-		msg_report(MSG_WRITE_FAILED);
-		return false;
-	}
+	/* When streaming, the header is written once the catalogue is
+	 * known; otherwise write a placeholder now, to be updated later.
+	 */
 
-	if (!output_strong_file_write_filename("$")) {
-		fclose(output_strong_file_handle);
+	if (!output_strong_file_stream && !output_strong_file_write_header(0, 0)) {
+		output_file_close(output_strong_file_handle);
 		output_strong_file_handle = NULL;
 		return false;
 	}
@@ -277,8 +337,7 @@ bool output_strong_file_open(struct filename *filename)
 
 void output_strong_file_close(void)
 {
-	struct output_strong_file_dir_entry	dir;
-	size_t					offset, length;
+	size_t	offset, length, position;
 
 	if (output_strong_file_handle == NULL)
 		return;
@@ -287,31 +346,35 @@ void output_strong_file_close(void)
 	 * the root entry with the correct size and offset.
 	 */
 
-	if (output_strong_file_count_directory(output_strong_file_root)) {
-		if (output_strong_file_write_catalogue(output_strong_file_root, &offset, &length)) {
-
-			/* Write the root directory entry. */
-
-			dir.object_offset = offset;
-			dir.load_address = 0xfffffd00;
-			dir.exec_address = 0x00000000;
-			dir.size = length - 8;
-			dir.flags = 0x100;
-			dir.reserved = 0;
-
-			if (fseek(output_strong_file_handle, output_strong_file_root_dir_offset, SEEK_SET) == -1)
-				msg_report(MSG_WRITE_FAILED);
-
-			if (fwrite(&dir, sizeof(struct output_strong_file_dir_entry), 1, output_strong_file_handle) != 1)
-				msg_report(MSG_WRITE_FAILED);
-		}
-	} else {
+	if (!output_strong_file_count_directory(output_strong_file_root)) {
 		msg_report(MSG_STRONG_COUNT_FAIL);
+	} else if (output_strong_file_stream) {
+		/* The catalogue follows the header, with the root directory
+		 * last, and the buffered files follow the catalogue.
+		 */
+
+		length = output_strong_file_size_catalogue(output_strong_file_root);
+
+		position = OUTPUT_STRONG_FILE_HEADER_SIZE + length;
+
+		if (position > OUTPUT_STRONG_FILE_MAX_OFFSET || !output_strong_file_place_files(output_strong_file_root, &position))
+			msg_report(MSG_STRONG_TOO_LARGE);
+		else if (output_strong_file_write_header(OUTPUT_STRONG_FILE_HEADER_SIZE + length - output_strong_file_root->size,
+				output_strong_file_root->size - 8) &&
+				output_strong_file_write_catalogue(output_strong_file_root, &offset, &length))
+			output_strong_file_write_files(output_strong_file_root);
+	} else if (output_strong_file_write_catalogue(output_strong_file_root, &offset, &length)) {
+		if (!output_file_seek(output_strong_file_handle, 0))
+			msg_report(MSG_WRITE_FAILED);
+		else
+			output_strong_file_write_header(offset, length - 8);
 	}
 
 	/* Close the file. */
 
-	fclose(output_strong_file_handle);
+	if (!output_file_close(output_strong_file_handle))
+		msg_report(MSG_WRITE_FAILED);
+
 	output_strong_file_handle = NULL;
 }
 
@@ -351,16 +414,33 @@ bool output_strong_file_sub_open(struct filename *filename, int type)
 		return false;
 	}
 
+	/* When streaming, collect the file's contents in memory. */
+
+	if (output_strong_file_stream) {
+		output_strong_file_target = output_file_open_memory();
+
+		if (output_strong_file_target == NULL) {
+			output_strong_file_current_block = NULL;
+			msg_report(MSG_WRITE_FAILED);
+			return false;
+		}
+
+		return true;
+	}
+
+	output_strong_file_target = output_strong_file_handle;
+
 	/* Record the new file's offset. */
 
-	output_strong_file_current_block->file_offset = OUTPUT_STRONG_FILE_TO_RISCOS(ftell(output_strong_file_handle));
+	if (!output_strong_file_get_position(&(output_strong_file_current_block->file_offset)))
+		return false;
 
 	/* Write a DIR$ header block, with a zero placeholder for size. */
 
 	data.data = 0x41544144;
 	data.size = 0;
 
-	if (fwrite(&data, sizeof(struct output_strong_file_data_block), 1, output_strong_file_handle) != 1) {
+	if (!output_file_write(output_strong_file_handle, &data, sizeof(struct output_strong_file_data_block))) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -378,6 +458,7 @@ bool output_strong_file_sub_close(void)
 {
 	struct output_strong_file_data_block	data;
 	size_t					position;
+	bool					success;
 
 	if (output_strong_file_handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
@@ -389,15 +470,33 @@ bool output_strong_file_sub_close(void)
 		return false;
 	}
 
+	/* When streaming, keep the file's contents until the output is
+	 * closed, by which time the catalogue will be known.
+	 */
+
+	if (output_strong_file_stream) {
+		success = output_file_close_memory(output_strong_file_target, &(output_strong_file_current_block->data), &position);
+
+		output_strong_file_current_block->size = position + sizeof(struct output_strong_file_data_block);
+		output_strong_file_current_block = NULL;
+		output_strong_file_target = NULL;
+
+		if (!success)
+			msg_report(MSG_WRITE_FAILED);
+
+		return success;
+	}
+
 	/* Find the position of the end of the file, and calculate its size. */
 
-	position = OUTPUT_STRONG_FILE_TO_RISCOS(ftell(output_strong_file_handle));
+	if (!output_strong_file_get_position(&position))
+		return false;
 
 	output_strong_file_current_block->size = position - output_strong_file_current_block->file_offset;
 
 	/* Update the file's DIR$ header block with the correct size. */
 
-	if (fseek(output_strong_file_handle, output_strong_file_current_block->file_offset, SEEK_SET) == -1) {
+	if (!output_file_seek(output_strong_file_handle, output_strong_file_current_block->file_offset)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -405,19 +504,20 @@ bool output_strong_file_sub_close(void)
 	data.data = 0x41544144;
 	data.size = output_strong_file_current_block->size;
 
-	if (fwrite(&data, sizeof(struct output_strong_file_data_block), 1, output_strong_file_handle) != 1) {
+	if (!output_file_write(output_strong_file_handle, &data, sizeof(struct output_strong_file_data_block))) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
 
 	/* Return the pointer to the end of the file. */
 
-	if (fseek(output_strong_file_handle, position, SEEK_SET) == -1) {
+	if (!output_file_seek(output_strong_file_handle, position)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
 
 	output_strong_file_current_block = NULL;
+	output_strong_file_target = NULL;
 
 	/* Pad the file out to a multiple of four bytes. */
 
@@ -486,99 +586,92 @@ static struct output_strong_file_object *output_strong_file_add_entry(struct out
  * on top of an existing file, that file is moved to become !Root within
  * the new directory.
  *
+ * Objects are found through the directory's index, and added to the
+ * directory unsorted; the contents are sorted once, when the catalogue
+ * is counted.
+ *
  * \param *directory	Pointer to the directory to link in to.
- * \param *filename	Pointer to the required filename.
+ * \param *filename	Pointer to the required filename, which becomes
+ *			owned by the object tree.
  * \param type		The required file type.
  * \return		Pointer to the linked object, or NULL on failure.
  */
 
 static struct output_strong_file_object *output_strong_file_link_object(struct output_strong_file_object *directory, char *filename, int type)
 {
-	struct output_strong_file_object	*current = NULL, *previous = NULL, *new = NULL;
-	int					compare = -1;
+	struct output_strong_file_object	*current = NULL, *new = NULL;
 	char					*new_name = NULL, *root = "!Root";
 
 	if (directory == NULL || filename == NULL)
 		return NULL;
 
-	/* Locate the object's position in the linked list. */
-
-	current = directory->contents;
+	/* Look for an existing object with the name. */
 
-	while ((current != NULL) && ((compare = string_nocase_strcmp(current->filename, filename)) < 0)) {
-		previous = current;
-		current = current->next;
-	}
-
-	if (compare == 0) {
-		/* An existing object with the name has been found. */
+	current = *output_strong_file_find_slot(directory, filename, string_nocase_hash(filename, STRING_HASH_INITIAL));
 
+	if (current != NULL) {
 		if (current->contents == NULL && type != OUTPUT_STRONG_FILE_TYPE_DIR) {
 			/* Both entries are files, so there's a conflict that
 			 * we can't resolve.
 			 */
 
 			msg_report(MSG_STRONG_NAME_EXISTS, filename, directory->filename);
+			free(filename);
 			return NULL;
 		} else if (current->contents == NULL) {
 			/* There's already a file with the name that we want
 			 * for the new directory, so move the existing file
-			 * into the new directory and call it !Root.
+			 * into a new !Root file, and turn its node into the
+			 * new directory.
 			 */
 
-			/* Create the new directory. */
-
-			new = output_strong_file_create_object(filename, type);
-			if (new == NULL)
+			new_name = malloc(strlen(root) + 1);
+			if (new_name == NULL)
 				return NULL;
 
-			/* Allocate a new name for the existing file. */
+			strcpy(new_name, root);
 
-			new_name = malloc(strlen(root) + 1);
-			if (new_name == NULL) {
-				free(new);
+			new = output_strong_file_create_object(new_name, current->type);
+			if (new == NULL) {
+				free(new_name);
 				return NULL;
 			}
 
-			strcpy(new_name, root);
+			new->file_offset = current->file_offset;
+			new->size = current->size;
+			new->data = current->data;
 
-			free(current->filename);
-			current->filename = new_name;
+			current->type = type;
+			current->file_offset = 0;
+			current->size = 0;
+			current->data = NULL;
+			current->contents = new;
 
-			/* Move the file and directory blocks around. */
+			if (!output_strong_file_index_object(current, new))
+				return NULL;
+		}
 
-			new->contents = current;
-			new->next = current->next;
-			previous->next = new;
-			current->next = NULL;
+		/* The existing entry is now a directory, so we can simply
+		 * use it again.
+		 */
 
-			return new;
-		} else {
-			/* The existing entry is a directory, so we can simply
-			 * use it again.
-			 */
+		free(filename);
+		return current;
+	}
 
-			return current;
-		}
-	} else {
-		/* A new object is required. */
+	/* A new object is required. */
 
-		new = output_strong_file_create_object(filename, type);
-		if (new == NULL)
-			return NULL;
+	new = output_strong_file_create_object(filename, type);
+	if (new == NULL)
+		return NULL;
 
-		if (previous == NULL) {
-			new->next = directory->contents;
-			directory->contents = new;
-		} else {
-			new->next = previous->next;
-			previous->next = new;
-		}
+	new->next = directory->contents;
+	directory->contents = new;
 
-		return new;
-	}
+	if (!output_strong_file_index_object(directory, new))
+		return NULL;
 
-	return NULL;
+	return new;
 }
 
 /**
@@ -599,14 +692,198 @@ static struct output_strong_file_object *output_strong_file_create_object(char *
 
 	new->file_offset = 0;
 	new->filename = filename;
+	new->hash = (filename != NULL) ? string_nocase_hash(filename, STRING_HASH_INITIAL) : 0;
 	new->type = type;
 	new->size = 0;
+	new->data = NULL;
 	new->contents = NULL;
+	new->index = NULL;
+	new->index_size = 0;
+	new->entries = 0;
 	new->next = NULL;
 
 	return new;
 };
 
+/**
+ * Find the slot in a directory's index which holds the object with a
+ * given filename, or the empty slot where it would be placed.
+ *
+ * \param *directory	Pointer to the directory to search.
+ * \param *filename	Pointer to the filename to look for.
+ * \param hash		The case-insensitive hash of the filename.
+ * \return		Pointer to the slot, which holds NULL if the name
+ *			was not found.
+ */
+
+static struct output_strong_file_object **output_strong_file_find_slot(struct output_strong_file_object *directory, char *filename, uint64_t hash)
+{
+	static struct output_strong_file_object	*empty = NULL;
+	size_t					slot;
+
+	if (directory->index == NULL)
+		return &empty;
+
+	slot = hash & (directory->index_size - 1);
+
+	while (directory->index[slot] != NULL) {
+		if (directory->index[slot]->hash == hash && string_nocase_strcmp(directory->index[slot]->filename, filename) == 0)
+			break;
+
+		slot = (slot + 1) & (directory->index_size - 1);
+	}
+
+	return directory->index + slot;
+}
+
+/**
+ * Add an object which has been linked into a directory's contents to
+ * the directory's index, growing the index if required.
+ *
+ * \param *directory	Pointer to the directory holding the object.
+ * \param *object	Pointer to the object to be indexed.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_strong_file_index_object(struct output_strong_file_object *directory, struct output_strong_file_object *object)
+{
+	struct output_strong_file_object	**index = NULL, *node = NULL;
+	size_t					size;
+
+	/* If there's space, add the object into the existing index. */
+
+	if (directory->index != NULL && (directory->entries + 1) * OUTPUT_STRONG_FILE_INDEX_DIVISOR <=
+			directory->index_size * OUTPUT_STRONG_FILE_INDEX_LIMIT) {
+		*output_strong_file_find_slot(directory, object->filename, object->hash) = object;
+		directory->entries++;
+		return true;
+	}
+
+	/* Otherwise, build a larger index from the directory contents,
+	 * which will already include the new object.
+	 */
+
+	size = (directory->index_size > 0) ? directory->index_size * 2 : OUTPUT_STRONG_FILE_INDEX_SIZE;
+
+	index = calloc(size, sizeof(struct output_strong_file_object *));
+	if (index == NULL)
+		return false;
+
+	free(directory->index);
+
+	directory->index = index;
+	directory->index_size = size;
+	directory->entries = 0;
+
+	for (node = directory->contents; node != NULL; node = node->next) {
+		*output_strong_file_find_slot(directory, node->filename, node->hash) = node;
+		directory->entries++;
+	}
+
+	return true;
+}
+
+/**
+ * Sort the contents of a directory into the case-insensitive order
+ * required by the catalogue, and release the directory's index.
+ *
+ * \param *directory	Pointer to the directory to sort.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_strong_file_sort_directory(struct output_strong_file_object *directory)
+{
+	struct output_strong_file_object	**nodes = NULL, *node = NULL;
+	size_t					count = 0, i;
+
+	for (node = directory->contents; node != NULL; node = node->next)
+		count++;
+
+	if (count > 1) {
+		nodes = malloc(count * sizeof(struct output_strong_file_object *));
+		if (nodes == NULL)
+			return false;
+
+		for (i = 0, node = directory->contents; node != NULL; node = node->next)
+			nodes[i++] = node;
+
+		qsort(nodes, count, sizeof(struct output_strong_file_object *), output_strong_file_compare_objects);
+
+		for (i = 0; i < count; i++)
+			nodes[i]->next = (i + 1 < count) ? nodes[i + 1] : NULL;
+
+		directory->contents = nodes[0];
+
+		free(nodes);
+	}
+
+	free(directory->index);
+	directory->index = NULL;
+	directory->index_size = 0;
+	directory->entries = 0;
+
+	return true;
+}
+
+/**
+ * Compare two objects by filename, for qsort().
+ *
+ * \param *a		Pointer to a pointer to the first object.
+ * \param *b		Pointer to a pointer to the second object.
+ * \return		The result of the comparison.
+ */
+
+static int output_strong_file_compare_objects(const void *a, const void *b)
+{
+	struct output_strong_file_object *object_a = *(struct output_strong_file_object * const *) a;
+	struct output_strong_file_object *object_b = *(struct output_strong_file_object * const *) b;
+
+	return string_nocase_strcmp(object_a->filename, object_b->filename);
+}
+
+/**
+ * Write the file header block and the root directory entry at the
+ * current position in the output file.
+ *
+ * \param offset	The file offset of the root directory.
+ * \param size		The size to record for the root directory.
+ * \return		True on success; False on failure.
+ */
+
+static bool output_strong_file_write_header(size_t offset, size_t size)
+{
+	struct output_strong_file_root		root;
+	struct output_strong_file_dir_entry	dir;
+
+	/* Write the file header block. */
+
+	root.help = 0x504c4548;
+	root.size = OUTPUT_STRONG_FILE_HEADER_SIZE;
+	root.version = 290;
+	root.free_offset = -1;
+
+	if (!output_file_write(output_strong_file_handle, &root, sizeof(struct output_strong_file_root))) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
+
+	/* Write the root directory entry. */
+
+	dir.object_offset = offset;
+	dir.load_address = 0xfffffd00;
+	dir.exec_address = 0x00000000;
+	dir.size = size;
+	dir.flags = 0x100;
+	dir.reserved = 0;
+
+	if (!output_file_write(output_strong_file_handle, &dir, sizeof(struct output_strong_file_dir_entry))) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
+
+	return output_strong_file_write_filename("$");
+}
+
 /**
  * Count the size of a directory node, and then recurse into all of
  * its subdirectories.
@@ -623,6 +900,11 @@ static bool output_strong_file_count_directory(struct output_strong_file_object
 	if (directory == NULL)
 		return false;
 
+	/* Put the directory's contents into catalogue order. */
+
+	if (!output_strong_file_sort_directory(directory))
+		return false;
+
 	/* Include the size of the DIR$ header. */
 
 	bytes = sizeof(struct output_strong_file_dir_block);
@@ -652,6 +934,63 @@ static bool output_strong_file_count_directory(struct output_strong_file_object
 	return true;
 }
 
+/**
+ * Total up the size of a directory and all of its subdirectories, once
+ * they have been counted.
+ *
+ * \param *directory	Pointer to the directory to process.
+ * \return		The size of the catalogue, in bytes.
+ */
+
+static size_t output_strong_file_size_catalogue(struct output_strong_file_object *directory)
+{
+	struct output_strong_file_object	*node = NULL;
+	size_t					bytes;
+
+	bytes = directory->size;
+
+	for (node = directory->contents; node != NULL; node = node->next) {
+		if (node->contents != NULL)
+			bytes += output_strong_file_size_catalogue(node);
+	}
+
+	return bytes;
+}
+
+/**
+ * Allocate file offsets to the buffered files in a directory and all
+ * of its subdirectories, in the order that they will be written.
+ *
+ * \param *directory	Pointer to the directory to process.
+ * \param *offset	Pointer to the offset of the next file, to be
+ *			updated on return.
+ * \return		True if successful; False if the files would not
+ *			fit within the StrongHelp format's offset limit.
+ */
+
+static bool output_strong_file_place_files(struct output_strong_file_object *directory, size_t *offset)
+{
+	struct output_strong_file_object	*node = NULL;
+	size_t					size;
+
+	for (node = directory->contents; node != NULL; node = node->next) {
+		if (node->contents != NULL) {
+			if (!output_strong_file_place_files(node, offset))
+				return false;
+		} else if (node->type != OUTPUT_STRONG_FILE_TYPE_DIR) {
+			size = node->size + OUTPUT_STRONG_FILE_PADDING(node->size);
+
+			if (size > OUTPUT_STRONG_FILE_MAX_OFFSET - *offset)
+				return false;
+
+			node->file_offset = *offset;
+			*offset += size;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Write the catalogue entries for a directory and any sub-directories
  * to the file.
@@ -691,7 +1030,8 @@ static bool output_strong_file_write_catalogue(struct output_strong_file_object
 
 	/* Write out this directory. */
 
-	position = OUTPUT_STRONG_FILE_TO_RISCOS(ftell(output_strong_file_handle));
+	if (!output_strong_file_get_position(&position))
+		return false;
 
 	/* Write the directory block header. */
 
@@ -699,7 +1039,7 @@ static bool output_strong_file_write_catalogue(struct output_strong_file_object
 	dir.size = directory->size;
 	dir.used = directory->size;
 
-	if (fwrite(&dir, sizeof(struct output_strong_file_dir_block), 1, output_strong_file_handle) != 1) {
+	if (!output_file_write(output_strong_file_handle, &dir, sizeof(struct output_strong_file_dir_block))) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -716,7 +1056,7 @@ static bool output_strong_file_write_catalogue(struct output_strong_file_object
 		entry.flags = (node->type == OUTPUT_STRONG_FILE_TYPE_DIR) ? 0x100 : 0x37;
 		entry.reserved = 0;
 
-		if (fwrite(&entry, sizeof(struct output_strong_file_dir_entry), 1, output_strong_file_handle) != 1) {
+		if (!output_file_write(output_strong_file_handle, &entry, sizeof(struct output_strong_file_dir_entry))) {
 			msg_report(MSG_WRITE_FAILED);
 			return false;
 		}
@@ -735,6 +1075,135 @@ static bool output_strong_file_write_catalogue(struct output_strong_file_object
 	return true;
 }
 
+/**
+ * Write the buffered files in a directory and all of its subdirectories
+ * to the output, in the order that they were placed, freeing their
+ * contents as they go.
+ *
+ * \param *directory	Pointer to the directory to write.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_strong_file_write_files(struct output_strong_file_object *directory)
+{
+	struct output_strong_file_object	*node = NULL;
+	struct output_strong_file_data_block	data;
+	size_t					length;
+
+	for (node = directory->contents; node != NULL; node = node->next) {
+		if (node->contents != NULL) {
+			if (!output_strong_file_write_files(node))
+				return false;
+
+			continue;
+		}
+
+		if (node->type == OUTPUT_STRONG_FILE_TYPE_DIR)
+			continue;
+
+		data.data = 0x41544144;
+		data.size = node->size;
+
+		length = node->size - sizeof(struct output_strong_file_data_block);
+
+		if (!output_file_write(output_strong_file_handle, &data, sizeof(struct output_strong_file_data_block)) ||
+				(length > 0 && !output_file_write(output_strong_file_handle, node->data, length))) {
+			msg_report(MSG_WRITE_FAILED);
+			return false;
+		}
+
+		free(node->data);
+		node->data = NULL;
+
+		if (!output_strong_file_pad())
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Start capturing the output written to the current file within the
+ * StrongHelp output file into memory, until the capture is closed.
+ *
+ * \return		True on success; False on failure.
+ */
+
+bool output_strong_file_open_capture(void)
+{
+	if (output_strong_file_current_block == NULL || output_strong_file_captured != NULL) {
+		msg_report(MSG_STRONG_NO_FILE);
+		return false;
+	}
+
+	output_strong_file_captured = output_strong_file_target;
+
+	output_strong_file_target = output_file_open_memory();
+	if (output_strong_file_target == NULL) {
+		output_strong_file_target = output_strong_file_captured;
+		output_strong_file_captured = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Stop capturing output into memory, and return to writing to the
+ * current file within the StrongHelp output file.
+ *
+ * \param **data	Pointer to a variable to take a pointer to the captured
+ *			data, which the caller must free().
+ * \param *length	Pointer to a variable to take the length of the data.
+ * \return		True on success; False on failure.
+ */
+
+bool output_strong_file_close_capture(void **data, size_t *length)
+{
+	bool success;
+
+	if (output_strong_file_captured == NULL) {
+		msg_report(MSG_STRONG_NO_FILE);
+		return false;
+	}
+
+	success = output_file_close_memory(output_strong_file_target, data, length);
+
+	output_strong_file_target = output_strong_file_captured;
+	output_strong_file_captured = NULL;
+
+	return success;
+}
+
+/**
+ * Write a block of data to the current StrongHelp output file, without
+ * any conversion, as it was previously captured.
+ *
+ * \param *data		Pointer to the data to be written.
+ * \param length	The length of the data, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_strong_file_write_data(void *data, size_t length)
+{
+	if (output_strong_file_handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	if (output_strong_file_current_block == NULL) {
+		msg_report(MSG_STRONG_NO_FILE);
+		return false;
+	}
+
+	if (!output_file_write(output_strong_file_target, data, length)) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
+
+	return true;
+}
+
 /**
  * Write a UTF8 string to the current StrongHelp output file, in the
  * currently selected encoding.
@@ -745,7 +1214,9 @@ static bool output_strong_file_write_catalogue(struct output_strong_file_object
 
 bool output_strong_file_write_text(char *text)
 {
-	int c;
+	int	c;
+	size_t	length, run;
+	char	*start;
 
 	if (text == NULL)
 		return true;
@@ -760,23 +1231,130 @@ bool output_strong_file_write_text(char *text)
 		return false;
 	}
 
-	do {
-		c = encoding_parse_utf8_string(&text);
+	length = strlen(text);
 
-		if (c != '\0') {
-			/* Escape special characters. */
+	while (length > 0) {
+		/* Copy any run of plain ASCII which doesn't need escaping
+		 * straight to the output.
+		 */
 
-			if (c == '{' && !output_strong_file_write_char('\\'))
-				return false;
+		run = encoding_find_ascii_run(text, length, '{');
 
-			if (!output_strong_file_write_char(c))
+		if (run > 0) {
+			if (!output_file_write(output_strong_file_target, text, run)) {
+				msg_report(MSG_WRITE_FAILED);
 				return false;
+			}
+
+			text += run;
+			length -= run;
+			continue;
 		}
-	} while (c != '\0');
+
+		/* Anything else must be decoded and written individually. */
+
+		start = text;
+		c = encoding_parse_utf8_string(&text);
+
+		if (c == '\0')
+			break;
+
+		/* Escape special characters. */
+
+		if (c == '{' && !output_strong_file_write_char('\\'))
+			return false;
+
+		if (!output_strong_file_write_char(c))
+			return false;
+
+		length -= text - start;
+	}
 
 	return true;
 }
 
+/**
+ * Write the text of a TEXT chunk to the current StrongHelp output file, in the
+ * currently selected encoding, using the encoded text cache if it is
+ * in use.
+ *
+ * \param *chunk	Pointer to the chunk to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_strong_file_write_chunk(struct manual_data *chunk)
+{
+	struct output_file		*file;
+	enum encoding_target		target;
+	const char			*encoded;
+	void				*data = NULL;
+	size_t				length;
+	bool				success;
+
+	if (chunk == NULL || chunk->chunk.text == NULL)
+		return true;
+
+	if (output_strong_file_handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	if (output_strong_file_current_block == NULL) {
+		msg_report(MSG_STRONG_NO_FILE);
+		return false;
+	}
+
+	/* Plain ASCII can be copied straight out, so isn't worth caching. */
+
+	length = strlen(chunk->chunk.text);
+
+	if (!manual_encoded_active() || encoding_find_ascii_run(chunk->chunk.text, length, '{') == length)
+		return output_strong_file_write_text(chunk->chunk.text);
+
+	/* Copy the text out if it has already been encoded. */
+
+	target = encoding_get_current_target();
+
+	encoded = manual_encoded_find(chunk, MODES_TYPE_STRONGHELP, target, &length);
+	if (encoded != NULL) {
+		if (!output_file_write(output_strong_file_target, encoded, length)) {
+			msg_report(MSG_WRITE_FAILED);
+			return false;
+		}
+
+		return true;
+	}
+
+	/* Otherwise, encode the text into memory so that it can be kept. */
+
+	file = output_strong_file_target;
+
+	output_strong_file_target = output_file_open_memory();
+	if (output_strong_file_target == NULL) {
+		output_strong_file_target = file;
+		return output_strong_file_write_text(chunk->chunk.text);
+	}
+
+	success = output_strong_file_write_text(chunk->chunk.text);
+
+	if (!output_file_close_memory(output_strong_file_target, &data, &length))
+		success = false;
+
+	output_strong_file_target = file;
+
+	if (success && length > 0 && !output_file_write(output_strong_file_target, data, length)) {
+		msg_report(MSG_WRITE_FAILED);
+		success = false;
+	}
+
+	if (success)
+		manual_encoded_store(chunk, MODES_TYPE_STRONGHELP, target, data, length);
+
+	free(data);
+
+	return success;
+}
+
 /**
  * Write an ASCII string to the output.
  *
@@ -805,7 +1383,7 @@ bool output_strong_file_write_plain(char *text, ...)
 
 	va_start(ap, text);
   
-	if (vfprintf(output_strong_file_handle, text, ap) < 0) {
+	if (!output_file_write_format(output_strong_file_target, text, ap)) {
 		msg_report(MSG_WRITE_FAILED);
 		success = false;
 	}
@@ -841,7 +1419,7 @@ bool output_strong_file_write_newline(void)
 		return false;
 	}
 
-	if (fputs(line_end, output_strong_file_handle) == EOF) {
+	if (!output_file_write_text(output_strong_file_target, line_end)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -874,7 +1452,7 @@ static bool output_strong_file_write_char(int unicode)
 
 	encoding_write_unicode_char(buffer, ENCODING_CHAR_BUF_LEN, unicode);
 
-	if (fputs(buffer, output_strong_file_handle) == EOF) {
+	if (!output_file_write_text(output_strong_file_target, buffer)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -896,12 +1474,12 @@ static bool output_strong_file_write_filename(char *filename)
 		return false;
 	}
 
-	if (fputs(filename, output_strong_file_handle) == EOF) {
+	if (!output_file_write_text(output_strong_file_handle, filename)) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
 
-	if (fputc('\0', output_strong_file_handle) == EOF) {
+	if (!output_file_write_char(output_strong_file_handle, '\0')) {
 		msg_report(MSG_WRITE_FAILED);
 		return false;
 	}
@@ -924,11 +1502,12 @@ static bool output_strong_file_pad(void)
 		return false;
 	}
 
-	position = OUTPUT_STRONG_FILE_TO_RISCOS(ftell(output_strong_file_handle));
+	if (!output_strong_file_get_position(&position))
+		return false;
 	padding = OUTPUT_STRONG_FILE_PADDING(position);
 
 	for (; padding > 0; padding--) {
-		if (fputc('\0', output_strong_file_handle) == EOF) {
+		if (!output_file_write_char(output_strong_file_handle, '\0')) {
 			msg_report(MSG_WRITE_FAILED);
 			return false;
 		}
@@ -937,3 +1516,31 @@ static bool output_strong_file_pad(void)
 	return true;
 }
 
+/**
+ * Find the current position in the StrongHelp output file, checking
+ * that it can be recorded in the file's 32-bit catalogue.
+ *
+ * \param *position	Pointer to a variable to return the position.
+ * \return		True if successful; False on failure.
+ */
+
+static bool output_strong_file_get_position(size_t *position)
+{
+	int64_t	offset;
+
+	offset = output_file_tell(output_strong_file_handle);
+
+	if (offset < 0) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
+
+	if (offset > (int64_t) OUTPUT_STRONG_FILE_MAX_OFFSET) {
+		msg_report(MSG_STRONG_TOO_LARGE);
+		return false;
+	}
+
+	*position = offset;
+
+	return true;
+}
@@ -31,8 +31,19 @@
 #define XMLMAN_OUTPUT_STRONG_FILE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "filename.h"
+#include "manual_data.h"
+
+/**
+ * Initialise the StrongHelp file output engine.
+ *
+ * \param stream	True to stream files sequentially, buffering each
+ *			file in memory so that the output is never seeked.
+ */
+
+void output_strong_file_initialise(bool stream);
 
 /**
  * Open a file to write the StrongHelp output to.
@@ -67,6 +78,38 @@ bool output_strong_file_sub_open(struct filename *filename, int type);
 
 bool output_strong_file_sub_close(void);
 
+/**
+ * Start capturing the output written to the current file within the
+ * StrongHelp output file into memory, until the capture is closed.
+ *
+ * \return		True on success; False on failure.
+ */
+
+bool output_strong_file_open_capture(void);
+
+/**
+ * Stop capturing output into memory, and return to writing to the
+ * current file within the StrongHelp output file.
+ *
+ * \param **data	Pointer to a variable to take a pointer to the captured
+ *			data, which the caller must free().
+ * \param *length	Pointer to a variable to take the length of the data.
+ * \return		True on success; False on failure.
+ */
+
+bool output_strong_file_close_capture(void **data, size_t *length);
+
+/**
+ * Write a block of data to the current StrongHelp output file, without
+ * any conversion, as it was previously captured.
+ *
+ * \param *data		Pointer to the data to be written.
+ * \param length	The length of the data, in bytes.
+ * \return		True if successful; False on error.
+ */
+
+bool output_strong_file_write_data(void *data, size_t length);
+
 /**
  * Write a UTF8 string to the current StrongHelp output file, in the
  * currently selected encoding.
@@ -77,6 +120,17 @@ bool output_strong_file_sub_close(void);
 
 bool output_strong_file_write_text(char *text);
 
+/**
+ * Write the text of a TEXT chunk to the current StrongHelp output file, in the
+ * currently selected encoding, using the encoded text cache if it is
+ * in use.
+ *
+ * \param *chunk	Pointer to the chunk to be written.
+ * \return		True if successful; False on error.
+ */
+
+bool output_strong_file_write_chunk(struct manual_data *chunk);
+
 /**
  * Write an ASCII string to the output.
  *
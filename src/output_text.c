@@ -39,12 +39,14 @@
 #include "encoding.h"
 #include "filename.h"
 #include "list_numbers.h"
+#include "manifest.h"
 #include "manual_data.h"
-#include "manual_ids.h"
 #include "manual_queue.h"
 #include "modes.h"
 #include "msg.h"
 #include "output_text_line.h"
+#include "output_render.h"
+#include "profile.h"
 
 /* Static constants. */
 
@@ -92,17 +94,91 @@ static int output_text_page_width = 77;
 
 static struct filename *output_text_root_filename;
 
+/**
+ * The incremental build manifest for the output, or NULL.
+ */
+
+static struct manifest *output_text_manifest;
+
+/**
+ * The folder into which streamed output is written.
+ */
+
+static struct filename *output_text_stream_filename = NULL;
+
+/**
+ * The file being written by streamed output, or NULL if none is open.
+ */
+
+static struct filename *output_text_stream_file = NULL;
+
+/**
+ * The encoding to use for streamed output.
+ */
+
+static enum encoding_target output_text_stream_encoding = ENCODING_TARGET_NONE;
+
+/**
+ * The line ending to use for streamed output.
+ */
+
+static enum encoding_line_end output_text_stream_line_end = ENCODING_LINE_END_NONE;
+
+/**
+ * The level of the contents of the manual being streamed.
+ */
+
+static int output_text_stream_level = OUTPUT_TEXT_BASE_LEVEL;
+
 /**
  * The bullets that we will use for unordered lists.
  */
 
 static char *output_text_unordered_list_bullets[] = { "*", "+", ">", NULL };
 
+/**
+ * The rendering of the inline spans, with the decoration enclosing the text.
+ */
+
+static struct output_render_span output_text_spans[] = {
+	{MANUAL_DATA_OBJECT_TYPE_CITATION,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_CODE,			OUTPUT_RENDER_SPAN_WRAP,	"\""},
+	{MANUAL_DATA_OBJECT_TYPE_COMMAND,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_CONSTANT,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_EVENT,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_FILENAME,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_FUNCTION,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_ICON,			OUTPUT_RENDER_SPAN_WRAP,	"'"},
+	{MANUAL_DATA_OBJECT_TYPE_INTRO,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_KEY,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_KEYWORD,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"/"},
+	{MANUAL_DATA_OBJECT_TYPE_LINK,			OUTPUT_RENDER_SPAN_LINK,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MATHS,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MENU,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MESSAGE,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_MOUSE,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_NAME,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_REFERENCE,		OUTPUT_RENDER_SPAN_REFERENCE,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS,	OUTPUT_RENDER_SPAN_WRAP,	"*"},
+	{MANUAL_DATA_OBJECT_TYPE_SWI,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_TYPE,			OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_USER_ENTRY,		OUTPUT_RENDER_SPAN_WRAP,	"\""},
+	{MANUAL_DATA_OBJECT_TYPE_VARIABLE,		OUTPUT_RENDER_SPAN_PLAIN,	NULL},
+	{MANUAL_DATA_OBJECT_TYPE_WINDOW,		OUTPUT_RENDER_SPAN_PLAIN,	NULL}
+};
+
 /* Static Function Prototypes. */
 
 static bool output_text_write_manual(struct manual_data *chapter, struct filename *folder);
 static bool output_text_write_file(struct manual_data *object, struct filename *folder, bool single_file);
 static bool output_text_write_object(struct manual_data *object, bool root, int level);
+static enum manual_data_walk_action output_text_enter_object(struct manual_data *object, bool root, int *level);
+static enum manual_data_walk_action output_text_walk_object_enter(struct manual_data_walk_frame *frame, void *data);
+static bool output_text_walk_object_leave(struct manual_data_walk_frame *frame, void *data);
+static bool output_text_write_object_head(struct manual_data *object, bool root, int *level);
+static bool output_text_write_object_block(struct manual_data *object, struct manual_data *block, int level);
+static bool output_text_write_object_foot(struct manual_data *object, bool root);
 static bool output_text_write_file_head(struct manual_data *manual);
 static bool output_text_write_page_head(struct manual_data *manual, int level);
 static bool output_text_write_page_foot(struct manual_data *manual);
@@ -113,11 +189,16 @@ static bool output_text_write_block_collection_object(struct manual_data *object
 static bool output_text_write_footnote(struct manual_data *object, int column);
 static bool output_text_write_callout(struct manual_data *object, int column);
 static bool output_text_write_list(struct manual_data *object, int column, int level);
+static enum manual_data_walk_action output_text_walk_list_enter(struct manual_data_walk_frame *frame, void *data);
+static bool output_text_walk_list_leave(struct manual_data_walk_frame *frame, void *data);
+static enum manual_data_walk_action output_text_enter_list(struct manual_data *object, int column, int level, struct list_numbers **numbers);
 static bool output_text_write_table(struct manual_data *object, int target_column);
+static bool output_text_write_table_contents(struct manual_data *object, int target_column);
 static bool output_text_write_code_block(struct manual_data *object, int column);
 static bool output_text_write_paragraph(struct manual_data *object, int column, bool last_item);
 static bool output_text_write_reference(struct manual_data *target);
 static bool output_text_write_text(int column, enum manual_data_object_type type, struct manual_data *text);
+static bool output_text_write_text_contents(int column, enum manual_data_object_type type, struct manual_data *text);
 static bool output_text_write_span_enclosed(int column, enum manual_data_object_type type, char *string, struct manual_data *text);
 static bool output_text_write_inline_link(int column, struct manual_data *link);
 static bool output_text_write_inline_reference(int column, struct manual_data *reference);
@@ -155,13 +236,167 @@ bool output_text(struct manual *document, struct filename *filename, enum encodi
 
 	output_text_root_filename = filename_make(OUTPUT_TEXT_ROOT_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
 
+	output_text_manifest = manifest_open(filename, MODES_TYPE_TEXT, encoding, line_end);
+
 	result = output_text_write_manual(document->manual, filename);
 
+	manifest_close(output_text_manifest, result);
+
 	filename_destroy(output_text_root_filename);
 
 	return result;
 }
 
+/**
+ * Prepare to output a manual in text form, one top-level node at a time
+ * as it is parsed.
+ *
+ * \param *filename	The filename to use to write to.
+ * \param encoding	The encoding to use for output.
+ * \param line_end	The line ending to use for output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_initialise(struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end)
+{
+	if (filename == NULL)
+		return false;
+
+	output_text_stream_filename = filename;
+	output_text_stream_encoding = encoding;
+	output_text_stream_line_end = line_end;
+
+	output_text_stream_file = NULL;
+
+	return true;
+}
+
+/**
+ * Start streamed text output, opening the file and writing the manual's
+ * page heading.
+ *
+ * \param *manual	The manual to be output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_start(struct manual_data *manual)
+{
+	struct filename *foldername = NULL;
+
+	if (manual == NULL || output_text_stream_filename == NULL)
+		return false;
+
+	msg_report(MSG_START_MODE, "Text");
+
+	/* Output encoding defaults to UTF8. */
+
+	encoding_select_table((output_text_stream_encoding != ENCODING_TARGET_NONE) ? output_text_stream_encoding : ENCODING_TARGET_UTF8);
+
+	/* Output line endings default to LF. */
+
+	encoding_select_line_end((output_text_stream_line_end != ENCODING_LINE_END_NONE) ? output_text_stream_line_end : ENCODING_LINE_END_LF);
+
+	output_text_root_filename = filename_make(OUTPUT_TEXT_ROOT_FILENAME, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LINUX);
+
+	/* Confirm that this is a manual. */
+
+	if (manual->type != MANUAL_DATA_OBJECT_TYPE_MANUAL) {
+		msg_report(MSG_UNEXPECTED_BLOCK, manual_data_find_object_name(MANUAL_DATA_OBJECT_TYPE_MANUAL),
+				manual_data_find_object_name(manual->type));
+		return false;
+	}
+
+	manual_queue_initialise();
+
+	/* An empty manual doesn't get a file, as with normal output. */
+
+	if (manual->first_child == NULL)
+		return true;
+
+	/* Find the file and folder names, and open the file. */
+
+	output_text_stream_file = filename_make(NULL, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_NONE);
+	if (output_text_stream_file == NULL)
+		return false;
+
+	if (!filename_prepend(output_text_stream_file, output_text_stream_filename, 0))
+		return false;
+
+	foldername = filename_up(output_text_stream_file, 1);
+	if (foldername == NULL)
+		return false;
+
+	if (!filename_mkdir(foldername, true)) {
+		filename_destroy(foldername);
+		return false;
+	}
+
+	filename_destroy(foldername);
+
+	if (!output_text_line_open(output_text_stream_file, output_text_page_width)) {
+		filename_destroy(output_text_stream_file);
+		output_text_stream_file = NULL;
+		return false;
+	}
+
+	/* Set up a default column on the top level line, and write the heading. */
+
+	if (!output_text_line_add_column(0, OUTPUT_TEXT_LINE_FULL_WIDTH))
+		return false;
+
+	if (!output_text_write_file_head(manual))
+		return false;
+
+	output_text_stream_level = OUTPUT_TEXT_BASE_LEVEL;
+
+	return output_text_write_object_head(manual, true, &output_text_stream_level);
+}
+
+/**
+ * Write a top-level node of a manual out to a streamed text file.
+ *
+ * \param *object	The object to be output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_write(struct manual_data *object)
+{
+	if (object == NULL || object->parent == NULL || output_text_stream_file == NULL)
+		return false;
+
+	return output_text_write_object_block(object->parent, object, output_text_stream_level);
+}
+
+/**
+ * End streamed text output, writing the page footer if successful and
+ * then closing the file.
+ *
+ * \param *manual	The manual being output.
+ * \param success	TRUE if the output has been successful so far.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_end(struct manual_data *manual, bool success)
+{
+	if (output_text_stream_file != NULL) {
+		if (success && (!output_text_write_object_foot(manual, true) || !output_text_write_file_foot(manual)))
+			success = false;
+
+		output_text_line_close();
+
+		if (success && !filename_set_type(output_text_stream_file, FILENAME_FILETYPE_TEXT))
+			success = false;
+
+		filename_destroy(output_text_stream_file);
+		output_text_stream_file = NULL;
+	}
+
+	filename_destroy(output_text_root_filename);
+	output_text_root_filename = NULL;
+
+	return success;
+}
+
 /**
  * Process the contents of a chapter block and write it out.
  *
@@ -190,6 +425,13 @@ static bool output_text_write_manual(struct manual_data *manual, struct filename
 
 	single_file = !manual_data_find_filename_data(manual, MODES_TYPE_TEXT);
 
+	/* Output can only be sent to stdout if it's a single file. */
+
+	if (!single_file && filename_is_stdio(folder)) {
+		msg_report(MSG_OUTPUT_STDIO_MULTIPLE);
+		return false;
+	}
+
 	/* Initialise the manual queue. */
 
 	manual_queue_initialise();
@@ -203,8 +445,12 @@ static bool output_text_write_manual(struct manual_data *manual, struct filename
 		if (object == NULL)
 			continue;
 
-		if (!output_text_write_file(object, folder, single_file))
+		if (!output_text_write_file(object, folder, single_file)) {
+			manual_queue_complete_node(false);
 			return false;
+		}
+
+		manual_queue_complete_node(true);
 	} while (object != NULL);
 
 	return true;
@@ -258,6 +504,15 @@ static bool output_text_write_file(struct manual_data *object, struct filename *
 		return false;
 	}
 
+	/* If the file is up to date, only the files hanging off it need
+	 * to be considered.
+	 */
+
+	if (manifest_check_file(output_text_manifest, object, filename)) {
+		filename_destroy(filename);
+		return manual_queue_add_file_children(object, MODES_TYPE_TEXT);
+	}
+
 	foldername = filename_up(filename, 1);
 	if (foldername == NULL) {
 		filename_destroy(filename);
@@ -326,7 +581,8 @@ static bool output_text_write_file(struct manual_data *object, struct filename *
 }
 
 /**
- * Process the contents of an index, chapter or section block and write it out.
+ * Process the contents of an index, chapter or section block and write it out,
+ * walking any nested sections without recursion.
  *
  * \param *object	The object to process.
  * \param root		True if the object is at the root of a file.
@@ -336,12 +592,121 @@ static bool output_text_write_file(struct manual_data *object, struct filename *
 
 static bool output_text_write_object(struct manual_data *object, bool root, int level)
 {
-	struct manual_data	*block;
+	switch (output_text_enter_object(object, root, &level)) {
+	case MANUAL_DATA_WALK_STOP:
+		return false;
+	case MANUAL_DATA_WALK_SKIP:
+		return true;
+	case MANUAL_DATA_WALK_DESCEND:
+		break;
+	}
+
+	if (!manual_data_walk(object->first_child, object, true, level,
+			output_text_walk_object_enter, output_text_walk_object_leave, NULL))
+		return false;
+
+	return output_text_write_object_foot(object, root);
+}
+
+/**
+ * Start an index, chapter or section block, writing its heading. If the
+ * block is to be written to a separate file, it is queued for writing
+ * later and a reference is written in its place.
+ *
+ * \param *object	The object to process.
+ * \param root		True if the object is at the root of a file.
+ * \param *level	Pointer to the level to write the section at, starting
+ *			from 0, which is updated to the level of the contents.
+ * \return		The action to take with the object's contents.
+ */
+
+static enum manual_data_walk_action output_text_enter_object(struct manual_data *object, bool root, int *level)
+{
 	struct manual_data_mode *resources = NULL;
 
 	if (object == NULL || object->first_child == NULL)
-		return true;
+		return MANUAL_DATA_WALK_SKIP;
+
+	if (!output_text_write_object_head(object, root, level))
+		return MANUAL_DATA_WALK_STOP;
+
+	resources = modes_find_resources(object->chapter.resources, MODES_TYPE_TEXT);
+
+	/* If this is a separate file, queue it for writing later. Otherwise,
+	 * the objects which fall within it must be written.
+	 */
+
+	if (resources != NULL && !root && (resources->filename != NULL || resources->folder != NULL)) {
+		if (object->chapter.resources->summary != NULL &&
+				!output_text_write_paragraph(object->chapter.resources->summary, 0, true))
+			return MANUAL_DATA_WALK_STOP;
+
+		if (!output_text_line_write_newline() || !output_text_write_reference(object))
+			return MANUAL_DATA_WALK_STOP;
+
+		manual_queue_add_node(object);
+
+		return MANUAL_DATA_WALK_SKIP;
+	}
+
+	return MANUAL_DATA_WALK_DESCEND;
+}
+
+/**
+ * Enter one of the blocks within an index, chapter or section block,
+ * during a walk of the object's contents.
+ *
+ * \param *frame	The walk frame for the block.
+ * \param *data		Unused.
+ * \return		The action for the walk to take.
+ */
+
+static enum manual_data_walk_action output_text_walk_object_enter(struct manual_data_walk_frame *frame, void *data)
+{
+	switch (frame->node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		frame->level = manual_data_get_nesting_level(frame->node, frame->level);
+		return output_text_enter_object(frame->node, false, &frame->level);
+
+	default:
+		if (!output_text_write_object_block(frame->parent, frame->node, frame->level))
+			return MANUAL_DATA_WALK_STOP;
+		return MANUAL_DATA_WALK_SKIP;
+	}
+}
+
+/**
+ * Leave an index, chapter or section block, once its contents have been
+ * walked.
+ *
+ * \param *frame	The walk frame for the block.
+ * \param *data		Unused.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_text_walk_object_leave(struct manual_data_walk_frame *frame, void *data)
+{
+	if (frame->failed)
+		return false;
+
+	return output_text_write_object_foot(frame->node, false);
+}
+
+/**
+ * Write the heading of an index, chapter or section block, and set up
+ * the indent for its contents.
+ *
+ * \param *object	The object to process.
+ * \param root		True if the object is at the root of a file.
+ * \param *level	Pointer to the level to write the section at, starting
+ *			from 0, which is updated to the level of the contents.
+ * \return		True if successful; False on error.
+ */
 
+static bool output_text_write_object_head(struct manual_data *object, bool root, int *level)
+{
 	/* Confirm that this is a suitable object. */
 
 	switch (object->type) {
@@ -356,12 +721,10 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 		return false;
 	}
 
-	resources = modes_find_resources(object->chapter.resources, MODES_TYPE_TEXT);
-
 	/* Check that the nesting depth is OK and sort out the indents. */
 
-	if (level > OUTPUT_TEXT_MAX_SECTION_LEVEL) {
-		msg_report(MSG_TOO_DEEP, level);
+	if (*level > OUTPUT_TEXT_MAX_SECTION_LEVEL) {
+		msg_report(MSG_TOO_DEEP, *level);
 		return false;
 	}
 
@@ -369,7 +732,7 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 	 * parent level after level 3.
 	 */
 
-	if (!output_text_line_push_absolute((level > 2) ? ((level - 2) * OUTPUT_TEXT_BLOCK_INDENT) : OUTPUT_TEXT_NO_INDENT))
+	if (!output_text_line_push_absolute((*level > 2) ? ((*level - 2) * OUTPUT_TEXT_BLOCK_INDENT) : OUTPUT_TEXT_NO_INDENT))
 		return false;
 
 	if (!output_text_line_add_column(0, OUTPUT_TEXT_LINE_FULL_WIDTH))
@@ -380,7 +743,7 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 	 */
 
 	if (root == true) {
-		if (!output_text_write_page_head(object, level))
+		if (!output_text_write_page_head(object, *level))
 			return false;
 
 		/* If we're starting at a section, skip up a level to
@@ -389,7 +752,7 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 		 */
 
 		if (object->type == MANUAL_DATA_OBJECT_TYPE_SECTION)
-			level++;
+			(*level)++;
 	} else if (object->title != NULL) {
 		if (!output_text_line_write_newline())
 			return false;
@@ -405,137 +768,142 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 
 	/* Push the body indent. */
 
-	if (!output_text_line_push_absolute(((level > 2) ? (level - 2) : (level - 1)) * OUTPUT_TEXT_BLOCK_INDENT))
+	if (!output_text_line_push_absolute(((*level > 2) ? (*level - 2) : (*level - 1)) * OUTPUT_TEXT_BLOCK_INDENT))
 		return false;
 
 	if (!output_text_line_add_column(0, OUTPUT_TEXT_LINE_FULL_WIDTH))
 		return false;
 
-	/* If this is a separate file, queue it for writing later. Otherwise,
-	 * write the objects which fall within it.
-	 */
+	return true;
+}
 
-	if (resources != NULL && !root && (resources->filename != NULL || resources->folder != NULL)) {
-		if (object->chapter.resources->summary != NULL &&
-				!output_text_write_paragraph(object->chapter.resources->summary, 0, true))
-			return false;
+/**
+ * Write out one of the blocks within an index, chapter or section block.
+ *
+ * \param *object	The object containing the block.
+ * \param *block	The block to write out.
+ * \param level		The level of the object's contents.
+ * \return		True if successful; False on error.
+ */
 
-		if (!output_text_line_write_newline() || !output_text_write_reference(object))
+static bool output_text_write_object_block(struct manual_data *object, struct manual_data *block, int level)
+{
+	switch (block->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		if (!output_text_write_object(block, false, manual_data_get_nesting_level(block, level)))
 			return false;
+		break;
 
-		manual_queue_add_node(object);
-
-		return true;
-	} else {
-		block = object->first_child;
-
-		while (block != NULL) {
-			switch (block->type) {
-			case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-			case MANUAL_DATA_OBJECT_TYPE_INDEX:
-			case MANUAL_DATA_OBJECT_TYPE_SECTION:
-				if (!output_text_write_object(block, false, manual_data_get_nesting_level(block, level)))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
+		if (object->type == MANUAL_DATA_OBJECT_TYPE_MANUAL) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
-				if (object->type == MANUAL_DATA_OBJECT_TYPE_MANUAL) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		/* The chapter list is treated like a section, so we always bump the level. */
 
-				/* The chapter list is treated like a section, so we always bump the level. */
+		if (!output_text_write_chapter_list(block, manual_data_get_nesting_level(block, level)))
+			return false;
+		break;
 
-				if (!output_text_write_chapter_list(block, manual_data_get_nesting_level(block, level)))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_PARAGRAPH:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_PARAGRAPH:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_paragraph(block, 0, true))
+			return false;
+		break;
 
-				if (!output_text_write_paragraph(block, 0, true))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST:
+	case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST:
-			case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_list(block, 0, 0))
+			return false;
+		break;
 
-				if (!output_text_write_list(block, 0, 0))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_TABLE:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_table(block, 0))
+			return false;
+		break;
 
-				if (!output_text_write_table(block, 0))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_CALLOUT:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_CALLOUT:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_callout(block, 0))
+			return false;
+		break;
 
-				if (!output_text_write_callout(block, 0))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_code_block(block, 0))
+			return false;
+		break;
 
-				if (!output_text_write_code_block(block, 0))
-					return false;
-				break;
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(block->type),
+					manual_data_find_object_name(object->type));
+			break;
+		}
 
-			case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
-				if (object->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-					msg_report(MSG_UNEXPECTED_CHUNK,
-							manual_data_find_object_name(block->type),
-							manual_data_find_object_name(object->type));
-					break;
-				}
+		if (!output_text_write_footnote(block, 0))
+			return false;
+		break;
 
-				if (!output_text_write_footnote(block, 0))
-					return false;
-				break;
+	default:
+		msg_report(MSG_UNEXPECTED_CHUNK,
+				manual_data_find_object_name(block->type),
+				manual_data_find_object_name(object->type));
+		break;
+	}
 
-			default:
-				msg_report(MSG_UNEXPECTED_CHUNK,
-						manual_data_find_object_name(block->type),
-						manual_data_find_object_name(object->type));
-				break;
-			}
+	return true;
+}
 
-			block = block->next;
-		}
-	}
+/**
+ * Complete an index, chapter or section block, once its contents have
+ * been written.
+ *
+ * \param *object	The object being processed.
+ * \param root		True if the object is at the root of a file.
+ * \return		True if successful; False on error.
+ */
 
+static bool output_text_write_object_foot(struct manual_data *object, bool root)
+{
 	/* Pop the indent. */
 
 	if (!output_text_line_pop())
@@ -546,7 +914,6 @@ static bool output_text_write_object(struct manual_data *object, bool root, int
 	if (root == true && !output_text_write_page_foot(object))
 		return false;
 
-
 	return true;
 }
 
@@ -973,12 +1340,8 @@ static bool output_text_write_footnote(struct manual_data *object, int column)
 	if (number == NULL)
 		return false;
 
-	if (!output_text_line_add_text(column, number)) {
-		free(number);
+	if (!output_text_line_add_text(column, number))
 		return false;
-	}
-
-	free(number);
 
 	if (!output_text_line_write(false, false))
 		return false;
@@ -1135,7 +1498,8 @@ static bool output_text_write_callout(struct manual_data *object, int column)
 }
 
 /**
- * Write the contents of a list to the output.
+ * Write the contents of a list to the output, walking any nested lists
+ * without recursion.
  *
  * \param *object		The object to process.
  * \param column		The column to align the object with.
@@ -1144,13 +1508,132 @@ static bool output_text_write_callout(struct manual_data *object, int column)
  */
 
 static bool output_text_write_list(struct manual_data *object, int column, int level)
+{
+	if (object == NULL)
+		return false;
+
+	return manual_data_walk(object, object->parent, false, level,
+			output_text_walk_list_enter, output_text_walk_list_leave, &column);
+}
+
+/**
+ * Enter one of the nodes within a list, during a walk of the list's
+ * contents. Lists hold items, and the items hold block collections,
+ * which can in turn contain further lists.
+ *
+ * \param *frame		The walk frame for the node.
+ * \param *data			Pointer to the column to align the list with.
+ * \return			The action for the walk to take.
+ */
+
+static enum manual_data_walk_action output_text_walk_list_enter(struct manual_data_walk_frame *frame, void *data)
+{
+	struct manual_data *node = frame->node;
+
+	/* The list at the top of the walk. */
+
+	if (frame->up == NULL)
+		return output_text_enter_list(node, *((int *) data), frame->level, (struct list_numbers **) &frame->handle);
+
+	/* The items within a list. */
+
+	if (frame->parent->type != MANUAL_DATA_OBJECT_TYPE_LIST_ITEM) {
+		if (node->type != MANUAL_DATA_OBJECT_TYPE_LIST_ITEM) {
+			msg_report(MSG_UNEXPECTED_CHUNK,
+					manual_data_find_object_name(node->type),
+					manual_data_find_object_name(frame->parent->type));
+			return MANUAL_DATA_WALK_SKIP;
+		}
+
+		if (!output_text_line_reset())
+			return MANUAL_DATA_WALK_STOP;
+
+		if (!output_text_line_add_text(0, list_numbers_get_next_entry(frame->up->handle)))
+			return MANUAL_DATA_WALK_STOP;
+
+		return MANUAL_DATA_WALK_DESCEND;
+	}
+
+	/* The blocks within a list item. The line for the first block should
+	 * come pre-configured from the list, with content set up.
+	 *
+	 * If changing this switch, note the analogous lists in
+	 * output_text_write_block_collection_object() and
+	 * output_html_write_section_object() which cover similar
+	 * block level objects.
+	 */
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_PARAGRAPH:
+		if (!output_text_write_paragraph(node, 1, true))
+			return MANUAL_DATA_WALK_STOP;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST:
+	case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
+		return output_text_enter_list(node, 1, ++frame->level, (struct list_numbers **) &frame->handle);
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		if (!output_text_write_table(node, 1))
+			return MANUAL_DATA_WALK_STOP;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+		if (!output_text_write_code_block(node, 1))
+			return MANUAL_DATA_WALK_STOP;
+		break;
+
+	default:
+		msg_report(MSG_UNEXPECTED_CHUNK,
+				manual_data_find_object_name(node->type),
+				manual_data_find_object_name(frame->parent->type));
+		break;
+	}
+
+	return MANUAL_DATA_WALK_SKIP;
+}
+
+/**
+ * Leave a list or list item, once its contents have been walked.
+ *
+ * \param *frame		The walk frame for the node.
+ * \param *data			Unused.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_text_walk_list_leave(struct manual_data_walk_frame *frame, void *data)
+{
+	if (frame->node->type == MANUAL_DATA_OBJECT_TYPE_LIST_ITEM)
+		return !frame->failed;
+
+	list_numbers_destroy(frame->handle);
+	frame->handle = NULL;
+
+	if (frame->failed)
+		return false;
+
+	return output_text_line_pop();
+}
+
+/**
+ * Start writing a list to the output, setting up its numbers or bullets
+ * and the columns for its items.
+ *
+ * \param *object		The object to process.
+ * \param column		The column to align the object with.
+ * \param level			The list nesting level.
+ * \param **numbers		Pointer to a location in which to return
+ *				the list numbers, to be destroyed once the
+ *				list is complete.
+ * \return			The action to take with the list's contents.
+ */
+
+static enum manual_data_walk_action output_text_enter_list(struct manual_data *object, int column, int level, struct list_numbers **numbers)
 {
 	struct manual_data *item;
-	struct list_numbers *numbers = NULL;
 	int entries = 0;
 
-	if (object == NULL)
-		return false;
+	*numbers = NULL;
 
 	/* Confirm that this is a list. */
 
@@ -1161,14 +1644,14 @@ static bool output_text_write_list(struct manual_data *object, int column, int l
 	default:
 		msg_report(MSG_UNEXPECTED_BLOCK, manual_data_find_object_name(MANUAL_DATA_OBJECT_TYPE_ORDERED_LIST),
 				manual_data_find_object_name(object->type));
-		return false;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* If the current output line has content, we can't add to it. */
 
 	if (output_text_line_has_content()) {
 		msg_report(MSG_TEXT_LINE_NOT_EMPTY, manual_data_find_object_name(object->type));
-		return false;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* Set the list numbers or bullets up. */
@@ -1182,37 +1665,30 @@ static bool output_text_write_list(struct manual_data *object, int column, int l
 			item = item->next;
 		}
 
-		numbers = list_numbers_create_ordered(entries, level);
+		*numbers = list_numbers_create_ordered(entries, level);
 		break;
 
 	case MANUAL_DATA_OBJECT_TYPE_UNORDERED_LIST:
-		numbers = list_numbers_create_unordered(output_text_unordered_list_bullets, level);
+		*numbers = list_numbers_create_unordered(output_text_unordered_list_bullets, level);
 		break;
 
 	default:
 		break;
 	}
 
-	if (numbers == NULL) {
+	if (*numbers == NULL) {
 		msg_report(MSG_BAD_LIST_NUMBERS);
-		return false;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* Output the list. */
 
-	if (!output_text_line_push_to_column(column, OUTPUT_TEXT_NO_INDENT, OUTPUT_TEXT_NO_INDENT)) {
-		list_numbers_destroy(numbers);
-		return false;
-	}
-
-	if (!output_text_line_add_column(0, list_numbers_get_max_length(numbers))) {
-		list_numbers_destroy(numbers);
-		return false;
-	}
-
-	if (!output_text_line_add_column(1, OUTPUT_TEXT_LINE_FULL_WIDTH)) {
-		list_numbers_destroy(numbers);
-		return false;
+	if (!output_text_line_push_to_column(column, OUTPUT_TEXT_NO_INDENT, OUTPUT_TEXT_NO_INDENT) ||
+			!output_text_line_add_column(0, list_numbers_get_max_length(*numbers)) ||
+			!output_text_line_add_column(1, OUTPUT_TEXT_LINE_FULL_WIDTH)) {
+		list_numbers_destroy(*numbers);
+		*numbers = NULL;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
 	/* If the list isn't nested in a list item, output a blank line
@@ -1225,58 +1701,47 @@ static bool output_text_write_list(struct manual_data *object, int column, int l
 //		return false;
 
 	if (!output_text_line_write_newline()) {
-		list_numbers_destroy(numbers);
-		return false;
+		list_numbers_destroy(*numbers);
+		*numbers = NULL;
+		return MANUAL_DATA_WALK_STOP;
 	}
 
-	item = object->first_child;
-
-	while (item != NULL) {
-		switch (item->type) {
-		case MANUAL_DATA_OBJECT_TYPE_LIST_ITEM:
-			if (!output_text_line_reset()) {
-				list_numbers_destroy(numbers);
-				return false;
-			}
-
-			if (!output_text_line_add_text(0, list_numbers_get_next_entry(numbers))) {
-				list_numbers_destroy(numbers);
-				return false;
-			}
+	return MANUAL_DATA_WALK_DESCEND;
+}
 
-			if (!output_text_write_block_collection_object(item, 1, level)) {
-				list_numbers_destroy(numbers);
-				return false;
-			}
-			break;
+/**
+ * Write the contents of a table to the output.
+ * The call is profiled, if profiling has been built in.
+ *
+ * \param *object		The object to process.
+ * \param target_column		The column to align the object with.
+ * \return			True if successful; False on error.
+ */
 
-		default:
-			msg_report(MSG_UNEXPECTED_CHUNK,
-					manual_data_find_object_name(item->type),
-					manual_data_find_object_name(object->type));
-			break;
-		}
+static bool output_text_write_table(struct manual_data *object, int target_column)
+{
+	bool result;
+	PROFILE_TIMER(timer);
 
-		item = item->next;
-	}
+	PROFILE_START(timer);
 
-	list_numbers_destroy(numbers);
+	result = output_text_write_table_contents(object, target_column);
 
-	if (!output_text_line_pop())
-		return false;
+	PROFILE_RECORD(timer, PROFILE_HOOK_TEXT_TABLE, (object != NULL) ? object->type : MANUAL_DATA_OBJECT_TYPE_NONE);
 
-	return true;
+	return result;
 }
 
 /**
- * Write the contents of a table to the output.
+ * Carry out the work of output_text_write_table(), which calls this so that it
+ * can be profiled.
  *
  * \param *object		The object to process.
  * \param target_column		The column to align the object with.
  * \return			True if successful; False on error.
  */
 
-static bool output_text_write_table(struct manual_data *object, int target_column)
+static bool output_text_write_table_contents(struct manual_data *object, int target_column)
 {
 	struct manual_data *column_set, *column, *row;
 	int c;
@@ -1641,6 +2106,7 @@ static bool output_text_write_reference(struct manual_data *target)
 
 /**
  * Write a block of text to a column in the current output line.
+ * The call is profiled, if profiling has been built in.
  *
  * \param column		The column in the line to write to.
  * \param type			The type of block which is expected.
@@ -1649,8 +2115,33 @@ static bool output_text_write_reference(struct manual_data *target)
  */
 
 static bool output_text_write_text(int column, enum manual_data_object_type type, struct manual_data *text)
+{
+	bool result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = output_text_write_text_contents(column, type, text);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_TEXT_TEXT, type);
+
+	return result;
+}
+
+/**
+ * Carry out the work of output_text_write_text(), which calls this so that it
+ * can be profiled.
+ *
+ * \param column		The column in the line to write to.
+ * \param type			The type of block which is expected.
+ * \param *text			The block of text to be written.
+ * \return			True if successful; False on error.
+ */
+
+static bool output_text_write_text_contents(int column, enum manual_data_object_type type, struct manual_data *text)
 {
 	struct manual_data *chunk;
+	struct output_render_span *span;
 	bool success = true;
 
 	/* An empty block doesn't require any output. */
@@ -1667,81 +2158,6 @@ static bool output_text_write_text(int column, enum manual_data_object_type type
 
 	while (success == true && chunk != NULL) {
 		switch (chunk->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CITATION:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_CITATION, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CODE:
-			success = output_text_write_span_enclosed(column, MANUAL_DATA_OBJECT_TYPE_CODE, "\"", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_COMMAND:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_COMMAND, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_CONSTANT:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_CONSTANT, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_EVENT:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_EVENT, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FILENAME:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_FILENAME, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_FUNCTION:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_FUNCTION, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_ICON:
-			success = output_text_write_span_enclosed(column, MANUAL_DATA_OBJECT_TYPE_ICON, "'", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_INTRO:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_INTRO, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEY:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_KEY, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_KEYWORD:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_KEYWORD, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS:
-			success = output_text_write_span_enclosed(column, MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS, "/", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_LINK:
-			success = output_text_write_inline_link(column, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MATHS:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_MATHS, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MENU:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_MENU, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MESSAGE:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_MESSAGE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_MOUSE:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_MOUSE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_NAME:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_NAME, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
-			success = output_text_write_inline_reference(column, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS:
-			success = output_text_write_span_enclosed(column, MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS, "*", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_SWI:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_SWI, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_TYPE:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_TYPE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_USER_ENTRY:
-			success = output_text_write_span_enclosed(column, MANUAL_DATA_OBJECT_TYPE_USER_ENTRY, "\"", chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_VARIABLE:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_VARIABLE, chunk);
-			break;
-		case MANUAL_DATA_OBJECT_TYPE_WINDOW:
-			success = output_text_write_text(column, MANUAL_DATA_OBJECT_TYPE_WINDOW, chunk);
-			break;
 		case MANUAL_DATA_OBJECT_TYPE_LINE_BREAK:
 			success = output_text_line_add_text(column, "\n");
 			break;
@@ -1752,9 +2168,29 @@ static bool output_text_write_text(int column, enum manual_data_object_type type
 			success = output_text_write_entity(column, chunk->chunk.entity);
 			break;
 		default:
-			msg_report(MSG_UNEXPECTED_CHUNK,
-					manual_data_find_object_name(chunk->type),
-					manual_data_find_object_name(text->type));
+			/* Anything else must be one of the inline spans. */
+
+			span = output_render_find_span(output_text_spans, chunk->type);
+
+			switch ((span != NULL) ? span->style : OUTPUT_RENDER_SPAN_NONE) {
+			case OUTPUT_RENDER_SPAN_PLAIN:
+				success = output_text_write_text(column, chunk->type, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_WRAP:
+				success = output_text_write_span_enclosed(column, chunk->type, span->decoration, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_LINK:
+				success = output_text_write_inline_link(column, chunk);
+				break;
+			case OUTPUT_RENDER_SPAN_REFERENCE:
+				success = output_text_write_inline_reference(column, chunk);
+				break;
+			default:
+				msg_report(MSG_UNEXPECTED_CHUNK,
+						manual_data_find_object_name(chunk->type),
+						manual_data_find_object_name(text->type));
+				break;
+			}
 			break;
 		}
 
@@ -1819,7 +2255,7 @@ static bool output_text_write_inline_link(int column, struct manual_data *link)
 
 	/* If there was link text, and flatten was applied, don't output the link itself. */
 
-	if (link->first_child != NULL && (link->chunk.flags & MANUAL_DATA_OBJECT_FLAGS_LINK_FLATTEN))
+	if (link->first_child != NULL && (link->flags & MANUAL_DATA_OBJECT_FLAGS_LINK_FLATTEN))
 		return true;
 
 	/* Write the link information. */
@@ -1865,7 +2301,7 @@ static bool output_text_write_inline_reference(int column, struct manual_data *r
 
 	/* Find the target object. */
 
-	target = manual_ids_find_node(reference);
+	target = reference->chunk.target;
 
 	/* Write the reference text. */
 
@@ -1925,12 +2361,8 @@ static bool output_text_write_inline_reference(int column, struct manual_data *r
 		if (number == NULL)
 			return false;
 
-		if (!output_text_line_add_text(column, number)) {
-			free(number);
+		if (!output_text_line_add_text(column, number))
 			return false;
-		}
-
-		free(number);
 
 		if (!output_text_line_add_text(column, "]"))
 			return false;
@@ -1963,12 +2395,8 @@ static bool output_text_write_title(int column, struct manual_data *node, bool i
 	number = manual_data_get_node_number(node, include_name);
 
 	if (number != NULL) {
-		if (!output_text_line_add_text(column, number)) {
-			free(number);
+		if (!output_text_line_add_text(column, number))
 			return false;
-		}
-
-		free(number);
 
 		if (include_title && !output_text_line_add_text(column, " "))
 			return false;
@@ -34,6 +34,7 @@
 #include "encoding.h"
 #include "filename.h"
 #include "manual.h"
+#include "manual_data.h"
 
 /**
  * Output a manual in text form.
@@ -47,5 +48,47 @@
 
 bool output_text(struct manual *document, struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end);
 
+/**
+ * Prepare to output a manual in text form, one top-level node at a time
+ * as it is parsed.
+ *
+ * \param *filename	The filename to use to write to.
+ * \param encoding	The encoding to use for output.
+ * \param line_end	The line ending to use for output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_initialise(struct filename *filename, enum encoding_target encoding, enum encoding_line_end line_end);
+
+/**
+ * Start streamed text output, opening the file and writing the manual's
+ * page heading.
+ *
+ * \param *manual	The manual to be output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_start(struct manual_data *manual);
+
+/**
+ * Write a top-level node of a manual out to a streamed text file.
+ *
+ * \param *object	The object to be output.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_write(struct manual_data *object);
+
+/**
+ * End streamed text output, writing the page footer if successful and
+ * then closing the file.
+ *
+ * \param *manual	The manual being output.
+ * \param success	TRUE if the output has been successful so far.
+ * \return		TRUE if successful, otherwise FALSE.
+ */
+
+bool output_text_stream_end(struct manual_data *manual, bool success);
+
 #endif
 
@@ -38,6 +38,57 @@
 #include "encoding.h"
 #include "filename.h"
 #include "msg.h"
+#include "output_file.h"
+
+/**
+ * The layout of one row of text within a column, as measured while
+ * sizing the columns in a line so that it can be reused when the row
+ * is written out. Positions are held as offsets into the column's
+ * text buffer.
+ */
+
+struct output_text_line_row {
+	/**
+	 * The position of the write pointer when the row was measured.
+	 */
+	size_t					from;
+
+	/**
+	 * The position of the first character to be written.
+	 */
+	size_t					start;
+
+	/**
+	 * The width available to the row, in characters.
+	 */
+	int					available_width;
+
+	/**
+	 * The number of characters to be written.
+	 */
+	int					breakpoint;
+
+	/**
+	 * True if the row contains nothing to write, and the column is
+	 * complete.
+	 */
+	bool					empty;
+
+	/**
+	 * True if a hyphen should follow the row.
+	 */
+	bool					hyphenate;
+
+	/**
+	 * True if a newline terminating the row should be skipped.
+	 */
+	bool					skip;
+
+	/**
+	 * True if the row completes the column.
+	 */
+	bool					complete;
+};
 
 /**
  * A column within a text line instance.
@@ -89,6 +140,38 @@ struct output_text_line_column {
 	 */
 	size_t					size;
 
+	/**
+	 * The length of the text in the column's buffer, excluding
+	 * the terminator.
+	 */
+	size_t					length;
+
+	/**
+	 * The display width of the text in the column's buffer, in
+	 * characters.
+	 */
+	int					text_width;
+
+	/**
+	 * The row layouts measured for the column's text, or NULL.
+	 */
+	struct output_text_line_row		*rows;
+
+	/**
+	 * The number of row layouts which the rows array can hold.
+	 */
+	size_t					row_size;
+
+	/**
+	 * The number of valid row layouts in the rows array.
+	 */
+	size_t					row_count;
+
+	/**
+	 * The index of the next row layout to be used in writing out.
+	 */
+	size_t					next_row;
+
 	/**
 	 * Pointer to the current position in the text during the
 	 * write-out operation, or NULL on completion.
@@ -139,6 +222,13 @@ struct output_text_line {
 
 	bool				is_prepared;
 
+	/**
+	 * Are the column positions and widths up to date with the columns
+	 * in the line? They're only recalculated when the columns change,
+	 * so that the rows of a table don't repeat the calculation.
+	 */
+	bool				widths_set;
+
 	/**
 	 * The linked list of columns in the line.
 	 */
@@ -161,25 +251,60 @@ struct output_text_line {
 };
 
 /**
- * The number of characters that we allocate at a time when adding text
- * to column buffers.
+ * The number of characters that we allocate for a new column buffer; the
+ * buffer's size is doubled each time that it fills up.
  */
 
 #define OUTPUT_TEXT_LINE_COLUMN_BLOCK_SIZE 2048
 
+/**
+ * The number of row layouts that we allocate for a new column; the
+ * array's size is doubled each time that it fills up.
+ */
+
+#define OUTPUT_TEXT_LINE_ROW_BLOCK_SIZE 16
+
 /**
  * The minimum column width in which hypjenation will occur.
  */
 
 #define OUTPUT_TEXT_LINE_HYPHENATION_LIMIT 3
 
+/**
+ * The number of bytes to allow for the line ending sequence at the end
+ * of the output buffer.
+ */
+
+#define OUTPUT_TEXT_LINE_NEWLINE_SPACE 4
+
 /* Global Variables. */
 
 /**
  * The output file handle.
  */
 
-static FILE *output_text_line_handle = NULL;
+static struct output_file *output_text_line_handle = NULL;
+
+/**
+ * The buffer in which each line of output is assembled in the target
+ * encoding, so that the columns of a row can be interleaved and sent to
+ * the file in one write instead of a character at a time.
+ */
+
+static char *output_text_line_buffer = NULL;
+
+/**
+ * The size of the output buffer, which is set to hold a full line of
+ * the page in the widest encoding.
+ */
+
+static size_t output_text_line_buffer_size = 0;
+
+/**
+ * The number of bytes waiting in the output buffer.
+ */
+
+static size_t output_text_line_buffer_length = 0;
 
 /**
  * The stack of output lines.
@@ -187,6 +312,20 @@ static FILE *output_text_line_handle = NULL;
 
 static struct output_text_line *output_text_line_stack = NULL;
 
+/**
+ * The pool of spare line instances, released from the stack and waiting
+ * to be reused.
+ */
+
+static struct output_text_line *output_text_line_free_lines = NULL;
+
+/**
+ * The pool of spare column instances, which retain their text buffers
+ * so that they can be reused without claiming more memory.
+ */
+
+static struct output_text_line_column *output_text_line_free_columns = NULL;
+
 /**
  * The width of the output page.
  */
@@ -197,6 +336,7 @@ static int output_text_line_page_width = 0;
 
 static struct output_text_line *output_text_line_create(int page_width, int left_margin);
 static void output_text_line_destroy(struct output_text_line *line);
+static void output_text_line_free_pools(void);
 static bool output_text_line_set_column_widths(struct output_text_line *line);
 static bool output_text_line_add_column_text(struct output_text_line_column *column, char *text);
 static bool output_text_line_update_column_memory(struct output_text_line_column *column);
@@ -205,10 +345,15 @@ static struct output_text_line_column* output_text_line_find_column(struct outpu
 static bool output_text_line_size_columns(struct output_text_line *line);
 static bool output_text_line_write_line(struct output_text_line *line, bool underline);
 static bool output_text_line_write_column(struct output_text_line_column *column, bool trial);
+static void output_text_line_measure_row(struct output_text_line_column *column, struct output_text_line_row *row);
+static bool output_text_line_store_row(struct output_text_line_column *column, struct output_text_line_row *row);
 static bool output_text_line_write_column_underline(struct output_text_line_column *column);
 static bool output_text_line_pad_to_column(struct output_text_line_column *column);
 static bool output_text_line_pad_to_position(struct output_text_line *line, int position);
 static bool output_text_line_write_char(struct output_text_line *line, int c);
+static bool output_text_line_write_chars(struct output_text_line *line, int unicode, int count);
+static bool output_text_line_buffer_chars(int unicode, int count);
+static bool output_text_line_flush_buffer(void);
 
 
 /**
@@ -221,12 +366,23 @@ static bool output_text_line_write_char(struct output_text_line *line, int c);
 
 bool output_text_line_open(struct filename *filename, int page_width)
 {
-	output_text_line_handle = filename_fopen(filename, "w");
+	output_text_line_handle = output_file_open(filename);
 	output_text_line_page_width = page_width;
 
 	if (output_text_line_handle == NULL)
 		return false;
 
+	output_text_line_buffer_length = 0;
+	output_text_line_buffer_size = (page_width + 1) * ENCODING_CHAR_BUF_LEN + OUTPUT_TEXT_LINE_NEWLINE_SPACE;
+
+	output_text_line_buffer = malloc(output_text_line_buffer_size);
+	if (output_text_line_buffer == NULL) {
+		msg_report(MSG_TEXT_LINE_MEM);
+		output_file_close(output_text_line_handle);
+		output_text_line_handle = NULL;
+		return false;
+	}
+
 	output_text_line_stack = output_text_line_create(page_width, 0);
 
 	return true;
@@ -238,17 +394,28 @@ bool output_text_line_open(struct filename *filename, int page_width)
 
 void output_text_line_close(void)
 {
-	/* Close the output file. */
+	/* Close the output file, once anything left in the buffer is written. */
 
 	if (output_text_line_handle != NULL) {
-		fclose(output_text_line_handle);
+		output_text_line_flush_buffer();
+
+		if (!output_file_close(output_text_line_handle))
+			msg_report(MSG_WRITE_FAILED);
+
 		output_text_line_handle = NULL;
 	}
 
+	free(output_text_line_buffer);
+	output_text_line_buffer = NULL;
+	output_text_line_buffer_size = 0;
+	output_text_line_buffer_length = 0;
+
 	/* Clear the line stack. */
 
 	while (output_text_line_stack != NULL)
 		output_text_line_pop();
+
+	output_text_line_free_pools();
 }
 
 /**
@@ -382,10 +549,17 @@ static struct output_text_line *output_text_line_create(int page_width, int left
 {
 	struct output_text_line *line = NULL;
 
-	line = malloc(sizeof(struct output_text_line));
-	if (line == NULL) {
-		msg_report(MSG_TEXT_LINE_MEM);
-		return NULL;
+	/* Reuse a spare line if there is one; otherwise claim a new one. */
+
+	if (output_text_line_free_lines != NULL) {
+		line = output_text_line_free_lines;
+		output_text_line_free_lines = line->next;
+	} else {
+		line = malloc(sizeof(struct output_text_line));
+		if (line == NULL) {
+			msg_report(MSG_TEXT_LINE_MEM);
+			return NULL;
+		}
 	}
 
 	line->columns = NULL;
@@ -394,12 +568,14 @@ static struct output_text_line *output_text_line_create(int page_width, int left
 	line->next = NULL;
 	line->is_prepared = false;
 	line->has_content = false;
+	line->widths_set = false;
 
 	return line;
 }
 
 /**
- * Destroy a text line output instance.
+ * Destroy a text line output instance, returning it and its columns to
+ * the pools for reuse.
  *
  * \param *line		The line output instance to destroy.
  */
@@ -413,24 +589,54 @@ static void output_text_line_destroy(struct output_text_line *line)
 	if (line == NULL)
 		return;
 
-	/* Free the column blocks. */
+	/* Return the column blocks to the pool, complete with their buffers. */
 
 	column = line->columns;
 
 	while (column != NULL) {
 		next = column->next;
 
-		if (column->text != NULL)
-			free(column->text);
-
-		free(column);
+		column->next = output_text_line_free_columns;
+		output_text_line_free_columns = column;
 
 		column = next;
 	}
 
-	/* Free the line block. */
+	line->columns = NULL;
+
+	/* Return the line block to the pool. */
 
-	free(line);
+	line->next = output_text_line_free_lines;
+	output_text_line_free_lines = line;
+}
+
+/**
+ * Free the pools of spare lines and columns.
+ */
+
+static void output_text_line_free_pools(void)
+{
+	struct output_text_line		*line = NULL;
+	struct output_text_line_column	*column = NULL;
+
+	while (output_text_line_free_lines != NULL) {
+		line = output_text_line_free_lines;
+		output_text_line_free_lines = line->next;
+		free(line);
+	}
+
+	while (output_text_line_free_columns != NULL) {
+		column = output_text_line_free_columns;
+		output_text_line_free_columns = column->next;
+
+		if (column->text != NULL)
+			free(column->text);
+
+		if (column->rows != NULL)
+			free(column->rows);
+
+		free(column);
+	}
 }
 
 /**
@@ -487,10 +693,22 @@ bool output_text_line_add_column(int margin, int width)
 		return false;
 	}
 
-	column = malloc(sizeof(struct output_text_line_column));
-	if (column == NULL) {
-		msg_report(MSG_TEXT_LINE_COL_MEM);
-		return false;
+	/* Reuse a spare column if there is one, keeping its text buffer. */
+
+	if (output_text_line_free_columns != NULL) {
+		column = output_text_line_free_columns;
+		output_text_line_free_columns = column->next;
+	} else {
+		column = malloc(sizeof(struct output_text_line_column));
+		if (column == NULL) {
+			msg_report(MSG_TEXT_LINE_COL_MEM);
+			return false;
+		}
+
+		column->text = NULL;
+		column->size = 0;
+		column->rows = NULL;
+		column->row_size = 0;
 	}
 
 	/* Find the previous column data. */
@@ -507,6 +725,8 @@ bool output_text_line_add_column(int margin, int width)
 	else
 		previous->next = column;
 
+	line->widths_set = false;
+
 	/* Initialise the column data. */
 
 	column->requested_margin = margin;
@@ -514,14 +734,21 @@ bool output_text_line_add_column(int margin, int width)
 	column->parent = line;
 	column->flags = OUTPUT_TEXT_LINE_COLUMN_FLAGS_NONE;
 	column->width = 0;
-	column->text = NULL;
-	column->size = 0;
+	column->length = 0;
+	column->text_width = 0;
+	column->row_count = 0;
+	column->next_row = 0;
 	column->write_ptr = NULL;
 	column->written_width = 0;
 	column->hanging_indent = 0;
 	column->blank_rows = 0;
 	column->next = NULL;
 
+	if (column->text != NULL) {
+		column->text[0] = '\0';
+		return true;
+	}
+
 	return output_text_line_update_column_memory(column);
 }
 
@@ -580,6 +807,10 @@ bool output_text_line_reset(void)
 		if (column->text != NULL && column->size > 0)
 			column->text[0] = '\0';
 
+		column->length = 0;
+		column->text_width = 0;
+		column->row_count = 0;
+		column->next_row = 0;
 		column->written_width = 0;
 		column->blank_rows = 0;
 		column->hanging_indent = 0;
@@ -587,9 +818,9 @@ bool output_text_line_reset(void)
 		column = column->next;
 	}
 
-	/* Calculate the column widths. */
+	/* Calculate the column widths, if the columns have changed. */
 
-	if (!output_text_line_set_column_widths(line))
+	if (!line->widths_set && !output_text_line_set_column_widths(line))
 		return false;
 
 	/* Mark the line as prepared. */
@@ -621,7 +852,7 @@ bool output_text_line_set_column_width(int column)
 	if (col == NULL)
 		return false;
 		
-	col->requested_width = encoding_get_utf8_string_length(col->text);
+	col->requested_width = col->text_width;
 
 	/* Recalculate the column widths. */
 
@@ -649,6 +880,8 @@ static bool output_text_line_set_column_widths(struct output_text_line *line)
 		return false;
 	}
 
+	line->widths_set = false;
+
 	/* Count up the known column widths. */
 
 	used_width = line->left_margin;
@@ -703,6 +936,8 @@ static bool output_text_line_set_column_widths(struct output_text_line *line)
 		column = column->next;
 	}
 
+	line->widths_set = success;
+
 	return success;
 }
 
@@ -749,7 +984,7 @@ bool output_text_line_add_text(int column, char *text)
 
 static bool output_text_line_add_column_text(struct output_text_line_column *column, char *text)
 {
-	int	write_ptr;
+	size_t	write_ptr, length;
 
 	if (column == NULL) {
 		msg_report(MSG_TEXT_LINE_BAD_COL_REF);
@@ -762,8 +997,8 @@ static bool output_text_line_add_column_text(struct output_text_line_column *col
 		return true;
 
 	/* Find the end of the text currently in the buffer. The buffer
-	 * should always be zero terminated, so if we get to the end
-	 * without a zero, there's a problem that we can't fix.
+	 * should always be zero terminated at the recorded length, so if
+	 * it isn't, there's a problem that we can't fix.
 	 */
 
 	if (column->text == NULL) {
@@ -771,33 +1006,42 @@ static bool output_text_line_add_column_text(struct output_text_line_column *col
 		return false;
 	}
 
-	write_ptr = 0;
-
-	while ((column->text[write_ptr] != '\0') && (write_ptr < column->size))
-		write_ptr++;
+	write_ptr = column->length;
 
-	if (column->text[write_ptr] != '\0') {
+	if (write_ptr >= column->size || column->text[write_ptr] != '\0') {
 		msg_report(MSG_UNKNOWN_MEM_ERROR);
 		return false;
 	}
 
-	/* The write_ptr is now pointing to the zero terminator, so
-	 * there is space to write the first character, at least.
-	 */
+	/* Any measured rows no longer match the text. */
 
-	while (*text != '\0') {
-		column->text[write_ptr++] = *text++;
+	column->row_count = 0;
+	column->next_row = 0;
+
+	/* Make sure that there's room for the text and its terminator,
+	 * then copy it in one go.
+	 */
 
-		/* If we're now out of memory, try to claim some more. */
+	length = strlen(text);
 
-		if ((write_ptr >= column->size) && !output_text_line_update_column_memory(column)) {
-			column->text[write_ptr - 1] = '\0';
+	while (write_ptr + length >= column->size) {
+		if (!output_text_line_update_column_memory(column)) {
 			msg_report(MSG_TEXT_LINE_NO_MEM);
 			return false;
 		}
 	}
 
-	column->text[write_ptr] = '\0';
+	memcpy(column->text + write_ptr, text, length + 1);
+	column->length = write_ptr + length;
+
+	/* Count the characters, skipping UTF8 continuation bytes. */
+
+	while (*text != '\0') {
+		if ((*text & 0xc0) != 0x80)
+			column->text_width++;
+
+		text++;
+	}
 
 	return true;
 }
@@ -811,7 +1055,8 @@ static bool output_text_line_add_column_text(struct output_text_line_column *col
 
 static bool output_text_line_update_column_memory(struct output_text_line_column *column)
 {
-	char *new;
+	char	*new;
+	size_t	offset = 0;
 
 	if (column == NULL) {
 		msg_report(MSG_TEXT_LINE_BAD_COL_REF);
@@ -830,11 +1075,20 @@ static bool output_text_line_update_column_memory(struct output_text_line_column
 		if (column->size > 0)
 			column->text[0] = '\0';
 	} else {
-		new = realloc(column->text, column->size + OUTPUT_TEXT_LINE_COLUMN_BLOCK_SIZE);
+		/* Any write pointer into the buffer must follow it if it moves. */
+
+		if (column->write_ptr != NULL)
+			offset = column->write_ptr - column->text;
+
+		new = realloc(column->text, column->size * 2);
 		if (new == NULL)
 			return false;
 
-		column->size += OUTPUT_TEXT_LINE_COLUMN_BLOCK_SIZE;
+		if (column->write_ptr != NULL)
+			column->write_ptr = new + offset;
+
+		column->text = new;
+		column->size *= 2;
 	}
 
 	return true;
@@ -919,7 +1173,7 @@ static bool output_text_line_set_column_hanging_indent(struct output_text_line_c
 				width++;
 		} while (c != '\0' && spaces > 0);
 	} else {
-		width = encoding_get_utf8_string_length(column->text);
+		width = column->text_width;
 	}
 
 	if (width >= column->width) {
@@ -1034,6 +1288,7 @@ static bool output_text_line_size_columns(struct output_text_line *line)
 	while (column != NULL) 
 	{
 		column->blank_rows = 0;
+		column->row_count = 0;
 
 		while (column->write_ptr != NULL) {
 			if (!output_text_line_write_column(column, true))
@@ -1043,6 +1298,7 @@ static bool output_text_line_size_columns(struct output_text_line *line)
 		}
 
 		column->write_ptr = column->text;
+		column->next_row = 0;
 
 		if (column->blank_rows > max_count)
 			max_count = column->blank_rows;
@@ -1107,7 +1363,9 @@ static bool output_text_line_write_line(struct output_text_line *line, bool unde
 }
 
 /**
- * Write one column from a line to the output.
+ * Write one column from a line to the output. On a trial run, the layout
+ * of the row is recorded so that it can be reused when the row is written
+ * out for real.
  *
  * \param *column	The current column instance.
  * \param trial		Is this a trial run?
@@ -1116,9 +1374,9 @@ static bool output_text_line_write_line(struct output_text_line *line, bool unde
 
 static bool output_text_line_write_column(struct output_text_line_column *column, bool trial)
 {
-	int	available_width, written_width, breakpoint, c;
-	char	*scan_ptr;
-	bool	hyphenate = false, skip = false, complete = false, preformat = false;
+	struct output_text_line_row	measured, *row = NULL;
+	int				available_width, breakpoint, c;
+	bool				hyphenate, skip, complete;
 
 	if (column == NULL) {
 		msg_report(MSG_TEXT_LINE_BAD_COL_REF);
@@ -1130,16 +1388,131 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 	if (column->write_ptr == NULL)
 		return true;
 
-	/* If there's no width, complete the line and exit. */
+	/* Use the layout measured on the trial run if there is one for the
+	 * current position; otherwise, measure the row now.
+	 */
 
-	available_width = (column->write_ptr == column->text) ?
-			column->width : column->width - column->hanging_indent;
+	if (trial == false && column->next_row < column->row_count &&
+			column->rows[column->next_row].from == column->write_ptr - column->text) {
+		row = column->rows + column->next_row++;
+	} else {
+		output_text_line_measure_row(column, &measured);
+		row = &measured;
+
+		if (trial == true && !output_text_line_store_row(column, row))
+			return false;
+	}
 
-	if (available_width <= 0) {
+	/* If there's nothing to output, flag the column as complete and exit. */
+
+	if (row->empty) {
 		column->write_ptr = NULL;
 		return true;
 	}
 
+	column->write_ptr = column->text + row->start;
+
+	available_width = row->available_width;
+	breakpoint = row->breakpoint;
+	hyphenate = row->hyphenate;
+	skip = row->skip;
+	complete = row->complete;
+
+	/* Track the maximum line length seen. */
+
+	if (breakpoint > column->written_width)
+		column->written_width = (hyphenate) ? breakpoint + 1 : breakpoint;
+
+	/* Write the line of text. */
+
+	if (trial == false) {
+		if (!output_text_line_pad_to_column(column))
+			return false;
+
+		if (column->flags & OUTPUT_TEXT_LINE_COLUMN_FLAGS_RIGHT) {
+			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - breakpoint)))
+				return false;
+		} else if (column->flags & OUTPUT_TEXT_LINE_COLUMN_FLAGS_CENTRE) {
+			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - breakpoint) / 2))
+				return false;
+		} else {
+			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - available_width)))
+				return false;
+		}
+
+		do {
+			c = (breakpoint-- > 0) ? encoding_parse_utf8_string(&(column->write_ptr)) : '\0';
+
+			/* Change the special characters passed in by the formatter. */
+
+			switch (c) {
+			case ENCODING_UC_NBSP:
+				c = ' ';
+				break;
+			case ENCODING_UC_NBHY:
+				c = '-';
+				break;
+			}
+
+			if (c != '\0' && !output_text_line_write_char(column->parent, c))
+				return false;
+		} while (c != '\0');
+
+		/* If the line is to be hyphenated, write the hyphen. */
+
+		if (hyphenate && !output_text_line_write_char(column->parent, '-'))
+			return false;
+	} else {
+		while (breakpoint-- > 0)
+			encoding_parse_utf8_string(&(column->write_ptr));
+	}
+
+	/* Skip past any terminating newline. */
+
+	if (skip)
+		encoding_parse_utf8_string(&(column->write_ptr));
+
+	/* If complete, flag the column as done; else, flag the line as not done. */
+
+	if (complete == true)
+		column->write_ptr = NULL;
+	else
+		column->parent->complete = false;
+
+	return true;
+}
+
+/**
+ * Measure the layout of the next row of text to be written from a column,
+ * starting from the column's current write pointer.
+ *
+ * \param *column	The current column instance.
+ * \param *row		Pointer to the row layout to fill in.
+ */
+
+static void output_text_line_measure_row(struct output_text_line_column *column, struct output_text_line_row *row)
+{
+	int	available_width, written_width, breakpoint, c;
+	char	*scan_ptr, *start_ptr;
+	bool	hyphenate = false, skip = false, complete = false, preformat = false;
+
+	row->from = column->write_ptr - column->text;
+	row->start = row->from;
+	row->available_width = 0;
+	row->breakpoint = 0;
+	row->empty = true;
+	row->hyphenate = false;
+	row->skip = false;
+	row->complete = false;
+
+	/* If there's no width, complete the line and exit. */
+
+	available_width = (column->write_ptr == column->text) ?
+			column->width : column->width - column->hanging_indent;
+
+	if (available_width <= 0)
+		return;
+
 	/* Find the next chunk of string to be written out. */
 
 	if (column->flags & OUTPUT_TEXT_LINE_COLUMN_FLAGS_PREFORMAT)
@@ -1149,6 +1522,7 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 	breakpoint = 0;
 
 	scan_ptr = column->write_ptr;
+	start_ptr = column->write_ptr;
 
 	c = encoding_parse_utf8_string(&scan_ptr);
 
@@ -1158,12 +1532,10 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 		/* If this is a possible breakpoint... */
 
 		if (c == ' ' || c == '-') {
-			
-
 			if (preformat == false && c == ' ' && written_width == 1) {
 				/* If the first character of the column is a space, we skip it. */
 				written_width = 0;
-				column->write_ptr = scan_ptr;
+				start_ptr = scan_ptr;
 			} else {
 				/* Otherwise, we remember the breakpoint. */
 				breakpoint = (c == '-') ? written_width : written_width - 1;
@@ -1173,12 +1545,10 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 		c = encoding_parse_utf8_string(&scan_ptr);
 	}
 
-	/* If there's nothing to output, flag the column as complete and exit. */
+	/* If there's nothing to output, the row is empty. */
 
-	if (c != '\n' && written_width == 0) {
-		column->write_ptr = NULL;
-		return true;
-	}
+	if (c != '\n' && written_width == 0)
+		return;
 
 	/* We've reached the end of the string. */
 
@@ -1214,66 +1584,42 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 		}
 	}
 
-	/* Track the maximum line length seen. */
+	row->start = start_ptr - column->text;
+	row->available_width = available_width;
+	row->breakpoint = breakpoint;
+	row->empty = false;
+	row->hyphenate = hyphenate;
+	row->skip = skip;
+	row->complete = complete;
+}
 
-	if (breakpoint > column->written_width)
-		column->written_width = (hyphenate) ? breakpoint + 1 : breakpoint;
+/**
+ * Store a measured row layout in a column, for later reuse.
+ *
+ * \param *column	The column to store the layout in.
+ * \param *row		Pointer to the layout to be stored.
+ * \return		True on success; False on error.
+ */
 
-	/* Write the line of text. */
+static bool output_text_line_store_row(struct output_text_line_column *column, struct output_text_line_row *row)
+{
+	struct output_text_line_row	*new;
+	size_t				size;
 
-	if (trial == false) {
-		if (!output_text_line_pad_to_column(column))
-			return false;
+	if (column->row_count >= column->row_size) {
+		size = (column->row_size > 0) ? column->row_size * 2 : OUTPUT_TEXT_LINE_ROW_BLOCK_SIZE;
 
-		if (column->flags & OUTPUT_TEXT_LINE_COLUMN_FLAGS_RIGHT) {
-			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - breakpoint)))
-				return false;
-		} else if (column->flags & OUTPUT_TEXT_LINE_COLUMN_FLAGS_CENTRE) {
-			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - breakpoint) / 2))
-				return false;
-		} else {
-			if (!output_text_line_pad_to_position(column->parent, column->start + (column->width - available_width)))
-				return false;
+		new = realloc(column->rows, size * sizeof(struct output_text_line_row));
+		if (new == NULL) {
+			msg_report(MSG_TEXT_LINE_NO_MEM);
+			return false;
 		}
 
-		do {
-			c = (breakpoint-- > 0) ? encoding_parse_utf8_string(&(column->write_ptr)) : '\0';
-
-			/* Change the special characters passed in by the formatter. */
-
-			switch (c) {
-			case ENCODING_UC_NBSP:
-				c = ' ';
-				break;
-			case ENCODING_UC_NBHY:
-				c = '-';
-				break;
-			}
-
-			if (c != '\0' && !output_text_line_write_char(column->parent, c))
-				return false;
-		} while (c != '\0');
-
-		/* If the line is to be hyphenated, write the hyphen. */
-
-		if (hyphenate && !output_text_line_write_char(column->parent, '-'))
-			return false;
-	} else {
-		while (breakpoint-- > 0)
-			encoding_parse_utf8_string(&(column->write_ptr));
+		column->rows = new;
+		column->row_size = size;
 	}
 
-	/* Skip past any terminating newline. */
-
-	if (skip)
-		encoding_parse_utf8_string(&(column->write_ptr));
-
-	/* If complete, flag the column as done; else, flag the line as not done. */
-
-	if (complete == true)
-		column->write_ptr = NULL;
-	else
-		column->parent->complete = false;
+	column->rows[column->row_count++] = *row;
 
 	return true;
 }
@@ -1287,8 +1633,6 @@ static bool output_text_line_write_column(struct output_text_line_column *column
 
 static bool output_text_line_write_column_underline(struct output_text_line_column *column)
 {
-	int i;
-
 	if (column == NULL) {
 		msg_report(MSG_TEXT_LINE_BAD_COL_REF);
 		return false;
@@ -1304,12 +1648,7 @@ static bool output_text_line_write_column_underline(struct output_text_line_colu
 	if (!output_text_line_pad_to_column(column))
 		return false;
 
-	for (i = 0; i < column->written_width; i++) {
-		if (!output_text_line_write_char(column->parent, '-'))
-			return false;
-	}
-
-	return true;
+	return output_text_line_write_chars(column->parent, '-', column->written_width);
 }
 
 /**
@@ -1343,12 +1682,10 @@ static bool output_text_line_pad_to_position(struct output_text_line *line, int
 		return false;
 	}
 
-	while (line->position < position) {
-		if (!output_text_line_write_char(line, ' '))
-			return false;
-	}
+	if (line->position >= position)
+		return true;
 
-	return true;
+	return output_text_line_write_chars(line, ' ', position - line->position);
 }
 
 /**
@@ -1362,7 +1699,6 @@ static bool output_text_line_pad_to_position(struct output_text_line *line, int
 bool output_text_line_write_ruleoff(int unicode)
 {
 	int position = 0;
-	char buffer[ENCODING_CHAR_BUF_LEN];
 	struct output_text_line *line = output_text_line_stack;
 
 	if (line == NULL) {
@@ -1370,28 +1706,21 @@ bool output_text_line_write_ruleoff(int unicode)
 		return false;
 	}
 
-	encoding_write_unicode_char(buffer, ENCODING_CHAR_BUF_LEN, ' ');
-
-	while (position < line->left_margin) {
-		if (fputs(buffer, output_text_line_handle) == EOF) {
-			msg_report(MSG_WRITE_FAILED);
-			return false;
-		}
-
-		position++;
+	if (output_text_line_handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
 	}
 
-	encoding_write_unicode_char(buffer, ENCODING_CHAR_BUF_LEN, unicode);
-
-	while (position < line->page_width) {
-		if (fputs(buffer, output_text_line_handle) == EOF) {
-			msg_report(MSG_WRITE_FAILED);
+	if (line->left_margin > 0) {
+		if (!output_text_line_buffer_chars(' ', line->left_margin))
 			return false;
-		}
 
-		position++;
+		position = line->left_margin;
 	}
 
+	if (position < line->page_width && !output_text_line_buffer_chars(unicode, line->page_width - position))
+		return false;
+
 	return output_text_line_write_newline();
 }
 
@@ -1404,6 +1733,7 @@ bool output_text_line_write_ruleoff(int unicode)
 bool output_text_line_write_newline(void)
 {
 	const char *line_end = NULL;
+	size_t length;
 
 	if (output_text_line_handle == NULL) {
 		msg_report(MSG_WRITE_NO_FILE);
@@ -1416,12 +1746,18 @@ bool output_text_line_write_newline(void)
 		return false;
 	}
 
-	if (fputs(line_end, output_text_line_handle) == EOF) {
-		msg_report(MSG_WRITE_FAILED);
+	/* Complete the line in the buffer, and send it to the file. */
+
+	length = strlen(line_end);
+
+	if (length > output_text_line_buffer_size - output_text_line_buffer_length &&
+			!output_text_line_flush_buffer())
 		return false;
-	}
 
-	return true;
+	memcpy(output_text_line_buffer + output_text_line_buffer_length, line_end, length);
+	output_text_line_buffer_length += length;
+
+	return output_text_line_flush_buffer();
 }
 
 /**
@@ -1435,8 +1771,36 @@ bool output_text_line_write_newline(void)
 
 static bool output_text_line_write_char(struct output_text_line *line, int unicode)
 {
-	char buffer[ENCODING_CHAR_BUF_LEN];
+	if (line == NULL) {
+		msg_report(MSG_TEXT_LINE_BAD_REF);
+		return false;
+	}
+
+	if (output_text_line_handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	if (!output_text_line_buffer_chars(unicode, 1))
+		return false;
+
+	line->position++;
+
+	return true;
+}
 
+/**
+ * Write a run of copies of a single unicode character to the output in
+ * the currently selected encoding.
+ *
+ * \param *line		The line instance to work with.
+ * \param unicode	The unicode character to be written.
+ * \param count		The number of copies to write.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_text_line_write_chars(struct output_text_line *line, int unicode, int count)
+{
 	if (line == NULL) {
 		msg_report(MSG_TEXT_LINE_BAD_REF);
 		return false;
@@ -1447,14 +1811,73 @@ static bool output_text_line_write_char(struct output_text_line *line, int unico
 		return false;
 	}
 
-	encoding_write_unicode_char(buffer, ENCODING_CHAR_BUF_LEN, unicode);
+	if (!output_text_line_buffer_chars(unicode, count))
+		return false;
 
-	if (fputs(buffer, output_text_line_handle) == EOF) {
-		msg_report(MSG_WRITE_FAILED);
+	line->position += count;
+
+	return true;
+}
+
+/**
+ * Add a run of copies of a single unicode character to the output buffer
+ * in the currently selected encoding, writing out the buffer whenever it
+ * becomes full. The character is only encoded once.
+ *
+ * \param unicode	The unicode character to be added.
+ * \param count		The number of copies to add.
+ * \return		True if successful; False on error.
+ */
+
+static bool output_text_line_buffer_chars(int unicode, int count)
+{
+	char	encoded[ENCODING_CHAR_BUF_LEN];
+	size_t	length;
+
+	if (output_text_line_buffer == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
 		return false;
 	}
 
-	line->position++;
+	encoding_write_unicode_char(encoded, ENCODING_CHAR_BUF_LEN, unicode);
+	length = strlen(encoded);
+
+	while (count-- > 0) {
+		if (output_text_line_buffer_size - output_text_line_buffer_length < length &&
+				!output_text_line_flush_buffer())
+			return false;
+
+		memcpy(output_text_line_buffer + output_text_line_buffer_length, encoded, length);
+		output_text_line_buffer_length += length;
+	}
+
+	return true;
+}
+
+/**
+ * Write the contents of the output buffer to the output file.
+ *
+ * \return		True if successful; False on error.
+ */
+
+static bool output_text_line_flush_buffer(void)
+{
+	size_t length = output_text_line_buffer_length;
+
+	if (length == 0)
+		return true;
+
+	output_text_line_buffer_length = 0;
+
+	if (output_text_line_handle == NULL) {
+		msg_report(MSG_WRITE_NO_FILE);
+		return false;
+	}
+
+	if (!output_file_write(output_text_line_handle, output_text_line_buffer, length)) {
+		msg_report(MSG_WRITE_FAILED);
+		return false;
+	}
 
 	return true;
 }
@@ -29,20 +29,28 @@
 
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "xmlman.h"
 #include "encoding.h"
 #include "filename.h"
 #include "manual.h"
+#include "manual_arena.h"
 #include "manual_data.h"
 #include "manual_entity.h"
+#include "manual_ids.h"
+#include "manual_outline.h"
 #include "modes.h"
 #include "msg.h"
+#include "parse.h"
 #include "parse_element.h"
 #include "parse_link.h"
 #include "parse_xml.h"
+#include "profile.h"
+#include "stats.h"
 
 /**
  * The maximum length of a file leafname.
@@ -50,107 +58,1601 @@
 
 #define PARSE_MAX_LEAFNAME 128
 
-/* Static Function Prototypes. */
+/**
+ * The maximum number of threads which can be used to parse chapter files.
+ */
+
+#define PARSE_MAX_THREADS 64
+
+/**
+ * A chapter file awaiting parsing.
+ */
+
+struct parse_chapter_job {
+	struct filename		*filename;	/**< The name of the chapter file.			*/
+	struct manual_data	*chapter;	/**< The placeholder chapter to parse the file into.	*/
+	bool			complete;	/**< True once the file has been parsed.		*/
+};
+
+/**
+ * A pool of chapter files, shared between the threads parsing them.
+ */
+
+struct parse_chapter_pool {
+	pthread_mutex_t		lock;		/**< Lock protecting the job indexes.			*/
+	pthread_cond_t		progress;	/**< Signalled when the finished job index advances.	*/
+	struct parse_chapter_job *jobs;		/**< The array of jobs in the pool.			*/
+	struct manual_data	*manual;	/**< The root manual, shared by the jobs in turn.	*/
+	int			count;		/**< The number of jobs in the pool.			*/
+	int			next;		/**< The index of the next job to be claimed.		*/
+	int			finished;	/**< The number of jobs finished, in chapter order.	*/
+};
+
+/**
+ * A thread parsing chapter files from a pool.
+ */
+
+struct parse_chapter_worker {
+	pthread_t		thread;		/**< The thread running the worker.			*/
+	bool			started;	/**< True if the thread was started.			*/
+	struct parse_chapter_pool *pool;	/**< The pool from which to claim jobs.			*/
+	struct manual_arena	*arena;		/**< The arena to allocate from, or NULL for the current one.	*/
+	struct msg_context	*context;	/**< The message context to use, or NULL for the current one.	*/
+	struct parse_chapter_job *job;		/**< The job being parsed, or NULL.			*/
+	bool			turn;		/**< True once the job has taken its turn on the manual.	*/
+};
+
+/**
+ * A top-level node of a document which is being streamed, waiting to be
+ * written out.
+ */
+
+struct parse_stream_item {
+	struct manual_data	*node;		/**< The top-level node.				*/
+	struct manual_arena	*arena;		/**< The arena holding the node's contents, or NULL.	*/
+};
+
+/**
+ * A selection of a single chapter to be parsed in full, with the other
+ * chapter files only having their headers read.
+ */
+
+struct parse_select {
+	const char		*id;		/**< The id of the selected chapter.				*/
+	bool			partial;	/**< Set when the file being parsed was stopped after its header.	*/
+};
+
+/**
+ * A chapter file from a document being parsed for a selected chapter.
+ */
+
+struct parse_select_file {
+	struct manual_data	*chapter;	/**< The placeholder chapter parsed from the file.		*/
+	struct filename		*filename;	/**< The name of the file.					*/
+	bool			partial;	/**< True if only the chapter's header has been parsed.	*/
+};
+
+/**
+ * The number of files by which the list of watched files is extended.
+ */
+
+#define PARSE_WATCH_BLOCK 32
+
+/**
+ * A source file being watched for changes.
+ */
+
+struct parse_watch_file {
+	struct filename		*filename;	/**< The name of the file.					*/
+	struct manual_data	*chapter;	/**< The chapter parsed from the file, or NULL for the root.	*/
+	struct manual_arena	*arena;		/**< The arena holding the chapter and its source, or NULL.	*/
+	uint64_t		stamp;		/**< The file's stamp when it was last parsed.			*/
+	bool			stamped;	/**< True if the file's stamp could be read.			*/
+};
+
+/**
+ * A document being kept up to date with its source files.
+ */
+
+struct parse_watch {
+	char			*filename;	/**< The name of the root file.					*/
+	struct manual		*document;	/**< The current document, or NULL if it failed to parse.	*/
+	struct manual_arena	*links;		/**< The arena holding the document's annotations.		*/
+	struct parse_watch_file	*files;		/**< The list of source files.					*/
+	int			count;		/**< The number of files in the list.				*/
+	int			size;		/**< The number of files which the list can hold.		*/
+	bool			loaded;		/**< True once the document has been loaded.			*/
+};
+
+/**
+ * Block definition flag: the element may be nested within a block object.
+ */
+
+#define PARSE_BLOCK_INLINE 0x01u
+
+/**
+ * Block definition flag: the element may appear as an empty tag within a
+ * block object.
+ */
+
+#define PARSE_BLOCK_EMPTY 0x02u
+
+/**
+ * The definition of how an element is handled as a block object.
+ */
+
+struct parse_block_definition {
+	enum manual_data_object_type	type;		/**< The object type created for the element, or NONE if it can't be a block.	*/
+	unsigned int			flags;		/**< Flags indicating where the element can appear within a block.		*/
+};
+
+/**
+ * The block object definitions, indexed by element type. Elements which
+ * can not form block objects have an object type of NONE, except for
+ * PARSE_ELEMENT_NONE itself, which forms a multi-level attribute.
+ */
+
+static const struct parse_block_definition parse_block_definitions[PARSE_ELEMENT_NONE + 1] = {
+	[PARSE_ELEMENT_BR]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_CALLOUT]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_CHAPTER]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_CHAPTERLIST]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_CITE]		= {MANUAL_DATA_OBJECT_TYPE_CITATION,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_CODE]		= {MANUAL_DATA_OBJECT_TYPE_CODE,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_COL]		= {MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN,		0},
+	[PARSE_ELEMENT_COLDEF]		= {MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION,	0},
+	[PARSE_ELEMENT_COLUMNS]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_COMMAND]		= {MANUAL_DATA_OBJECT_TYPE_COMMAND,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_CONST]		= {MANUAL_DATA_OBJECT_TYPE_CONSTANT,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_CREDIT]		= {MANUAL_DATA_OBJECT_TYPE_CREDIT,			0},
+	[PARSE_ELEMENT_DATE]		= {MANUAL_DATA_OBJECT_TYPE_DATE,			0},
+	[PARSE_ELEMENT_DOWNLOADS]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_EM]		= {MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS,		PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_ENTRY]		= {MANUAL_DATA_OBJECT_TYPE_USER_ENTRY,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_EVENT]		= {MANUAL_DATA_OBJECT_TYPE_EVENT,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_FILE]		= {MANUAL_DATA_OBJECT_TYPE_FILENAME,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_FILENAME]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_FOOTNOTE]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_FOLDER]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_FUNCTION]	= {MANUAL_DATA_OBJECT_TYPE_FUNCTION,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_ICON]		= {MANUAL_DATA_OBJECT_TYPE_ICON,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_IMAGES]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_INTRO]		= {MANUAL_DATA_OBJECT_TYPE_INTRO,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_INDEX]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_KEY]		= {MANUAL_DATA_OBJECT_TYPE_KEY,				PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_KEYWORD]		= {MANUAL_DATA_OBJECT_TYPE_KEYWORD,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_LI]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_LINK]		= {MANUAL_DATA_OBJECT_TYPE_LINK,			PARSE_BLOCK_INLINE | PARSE_BLOCK_EMPTY},
+	[PARSE_ELEMENT_MANUAL]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_MATHS]		= {MANUAL_DATA_OBJECT_TYPE_MATHS,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_MENU]		= {MANUAL_DATA_OBJECT_TYPE_MENU,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_MESSAGE]		= {MANUAL_DATA_OBJECT_TYPE_MESSAGE,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_MODE]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_MOUSE]		= {MANUAL_DATA_OBJECT_TYPE_MOUSE,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_NAME]		= {MANUAL_DATA_OBJECT_TYPE_NAME,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_OL]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_PARAGRAPH]	= {MANUAL_DATA_OBJECT_TYPE_PARAGRAPH,			0},
+	[PARSE_ELEMENT_REF]		= {MANUAL_DATA_OBJECT_TYPE_REFERENCE,			PARSE_BLOCK_INLINE | PARSE_BLOCK_EMPTY},
+	[PARSE_ELEMENT_RESOURCES]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_ROW]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_SECTION]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_STRAPLINE]	= {MANUAL_DATA_OBJECT_TYPE_STRAPLINE,			0},
+	[PARSE_ELEMENT_STRONG]		= {MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS,		PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_STYLESHEET]	= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_SUMMARY]		= {MANUAL_DATA_OBJECT_TYPE_SUMMARY,			0},
+	[PARSE_ELEMENT_SWI]		= {MANUAL_DATA_OBJECT_TYPE_SWI,				PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_TABLE]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_TITLE]		= {MANUAL_DATA_OBJECT_TYPE_TITLE,			0},
+	[PARSE_ELEMENT_TYPE]		= {MANUAL_DATA_OBJECT_TYPE_TYPE,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_UL]		= {MANUAL_DATA_OBJECT_TYPE_NONE,			0},
+	[PARSE_ELEMENT_VARIABLE]	= {MANUAL_DATA_OBJECT_TYPE_VARIABLE,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_VERSION]		= {MANUAL_DATA_OBJECT_TYPE_VERSION,			0},
+	[PARSE_ELEMENT_WINDOW]		= {MANUAL_DATA_OBJECT_TYPE_WINDOW,			PARSE_BLOCK_INLINE},
+	[PARSE_ELEMENT_NONE]		= {MANUAL_DATA_OBJECT_TYPE_MULTI_LEVEL_ATTRIBUTE,	0}
+};
+
+/* Global Variables. */
+
+/**
+ * The folder against which chapter files are found, or NULL to use the
+ * folder holding the root file.
+ */
+
+static char *parse_root_folder = NULL;
+
+/**
+ * The key used to hold the chapter worker running on each thread.
+ */
+
+static pthread_key_t parse_worker_key;
 
-static bool parse_file(struct filename *filename, struct manual_data **manual, struct manual_data *chapter);
+/**
+ * Control for the one-time creation of the worker key.
+ */
+
+static pthread_once_t parse_worker_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the worker key was created successfully.
+ */
+
+static bool parse_worker_key_valid = false;
+
+/* Static Function Prototypes. */
 
-static void parse_manual(struct parse_xml_block *parser, struct manual_data **manual, struct manual_data *chapter);
+static struct manual_data *parse_root_file(char *filename, struct filename **document_root);
+static bool parse_stream_write(struct parse_stream *stream, struct manual_data *manual, struct parse_stream_item *items,
+		int count, int *next, bool *started, bool complete);
+static bool parse_stream_has_files(struct manual_data *node);
+static bool parse_select_ready(struct manual_data *manual, struct parse_select_file *files, int count);
+static bool parse_select_link(struct manual_data *manual);
+static enum manual_data_walk_action parse_select_index_node(struct manual_data_walk_frame *frame, void *data);
+static bool parse_watch_load(struct parse_watch *watch);
+static bool parse_watch_reload_chapter(struct parse_watch *watch, struct parse_watch_file *file);
+static bool parse_watch_link(struct parse_watch *watch);
+static struct parse_watch_file *parse_watch_add_file(struct parse_watch *watch, struct filename *filename, struct manual_data *chapter);
+static void parse_watch_clear(struct parse_watch *watch);
+static void parse_watch_report_change(struct filename *filename);
+static bool parse_chapters_parallel(struct manual *document, struct manual_data *manual, struct filename *document_root, int threads);
+static void *parse_chapter_worker(void *data);
+static struct parse_chapter_job *parse_claim_chapter_job(struct parse_chapter_pool *pool);
+static void parse_finish_chapter_job(struct parse_chapter_pool *pool, struct parse_chapter_job *job);
+static void parse_wait_for_manual(void);
+static void parse_create_worker_key(void);
+static bool parse_file(struct filename *filename, struct manual_data **manual, struct manual_data *chapter, struct parse_select *select);
+
+static void parse_manual(struct parse_xml_block *parser, struct manual_data **manual, struct manual_data *chapter, struct parse_select *select);
 static struct manual_data *parse_placeholder_chapter(struct parse_xml_block *parser, struct manual_data *parent);
-static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct manual_data *chapter);
+static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct manual_data *chapter, struct parse_select *select);
 static struct manual_data *parse_section(struct parse_xml_block *parser);
 static struct manual_data *parse_block_collection_object(struct parse_xml_block *parser);
 static struct manual_data *parse_callout(struct parse_xml_block *parser);
 static struct manual_data *parse_list(struct parse_xml_block *parser);
 static struct manual_data *parse_table(struct parse_xml_block *parser);
+static struct manual_data *parse_table_contents(struct parse_xml_block *parser);
 static struct manual_data *parse_table_column_set(struct parse_xml_block *parser);
 static struct manual_data *parse_table_row(struct parse_xml_block *parser);
 static struct manual_data *parse_code_block(struct parse_xml_block *parser);
 static struct manual_data *parse_block_object(struct parse_xml_block *parser);
+static struct manual_data *parse_block_object_contents(struct parse_xml_block *parser);
 static struct manual_data *parse_empty_block_object(struct parse_xml_block *parser);
+static void parse_block_attributes(struct parse_xml_block *parser, enum parse_element_type type, struct manual_data *block);
+
+static void parse_unknown(struct parse_xml_block *parser);
+static void parse_resources(struct parse_xml_block *parser, struct manual_data_resources *resources);
+static void parse_mode_resources(struct parse_xml_block *parser, enum modes_type mode, struct manual_data_mode *resources);
+static struct manual_data *parse_multi_level_attribute(struct parse_xml_block *parser, char *attribute);
+static struct manual_data *parse_single_level_attribute(struct parse_xml_block *parser, char *attribute);
+static bool parse_fetch_single_level_block(struct parse_xml_block *parser, char *buffer, size_t length);
+static char *parse_get_text(struct parse_xml_block *parser);
+static char *parse_get_flat_text(struct parse_xml_block *parser);
+static char *parse_get_attribute_text(struct parse_xml_block *parser, const char *name);
+static void parse_link_item(struct manual_data **previous, struct manual_data *parent, struct manual_data *item);
+
+/**
+ * Initialise the parser for a new document.
+ *
+ * \param *root		The folder against which chapter files are found,
+ *			or NULL to use the folder holding the root file.
+ *			This is required if the root file is read from
+ *			stdin, and must remain valid while parsing.
+ */
+
+void parse_initialise(char *root)
+{
+	parse_root_folder = root;
+}
+
+/**
+ * Parse an XML file and its descendents.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param threads	The number of threads to use when parsing chapter
+ *			files, or 1 to parse them in sequence.
+ * \return		Pointer to the resulting manual structure.
+ */
+
+struct manual *parse_document(char *filename, int threads)
+{
+	struct manual		*document = NULL;
+	struct manual_data	*manual = NULL, *chapter = NULL;
+	struct filename		*document_root = NULL, *document_base = NULL;
+	struct stats_timer	timer;
+
+	/* Create the document, and allocate its data from the document's arena. */
+
+	document = manual_create(NULL);
+	if (document == NULL)
+		return NULL;
+
+	manual_data_select_arena(document->arena);
+
+	/* Parse the root file. */
+
+	manual = parse_root_file(filename, &document_root);
+	if (manual == NULL)
+		return NULL;
+
+	/* Parse any non-inlined chapter files. */
+
+	if (threads > 1) {
+		if (!parse_chapters_parallel(document, manual, document_root, threads))
+			return NULL;
+
+		chapter = NULL;
+	} else {
+		chapter = manual->first_child;
+	}
+
+	while (chapter != NULL) {
+		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
+				msg_report(MSG_BAD_TYPE);
+				return NULL;
+			}
+
+			if (!chapter->processed) {
+				document_base = filename_up(document_root, 0);
+
+				if (filename_append(document_base, chapter->chapter.filename, 0)) {
+					filename_destroy(chapter->chapter.filename);
+					chapter->chapter.filename = NULL;
+
+					parse_file(document_base, &manual, chapter, NULL);
+				}
+
+				filename_destroy(document_base);
+			}
+		}
+
+		chapter = chapter->next;
+	}
+
+	/* Link the document. */
+
+	document->manual = manual;
+
+	stats_start(&timer);
+
+	if (!parse_link(manual))
+		return NULL;
+
+	stats_record(&timer, "link", NULL);
+
+	manual_ids_dump();
+
+	return document;
+} 
+
+/**
+ * Parse an XML file and its descendents, passing each top-level node of
+ * the manual to a stream client in turn as soon as it has been parsed,
+ * linked and had all of its references found. Once written out, the
+ * contents of each chapter file are replaced by an outline, so that
+ * only the chapters still waiting to be written are held in full.
+ *
+ * Any manual-level content in the chapter files is parsed into a stand-in
+ * manual and ignored, as the root manual may already have been written.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param *stream	The client to write the document out.
+ * \return		Pointer to the resulting manual structure, or NULL
+ *			on failure.
+ */
+
+struct manual *parse_document_stream(char *filename, struct parse_stream *stream)
+{
+	struct manual			*document = NULL;
+	struct manual_data		*manual = NULL, *chapter = NULL, *standin = NULL;
+	struct filename			*document_root = NULL, *document_base = NULL;
+	struct parse_stream_item	*items = NULL;
+	int				i, count = 0, added = 0, next = 0;
+	bool				started = false, success = true;
+
+	if (stream == NULL || stream->start == NULL || stream->write == NULL || stream->end == NULL)
+		return NULL;
+
+	/* Create the document, and allocate its data from the document's arena. */
+
+	document = manual_create(NULL);
+	if (document == NULL)
+		return NULL;
+
+	manual_data_select_arena(document->arena);
+
+	/* Parse the root file. */
+
+	manual = parse_root_file(filename, &document_root);
+	if (manual == NULL)
+		return NULL;
+
+	document->manual = manual;
+
+	/* Set up a list of the top-level nodes, which can only be written
+	 * out as a single file.
+	 */
+
+	for (chapter = manual->first_child; chapter != NULL; chapter = chapter->next)
+		count++;
+
+	items = malloc(((count > 0) ? count : 1) * sizeof(struct parse_stream_item));
+	if (items == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	if (parse_stream_has_files(manual)) {
+		msg_report(MSG_STREAM_FILES);
+		free(items);
+		return NULL;
+	}
+
+	manual_outline_initialise();
+
+	if (!parse_link_start(manual))
+		success = false;
+
+	/* Parse, link and write each of the top-level nodes in turn. */
+
+	for (chapter = manual->first_child, i = 0; chapter != NULL && success; chapter = chapter->next, i++) {
+		items[i].node = chapter;
+		items[i].arena = NULL;
+		added++;
+
+		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
+			if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
+				msg_report(MSG_BAD_TYPE);
+				success = false;
+				break;
+			}
+
+			if (!chapter->processed) {
+				items[i].arena = manual_arena_create();
+				if (items[i].arena == NULL) {
+					msg_report(MSG_DATA_MALLOC_FAIL);
+					success = false;
+					break;
+				}
+
+				manual_data_select_arena(items[i].arena);
+
+				document_base = filename_up(document_root, 0);
+
+				if (filename_append(document_base, chapter->chapter.filename, 0)) {
+					filename_destroy(chapter->chapter.filename);
+					chapter->chapter.filename = NULL;
+
+					standin = NULL;
+					parse_file(document_base, &standin, chapter, NULL);
+				}
+
+				filename_destroy(document_base);
+			}
+		}
+
+		if (parse_stream_has_files(chapter)) {
+			msg_report(MSG_STREAM_FILES);
+			success = false;
+			break;
+		}
+
+		/* Link the node, allocating its annotations alongside its contents. */
+
+		if (!parse_link_add(manual, chapter))
+			success = false;
+
+		manual_data_select_arena(document->arena);
+
+		if (success)
+			success = parse_stream_write(stream, manual, items, i + 1, &next, &started, false);
+	}
+
+	/* Write out anything left, reporting any references which can't be found. */
+
+	if (success)
+		success = parse_stream_write(stream, manual, items, count, &next, &started, true);
+
+	if (!stream->end(manual, success))
+		success = false;
+
+	/* Any nodes which weren't written out keep their contents. */
+
+	for (i = next; i < added; i++) {
+		if (items[i].arena != NULL)
+			manual_arena_merge(document->arena, items[i].arena);
+	}
+
+	free(items);
+	filename_destroy(document_root);
+
+	manual_outline_close();
+
+	manual_ids_dump();
+
+	return (success) ? document : NULL;
+}
+
+/**
+ * Parse an XML file and just those of its descendents needed to output a
+ * single selected chapter. Every chapter file has its header read, so
+ * that the titles, numbering and IDs of the chapters are all known, but
+ * only the selected chapter is parsed in full. The remaining chapter
+ * files are then parsed in full in order, until all of the targets of
+ * the references in the chapters held in full can be found.
+ *
+ * The chapter files are parsed in sequence.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param *id		The id of the chapter to be parsed in full.
+ * \return		Pointer to the resulting manual structure, or NULL
+ *			on failure.
+ */
+
+struct manual *parse_document_chapter(char *filename, char *id)
+{
+	struct manual			*document = NULL;
+	struct manual_data		*manual = NULL, *chapter = NULL, *selected = NULL;
+	struct filename			*document_root = NULL;
+	struct parse_select_file	*files = NULL;
+	struct parse_select		select;
+	struct stats_timer		timer;
+	int				i, count = 0;
+	bool				success = true;
+
+	if (id == NULL)
+		return NULL;
+
+	/* Create the document, and allocate its data from the document's arena. */
+
+	document = manual_create(NULL);
+	if (document == NULL)
+		return NULL;
+
+	manual_data_select_arena(document->arena);
+
+	/* Parse the root file. */
+
+	manual = parse_root_file(filename, &document_root);
+	if (manual == NULL)
+		return NULL;
+
+	/* Set up a list of the chapter files, so that they can be parsed
+	 * again in full if required.
+	 */
+
+	for (chapter = manual->first_child; chapter != NULL; chapter = chapter->next)
+		count++;
+
+	files = malloc(((count > 0) ? count : 1) * sizeof(struct parse_select_file));
+	if (files == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		filename_destroy(document_root);
+		return NULL;
+	}
+
+	/* Read the header of each chapter file, or the whole of the
+	 * selected chapter.
+	 */
+
+	count = 0;
+
+	for (chapter = manual->first_child; chapter != NULL && success; chapter = chapter->next) {
+		if (chapter->type == MANUAL_DATA_OBJECT_TYPE_SECTION)
+			continue;
+
+		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
+			msg_report(MSG_BAD_TYPE);
+			success = false;
+			break;
+		}
+
+		if (!chapter->processed) {
+			files[count].chapter = chapter;
+			files[count].filename = filename_up(document_root, 0);
+
+			if (filename_append(files[count].filename, chapter->chapter.filename, 0)) {
+				filename_destroy(chapter->chapter.filename);
+				chapter->chapter.filename = NULL;
+
+				select.id = id;
+				select.partial = false;
+
+				parse_file(files[count].filename, &manual, chapter, &select);
+
+				files[count++].partial = select.partial;
+			} else {
+				filename_destroy(files[count].filename);
+			}
+		}
+
+		if (selected == NULL && chapter->chapter.id != NULL && strcmp(chapter->chapter.id, id) == 0)
+			selected = chapter;
+	}
+
+	if (success && selected == NULL) {
+		msg_report(MSG_CHAPTER_NOT_FOUND, id);
+		success = false;
+	}
+
+	/* Parse the other chapters in full until the references in the
+	 * chapters held in full can all be found.
+	 */
+
+	document->manual = manual;
+
+	if (success && !parse_select_link(manual))
+		success = false;
+
+	i = 0;
+
+	while (success && !parse_select_ready(manual, files, count)) {
+		while (i < count && !files[i].partial)
+			i++;
+
+		if (i >= count)
+			break;
+
+		chapter = files[i].chapter;
+
+		chapter->title = NULL;
+		chapter->first_child = NULL;
+		chapter->chapter.id = NULL;
+		chapter->chapter.resources = NULL;
+		chapter->processed = false;
+
+		parse_file(files[i].filename, &manual, chapter, NULL);
+
+		files[i].partial = false;
+
+		/* Index the new targets, which will be properly linked later. */
+
+		if (chapter->first_child != NULL && !manual_data_walk(chapter->first_child, chapter, true, 0, parse_select_index_node, NULL, NULL))
+			success = false;
+	}
+
+	for (i = 0; i < count; i++)
+		filename_destroy(files[i].filename);
+
+	free(files);
+	filename_destroy(document_root);
+
+	if (!success)
+		return NULL;
+
+	/* Link the document. */
+
+	stats_start(&timer);
+
+	if (!parse_link(manual))
+		return NULL;
+
+	stats_record(&timer, "link", NULL);
+
+	manual_ids_dump();
+
+	return document;
+}
+
+/**
+ * Parse the root file of a document into the current arena.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param **document_root	Pointer to a location to take the folder
+ *			containing the root file.
+ * \return		Pointer to the root manual, or NULL on failure.
+ */
+
+static struct manual_data *parse_root_file(char *filename, struct filename **document_root)
+{
+	struct manual_data	*manual = NULL;
+	struct filename		*document_base = NULL;
+
+	document_base = filename_make(filename, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LOCAL);
+	if (document_base == NULL)
+		return NULL;
+
+	if (parse_root_folder != NULL)
+		*document_root = filename_make(parse_root_folder, FILENAME_TYPE_DIRECTORY, FILENAME_PLATFORM_LOCAL);
+	else
+		*document_root = filename_up(document_base, 1);
+
+	if (*document_root == NULL) {
+		filename_destroy(document_base);
+		return NULL;
+	}
+
+	parse_file(document_base, &manual, NULL, NULL);
+	filename_destroy(document_base);
+
+	if (manual == NULL)
+		return NULL;
+
+	if (manual->type != MANUAL_DATA_OBJECT_TYPE_MANUAL) {
+		msg_report(MSG_BAD_TYPE);
+		return NULL;
+	}
+
+	return manual;
+}
+
+/**
+ * Write out as many of the waiting top-level nodes of a streamed document
+ * as possible. Each node is written once all of its references can be
+ * resolved, but the nodes must be written in order.
+ *
+ * \param *stream	The client to write the document out.
+ * \param *manual	The root manual.
+ * \param *items	The list of top-level nodes.
+ * \param count		The number of nodes in the list which have been linked.
+ * \param *next		Pointer to the index of the next node to write, which
+ *			is updated.
+ * \param *started	Pointer to a flag indicating whether the stream has
+ *			been started, which is updated.
+ * \param complete	True if the whole document has been parsed, so that
+ *			everything left must be written.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_stream_write(struct parse_stream *stream, struct manual_data *manual, struct parse_stream_item *items,
+		int count, int *next, bool *started, bool complete)
+{
+	/* The manual heading is written first, once its references are known. */
+
+	if (!*started) {
+		if (!complete && !parse_link_ready(manual, false))
+			return true;
+
+		parse_link_resolve(manual, false);
+
+		if (!stream->start(manual))
+			return false;
+
+		*started = true;
+	}
+
+	while (*next < count) {
+		if (!complete && !parse_link_ready(items[*next].node, true))
+			break;
+
+		parse_link_resolve(items[*next].node, true);
+
+		if (!stream->write(items[*next].node))
+			return false;
+
+		/* Chapters from their own files can now be cut down to an outline,
+		 * freeing their contents along with the source buffer which the
+		 * chapter's arena adopted when their text was claimed from it.
+		 */
+
+		if (items[*next].arena != NULL) {
+			if (!manual_outline_replace(items[*next].node))
+				return false;
+
+			manual_arena_destroy(items[*next].arena);
+			items[*next].arena = NULL;
+		}
+
+		(*next)++;
+	}
+
+	return true;
+}
+
+/**
+ * Test whether any of the processed parts of a node or its children
+ * would be written to files of their own in text mode, which can't be
+ * done when the output is streamed.
+ *
+ * \param *node		The node to test.
+ * \return		True if there is filename data; otherwise false.
+ */
+
+static bool parse_stream_has_files(struct manual_data *node)
+{
+	struct manual_data_mode	*resources = NULL;
+	struct manual_data	*child;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+		if (!node->processed)
+			return false;
+
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		resources = modes_find_resources(node->chapter.resources, MODES_TYPE_TEXT);
+		if (resources != NULL && (resources->filename != NULL || resources->folder != NULL))
+			return true;
+
+		for (child = node->first_child; child != NULL; child = child->next) {
+			if (parse_stream_has_files(child))
+				return true;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+/**
+ * Test whether the references in a document parsed for a selected chapter
+ * can all be resolved: those in the headings of the manual and of the
+ * chapters which have only had their headers parsed, and those anywhere
+ * within the rest of the top-level nodes.
+ *
+ * \param *manual	The root manual, which has been linked.
+ * \param *files	The list of chapter files, in document order.
+ * \param count		The number of files in the list.
+ * \return		True if the references can all be resolved.
+ */
+
+static bool parse_select_ready(struct manual_data *manual, struct parse_select_file *files, int count)
+{
+	struct manual_data	*node;
+	bool			partial;
+	int			i = 0;
+
+	if (!parse_link_targets_ready(manual, false))
+		return false;
+
+	for (node = manual->first_child; node != NULL; node = node->next) {
+		partial = false;
+
+		if (i < count && files[i].chapter == node)
+			partial = files[i++].partial;
+
+		if (!parse_link_targets_ready(node, !partial))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Link a document one top-level node at a time, indexing its IDs without
+ * resolving any of its references.
+ *
+ * \param *manual	The root manual to link.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_select_link(struct manual_data *manual)
+{
+	struct manual_data *node;
+
+	if (!parse_link_start(manual))
+		return false;
+
+	for (node = manual->first_child; node != NULL; node = node->next) {
+		if (!parse_link_add(manual, node))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Index the ID of a node in a chapter parsed for its targets, as a node
+ * in a tree walk.
+ *
+ * \param *frame	The walk frame for the node.
+ * \param *data		Unused.
+ * \return		The action for the walk to take.
+ */
+
+static enum manual_data_walk_action parse_select_index_node(struct manual_data_walk_frame *frame, void *data)
+{
+	struct manual_data *node = frame->node;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		if (node->chapter.id != NULL && !manual_ids_add_node(node))
+			return MANUAL_DATA_WALK_STOP;
+		break;
+	default:
+		break;
+	}
+
+	return MANUAL_DATA_WALK_DESCEND;
+}
+
+/**
+ * Create a watch on a document, which will keep the document up to date
+ * as its source files change. The document isn't loaded until the first
+ * call to parse_watch_update().
+ *
+ * \param *filename	The name of the root file to parse.
+ * \return		Pointer to the new watch, or NULL on failure.
+ */
+
+struct parse_watch *parse_watch_create(char *filename)
+{
+	struct parse_watch *watch;
+
+	if (filename == NULL)
+		return NULL;
+
+	watch = malloc(sizeof(struct parse_watch));
+	if (watch == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	watch->filename = filename;
+	watch->document = NULL;
+	watch->links = NULL;
+	watch->files = NULL;
+	watch->count = 0;
+	watch->size = 0;
+	watch->loaded = false;
+
+	return watch;
+}
+
+/**
+ * Destroy a document watch, along with its document.
+ *
+ * \param *watch	The watch to destroy.
+ */
+
+void parse_watch_destroy(struct parse_watch *watch)
+{
+	if (watch == NULL)
+		return;
+
+	parse_watch_clear(watch);
+
+	free(watch->files);
+	free(watch);
+}
+
+/**
+ * Check the source files of a watched document, updating the document
+ * if any have changed since they were last parsed. A change to the root
+ * file causes the whole document to be parsed again; otherwise only the
+ * chapters whose files have changed are parsed, before the document is
+ * linked again.
+ *
+ * \param *watch	The watch to update.
+ * \param **document	Pointer to a location to take the current document,
+ *			or NULL if it couldn't be parsed.
+ * \return		The outcome of the update.
+ */
+
+enum parse_watch_result parse_watch_update(struct parse_watch *watch, struct manual **document)
+{
+	struct parse_watch_file	*file;
+	uint64_t		stamp = 0;
+	bool			stamped, changed = false;
+	int			i;
+
+	if (watch == NULL || document == NULL)
+		return PARSE_WATCH_ERROR;
+
+	/* Load the document in full the first time around, or if the
+	 * root file has changed.
+	 */
+
+	if (watch->loaded && watch->count > 0) {
+		stamped = filename_get_stamp(watch->files[0].filename, &stamp);
+		if (stamped != watch->files[0].stamped || (stamped && stamp != watch->files[0].stamp)) {
+			parse_watch_report_change(watch->files[0].filename);
+			watch->loaded = false;
+		}
+	}
+
+	if (!watch->loaded) {
+		if (!parse_watch_load(watch))
+			return PARSE_WATCH_ERROR;
+
+		*document = watch->document;
+		return PARSE_WATCH_CHANGED;
+	}
+
+	/* Otherwise, parse any chapters whose files have changed. */
+
+	if (watch->document == NULL)
+		return PARSE_WATCH_UNCHANGED;
+
+	for (i = 1; i < watch->count; i++) {
+		file = watch->files + i;
+
+		stamped = filename_get_stamp(file->filename, &stamp);
+		if (stamped == file->stamped && (!stamped || stamp == file->stamp))
+			continue;
+
+		file->stamp = stamp;
+		file->stamped = stamped;
+
+		parse_watch_report_change(file->filename);
+
+		if (!parse_watch_reload_chapter(watch, file))
+			return PARSE_WATCH_ERROR;
+
+		changed = true;
+	}
+
+	if (!changed)
+		return PARSE_WATCH_UNCHANGED;
+
+	if (!parse_watch_link(watch))
+		return PARSE_WATCH_ERROR;
+
+	*document = watch->document;
+
+	return PARSE_WATCH_CHANGED;
+}
+
+/**
+ * Parse a watched document in full, discarding any previous version and
+ * recording the files which it was parsed from. Each chapter file is
+ * parsed into an arena of its own, so that it can be replaced on its own
+ * later. Any manual-level content in the chapter files is parsed into a
+ * stand-in manual and ignored, as it couldn't be replaced along with them.
+ *
+ * \param *watch	The watch to load the document for.
+ * \return		True if successful, even if the document failed to
+ *			parse; False on an unrecoverable error.
+ */
+
+static bool parse_watch_load(struct parse_watch *watch)
+{
+	struct manual_data	*manual = NULL, *chapter = NULL, *standin = NULL;
+	struct filename		*document_root = NULL, *document_base = NULL;
+	struct parse_watch_file	*file = NULL;
+
+	parse_watch_clear(watch);
+
+	watch->loaded = true;
+
+	/* Record the root file before parsing it, so that any changes made
+	 * while it is being read get picked up next time.
+	 */
+
+	document_base = filename_make(watch->filename, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LOCAL);
+	if (document_base == NULL || parse_watch_add_file(watch, document_base, NULL) == NULL) {
+		filename_destroy(document_base);
+		return false;
+	}
+
+	watch->document = manual_create(NULL);
+	if (watch->document == NULL)
+		return false;
+
+	manual_data_select_arena(watch->document->arena);
+
+	manual = parse_root_file(watch->filename, &document_root);
+	if (manual == NULL) {
+		filename_destroy(document_root);
+		manual_destroy(watch->document);
+		watch->document = NULL;
+		return true;
+	}
+
+	/* Parse the chapter files, each into its own arena. */
+
+	for (chapter = manual->first_child; chapter != NULL; chapter = chapter->next) {
+		if (chapter->type == MANUAL_DATA_OBJECT_TYPE_SECTION)
+			continue;
+
+		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
+			msg_report(MSG_BAD_TYPE);
+			filename_destroy(document_root);
+			manual_destroy(watch->document);
+			watch->document = NULL;
+			return true;
+		}
+
+		if (chapter->processed)
+			continue;
+
+		document_base = filename_up(document_root, 0);
+
+		if (!filename_append(document_base, chapter->chapter.filename, 0)) {
+			filename_destroy(document_base);
+			continue;
+		}
+
+		filename_destroy(chapter->chapter.filename);
+		chapter->chapter.filename = NULL;
+
+		file = parse_watch_add_file(watch, document_base, chapter);
+		if (file == NULL) {
+			filename_destroy(document_base);
+			filename_destroy(document_root);
+			return false;
+		}
+
+		file->arena = manual_arena_create();
+		if (file->arena == NULL) {
+			msg_report(MSG_DATA_MALLOC_FAIL);
+			filename_destroy(document_root);
+			return false;
+		}
+
+		manual_data_select_arena(file->arena);
+
+		standin = NULL;
+		parse_file(file->filename, &standin, chapter, NULL);
+	}
+
+	filename_destroy(document_root);
+
+	watch->document->manual = manual;
+
+	return parse_watch_link(watch);
+}
+
+/**
+ * Parse a chapter of a watched document again, replacing its previous
+ * contents with those of its file.
+ *
+ * \param *watch	The watch holding the chapter.
+ * \param *file		The file holding the chapter.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_watch_reload_chapter(struct parse_watch *watch, struct parse_watch_file *file)
+{
+	struct manual_data *chapter, *standin = NULL;
+
+	if (watch == NULL || file == NULL || file->chapter == NULL)
+		return false;
+
+	chapter = file->chapter;
+
+	/* Return the chapter to being a placeholder. */
+
+	chapter->title = NULL;
+	chapter->first_child = NULL;
+	chapter->annotations = NULL;
+	chapter->chapter.id = NULL;
+	chapter->chapter.resources = NULL;
+	chapter->processed = false;
+
+	/* Free the old contents, along with the source buffer which the
+	 * arena adopted when their text was claimed from it.
+	 */
+
+	manual_arena_destroy(file->arena);
+
+	file->arena = manual_arena_create();
+	if (file->arena == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return false;
+	}
+
+	manual_data_select_arena(file->arena);
+
+	parse_file(file->filename, &standin, chapter, NULL);
+
+	manual_data_select_arena(watch->document->arena);
+
+	return true;
+}
+
+/**
+ * Link a watched document, replacing any annotations from a previous link.
+ *
+ * \param *watch	The watch holding the document.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_watch_link(struct parse_watch *watch)
+{
+	struct manual_arena	*links;
+	struct stats_timer	timer;
+	bool			result;
+
+	if (watch == NULL || watch->document == NULL)
+		return false;
+
+	links = manual_arena_create();
+	if (links == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return false;
+	}
+
+	manual_data_select_arena(links);
+
+	stats_start(&timer);
+
+	result = parse_link(watch->document->manual);
+
+	stats_record(&timer, "link", NULL);
+
+	manual_data_select_arena(watch->document->arena);
+
+	/* Every node has now been annotated again. */
+
+	manual_arena_destroy(watch->links);
+	watch->links = links;
+
+	manual_ids_dump();
+
+	return result;
+}
+
+/**
+ * Add a file to the list of those being watched, recording its current
+ * stamp. The watch takes ownership of the filename.
+ *
+ * \param *watch	The watch to add the file to.
+ * \param *filename	The name of the file.
+ * \param *chapter	The chapter being parsed from the file, or NULL
+ *			for the root file.
+ * \return		Pointer to the new file entry, or NULL on failure.
+ */
+
+static struct parse_watch_file *parse_watch_add_file(struct parse_watch *watch, struct filename *filename, struct manual_data *chapter)
+{
+	struct parse_watch_file *files, *file;
+
+	if (watch->count >= watch->size) {
+		files = realloc(watch->files, (watch->size + PARSE_WATCH_BLOCK) * sizeof(struct parse_watch_file));
+		if (files == NULL) {
+			msg_report(MSG_DATA_MALLOC_FAIL);
+			return NULL;
+		}
+
+		watch->files = files;
+		watch->size += PARSE_WATCH_BLOCK;
+	}
+
+	file = watch->files + watch->count++;
+
+	file->filename = filename;
+	file->chapter = chapter;
+	file->arena = NULL;
+	file->stamped = filename_get_stamp(filename, &(file->stamp));
+
+	return file;
+}
+
+/**
+ * Discard the document held by a watch, along with its list of files.
+ *
+ * \param *watch	The watch to clear.
+ */
+
+static void parse_watch_clear(struct parse_watch *watch)
+{
+	int i;
+
+	for (i = 0; i < watch->count; i++) {
+		filename_destroy(watch->files[i].filename);
+		manual_arena_destroy(watch->files[i].arena);
+	}
+
+	watch->count = 0;
+
+	manual_arena_destroy(watch->links);
+	watch->links = NULL;
+
+	if (watch->document != NULL)
+		manual_destroy(watch->document);
+
+	watch->document = NULL;
+	watch->loaded = false;
+}
+
+/**
+ * Report that a watched file has changed.
+ *
+ * \param *filename	The name of the file.
+ */
+
+static void parse_watch_report_change(struct filename *filename)
+{
+	char *file;
+
+	file = filename_convert(filename, FILENAME_PLATFORM_LOCAL, 0);
+	if (file == NULL)
+		return;
+
+	msg_report(MSG_WATCH_CHANGED, file);
+
+	free(file);
+}
+
+/**
+ * Parse the non-inlined chapter files of a manual, using a pool of threads.
+ * The calling thread takes part, so at most threads - 1 new threads will
+ * be started.
+ *
+ * Each thread allocates from an arena of its own, which is merged into
+ * the document's arena once parsing is complete. Any manual-level content
+ * in the chapter files is applied to the root manual in chapter order, so
+ * that it is checked and reported exactly as when parsing serially: a
+ * thread waits for the earlier chapters to finish before it touches the
+ * manual.
+ *
+ * \param *document	The document being parsed.
+ * \param *manual	The root manual, whose chapters are to be parsed.
+ * \param *document_root	The folder containing the root file.
+ * \param threads	The number of threads to use.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_chapters_parallel(struct manual *document, struct manual_data *manual, struct filename *document_root, int threads)
+{
+	struct parse_chapter_pool	pool;
+	struct parse_chapter_worker	*workers;
+	struct manual_data		*chapter;
+	int				i, count = 0;
+
+	/* Check the chapter types, and count the chapters to be parsed. */
+
+	for (chapter = manual->first_child; chapter != NULL; chapter = chapter->next) {
+		if (chapter->type == MANUAL_DATA_OBJECT_TYPE_SECTION)
+			continue;
+
+		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
+			msg_report(MSG_BAD_TYPE);
+			return false;
+		}
+
+		if (!chapter->processed)
+			count++;
+	}
+
+	if (count == 0)
+		return true;
+
+	/* Build the pool of jobs, resolving the filenames before any of the
+	 * threads are started.
+	 */
+
+	pthread_once(&parse_worker_once, parse_create_worker_key);
+
+	if (!parse_worker_key_valid)
+		return false;
+
+	pool.jobs = malloc(count * sizeof(struct parse_chapter_job));
+	if (pool.jobs == NULL)
+		return false;
+
+	pool.manual = manual;
+	pool.count = 0;
+	pool.next = 0;
+	pool.finished = 0;
+
+	for (chapter = manual->first_child; chapter != NULL; chapter = chapter->next) {
+		if (chapter->type == MANUAL_DATA_OBJECT_TYPE_SECTION || chapter->processed)
+			continue;
+
+		pool.jobs[pool.count].filename = filename_up(document_root, 0);
+		pool.jobs[pool.count].chapter = chapter;
+		pool.jobs[pool.count].complete = false;
+
+		if (filename_append(pool.jobs[pool.count].filename, chapter->chapter.filename, 0)) {
+			filename_destroy(chapter->chapter.filename);
+			chapter->chapter.filename = NULL;
+
+			pool.count++;
+		} else {
+			filename_destroy(pool.jobs[pool.count].filename);
+		}
+	}
+
+	if (threads > count)
+		threads = count;
+
+	if (threads > PARSE_MAX_THREADS)
+		threads = PARSE_MAX_THREADS;
+
+	workers = malloc(threads * sizeof(struct parse_chapter_worker));
+	if (workers == NULL || pthread_mutex_init(&(pool.lock), NULL) != 0) {
+		for (i = 0; i < pool.count; i++)
+			filename_destroy(pool.jobs[i].filename);
+
+		free(pool.jobs);
+		free(workers);
+		return false;
+	}
+
+	if (pthread_cond_init(&(pool.progress), NULL) != 0) {
+		pthread_mutex_destroy(&(pool.lock));
+
+		for (i = 0; i < pool.count; i++)
+			filename_destroy(pool.jobs[i].filename);
+
+		free(pool.jobs);
+		free(workers);
+		return false;
+	}
+
+	/* Start the additional threads. Any which can't be set up are
+	 * skipped, leaving the remaining threads to take up the work.
+	 */
+
+	for (i = 0; i < threads; i++) {
+		workers[i].started = false;
+		workers[i].pool = &pool;
+		workers[i].arena = NULL;
+		workers[i].context = NULL;
+		workers[i].job = NULL;
+		workers[i].turn = false;
+
+		workers[i].context = msg_create_context(true);
+
+		if (i == 0)
+			continue;
+
+		workers[i].arena = manual_arena_create();
+
+		if (workers[i].arena != NULL && workers[i].context != NULL &&
+				pthread_create(&(workers[i].thread), NULL, parse_chapter_worker, &(workers[i])) == 0)
+			workers[i].started = true;
+	}
+
+	/* Take part in the parsing, then wait for the other threads. */
+
+	parse_chapter_worker(&(workers[0]));
+
+	for (i = 0; i < threads; i++) {
+		if (workers[i].started)
+			pthread_join(workers[i].thread, NULL);
+
+		manual_arena_merge(document->arena, workers[i].arena);
+		msg_destroy_context(workers[i].context);
+	}
+
+	/* Report the messages from the workers, in chapter order. */
+
+	msg_flush();
+
+	pthread_cond_destroy(&(pool.progress));
+	pthread_mutex_destroy(&(pool.lock));
+
+	for (i = 0; i < pool.count; i++)
+		filename_destroy(pool.jobs[i].filename);
+
+	free(pool.jobs);
+	free(workers);
+
+	return true;
+}
+
+/**
+ * Parse chapter files claimed from a pool until there are none left.
+ *
+ * \param *data		Pointer to the worker's data block.
+ * \return		NULL.
+ */
+
+static void *parse_chapter_worker(void *data)
+{
+	struct parse_chapter_worker	*worker = data;
+	struct parse_chapter_job	*job;
+	struct manual_data		*manual;
+
+	if (worker == NULL)
+		return NULL;
+
+	pthread_setspecific(parse_worker_key, worker);
+
+	if (worker->context != NULL)
+		msg_select_context(worker->context);
+
+	if (worker->arena != NULL)
+		manual_data_select_arena(worker->arena);
+
+	while ((job = parse_claim_chapter_job(worker->pool)) != NULL) {
+		msg_set_order(job - worker->pool->jobs);
 
-static void parse_unknown(struct parse_xml_block *parser);
-static void parse_resources(struct parse_xml_block *parser, struct manual_data_resources *resources);
-static void parse_mode_resources(struct parse_xml_block *parser, enum modes_type mode, struct manual_data_mode *resources);
-static struct manual_data *parse_multi_level_attribute(struct parse_xml_block *parser, char *attribute);
-static struct manual_data *parse_single_level_attribute(struct parse_xml_block *parser, char *attribute);
-static bool parse_fetch_single_level_block(struct parse_xml_block *parser, char *buffer, size_t length);
-static void parse_link_item(struct manual_data **previous, struct manual_data *parent, struct manual_data *item);
+		worker->job = job;
+		worker->turn = false;
+
+		manual = worker->pool->manual;
+		parse_file(job->filename, &manual, job->chapter, NULL);
+
+		worker->job = NULL;
+		parse_finish_chapter_job(worker->pool, job);
+	}
+
+	if (worker->context != NULL)
+		msg_select_context(NULL);
+
+	pthread_setspecific(parse_worker_key, NULL);
+
+	return NULL;
+}
 
 /**
- * Parse an XML file and its descendents.
+ * Claim the next unparsed chapter file from a pool.
  *
- * \param *filename	The name of the root file to parse.
- * \return		Pointer to the resulting manual structure.
+ * \param *pool		Pointer to the pool to claim from.
+ * \return		Pointer to the claimed job, or NULL if none remain.
  */
 
-struct manual *parse_document(char *filename)
+static struct parse_chapter_job *parse_claim_chapter_job(struct parse_chapter_pool *pool)
 {
-	struct manual		*document = NULL;
-	struct manual_data	*manual = NULL, *chapter = NULL;
-	struct filename		*document_root = NULL, *document_base = NULL;
+	struct parse_chapter_job *job = NULL;
 
-	document_base = filename_make(filename, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LOCAL);
-	if (document_base == NULL)
-		return NULL;
+	pthread_mutex_lock(&(pool->lock));
 
-	document_root = filename_up(document_base, 1);
-	if (document_root == NULL)
-		return NULL;
+	if (pool->next < pool->count)
+		job = &(pool->jobs[pool->next++]);
 
-	/* Parse the root file. */
+	pthread_mutex_unlock(&(pool->lock));
 
-	parse_file(document_base, &manual, chapter);
-	filename_destroy(document_base);
+	return job;
+}
 
-	if (manual == NULL)
-		return NULL;
+/**
+ * Mark a job in a pool as finished, advancing the count of jobs finished
+ * in chapter order and waking any threads waiting for their turn.
+ *
+ * \param *pool		Pointer to the pool holding the job.
+ * \param *job		Pointer to the job which has finished.
+ */
 
-	if (manual->type != MANUAL_DATA_OBJECT_TYPE_MANUAL) {
-		msg_report(MSG_BAD_TYPE);
-		return NULL;
-	}
+static void parse_finish_chapter_job(struct parse_chapter_pool *pool, struct parse_chapter_job *job)
+{
+	pthread_mutex_lock(&(pool->lock));
 
-	/* Parse any non-inlined chapter files. */
+	job->complete = true;
 
-	chapter = manual->first_child;
+	while (pool->finished < pool->count && pool->jobs[pool->finished].complete)
+		pool->finished++;
 
-	while (chapter != NULL) {
-		if (chapter->type != MANUAL_DATA_OBJECT_TYPE_SECTION) {
-			if (chapter->type != MANUAL_DATA_OBJECT_TYPE_CHAPTER && chapter->type != MANUAL_DATA_OBJECT_TYPE_INDEX) {
-				msg_report(MSG_BAD_TYPE);
-				return NULL;
-			}
+	pthread_cond_broadcast(&(pool->progress));
+	pthread_mutex_unlock(&(pool->lock));
+}
 
-			if (!chapter->chapter.processed) {
-				document_base = filename_up(document_root, 0);
+/**
+ * If the calling thread is parsing a chapter file from a pool, wait until
+ * all of the earlier chapters in the pool have finished, so that the
+ * thread can safely update the shared root manual. Jobs are claimed in
+ * chapter order, so the earliest unfinished job never waits.
+ *
+ * When parsing serially, this returns immediately.
+ */
 
-				if (filename_append(document_base, chapter->chapter.filename, 0)) {
-					filename_destroy(chapter->chapter.filename);
-					chapter->chapter.filename = NULL;
+static void parse_wait_for_manual(void)
+{
+	struct parse_chapter_worker	*worker;
+	struct parse_chapter_pool	*pool;
+	int				index;
 
-					parse_file(document_base, &manual, chapter);
-				}
+	if (!parse_worker_key_valid)
+		return;
 
-				filename_destroy(document_base);
-			}
-		}
+	worker = pthread_getspecific(parse_worker_key);
+	if (worker == NULL || worker->job == NULL || worker->turn)
+		return;
 
-		chapter = chapter->next;
-	}
+	pool = worker->pool;
+	index = worker->job - pool->jobs;
 
-	/* Link the document. */
+	pthread_mutex_lock(&(pool->lock));
 
-	document = manual_create(manual);
-	if (document == NULL)
-		return NULL;
+	while (pool->finished < index)
+		pthread_cond_wait(&(pool->progress), &(pool->lock));
 
-	if (!parse_link(manual))
-		return NULL;
+	pthread_mutex_unlock(&(pool->lock));
 
-	manual_ids_dump();
+	worker->turn = true;
+}
 
-	return document;
-} 
+/**
+ * Create the key used to hold the chapter worker for each thread, on
+ * behalf of pthread_once().
+ */
+
+static void parse_create_worker_key(void)
+{
+	parse_worker_key_valid = (pthread_key_create(&parse_worker_key, NULL) == 0) ? true : false;
+}
 
 /**
  * Parse an XML file.
@@ -161,14 +1663,20 @@ struct manual *parse_document(char *filename)
  *			file.
  * \param **chapter	Pointer to the current chapter. The chapter pointer
  * 			can be NULL if this is the root file.
+ * \param *select	Pointer to a chapter selection, if only the header of
+ *			a chapter other than the selected one is to be
+ *			parsed, or NULL to parse the whole file.
  */
 
-static bool parse_file(struct filename *filename, struct manual_data **manual, struct manual_data *chapter)
+static bool parse_file(struct filename *filename, struct manual_data **manual, struct manual_data *chapter, struct parse_select *select)
 {
 	struct parse_xml_block	*parser;
 	enum parse_xml_result	result;
 	enum parse_element_type	element;
 	char			*file = NULL;
+	struct stats_timer	timer;
+
+	stats_start(&timer);
 
 	file = filename_convert(filename, FILENAME_PLATFORM_LOCAL, 0);
 
@@ -177,9 +1685,12 @@ static bool parse_file(struct filename *filename, struct manual_data **manual, s
 		return false;
 	}
 
-	/* Construct a parser and open the XML file. */
+	/* Construct a parser and open the XML file. A file which may only
+	 * have its header parsed is read as the parser reaches it, so that
+	 * the rest is never read if the parse stops early.
+	 */
 
-	parser = parse_xml_open_file(file);
+	parser = parse_xml_open_file(file, (select != NULL) ? true : false);
 
 	if (parser == NULL) {
 		msg_report(MSG_OPEN_FAIL, file);
@@ -200,7 +1711,7 @@ static bool parse_file(struct filename *filename, struct manual_data **manual, s
 
 			switch (element) {
 			case PARSE_ELEMENT_MANUAL:
-				parse_manual(parser, manual, chapter);
+				parse_manual(parser, manual, chapter, select);
 				break;
 			default:
 				msg_report(MSG_UNEXPECTED_NODE, parse_element_find_tag(element), "Outer");
@@ -217,7 +1728,7 @@ static bool parse_file(struct filename *filename, struct manual_data **manual, s
 			msg_report(MSG_UNEXPECTED_XML, parse_xml_get_result_name(result), "Outer");
 			break;
 		}
-	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF);
+	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && (select == NULL || !select->partial));
 
 	/* Report any errors. */
 
@@ -228,6 +1739,8 @@ static bool parse_file(struct filename *filename, struct manual_data **manual, s
 
 	parse_xml_close_file(parser);
 
+	stats_record(&timer, "parse", file);
+
 	/* Free the file name storage. */
 
 	free(file);
@@ -245,9 +1758,10 @@ static bool parse_file(struct filename *filename, struct manual_data **manual, s
  *			file.
  * \param *chapter	Pointer the current chapter. The chapter pointer can be
  * 			NULL if this is the root file.
+ * \param *select	Pointer to a chapter selection, or NULL.
  */
 
-static void parse_manual(struct parse_xml_block *parser, struct manual_data **manual, struct manual_data *chapter)
+static void parse_manual(struct parse_xml_block *parser, struct manual_data **manual, struct manual_data *chapter, struct parse_select *select)
 {
 	bool done = false;
 	enum parse_xml_result result;
@@ -269,7 +1783,7 @@ static void parse_manual(struct parse_xml_block *parser, struct manual_data **ma
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Manual", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Manual", parse_element_find_tag(type));
 
 	/* Process the manual contents. */
 
@@ -280,6 +1794,14 @@ static void parse_manual(struct parse_xml_block *parser, struct manual_data **ma
 		case PARSE_XML_RESULT_TAG_START:
 			element = parse_xml_get_element(parser);
 
+			/* Anything other than the chapter itself touches the
+			 * manual, so wait for any earlier chapters being parsed
+			 * on other threads to finish first.
+			 */
+
+			if (element != PARSE_ELEMENT_CHAPTER && element != PARSE_ELEMENT_INDEX && element != PARSE_ELEMENT_NONE)
+				parse_wait_for_manual();
+
 			switch (element) {
 			case PARSE_ELEMENT_TITLE:
 				if ((*manual)->title == NULL) {
@@ -369,9 +1891,11 @@ static void parse_manual(struct parse_xml_block *parser, struct manual_data **ma
 				break;
 			case PARSE_ELEMENT_CHAPTER:
 			case PARSE_ELEMENT_INDEX:
-				item = parse_chapter(parser, chapter);
+				item = parse_chapter(parser, chapter, select);
 				if (chapter == NULL)
 					parse_link_item(&tail, *manual, item);
+				if (select != NULL && select->partial)
+					done = true;
 				break;
 			case PARSE_ELEMENT_SECTION:
 				item = parse_section(parser);
@@ -391,6 +1915,7 @@ static void parse_manual(struct parse_xml_block *parser, struct manual_data **ma
 			switch (element) {
 			case PARSE_ELEMENT_CHAPTER:
 			case PARSE_ELEMENT_INDEX:
+				parse_wait_for_manual();
 				item = parse_placeholder_chapter(parser, *manual);
 				parse_link_item(&tail, *manual, item);
 				break;
@@ -420,7 +1945,7 @@ static void parse_manual(struct parse_xml_block *parser, struct manual_data **ma
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 	
-	msg_report(MSG_PARSE_POP, "Manual", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Manual", parse_element_find_tag(type));
 }
 
 
@@ -444,7 +1969,7 @@ static struct manual_data *parse_placeholder_chapter(struct parse_xml_block *par
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Placeholder Chapter", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Placeholder Chapter", parse_element_find_tag(type));
 
 	/* Read the supplied filename. */
 
@@ -489,12 +2014,16 @@ static struct manual_data *parse_placeholder_chapter(struct parse_xml_block *par
  * \param *parser	Pointer to the parser to use.
  * \param *chapter	Pointer to a placeholder chapter to use, or NULL to
  *			create a new one.
+ * \param *select	Pointer to a chapter selection, or NULL. If the
+ *			chapter isn't the selected one, parsing stops at the
+ *			end of its header and the selection is marked as
+ *			partial.
  * \return		Pointer to the new data structure.
  */
 
-static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct manual_data *chapter)
+static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct manual_data *chapter, struct parse_select *select)
 {
-	bool done = false;
+	bool done = false, header = false;
 	enum parse_xml_result result;
 	enum parse_element_type type, element;
 	struct manual_data *new_chapter = NULL, *tail = NULL, *item = NULL;
@@ -504,7 +2033,7 @@ static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Chapter", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Chapter", parse_element_find_tag(type));
 
 	/* Create the new chapter object. */
 
@@ -532,11 +2061,16 @@ static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct
 
 	/* Read the chapter id. */
 
-	new_chapter->chapter.id = parse_xml_get_attribute_text(parser, "id");
+	new_chapter->chapter.id = parse_get_attribute_text(parser, "id");
+
+	/* Only the header is needed if another chapter has been selected. */
+
+	if (select != NULL && (new_chapter->chapter.id == NULL || strcmp(new_chapter->chapter.id, select->id) != 0))
+		header = true;
 
 	/* We've now processed the actual chapter data. */
 
-	new_chapter->chapter.processed = true;
+	new_chapter->processed = true;
 
 	/* Parse the chapter contents. */
 
@@ -579,6 +2113,12 @@ static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct
 					parse_xml_set_error(parser);
 				break;
 			case PARSE_ELEMENT_SECTION:
+				if (header) {
+					select->partial = true;
+					done = true;
+					break;
+				}
+
 				item = parse_section(parser);
 				parse_link_item(&tail, new_chapter, item);
 				break;
@@ -595,6 +2135,12 @@ static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct
 
 			switch (element) {
 			case PARSE_ELEMENT_CHAPTERLIST:
+				if (header) {
+					select->partial = true;
+					done = true;
+					break;
+				}
+
 				item = manual_data_create(MANUAL_DATA_OBJECT_TYPE_CONTENTS);
 				if (item == NULL) {
 					result = parse_xml_set_error(parser);
@@ -630,7 +2176,7 @@ static struct manual_data *parse_chapter(struct parse_xml_block *parser, struct
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Chapter", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Chapter", parse_element_find_tag(type));
 
 	return new_chapter;
 }
@@ -656,7 +2202,7 @@ static struct manual_data *parse_section(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Section", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Section", parse_element_find_tag(type));
 
 	/* Create the new section object. */
 
@@ -677,7 +2223,7 @@ static struct manual_data *parse_section(struct parse_xml_block *parser)
 
 	/* Read the section id. */
 
-	new_section->chapter.id = parse_xml_get_attribute_text(parser, "id");
+	new_section->chapter.id = parse_get_attribute_text(parser, "id");
 
 	/* Parse the section contents. */
 
@@ -796,7 +2342,7 @@ static struct manual_data *parse_section(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Section", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Section", parse_element_find_tag(type));
 
 	return new_section;
 }
@@ -823,7 +2369,7 @@ static struct manual_data *parse_block_collection_object(struct parse_xml_block
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Block Collection", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Block Collection", parse_element_find_tag(type));
 
 	/* Create the block object. */
 
@@ -837,7 +2383,7 @@ static struct manual_data *parse_block_collection_object(struct parse_xml_block
 		/* Read the foornote ID. */
 
 		if (new_block != NULL)
-			new_block->chapter.id = parse_xml_get_attribute_text(parser, "id");
+			new_block->chapter.id = parse_get_attribute_text(parser, "id");
 		break;
 	default:
 		msg_report(MSG_UNEXPECTED_BLOCK_ADD, parse_element_find_tag(type), "Block Collection");
@@ -925,7 +2471,7 @@ static struct manual_data *parse_block_collection_object(struct parse_xml_block
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 	
-	msg_report(MSG_PARSE_POP, "Block Collection", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Block Collection", parse_element_find_tag(type));
 
 	return new_block;
 
@@ -951,7 +2497,7 @@ static struct manual_data *parse_callout(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Callout", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Callout", parse_element_find_tag(type));
 
 	/* Create the new section object. */
 
@@ -975,34 +2521,34 @@ static struct manual_data *parse_callout(struct parse_xml_block *parser)
 	switch (parse_xml_read_option_attribute(parser, "type", 10,
 		"attention", "caution", "danger", "error", "hint", "important", "note", "seealso", "tip", "warning")) {
 	case 0:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ATTENTION;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ATTENTION;
 		break;
 	case 1:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_CAUTION;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_CAUTION;
 		break;
 	case 2:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_DANGER;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_DANGER;
 		break;
 	case 3:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ERROR;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_ERROR;
 		break;
 	case 4:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_HINT;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_HINT;
 		break;
 	case 5:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_IMPORTANT;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_IMPORTANT;
 		break;
 	case 6:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_NOTE;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_NOTE;
 		break;
 	case 7:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_SEEALSO;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_SEEALSO;
 		break;
 	case 8:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_TIP;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_TIP;
 		break;
 	case 9:
-		new_box->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_WARNING;
+		new_box->flags |= MANUAL_DATA_OBJECT_FLAGS_CALLOUT_TYPE_WARNING;
 		break;
 	default:
 		msg_report(MSG_MISSING_ATTRIBUTE, "type");
@@ -1069,7 +2615,7 @@ static struct manual_data *parse_callout(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Callout", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Callout", parse_element_find_tag(type));
 
 	return new_box;
 }
@@ -1093,7 +2639,7 @@ static struct manual_data *parse_list(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "List", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "List", parse_element_find_tag(type));
 
 	/* Create the new list object. */
 
@@ -1159,7 +2705,7 @@ static struct manual_data *parse_list(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "List", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "List", parse_element_find_tag(type));
 
 	return new_list;
 }
@@ -1168,12 +2714,35 @@ static struct manual_data *parse_list(struct parse_xml_block *parser)
 /**
  * Process a table object (TABLE), returning a pointer to the root
  * of the new data structure.
+ * The call is profiled, if profiling has been built in.
  *
  * \param *parser	Pointer to the parser to use.
  * \return		Pointer to the new data structure.
  */
 
 static struct manual_data *parse_table(struct parse_xml_block *parser)
+{
+	struct manual_data *result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = parse_table_contents(parser);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_PARSE_TABLE, MANUAL_DATA_OBJECT_TYPE_TABLE);
+
+	return result;
+}
+
+/**
+ * Carry out the work of parse_table(), which calls this so that it
+ * can be profiled.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \return		Pointer to the new data structure.
+ */
+
+static struct manual_data *parse_table_contents(struct parse_xml_block *parser)
 {
 	bool done = false;
 	int column_count, defined_columns = 0;
@@ -1185,7 +2754,7 @@ static struct manual_data *parse_table(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Table", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Table", parse_element_find_tag(type));
 
 	/* Create the new table object. */
 
@@ -1206,7 +2775,7 @@ static struct manual_data *parse_table(struct parse_xml_block *parser)
 
 	/* Read the table id. */
 
-	new_table->chapter.id = parse_xml_get_attribute_text(parser, "id");
+	new_table->chapter.id = parse_get_attribute_text(parser, "id");
 
 	/* Read the table title. */
 
@@ -1311,7 +2880,7 @@ static struct manual_data *parse_table(struct parse_xml_block *parser)
 		row = row->next;
 	}
 
-	msg_report(MSG_PARSE_POP, "Table", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Table", parse_element_find_tag(type));
 
 	return new_table;
 }
@@ -1336,7 +2905,7 @@ static struct manual_data *parse_table_column_set(struct parse_xml_block *parser
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Table Column Set", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Table Column Set", parse_element_find_tag(type));
 
 	/* Create the new table column set object. */
 
@@ -1399,7 +2968,7 @@ static struct manual_data *parse_table_column_set(struct parse_xml_block *parser
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Table Column Set", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Table Column Set", parse_element_find_tag(type));
 
 	return new_table_column_set;
 }
@@ -1423,7 +2992,7 @@ static struct manual_data *parse_table_row(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Table Row", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Table Row", parse_element_find_tag(type));
 
 	/* Create the new table row object. */
 
@@ -1486,7 +3055,7 @@ static struct manual_data *parse_table_row(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Table Row", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Table Row", parse_element_find_tag(type));
 
 	return new_table_row;
 }
@@ -1511,7 +3080,7 @@ static struct manual_data *parse_code_block(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Code Block", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Code Block", parse_element_find_tag(type));
 
 	/* Create the new code block object. */
 
@@ -1532,7 +3101,7 @@ static struct manual_data *parse_code_block(struct parse_xml_block *parser)
 
 	/* Read the code block id. */
 
-	new_code_block->chapter.id = parse_xml_get_attribute_text(parser, "id");
+	new_code_block->chapter.id = parse_get_attribute_text(parser, "id");
 
 	/* Read the code block title. */
 
@@ -1555,7 +3124,7 @@ static struct manual_data *parse_code_block(struct parse_xml_block *parser)
 				msg_report(MSG_DATA_MALLOC_FAIL);
 				continue;
 			}
-			item->chunk.text = parse_xml_get_text(parser);
+			item->chunk.text = parse_get_text(parser);
 			parse_link_item(&tail, new_code_block, item);
 			break;
 
@@ -1590,7 +3159,7 @@ static struct manual_data *parse_code_block(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Code Block", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Code Block", parse_element_find_tag(type));
 
 	return new_code_block;
 }
@@ -1598,12 +3167,35 @@ static struct manual_data *parse_code_block(struct parse_xml_block *parser)
 /**
  * Process a block object (P, TITLE, SUMMARY, COL, COLDEF), returning a pointer to the root
  * of the new data structure.
+ * The call is profiled, if profiling has been built in.
  *
  * \param *parser	Pointer to the parser to use.
  * \return		Pointer to the new data structure.
  */
 
 static struct manual_data *parse_block_object(struct parse_xml_block *parser)
+{
+	struct manual_data *result;
+	PROFILE_TIMER(timer);
+
+	PROFILE_START(timer);
+
+	result = parse_block_object_contents(parser);
+
+	PROFILE_RECORD(timer, PROFILE_HOOK_PARSE_BLOCK, (result != NULL) ? result->type : MANUAL_DATA_OBJECT_TYPE_NONE);
+
+	return result;
+}
+
+/**
+ * Carry out the work of parse_block_object(), which calls this so that it
+ * can be profiled.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \return		Pointer to the new data structure.
+ */
+
+static struct manual_data *parse_block_object_contents(struct parse_xml_block *parser)
 {
 	bool done = false;
 	enum parse_xml_result result;
@@ -1614,122 +3206,18 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Block", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Block", parse_element_find_tag(type));
 
 	/* Create the block object. */
 
-	switch (type) {
-	case PARSE_ELEMENT_NONE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_MULTI_LEVEL_ATTRIBUTE);
-		break;
-	case PARSE_ELEMENT_PARAGRAPH:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_PARAGRAPH);
-		break;
-	case PARSE_ELEMENT_TITLE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_TITLE);
-		break;
-	case PARSE_ELEMENT_SUMMARY:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_SUMMARY);
-		break;
-	case PARSE_ELEMENT_STRAPLINE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_STRAPLINE);
-		break;
-	case PARSE_ELEMENT_CREDIT:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_CREDIT);
-		break;
-	case PARSE_ELEMENT_VERSION:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_VERSION);
-		break;
-	case PARSE_ELEMENT_DATE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_DATE);
-		break;
-	case PARSE_ELEMENT_COL:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN);
-		break;
-	case PARSE_ELEMENT_COLDEF:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_TABLE_COLUMN_DEFINITION);
-		break;
-	case PARSE_ELEMENT_CITE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_CITATION);
-		break;
-	case PARSE_ELEMENT_CODE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_CODE);
-		break;
-	case PARSE_ELEMENT_COMMAND:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_COMMAND);
-		break;
-	case PARSE_ELEMENT_CONST:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_CONSTANT);
-		break;
-	case PARSE_ELEMENT_EM:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_LIGHT_EMPHASIS);
-		break;
-	case PARSE_ELEMENT_ENTRY:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_USER_ENTRY);
-		break;
-	case PARSE_ELEMENT_EVENT:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_EVENT);
-		break;
-	case PARSE_ELEMENT_FILE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_FILENAME);
-		break;
-	case PARSE_ELEMENT_FUNCTION:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_FUNCTION);
-		break;
-	case PARSE_ELEMENT_ICON:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_ICON);
-		break;
-	case PARSE_ELEMENT_INTRO:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_INTRO);
-		break;
-	case PARSE_ELEMENT_KEY:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_KEY);
-		break;
-	case PARSE_ELEMENT_KEYWORD:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_KEYWORD);
-		break;
-	case PARSE_ELEMENT_LINK:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_LINK);
-		break;
-	case PARSE_ELEMENT_MATHS:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_MATHS);
-		break;
-	case PARSE_ELEMENT_MENU:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_MENU);
-		break;
-	case PARSE_ELEMENT_MESSAGE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_MESSAGE);
-		break;
-	case PARSE_ELEMENT_MOUSE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_MOUSE);
-		break;
-	case PARSE_ELEMENT_NAME:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_NAME);
-		break;
-	case PARSE_ELEMENT_REF:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_REFERENCE);
-		break;
-	case PARSE_ELEMENT_STRONG:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_STRONG_EMPHASIS);
-		break;
-	case PARSE_ELEMENT_SWI:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_SWI);
-		break;
-	case PARSE_ELEMENT_TYPE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_TYPE);
-		break;
-	case PARSE_ELEMENT_VARIABLE:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_VARIABLE);
-		break;
-	case PARSE_ELEMENT_WINDOW:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_WINDOW);
-		break;
-	default:
+	if (type < 0 || type > PARSE_ELEMENT_NONE || parse_block_definitions[type].type == MANUAL_DATA_OBJECT_TYPE_NONE) {
 		msg_report(MSG_UNEXPECTED_BLOCK_ADD, parse_element_find_tag(type), "Block");
 		parse_xml_set_error(parser);
 		return NULL;
 	}
 
+	new_block = manual_data_create(parse_block_definitions[type].type);
+
 	if (new_block == NULL) {
 		parse_xml_set_error(parser);
 		return NULL;
@@ -1737,26 +3225,7 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 
 	/* Read attributes where applicable. */
 
-	switch (type) {
-	case PARSE_ELEMENT_LINK:
-		new_block->chunk.link = parse_single_level_attribute(parser, "href");
-		parse_link_item(NULL, new_block, new_block->chunk.link);
-
-		if (parse_xml_test_boolean_attribute(parser, "external", "true", "false"))
-			new_block->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_EXTERNAL;
-
-		if (parse_xml_test_boolean_attribute(parser, "flatten", "true", "false"))
-			new_block->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_FLATTEN;
-		break;
-	case PARSE_ELEMENT_REF:
-		new_block->chunk.id = parse_xml_get_attribute_text(parser, "id");
-		break;
-	case PARSE_ELEMENT_COLDEF:
-		new_block->chunk.width = parse_xml_read_integer_attribute(parser, "width", 0, 0, 1000);
-		break;
-	default:
-		break;
-	}
+	parse_block_attributes(parser, type, new_block);
 
 	/* Process the content within the new object. */
 
@@ -1772,8 +3241,7 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 				msg_report(MSG_DATA_MALLOC_FAIL);
 				continue;
 			}
-			item->chunk.text = parse_xml_get_text(parser);
-			encoding_flatten_whitespace(item->chunk.text);
+			item->chunk.text = parse_get_flat_text(parser);
 			parse_link_item(&tail, new_block, item);
 			break;
 
@@ -1791,49 +3259,19 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 		case PARSE_XML_RESULT_TAG_START:
 			element = parse_xml_get_element(parser);
 
-			switch (element) {
-			case PARSE_ELEMENT_CITE:
-			case PARSE_ELEMENT_CODE:
-			case PARSE_ELEMENT_COMMAND:
-			case PARSE_ELEMENT_CONST:
-			case PARSE_ELEMENT_EM:
-			case PARSE_ELEMENT_ENTRY:
-			case PARSE_ELEMENT_EVENT:
-			case PARSE_ELEMENT_FILE:
-			case PARSE_ELEMENT_FUNCTION:
-			case PARSE_ELEMENT_ICON:
-			case PARSE_ELEMENT_INTRO:
-			case PARSE_ELEMENT_KEY:
-			case PARSE_ELEMENT_KEYWORD:
-			case PARSE_ELEMENT_LINK:
-			case PARSE_ELEMENT_MATHS:
-			case PARSE_ELEMENT_MENU:
-			case PARSE_ELEMENT_MESSAGE:
-			case PARSE_ELEMENT_MOUSE:
-			case PARSE_ELEMENT_NAME:
-			case PARSE_ELEMENT_REF:
-			case PARSE_ELEMENT_STRONG:
-			case PARSE_ELEMENT_SWI:
-			case PARSE_ELEMENT_TYPE:
-			case PARSE_ELEMENT_VARIABLE:
-			case PARSE_ELEMENT_WINDOW:
+			if (parse_block_definitions[element].flags & PARSE_BLOCK_INLINE) {
 				item = parse_block_object(parser);
 				parse_link_item(&tail, new_block, item);
-				break;
-			case PARSE_ELEMENT_NONE:
-				break;
-			default:
+			} else if (element != PARSE_ELEMENT_NONE) {
 				msg_report(MSG_UNEXPECTED_NODE, parse_element_find_tag(element), parse_element_find_tag(type));
 				parse_unknown(parser);
-				break;
 			}
 			break;
 
 		case PARSE_XML_RESULT_TAG_EMPTY:
 			element = parse_xml_get_element(parser);
 
-			switch (element) {
-			case PARSE_ELEMENT_BR:
+			if (element == PARSE_ELEMENT_BR) {
 				item = manual_data_create(MANUAL_DATA_OBJECT_TYPE_LINE_BREAK);
 				if (item == NULL) {
 					result = parse_xml_set_error(parser);
@@ -1841,18 +3279,12 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 					continue;
 				}
 				parse_link_item(&tail, new_block, item);
-				break;
-			case PARSE_ELEMENT_LINK:
-			case PARSE_ELEMENT_REF:
+			} else if (parse_block_definitions[element].flags & PARSE_BLOCK_EMPTY) {
 				item = parse_empty_block_object(parser);
 				parse_link_item(&tail, new_block, item);
-				break;
-			case PARSE_ELEMENT_NONE:
-				break;
-			default:
+			} else if (element != PARSE_ELEMENT_NONE) {
 				msg_report(MSG_UNEXPECTED_NODE, parse_element_find_tag(element), parse_element_find_tag(type));
 				parse_unknown(parser);
-				break;
 			}
 			break;
 
@@ -1876,7 +3308,7 @@ static struct manual_data *parse_block_object(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 	
-	msg_report(MSG_PARSE_POP, "Block", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Block", parse_element_find_tag(type));
 
 	return new_block;
 }
@@ -1899,23 +3331,18 @@ static struct manual_data *parse_empty_block_object(struct parse_xml_block *pars
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Empty Block", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Empty Block", parse_element_find_tag(type));
 
 	/* Create the block object. */
 
-	switch (type) {
-	case PARSE_ELEMENT_LINK:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_LINK);
-		break;
-	case PARSE_ELEMENT_REF:
-		new_block = manual_data_create(MANUAL_DATA_OBJECT_TYPE_REFERENCE);
-		break;
-	default:
+	if (type < 0 || type > PARSE_ELEMENT_NONE || !(parse_block_definitions[type].flags & PARSE_BLOCK_EMPTY)) {
 		msg_report(MSG_UNEXPECTED_BLOCK_ADD, parse_element_find_tag(type), "Empty Block");
 		parse_xml_set_error(parser);
 		return NULL;
 	}
 
+	new_block = manual_data_create(parse_block_definitions[type].type);
+
 	if (new_block == NULL) {
 		parse_xml_set_error(parser);
 		return NULL;
@@ -1923,25 +3350,43 @@ static struct manual_data *parse_empty_block_object(struct parse_xml_block *pars
 
 	/* Read attributes where applicable. */
 
+	parse_block_attributes(parser, type, new_block);
+
+	return new_block;
+}
+
+
+/**
+ * Read the attributes of a block object (LINK, REF, COLDEF) into its
+ * data structure. Other block objects take no attributes.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \param type		The element type of the block object.
+ * \param *block	Pointer to the data structure for the block.
+ */
+
+static void parse_block_attributes(struct parse_xml_block *parser, enum parse_element_type type, struct manual_data *block)
+{
 	switch (type) {
 	case PARSE_ELEMENT_LINK:
-		new_block->chunk.link = parse_single_level_attribute(parser, "href");
-		parse_link_item(NULL, new_block, new_block->chunk.link);
+		block->chunk.link = parse_single_level_attribute(parser, "href");
+		parse_link_item(NULL, block, block->chunk.link);
 
 		if (parse_xml_test_boolean_attribute(parser, "external", "true", "false"))
-			new_block->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_EXTERNAL;
+			block->flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_EXTERNAL;
 
 		if (parse_xml_test_boolean_attribute(parser, "flatten", "true", "false"))
-			new_block->chunk.flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_FLATTEN;
+			block->flags |= MANUAL_DATA_OBJECT_FLAGS_LINK_FLATTEN;
 		break;
 	case PARSE_ELEMENT_REF:
-		new_block->chunk.id = parse_xml_get_attribute_text(parser, "id");
+		block->chunk.id = parse_get_attribute_text(parser, "id");
+		break;
+	case PARSE_ELEMENT_COLDEF:
+		block->chunk.width = parse_xml_read_integer_attribute(parser, "width", 0, 0, 1000);
 		break;
 	default:
 		break;
 	}
-
-	return new_block;
 }
 
 
@@ -1961,7 +3406,7 @@ static void parse_unknown(struct parse_xml_block *parser)
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Unknown", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Unknown", parse_element_find_tag(type));
 
 	do {
 		result = parse_xml_read_next_chunk(parser);
@@ -1991,7 +3436,7 @@ static void parse_unknown(struct parse_xml_block *parser)
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 	
-	msg_report(MSG_PARSE_POP, "Unknown", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Unknown", parse_element_find_tag(type));
 }
 
 
@@ -2016,7 +3461,7 @@ static void parse_resources(struct parse_xml_block *parser, struct manual_data_r
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Resources", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Resources", parse_element_find_tag(type));
 
 	if (type != PARSE_ELEMENT_RESOURCES) {
 		msg_report(MSG_UNEXPECTED_BLOCK_ADD, parse_element_find_tag(type), "Resources");
@@ -2091,7 +3536,7 @@ static void parse_resources(struct parse_xml_block *parser, struct manual_data_r
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Resources", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Resources", parse_element_find_tag(type));
 }
 
 
@@ -2115,7 +3560,7 @@ static void parse_mode_resources(struct parse_xml_block *parser, enum modes_type
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Mode Resources", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Mode Resources", parse_element_find_tag(type));
 
 	if (type != PARSE_ELEMENT_MODE) {
 		msg_report(MSG_UNEXPECTED_BLOCK_ADD, parse_element_find_tag(type), "Mode Resources");
@@ -2184,7 +3629,7 @@ static void parse_mode_resources(struct parse_xml_block *parser, enum modes_type
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Mode Resources", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Mode Resources", parse_element_find_tag(type));
 }
 
 /**
@@ -2234,7 +3679,7 @@ static struct manual_data *parse_single_level_attribute(struct parse_xml_block *
 
 	type = parse_xml_get_element(attribute_parser);
 
-	msg_report(MSG_PARSE_PUSH, "Single Level Attribute", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Single Level Attribute", parse_element_find_tag(type));
 
 	/* Create the block object. */
 
@@ -2267,8 +3712,7 @@ static struct manual_data *parse_single_level_attribute(struct parse_xml_block *
 				msg_report(MSG_DATA_MALLOC_FAIL);
 				continue;
 			}
-			item->chunk.text = parse_xml_get_text(attribute_parser);
-			encoding_flatten_whitespace(item->chunk.text);
+			item->chunk.text = parse_get_flat_text(attribute_parser);
 			parse_link_item(&tail, new_block, item);
 			break;
 
@@ -2294,7 +3738,7 @@ static struct manual_data *parse_single_level_attribute(struct parse_xml_block *
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 	
-	msg_report(MSG_PARSE_POP, "Single Level Attribute", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Single Level Attribute", parse_element_find_tag(type));
 
 	return new_block;
 }
@@ -2323,7 +3767,7 @@ static bool parse_fetch_single_level_block(struct parse_xml_block *parser, char
 
 	type = parse_xml_get_element(parser);
 
-	msg_report(MSG_PARSE_PUSH, "Single Chunk", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_PUSH, "Single Chunk", parse_element_find_tag(type));
 
 	/* Parse the resources data contents. */
 
@@ -2386,12 +3830,113 @@ static bool parse_fetch_single_level_block(struct parse_xml_block *parser, char
 		}
 	} while (result != PARSE_XML_RESULT_ERROR && result != PARSE_XML_RESULT_EOF && !done);
 
-	msg_report(MSG_PARSE_POP, "Single Chunk", parse_element_find_tag(type));
+	msg_trace(MSG_PARSE_POP, "Single Chunk", parse_element_find_tag(type));
 
 	return (end > 0) ? true : false;
 }
 
 
+/**
+ * Return the current text block from the parser, for storing in a
+ * text chunk. If no line ending conversion is required, the text will
+ * be left in place in the parser's source buffer; otherwise a converted
+ * copy will be allocated from the manual data arena.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \return		Pointer to the text, or NULL on failure.
+ */
+
+static char *parse_get_text(struct parse_xml_block *parser)
+{
+	struct parse_xml_span span;
+	char *text;
+
+	if (!parse_xml_get_text_span(parser, &span))
+		return NULL;
+
+	if (!span.normalise)
+		return parse_xml_claim_text(parser);
+
+	text = manual_data_alloc(span.length + 1);
+	if (text == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	parse_xml_copy_text(parser, text, span.length + 1);
+
+	return text;
+}
+
+
+/**
+ * Return the current text block from the parser, for storing in a
+ * text chunk, with its white space flattened. If no line ending
+ * conversion is required, the text will be flattened in place in the
+ * parser's source buffer; otherwise it will be flattened straight into
+ * a copy allocated from the manual data arena, which leaves nothing
+ * for the line ending conversion to do.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \return		Pointer to the text, or NULL on failure.
+ */
+
+static char *parse_get_flat_text(struct parse_xml_block *parser)
+{
+	struct parse_xml_span span;
+	char *text;
+
+	if (!parse_xml_get_text_span(parser, &span))
+		return NULL;
+
+	if (!span.normalise) {
+		text = parse_xml_claim_text(parser);
+		encoding_flatten_whitespace(text);
+		return text;
+	}
+
+	text = manual_data_alloc(span.length + 1);
+	if (text == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	encoding_flatten_whitespace_copy(text, span.text, span.length);
+
+	return text;
+}
+
+
+/**
+ * Return a copy of the text from an attribute, allocated from the
+ * manual data arena.
+ *
+ * \param *parser	Pointer to the parser to use.
+ * \param *name		The name of the attribute to be copied.
+ * \return		Pointer to the text, or NULL if the attribute
+ *			was not present or on failure.
+ */
+
+static char *parse_get_attribute_text(struct parse_xml_block *parser, const char *name)
+{
+	struct parse_xml_span span;
+	char *text;
+
+	if (!parse_xml_get_attribute_span(parser, name, &span))
+		return NULL;
+
+	text = manual_data_alloc(span.length + 1);
+	if (text == NULL) {
+		msg_report(MSG_DATA_MALLOC_FAIL);
+		return NULL;
+	}
+
+	parse_xml_copy_attribute_text(parser, name, text, span.length + 1);
+
+	return text;
+}
+
+
 /**
  * Link a new manual data block on to the end of a chain.
  * The parent's first child will only be set if previous isn't
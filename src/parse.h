@@ -32,14 +32,138 @@
 
 #include <stdbool.h>
 
+#include "manual.h"
+#include "manual_data.h"
+
+/**
+ * A client which writes a document out while it is being parsed.
+ */
+
+struct parse_stream {
+	/**
+	 * Start the output, once the root manual's own content is ready.
+	 */
+
+	bool	(*start)(struct manual_data *manual);
+
+	/**
+	 * Write out a top-level node of the manual, once it is linked
+	 * and its references have been resolved.
+	 */
+
+	bool	(*write)(struct manual_data *object);
+
+	/**
+	 * End the output, with success set to False if it failed.
+	 */
+
+	bool	(*end)(struct manual_data *manual, bool success);
+};
+
+/**
+ * A document being kept up to date with its source files.
+ */
+
+struct parse_watch;
+
+/**
+ * The possible outcomes of updating a watched document.
+ */
+
+enum parse_watch_result {
+	PARSE_WATCH_UNCHANGED,	/**< None of the document's files have changed.	*/
+	PARSE_WATCH_CHANGED,	/**< The document has been updated.			*/
+	PARSE_WATCH_ERROR	/**< The document could not be updated.			*/
+};
+
+/**
+ * Initialise the parser for a new document.
+ *
+ * \param *root		The folder against which chapter files are found,
+ *			or NULL to use the folder holding the root file.
+ *			This is required if the root file is read from
+ *			stdin, and must remain valid while parsing.
+ */
+
+void parse_initialise(char *root);
+
 /**
  * Parse an XML file and its descendents.
  *
  * \param *filename	The name of the root file to parse.
+ * \param threads	The number of threads to use when parsing chapter
+ *			files, or 1 to parse them in sequence.
  * \return		Pointer to the resulting manual structure.
  */
 
-struct manual *parse_document(char *filename);
+struct manual *parse_document(char *filename, int threads);
+
+/**
+ * Parse an XML file and its descendents, passing each top-level node of
+ * the manual to a stream client in turn as soon as it has been parsed,
+ * linked and had all of its references found. Once written out, the
+ * contents of each chapter file are replaced by an outline, so that
+ * only the chapters still waiting to be written are held in full.
+ *
+ * As when parsing in parallel, any manual-level content in the chapter
+ * files is ignored.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param *stream	The client to write the document out.
+ * \return		Pointer to the resulting manual structure, or NULL
+ *			on failure.
+ */
+
+struct manual *parse_document_stream(char *filename, struct parse_stream *stream);
+
+/**
+ * Parse an XML file and just those of its descendents needed to output a
+ * single selected chapter. Every chapter file has its header read, so
+ * that the titles, numbering and IDs of the chapters are all known, but
+ * only the selected chapter is parsed in full, along with any other
+ * chapter files needed to find the targets of its references.
+ *
+ * \param *filename	The name of the root file to parse.
+ * \param *id		The id of the chapter to be parsed in full.
+ * \return		Pointer to the resulting manual structure, or NULL
+ *			on failure.
+ */
+
+struct manual *parse_document_chapter(char *filename, char *id);
+
+/**
+ * Create a watch on a document, which will keep the document up to date
+ * as its source files change. The document isn't loaded until the first
+ * call to parse_watch_update().
+ *
+ * \param *filename	The name of the root file to parse.
+ * \return		Pointer to the new watch, or NULL on failure.
+ */
+
+struct parse_watch *parse_watch_create(char *filename);
+
+/**
+ * Destroy a document watch, along with its document.
+ *
+ * \param *watch	The watch to destroy.
+ */
+
+void parse_watch_destroy(struct parse_watch *watch);
+
+/**
+ * Check the source files of a watched document, updating the document
+ * if any have changed since they were last parsed. A change to the root
+ * file causes the whole document to be parsed again; otherwise only the
+ * chapters whose files have changed are parsed, before the document is
+ * linked again.
+ *
+ * \param *watch	The watch to update.
+ * \param **document	Pointer to a location to take the current document,
+ *			or NULL if it couldn't be parsed.
+ * \return		The outcome of the update.
+ */
+
+enum parse_watch_result parse_watch_update(struct parse_watch *watch, struct manual **document);
 
 #endif
 
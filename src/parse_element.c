@@ -29,13 +29,14 @@
 
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "parse_element.h"
 
 #include "msg.h"
-#include "search_tree.h"
 
 /**
  * An element definition structure.
@@ -47,10 +48,32 @@ struct parse_element_definition {
 };
 
 /**
- * The lookup tree instance for the elements.
+ * The number of slots in the element hash table. This must be a power
+ * of two, and is chosen to be large enough that a collision-free seed
+ * can be found quickly for the known tags.
  */
 
-static struct search_tree *parse_element_search_tree = NULL;
+#define PARSE_ELEMENT_HASH_SIZE 512
+
+/**
+ * The number of hash seeds to try before giving up on building the
+ * element lookup table.
+ */
+
+#define PARSE_ELEMENT_HASH_ATTEMPTS 100000
+
+/**
+ * The perfect hash table for the elements, mapping each slot to the
+ * element whose tag hashes to it, or to PARSE_ELEMENT_NONE.
+ */
+
+static enum parse_element_type parse_element_hash_table[PARSE_ELEMENT_HASH_SIZE];
+
+/**
+ * The seed for which the element hash table is free of collisions.
+ */
+
+static unsigned int parse_element_hash_seed = 0;
 
 /**
  * The number of entries in the element list.
@@ -126,9 +149,25 @@ static struct parse_element_definition parse_element_tags[] = {
 	{PARSE_ELEMENT_NONE,		"*none*"}
 };
 
+/**
+ * Control for the one-time initialisation of the element lists.
+ */
+
+static pthread_once_t parse_element_lists_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Set to true if the element lists were initialised successfully.
+ */
+
+static bool parse_element_lists_valid = false;
+
 /* Static function prototypes. */
 
+static bool parse_element_check_lists(void);
+static void parse_element_initialise_once(void);
 static bool parse_element_initialise_lists(void);
+static bool parse_element_build_hash(void);
+static unsigned int parse_element_hash(const char *name, unsigned int seed);
 
 /**
  * Given a node containing an element, return the element type.
@@ -139,25 +178,27 @@ static bool parse_element_initialise_lists(void);
 
 enum parse_element_type parse_element_find_type(char *name)
 {
-	struct parse_element_definition *element;
+	enum parse_element_type type;
 
 	if (name == NULL)
 		return PARSE_ELEMENT_NONE;
 
-	/* If the search tree hasn't been initialised, do it now.*/
+	/* If the lookup table hasn't been initialised, do it now.*/
 
-	if (parse_element_search_tree == NULL && !parse_element_initialise_lists())
+	if (!parse_element_check_lists())
 		return PARSE_ELEMENT_NONE;
 
-	/* Find the element definition. */
+	/* Find the element definition. As the hash is perfect over the known
+	 * tags, there is only ever one candidate to compare against.
+	 */
 
-	element = search_tree_find_entry(parse_element_search_tree, name);
-	if (element == NULL) {
+	type = parse_element_hash_table[parse_element_hash(name, parse_element_hash_seed)];
+	if (type == PARSE_ELEMENT_NONE || strcmp(parse_element_tags[type].tag, name) != 0) {
 		msg_report(MSG_UNKNOWN_ELEMENT, name);
 		return PARSE_ELEMENT_NONE;
 	}
 
-	return element->type;
+	return type;
 }
 
 /**
@@ -170,7 +211,7 @@ enum parse_element_type parse_element_find_type(char *name)
 
 const char *parse_element_find_tag(enum parse_element_type type)
 {
-	if (parse_element_max_entries <= 0 && !parse_element_initialise_lists())
+	if (!parse_element_check_lists())
 		return "*error*";
 
 	if (type < 0 || type >= parse_element_max_entries)
@@ -186,7 +227,31 @@ const char *parse_element_find_tag(enum parse_element_type type)
 }
 
 /**
- * Initialise the parse tree and element list.
+ * Ensure that the lookup table and element list have been initialised, doing so
+ * now if required. This is safe to call from multiple threads.
+ *
+ * \return		True if the lists are valid; False on failure.
+ */
+
+static bool parse_element_check_lists(void)
+{
+	pthread_once(&parse_element_lists_once, parse_element_initialise_once);
+
+	return parse_element_lists_valid;
+}
+
+/**
+ * Perform the one-time initialisation of the lookup table and element list, on
+ * behalf of pthread_once().
+ */
+
+static void parse_element_initialise_once(void)
+{
+	parse_element_lists_valid = parse_element_initialise_lists();
+}
+
+/**
+ * Initialise the lookup table and element list.
  * 
  * \return		True if successful; False on failure.
  */
@@ -195,25 +260,14 @@ static bool parse_element_initialise_lists(void)
 {
 	int i;
 
-	if (parse_element_search_tree != NULL || parse_element_max_entries > 0)
-		return false;
-
-	/* Create a new search tree. */
-
-	parse_element_search_tree = search_tree_create();
-	if (parse_element_search_tree == NULL)
+	if (parse_element_max_entries > 0)
 		return false;
 
-	/* Add the element tags to the search tree. */
+	/* Check that the values are in the correct index slots, to allow for
+	 * quick lookups.
+	 */
 
 	for (i = 0; parse_element_tags[i].type != PARSE_ELEMENT_NONE; i++) {
-		if (!search_tree_add_entry(parse_element_search_tree, parse_element_tags[i].tag, &(parse_element_tags[i])))
-			return false;
-
-		/* Check that the values are in the correct index slots, to allow for
-		 * quick lookups.
-		 */
-
 		if (parse_element_tags[i].type != i) {
 			msg_report(MSG_ELEMENT_OUT_OF_SEQ);
 			return false;
@@ -222,5 +276,69 @@ static bool parse_element_initialise_lists(void)
 
 	parse_element_max_entries = i;
 
+	/* Build the hash table for looking tags up. */
+
+	if (!parse_element_build_hash()) {
+		msg_report(MSG_ELEMENT_NO_HASH);
+		return false;
+	}
+
 	return true;
 }
+
+
+/**
+ * Search for a hash seed which maps every known tag to a different slot
+ * in the element hash table, and fill the table in using it.
+ *
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_element_build_hash(void)
+{
+	unsigned int seed, slot;
+	int i;
+	bool collision;
+
+	for (seed = 1; seed <= PARSE_ELEMENT_HASH_ATTEMPTS; seed++) {
+		for (slot = 0; slot < PARSE_ELEMENT_HASH_SIZE; slot++)
+			parse_element_hash_table[slot] = PARSE_ELEMENT_NONE;
+
+		collision = false;
+
+		for (i = 0; !collision && i < parse_element_max_entries; i++) {
+			slot = parse_element_hash(parse_element_tags[i].tag, seed);
+
+			if (parse_element_hash_table[slot] != PARSE_ELEMENT_NONE)
+				collision = true;
+			else
+				parse_element_hash_table[slot] = parse_element_tags[i].type;
+		}
+
+		if (!collision) {
+			parse_element_hash_seed = seed;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * Hash a tag name into a slot in the element hash table.
+ *
+ * \param *name		Pointer to the tag name to hash.
+ * \param seed		The seed to apply to the hash.
+ * \return		The slot in the element hash table.
+ */
+
+static unsigned int parse_element_hash(const char *name, unsigned int seed)
+{
+	uint32_t hash = 2166136261u ^ seed;
+
+	while (*name != '\0')
+		hash = (hash ^ (unsigned char) *name++) * 16777619u;
+
+	return (hash ^ (hash >> 16)) & (PARSE_ELEMENT_HASH_SIZE - 1);
+}
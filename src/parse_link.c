@@ -58,9 +58,31 @@ static int parse_link_table_index = 0;
 
 static int parse_link_code_block_index = 0;
 
+/**
+ * The index count for the top-level nodes, when the document is being
+ * linked one node at a time.
+ */
+
+static int parse_link_root_index = 0;
+
+/**
+ * The last top-level node linked, when the document is being linked
+ * one node at a time.
+ */
+
+static struct manual_data *parse_link_root_previous = NULL;
+
 /* Static Function Prototypes. */
 
 static bool parse_link_node(struct manual_data *node, struct manual_data *parent);
+static enum manual_data_walk_action parse_link_enter_node(struct manual_data_walk_frame *frame, void *data);
+static bool parse_link_single_node(struct manual_data *node, struct manual_data *parent, struct manual_data *previous, int *index);
+static void parse_link_references(struct manual_data *node);
+static void parse_link_node_references(struct manual_data *node, bool children);
+static void parse_link_resource_references(struct manual_data_resources *resources);
+static bool parse_link_references_ready(struct manual_data *node, bool contents);
+static bool parse_link_node_references_ready(struct manual_data *node, bool children, bool contents);
+static bool parse_link_resource_references_ready(struct manual_data_resources *resources, bool contents);
 
 /**
  * Link a node and its children, connecting the previous and parent node
@@ -76,11 +98,129 @@ bool parse_link(struct manual_data *root)
 
 	parse_link_footnote_index = 1;
 
-	return parse_link_node(root, NULL);
+	if (!parse_link_node(root, NULL))
+		return false;
+
+	/* With all of the IDs indexed, the references can be resolved. */
+
+	parse_link_references(root);
+
+	return true;
+}
+
+/**
+ * Start to link a document one top-level node at a time, linking the
+ * root node on its own. The root's children must then be passed in turn
+ * to parse_link_add(), and their references resolved with
+ * parse_link_resolve() once parse_link_ready() shows that all of their
+ * targets are known.
+ *
+ * \param *root		The root node to link from.
+ * \return		True if successful; False on error.
+ */
+
+bool parse_link_start(struct manual_data *root)
+{
+	int index = 0;
+
+	manual_ids_initialise();
+
+	parse_link_footnote_index = 1;
+	parse_link_root_index = 0;
+	parse_link_root_previous = NULL;
+
+	return parse_link_single_node(root, NULL, NULL, &index);
+}
+
+/**
+ * Link one of the children of the root node and its descendents, following
+ * on from those which have been linked already.
+ *
+ * \param *root		The root node, as passed to parse_link_start().
+ * \param *node		The child node to link.
+ * \return		True if successful; False on error.
+ */
+
+bool parse_link_add(struct manual_data *root, struct manual_data *node)
+{
+	bool success;
+
+	if (node == NULL)
+		return false;
+
+	success = parse_link_single_node(node, root, parse_link_root_previous, &parse_link_root_index);
+
+	if (node->first_child != NULL && !parse_link_node(node->first_child, node))
+		success = false;
+
+	if (!success)
+		return false;
+
+	parse_link_root_previous = node;
+
+	return true;
+}
+
+/**
+ * Test whether the references within a node can all be resolved from the
+ * IDs which have been indexed so far. Chapter lists are never ready, as
+ * they depend on the whole of the document.
+ *
+ * \param *node		Pointer to the node to test.
+ * \param children	True to include the node's children; False to test
+ *			only its title and resources.
+ * \return		True if the node's references can be resolved.
+ */
+
+bool parse_link_ready(struct manual_data *node, bool children)
+{
+	if (node == NULL)
+		return true;
+
+	return parse_link_node_references_ready(node, children, false);
+}
+
+/**
+ * Test whether the targets of the references within a node are all
+ * known from the IDs which have been indexed so far. Unlike
+ * parse_link_ready(), chapter lists are taken to be ready, as they only
+ * need the headings of the chapters which they list.
+ *
+ * \param *node		Pointer to the node to test.
+ * \param children	True to include the node's children; False to test
+ *			only its title and resources.
+ * \return		True if the node's reference targets are known.
+ */
+
+bool parse_link_targets_ready(struct manual_data *node, bool children)
+{
+	if (node == NULL)
+		return true;
+
+	return parse_link_node_references_ready(node, children, true);
+}
+
+/**
+ * Resolve the targets of any references within a node, which has already
+ * been linked.
+ *
+ * \param *node		Pointer to the node to resolve.
+ * \param children	True to include the node's children; False to resolve
+ *			only its title and resources.
+ */
+
+void parse_link_resolve(struct manual_data *node, bool children)
+{
+	if (node == NULL)
+		return;
+
+	parse_link_node_references(node, children);
 }
 
 /**
- * Recursively link a node with its siblings and its children.
+ * Link a node with its siblings and its children, walking the tree
+ * without recursion so that deeply nested documents can't exhaust the
+ * stack.
  *
  * \param *node		Pointer to the node to link.
  * \param *parent	Pointer to the node's parent.
@@ -89,76 +229,285 @@ bool parse_link(struct manual_data *root)
 
 static bool parse_link_node(struct manual_data *node, struct manual_data *parent)
 {
-	struct manual_data	*previous = NULL;
-	int			index = 1;
-	bool			success = true;
+	bool success = true;
 
+	manual_data_walk(node, parent, true, 0, parse_link_enter_node, NULL, &success);
 
-	while (node != NULL) {
-		node->previous = previous;
-		node->parent = parent;
-
-		/* Index the node ID, if applicable. */
-
-		switch (node->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_INDEX:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-		case MANUAL_DATA_OBJECT_TYPE_TABLE:
-		case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
-		case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
-			if (node->chapter.id != NULL && !manual_ids_add_node(node))
-				success = false;
-			break;
-		default:
-			break;
-		}
-
-		/* Reset the per-chapter index numbers. */
-
-		if (node->type == MANUAL_DATA_OBJECT_TYPE_CHAPTER) {
-			parse_link_code_block_index = 1;
-			parse_link_table_index = 1;
-		}
-
-		/* Number the node, if appropriate. */
-
-		switch (node->type) {
-		case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
-		case MANUAL_DATA_OBJECT_TYPE_SECTION:
-			if (node->title != NULL)
-				node->index = index++;
-			break;
-
-		case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
-			if (node->title != NULL)
-				node->index = parse_link_code_block_index++;
-			break;
-
-		case MANUAL_DATA_OBJECT_TYPE_TABLE:
-			if (node->title != NULL)
-				node->index = parse_link_table_index++;
-			break;
-
-		case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
-			node->index = parse_link_footnote_index++;
-			break;
-
-		default:
-			break;
-		}
-
-		/* Process any child nodes. */
-
-		if (node->first_child != NULL && !parse_link_node(node->first_child, node))
+	return success;
+}
+
+/**
+ * Link a node as it is entered during a tree walk. Any failure is
+ * recorded, but the walk continues so that all of the problems in the
+ * document get reported.
+ *
+ * \param *frame	The walk frame for the node.
+ * \param *data		Pointer to the linking success flag.
+ * \return		The action for the walk to take.
+ */
+
+static enum manual_data_walk_action parse_link_enter_node(struct manual_data_walk_frame *frame, void *data)
+{
+	bool *success = data;
+
+	if (!parse_link_single_node(frame->node, frame->parent, frame->previous, &frame->count))
+		*success = false;
+
+	return MANUAL_DATA_WALK_DESCEND;
+}
+
+/**
+ * Link a node, without its children.
+ *
+ * \param *node		Pointer to the node to link.
+ * \param *parent	Pointer to the node's parent.
+ * \param *previous	Pointer to the node's previous sibling.
+ * \param *index	Pointer to the count of numbered siblings before
+ *			the node, which is updated.
+ * \return		True if successful; False on failure.
+ */
+
+static bool parse_link_single_node(struct manual_data *node, struct manual_data *parent, struct manual_data *previous, int *index)
+{
+	bool success = true;
+
+	node->previous = previous;
+	node->parent = parent;
+
+	/* Index the node ID, if applicable. */
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		if (node->chapter.id != NULL && !manual_ids_add_node(node))
 			success = false;
+		break;
+	default:
+		break;
+	}
 
-		/* Move on to the next sibling. */
+	/* Reset the per-chapter index numbers. */
 
-		previous = node;
-		node = node->next;
+	if (node->type == MANUAL_DATA_OBJECT_TYPE_CHAPTER) {
+		parse_link_code_block_index = 1;
+		parse_link_table_index = 1;
+	}
+
+	/* Number the node, if appropriate. */
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		if (node->title != NULL)
+			node->index = ++(*index);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CODE_BLOCK:
+		if (node->title != NULL)
+			node->index = parse_link_code_block_index++;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		if (node->title != NULL)
+			node->index = parse_link_table_index++;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_FOOTNOTE:
+		node->index = parse_link_footnote_index++;
+		break;
+
+	default:
+		break;
 	}
 
+	/* Record the node's file owners and number, now that its
+	 * parents have been linked and numbered.
+	 */
+
+	if (!manual_data_annotate_node(node))
+		success = false;
+
 	return success;
 }
 
+/**
+ * Recursively resolve the targets of any references within a node, its
+ * siblings and their children, storing the target in each reference.
+ * Any references which can't be resolved are reported here, so that
+ * the output engines only have to follow the stored pointers.
+ *
+ * \param *node		Pointer to the first node to resolve.
+ */
+
+static void parse_link_references(struct manual_data *node)
+{
+	while (node != NULL) {
+		parse_link_node_references(node, true);
+
+		node = node->next;
+	}
+}
+
+/**
+ * Resolve the targets of any references within a node and, optionally,
+ * its children.
+ *
+ * \param *node		Pointer to the node to resolve.
+ * \param children	True to resolve the node's children as well.
+ */
+
+static void parse_link_node_references(struct manual_data *node, bool children)
+{
+	parse_link_references(node->title);
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		node->chunk.target = manual_ids_find_node(node);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		parse_link_references(node->chunk.link);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		parse_link_references(node->chapter.columns);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		if (node->processed)
+			parse_link_resource_references(node->chapter.resources);
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		parse_link_resource_references(node->chapter.resources);
+		break;
+
+	default:
+		break;
+	}
+
+	if (children)
+		parse_link_references(node->first_child);
+}
+
+/**
+ * Resolve the targets of any references within the text held in
+ * a resources block.
+ *
+ * \param *resources	Pointer to the resources block, or NULL.
+ */
+
+static void parse_link_resource_references(struct manual_data_resources *resources)
+{
+	if (resources == NULL)
+		return;
+
+	parse_link_references(resources->summary);
+	parse_link_references(resources->strapline);
+	parse_link_references(resources->credit);
+	parse_link_references(resources->version);
+	parse_link_references(resources->date);
+}
+
+/**
+ * Recursively test whether the references within a node, its siblings
+ * and their children can all be resolved.
+ *
+ * \param *node		Pointer to the first node to test.
+ * \param contents	True if chapter lists are to be treated as ready.
+ * \return		True if the references can all be resolved.
+ */
+
+static bool parse_link_references_ready(struct manual_data *node, bool contents)
+{
+	while (node != NULL) {
+		if (!parse_link_node_references_ready(node, true, contents))
+			return false;
+
+		node = node->next;
+	}
+
+	return true;
+}
+
+/**
+ * Test whether the references within a node and, optionally, its
+ * children can all be resolved.
+ *
+ * \param *node		Pointer to the node to test.
+ * \param children	True to test the node's children as well.
+ * \param contents	True if chapter lists are to be treated as ready.
+ * \return		True if the references can all be resolved.
+ */
+
+static bool parse_link_node_references_ready(struct manual_data *node, bool children, bool contents)
+{
+	if (!parse_link_references_ready(node->title, contents))
+		return false;
+
+	switch (node->type) {
+	case MANUAL_DATA_OBJECT_TYPE_REFERENCE:
+		if (node->chunk.id != NULL && manual_ids_peek_node(node) == NULL)
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CONTENTS:
+		if (!contents)
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_LINK:
+		if (!parse_link_references_ready(node->chunk.link, contents))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_TABLE:
+		if (!parse_link_references_ready(node->chapter.columns, contents))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_CHAPTER:
+	case MANUAL_DATA_OBJECT_TYPE_INDEX:
+		if (node->processed && !parse_link_resource_references_ready(node->chapter.resources, contents))
+			return false;
+		break;
+
+	case MANUAL_DATA_OBJECT_TYPE_MANUAL:
+	case MANUAL_DATA_OBJECT_TYPE_SECTION:
+		if (!parse_link_resource_references_ready(node->chapter.resources, contents))
+			return false;
+		break;
+
+	default:
+		break;
+	}
+
+	return (children) ? parse_link_references_ready(node->first_child, contents) : true;
+}
+
+/**
+ * Test whether the references within the text held in a resources block
+ * can all be resolved.
+ *
+ * \param *resources	Pointer to the resources block, or NULL.
+ * \param contents	True if chapter lists are to be treated as ready.
+ * \return		True if the references can all be resolved.
+ */
+
+static bool parse_link_resource_references_ready(struct manual_data_resources *resources, bool contents)
+{
+	if (resources == NULL)
+		return true;
+
+	return parse_link_references_ready(resources->summary, contents) &&
+			parse_link_references_ready(resources->strapline, contents) &&
+			parse_link_references_ready(resources->credit, contents) &&
+			parse_link_references_ready(resources->version, contents) &&
+			parse_link_references_ready(resources->date, contents);
+}
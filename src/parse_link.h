@@ -45,5 +45,67 @@
 
 bool parse_link(struct manual_data *root);
 
+/**
+ * Start to link a document one top-level node at a time, linking the
+ * root node on its own. The root's children must then be passed in turn
+ * to parse_link_add(), and their references resolved with
+ * parse_link_resolve() once parse_link_ready() shows that all of their
+ * targets are known.
+ *
+ * \param *root		The root node to link from.
+ * \return		True if successful; False on error.
+ */
+
+bool parse_link_start(struct manual_data *root);
+
+/**
+ * Link one of the children of the root node and its descendents, following
+ * on from those which have been linked already.
+ *
+ * \param *root		The root node, as passed to parse_link_start().
+ * \param *node		The child node to link.
+ * \return		True if successful; False on error.
+ */
+
+bool parse_link_add(struct manual_data *root, struct manual_data *node);
+
+/**
+ * Test whether the references within a node can all be resolved from the
+ * IDs which have been indexed so far. Chapter lists are never ready, as
+ * they depend on the whole of the document.
+ *
+ * \param *node		Pointer to the node to test.
+ * \param children	True to include the node's children; False to test
+ *			only its title and resources.
+ * \return		True if the node's references can be resolved.
+ */
+
+bool parse_link_ready(struct manual_data *node, bool children);
+
+/**
+ * Test whether the targets of the references within a node are all
+ * known from the IDs which have been indexed so far. Unlike
+ * parse_link_ready(), chapter lists are taken to be ready, as they only
+ * need the headings of the chapters which they list.
+ *
+ * \param *node		Pointer to the node to test.
+ * \param children	True to include the node's children; False to test
+ *			only its title and resources.
+ * \return		True if the node's reference targets are known.
+ */
+
+bool parse_link_targets_ready(struct manual_data *node, bool children);
+
+/**
+ * Resolve the targets of any references within a node, which has already
+ * been linked.
+ *
+ * \param *node		Pointer to the node to resolve.
+ * \param children	True to include the node's children; False to resolve
+ *			only its title and resources.
+ */
+
+void parse_link_resolve(struct manual_data *node, bool children);
+
 #endif
 
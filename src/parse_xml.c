@@ -32,12 +32,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "filename.h"
+#include "manual_cache.h"
+#include "manual_data.h"
 #include "manual_entity.h"
 #include "msg.h"
 #include "parse_element.h"
 #include "parse_xml.h"
+#include "stats.h"
+#include "string.h"
 
 /**
  * The maximum tag or entity name length. */
@@ -45,10 +51,11 @@
 #define PARSE_XML_MAX_NAME_LEN 64
 
 /**
- * The maximum number of attributes allowed in a tag.
+ * The number of attributes held within each parser instance. Tags with
+ * more attributes than this spill over into allocated storage.
  */
 
-#define PARSE_XML_MAX_ATTRIBUTES 10
+#define PARSE_XML_INLINE_ATTRIBUTES 8
 
 /**
  * The maximum length of an attribute value which we process
@@ -57,15 +64,24 @@
 
 #define PARSE_XML_MAX_ATTRIBUTE_VAL_LEN 64
 
+/**
+ * The size of the blocks in which source files are read into memory.
+ */
+
+#define PARSE_XML_LOAD_BLOCK_SIZE 8192
+
 /**
  * Structure to hold details of an attribute.
  */
 
 struct parse_xml_attribute {
-	char name[PARSE_XML_MAX_NAME_LEN];
-	long start;
-	long length;
-	struct parse_xml_block *parser;
+	uint64_t		hash;		/**< The hash of the attribute name.				*/
+	int64_t			name_start;	/**< The offset of the attribute name in the buffer.		*/
+	size_t			name_length;	/**< The length of the attribute name.				*/
+	int64_t			start;		/**< The offset of the value in the buffer, or -1 for none.	*/
+	int64_t			length;		/**< The length of the value.					*/
+	int			quote;		/**< The quote character which terminates the value.		*/
+	struct parse_xml_block	*parser;	/**< A parser for the value, or NULL if not yet required.	*/
 };
 
 /**
@@ -74,25 +90,69 @@ struct parse_xml_attribute {
 
 struct parse_xml_block {
 	/**
-	 * The handle of the file, or NULL.
+	 * Pointer to the in-memory copy of the file, or NULL. This is shared
+	 * between an instance and its attribute parsers, and is owned by the
+	 * instance which opened the file.
+	 */
+	char *buffer;
+
+	/**
+	 * The number of bytes of file data held in the buffer.
+	 */
+	int64_t buffer_length;
+
+	/**
+	 * The number of bytes allocated to the buffer, when the file is
+	 * being read incrementally.
+	 */
+	int64_t buffer_size;
+
+	/**
+	 * The file being read incrementally into the buffer, or NULL if
+	 * the whole file has been read.
 	 */
 	FILE *file;
 
+	/**
+	 * Pointer to the instance which owns the buffer, or NULL if this
+	 * instance is the owner.
+	 */
+	struct parse_xml_block *owner;
+
+	/**
+	 * True if text has been claimed in place from the buffer, meaning
+	 * that it has been handed over to the manual data arena and must
+	 * not be freed when the file is closed.
+	 */
+	bool buffer_retained;
+
+	/**
+	 * The offset of a character in the buffer which has been overwritten
+	 * to terminate a claimed text block, or -1 for none.
+	 */
+	int64_t terminator_position;
+
+	/**
+	 * The original value of the overwritten terminator character.
+	 */
+	int terminator_char;
+
 	/**
 	 * The current parser mode.
 	 */
 	enum parse_xml_result current_mode;
 
 	/**
-	 * The current file pointer.
+	 * The current file pointer, as an offset into the buffer.
 	 */
-	long file_pointer;
+	int64_t file_pointer;
 
 	/**
 	 * The file pointer for the most recent line count, to avoid double
-	 * counting new lines.
+	 * counting new lines. Lines are only counted when a message needs
+	 * to report them.
 	 */
-	long line_count_file_pointer;
+	int64_t line_count_file_pointer;
 
 	/**
 	 * The end of file character for the instance.
@@ -100,7 +160,7 @@ struct parse_xml_block {
 	int eof;
 
 	/**
-	 * A count of the lines processed.
+	 * A count of the lines processed, up to line_count_file_pointer.
 	 */
 	int line_count;
 
@@ -109,32 +169,67 @@ struct parse_xml_block {
 	 */
 	char object_name[PARSE_XML_MAX_NAME_LEN];
 
+	/**
+	 * The element decoded from the current element name, or
+	 * PARSE_ELEMENT_NONE if it has not been successfully looked up.
+	 */
+	enum parse_element_type object_element;
+
 	/**
 	 * File pointer to the start of the current text block.
 	 */
-	long text_block_start;
+	int64_t text_block_start;
 
 	/**
 	 * Size of the current text block.
 	 */
 	size_t text_block_length;
 
+	/**
+	 * True if the current text block contains line endings which need
+	 * to be normalised.
+	 */
+	bool text_block_normalise;
+
 	/**
 	 * The number of attributes in the current element.
 	 */
 	int attribute_count;
 
 	/**
-	 * The attributes for the current element.
+	 * The number of attribute slots available in the attributes array.
+	 */
+	int attribute_capacity;
+
+	/**
+	 * A count of the chunks parsed, for the build statistics.
+	 */
+	size_t chunk_count;
+
+	/**
+	 * The attributes for the current element. This points to the inline
+	 * store, unless the attributes have spilled over into allocated
+	 * storage.
+	 */
+	struct parse_xml_attribute *attributes;
+
+	/**
+	 * Inline storage for the attributes of the current element.
 	 */
-	struct parse_xml_attribute attributes[PARSE_XML_MAX_ATTRIBUTES];
+	struct parse_xml_attribute attribute_store[PARSE_XML_INLINE_ATTRIBUTES];
 };
 
 /* Static Function Prototypes. */
 
 static struct parse_xml_block *parse_xml_initialise(void);
+static char *parse_xml_load_file(FILE *file, int64_t *length);
+static char *parse_xml_start_file(FILE *file, int64_t *length, int64_t *size);
+static bool parse_xml_load_block(struct parse_xml_block *instance);
 static struct parse_xml_attribute *parse_xml_find_attribute(struct parse_xml_block *instance, const char *name);
-static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, long start, size_t length, char *buffer, size_t size);
+static struct parse_xml_attribute *parse_xml_claim_attribute(struct parse_xml_block *instance);
+static void parse_xml_free_attributes(struct parse_xml_block *instance);
+static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, int64_t start, size_t length, char *buffer, size_t size);
+static int parse_xml_peek(struct parse_xml_block *instance, int64_t position);
 static void parse_xml_read_text(struct parse_xml_block *instance, int c);
 static void parse_xml_read_markup(struct parse_xml_block *instance, int c);
 static void parse_xml_read_comment(struct parse_xml_block *instance);
@@ -143,6 +238,7 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 static void parse_xml_read_entity(struct parse_xml_block *instance, int c);
 static bool parse_xml_match_ahead(struct parse_xml_block *instance, const char *text);
 static int parse_xml_getc(struct parse_xml_block *instance);
+static unsigned parse_xml_find_line(void *data);
 
 /* Type tests. */
 
@@ -157,6 +253,7 @@ static int parse_xml_getc(struct parse_xml_block *instance);
 static struct parse_xml_block *parse_xml_initialise(void)
 {
 	struct parse_xml_block *new = NULL;
+	int i;
 
 	new = malloc(sizeof(struct parse_xml_block));
 	if (new == NULL)
@@ -168,27 +265,46 @@ static struct parse_xml_block *parse_xml_initialise(void)
 	new->line_count_file_pointer = 0;
 	new->eof = EOF;
 	new->line_count = 1;
+	new->object_element = PARSE_ELEMENT_NONE;
 
 	new->text_block_start = 0;
 	new->text_block_length = 0;
+	new->text_block_normalise = false;
 
 	new->attribute_count = 0;
+	new->attribute_capacity = PARSE_XML_INLINE_ATTRIBUTES;
+	new->attributes = new->attribute_store;
+
+	for (i = 0; i < PARSE_XML_INLINE_ATTRIBUTES; i++)
+		new->attribute_store[i].parser = NULL;
+
+	new->chunk_count = 0;
+	new->buffer = NULL;
+	new->buffer_length = 0;
+	new->buffer_size = 0;
 	new->file = NULL;
+	new->owner = NULL;
+	new->buffer_retained = false;
+	new->terminator_position = -1;
+	new->terminator_char = '\0';
 
 	return new;
 }
 
 /**
- * Open a new file in the XML parser.
+ * Open a new file in the XML parser. A filename of FILENAME_STDIO reads
+ * the document from stdin.
  *
  * \param *filename	The name of the file to open.
+ * \param incremental	True to read the file only as far as it is parsed;
+ *			False to read it all up front.
  * \return		Pointer to the new instance, or NULL on failure.
  */
 
-struct parse_xml_block *parse_xml_open_file(char *filename)
+struct parse_xml_block *parse_xml_open_file(char *filename, bool incremental)
 {
-	struct parse_xml_block *instance = NULL, *parser = NULL;
-	int i;
+	struct parse_xml_block *instance = NULL;
+	FILE *file;
 
 	msg_set_location(NULL);
 
@@ -196,26 +312,45 @@ struct parse_xml_block *parse_xml_open_file(char *filename)
 	if (instance == NULL)
 		return NULL;
 
-	/* Open the file. */
+	/* Open the file and read its contents into memory. */
 
-	instance->file = fopen(filename, "rb");
-	if (instance->file == NULL) {
+	file = (strcmp(filename, FILENAME_STDIO) == 0) ? stdin : fopen(filename, "rb");
+	if (file == NULL) {
 		free(instance);
 		return NULL;
 	}
 
-	msg_set_location(filename);
+	/* A file being read incrementally stays open, with a buffer large
+	 * enough for the whole file so that text claimed from it never
+	 * moves. The source cache needs the whole file, and so it only
+	 * records files which are read up front.
+	 */
 
-	/* Create parsers for the attributes. */
+	if (incremental && file != stdin)
+		instance->buffer = parse_xml_start_file(file, &(instance->buffer_length), &(instance->buffer_size));
 
-	for (i = 0; i < PARSE_XML_MAX_ATTRIBUTES; i++) {
-		parser = parse_xml_initialise();
-		if (parser != NULL) {
-			parser->file = instance->file;
-		}
-		instance->attributes[i].parser = parser;
+	if (instance->buffer != NULL) {
+		instance->file = file;
+	} else {
+		instance->buffer = parse_xml_load_file(file, &(instance->buffer_length));
+
+		if (file != stdin)
+			fclose(file);
+	}
+
+	if (instance->buffer == NULL) {
+		free(instance);
+		return NULL;
 	}
 
+	msg_set_location(filename);
+	msg_set_line_source(parse_xml_find_line, instance);
+
+	stats_count(STATS_COUNTER_BYTES_READ, instance->buffer_length);
+
+	if (instance->file == NULL)
+		manual_cache_add_source(filename, instance->buffer, instance->buffer_length);
+
 	instance->current_mode = PARSE_XML_RESULT_START;
 
 	return instance;
@@ -231,27 +366,183 @@ struct parse_xml_block *parse_xml_open_file(char *filename)
 
 void parse_xml_close_file(struct parse_xml_block *instance)
 {
-	int i;
-
 	if (instance == NULL)
 		return;
-	
-	/* Close the file. */
+
+	/* Leave the final line in place for any later messages. */
+
+	if (instance->owner == NULL) {
+		msg_set_line(parse_xml_find_line(instance));
+		msg_set_line_source(NULL, NULL);
+	}
+
+	/* Free the file contents, unless text has been claimed from them. */
+
+	if (instance->buffer != NULL && !instance->buffer_retained)
+		free(instance->buffer);
+
+	/* Close the file if it was still being read incrementally. */
 
 	if (instance->file != NULL)
 		fclose(instance->file);
 
 	/* Free the attribute parser instances. */
 
-	for (i = 0; i < PARSE_XML_MAX_ATTRIBUTES; i++) {
-		if (instance->attributes[i].parser != NULL)
-			free(instance->attributes[i].parser);
-	}
+	parse_xml_free_attributes(instance);
+
+	stats_count(STATS_COUNTER_CHUNKS, instance->chunk_count);
 
 	free(instance);
 }
 
 
+/**
+ * Read the whole of an open file into a block of memory. The data is
+ * read in blocks, so this will work for streams whose size can not be
+ * found in advance.
+ *
+ * \param *file		The handle of the file to be read.
+ * \param *length	Pointer to a variable to take the length of
+ *			the data read.
+ * \return		Pointer to the file data, or NULL on failure.
+ */
+
+static char *parse_xml_load_file(FILE *file, int64_t *length)
+{
+	char *buffer = NULL, *extended;
+	size_t size = 0, used = 0, bytes;
+
+	if (file == NULL || length == NULL)
+		return NULL;
+
+	*length = 0;
+
+	do {
+		/* Grow the buffer if it's full, leaving space for a terminator. */
+
+		if (size - used <= 1) {
+			if (size > SIZE_MAX / 2) {
+				free(buffer);
+				return NULL;
+			}
+
+			size = (size == 0) ? PARSE_XML_LOAD_BLOCK_SIZE : size * 2;
+
+			extended = realloc(buffer, size);
+			if (extended == NULL) {
+				free(buffer);
+				return NULL;
+			}
+
+			buffer = extended;
+		}
+
+		bytes = fread(buffer + used, 1, size - used - 1, file);
+		used += bytes;
+	} while (bytes > 0);
+
+	if (ferror(file)) {
+		free(buffer);
+		return NULL;
+	}
+
+	buffer[used] = '\0';
+	*length = used;
+
+	return buffer;
+}
+
+
+/**
+ * Start to read an open file into a block of memory, allocating enough
+ * space for the whole file but only reading its first block. The rest
+ * can be read as required using parse_xml_load_block().
+ *
+ * \param *file		The handle of the file to be read.
+ * \param *length	Pointer to a variable to take the length of
+ *			the data read.
+ * \param *size		Pointer to a variable to take the size of the
+ *			memory allocated.
+ * \return		Pointer to the file data, or NULL on failure or if
+ *			the size of the file can not be found.
+ */
+
+static char *parse_xml_start_file(FILE *file, int64_t *length, int64_t *size)
+{
+	char *buffer;
+	long extent;
+	size_t bytes;
+
+	if (file == NULL || length == NULL || size == NULL)
+		return NULL;
+
+	*length = 0;
+	*size = 0;
+
+	if (fseek(file, 0, SEEK_END) != 0 || (extent = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0 ||
+			(unsigned long) extent >= SIZE_MAX)
+		return NULL;
+
+	buffer = malloc((size_t) extent + 1);
+	if (buffer == NULL)
+		return NULL;
+
+	bytes = fread(buffer, 1, ((size_t) extent < PARSE_XML_LOAD_BLOCK_SIZE) ? (size_t) extent : PARSE_XML_LOAD_BLOCK_SIZE, file);
+
+	if (ferror(file)) {
+		free(buffer);
+		return NULL;
+	}
+
+	buffer[bytes] = '\0';
+	*length = bytes;
+	*size = (int64_t) extent + 1;
+
+	return buffer;
+}
+
+
+/**
+ * Read the next block of a file being read incrementally into its buffer,
+ * closing the file once the end is reached. Any attribute parser sharing
+ * the buffer sees the new data as well.
+ *
+ * \param *instance	Pointer to the instance needing more data.
+ * \return		True if more data was read; False if there is
+ *			no more to read.
+ */
+
+static bool parse_xml_load_block(struct parse_xml_block *instance)
+{
+	struct parse_xml_block *owner;
+	size_t bytes = 0, space;
+
+	owner = (instance->owner != NULL) ? instance->owner : instance;
+
+	if (owner->file == NULL)
+		return false;
+
+	space = (size_t) (owner->buffer_size - owner->buffer_length - 1);
+
+	if (space > 0)
+		bytes = fread(owner->buffer + owner->buffer_length, 1, (space < PARSE_XML_LOAD_BLOCK_SIZE) ? space : PARSE_XML_LOAD_BLOCK_SIZE, owner->file);
+
+	if (bytes == 0) {
+		fclose(owner->file);
+		owner->file = NULL;
+		return false;
+	}
+
+	owner->buffer_length += bytes;
+	owner->buffer[owner->buffer_length] = '\0';
+	instance->buffer_length = owner->buffer_length;
+
+	stats_count(STATS_COUNTER_BYTES_READ, bytes);
+
+	return true;
+}
+
+
 /**
  * Set the parser state to error.
  *
@@ -264,7 +555,7 @@ enum parse_xml_result parse_xml_set_error(struct parse_xml_block *instance)
 	if (instance != NULL)
 		instance->current_mode = PARSE_XML_RESULT_ERROR;
 
-	msg_report(MSG_PARSER_SET_ERROR);
+	msg_trace(MSG_PARSER_SET_ERROR);
 
 	return PARSE_XML_RESULT_ERROR;
 }
@@ -288,17 +579,13 @@ enum parse_xml_result parse_xml_read_next_chunk(struct parse_xml_block *instance
 
 	instance->current_mode = PARSE_XML_RESULT_ERROR;
 	instance->attribute_count = 0;
+	instance->chunk_count++;
 
-	/* Exit on error or EOF. */
+	/* Exit on error. */
 
-	if (instance->file == NULL)
+	if (instance->buffer == NULL)
 		return PARSE_XML_RESULT_ERROR;
 
-	fseek(instance->file, instance->file_pointer, SEEK_SET);
-
-	if (feof(instance->file))
-		return PARSE_XML_RESULT_EOF;
-
 	/* Decide what to do based on the next character in the file. */
 
 	c = parse_xml_getc(instance);
@@ -321,8 +608,6 @@ enum parse_xml_result parse_xml_read_next_chunk(struct parse_xml_block *instance
 		}
 	}
 
-	instance->file_pointer = ftell(instance->file);
-
 	return instance->current_mode;
 }
 
@@ -339,7 +624,7 @@ char *parse_xml_get_text(struct parse_xml_block *instance)
 {
 	char *text;
 
-	if (instance == NULL || instance->file == NULL)
+	if (instance == NULL || instance->buffer == NULL)
 		return NULL;
 
 	if (instance->current_mode != PARSE_XML_RESULT_TEXT &&
@@ -357,6 +642,102 @@ char *parse_xml_get_text(struct parse_xml_block *instance)
 }
 
 
+/**
+ * Return a pointer to the current text block parsed from the file,
+ * returning it in place within the source buffer if no line ending
+ * conversion is required or a copy if it is.
+ *
+ * Either way, the text may be modified by the caller but must not be
+ * freed; claiming text in place hands the source buffer over to the
+ * manual data arena, so that it remains after the file is closed.
+ *
+ * \param *instance		Pointer to the instance to be used.
+ * \return			Pointer to the block, or NULL.
+ */
+
+char *parse_xml_claim_text(struct parse_xml_block *instance)
+{
+	struct parse_xml_block *owner;
+	struct parse_xml_span span;
+	int64_t end;
+
+	if (!parse_xml_get_text_span(instance, &span))
+		return NULL;
+
+	if (span.normalise)
+		return parse_xml_get_text(instance);
+
+	/* The caller may rewrite the text in place, so count any lines in
+	 * it while the newlines are still in the buffer.
+	 */
+
+	parse_xml_find_line(instance);
+
+	/* Terminate the block in the buffer. If the terminating character
+	 * isn't the one beyond the end of the file, remember what it was so
+	 * that the parser can still read it when it moves on.
+	 */
+
+	end = instance->text_block_start + instance->text_block_length;
+
+	if (end < instance->buffer_length) {
+		instance->terminator_char = parse_xml_peek(instance, end);
+		instance->terminator_position = end;
+		instance->buffer[end] = '\0';
+	}
+
+	/* Hand the buffer over to the manual data arena the first time that
+	 * text is claimed from it, so that it's freed along with the data
+	 * which points into it. Without an arena, the data is never freed
+	 * and so neither is the buffer.
+	 */
+
+	owner = (instance->owner != NULL) ? instance->owner : instance;
+
+	if (!owner->buffer_retained) {
+		manual_data_adopt(owner->buffer);
+		owner->buffer_retained = true;
+	}
+
+	return span.text;
+}
+
+
+/**
+ * Return details of the current text block parsed from the file, as
+ * a span within the source buffer. The text will not be terminated, and
+ * if the normalise flag is set, the line endings will not have been
+ * converted.
+ *
+ * \param *instance		Pointer to the instance to be used.
+ * \param *span			Pointer to a span to take the details.
+ * \return			True if successful; else false.
+ */
+
+bool parse_xml_get_text_span(struct parse_xml_block *instance, struct parse_xml_span *span)
+{
+	if (span == NULL)
+		return false;
+
+	span->text = NULL;
+	span->length = 0;
+	span->normalise = false;
+
+	if (instance == NULL || instance->buffer == NULL)
+		return false;
+
+	if (instance->current_mode != PARSE_XML_RESULT_TEXT &&
+			instance->current_mode != PARSE_XML_RESULT_WHITESPACE)
+		return false;
+
+	span->text = instance->buffer + instance->text_block_start;
+	span->length = instance->text_block_length;
+	span->normalise = instance->text_block_normalise;
+
+	return true;
+}
+
+
 /**
  * Copy the current text block parsed from the file into a buffer
  * 
@@ -375,7 +756,7 @@ size_t parse_xml_copy_text(struct parse_xml_block *instance, char *buffer, size_
 
 	buffer[0] = '\0';
 
-	if (instance == NULL || instance->file == NULL)
+	if (instance == NULL || instance->buffer == NULL)
 		return 0;
 
 	if (instance->current_mode != PARSE_XML_RESULT_TEXT &&
@@ -404,7 +785,15 @@ enum parse_element_type parse_xml_get_element(struct parse_xml_block *instance)
 			instance->current_mode != PARSE_XML_RESULT_TAG_END)
 		return PARSE_ELEMENT_NONE;
 
-	return parse_element_find_type(instance->object_name);
+	/* The handlers query the element repeatedly for each tag, so cache
+	 * the result. Unknown elements are looked up afresh each time, so
+	 * that each query reports them as before.
+	 */
+
+	if (instance->object_element == PARSE_ELEMENT_NONE)
+		instance->object_element = parse_element_find_type(instance->object_name);
+
+	return instance->object_element;
 }
 
 
@@ -419,11 +808,32 @@ enum parse_element_type parse_xml_get_element(struct parse_xml_block *instance)
 struct parse_xml_block *parse_xml_get_attribute_parser(struct parse_xml_block *instance, const char *name)
 {
 	struct parse_xml_attribute *attribute;
+	struct parse_xml_block *parser;
 
 	attribute = parse_xml_find_attribute(instance, name);
 	if (attribute == NULL)
 		return NULL;
 
+	/* Parsers are only created for attributes which need them; once
+	 * created, they are reset for each new tag which uses their slot.
+	 */
+
+	if (attribute->parser == NULL) {
+		parser = parse_xml_initialise();
+		if (parser == NULL)
+			return NULL;
+
+		parser->buffer = instance->buffer;
+		parser->buffer_length = instance->buffer_length;
+		parser->owner = (instance->owner != NULL) ? instance->owner : instance;
+
+		parser->current_mode = PARSE_XML_RESULT_START;
+		parser->file_pointer = attribute->start;
+		parser->eof = attribute->quote;
+
+		attribute->parser = parser;
+	}
+
 	return attribute->parser;
 }
 
@@ -442,7 +852,7 @@ char *parse_xml_get_attribute_text(struct parse_xml_block *instance, const char
 	struct parse_xml_attribute *attribute;
 	char *text;
 
-	if (instance == NULL || instance->file == NULL)
+	if (instance == NULL || instance->buffer == NULL)
 		return NULL;
 
 	attribute = parse_xml_find_attribute(instance, name);
@@ -461,6 +871,51 @@ char *parse_xml_get_attribute_text(struct parse_xml_block *instance, const char
 }
 
 
+/**
+ * Return details of the text from an attribute, as a span within
+ * the source buffer, without considering the validity of any of the
+ * characters within. The text will not be terminated, and if the
+ * normalise flag is set, the line endings will not have been converted.
+ *
+ * \param *instance	Pointer to the instance to be used.
+ * \param *name		The name of the attribute to be matched.
+ * \param *span		Pointer to a span to take the details.
+ * \return		True if successful; else false.
+ */
+
+bool parse_xml_get_attribute_span(struct parse_xml_block *instance, const char *name, struct parse_xml_span *span)
+{
+	struct parse_xml_attribute *attribute;
+
+	if (span == NULL)
+		return false;
+
+	span->text = NULL;
+	span->length = 0;
+	span->normalise = false;
+
+	if (instance == NULL || instance->buffer == NULL)
+		return false;
+
+	attribute = parse_xml_find_attribute(instance, name);
+	if (attribute == NULL)
+		return false;
+
+	/* An attribute without a value has an empty span. */
+
+	if (attribute->start < 0) {
+		span->text = instance->buffer;
+		return true;
+	}
+
+	span->text = instance->buffer + attribute->start;
+	span->length = attribute->length;
+	span->normalise = (memchr(span->text, '\r', span->length) != NULL) ? true : false;
+
+	return true;
+}
+
+
 /**
  * Copy the text from an attribute into a buffer, without
  * considering the validity of any characters within.
@@ -483,7 +938,7 @@ size_t parse_xml_copy_attribute_text(struct parse_xml_block *instance, const cha
 
 	buffer[0] = '\0';
 
-	if (instance == NULL || instance->file == NULL)
+	if (instance == NULL || instance->buffer == NULL)
 		return 0;
 
 	attribute = parse_xml_find_attribute(instance, name);
@@ -510,7 +965,7 @@ bool parse_xml_test_boolean_attribute(struct parse_xml_block *instance, const ch
 	struct parse_xml_attribute *attribute;
 	char buffer[PARSE_XML_MAX_ATTRIBUTE_VAL_LEN];
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return false;
@@ -527,7 +982,7 @@ bool parse_xml_test_boolean_attribute(struct parse_xml_block *instance, const ch
 	else if (strcmp(buffer, value_false) == 0)
 		return false;
 
-	msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, attribute->name);
+	msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, name);
 	instance->current_mode = PARSE_XML_RESULT_ERROR;
 
 	return false;
@@ -555,7 +1010,7 @@ int parse_xml_read_integer_attribute(struct parse_xml_block *instance, const cha
 	struct parse_xml_attribute *attribute;
 	char buffer[PARSE_XML_MAX_ATTRIBUTE_VAL_LEN];
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return deflt;
@@ -572,7 +1027,7 @@ int parse_xml_read_integer_attribute(struct parse_xml_block *instance, const cha
 	/* Did the value parse OK? */
 
 	if (*endptr != '\0') {
-		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, attribute->name);
+		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, name);
 		instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return deflt;
 	}
@@ -580,7 +1035,7 @@ int parse_xml_read_integer_attribute(struct parse_xml_block *instance, const cha
 	/* Is the value in bounds? */
 
 	if (value < minimum || value > maxumum) {
-		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, attribute->name);
+		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, name);
 		instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return deflt;
 	}
@@ -608,7 +1063,7 @@ int parse_xml_read_option_attribute(struct parse_xml_block *instance, const char
 	struct parse_xml_attribute *attribute;
 	char buffer[PARSE_XML_MAX_ATTRIBUTE_VAL_LEN], *pattern;
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return -1;
@@ -634,7 +1089,7 @@ int parse_xml_read_option_attribute(struct parse_xml_block *instance, const char
 	/* We need to find a match if attribute is present. */
 
 	if (index == -1) {
-		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, attribute->name);
+		msg_report(MSG_BAD_ATTRIBUTE_VALUE, buffer, name);
 		instance->current_mode = PARSE_XML_RESULT_ERROR;
 	}
 
@@ -651,24 +1106,114 @@ int parse_xml_read_option_attribute(struct parse_xml_block *instance, const char
 
 static struct parse_xml_attribute *parse_xml_find_attribute(struct parse_xml_block *instance, const char *name)
 {
+	struct parse_xml_attribute *attribute;
+	uint64_t hash;
+	size_t length;
 	int i;
 
-	if (instance == NULL)
+	if (instance == NULL || name == NULL)
 		return NULL;
 
 	if (instance->current_mode != PARSE_XML_RESULT_TAG_START &&
 			instance->current_mode != PARSE_XML_RESULT_TAG_EMPTY)
 		return NULL;
 
+	if (instance->attribute_count == 0)
+		return NULL;
+
+	/* Compare hashes first, so that the names themselves only need to
+	 * be checked for the attribute which is likely to match.
+	 */
+
+	length = strlen(name);
+	hash = string_hash(name, length, STRING_HASH_INITIAL);
+
 	for (i = 0; i < instance->attribute_count; i++) {
-		if (strcmp(instance->attributes[i].name, name) == 0)
-			return instance->attributes + i;
+		attribute = instance->attributes + i;
+
+		if (attribute->hash == hash && attribute->name_length == length &&
+				memcmp(instance->buffer + attribute->name_start, name, length) == 0)
+			return attribute;
 	}
 
 	return NULL;
 }
 
 
+/**
+ * Claim the next free attribute slot for the current element, growing
+ * the attribute storage if required.
+ *
+ * \param *instance	Pointer to the instance to be used.
+ * \return		Pointer to the attribute slot, or NULL on failure.
+ */
+
+static struct parse_xml_attribute *parse_xml_claim_attribute(struct parse_xml_block *instance)
+{
+	struct parse_xml_attribute *attributes;
+	int i, capacity;
+
+	/* Spill over into allocated storage if the slots are all in use. The
+	 * storage is kept for the life of the instance, so that it only
+	 * grows on the largest tags.
+	 */
+
+	if (instance->attribute_count >= instance->attribute_capacity) {
+		capacity = instance->attribute_capacity * 2;
+
+		if (instance->attributes == instance->attribute_store) {
+			attributes = malloc(capacity * sizeof(struct parse_xml_attribute));
+			if (attributes != NULL)
+				memcpy(attributes, instance->attribute_store, sizeof(instance->attribute_store));
+		} else {
+			attributes = realloc(instance->attributes, capacity * sizeof(struct parse_xml_attribute));
+		}
+
+		if (attributes == NULL)
+			return NULL;
+
+		for (i = instance->attribute_capacity; i < capacity; i++)
+			attributes[i].parser = NULL;
+
+		instance->attributes = attributes;
+		instance->attribute_capacity = capacity;
+	}
+
+	return instance->attributes + instance->attribute_count++;
+}
+
+
+/**
+ * Free the attribute storage belonging to an instance, along with any
+ * attribute parsers which it holds.
+ *
+ * \param *instance	Pointer to the instance to be used.
+ */
+
+static void parse_xml_free_attributes(struct parse_xml_block *instance)
+{
+	struct parse_xml_block *parser;
+	int i;
+
+	for (i = 0; i < instance->attribute_capacity; i++) {
+		parser = instance->attributes[i].parser;
+		if (parser == NULL)
+			continue;
+
+		parse_xml_free_attributes(parser);
+		instance->chunk_count += parser->chunk_count;
+		free(parser);
+	}
+
+	if (instance->attributes != instance->attribute_store)
+		free(instance->attributes);
+
+	instance->attributes = instance->attribute_store;
+	instance->attribute_capacity = PARSE_XML_INLINE_ATTRIBUTES;
+	instance->attribute_count = 0;
+}
+
+
 /**
  * Read the details of the current entity parsed from
  * the file.
@@ -701,9 +1246,9 @@ enum manual_entity_type parse_xml_get_entity(struct parse_xml_block *instance)
  * \return		The number of bytes copied into the output buffer.
  */
 
-static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, long start, size_t length, char *buffer, size_t size)
+static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, int64_t start, size_t length, char *buffer, size_t size)
 {
-	long i, j;
+	int64_t i, j;
 	int c;
 	bool last_cr = false;
 
@@ -714,17 +1259,13 @@ static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, lo
 
 	buffer[0] = '\0';
 
-	if (instance == NULL)
+	if (instance == NULL || instance->buffer == NULL || start < 0)
 		return 0;
 
-	/* Find the start of the text to copy. */
-
-	fseek(instance->file, start, SEEK_SET);
-
 	/* Copy the text from the file to the buffer, converting \r and \r\n into \n. */
 
-	for (i = 0, j = 0; i < length && j < (size - 1); i++) {
-		c = parse_xml_getc(instance);
+	for (i = 0, j = 0; i < length && j < (size - 1) && (start + i) < instance->buffer_length; i++) {
+		c = parse_xml_peek(instance, start + i);
 
 		if (c == instance->eof)
 			break;
@@ -744,10 +1285,6 @@ static size_t parse_xml_copy_text_to_buffer(struct parse_xml_block *instance, lo
 
 	buffer[j] = '\0';
 
-	/* Restore the file pointer to where it came from. */
-
-	fseek(instance->file, instance->file_pointer, SEEK_SET);
-
 	return j;
 }
 
@@ -763,7 +1300,7 @@ static void parse_xml_read_text(struct parse_xml_block *instance, int c)
 {
 	bool whitespace = true;
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -771,13 +1308,16 @@ static void parse_xml_read_text(struct parse_xml_block *instance, int c)
 
 	/* Count the size of the text block. */
 
-	instance->text_block_start = ftell(instance->file) - 1;
+	instance->text_block_start = instance->file_pointer - 1;
 	instance->text_block_length = 0;
+	instance->text_block_normalise = false;
 
 	while (c != instance->eof && c != '<' && c != '&') {
 		instance->text_block_length++;
 		if (!parse_xml_isspace(c))
 			whitespace = false;
+		else if (c == '\r')
+			instance->text_block_normalise = true;
 
 		c = parse_xml_getc(instance);
 	}
@@ -785,16 +1325,16 @@ static void parse_xml_read_text(struct parse_xml_block *instance, int c)
 	/* Return the last character to the file. */
 
 	if (c != EOF)
-		fseek(instance->file, -1, SEEK_CUR);
+		instance->file_pointer--;
 
 	/* Update the status. */
 
 	if (whitespace == true) {
 		instance->current_mode = PARSE_XML_RESULT_WHITESPACE;
-		msg_report(MSG_PARSER_FOUND_WHITESPACE);
+		msg_trace(MSG_PARSER_FOUND_WHITESPACE);
 	} else {
 		instance->current_mode = PARSE_XML_RESULT_TEXT;
-		msg_report(MSG_PARSER_FOUND_TEXT);
+		msg_trace(MSG_PARSER_FOUND_TEXT);
 	}
 }
 
@@ -810,7 +1350,7 @@ static void parse_xml_read_markup(struct parse_xml_block *instance, int c)
 {
 	/* Tags must start with a <; we shouldn't be here otherwise. */
 
-	if (c != '<' || instance == NULL || instance->file == NULL) {
+	if (c != '<' || instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -852,7 +1392,7 @@ static void parse_xml_read_element(struct parse_xml_block *instance, int c)
 {
 	int len = 0;
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -861,6 +1401,7 @@ static void parse_xml_read_element(struct parse_xml_block *instance, int c)
 	/* Assume an opening tag until we learn otherwise. */
 
 	instance->current_mode = PARSE_XML_RESULT_TAG_START;
+	instance->object_element = PARSE_ELEMENT_NONE;
 
 	/* If the tag starts with a /, it's a closing tag. */
 
@@ -922,7 +1463,7 @@ static void parse_xml_read_element(struct parse_xml_block *instance, int c)
 
 	/* If the tag ended with a /, it was a self-closing tag. */
 
-	fseek(instance->file, -2, SEEK_CUR);
+	instance->file_pointer -= 2;
 	c = parse_xml_getc(instance);
 
 	if (c == '/') {
@@ -948,13 +1489,13 @@ static void parse_xml_read_element(struct parse_xml_block *instance, int c)
 
 	switch (instance->current_mode) {
 	case PARSE_XML_RESULT_TAG_START:
-		msg_report(MSG_PARSER_FOUND_OPENING_TAG, instance->object_name);
+		msg_trace(MSG_PARSER_FOUND_OPENING_TAG, instance->object_name);
 		break;
 	case PARSE_XML_RESULT_TAG_EMPTY:
-		msg_report(MSG_PARSER_FOUND_SELF_CLOSING_TAG, instance->object_name);
+		msg_trace(MSG_PARSER_FOUND_SELF_CLOSING_TAG, instance->object_name);
 		break;
 	case PARSE_XML_RESULT_TAG_END:
-		msg_report(MSG_PARSER_FOUND_CLOSING_TAG, instance->object_name);
+		msg_trace(MSG_PARSER_FOUND_CLOSING_TAG, instance->object_name);
 		break;
 	default:
 		break;
@@ -971,11 +1512,13 @@ static void parse_xml_read_element(struct parse_xml_block *instance, int c)
 
 static void parse_xml_read_element_attributes(struct parse_xml_block *instance, int c)
 {
-	int len = 0;
-	long start = -1, length = 0;
-	char name[PARSE_XML_MAX_NAME_LEN], quote = '\0';
+	int64_t name_start, start = -1, length = 0;
+	size_t name_length;
+	char name[PARSE_XML_MAX_NAME_LEN];
+	int quote = '\0';
+	struct parse_xml_attribute *attribute;
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -984,8 +1527,6 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 	/* Process the file until we reach the closing > or EOF. */
 
 	while (c != instance->eof && c != '>') {
-		len = 0;
-
 		/* Look for the start of an attribute name. */
 
 		while (c != instance->eof && c != '>' && !parse_xml_isname_start(c))
@@ -994,31 +1535,21 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 		if (c == instance->eof || c == '>')
 			continue;
 
-		/* We've found an attribute name, so copy it into the temp buffer. */
+		/* We've found an attribute name, so note where it lies in the
+		 * buffer; the file pointer is already one character beyond its
+		 * start.
+		 */
 
-		name[len++] = c;
+		name_start = instance->file_pointer - 1;
+		name_length = 1;
 
 		c = parse_xml_getc(instance);
 
-		do {
-			if (c != instance->eof && parse_xml_isname(c) && len < PARSE_XML_MAX_NAME_LEN)
-				name[len++] = c;
-
+		while (c != instance->eof && parse_xml_isname(c)) {
+			name_length++;
 			c = parse_xml_getc(instance);
-		} while (c != instance->eof && parse_xml_isname(c));
-
-		name[PARSE_XML_MAX_NAME_LEN - 1] = '\0';
-
-		/* The name is too long. */
-
-		if (len >= PARSE_XML_MAX_NAME_LEN) {
-			instance->current_mode = PARSE_XML_RESULT_ERROR;
-			msg_report(MSG_PARSE_ATTRIBUTE_TOO_LONG, name);
-			return;
 		}
 
-		name[len] = '\0';
-
 		/* Skip any whitespace after the name. */
 
 		while (c != instance->eof && isspace(c))
@@ -1038,7 +1569,7 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 
 			if (c == '\'' || c == '"') {
 				quote = c;
-				start = ftell(instance->file);
+				start = instance->file_pointer;
 
 				/* Step through the data, and find the length. */
 
@@ -1047,10 +1578,11 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 				while (c != instance->eof && c != quote)
 					c = parse_xml_getc(instance);
 
-				length = ftell(instance->file) - (start + 1);
+				length = instance->file_pointer - (start + 1);
 
 				if (c != quote) {
 					instance->current_mode = PARSE_XML_RESULT_ERROR;
+					parse_xml_copy_text_to_buffer(instance, name_start, name_length, name, PARSE_XML_MAX_NAME_LEN);
 					msg_report(MSG_PARSE_UNTERMINATED_ATTRIBUTE, name);
 					return;
 				}
@@ -1062,22 +1594,28 @@ static void parse_xml_read_element_attributes(struct parse_xml_block *instance,
 			length = 0;
 		}
 
-		/* Check that there's room for the attribute. */
+		/* Record the attribute in the next free slot. */
 
-		if (instance->attribute_count > PARSE_XML_MAX_ATTRIBUTES) {
+		attribute = parse_xml_claim_attribute(instance);
+		if (attribute == NULL) {
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
-			msg_report(MSG_PARSE_TOO_MANY_ATTRIBUTES);
+			msg_report(MSG_PARSE_ATTRIBUTE_NO_MEM);
 			return;
 		}
 
-		strncpy(instance->attributes[instance->attribute_count].name, name, PARSE_XML_MAX_NAME_LEN);
-		instance->attributes[instance->attribute_count].start = start;
-		instance->attributes[instance->attribute_count].length = length;
-		instance->attributes[instance->attribute_count].parser->current_mode = PARSE_XML_RESULT_START;
-		instance->attributes[instance->attribute_count].parser->file_pointer = start;
-		instance->attributes[instance->attribute_count].parser->eof = quote;
-
-		instance->attribute_count++;
+		attribute->hash = string_hash(instance->buffer + name_start, name_length, STRING_HASH_INITIAL);
+		attribute->name_start = name_start;
+		attribute->name_length = name_length;
+		attribute->start = start;
+		attribute->length = length;
+		attribute->quote = quote;
+
+		if (attribute->parser != NULL) {
+			attribute->parser->current_mode = PARSE_XML_RESULT_START;
+			attribute->parser->buffer_length = instance->buffer_length;
+			attribute->parser->file_pointer = start;
+			attribute->parser->eof = quote;
+		}
 	}
 
 	return;
@@ -1093,7 +1631,7 @@ static void parse_xml_read_comment(struct parse_xml_block *instance)
 {
 	int c, dashes = 0;
 
-	if (instance == NULL || instance->file == NULL) {
+	if (instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -1118,7 +1656,7 @@ static void parse_xml_read_comment(struct parse_xml_block *instance)
 
 	instance->current_mode = PARSE_XML_RESULT_COMMENT;
 
-	msg_report(MSG_PARSER_FOUND_COMMENT);
+	msg_trace(MSG_PARSER_FOUND_COMMENT);
 }
 
 
@@ -1135,7 +1673,7 @@ static void parse_xml_read_entity(struct parse_xml_block *instance, int c)
 
 	/* Entities must start with &; we shouldn't be here otherwise! */
 
-	if (c != '&' || instance == NULL || instance->file == NULL) {
+	if (c != '&' || instance == NULL || instance->buffer == NULL) {
 		if (instance != NULL)
 			instance->current_mode = PARSE_XML_RESULT_ERROR;
 		return;
@@ -1182,7 +1720,7 @@ static void parse_xml_read_entity(struct parse_xml_block *instance, int c)
 
 	instance->current_mode = PARSE_XML_RESULT_TAG_ENTITY;
 
-	msg_report(MSG_PARSER_FOUND_ENTITY, instance->object_name);
+	msg_trace(MSG_PARSER_FOUND_ENTITY, instance->object_name);
 }
 
 
@@ -1197,61 +1735,101 @@ static void parse_xml_read_entity(struct parse_xml_block *instance, int c)
 
 static bool parse_xml_match_ahead(struct parse_xml_block *instance, const char *text)
 {
-	int c;
-	long start;
+	int64_t position;
 
-	if (text == NULL || instance == NULL || instance->file == NULL)
+	if (text == NULL || instance == NULL || instance->buffer == NULL)
 		return false;
 
-	/* Remember where we started. */
+	/* Match through the required string, directly in the buffer. */
 
-	start = ftell(instance->file);
+	position = instance->file_pointer;
 
-	/* Match through the required string. */
-
-	while (*text != '\0') {
-		c = parse_xml_getc(instance);
-
-		if (c == instance->eof || c != *text)
+	while (*text != '\0' && position >= 0 && (position < instance->buffer_length || parse_xml_load_block(instance))) {
+		if (parse_xml_peek(instance, position) != (unsigned char) *text || (unsigned char) *text == instance->eof)
 			break;
 
+		position++;
 		text++;
 	}
 
-	/* If there wasn't a match, reset the file pointer. */
-
 	if (*text != '\0')
-		fseek(instance->file, start, SEEK_SET);
+		return false;
 
-	return (*text == '\0') ? true : false;
+	/* On a match, step over the text via the reader, so that the
+	 * line count is maintained.
+	 */
+
+	while (instance->file_pointer < position)
+		parse_xml_getc(instance);
+
+	return true;
 }
 
 /**
- * Get the next character from the file, updating the line count if
- * necessary.
- * 
+ * Get the next character from the file.
+ *
  * \param *instance	The parser instance to use.
  * \return		The next character read from the file.
  */
 
 static int parse_xml_getc(struct parse_xml_block *instance)
 {
-	int c;
-	long fp;
+	if (instance == NULL || instance->buffer == NULL)
+		return EOF;
+
+	if (instance->file_pointer < 0)
+		return EOF;
+
+	if (instance->file_pointer >= instance->buffer_length && !parse_xml_load_block(instance))
+		return EOF;
+
+	return parse_xml_peek(instance, instance->file_pointer++);
+}
 
-	if (instance == NULL || instance->file == NULL)
-		return instance->eof;
+/**
+ * Find the line number of the current position in a file, on behalf of
+ * the message system. New lines are counted from the point reached by
+ * the previous call, so each part of the file is only scanned once.
+ *
+ * \param *data		The parser instance to use.
+ * \return		The current line number.
+ */
 
-	c = fgetc(instance->file);
+static unsigned parse_xml_find_line(void *data)
+{
+	struct parse_xml_block	*instance = data;
+	int64_t			position;
 
-	fp = ftell(instance->file);
+	if (instance == NULL || instance->buffer == NULL)
+		return 0;
 
-	if (c == '\n' && fp > instance->line_count_file_pointer) {
-		msg_set_line(++(instance->line_count));
-		instance->line_count_file_pointer = fp;
+	for (position = instance->line_count_file_pointer; position < instance->file_pointer; position++) {
+		if (parse_xml_peek(instance, position) == '\n')
+			instance->line_count++;
 	}
 
-	return c;
+	if (instance->file_pointer > instance->line_count_file_pointer)
+		instance->line_count_file_pointer = instance->file_pointer;
+
+	return instance->line_count;
+}
+
+/**
+ * Return the character at a given offset into the buffer, allowing for
+ * any which have been overwritten to terminate a claimed text block.
+ *
+ * \param *instance	The parser instance to use.
+ * \param position	The offset of the character in the buffer, which
+ *			must be valid.
+ * \return		The character at the offset.
+ */
+
+static int parse_xml_peek(struct parse_xml_block *instance, int64_t position)
+{
+	if (position == instance->terminator_position)
+		return instance->terminator_char;
+
+	return (unsigned char) instance->buffer[position];
 }
 
 /**
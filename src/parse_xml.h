@@ -31,6 +31,7 @@
 #define XMLMAN_PARSE_XML_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "manual_entity.h"
 
 /**
@@ -58,13 +59,26 @@ enum parse_xml_result {
 struct parse_xml_block;
 
 /**
- * Open a new file in the XML parser.
+ * A span of text within the parser's in-memory copy of a source file.
+ */
+
+struct parse_xml_span {
+	char	*text;		/**< Pointer to the start of the text, which is not terminated.	*/
+	size_t	length;		/**< The number of bytes in the span.				*/
+	bool	normalise;	/**< True if the text contains line endings needing conversion.	*/
+};
+
+/**
+ * Open a new file in the XML parser. A filename of FILENAME_STDIO reads
+ * the document from stdin.
  *
  * \param *filename	The name of the file to open.
+ * \param incremental	True to read the file only as far as it is parsed;
+ *			False to read it all up front.
  * \return		Pointer to the new instance, or NULL on failure.
  */
 
-struct parse_xml_block *parse_xml_open_file(char *filename);
+struct parse_xml_block *parse_xml_open_file(char *filename, bool incremental);
 
 /**
  * Close a file in the XML parser.
@@ -103,6 +117,34 @@ enum parse_xml_result parse_xml_read_next_chunk(struct parse_xml_block *instance
 
 char *parse_xml_get_text(struct parse_xml_block *instance);
 
+/**
+ * Return a pointer to the current text block parsed from the file,
+ * returning it in place within the source buffer if no line ending
+ * conversion is required or a copy if it is.
+ *
+ * Either way, the text may be modified by the caller but must not be
+ * freed; claiming text in place hands the source buffer over to the
+ * manual data arena, so that it remains after the file is closed.
+ *
+ * \param *instance		Pointer to the instance to be used.
+ * \return			Pointer to the block, or NULL.
+ */
+
+char *parse_xml_claim_text(struct parse_xml_block *instance);
+
+/**
+ * Return details of the current text block parsed from the file, as
+ * a span within the source buffer. The text will not be terminated, and
+ * if the normalise flag is set, the line endings will not have been
+ * converted.
+ *
+ * \param *instance		Pointer to the instance to be used.
+ * \param *span			Pointer to a span to take the details.
+ * \return			True if successful; else false.
+ */
+
+bool parse_xml_get_text_span(struct parse_xml_block *instance, struct parse_xml_span *span);
+
 /**
  * Read the details of the current element parsed from
  * the file.
@@ -145,6 +187,20 @@ struct parse_xml_block *parse_xml_get_attribute_parser(struct parse_xml_block *i
 
 char *parse_xml_get_attribute_text(struct parse_xml_block *instance, const char *name);
 
+/**
+ * Return details of the text from an attribute, as a span within
+ * the source buffer, without considering the validity of any of the
+ * characters within. The text will not be terminated, and if the
+ * normalise flag is set, the line endings will not have been converted.
+ *
+ * \param *instance	Pointer to the instance to be used.
+ * \param *name		The name of the attribute to be matched.
+ * \param *span		Pointer to a span to take the details.
+ * \return		True if successful; else false.
+ */
+
+bool parse_xml_get_attribute_span(struct parse_xml_block *instance, const char *name, struct parse_xml_span *span);
+
 /**
  * Copy the text from an attribute into a buffer, without
  * considering the validity of any characters within.
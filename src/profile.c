@@ -0,0 +1,182 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file profile.c
+ *
+ * Hot Path Profiling, implementation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "profile.h"
+
+#include "xmlman.h"
+#include "manual_data.h"
+
+#ifdef XMLMAN_PROFILE
+
+/**
+ * The width of the histogram bars, in characters.
+ */
+
+#define PROFILE_BAR_WIDTH 30
+
+/**
+ * The number of object types which calls can be recorded against.
+ */
+
+#define PROFILE_TYPES (MANUAL_DATA_OBJECT_TYPE_NONE + 1)
+
+/**
+ * The totals for calls made through a hook for an object type.
+ */
+
+struct profile_total {
+	uint64_t	calls;		/**< The number of calls made.				*/
+	uint64_t	time;		/**< The time spent in the calls, in nanoseconds.	*/
+};
+
+/* Static Global Variables. */
+
+/**
+ * The names of the hooks, as shown in the report.
+ */
+
+static const char *profile_hook_names[PROFILE_HOOK_MAX] = {
+	"parse_block_object",
+	"parse_table",
+	"output_html_write_table",
+	"output_html_write_text",
+	"output_strong_write_text",
+	"output_text_write_table",
+	"output_text_write_text"
+};
+
+/**
+ * The totals for each hook and object type, which are updated atomically
+ * as the output engines can be running on several threads.
+ */
+
+static struct profile_total profile_totals[PROFILE_HOOK_MAX][PROFILE_TYPES];
+
+/* Static Function Prototypes. */
+
+static uint64_t profile_get_time(void);
+
+/**
+ * Start timing a profiled call.
+ *
+ * \param *timer	Pointer to the timer to start.
+ */
+
+void profile_start(struct profile_timer *timer)
+{
+	if (timer != NULL)
+		timer->start = profile_get_time();
+}
+
+/**
+ * Record a profiled call, adding the time since its timer was started
+ * to the totals for the hook and object type.
+ *
+ * \param *timer	Pointer to the timer for the call.
+ * \param hook		The hook through which the call was made.
+ * \param type		The type of object handled by the call.
+ */
+
+void profile_record(struct profile_timer *timer, enum profile_hook hook, enum manual_data_object_type type)
+{
+	struct profile_total *total;
+
+	if (timer == NULL || hook < 0 || hook >= PROFILE_HOOK_MAX || type < 0 || type >= PROFILE_TYPES)
+		return;
+
+	total = &(profile_totals[hook][type]);
+
+	__atomic_fetch_add(&(total->calls), 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&(total->time), profile_get_time() - timer->start, __ATOMIC_RELAXED);
+}
+
+/**
+ * Write the histogram of the calls recorded so far to stderr. Each
+ * hook's object types are listed with a bar showing their share of the
+ * time spent in the hook. The times of calls which nest, such as those
+ * writing inline text, include the calls made within them.
+ */
+
+void profile_report(void)
+{
+	uint64_t	hook_time;
+	int		hook, type, bar;
+	bool		header = false;
+
+	for (hook = 0; hook < PROFILE_HOOK_MAX; hook++) {
+		hook_time = 0;
+
+		for (type = 0; type < PROFILE_TYPES; type++)
+			hook_time += profile_totals[hook][type].time;
+
+		if (hook_time == 0)
+			continue;
+
+		if (!header) {
+			fprintf(stderr, "\n%-26s %-24s %10s %12s %10s\n", "Hook", "Object", "Calls", "Time (ms)", "Mean (us)");
+			header = true;
+		}
+
+		for (type = 0; type < PROFILE_TYPES; type++) {
+			if (profile_totals[hook][type].calls == 0)
+				continue;
+
+			bar = (int) ((profile_totals[hook][type].time * PROFILE_BAR_WIDTH + hook_time / 2) / hook_time);
+
+			fprintf(stderr, "%-26s %-24s %10llu %12.3f %10.3f %.*s\n", profile_hook_names[hook],
+					manual_data_find_object_name(type),
+					(unsigned long long) profile_totals[hook][type].calls,
+					(double) profile_totals[hook][type].time / 1000000.0,
+					(double) profile_totals[hook][type].time / 1000.0 / (double) profile_totals[hook][type].calls,
+					bar, "##############################");
+		}
+	}
+}
+
+/**
+ * Return the current monotonic time.
+ *
+ * \return		The monotonic time, in nanoseconds.
+ */
+
+static uint64_t profile_get_time(void)
+{
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+		return 0;
+
+	return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+/**
+ * \file profile.h
+ *
+ * Hot Path Profiling Interface.
+ *
+ * When built with XMLMAN_PROFILE defined, the calls through the busiest
+ * parser and output engine functions are counted and timed against the
+ * type of object that each was handling, and a histogram is written to
+ * stderr when the program exits. Otherwise, the hooks compile to nothing.
+ */
+
+#ifndef XMLMAN_PROFILE_H
+#define XMLMAN_PROFILE_H
+
+#include <stdint.h>
+
+#include "xmlman.h"
+
+/**
+ * The functions which can be profiled.
+ */
+
+enum profile_hook {
+	PROFILE_HOOK_PARSE_BLOCK,	/**< parse_block_object().			*/
+	PROFILE_HOOK_PARSE_TABLE,	/**< parse_table().				*/
+	PROFILE_HOOK_HTML_TABLE,	/**< output_html_write_table().			*/
+	PROFILE_HOOK_HTML_TEXT,		/**< output_html_write_text().			*/
+	PROFILE_HOOK_STRONG_TEXT,	/**< output_strong_write_text().		*/
+	PROFILE_HOOK_TEXT_TABLE,	/**< output_text_write_table().			*/
+	PROFILE_HOOK_TEXT_TEXT,		/**< output_text_write_text().			*/
+	PROFILE_HOOK_MAX		/**< The number of hooks.			*/
+};
+
+#ifdef XMLMAN_PROFILE
+
+/**
+ * A timer, holding the start time of a profiled call.
+ */
+
+struct profile_timer {
+	uint64_t	start;		/**< The monotonic time at the start, in nanoseconds.	*/
+};
+
+/**
+ * Start timing a profiled call.
+ *
+ * \param *timer	Pointer to the timer to start.
+ */
+
+void profile_start(struct profile_timer *timer);
+
+/**
+ * Record a profiled call, adding the time since its timer was started
+ * to the totals for the hook and object type.
+ *
+ * \param *timer	Pointer to the timer for the call.
+ * \param hook		The hook through which the call was made.
+ * \param type		The type of object handled by the call.
+ */
+
+void profile_record(struct profile_timer *timer, enum profile_hook hook, enum manual_data_object_type type);
+
+/**
+ * Write the histogram of the calls recorded so far to stderr.
+ */
+
+void profile_report(void);
+
+#define PROFILE_TIMER(timer) struct profile_timer timer
+#define PROFILE_START(timer) profile_start(&(timer))
+#define PROFILE_RECORD(timer, hook, type) profile_record(&(timer), (hook), (type))
+#define PROFILE_REPORT() profile_report()
+
+#else
+
+#define PROFILE_TIMER(timer)
+#define PROFILE_START(timer)
+#define PROFILE_RECORD(timer, hook, type)
+#define PROFILE_REPORT()
+
+#endif
+
+#endif
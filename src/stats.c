@@ -0,0 +1,437 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file stats.c
+ *
+ * Build Statistics, implementation.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <pthread.h>
+
+#include "stats.h"
+
+#include "msg.h"
+
+/**
+ * The number of phase records to allocate at a time.
+ */
+
+#define STATS_PHASE_BLOCK 32
+
+/**
+ * A phase record.
+ */
+
+struct stats_phase {
+	char	*phase;			/**< The name of the phase.				*/
+	char	*item;			/**< The item processed, in a malloc() block, or NULL.	*/
+	double	wall;			/**< The wall clock time spent, in seconds.		*/
+	double	cpu;			/**< The CPU time spent, in seconds.			*/
+};
+
+/**
+ * A counter definition.
+ */
+
+struct stats_counter_data {
+	char	*name;			/**< The name of the counter, for tables.		*/
+	char	*key;			/**< The key for the counter, for JSON.			*/
+};
+
+/* Global Variables. */
+
+/**
+ * The counter definitions. The order of entries in this array must match
+ * the order of the entries in enum stats_counter.
+ */
+
+static struct stats_counter_data stats_counters[] = {
+	{"Bytes read",			"bytes_read"},
+	{"XML chunks parsed",		"chunks"},
+	{"Nodes allocated",		"nodes"},
+	{"Data blocks allocated",	"allocations"},
+	{"Arena slabs claimed",		"slabs"},
+	{"IDs indexed",			"ids"},
+	{"References resolved",		"references"},
+	{"Output files written",	"files_written"},
+	{"Output files unchanged",	"files_unchanged"},
+	{"Output bytes written",	"bytes_written"}
+};
+
+/**
+ * True if statistics are being collected.
+ */
+
+static bool stats_enabled = false;
+
+/**
+ * Lock protecting the phase records.
+ */
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * The counter values, which are updated atomically so that counting each
+ * allocation doesn't serialise the worker threads on the lock.
+ */
+
+static size_t stats_values[STATS_COUNTER_MAX];
+
+/**
+ * The phase records.
+ */
+
+static struct stats_phase *stats_phases = NULL;
+
+/**
+ * The number of phase records in use.
+ */
+
+static size_t stats_phase_count = 0;
+
+/**
+ * The number of phase records allocated.
+ */
+
+static size_t stats_phase_size = 0;
+
+/* Static Function Prototypes. */
+
+static double stats_get_wall_time(void);
+static double stats_get_cpu_time(void);
+static long stats_get_peak_rss(void);
+static void stats_write_table(void);
+static bool stats_write_json(char *filename);
+static void stats_write_json_string(FILE *file, char *text);
+
+/**
+ * Initialise the statistics system, discarding any phases left over
+ * from an earlier build which wasn't reported. This must be called
+ * before any other threads are started.
+ *
+ * \param enabled	True if statistics are to be collected; otherwise
+ *			all of the calls will do nothing.
+ */
+
+void stats_initialise(bool enabled)
+{
+	size_t i;
+
+	stats_enabled = enabled;
+
+	for (i = 0; i < STATS_COUNTER_MAX; i++)
+		stats_values[i] = 0;
+
+	for (i = 0; i < stats_phase_count; i++)
+		free(stats_phases[i].item);
+
+	free(stats_phases);
+
+	stats_phases = NULL;
+	stats_phase_count = 0;
+	stats_phase_size = 0;
+}
+
+/**
+ * Start timing a phase.
+ *
+ * \param *timer	Pointer to the timer to start.
+ */
+
+void stats_start(struct stats_timer *timer)
+{
+	if (stats_enabled == false || timer == NULL)
+		return;
+
+	timer->wall = stats_get_wall_time();
+	timer->cpu = stats_get_cpu_time();
+}
+
+/**
+ * Record the time spent in a phase since its timer was started.
+ *
+ * \param *timer	Pointer to the timer for the phase.
+ * \param *phase	The name of the phase.
+ * \param *item		The name of the item processed by the phase, or NULL.
+ */
+
+void stats_record(struct stats_timer *timer, char *phase, char *item)
+{
+	struct stats_phase	*record, *extended;
+	double			wall, cpu;
+	char			*copy = NULL;
+
+	if (stats_enabled == false || timer == NULL || phase == NULL)
+		return;
+
+	wall = stats_get_wall_time() - timer->wall;
+	cpu = stats_get_cpu_time() - timer->cpu;
+
+	if (item != NULL) {
+		copy = malloc(strlen(item) + 1);
+		if (copy == NULL) {
+			msg_report(MSG_STATS_NO_MEM);
+			return;
+		}
+
+		strcpy(copy, item);
+	}
+
+	pthread_mutex_lock(&stats_lock);
+
+	if (stats_phase_count >= stats_phase_size) {
+		extended = realloc(stats_phases, (stats_phase_size + STATS_PHASE_BLOCK) * sizeof(struct stats_phase));
+		if (extended == NULL) {
+			pthread_mutex_unlock(&stats_lock);
+			msg_report(MSG_STATS_NO_MEM);
+			free(copy);
+			return;
+		}
+
+		stats_phases = extended;
+		stats_phase_size += STATS_PHASE_BLOCK;
+	}
+
+	record = stats_phases + stats_phase_count++;
+
+	record->phase = phase;
+	record->item = copy;
+	record->wall = wall;
+	record->cpu = cpu;
+
+	pthread_mutex_unlock(&stats_lock);
+}
+
+/**
+ * Add an amount to one of the counters.
+ *
+ * \param counter	The counter to update.
+ * \param amount	The amount to add to the counter.
+ */
+
+void stats_count(enum stats_counter counter, size_t amount)
+{
+	if (stats_enabled == false || counter < 0 || counter >= STATS_COUNTER_MAX)
+		return;
+
+	__atomic_fetch_add(&stats_values[counter], amount, __ATOMIC_RELAXED);
+}
+
+/**
+ * Report the statistics collected, either as a table on stdout or as
+ * JSON in a file.
+ *
+ * \param table		True to print a table of the statistics to stdout.
+ * \param *json		The name of a file to write JSON to, or NULL.
+ * \return		True if successful; otherwise False.
+ */
+
+bool stats_report(bool table, char *json)
+{
+	bool	result = true;
+	size_t	i;
+
+	if (stats_enabled == false)
+		return true;
+
+	pthread_mutex_lock(&stats_lock);
+
+	if (table == true)
+		stats_write_table();
+
+	if (json != NULL && !stats_write_json(json))
+		result = false;
+
+	for (i = 0; i < stats_phase_count; i++)
+		free(stats_phases[i].item);
+
+	free(stats_phases);
+
+	stats_phases = NULL;
+	stats_phase_count = 0;
+	stats_phase_size = 0;
+
+	pthread_mutex_unlock(&stats_lock);
+
+	if (result == false)
+		msg_report(MSG_STATS_WRITE_FAIL, json);
+
+	return result;
+}
+
+/**
+ * Write the statistics to stdout as a table.
+ */
+
+static void stats_write_table(void)
+{
+	size_t	i;
+	int	counter;
+
+	printf("\n%-12s %-40s %10s %10s\n", "Phase", "Item", "Wall (s)", "CPU (s)");
+
+	for (i = 0; i < stats_phase_count; i++) {
+		printf("%-12s %-40s %10.4f %10.4f\n", stats_phases[i].phase,
+				(stats_phases[i].item != NULL) ? stats_phases[i].item : "",
+				stats_phases[i].wall, stats_phases[i].cpu);
+	}
+
+	printf("\n%-24s %12s\n", "Counter", "Value");
+
+	for (counter = 0; counter < STATS_COUNTER_MAX; counter++)
+		printf("%-24s %12zu\n", stats_counters[counter].name, stats_values[counter]);
+
+	printf("%-24s %12ld\n", "Peak RSS (K)", stats_get_peak_rss());
+}
+
+/**
+ * Write the statistics to a file as JSON.
+ *
+ * \param *filename	The name of the file to write to.
+ * \return		True if successful; otherwise False.
+ */
+
+static bool stats_write_json(char *filename)
+{
+	FILE	*file;
+	size_t	i;
+	int	counter;
+	bool	result = true;
+
+	file = fopen(filename, "w");
+	if (file == NULL)
+		return false;
+
+	fprintf(file, "{\n  \"phases\": [");
+
+	for (i = 0; i < stats_phase_count; i++) {
+		fprintf(file, "%s\n    {\"phase\": ", (i > 0) ? "," : "");
+		stats_write_json_string(file, stats_phases[i].phase);
+
+		if (stats_phases[i].item != NULL) {
+			fprintf(file, ", \"item\": ");
+			stats_write_json_string(file, stats_phases[i].item);
+		}
+
+		fprintf(file, ", \"wall\": %.6f, \"cpu\": %.6f}", stats_phases[i].wall, stats_phases[i].cpu);
+	}
+
+	fprintf(file, "\n  ],\n  \"counters\": {");
+
+	for (counter = 0; counter < STATS_COUNTER_MAX; counter++)
+		fprintf(file, "%s\n    \"%s\": %zu", (counter > 0) ? "," : "", stats_counters[counter].key, stats_values[counter]);
+
+	fprintf(file, "\n  },\n  \"peak_rss_kb\": %ld\n}\n", stats_get_peak_rss());
+
+	if (ferror(file))
+		result = false;
+
+	if (fclose(file) != 0)
+		result = false;
+
+	return result;
+}
+
+/**
+ * Write a string to a file as a quoted JSON string.
+ *
+ * \param *file		The file to write to.
+ * \param *text		The text to be written.
+ */
+
+static void stats_write_json_string(FILE *file, char *text)
+{
+	unsigned char c;
+
+	fputc('"', file);
+
+	while ((c = *text++) != '\0') {
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(file, "\\u%04x", c);
+		else
+			fputc(c, file);
+	}
+
+	fputc('"', file);
+}
+
+/**
+ * Return the current wall clock time.
+ *
+ * \return		The wall clock time, in seconds.
+ */
+
+static double stats_get_wall_time(void)
+{
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+		return 0.0;
+
+	return (double) now.tv_sec + (double) now.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Return the CPU time used by the calling thread, or by the whole process
+ * if the thread's time is not available.
+ *
+ * \return		The CPU time, in seconds.
+ */
+
+static double stats_get_cpu_time(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0)
+		return (double) now.tv_sec + (double) now.tv_nsec / 1000000000.0;
+#endif
+
+	return (double) clock() / CLOCKS_PER_SEC;
+}
+
+/**
+ * Return the peak resident set size of the process.
+ *
+ * \return		The peak RSS, in kilobytes, or 0 if unknown.
+ */
+
+static long stats_get_peak_rss(void)
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	return usage.ru_maxrss;
+}
@@ -0,0 +1,117 @@
+/* Copyright 2024, Stephen Fryatt (info@stevefryatt.org.uk)
+ *
+ * This file is part of XmlMan:
+ *
+ *   http://www.stevefryatt.org.uk/risc-os
+ *
+ * Licensed under the EUPL, Version 1.2 only (the "Licence");
+ * You may not use this work except in compliance with the
+ * Licence.
+ *
+ * You may obtain a copy of the Licence at:
+ *
+ *   http://joinup.ec.europa.eu/software/page/eupl
+ *
+ * Unless required by applicable law or agreed to in
+ * writing, software distributed under the Licence is
+ * distributed on an "AS IS" basis, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * See the Licence for the specific language governing
+ * permissions and limitations under the Licence.
+ */
+
+/**
+ * \file stats.h
+ *
+ * Build Statistics Interface.
+ *
+ * When enabled, the time spent in each phase of a build is recorded
+ * along with counts of the work done, so that they can be reported at
+ * the end of the run.
+ */
+
+#ifndef XMLMAN_STATS_H
+#define XMLMAN_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The counters which can be updated.
+ */
+
+enum stats_counter {
+	STATS_COUNTER_BYTES_READ,	/**< The number of bytes of source read.		*/
+	STATS_COUNTER_CHUNKS,		/**< The number of XML chunks parsed.			*/
+	STATS_COUNTER_NODES,		/**< The number of manual_data nodes allocated.		*/
+	STATS_COUNTER_ALLOCATIONS,	/**< The number of blocks allocated for manual data.	*/
+	STATS_COUNTER_SLABS,		/**< The number of arena slabs claimed from the heap.	*/
+	STATS_COUNTER_IDS,		/**< The number of IDs indexed.				*/
+	STATS_COUNTER_REFERENCES,	/**< The number of references resolved.			*/
+	STATS_COUNTER_FILES_WRITTEN,	/**< The number of output files written.		*/
+	STATS_COUNTER_FILES_UNCHANGED,	/**< The number of output files left unchanged.		*/
+	STATS_COUNTER_BYTES_WRITTEN,	/**< The number of bytes of output written.		*/
+	STATS_COUNTER_MAX		/**< The number of counters.				*/
+};
+
+/**
+ * A timer, holding the start times of a phase.
+ */
+
+struct stats_timer {
+	double	wall;			/**< The wall clock time at the start, in seconds.	*/
+	double	cpu;			/**< The thread CPU time at the start, in seconds.	*/
+};
+
+/**
+ * Initialise the statistics system, discarding any phases left over
+ * from an earlier build which wasn't reported. This must be called
+ * before any other threads are started.
+ *
+ * \param enabled	True if statistics are to be collected; otherwise
+ *			all of the calls will do nothing.
+ */
+
+void stats_initialise(bool enabled);
+
+/**
+ * Start timing a phase.
+ *
+ * \param *timer	Pointer to the timer to start.
+ */
+
+void stats_start(struct stats_timer *timer);
+
+/**
+ * Record the time spent in a phase since its timer was started.
+ *
+ * \param *timer	Pointer to the timer for the phase.
+ * \param *phase	The name of the phase.
+ * \param *item		The name of the item processed by the phase, or NULL.
+ */
+
+void stats_record(struct stats_timer *timer, char *phase, char *item);
+
+/**
+ * Add an amount to one of the counters.
+ *
+ * \param counter	The counter to update.
+ * \param amount	The amount to add to the counter.
+ */
+
+void stats_count(enum stats_counter counter, size_t amount);
+
+/**
+ * Report the statistics collected, either as a table on stdout or as
+ * JSON in a file.
+ *
+ * \param table		True to print a table of the statistics to stdout.
+ * \param *json		The name of a file to write JSON to, or NULL.
+ * \return		True if successful; otherwise False.
+ */
+
+bool stats_report(bool table, char *json);
+
+#endif
+
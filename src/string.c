@@ -51,3 +51,35 @@ int string_nocase_strcmp(char *s1, char *s2)
 	return (toupper(*s1) - toupper(*s2));
 }
 
+/* Add a block of data into a running 64-bit FNV-1a hash.
+ *
+ * This is an external interface, documented in string.h
+ */
+
+uint64_t string_hash(const void *data, size_t length, uint64_t hash)
+{
+	const unsigned char *bytes = data;
+
+	while (length-- > 0) {
+		hash ^= *bytes++;
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+/* Add a terminated string into a running 64-bit FNV-1a hash, ignoring
+ * case.
+ *
+ * This is an external interface, documented in string.h
+ */
+
+uint64_t string_nocase_hash(const char *text, uint64_t hash)
+{
+	while (*text != '\0') {
+		hash ^= (unsigned char) toupper(*text++);
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
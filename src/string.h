@@ -30,6 +30,15 @@
 #ifndef XMLMAN_STRING_H
 #define XMLMAN_STRING_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The initial value for a string_hash() calculation.
+ */
+
+#define STRING_HASH_INITIAL 0xcbf29ce484222325ull
+
 /**
  * Perform a strcmp() case-insensitively on two strings, returning
  * a value less than, equal to or greater than zero depending on
@@ -42,5 +51,29 @@
 
 int string_nocase_strcmp(char *s1, char *s2);
 
+/**
+ * Add a block of data into a running 64-bit FNV-1a hash. A new hash
+ * should be started from STRING_HASH_INITIAL.
+ *
+ * \param *data		Pointer to the data to be hashed.
+ * \param length	The number of bytes of data to hash.
+ * \param hash		The hash value to add the data to.
+ * \return		The updated hash value.
+ */
+
+uint64_t string_hash(const void *data, size_t length, uint64_t hash);
+
+/**
+ * Add a terminated string into a running 64-bit FNV-1a hash, ignoring
+ * case so that strings which match with string_nocase_strcmp() give
+ * the same result.
+ *
+ * \param *text		Pointer to the string to be hashed.
+ * \param hash		The hash value to add the string to.
+ * \return		The updated hash value.
+ */
+
+uint64_t string_nocase_hash(const char *text, uint64_t hash);
+
 #endif
 
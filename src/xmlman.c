@@ -34,6 +34,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <time.h>
 
 /* Local source headers. */
 
@@ -41,22 +43,96 @@
 #include "args.h"
 #include "encoding.h"
 #include "filename.h"
+#include "manifest.h"
 #include "manual.h"
+#include "manual_cache.h"
+#include "manual_encoded.h"
+#include "manual_queue.h"
 #include "msg.h"
 #include "output_debug.h"
+#include "output_file.h"
 #include "output_html.h"
 #include "output_strong.h"
+#include "output_strong_file.h"
 #include "output_text.h"
 #include "parse.h"
+#include "profile.h"
+#include "stats.h"
 
 /* OSLib source headers. */
 
 #ifdef RISCOS
+#include "oslib/os.h"
 #include "oslib/osfile.h"
 #endif
 
+/**
+ * The number of output jobs which can be requested.
+ */
+
+#define XMLMAN_MAX_JOBS 5
+
+/**
+ * The longest line which can be read from a batch file.
+ */
+
+#define XMLMAN_BATCH_LINE_LEN 4096
+
+/**
+ * The maximum number of arguments on a line in a batch file, including
+ * the command name which is supplied in argv[0].
+ */
+
+#define XMLMAN_BATCH_MAX_ARGS 64
+
+/**
+ * The interval between checks on the source files in watch mode, in ms.
+ */
+
+#define XMLMAN_WATCH_INTERVAL 500
+
+/**
+ * An output job, writing a document out in one of the output modes.
+ */
+
+struct xmlman_job {
+	char			*name;		/**< The name of the output mode.			*/
+	char			*file;		/**< The filename to output to, or NULL to skip.	*/
+	struct manual		*document;	/**< The document to be output.				*/
+	enum encoding_target	encoding;	/**< The requested encoding for the output.		*/
+	enum encoding_line_end	line_end;	/**< The requested line ending for the output.		*/
+
+	/**
+	 * The function to use to write the output.
+	 */
+
+	bool			(*mode)(struct manual *, struct filename *, enum encoding_target, enum encoding_line_end);
+
+	unsigned		order;		/**< The position of the job in the list of jobs.	*/
+	bool			result;		/**< The outcome of the job, once complete.		*/
+};
+
+/**
+ * A pool of output jobs, shared between the threads running them.
+ */
+
+struct xmlman_job_pool {
+	pthread_mutex_t		lock;		/**< Lock protecting the next job index.		*/
+	struct xmlman_job	*jobs;		/**< The array of jobs in the pool.			*/
+	int			count;		/**< The number of jobs in the pool.			*/
+	int			next;		/**< The index of the next job to be claimed.		*/
+};
+
 /* Static Function Prototypes. */
 
+static int xmlman_process_line(int argc, char *argv[], bool batch_job);
+static int xmlman_run_batch(char *file, bool verbose);
+static int xmlman_split_batch_line(char *line, char *argv[], int size);
+static int xmlman_watch(char *file, struct xmlman_job *jobs, int count, int threads, bool stats, char *stats_json);
+static void xmlman_watch_pause(void);
+static bool xmlman_run_jobs(struct xmlman_job *jobs, int count, int threads);
+static void *xmlman_job_worker(void *data);
+static bool xmlman_run_job(struct xmlman_job *job, bool collect);
 static bool xmlman_process_mode(char *file, struct manual *document, enum encoding_target encoding, enum encoding_line_end line_end,
 		bool (*mode)(struct manual *, struct filename *, enum encoding_target, enum encoding_line_end));
 
@@ -69,22 +145,65 @@ static bool xmlman_process_mode(char *file, struct manual *document, enum encodi
  */
 
 int main(int argc, char *argv[])
+{
+	int result;
+
+	result = xmlman_process_line(argc, argv, false);
+
+	PROFILE_REPORT();
+
+	return result;
+}
+
+/**
+ * Process a command line, either from the program's own arguments or
+ * from a line in a batch file.
+ *
+ * \param argc			The number of command line arguments.
+ * \param *argv[]		The array of command line arguments.
+ * \param batch_job		True if the line came from a batch file.
+ * \return			The outcome of the execution.
+ */
+
+static int xmlman_process_line(int argc, char *argv[], bool batch_job)
 {
 	bool			param_error = false;
 	bool			output_help = false;
 	bool			verbose_output = false;
 	bool			debug_output = false;
+	bool			incremental = false;
+	bool			stream = false;
+	bool			onepass = false;
+	bool			watch = false;
+	bool			stats = false;
+	bool			shared_css = false;
+	bool			encode_cache = false;
+	bool			compress = false;
+	bool			compare = false;
+	bool			pack = false;
+	bool			search_index = false;
+	int			i, threads = 1, stdout_outputs = 0;
 	struct args_option	*options;
 	char			*input_file = NULL;
 	char			*out_text = NULL, *out_html = NULL, *out_strong = NULL;
+	char			*out_debug_json = NULL;
+	char			*stats_json = NULL;
+	char			*cache_file = NULL;
+	char			*batch_file = NULL;
+	char			*select_chapter = NULL;
+	char			*root_folder = NULL;
+	bool			result;
 	struct manual		*document = NULL;
+	struct filename		*onepass_file = NULL;
+	struct parse_stream	onepass_stream;
+	struct xmlman_job	jobs[XMLMAN_MAX_JOBS];
 	enum encoding_target	output_encoding = ENCODING_TARGET_NONE;
 	enum encoding_line_end	output_line_end = ENCODING_LINE_END_NONE;
 
 	/* Decode the command line options. */
 
 	options = args_process_line(argc, argv,
-			"source/A,verbose/S,help/S,encoding/K,lineend/K,debug/S,text/K,html/K,strong/K");
+			"source/A,verbose/S,help/S,encoding/K,lineend/K,debug/S,text/K,html/K,strong/K,threads/KI,incremental/S,stream/S,stats/S,statsjson/K,cache/K,onepass/S,batch/K,watch/S,htmlcss/S,encodecache/S,compress/S,compare/S,htmlpack/S,searchindex/S,chapter/K,debugjson/K,root/K");
 	if (options == NULL)
 		param_error = true;
 
@@ -93,12 +212,8 @@ int main(int argc, char *argv[])
 			if (options->data != NULL && options->data->value.boolean == true)
 				output_help = true;
 		} else if (strcmp(options->name, "source") == 0) {
-			if (options->data != NULL) {
-				if (options->data->value.string != NULL)
-					input_file = options->data->value.string;
-			} else {
-				param_error = true;
-			}
+			if (options->data != NULL && options->data->value.string != NULL)
+				input_file = options->data->value.string;
 		} else if (strcmp(options->name, "encoding") == 0) {
 			if (options->data != NULL) {
 				if (options->data->value.string != NULL) {
@@ -140,6 +255,87 @@ int main(int argc, char *argv[])
 				else
 					param_error = true;
 			}
+		} else if (strcmp(options->name, "threads") == 0) {
+			if (options->data != NULL) {
+				threads = options->data->value.integer;
+				if (threads < 1)
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "incremental") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				incremental = true;
+		} else if (strcmp(options->name, "stream") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				stream = true;
+		} else if (strcmp(options->name, "onepass") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				onepass = true;
+		} else if (strcmp(options->name, "watch") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				watch = true;
+		} else if (strcmp(options->name, "htmlcss") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				shared_css = true;
+		} else if (strcmp(options->name, "encodecache") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				encode_cache = true;
+		} else if (strcmp(options->name, "compress") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				compress = true;
+		} else if (strcmp(options->name, "compare") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				compare = true;
+		} else if (strcmp(options->name, "htmlpack") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				pack = true;
+		} else if (strcmp(options->name, "searchindex") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				search_index = true;
+		} else if (strcmp(options->name, "stats") == 0) {
+			if (options->data != NULL && options->data->value.boolean == true)
+				stats = true;
+		} else if (strcmp(options->name, "statsjson") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL)
+					stats_json = options->data->value.string;
+				else
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "cache") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL)
+					cache_file = options->data->value.string;
+				else
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "chapter") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL)
+					select_chapter = options->data->value.string;
+				else
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "root") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL)
+					root_folder = options->data->value.string;
+				else
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "batch") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL && !batch_job)
+					batch_file = options->data->value.string;
+				else
+					param_error = true;
+			}
+		} else if (strcmp(options->name, "debugjson") == 0) {
+			if (options->data != NULL) {
+				if (options->data->value.string != NULL)
+					out_debug_json = options->data->value.string;
+				else
+					param_error = true;
+			}
 		} else if (strcmp(options->name, "debug") == 0) {
 			if (options->data != NULL && options->data->value.boolean == true)
 				debug_output = true;
@@ -151,6 +347,91 @@ int main(int argc, char *argv[])
 		options = options->next;
 	}
 
+	/* One-pass output can only write a single text file. */
+
+	if (onepass && (out_text == NULL || out_html != NULL || out_strong != NULL ||
+			debug_output || out_debug_json != NULL || incremental || cache_file != NULL))
+		param_error = true;
+
+	/* Watch mode keeps running, so can't be part of a batch, and its
+	 * document can't come from a cache or be written in one pass.
+	 */
+
+	if (watch && (batch_job || onepass || cache_file != NULL))
+		param_error = true;
+
+	/* A selected chapter only has part of the document parsed, so it
+	 * can't be kept up to date, cached or written in one pass.
+	 */
+
+	if (select_chapter != NULL && (watch || onepass || cache_file != NULL))
+		param_error = true;
+
+	/* Cached text lives as long as the document, so it can't be used
+	 * when the document is updated in place by watch mode.
+	 */
+
+	if (encode_cache && (watch || onepass))
+		param_error = true;
+
+	/* Packed HTML has no folder to keep a manifest in, so can't be
+	 * updated incrementally.
+	 */
+
+	if (pack && (incremental || watch))
+		param_error = true;
+
+	/* Compressed files are passed straight on to disc as they're
+	 * written, so can't be held back to compare with the existing ones.
+	 */
+
+	if (compress && compare)
+		param_error = true;
+
+	/* A source read from stdin can only be read once, so it can't be
+	 * watched, cached or used to hold a cache.
+	 */
+
+	if (input_file != NULL && strcmp(input_file, FILENAME_STDIO) == 0 && (watch || cache_file != NULL))
+		param_error = true;
+
+	/* Only one output can be sent to stdout, with nothing else written
+	 * there. StrongHelp files are seeked as they're written unless they
+	 * are streamed, which -compress implies, and the manifest decides
+	 * whether a file needs writing by its content on disc, so neither a
+	 * seeked StrongHelp file nor an incremental build can be used.
+	 */
+
+	if (out_text != NULL && strcmp(out_text, FILENAME_STDIO) == 0)
+		stdout_outputs++;
+
+	if (out_html != NULL && strcmp(out_html, FILENAME_STDIO) == 0)
+		stdout_outputs++;
+
+	if (out_debug_json != NULL && strcmp(out_debug_json, FILENAME_STDIO) == 0)
+		stdout_outputs++;
+
+	if (out_strong != NULL && strcmp(out_strong, FILENAME_STDIO) == 0) {
+		if (!stream && !compress)
+			param_error = true;
+
+		stdout_outputs++;
+	}
+
+	if ((stdout_outputs > 0 && (debug_output || stats || incremental || watch)) || stdout_outputs > 1)
+		param_error = true;
+
+	/* A source file is required, unless a batch file supplies everything
+	 * on its own lines.
+	 */
+
+	if (batch_file == NULL && input_file == NULL)
+		param_error = true;
+
+	if (batch_file != NULL && (input_file != NULL || out_text != NULL || out_html != NULL || out_strong != NULL ||
+			debug_output || out_debug_json != NULL || incremental || stream || onepass || watch || shared_css || encode_cache || compress || compare || pack || search_index || select_chapter != NULL || cache_file != NULL || root_folder != NULL || stats || stats_json != NULL))
+		param_error = true;
+
 	/* Initialise the messaging system. */
 
 	msg_initialise(verbose_output);
@@ -167,44 +448,557 @@ int main(int argc, char *argv[])
 	if (param_error || output_help) {
 		printf("\nXML Manual Creation -- Usage:\n");
 		printf("xmlman <infile> [-text <outfile>] [-strong <outfile>] [-html <outfile>] [-debug <outfile>]\n");
-		printf("       [-encoding <name>] [lineend <name>] [<options>]\n\n");
+		printf("       [-encoding <name>] [lineend <name>] [<options>]\n");
+		printf("xmlman - -root <folder> [<outputs>] [<options>]\n");
+		printf("xmlman -batch <file> [-verbose]\n\n");
 
 		printf(" -help                  Produce this help information.\n");
 		printf(" -verbose               Generate verbose process information.\n");
 		printf(" -encoding <name>       Override the output encoding.\n");
 		printf(" -lineend <name>        Override the output line ending type.\n");
+		printf(" -threads <n>           Parse files and write outputs using <n> threads.\n");
+		printf(" -incremental           Skip output files whose inputs are unchanged, as recorded in a manifest.\n");
+		printf(" -stream                Write StrongHelp output sequentially, without seeking.\n");
+		printf(" -htmlcss               Write the default stylesheet once, for all HTML pages to share.\n");
+		printf(" -compress              Compress the output files with gzip, writing StrongHelp sequentially.\n");
+		printf(" -compare               Only replace output files on disc if the content generated for them differs.\n");
+		printf(" -htmlpack              Pack HTML split across multiple files into a single tar archive.\n");
+		printf(" -searchindex           Write a search index beside HTML split across multiple files.\n");
+		printf(" -encodecache           Keep encoded text, so that text written repeatedly is only converted once.\n");
+		printf(" -stats                 Report the time spent in each phase, and the work done.\n");
+		printf(" -statsjson <file>      Write the phase timings and work counts to <file> as JSON.\n");
+		printf(" -cache <file>          Load the parsed document from <file> if current, or save it there.\n");
+		printf(" -chapter <id>          Only parse the chapter <id> in full, with the headings of the others.\n");
+		printf(" -onepass               Write single-file text output as the chapters are parsed.\n");
+		printf(" -batch <file>          Process each line of <file> as a separate set of options.\n");
+		printf(" -watch                 Keep running, and update the outputs when the source files change.\n");
+		printf(" -root <folder>         Find the chapter files in <folder>, such as when the source is - for stdin.\n");
 
-		printf(" -text <outfile>        Generate text format output to <outfile>.\n");
-		printf(" -html <outfile>        Generate HTML format output to <outfile>.\n");
+		printf(" -text <outfile>        Generate text format output to <outfile>, or - for stdout.\n");
+		printf(" -html <outfile>        Generate HTML format output to <outfile>, or - for stdout.\n");
 		printf(" -strong <outfile>      Generate StrongHelp format output to <outfile>.\n");
 		printf(" -debug                 Generate Debug format output to stdout.\n");
+		printf(" -debugjson <outfile>   Generate Debug format output to <outfile> as one JSON record per node.\n");
 
 		return (output_help) ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
-	/* Parse the source XML documents. */
+	/* Run a batch of jobs, if requested. */
+
+	if (batch_file != NULL)
+		return xmlman_run_batch(batch_file, verbose_output);
+
+	/* Initialise the build statistics. */
+
+	stats_initialise(stats || stats_json != NULL);
+
+	/* Compression and comparison apply to every file written to disc. */
+
+	output_file_initialise(compress, compare);
+
+	/* Chapter files are found against the root folder, if given. */
+
+	parse_initialise(root_folder);
+
+	/* One-pass text output is written while the document is parsed,
+	 * so there's nothing further to do once it completes.
+	 */
+
+	if (onepass) {
+		if (input_file == NULL) {
+			msg_report(MSG_PARSE_FAIL);
+			return EXIT_FAILURE;
+		}
+
+		onepass_file = filename_make(out_text, FILENAME_TYPE_LEAF, FILENAME_PLATFORM_LOCAL);
+		if (onepass_file == NULL) {
+			msg_report(MSG_OUTPUT_FILENAME_NO_MEM);
+			return EXIT_FAILURE;
+		}
+
+		output_text_stream_initialise(onepass_file, output_encoding, output_line_end);
+
+		onepass_stream.start = output_text_stream_start;
+		onepass_stream.write = output_text_stream_write;
+		onepass_stream.end = output_text_stream_end;
+
+		manifest_initialise(false);
+
+		document = parse_document_stream(input_file, &onepass_stream);
+
+		filename_destroy(onepass_file);
+
+		stats_report(stats, stats_json);
+
+		if (document == NULL) {
+			msg_report(MSG_PARSE_FAIL);
+			return EXIT_FAILURE;
+		}
+
+		manual_destroy(document);
+
+		return EXIT_SUCCESS;
+	}
+
+	/* Set up the selected outputs. In watch mode, only the output files
+	 * whose content has changed are written again.
+	 */
+
+	manifest_initialise(incremental || watch);
+	output_strong_file_initialise(stream || compress);
+	output_html_initialise(threads, shared_css, pack, search_index);
+
+	jobs[0].name = "Debug";
+	jobs[0].file = (debug_output == true) ? "" : NULL;
+	jobs[0].mode = output_debug;
+
+	jobs[1].name = "HTML";
+	jobs[1].file = out_html;
+	jobs[1].mode = output_html;
+
+	jobs[2].name = "StrongHelp";
+	jobs[2].file = out_strong;
+	jobs[2].mode = output_strong;
+
+	jobs[3].name = "Text";
+	jobs[3].file = out_text;
+	jobs[3].mode = output_text;
+
+	jobs[4].name = "Debug JSON";
+	jobs[4].file = out_debug_json;
+	jobs[4].mode = output_debug_json;
+
+	for (i = 0; i < XMLMAN_MAX_JOBS; i++) {
+		jobs[i].document = NULL;
+		jobs[i].encoding = output_encoding;
+		jobs[i].line_end = output_line_end;
+		jobs[i].result = false;
+	}
+
+	if (watch)
+		return xmlman_watch(input_file, jobs, XMLMAN_MAX_JOBS, threads, stats, stats_json);
+
+	/* If the source is itself a cache, load it and use its recorded root
+	 * file should it turn out to be out of date.
+	 */
+
+	if (select_chapter == NULL && strcmp(input_file, FILENAME_STDIO) != 0 && manual_cache_test(input_file)) {
+		cache_file = input_file;
+		input_file = NULL;
+	}
+
+	manual_cache_initialise(cache_file != NULL);
+
+	if (cache_file != NULL)
+		document = manual_cache_load(cache_file, (input_file == NULL) ? &input_file : NULL);
+
+	/* Parse the source XML documents, if they weren't in the cache. */
 
-	document = parse_document(input_file);
 	if (document == NULL) {
-		msg_report(MSG_PARSE_FAIL);
-		return EXIT_FAILURE;
+		if (input_file == NULL) {
+			msg_report(MSG_PARSE_FAIL);
+			return EXIT_FAILURE;
+		}
+
+		if (select_chapter != NULL)
+			document = parse_document_chapter(input_file, select_chapter);
+		else
+			document = parse_document(input_file, threads);
+
+		if (document == NULL) {
+			msg_report(MSG_PARSE_FAIL);
+			return EXIT_FAILURE;
+		}
+
+		if (cache_file != NULL)
+			manual_cache_save(document, cache_file);
 	}
 
 	/* Generate the selected outputs. */
 
-	if (!xmlman_process_mode((debug_output == true) ? "" : NULL, document, output_encoding, output_line_end, output_debug))
-		return EXIT_FAILURE;
+	for (i = 0; i < XMLMAN_MAX_JOBS; i++)
+		jobs[i].document = document;
 
-	if (!xmlman_process_mode(out_html, document, output_encoding, output_line_end, output_html))
-		return EXIT_FAILURE;
+	manual_encoded_initialise((encode_cache) ? document->arena : NULL);
+
+	result = xmlman_run_jobs(jobs, XMLMAN_MAX_JOBS, threads);
+
+	manual_encoded_initialise(NULL);
 
-	if (!xmlman_process_mode(out_strong, document, output_encoding, output_line_end, output_strong))
+	stats_report(stats, stats_json);
+
+	manual_destroy(document);
+
+	return (result) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Process a batch file, running each of its lines in turn as if it had
+ * been given on the command line. Blank lines, and those starting with
+ * a #, are ignored.
+ *
+ * The jobs run in sequence, since the parser's state is shared; each
+ * can still write its outputs using multiple threads.
+ *
+ * \param *file			The name of the batch file.
+ * \param verbose		True to generate verbose output between jobs.
+ * \return			The outcome of the batch, failing if any of
+ *				the jobs failed.
+ */
+
+static int xmlman_run_batch(char *file, bool verbose)
+{
+	FILE	*in;
+	char	line[XMLMAN_BATCH_LINE_LEN];
+	char	*argv[XMLMAN_BATCH_MAX_ARGS];
+	int	argc, outcome, line_number = 0, jobs = 0, succeeded = 0;
+	bool	result = true;
+
+	in = fopen(file, "r");
+	if (in == NULL) {
+		msg_report(MSG_BATCH_OPEN_FAIL, file);
 		return EXIT_FAILURE;
+	}
+
+	while (fgets(line, XMLMAN_BATCH_LINE_LEN, in) != NULL) {
+		line_number++;
+
+		/* Lines which don't fit in the buffer can't be run. */
+
+		if (strchr(line, '\n') == NULL && !feof(in)) {
+			msg_report(MSG_BATCH_LINE_TOO_LONG, line_number);
+			result = false;
+
+			while (fgets(line, XMLMAN_BATCH_LINE_LEN, in) != NULL && strchr(line, '\n') == NULL);
+			continue;
+		}
+
+		argv[0] = "xmlman";
+
+		argc = xmlman_split_batch_line(line, argv + 1, XMLMAN_BATCH_MAX_ARGS - 1);
+		if (argc == 0)
+			continue;
+
+		jobs++;
+
+		msg_report(MSG_BATCH_JOB_START, line_number);
+
+		outcome = (argc > 0) ? xmlman_process_line(argc + 1, argv, true) : EXIT_FAILURE;
+
+		/* Each job sets up the messages for itself, so restore them. */
+
+		msg_initialise(verbose);
+
+		if (outcome == EXIT_SUCCESS) {
+			succeeded++;
+		} else {
+			msg_report(MSG_BATCH_JOB_FAILED, line_number);
+			result = false;
+		}
+	}
+
+	fclose(in);
+
+	msg_report(MSG_BATCH_COMPLETE, succeeded, jobs);
 
-	if (!xmlman_process_mode(out_text, document, output_encoding, output_line_end, output_text))
+	return (result) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Split a line from a batch file into arguments in place, at spaces
+ * and tabs outside of double quotes.
+ *
+ * \param *line			The line to split, which is modified.
+ * \param *argv[]		An array to take pointers to the arguments.
+ * \param size			The size of the argument array.
+ * \return			The number of arguments found, zero if the
+ *				line is empty or a comment, or -1 if there
+ *				are too many arguments.
+ */
+
+static int xmlman_split_batch_line(char *line, char *argv[], int size)
+{
+	char	*read = line, *write = line;
+	int	argc = 0;
+	bool	quoted;
+
+	while (*read != '\0') {
+		while (*read == ' ' || *read == '\t' || *read == '\r' || *read == '\n')
+			read++;
+
+		if (*read == '\0' || (argc == 0 && *read == '#'))
+			break;
+
+		if (argc >= size)
+			return -1;
+
+		argv[argc++] = write;
+		quoted = false;
+
+		while (*read != '\0' && (quoted || (*read != ' ' && *read != '\t' && *read != '\r' && *read != '\n'))) {
+			if (*read == '"')
+				quoted = !quoted;
+			else
+				*write++ = *read;
+
+			read++;
+		}
+
+		if (*read != '\0')
+			read++;
+
+		*write++ = '\0';
+	}
+
+	return argc;
+}
+
+/**
+ * Watch a document's source files, writing the outputs again each time
+ * that any of them change. This only returns if an error prevents the
+ * document from being updated.
+ *
+ * \param *file			The name of the root file to parse.
+ * \param *jobs			The array of output jobs to run.
+ * \param count			The number of jobs in the array.
+ * \param threads		The number of threads to use for the outputs.
+ * \param stats			True to report statistics after each update.
+ * \param *stats_json		A file to write statistics to, or NULL.
+ * \return			The outcome of the execution.
+ */
+
+static int xmlman_watch(char *file, struct xmlman_job *jobs, int count, int threads, bool stats, char *stats_json)
+{
+	struct parse_watch	*watch;
+	struct manual		*document = NULL;
+	enum parse_watch_result	result;
+	int			i;
+
+	watch = parse_watch_create(file);
+	if (watch == NULL)
 		return EXIT_FAILURE;
 
-	return EXIT_SUCCESS;
+	while ((result = parse_watch_update(watch, &document)) != PARSE_WATCH_ERROR) {
+		if (result == PARSE_WATCH_CHANGED) {
+			if (document != NULL) {
+				for (i = 0; i < count; i++)
+					jobs[i].document = document;
+
+				xmlman_run_jobs(jobs, count, threads);
+			} else {
+				msg_report(MSG_PARSE_FAIL);
+			}
+
+			stats_report(stats, stats_json);
+			stats_initialise(stats || stats_json != NULL);
+
+			msg_report(MSG_WATCH_WAITING);
+		}
+
+		xmlman_watch_pause();
+	}
+
+	parse_watch_destroy(watch);
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * Wait for the interval between checks on the source files in watch mode.
+ */
+
+static void xmlman_watch_pause(void)
+{
+#ifdef LINUX
+	struct timespec	interval;
+
+	interval.tv_sec = XMLMAN_WATCH_INTERVAL / 1000;
+	interval.tv_nsec = (XMLMAN_WATCH_INTERVAL % 1000) * 1000000L;
+
+	nanosleep(&interval, NULL);
+#endif
+#ifdef RISCOS
+	os_t start;
+
+	start = os_read_monotonic_time();
+
+	while ((os_read_monotonic_time() - start) < XMLMAN_WATCH_INTERVAL / 10);
+#endif
+}
+
+/**
+ * Run a set of output jobs. If more than one thread is available, the
+ * jobs are run concurrently with the calling thread taking part;
+ * otherwise they are run in sequence, stopping at the first failure.
+ *
+ * \param *jobs			The array of jobs to run.
+ * \param count			The number of jobs in the array.
+ * \param threads		The number of threads to use.
+ * \return			True if all of the jobs succeeded; False
+ *				on failure or error.
+ */
+
+static bool xmlman_run_jobs(struct xmlman_job *jobs, int count, int threads)
+{
+	struct xmlman_job_pool	pool;
+	pthread_t		workers[XMLMAN_MAX_JOBS];
+	bool			started[XMLMAN_MAX_JOBS];
+	int			i, requested = 0;
+	bool			result = true;
+
+	if (jobs == NULL)
+		return false;
+
+	for (i = 0; i < count; i++) {
+		jobs[i].order = i;
+
+		if (jobs[i].file != NULL)
+			requested++;
+	}
+
+	if (threads > requested)
+		threads = requested;
+
+	if (threads > XMLMAN_MAX_JOBS)
+		threads = XMLMAN_MAX_JOBS;
+
+	/* Directories created by a previous run might since have been
+	 * removed, so check them all again.
+	 */
+
+	filename_mkdir_reset();
+
+	/* With a single thread, run the jobs in sequence. */
+
+	if (threads <= 1) {
+		for (i = 0; i < count; i++) {
+			if (!xmlman_run_job(&(jobs[i]), false))
+				return false;
+		}
+
+		return true;
+	}
+
+	/* Start the additional threads, then take part in the work. */
+
+	pool.jobs = jobs;
+	pool.count = count;
+	pool.next = 0;
+
+	if (pthread_mutex_init(&(pool.lock), NULL) != 0)
+		return false;
+
+	for (i = 1; i < threads; i++)
+		started[i] = (pthread_create(&(workers[i]), NULL, xmlman_job_worker, &pool) == 0) ? true : false;
+
+	xmlman_job_worker(&pool);
+
+	for (i = 1; i < threads; i++) {
+		if (started[i])
+			pthread_join(workers[i], NULL);
+	}
+
+	/* Report the messages from the jobs, in job order. */
+
+	msg_flush();
+
+	pthread_mutex_destroy(&(pool.lock));
+
+	for (i = 0; i < count; i++) {
+		if (!jobs[i].result)
+			result = false;
+	}
+
+	return result;
+}
+
+/**
+ * Run output jobs claimed from a pool until there are none left.
+ *
+ * \param *data			Pointer to the job pool.
+ * \return			NULL.
+ */
+
+static void *xmlman_job_worker(void *data)
+{
+	struct xmlman_job_pool	*pool = data;
+	struct xmlman_job	*job;
+
+	if (pool == NULL)
+		return NULL;
+
+	do {
+		job = NULL;
+
+		pthread_mutex_lock(&(pool->lock));
+
+		if (pool->next < pool->count)
+			job = &(pool->jobs[pool->next++]);
+
+		pthread_mutex_unlock(&(pool->lock));
+
+		if (job != NULL)
+			xmlman_run_job(job, true);
+	} while (job != NULL);
+
+	return NULL;
+}
+
+/**
+ * Run an output job, giving it message, encoding and queue contexts of
+ * its own so that it can run alongside other jobs.
+ *
+ * \param *job			The job to run.
+ * \param collect		True to collect the job's messages, to be
+ *				output once all of the jobs are complete.
+ * \return			True if successful or skipped; False on
+ *				failure or error.
+ */
+
+static bool xmlman_run_job(struct xmlman_job *job, bool collect)
+{
+	struct msg_context		*msg = NULL;
+	struct encoding_context		*encoding = NULL;
+	struct manual_queue_context	*queue = NULL;
+	struct stats_timer		timer;
+
+	if (job == NULL)
+		return false;
+
+	if (job->file == NULL) {
+		job->result = true;
+		return true;
+	}
+
+	msg = msg_create_context(collect);
+	encoding = encoding_create_context();
+	queue = manual_queue_create_context();
+
+	if (msg == NULL || encoding == NULL || queue == NULL) {
+		msg_report(MSG_UNKNOWN_MEM_ERROR);
+		job->result = false;
+	} else {
+		msg_select_context(msg);
+		msg_set_order(job->order);
+		encoding_select_context(encoding);
+		manual_queue_select_context(queue);
+
+		stats_start(&timer);
+
+		job->result = xmlman_process_mode(job->file, job->document, job->encoding, job->line_end, job->mode);
+
+		stats_record(&timer, "output", job->name);
+
+		msg_select_context(NULL);
+		encoding_select_context(NULL);
+		manual_queue_select_context(NULL);
+	}
+
+	msg_destroy_context(msg);
+	encoding_destroy_context(encoding);
+	manual_queue_destroy_context(queue);
+
+	return job->result;
 }
 
 /**
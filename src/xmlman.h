@@ -48,6 +48,12 @@ enum modes_type {
 	MODES_TYPE_HTML,
 };
 
+/**
+ * The number of mode types, for sizing arrays indexed by mode.
+ */
+
+#define MODES_TYPE_COUNT (MODES_TYPE_HTML + 1)
+
 /**
  * The possible node object types.
  */
@@ -226,14 +232,13 @@ struct manual_data_resources {
 
 /**
  * Data for a manual block chunk.
+ *
+ * Only the parts of the structure which are used by a node's type are
+ * allocated, so the members used by the smaller node types are kept
+ * together at the start.
  */
 
 struct manual_data_chunk {
-	/**
-	 * Flags relating to the object.
-	 */
-	enum manual_data_object_flags flags;
-
 	union {
 		/**
 		 * Pointer to the target object's ID, or NULL if none has been set.
@@ -256,18 +261,38 @@ struct manual_data_chunk {
 		 * means "don't care".
 		 */
 		int width;
+
+		/**
+		 * The chunk entity type.
+		 *
+		 * Used by ENTITY objects.
+		 */
+		enum manual_entity_type		entity;
+
+		/**
+		 * Pointer to the first cached copy of the text in an output
+		 * encoding, or NULL if none have been made.
+		 *
+		 * Used by TEXT objects.
+		 */
+		struct manual_data_encoded	*encoded;
 	};
 
 	union {
 		/**
 		 * Pointer to the chunk text.
+		 *
+		 * Used by TEXT objects.
 		 */
 		char				*text;
 
 		/**
-		 * The chunk entity type.
+		 * Pointer to the target object, or NULL if it could not
+		 * be found when the document was linked.
+		 *
+		 * Used by REFERENCE objects.
 		 */
-		enum manual_entity_type		entity;
+		struct manual_data		*target;
 	};
 };
 
@@ -282,13 +307,6 @@ struct manual_data_chapter {
 
 	char					*id;
 
-	/**
-	 * Has the chapter been processed, or is this just a placeholder?
-	 */
-
-	bool					processed;
-
-
 	union {
 		/**
 		 * Pointer to the chapter source filename, or NULL if this
@@ -310,8 +328,59 @@ struct manual_data_chapter {
 	};
 };
 
+/**
+ * Annotations calculated for a node when the document is linked, so
+ * that the output engines don't need to search up the tree for them.
+ */
+
+struct manual_data_annotations {
+	/**
+	 * For each mode, pointer to the node which owns the file holding
+	 * the node, or NULL if it's in the root file.
+	 */
+
+	struct manual_data		*file[MODES_TYPE_COUNT];
+
+	/**
+	 * For each mode, pointer to the first of the node and its parents
+	 * which gives an output folder, or NULL if none does.
+	 */
+
+	struct manual_data		*folder[MODES_TYPE_COUNT];
+
+	/**
+	 * For each mode, pointer to the first of the node and its parents
+	 * which gives a stylesheet, or NULL if none does.
+	 */
+
+	struct manual_data		*stylesheet[MODES_TYPE_COUNT];
+
+	/**
+	 * For each mode, true if the output is split across more than one
+	 * file. This is only set in the annotations of the root node.
+	 */
+
+	bool				split[MODES_TYPE_COUNT];
+
+	/**
+	 * Pointer to the node's display number, or NULL if none.
+	 */
+
+	char				*number;
+
+	/**
+	 * Pointer to the node's display number, prefixed by the object
+	 * name, or NULL if none.
+	 */
+
+	char				*named_number;
+};
+
 /**
  * Top-Level data for a manual node.
+ *
+ * Nodes are allocated with only as much of the type-specific union as
+ * their type requires: see manual_data_create().
  */
 
 struct manual_data {
@@ -319,7 +388,19 @@ struct manual_data {
 	 * The object's content type).
 	 */
 
-	enum manual_data_object_type		type;
+	enum manual_data_object_type		type : 16;
+
+	/**
+	 * Flags relating to the object.
+	 */
+
+	enum manual_data_object_flags		flags : 15;
+
+	/**
+	 * Has a chapter or index been processed, or is this just a placeholder?
+	 */
+
+	bool					processed : 1;
 
 	/**
 	 * The index number of the node, or zero.
@@ -357,6 +438,13 @@ struct manual_data {
 
 	struct manual_data			*next;
 
+	/**
+	 * Pointer to the node's annotations, which may be shared with
+	 * its parent, or NULL if the node hasn't been linked.
+	 */
+
+	struct manual_data_annotations		*annotations;
+
 	/**
 	 * Additional data for specific object types.
 	 */